@@ -105,6 +105,8 @@ idCommon *			common = &commonLocal;
 
 void			Sys_Mkdir( const char *path ) {}
 ID_TIME_T			Sys_FileTimeStamp( FILE *fp ) { return 0; }
+const void *	Sys_MapFile( FILE *fp, int length ) { return NULL; }
+void			Sys_UnmapFile( const void *data, int length ) {}
 
 #ifdef _WIN32
 
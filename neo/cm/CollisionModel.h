@@ -117,6 +117,11 @@ public:
 	virtual void			Translation( trace_t *results, const idVec3 &start, const idVec3 &end,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) = 0;
+	// Translates a trace model along several paths and reports the first collision of each.
+	// The paths are traced as one packet so they should be close together, like the pellets of a shotgun blast.
+	virtual void			TranslationBatch( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numTraces,
+								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
+								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) = 0;
 	// Rotates a trace model and reports the first collision if any.
 	virtual void			Rotation( trace_t *results, const idVec3 &start, const idRotation &rotation,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
@@ -59,10 +59,10 @@ bool idCollisionModelManagerLocal::TestTrmVertsInBrush( cm_traceWork_t *tw, cm_b
 	float d, bestd;
 	idVec3 *p;
 
-	if ( b->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( tw->brushMarks[b->index] == tw->checkCount ) {
 		return false;
 	}
-	b->checkcount = idCollisionModelManagerLocal::checkCount;
+	tw->brushMarks[b->index] = tw->checkCount;
 
 	if ( !(b->contents & tw->contents) ) {
 		return false;
@@ -131,10 +131,10 @@ CM_SetTrmEdgeSidedness
 CM_SetTrmPolygonSidedness
 ================
 */
-#define CM_SetTrmPolygonSidedness( v, plane, bitNum ) {								\
+#define CM_SetTrmPolygonSidedness( v, point, plane, bitNum ) {						\
 	if ( !((v)->sideSet & (1<<bitNum)) ) {											\
 		float fl;																	\
-		fl = plane.Distance( (v)->p );												\
+		fl = plane.Distance( point );												\
 		/* cannot use float sign bit because it is undetermined when fl == 0.0f */	\
 		if ( fl < 0.0f ) {															\
 			(v)->side |= (1 << bitNum);												\
@@ -159,13 +159,14 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 	float d, bestd;
 	cm_trmEdge_t *trmEdge;
 	cm_edge_t *edge;
-	cm_vertex_t *v, *v1, *v2;
+	cm_vertex_t *v;
+	cm_queryMark_t *edgeMark, *vm, *v1, *v2;
 
 	// if already checked this polygon
-	if ( p->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( tw->polygonMarks[p->index] == tw->checkCount ) {
 		return false;
 	}
-	p->checkcount = idCollisionModelManagerLocal::checkCount;
+	tw->polygonMarks[p->index] = tw->checkCount;
 
 	// if this polygon does not have the right contents behind it
 	if ( !(p->contents & tw->contents) ) {
@@ -197,14 +198,14 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 			edgeNum = p->edges[i];
 			edge = tw->model->edges + abs(edgeNum);
 			// if this edge is already tested
-			if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+			if ( tw->edgeMarks[abs(edgeNum)].checkcount == tw->checkCount ) {
 				continue;
 			}
 
 			for ( j = 0; j < 2; j++ ) {
 				v = &tw->model->vertices[edge->vertexNum[j]];
 				// if this vertex is already tested
-				if ( v->checkcount == idCollisionModelManagerLocal::checkCount ) {
+				if ( tw->vertexMarks[edge->vertexNum[j]].checkcount == tw->checkCount ) {
 					continue;
 				}
 
@@ -239,19 +240,20 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 	for ( i = 0; i < p->numEdges; i++ ) {
 		edgeNum = p->edges[i];
 		edge = tw->model->edges + abs(edgeNum);
+		edgeMark = tw->edgeMarks + abs(edgeNum);
 		// reset sidedness cache if this is the first time we encounter this edge
-		if ( edge->checkcount != idCollisionModelManagerLocal::checkCount ) {
-			edge->sideSet = 0;
+		if ( edgeMark->checkcount != tw->checkCount ) {
+			edgeMark->sideSet = 0;
 		}
 		// pluecker coordinate for edge
 		tw->polygonEdgePlueckerCache[i].FromLine( tw->model->vertices[edge->vertexNum[0]].p,
 													tw->model->vertices[edge->vertexNum[1]].p );
-		v = &tw->model->vertices[edge->vertexNum[INTSIGNBITSET(edgeNum)]];
+		vm = &tw->vertexMarks[edge->vertexNum[INTSIGNBITSET(edgeNum)]];
 		// reset sidedness cache if this is the first time we encounter this vertex
-		if ( v->checkcount != idCollisionModelManagerLocal::checkCount ) {
-			v->sideSet = 0;
+		if ( vm->checkcount != tw->checkCount ) {
+			vm->sideSet = 0;
 		}
-		v->checkcount = idCollisionModelManagerLocal::checkCount;
+		vm->checkcount = tw->checkCount;
 	}
 
 	// get side of polygon for each trm vertex
@@ -271,10 +273,10 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 		// test if trm edge goes through the polygon between the polygon edges
 		for ( j = 0; j < p->numEdges; j++ ) {
 			edgeNum = p->edges[j];
-			edge = tw->model->edges + abs(edgeNum);
+			edgeMark = tw->edgeMarks + abs(edgeNum);
 #if 1
-			CM_SetTrmEdgeSidedness( edge, tw->edges[i].pl, tw->polygonEdgePlueckerCache[j], i );
-			if ( INTSIGNBITSET(edgeNum) ^ ((edge->side >> i) & 1) ^ flip ) {
+			CM_SetTrmEdgeSidedness( edgeMark, tw->edges[i].pl, tw->polygonEdgePlueckerCache[j], i );
+			if ( INTSIGNBITSET(edgeNum) ^ ((edgeMark->side >> i) & 1) ^ flip ) {
 				break;
 			}
 #else
@@ -312,17 +314,18 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 	for ( i = 0; i < p->numEdges; i++ ) {
 		edgeNum = p->edges[i];
 		edge = tw->model->edges + abs(edgeNum);
-		if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+		edgeMark = tw->edgeMarks + abs(edgeNum);
+		if ( edgeMark->checkcount == tw->checkCount ) {
 			continue;
 		}
-		edge->checkcount = idCollisionModelManagerLocal::checkCount;
+		edgeMark->checkcount = tw->checkCount;
 
 		for ( j = 0; j < tw->numPolys; j++ ) {
 #if 1
-			v1 = tw->model->vertices + edge->vertexNum[0];
-			CM_SetTrmPolygonSidedness( v1, tw->polys[j].plane, j );
-			v2 = tw->model->vertices + edge->vertexNum[1];
-			CM_SetTrmPolygonSidedness( v2, tw->polys[j].plane, j );
+			v1 = tw->vertexMarks + edge->vertexNum[0];
+			CM_SetTrmPolygonSidedness( v1, tw->model->vertices[edge->vertexNum[0]].p, tw->polys[j].plane, j );
+			v2 = tw->vertexMarks + edge->vertexNum[1];
+			CM_SetTrmPolygonSidedness( v2, tw->model->vertices[edge->vertexNum[1]].p, tw->polys[j].plane, j );
 			// if the polygon edge does not cross the trm polygon plane
 			if ( !(((v1->side ^ v2->side) >> j) & 1) ) {
 				continue;
@@ -331,10 +334,8 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 #else
 			float d1, d2;
 
-			v1 = tw->model->vertices + edge->vertexNum[0];
-			d1 = tw->polys[j].plane.Distance( v1->p );
-			v2 = tw->model->vertices + edge->vertexNum[1];
-			d2 = tw->polys[j].plane.Distance( v2->p );
+			d1 = tw->polys[j].plane.Distance( tw->model->vertices[edge->vertexNum[0]].p );
+			d2 = tw->polys[j].plane.Distance( tw->model->vertices[edge->vertexNum[1]].p );
 			// if the polygon edge does not cross the trm polygon plane
 			if ( (d1 >= 0.0f && d2 >= 0.0f) || (d1 <= 0.0f && d2 <= 0.0f) ) {
 				continue;
@@ -350,8 +351,8 @@ bool idCollisionModelManagerLocal::TestTrmInPolygon( cm_traceWork_t *tw, cm_poly
 				trmEdge = tw->edges + abs(trmEdgeNum);
 #if 1
 				bitNum = abs(trmEdgeNum);
-				CM_SetTrmEdgeSidedness( edge, trmEdge->pl, tw->polygonEdgePlueckerCache[i], bitNum );
-				if ( INTSIGNBITSET(trmEdgeNum) ^ ((edge->side >> bitNum) & 1) ^ flip ) {
+				CM_SetTrmEdgeSidedness( edgeMark, trmEdge->pl, tw->polygonEdgePlueckerCache[i], bitNum );
+				if ( INTSIGNBITSET(trmEdgeNum) ^ ((edgeMark->side >> bitNum) & 1) ^ flip ) {
 					break;
 				}
 #else
@@ -415,7 +416,7 @@ cm_node_t *idCollisionModelManagerLocal::PointNode( const idVec3 &p, cm_model_t
 idCollisionModelManagerLocal::PointContents
 ================
 */
-int idCollisionModelManagerLocal::PointContents( const idVec3 p, cmHandle_t model ) {
+int idCollisionModelManagerLocal::PointContents( const idVec3 p, cm_model_t *model ) {
 	int i;
 	float d;
 	cm_node_t *node;
@@ -423,7 +424,7 @@ int idCollisionModelManagerLocal::PointContents( const idVec3 p, cmHandle_t mode
 	cm_brush_t *b;
 	idPlane *plane;
 
-	node = idCollisionModelManagerLocal::PointNode( p, idCollisionModelManagerLocal::models[model] );
+	node = idCollisionModelManagerLocal::PointNode( p, model );
 	for ( bref = node->brushes; bref; bref = bref->next ) {
 		b = bref->b;
 		// test if the point is within the brush bounds
@@ -458,7 +459,7 @@ int idCollisionModelManagerLocal::PointContents( const idVec3 p, cmHandle_t mode
 idCollisionModelManagerLocal::TransformedPointContents
 ==================
 */
-int	idCollisionModelManagerLocal::TransformedPointContents( const idVec3 &p, cmHandle_t model, const idVec3 &origin, const idMat3 &modelAxis ) {
+int	idCollisionModelManagerLocal::TransformedPointContents( const idVec3 &p, cm_model_t *model, const idVec3 &origin, const idMat3 &modelAxis ) {
 	idVec3 p_l;
 
 	// subtract origin offset
@@ -475,9 +476,9 @@ int	idCollisionModelManagerLocal::TransformedPointContents( const idVec3 &p, cmH
 idCollisionModelManagerLocal::ContentsTrm
 ==================
 */
-int idCollisionModelManagerLocal::ContentsTrm( trace_t *results, const idVec3 &start,
+int idCollisionModelManagerLocal::ContentsTrm( cm_queryContext_t *context, trace_t *results, const idVec3 &start,
 									const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
-									cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
+									cm_model_t *model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
 	int i;
 	bool model_rotated, trm_rotated;
 	idMat3 invModelAxis, tmpAxis;
@@ -497,8 +498,6 @@ int idCollisionModelManagerLocal::ContentsTrm( trace_t *results, const idVec3 &s
 		return results->c.contents;
 	}
 
-	idCollisionModelManagerLocal::checkCount++;
-
 	tw.trace.fraction = 1.0f;
 	tw.trace.c.contents = 0;
 	tw.trace.c.type = CONTACT_NONE;
@@ -509,7 +508,8 @@ int idCollisionModelManagerLocal::ContentsTrm( trace_t *results, const idVec3 &s
 	tw.pointTrace = false;
 	tw.quickExit = false;
 	tw.numContacts = 0;
-	tw.model = idCollisionModelManagerLocal::models[model];
+	tw.model = model;
+	idCollisionModelManagerLocal::SetupQueryMarks( context, &tw );
 	tw.start = start - modelOrigin;
 	tw.end = tw.start;
 
@@ -627,15 +627,23 @@ int idCollisionModelManagerLocal::Contents( const idVec3 &start,
 									const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 									cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
 	trace_t results;
+	cm_queryContext_t *context;
+	cm_model_t *cmodel;
 
 	if ( model < 0 || model > idCollisionModelManagerLocal::maxModels || model > MAX_SUBMODELS ) {
 		common->Printf("idCollisionModelManagerLocal::Contents: invalid model handle\n");
 		return 0;
 	}
-	if ( !idCollisionModelManagerLocal::models || !idCollisionModelManagerLocal::models[model] ) {
+	if ( !idCollisionModelManagerLocal::models ) {
+		common->Printf("idCollisionModelManagerLocal::Contents: invalid model\n");
+		return 0;
+	}
+	context = idCollisionModelManagerLocal::GetQueryContext();
+	cmodel = idCollisionModelManagerLocal::ModelForHandle( model );
+	if ( !cmodel ) {
 		common->Printf("idCollisionModelManagerLocal::Contents: invalid model\n");
 		return 0;
 	}
 
-	return ContentsTrm( &results, start, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
+	return ContentsTrm( context, &results, start, trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis );
 }
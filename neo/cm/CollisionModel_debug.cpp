@@ -323,7 +323,7 @@ void idCollisionModelManagerLocal::DrawModel( cmHandle_t handle, const idVec3 &m
 		cm_drawColor.ClearModified();
 	}
 
-	model = models[ handle ];
+	model = ModelForHandle( handle );
 	viewPos = (viewOrigin - modelOrigin) * modelAxis.Transpose();
 	checkCount++;
 	DrawNodePolygons( model, model->node, modelOrigin, modelAxis, viewPos, radius );
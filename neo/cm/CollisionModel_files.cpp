@@ -43,6 +43,12 @@ If you have questions concerning this license or the applicable additional terms
 #define CM_FILEID			"CM"
 #define CM_FILEVERSION		"1.00"
 
+#define CM_BINARY_FILE_EXT		"bcm"
+#define CM_BINARY_FILEID		"BCM "
+#define CM_BINARY_FILEVERSION	1
+
+static idCVar cm_useBinaryFiles( "cm_useBinaryFiles", "1", CVAR_GAME | CVAR_BOOL, "load collision models from the binary .bcm files written next to the .cm files" );
+
 
 /*
 ===============================================================================
@@ -232,7 +238,7 @@ idCollisionModelManagerLocal::WriteCollisionModelsToFile
 ================
 */
 void idCollisionModelManagerLocal::WriteCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC ) {
-	int i;
+	int i, textLength;
 	idFile *fp;
 	idStr name;
 
@@ -257,7 +263,11 @@ void idCollisionModelManagerLocal::WriteCollisionModelsToFile( const char *filen
 		WriteCollisionModel( fp, models[ i ] );
 	}
 
+	textLength = fp->Tell();
+
 	fileSystem->CloseFile( fp );
+
+	WriteBinaryCollisionModelsToFile( filename, &models[ firstModel ], lastModel - firstModel, mapFileCRC, textLength );
 }
 
 /*
@@ -266,6 +276,7 @@ idCollisionModelManagerLocal::WriteCollisionModelForMapEntity
 ================
 */
 bool idCollisionModelManagerLocal::WriteCollisionModelForMapEntity( const idMapEntity *mapEnt, const char *filename, const bool testTraceModel ) {
+	int textLength;
 	idFile *fp;
 	idStr name;
 	cm_model_t *model;
@@ -293,8 +304,12 @@ bool idCollisionModelManagerLocal::WriteCollisionModelForMapEntity( const idMapE
 	// write the collision model
 	WriteCollisionModel( fp, model );
 
+	textLength = fp->Tell();
+
 	fileSystem->CloseFile( fp );
 
+	WriteBinaryCollisionModelsToFile( filename, &model, 1, 0, textLength );
+
 	if ( testTraceModel ) {
 		idTraceModel trm;
 		TrmFromModel( model, trm );
@@ -305,6 +320,221 @@ bool idCollisionModelManagerLocal::WriteCollisionModelForMapEntity( const idMapE
 	return true;
 }
 
+/*
+===============================================================================
+
+Writing of binary collision model file
+
+The binary file stores the models the way they are kept in memory so
+loading them only needs to fix up the references between the arrays.
+Polygons and brushes are stored once and the nodes refer to them by number.
+
+===============================================================================
+*/
+
+/*
+================
+idCollisionModelManagerLocal::CollectPrimitives_r
+================
+*/
+void idCollisionModelManagerLocal::CollectPrimitives_r( cm_node_t *node, idList<cm_polygon_t *> &polygons, idList<cm_brush_t *> &brushes,
+														int &numPolygonRefs, int &numBrushRefs ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		if ( !pref->p ) {
+			continue;
+		}
+		numPolygonRefs++;
+		if ( pref->p->checkcount == checkCount ) {
+			continue;
+		}
+		pref->p->checkcount = checkCount;
+		polygons.Append( pref->p );
+	}
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		if ( !bref->b ) {
+			continue;
+		}
+		numBrushRefs++;
+		if ( bref->b->checkcount == checkCount ) {
+			continue;
+		}
+		bref->b->checkcount = checkCount;
+		brushes.Append( bref->b );
+	}
+	if ( node->planeType != -1 ) {
+		CollectPrimitives_r( node->children[0], polygons, brushes, numPolygonRefs, numBrushRefs );
+		CollectPrimitives_r( node->children[1], polygons, brushes, numPolygonRefs, numBrushRefs );
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryNodes
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryNodes( idFile *fp, cm_node_t *node, const idList<int> &polygonNums, const idList<int> &brushNums ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+	int num;
+
+	fp->WriteInt( node->planeType );
+	fp->WriteFloat( node->planeDist );
+
+	for ( num = 0, pref = node->polygons; pref; pref = pref->next ) {
+		num += ( pref->p != NULL );
+	}
+	fp->WriteInt( num );
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		if ( pref->p ) {
+			fp->WriteInt( polygonNums[pref->p->index] );
+		}
+	}
+
+	for ( num = 0, bref = node->brushes; bref; bref = bref->next ) {
+		num += ( bref->b != NULL );
+	}
+	fp->WriteInt( num );
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		if ( bref->b ) {
+			fp->WriteInt( brushNums[bref->b->index] );
+		}
+	}
+
+	if ( node->planeType != -1 ) {
+		WriteBinaryNodes( fp, node->children[0], polygonNums, brushNums );
+		WriteBinaryNodes( fp, node->children[1], polygonNums, brushNums );
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	int i, j, polygonMemory, brushMemory, numPolygonRefs, numBrushRefs;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	idList<const idMaterial *> materials;
+	idList<int> polygonNums, brushNums;
+
+	// number the polygons and brushes in the order they are written
+	numPolygonRefs = numBrushRefs = 0;
+	checkCount++;
+	CollectPrimitives_r( model->node, polygons, brushes, numPolygonRefs, numBrushRefs );
+	polygonNums.AssureSize( model->numPolygonIndexes, -1 );
+	brushNums.AssureSize( model->numBrushIndexes, -1 );
+	polygonMemory = brushMemory = 0;
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		polygonNums[polygons[i]->index] = i;
+		polygonMemory += sizeof( cm_polygon_t ) + ( polygons[i]->numEdges - 1 ) * sizeof( polygons[i]->edges[0] );
+		materials.AddUnique( polygons[i]->material );
+	}
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		brushNums[brushes[i]->index] = i;
+		brushMemory += sizeof( cm_brush_t ) + ( brushes[i]->numPlanes - 1 ) * sizeof( brushes[i]->planes[0] );
+	}
+
+	fp->WriteString( model->name );
+	fp->WriteVec3( model->bounds[0] );
+	fp->WriteVec3( model->bounds[1] );
+	fp->WriteInt( model->contents );
+	fp->WriteInt( model->numNodes );
+	fp->WriteInt( numPolygonRefs );
+	fp->WriteInt( numBrushRefs );
+	fp->WriteInt( model->numInternalEdges );
+	fp->WriteInt( model->numSharpEdges );
+
+	// vertices
+	fp->WriteInt( model->numVertices );
+	for ( i = 0; i < model->numVertices; i++ ) {
+		fp->WriteVec3( model->vertices[i].p );
+	}
+	// edges
+	fp->WriteInt( model->numEdges );
+	for ( i = 0; i < model->numEdges; i++ ) {
+		fp->WriteInt( model->edges[i].vertexNum[0] );
+		fp->WriteInt( model->edges[i].vertexNum[1] );
+		fp->WriteInt( model->edges[i].internal );
+		fp->WriteInt( model->edges[i].numUsers );
+		fp->WriteVec3( model->edges[i].normal );
+	}
+	// materials
+	fp->WriteInt( materials.Num() );
+	for ( i = 0; i < materials.Num(); i++ ) {
+		fp->WriteString( materials[i]->GetName() );
+	}
+	// polygons
+	fp->WriteInt( polygons.Num() );
+	fp->WriteInt( polygonMemory );
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		cm_polygon_t *p = polygons[i];
+		fp->WriteInt( p->numEdges );
+		for ( j = 0; j < p->numEdges; j++ ) {
+			fp->WriteInt( p->edges[j] );
+		}
+		fp->WriteVec3( p->plane.Normal() );
+		fp->WriteFloat( p->plane.Dist() );
+		fp->WriteVec3( p->bounds[0] );
+		fp->WriteVec3( p->bounds[1] );
+		fp->WriteInt( materials.FindIndex( p->material ) );
+	}
+	// brushes
+	fp->WriteInt( brushes.Num() );
+	fp->WriteInt( brushMemory );
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		cm_brush_t *b = brushes[i];
+		fp->WriteInt( b->numPlanes );
+		for ( j = 0; j < b->numPlanes; j++ ) {
+			fp->WriteVec3( b->planes[j].Normal() );
+			fp->WriteFloat( b->planes[j].Dist() );
+		}
+		fp->WriteVec3( b->bounds[0] );
+		fp->WriteVec3( b->bounds[1] );
+		fp->WriteInt( b->contents );
+	}
+	// nodes with references to the polygons and brushes
+	WriteBinaryNodes( fp, model->node, polygonNums, brushNums );
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile
+
+  the length of the text file is stored to detect a text file that changed afterwards
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile( const char *filename, cm_model_t **fileModels, int numFileModels, unsigned int mapFileCRC, int textLength ) {
+	int i;
+	idFile *fp;
+	idStr name;
+
+	name = filename;
+	name.SetFileExtension( CM_BINARY_FILE_EXT );
+
+	common->Printf( "writing %s\n", name.c_str() );
+	fp = fileSystem->OpenFileWrite( name, "fs_devpath" );
+	if ( !fp ) {
+		common->Warning( "idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile: Error opening file %s\n", name.c_str() );
+		return;
+	}
+
+	fp->Write( CM_BINARY_FILEID, 4 );
+	fp->WriteInt( CM_BINARY_FILEVERSION );
+	fp->WriteUnsignedInt( mapFileCRC );
+	fp->WriteInt( textLength );
+	fp->WriteInt( numFileModels );
+
+	for ( i = 0; i < numFileModels; i++ ) {
+		WriteBinaryCollisionModel( fp, fileModels[i] );
+	}
+
+	fileSystem->CloseFile( fp );
+}
+
 
 /*
 ===============================================================================
@@ -328,8 +558,6 @@ void idCollisionModelManagerLocal::ParseVertices( idLexer *src, cm_model_t *mode
 	model->vertices = (cm_vertex_t *) Mem_Alloc( model->maxVertices * sizeof( cm_vertex_t ) );
 	for ( i = 0; i < model->numVertices; i++ ) {
 		src->Parse1DMatrix( 3, model->vertices[i].p.ToFloatPtr() );
-		model->vertices[i].side = 0;
-		model->vertices[i].sideSet = 0;
 		model->vertices[i].checkcount = 0;
 	}
 	src->ExpectTokenString( "}" );
@@ -352,8 +580,6 @@ void idCollisionModelManagerLocal::ParseEdges( idLexer *src, cm_model_t *model )
 		model->edges[i].vertexNum[0] = src->ParseInt();
 		model->edges[i].vertexNum[1] = src->ParseInt();
 		src->ExpectTokenString( ")" );
-		model->edges[i].side = 0;
-		model->edges[i].sideSet = 0;
 		model->edges[i].internal = src->ParseInt();
 		model->edges[i].numUsers = src->ParseInt();
 		model->edges[i].normal = vec3_origin;
@@ -544,6 +770,8 @@ bool idCollisionModelManagerLocal::ParseCollisionModel( idLexer *src ) {
 						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
 						model->numBrushRefs * sizeof(cm_brushRef_t);
 
+	FlattenModel( model );
+
 	return true;
 }
 
@@ -558,6 +786,10 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	idLexer *src;
 	unsigned int crc;
 
+	if ( LoadBinaryCollisionModelFile( name, mapFileCRC ) ) {
+		return true;
+	}
+
 	// load it
 	fileName = name;
 	fileName.SetFileExtension( CM_FILE_EXT );
@@ -614,3 +846,424 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 
 	return true;
 }
+
+
+/*
+===============================================================================
+
+Loading of binary collision model file
+
+===============================================================================
+*/
+
+/*
+================
+CM_BinaryHasData
+
+  checks that the binary file has enough data left for count items
+================
+*/
+static bool CM_BinaryHasData( idFile *f, int count, int itemSize ) {
+	return count >= 0 && count <= ( f->Length() - f->Tell() ) / itemSize;
+}
+
+/*
+================
+CM_ReadBinaryString
+================
+*/
+static bool CM_ReadBinaryString( idFile *f, idStr &string ) {
+	char buffer[MAX_STRING_CHARS];
+	int length;
+
+	f->ReadInt( length );
+	if ( length < 0 || length >= MAX_STRING_CHARS || !CM_BinaryHasData( f, length, 1 ) ) {
+		return false;
+	}
+	f->Read( buffer, length );
+	buffer[length] = '\0';
+	string = buffer;
+	return true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryNodes_r
+
+  returns NULL if the file is bad
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::ReadBinaryNodes_r( idFile *f, cm_model_t *model, cm_node_t *parent,
+													const idList<cm_polygon_t *> &polygons, const idList<cm_brush_t *> &brushes,
+													int &numNodesLeft, int &numPolygonRefsLeft, int &numBrushRefsLeft ) {
+	cm_node_t *node;
+	cm_polygonRef_t *pref, **lastPolygonRef;
+	cm_brushRef_t *bref, **lastBrushRef;
+	int i, num, index;
+
+	if ( --numNodesLeft < 0 || !CM_BinaryHasData( f, 4, sizeof( int ) ) ) {
+		return NULL;
+	}
+
+	model->numNodes++;
+	node = AllocNode( model, model->numNodes + numNodesLeft );
+	node->brushes = NULL;
+	node->polygons = NULL;
+	node->parent = parent;
+	node->children[0] = node->children[1] = NULL;
+	f->ReadInt( node->planeType );
+	f->ReadFloat( node->planeDist );
+	if ( node->planeType < -1 || node->planeType > 2 ) {
+		return NULL;
+	}
+
+	// polygon references in the order they were written
+	f->ReadInt( num );
+	if ( num > numPolygonRefsLeft || !CM_BinaryHasData( f, num, sizeof( int ) ) ) {
+		return NULL;
+	}
+	numPolygonRefsLeft -= num;
+	lastPolygonRef = &node->polygons;
+	for ( i = 0; i < num; i++ ) {
+		f->ReadInt( index );
+		if ( index < 0 || index >= polygons.Num() ) {
+			return NULL;
+		}
+		pref = AllocPolygonReference( model, model->numPolygonRefs + numPolygonRefsLeft + num - i );
+		pref->p = polygons[index];
+		pref->next = NULL;
+		*lastPolygonRef = pref;
+		lastPolygonRef = &pref->next;
+		model->numPolygonRefs++;
+	}
+
+	// brush references in the order they were written
+	if ( !CM_BinaryHasData( f, 1, sizeof( int ) ) ) {
+		return NULL;
+	}
+	f->ReadInt( num );
+	if ( num > numBrushRefsLeft || !CM_BinaryHasData( f, num, sizeof( int ) ) ) {
+		return NULL;
+	}
+	numBrushRefsLeft -= num;
+	lastBrushRef = &node->brushes;
+	for ( i = 0; i < num; i++ ) {
+		f->ReadInt( index );
+		if ( index < 0 || index >= brushes.Num() ) {
+			return NULL;
+		}
+		bref = AllocBrushReference( model, model->numBrushRefs + numBrushRefsLeft + num - i );
+		bref->b = brushes[index];
+		bref->next = NULL;
+		*lastBrushRef = bref;
+		lastBrushRef = &bref->next;
+		model->numBrushRefs++;
+	}
+
+	if ( node->planeType != -1 ) {
+		node->children[0] = ReadBinaryNodes_r( f, model, node, polygons, brushes, numNodesLeft, numPolygonRefsLeft, numBrushRefsLeft );
+		if ( !node->children[0] ) {
+			return NULL;
+		}
+		node->children[1] = ReadBinaryNodes_r( f, model, node, polygons, brushes, numNodesLeft, numPolygonRefsLeft, numBrushRefsLeft );
+		if ( !node->children[1] ) {
+			return NULL;
+		}
+	}
+	return node;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryCollisionModel
+
+  The model is added to the models before it is read so the caller can free it if the file is bad.
+  The tree is only linked to the model once it is complete, until then all memory is owned by the blocks.
+================
+*/
+bool idCollisionModelManagerLocal::ReadBinaryCollisionModel( idFile *f ) {
+	cm_model_t *model;
+	cm_polygon_t *p;
+	cm_brush_t *b;
+	cm_node_t *node;
+	idStr name;
+	idVec3 normal;
+	float dist;
+	int i, j, num, size, memory, numNodes, numPolygonRefs, numBrushRefs;
+	idList<const idMaterial *> materials;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+
+	if ( numModels >= MAX_SUBMODELS ) {
+		common->Error( "LoadModel: no free slots" );
+		return false;
+	}
+
+	if ( !CM_ReadBinaryString( f, name ) || !CM_BinaryHasData( f, 12, sizeof( int ) ) ) {
+		return false;
+	}
+
+	model = AllocModel();
+	models[numModels] = model;
+	numModels++;
+	model->name = name;
+
+	f->ReadVec3( model->bounds[0] );
+	f->ReadVec3( model->bounds[1] );
+	f->ReadInt( model->contents );
+	f->ReadInt( numNodes );
+	f->ReadInt( numPolygonRefs );
+	f->ReadInt( numBrushRefs );
+	f->ReadInt( model->numInternalEdges );
+	f->ReadInt( model->numSharpEdges );
+	if ( numNodes <= 0 || numPolygonRefs < 0 || numBrushRefs < 0 ) {
+		return false;
+	}
+
+	// vertices
+	f->ReadInt( num );
+	if ( !CM_BinaryHasData( f, num, 3 * sizeof( float ) ) ) {
+		return false;
+	}
+	model->numVertices = model->maxVertices = num;
+	model->vertices = (cm_vertex_t *) Mem_Alloc( num * sizeof( cm_vertex_t ) );
+	for ( i = 0; i < num; i++ ) {
+		f->ReadVec3( model->vertices[i].p );
+		model->vertices[i].checkcount = 0;
+	}
+
+	// edges
+	if ( !CM_BinaryHasData( f, 1, sizeof( int ) ) ) {
+		return false;
+	}
+	f->ReadInt( num );
+	if ( !CM_BinaryHasData( f, num, 4 * sizeof( int ) + 3 * sizeof( float ) ) ) {
+		return false;
+	}
+	model->numEdges = model->maxEdges = num;
+	model->edges = (cm_edge_t *) Mem_Alloc( num * sizeof( cm_edge_t ) );
+	for ( i = 0; i < num; i++ ) {
+		cm_edge_t *edge = &model->edges[i];
+		int internal, numUsers;
+
+		f->ReadInt( edge->vertexNum[0] );
+		f->ReadInt( edge->vertexNum[1] );
+		f->ReadInt( internal );
+		f->ReadInt( numUsers );
+		f->ReadVec3( edge->normal );
+		if ( edge->vertexNum[0] < 0 || edge->vertexNum[0] >= model->numVertices ||
+				edge->vertexNum[1] < 0 || edge->vertexNum[1] >= model->numVertices ) {
+			return false;
+		}
+		edge->internal = internal;
+		edge->numUsers = numUsers;
+		edge->checkcount = 0;
+	}
+
+	// materials
+	if ( !CM_BinaryHasData( f, 1, sizeof( int ) ) ) {
+		return false;
+	}
+	f->ReadInt( num );
+	if ( !CM_BinaryHasData( f, num, sizeof( int ) ) ) {
+		return false;
+	}
+	materials.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		if ( !CM_ReadBinaryString( f, name ) ) {
+			return false;
+		}
+		materials[i] = declManager->FindMaterial( name );
+	}
+
+	// polygons, all of them go into a single block
+	if ( !CM_BinaryHasData( f, 2, sizeof( int ) ) ) {
+		return false;
+	}
+	f->ReadInt( num );
+	f->ReadInt( memory );
+	if ( !CM_BinaryHasData( f, num, 13 * sizeof( int ) ) || memory < 0 ) {
+		return false;
+	}
+	model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc( sizeof( cm_polygonBlock_t ) + memory );
+	model->polygonBlock->bytesRemaining = memory;
+	model->polygonBlock->next = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t );
+	polygons.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		int numEdges, materialNum;
+
+		f->ReadInt( numEdges );
+		if ( numEdges < 3 || numEdges > CM_MAX_POLYGON_EDGES || !CM_BinaryHasData( f, numEdges + 11, sizeof( int ) ) ) {
+			return false;
+		}
+		size = sizeof( cm_polygon_t ) + ( numEdges - 1 ) * sizeof( p->edges[0] );
+		if ( size > model->polygonBlock->bytesRemaining ) {
+			return false;
+		}
+		p = AllocPolygon( model, numEdges );
+		p->numEdges = numEdges;
+		for ( j = 0; j < numEdges; j++ ) {
+			f->ReadInt( p->edges[j] );
+			if ( abs( p->edges[j] ) >= model->numEdges ) {
+				return false;
+			}
+		}
+		f->ReadVec3( normal );
+		f->ReadFloat( dist );
+		p->plane.SetNormal( normal );
+		p->plane.SetDist( dist );
+		f->ReadVec3( p->bounds[0] );
+		f->ReadVec3( p->bounds[1] );
+		f->ReadInt( materialNum );
+		if ( materialNum < 0 || materialNum >= materials.Num() ) {
+			return false;
+		}
+		p->material = materials[materialNum];
+		p->contents = p->material->GetContentFlags();
+		p->checkcount = 0;
+		polygons[i] = p;
+	}
+
+	// brushes, all of them go into a single block
+	if ( !CM_BinaryHasData( f, 2, sizeof( int ) ) ) {
+		return false;
+	}
+	f->ReadInt( num );
+	f->ReadInt( memory );
+	if ( !CM_BinaryHasData( f, num, 8 * sizeof( int ) ) || memory < 0 ) {
+		return false;
+	}
+	model->brushBlock = (cm_brushBlock_t *) Mem_Alloc( sizeof( cm_brushBlock_t ) + memory );
+	model->brushBlock->bytesRemaining = memory;
+	model->brushBlock->next = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t );
+	brushes.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		int numPlanes;
+
+		f->ReadInt( numPlanes );
+		if ( numPlanes < 1 || !CM_BinaryHasData( f, numPlanes * 4 + 7, sizeof( int ) ) ) {
+			return false;
+		}
+		size = sizeof( cm_brush_t ) + ( numPlanes - 1 ) * sizeof( b->planes[0] );
+		if ( size > model->brushBlock->bytesRemaining ) {
+			return false;
+		}
+		b = AllocBrush( model, numPlanes );
+		b->numPlanes = numPlanes;
+		for ( j = 0; j < numPlanes; j++ ) {
+			f->ReadVec3( normal );
+			f->ReadFloat( dist );
+			b->planes[j].SetNormal( normal );
+			b->planes[j].SetDist( dist );
+		}
+		f->ReadVec3( b->bounds[0] );
+		f->ReadVec3( b->bounds[1] );
+		f->ReadInt( b->contents );
+		b->material = NULL;
+		b->checkcount = 0;
+		b->primitiveNum = 0;
+		brushes[i] = b;
+	}
+
+	// nodes with the polygon and brush references
+	node = ReadBinaryNodes_r( f, model, NULL, polygons, brushes, numNodes, numPolygonRefs, numBrushRefs );
+	if ( !node ) {
+		return false;
+	}
+	model->node = node;
+
+	// total memory used by this model
+	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
+						model->numEdges * sizeof(cm_edge_t) +
+						model->polygonMemory +
+						model->brushMemory +
+						model->numNodes * sizeof(cm_node_t) +
+						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
+						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	FlattenModel( model );
+
+	return true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModelFile
+
+  The binary file is mapped and the models are copied out of it into their own arrays.
+  A text file that is newer or has a different length than the one the binary
+  file was written with takes precedence.
+================
+*/
+bool idCollisionModelManagerLocal::LoadBinaryCollisionModelFile( const char *name, unsigned int mapFileCRC ) {
+	idStr fileName, textFileName;
+	const void *buffer;
+	ID_TIME_T timeStamp, textTimeStamp;
+	int i, length, version, fileTextLength, textLength, numFileModels, firstModel;
+	unsigned int crc;
+	char id[4];
+	bool ok;
+
+	if ( !cm_useBinaryFiles.GetBool() ) {
+		return false;
+	}
+
+	fileName = name;
+	fileName.SetFileExtension( CM_BINARY_FILE_EXT );
+
+	length = fileSystem->MapFile( fileName, &buffer, &timeStamp );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	idFile_Memory f( fileName, (const char *)buffer, length );
+
+	f.Read( id, sizeof( id ) );
+	f.ReadInt( version );
+	f.ReadUnsignedInt( crc );
+	f.ReadInt( fileTextLength );
+	f.ReadInt( numFileModels );
+
+	if ( length < (int)( sizeof( id ) + 4 * sizeof( int ) ) || memcmp( id, CM_BINARY_FILEID, sizeof( id ) ) != 0
+			|| version != CM_BINARY_FILEVERSION ) {
+		common->Warning( "%s is not a valid binary CM file.", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	if ( mapFileCRC && crc != mapFileCRC ) {
+		common->Printf( "%s is out of date\n", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	textFileName = name;
+	textFileName.SetFileExtension( CM_FILE_EXT );
+	textLength = fileSystem->ReadFile( textFileName, NULL, &textTimeStamp );
+	if ( textLength >= 0 && ( textLength != fileTextLength || textTimeStamp > timeStamp ) ) {
+		common->Printf( "%s is out of date\n", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	firstModel = numModels;
+	ok = ( numFileModels >= 0 );
+	for ( i = 0; ok && i < numFileModels; i++ ) {
+		ok = ReadBinaryCollisionModel( &f );
+	}
+
+	fileSystem->UnmapFile( buffer );
+
+	if ( !ok ) {
+		common->Warning( "%s is corrupt", fileName.c_str() );
+		// free the models read from this file
+		for ( i = firstModel; i < numModels; i++ ) {
+			FreeModel( models[i] );
+			models[i] = NULL;
+		}
+		numModels = firstModel;
+		return false;
+	}
+
+	return true;
+}
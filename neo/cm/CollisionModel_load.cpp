@@ -54,6 +54,8 @@ If you have questions concerning this license or the applicable additional terms
 idCollisionModelManagerLocal	collisionModelManagerLocal;
 idCollisionModelManager *		collisionModelManager = &collisionModelManagerLocal;
 
+static idCVar cm_flattenModels( "cm_flattenModels", "1", CVAR_GAME | CVAR_BOOL, "store the nodes and references of collision models in contiguous arrays after loading" );
+
 cm_windingList_t *				cm_windingList;
 cm_windingList_t *				cm_outList;
 cm_windingList_t *				cm_tmpList;
@@ -183,15 +185,10 @@ void idCollisionModelManagerLocal::Clear( void ) {
 	maxModels = 0;
 	numModels = 0;
 	models = NULL;
-	memset( trmPolygons, 0, sizeof( trmPolygons ) );
-	trmBrushes[0] = NULL;
+	memset( queryContexts, 0, sizeof( queryContexts ) );
 	trmMaterial = NULL;
 	numProcNodes = 0;
 	procNodes = NULL;
-	getContacts = false;
-	contacts = NULL;
-	maxContacts = 0;
-	numContacts = 0;
 }
 
 /*
@@ -387,6 +384,10 @@ void idCollisionModelManagerLocal::FreeModel( cm_model_t *model ) {
 		nextNodeBlock = nodeBlock->next;
 		Mem_Free( nodeBlock );
 	}
+	// free the flattened layout
+	Mem_Free( model->polygonRefNums );
+	Mem_Free16( model->polygonPlanes );
+	Mem_Free( model->polygonContents );
 	// free block allocated polygons
 	Mem_Free( model->polygonBlock );
 	// free block allocated brushes
@@ -419,7 +420,7 @@ void idCollisionModelManagerLocal::FreeMap( void ) {
 		FreeModel( models[i] );
 	}
 
-	FreeTrmModelStructure();
+	FreeQueryContexts();
 
 	Mem_Free( models );
 
@@ -433,22 +434,24 @@ void idCollisionModelManagerLocal::FreeMap( void ) {
 idCollisionModelManagerLocal::FreeTrmModelStructure
 ================
 */
-void idCollisionModelManagerLocal::FreeTrmModelStructure( void ) {
+void idCollisionModelManagerLocal::FreeTrmModelStructure( cm_queryContext_t *context ) {
 	int i;
+	cm_model_t *model;
 
-	assert( models );
-	if ( !models[MAX_SUBMODELS] ) {
+	model = context->trmModel;
+	if ( !model ) {
 		return;
 	}
 
 	for ( i = 0; i < MAX_TRACEMODEL_POLYS; i++ ) {
-		FreePolygon( models[MAX_SUBMODELS], trmPolygons[i]->p );
+		FreePolygon( model, context->trmPolygons[i]->p );
 	}
-	FreeBrush( models[MAX_SUBMODELS], trmBrushes[0]->b );
+	FreeBrush( model, context->trmBrushes[0]->b );
 
-	models[MAX_SUBMODELS]->node->polygons = NULL;
-	models[MAX_SUBMODELS]->node->brushes = NULL;
-	FreeModel( models[MAX_SUBMODELS] );
+	model->node->polygons = NULL;
+	model->node->brushes = NULL;
+	FreeModel( model );
+	context->trmModel = NULL;
 }
 
 
@@ -553,6 +556,11 @@ cm_model_t *idCollisionModelManagerLocal::AllocModel( void ) {
 	model->brushRefBlocks = NULL;
 	model->polygonBlock = NULL;
 	model->brushBlock = NULL;
+	model->numPolygonIndexes = 0;
+	model->numBrushIndexes = 0;
+	model->polygonRefNums = NULL;
+	model->polygonPlanes = NULL;
+	model->polygonContents = NULL;
 	model->numPolygons = model->polygonMemory =
 	model->numBrushes = model->brushMemory =
 	model->numNodes = model->numBrushRefs =
@@ -670,6 +678,7 @@ cm_polygon_t *idCollisionModelManagerLocal::AllocPolygon( cm_model_t *model, int
 	} else {
 		poly = (cm_polygon_t *) Mem_Alloc( size );
 	}
+	poly->index = model->numPolygonIndexes++;
 	return poly;
 }
 
@@ -692,6 +701,7 @@ cm_brush_t *idCollisionModelManagerLocal::AllocBrush( cm_model_t *model, int num
 	} else {
 		brush = (cm_brush_t *) Mem_Alloc( size );
 	}
+	brush->index = model->numBrushIndexes++;
 	return brush;
 }
 
@@ -730,16 +740,19 @@ void idCollisionModelManagerLocal::AddBrushToNode( cm_model_t *model, cm_node_t
 idCollisionModelManagerLocal::SetupTrmModelStructure
 ================
 */
-void idCollisionModelManagerLocal::SetupTrmModelStructure( void ) {
+void idCollisionModelManagerLocal::SetupTrmModelStructure( cm_queryContext_t *context ) {
 	int i;
 	cm_node_t *node;
 	cm_model_t *model;
+	cm_polygonRef_t **trmPolygons;
+	cm_brushRef_t **trmBrushes;
 
 	// setup model
 	model = AllocModel();
 
-	assert( models );
-	models[MAX_SUBMODELS] = model;
+	context->trmModel = model;
+	trmPolygons = context->trmPolygons;
+	trmBrushes = context->trmBrushes;
 	// create node to hold the collision data
 	node = (cm_node_t *) AllocNode( model, 1 );
 	node->planeType = -1;
@@ -751,11 +764,6 @@ void idCollisionModelManagerLocal::SetupTrmModelStructure( void ) {
 	model->numEdges = 0;
 	model->maxEdges = MAX_TRACEMODEL_EDGES+1;
 	model->edges = (cm_edge_t *) Mem_ClearedAlloc( model->maxEdges * sizeof(cm_edge_t) );
-	// create a material for the trace model polygons
-	trmMaterial = declManager->FindMaterial( "_tracemodel", false );
-	if ( !trmMaterial ) {
-		common->FatalError( "_tracemodel material not found" );
-	}
 
 	// allocate polygons
 	for ( i = 0; i < MAX_TRACEMODEL_POLYS; i++ ) {
@@ -782,8 +790,8 @@ void idCollisionModelManagerLocal::SetupTrmModelStructure( void ) {
 ================
 idCollisionModelManagerLocal::SetupTrmModel
 
-Trace models (item boxes, etc) are converted to collision models on the fly, using the last model slot
-as a reusable temporary buffer
+Trace models (item boxes, etc) are converted to collision models on the fly, using the trace
+model slot of the calling thread as a reusable temporary buffer
 ================
 */
 cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm, const idMaterial *material ) {
@@ -795,6 +803,9 @@ cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm,
 	const traceModelVert_t *trmVert;
 	const traceModelEdge_t *trmEdge;
 	const traceModelPoly_t *trmPoly;
+	cm_queryContext_t *context;
+	cm_polygonRef_t **trmPolygons;
+	cm_brushRef_t **trmBrushes;
 
 	assert( models );
 
@@ -802,7 +813,11 @@ cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm,
 		material = trmMaterial;
 	}
 
-	model = models[MAX_SUBMODELS];
+	context = GetQueryContext();
+	trmPolygons = context->trmPolygons;
+	trmBrushes = context->trmBrushes;
+
+	model = context->trmModel;
 	model->node->brushes = NULL;
 	model->node->polygons = NULL;
 	// if not a valid trace model
@@ -815,7 +830,6 @@ cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm,
 	trmVert = trm.verts;
 	for ( i = 0; i < trm.numVerts; i++, vertex++, trmVert++ ) {
 		vertex->p = *trmVert;
-		vertex->sideSet = 0;
 	}
 	// edges
 	model->numEdges = trm.numEdges;
@@ -826,7 +840,6 @@ cmHandle_t idCollisionModelManagerLocal::SetupTrmModel( const idTraceModel &trm,
 		edge->vertexNum[1] = trmEdge->v[1];
 		edge->normal = trmEdge->normal;
 		edge->internal = false;
-		edge->sideSet = 0;
 	}
 	// polygons
 	model->numPolygons = trm.numPolys;
@@ -2957,6 +2970,178 @@ void idCollisionModelManagerLocal::FinishModel( cm_model_t *model ) {
 						model->numNodes * sizeof(cm_node_t) +
 						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
 						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	FlattenModel( model );
+}
+
+/*
+================
+CM_CountNodes_r
+================
+*/
+static int CM_CountNodes_r( cm_node_t *node ) {
+	if ( node->planeType == -1 ) {
+		return 1;
+	}
+	return 1 + CM_CountNodes_r( node->children[0] ) + CM_CountNodes_r( node->children[1] );
+}
+
+/*
+================
+idCollisionModelManagerLocal::FlattenNode_r
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::FlattenNode_r( cm_model_t *model, cm_node_t *node, cm_node_t *parent, cm_node_t *nodes, int &numNodes,
+											cm_polygonRef_t *polygonRefs, int &numPolygonRefs, cm_brushRef_t *brushRefs, int &numBrushRefs ) {
+	cm_node_t *newNode;
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+
+	newNode = &nodes[numNodes++];
+	newNode->planeType = node->planeType;
+	newNode->planeDist = node->planeDist;
+	newNode->parent = parent;
+
+	// copy the polygon references next to each other
+	newNode->polygons = NULL;
+	newNode->firstPolygonRef = numPolygonRefs;
+	newNode->numPolygonRefs = 0;
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		if ( !pref->p ) {
+			continue;
+		}
+		polygonRefs[numPolygonRefs].p = pref->p;
+		polygonRefs[numPolygonRefs].next = NULL;
+		if ( newNode->numPolygonRefs ) {
+			polygonRefs[numPolygonRefs-1].next = &polygonRefs[numPolygonRefs];
+		} else {
+			newNode->polygons = &polygonRefs[numPolygonRefs];
+		}
+		model->polygonRefNums[numPolygonRefs] = pref->p->index;
+		numPolygonRefs++;
+		newNode->numPolygonRefs++;
+	}
+
+	// copy the brush references next to each other
+	newNode->brushes = NULL;
+	newNode->numBrushRefs = 0;
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		if ( !bref->b ) {
+			continue;
+		}
+		brushRefs[numBrushRefs].b = bref->b;
+		brushRefs[numBrushRefs].next = NULL;
+		if ( newNode->numBrushRefs ) {
+			brushRefs[numBrushRefs-1].next = &brushRefs[numBrushRefs];
+		} else {
+			newNode->brushes = &brushRefs[numBrushRefs];
+		}
+		numBrushRefs++;
+		newNode->numBrushRefs++;
+	}
+
+	// the front child directly follows its parent
+	if ( node->planeType != -1 ) {
+		newNode->children[0] = FlattenNode_r( model, node->children[0], newNode, nodes, numNodes, polygonRefs, numPolygonRefs, brushRefs, numBrushRefs );
+		newNode->children[1] = FlattenNode_r( model, node->children[1], newNode, nodes, numNodes, polygonRefs, numPolygonRefs, brushRefs, numBrushRefs );
+	} else {
+		newNode->children[0] = newNode->children[1] = NULL;
+	}
+	return newNode;
+}
+
+/*
+================
+idCollisionModelManagerLocal::FlattenModel
+
+  Moves the tree of a loaded model into one depth first node array with the
+  references of each node stored next to each other. The polygons and brushes
+  are numbered densely and the polygon planes and contents are copied into
+  arrays so the tree traversal can reject polygons without touching them.
+================
+*/
+void idCollisionModelManagerLocal::FlattenModel( cm_model_t *model ) {
+	int i, numNodes, numPolygons, numBrushes, numPolygonRefs, numBrushRefs;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	cm_nodeBlock_t *nodeBlock, *block, *nextNodeBlock;
+	cm_polygonRefBlock_t *polygonRefBlock, *prefBlock, *nextPolygonRefBlock;
+	cm_brushRefBlock_t *brushRefBlock, *brefBlock, *nextBrushRefBlock;
+	cm_node_t *nodes;
+
+	if ( !cm_flattenModels.GetBool() || !model->node || model->polygonRefNums ) {
+		return;
+	}
+
+	// number the polygons and brushes densely and count the references
+	numPolygonRefs = numBrushRefs = 0;
+	checkCount++;
+	CollectPrimitives_r( model->node, polygons, brushes, numPolygonRefs, numBrushRefs );
+	numPolygons = polygons.Num();
+	numBrushes = brushes.Num();
+	for ( i = 0; i < numPolygons; i++ ) {
+		polygons[i]->index = i;
+	}
+	for ( i = 0; i < numBrushes; i++ ) {
+		brushes[i]->index = i;
+	}
+	model->numPolygonIndexes = numPolygons;
+	model->numBrushIndexes = numBrushes;
+
+	numNodes = CM_CountNodes_r( model->node );
+
+	// allocate the new blocks, they replace the old ones so FreeModel releases them the same way
+	nodeBlock = (cm_nodeBlock_t *) Mem_ClearedAlloc( sizeof( cm_nodeBlock_t ) + numNodes * sizeof( cm_node_t ) );
+	nodeBlock->nextNode = NULL;
+	nodeBlock->next = NULL;
+	nodes = (cm_node_t *) ( ( (byte *) nodeBlock ) + sizeof( cm_nodeBlock_t ) );
+
+	polygonRefBlock = (cm_polygonRefBlock_t *) Mem_Alloc( sizeof( cm_polygonRefBlock_t ) + Max( numPolygonRefs, 1 ) * sizeof( cm_polygonRef_t ) );
+	polygonRefBlock->nextRef = NULL;
+	polygonRefBlock->next = NULL;
+
+	brushRefBlock = (cm_brushRefBlock_t *) Mem_Alloc( sizeof( cm_brushRefBlock_t ) + Max( numBrushRefs, 1 ) * sizeof( cm_brushRef_t ) );
+	brushRefBlock->nextRef = NULL;
+	brushRefBlock->next = NULL;
+
+	model->polygonRefNums = (int *) Mem_Alloc( Max( numPolygonRefs, 1 ) * sizeof( int ) );
+
+	numNodes = numPolygonRefs = numBrushRefs = 0;
+	model->node = FlattenNode_r( model, model->node, NULL, nodes, numNodes,
+									(cm_polygonRef_t *) ( ( (byte *) polygonRefBlock ) + sizeof( cm_polygonRefBlock_t ) ), numPolygonRefs,
+									(cm_brushRef_t *) ( ( (byte *) brushRefBlock ) + sizeof( cm_brushRefBlock_t ) ), numBrushRefs );
+
+	// free the old blocks
+	for ( block = model->nodeBlocks; block; block = nextNodeBlock ) {
+		nextNodeBlock = block->next;
+		Mem_Free( block );
+	}
+	model->nodeBlocks = nodeBlock;
+	for ( prefBlock = model->polygonRefBlocks; prefBlock; prefBlock = nextPolygonRefBlock ) {
+		nextPolygonRefBlock = prefBlock->next;
+		Mem_Free( prefBlock );
+	}
+	model->polygonRefBlocks = polygonRefBlock;
+	for ( brefBlock = model->brushRefBlocks; brefBlock; brefBlock = nextBrushRefBlock ) {
+		nextBrushRefBlock = brefBlock->next;
+		Mem_Free( brefBlock );
+	}
+	model->brushRefBlocks = brushRefBlock;
+
+	model->numNodes = numNodes;
+	model->numPolygonRefs = numPolygonRefs;
+	model->numBrushRefs = numBrushRefs;
+
+	// polygon planes and contents by polygon number
+	model->polygonPlanes = (float *) Mem_Alloc16( Max( numPolygons, 1 ) * 4 * sizeof( float ) );
+	model->polygonContents = (int *) Mem_Alloc( Max( numPolygons, 1 ) * sizeof( int ) );
+	for ( i = 0; i < numPolygons; i++ ) {
+		model->polygonPlanes[0 * numPolygons + i] = polygons[i]->plane[0];
+		model->polygonPlanes[1 * numPolygons + i] = polygons[i]->plane[1];
+		model->polygonPlanes[2 * numPolygons + i] = polygons[i]->plane[2];
+		model->polygonPlanes[3 * numPolygons + i] = polygons[i]->plane[3];
+		model->polygonContents[i] = polygons[i]->contents;
+	}
 }
 
 /*
@@ -3367,8 +3552,11 @@ void idCollisionModelManagerLocal::LoadMap( const idMapFile *mapFile ) {
 	// setup hash to speed up finding shared vertices and edges
 	SetupHash();
 
-	// setup trace model structure
-	SetupTrmModelStructure();
+	// material for the trace model polygons, the trace model structures are setup per thread
+	trmMaterial = declManager->FindMaterial( "_tracemodel", false );
+	if ( !trmMaterial ) {
+		common->FatalError( "_tracemodel material not found" );
+	}
 
 	// build collision models
 	BuildModels( mapFile );
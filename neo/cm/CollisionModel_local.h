@@ -80,17 +80,13 @@ Collision model
 
 typedef struct cm_vertex_s {
 	idVec3					p;					// vertex point
-	int						checkcount;			// for multi-check avoidance
-	unsigned long			side;				// each bit tells at which side this vertex passes one of the trace model edges
-	unsigned long			sideSet;			// each bit tells if sidedness for the trace model edge has been calculated yet
+	int						checkcount;			// for multi-check avoidance while building and drawing models
 } cm_vertex_t;
 
 typedef struct cm_edge_s {
-	int						checkcount;			// for multi-check avoidance
+	int						checkcount;			// for multi-check avoidance while building and drawing models
 	unsigned short			internal;			// a trace model can never collide with internal edges
 	unsigned short			numUsers;			// number of polygons using this edge
-	unsigned long			side;				// each bit tells at which side of this edge one of the trace model vertices passes
-	unsigned long			sideSet;			// each bit tells if sidedness for the trace model vertex has been calculated yet
 	int						vertexNum[2];		// start and end point of edge
 	idVec3					normal;				// edge normal
 } cm_edge_t;
@@ -102,7 +98,8 @@ typedef struct cm_polygonBlock_s {
 
 typedef struct cm_polygon_s {
 	idBounds				bounds;				// polygon bounds
-	int						checkcount;			// for multi-check avoidance
+	int						checkcount;			// for multi-check avoidance while building and drawing models
+	int						index;				// unique in the model, for the marks of collision queries
 	int						contents;			// contents behind polygon
 	const idMaterial *		material;			// material
 	idPlane					plane;				// polygon plane
@@ -126,7 +123,8 @@ typedef struct cm_brushBlock_s {
 } cm_brushBlock_t;
 
 typedef struct cm_brush_s {
-	int						checkcount;			// for multi-check avoidance
+	int						checkcount;			// for multi-check avoidance while building and drawing models
+	int						index;				// unique in the model, for the marks of collision queries
 	idBounds				bounds;				// brush bounds
 	int						contents;			// contents of brush
 	const idMaterial *		material;			// material
@@ -152,6 +150,9 @@ typedef struct cm_node_s {
 	cm_brushRef_t *			brushes;			// brushes in node
 	struct cm_node_s *		parent;				// parent of this node
 	struct cm_node_s *		children[2];		// node children
+	int						firstPolygonRef;	// first polygon number in the flattened model reference array
+	int						numPolygonRefs;		// number of polygon references of a flattened node
+	int						numBrushRefs;		// number of brush references of a flattened node
 } cm_node_t;
 
 typedef struct cm_nodeBlock_s {
@@ -178,6 +179,13 @@ typedef struct cm_model_s {
 	cm_brushRefBlock_t *	brushRefBlocks;		// list with blocks of brush references
 	cm_polygonBlock_t *		polygonBlock;		// memory block with all polygons
 	cm_brushBlock_t *		brushBlock;			// memory block with all brushes
+	int						numPolygonIndexes;	// number of polygons ever allocated
+	int						numBrushIndexes;	// number of brushes ever allocated
+	// flattened layout, the nodes are stored depth first in one block and the
+	// references of a node are contiguous so node->polygons[i] can be indexed
+	int *					polygonRefNums;		// polygon numbers of all node references, NULL if not flattened
+	float *					polygonPlanes;		// arrays with the a, b, c and d of the polygon planes by polygon number
+	int *					polygonContents;	// polygon contents by polygon number
 	// statistics
 	int						numPolygons;
 	int						polygonMemory;
@@ -231,6 +239,13 @@ typedef struct cm_trmPolygon_s {
 	idBounds rotationBounds;						// rotation bounds for this polygon
 } cm_trmPolygon_t;
 
+typedef struct cm_queryMark_s {
+	int checkcount;									// for multi-check avoidance
+	unsigned long side;								// each bit tells at which side a model vertex passes one of the trace model edges
+													// or at which side of a model edge one of the trace model vertices passes
+	unsigned long sideSet;							// each bit tells if sidedness for the trace model feature has been calculated yet
+} cm_queryMark_t;
+
 typedef struct cm_traceWork_s {
 	int numVerts;
 	cm_trmVertex_t vertices[MAX_TRACEMODEL_VERTS];	// trm vertices
@@ -239,12 +254,19 @@ typedef struct cm_traceWork_s {
 	int numPolys;
 	cm_trmPolygon_t polys[MAX_TRACEMODEL_POLYS];	// trm polygons
 	cm_model_t *model;								// model colliding with
+	int checkCount;									// for multi-check avoidance
+	int *polygonMarks;								// check counts for the model polygons by index
+	int *brushMarks;								// check counts for the model brushes by index
+	cm_queryMark_t *vertexMarks;					// check counts and sidedness for the model vertices
+	cm_queryMark_t *edgeMarks;						// check counts and sidedness for the model edges
 	idVec3 start;									// start of trace
 	idVec3 end;										// end of trace
 	idVec3 dir;										// trace direction
 	idBounds bounds;								// bounds of full trace
 	idBounds size;									// bounds of transformed trm relative to start
 	idVec3 extents;									// largest of abs(size[0]) and abs(size[1]) for BSP trace
+	bool modelRotated;								// true if the trace is rotated into the model space
+	idMat3 invModelAxis;							// transpose of the model axis if the model is rotated
 	int contents;									// ignore polygons that do not have any of these contents flags
 	trace_t trace;									// collision detection result
 
@@ -280,6 +302,43 @@ typedef struct cm_traceWork_s {
 /*
 ===============================================================================
 
+Query contexts
+
+Collision queries never write to the collision models, so any number of
+threads can query at the same time.  Every thread gets a context with its
+own multi-check marks, trace work and trace model slot.
+
+===============================================================================
+*/
+
+#define MAX_QUERY_CONTEXTS					(MAX_JOB_THREADS+1)		// main thread and job threads
+
+typedef struct cm_queryContext_s {
+	int						checkCount;			// incremented for every query
+	idList<int>				polygonMarks;		// grown to the largest model queried
+	idList<int>				brushMarks;
+	idList<cm_queryMark_t>	vertexMarks;
+	idList<cm_queryMark_t>	edgeMarks;
+	cm_traceWork_t *		translationWork;
+	cm_traceWork_t *		rotationWork;
+	cm_model_t *			trmModel;			// model used for TRACE_MODEL_HANDLE on this thread
+	cm_polygonRef_t *		trmPolygons[MAX_TRACEMODEL_POLYS];
+	cm_brushRef_t *			trmBrushes[1];
+	bool					getContacts;		// for retrieving contact points
+	contactInfo_t *			contacts;
+	int						maxContacts;
+	int						numContacts;
+	int						debugEntered;		// set while checking a query for missed collisions
+	idList<cm_polygon_t *>	packetPolygons;		// polygons touching the bounds of a batch of traces
+	idList<float>			packetBounds[6];	// bounds of the packet polygons as mins and maxs per axis
+	idList<int>				packetHits;			// packet polygons touching the bounds of the current trace
+} cm_queryContext_t;
+
+#define CM_MAX_PACKET_POLYGONS				2048	// beyond this the traces of a batch are traced one by one
+
+/*
+===============================================================================
+
 Collision Map
 
 ===============================================================================
@@ -321,6 +380,10 @@ public:
 	void			Translation( trace_t *results, const idVec3 &start, const idVec3 &end,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis );
+	// translates a trm along several paths and reports the first collision of each
+	void			TranslationBatch( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numTraces,
+								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
+								cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis );
 	// rotates a trm and reports the first collision if any
 	void			Rotation( trace_t *results, const idVec3 &start, const idRotation &rotation,
 								const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
@@ -354,6 +417,13 @@ private:			// CollisionMap_translate.cpp
 	bool			TranslateTrmThroughPolygon( cm_traceWork_t *tw, cm_polygon_t *p );
 	void			SetupTranslationHeartPlanes( cm_traceWork_t *tw );
 	void			SetupTrm( cm_traceWork_t *tw, const idTraceModel *trm );
+	bool			SetupTranslation( cm_queryContext_t *context, cm_traceWork_t *tw, trace_t *results,
+									const idVec3 &start, const idVec3 &end,
+									const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
+									cm_model_t *cmodel, const idVec3 &modelOrigin, const idMat3 &modelAxis );
+	void			FinishTranslation( cm_queryContext_t *context, cm_traceWork_t *tw, trace_t *results,
+									const idVec3 &start, const idVec3 &end, const idMat3 &trmAxis,
+									const idVec3 &modelOrigin, const idMat3 &modelAxis );
 
 private:			// CollisionMap_rotate.cpp
 	int				CollisionBetweenEdgeBounds( cm_traceWork_t *tw, const idVec3 &va, const idVec3 &vb,
@@ -378,30 +448,39 @@ private:			// CollisionMap_rotate.cpp
 											cm_vertex_t *v, idVec3 &rotationOrigin );
 	bool			RotateTrmThroughPolygon( cm_traceWork_t *tw, cm_polygon_t *p );
 	void			BoundsForRotation( const idVec3 &origin, const idVec3 &axis, const idVec3 &start, const idVec3 &end, idBounds &bounds );
-	void			Rotation180( trace_t *results, const idVec3 &rorg, const idVec3 &axis,
+	void			Rotation180( cm_queryContext_t *context, trace_t *results, const idVec3 &rorg, const idVec3 &axis,
 									const float startAngle, const float endAngle, const idVec3 &start,
 									const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
-									cmHandle_t model, const idVec3 &origin, const idMat3 &modelAxis );
+									cm_model_t *model, const idVec3 &origin, const idMat3 &modelAxis );
 
 private:			// CollisionMap_contents.cpp
 	bool			TestTrmVertsInBrush( cm_traceWork_t *tw, cm_brush_t *b );
 	bool			TestTrmInPolygon( cm_traceWork_t *tw, cm_polygon_t *p );
 	cm_node_t *		PointNode( const idVec3 &p, cm_model_t *model );
-	int				PointContents( const idVec3 p, cmHandle_t model );
-	int				TransformedPointContents( const idVec3 &p, cmHandle_t model, const idVec3 &origin, const idMat3 &modelAxis );
-	int				ContentsTrm( trace_t *results, const idVec3 &start,
+	int				PointContents( const idVec3 p, cm_model_t *model );
+	int				TransformedPointContents( const idVec3 &p, cm_model_t *model, const idVec3 &origin, const idMat3 &modelAxis );
+	int				ContentsTrm( cm_queryContext_t *context, trace_t *results, const idVec3 &start,
 									const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
-									cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis );
+									cm_model_t *model, const idVec3 &modelOrigin, const idMat3 &modelAxis );
 
 private:			// CollisionMap_trace.cpp
 	void			TraceTrmThroughNode( cm_traceWork_t *tw, cm_node_t *node );
+	void			TraceTrmThroughFlatNode( cm_traceWork_t *tw, cm_node_t *node );
 	void			TraceThroughAxialBSPTree_r( cm_traceWork_t *tw, cm_node_t *node, float p1f, float p2f, idVec3 &p1, idVec3 &p2);
 	void			TraceThroughModel( cm_traceWork_t *tw );
+	void			GatherPacketPolygons_r( cm_queryContext_t *context, cm_traceWork_t *tw, cm_node_t *node, const idBounds &bounds );
+	bool			GatherPacketPolygons( cm_queryContext_t *context, cm_model_t *model, const idBounds &bounds, int contentMask );
+	void			TraceThroughPacket( cm_queryContext_t *context, cm_traceWork_t *tw );
 	void			RecurseProcBSP_r( trace_t *results, int parentNodeNum, int nodeNum, float p1f, float p2f, const idVec3 &p1, const idVec3 &p2 );
 
 private:			// CollisionMap_load.cpp
 	void			Clear( void );
-	void			FreeTrmModelStructure( void );
+					// query contexts
+	cm_queryContext_t *GetQueryContext( void );
+	void			FreeQueryContexts( void );
+	cm_model_t *	ModelForHandle( cmHandle_t model );
+	void			SetupQueryMarks( cm_queryContext_t *context, cm_traceWork_t *tw );
+	void			FreeTrmModelStructure( cm_queryContext_t *context );
 					// model deallocation
 	void			RemovePolygonReferences_r( cm_node_t *node, cm_polygon_t *p );
 	void			RemoveBrushReferences_r( cm_node_t *node, cm_brush_t *b );
@@ -441,7 +520,7 @@ private:			// CollisionMap_load.cpp
 	cm_brush_t *	AllocBrush( cm_model_t *model, int numPlanes );
 	void			AddPolygonToNode( cm_model_t *model, cm_node_t *node, cm_polygon_t *p );
 	void			AddBrushToNode( cm_model_t *model, cm_node_t *node, cm_brush_t *b );
-	void			SetupTrmModelStructure( void );
+	void			SetupTrmModelStructure( cm_queryContext_t *context );
 	void			R_FilterPolygonIntoTree( cm_model_t *model, cm_node_t *node, cm_polygonRef_t *pref, cm_polygon_t *p );
 	void			R_FilterBrushIntoTree( cm_model_t *model, cm_node_t *node, cm_brushRef_t *pref, cm_brush_t *b );
 	cm_node_t *		R_CreateAxialBSPTree( cm_model_t *model, cm_node_t *node, const idBounds &bounds );
@@ -465,6 +544,9 @@ private:			// CollisionMap_load.cpp
 	void			RemapEdges( cm_node_t *node, int *edgeRemap );
 	void			OptimizeArrays( cm_model_t *model );
 	void			FinishModel( cm_model_t *model );
+	cm_node_t *		FlattenNode_r( cm_model_t *model, cm_node_t *node, cm_node_t *parent, cm_node_t *nodes, int &numNodes,
+									cm_polygonRef_t *polygonRefs, int &numPolygonRefs, cm_brushRef_t *brushRefs, int &numBrushRefs );
+	void			FlattenModel( cm_model_t *model );
 	void			BuildModels( const idMapFile *mapFile );
 	cmHandle_t		FindModel( const char *name );
 	cm_model_t *	CollisionModelForMapEntity( const idMapEntity *mapEnt );	// brush/patch model from .map
@@ -481,6 +563,11 @@ private:			// CollisionMap_files.cpp
 	void			WriteBrushes( idFile *fp, cm_node_t *node );
 	void			WriteCollisionModel( idFile *fp, cm_model_t *model );
 	void			WriteCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC );
+	void			CollectPrimitives_r( cm_node_t *node, idList<cm_polygon_t *> &polygons, idList<cm_brush_t *> &brushes,
+											int &numPolygonRefs, int &numBrushRefs );
+	void			WriteBinaryNodes( idFile *fp, cm_node_t *node, const idList<int> &polygonNums, const idList<int> &brushNums );
+	void			WriteBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	void			WriteBinaryCollisionModelsToFile( const char *filename, cm_model_t **fileModels, int numFileModels, unsigned int mapFileCRC, int textLength );
 					// loading
 	cm_node_t *		ParseNodes( idLexer *src, cm_model_t *model, cm_node_t *parent );
 	void			ParseVertices( idLexer *src, cm_model_t *model );
@@ -489,6 +576,11 @@ private:			// CollisionMap_files.cpp
 	void			ParseBrushes( idLexer *src, cm_model_t *model );
 	bool			ParseCollisionModel( idLexer *src );
 	bool			LoadCollisionModelFile( const char *name, unsigned int mapFileCRC );
+	cm_node_t *		ReadBinaryNodes_r( idFile *f, cm_model_t *model, cm_node_t *parent,
+									const idList<cm_polygon_t *> &polygons, const idList<cm_brush_t *> &brushes,
+									int &numNodesLeft, int &numPolygonRefsLeft, int &numBrushRefsLeft );
+	bool			ReadBinaryCollisionModel( idFile *f );
+	bool			LoadBinaryCollisionModelFile( const char *name, unsigned int mapFileCRC );
 
 private:			// CollisionMap_debug
 	int				ContentsFromString( const char *string ) const;
@@ -503,24 +595,18 @@ private:			// collision map data
 	idStr			mapName;
 	ID_TIME_T			mapFileTime;
 	int				loaded;
-					// for multi-check avoidance
+					// for multi-check avoidance while building and drawing models
 	int				checkCount;
 					// models
 	int				maxModels;
 	int				numModels;
 	cm_model_t **	models;
-					// polygons and brush for trm model
-	cm_polygonRef_t*trmPolygons[MAX_TRACEMODEL_POLYS];
-	cm_brushRef_t *	trmBrushes[1];
+					// per thread query data
+	cm_queryContext_t *queryContexts[MAX_QUERY_CONTEXTS];
 	const idMaterial *trmMaterial;
 					// for data pruning
 	int				numProcNodes;
 	cm_procNode_t *	procNodes;
-					// for retrieving contact points
-	bool			getContacts;
-	contactInfo_t *	contacts;
-	int				maxContacts;
-	int				numContacts;
 };
 
 // for debugging
@@ -508,7 +508,7 @@ void idCollisionModelManagerLocal::RotateTrmEdgeThroughPolygon( cm_traceWork_t *
 		edge = tw->model->edges + abs(edgeNum);
 
 		// if this edge is already checked
-		if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+		if ( tw->edgeMarks[abs(edgeNum)].checkcount == tw->checkCount ) {
 			continue;
 		}
 
@@ -1062,10 +1062,10 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 	idVec3 *rotationOrigin;
 
 	// if already checked this polygon
-	if ( p->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( tw->polygonMarks[p->index] == tw->checkCount ) {
 		return false;
 	}
-	p->checkcount = idCollisionModelManagerLocal::checkCount;
+	tw->polygonMarks[p->index] = tw->checkCount;
 
 	// if this polygon does not have the right contents behind it
 	if ( !(p->contents & tw->contents) ) {
@@ -1161,11 +1161,11 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 			edgeNum = p->edges[i];
 			e = tw->model->edges + abs(edgeNum);
 
-			if ( e->checkcount == idCollisionModelManagerLocal::checkCount ) {
+			if ( tw->edgeMarks[abs(edgeNum)].checkcount == tw->checkCount ) {
 				continue;
 			}
 			// set edge check count
-			e->checkcount = idCollisionModelManagerLocal::checkCount;
+			tw->edgeMarks[abs(edgeNum)].checkcount = tw->checkCount;
 			// can never collide with internal edges
 			if ( e->internal ) {
 				continue;
@@ -1176,11 +1176,11 @@ bool idCollisionModelManagerLocal::RotateTrmThroughPolygon( cm_traceWork_t *tw,
 				v = tw->model->vertices + e->vertexNum[k ^ INTSIGNBITSET(edgeNum)];
 
 				// if this vertex is already checked
-				if ( v->checkcount == idCollisionModelManagerLocal::checkCount ) {
+				if ( tw->vertexMarks[e->vertexNum[k ^ INTSIGNBITSET(edgeNum)]].checkcount == tw->checkCount ) {
 					continue;
 				}
 				// set vertex check count
-				v->checkcount = idCollisionModelManagerLocal::checkCount;
+				tw->vertexMarks[e->vertexNum[k ^ INTSIGNBITSET(edgeNum)]].checkcount = tw->checkCount;
 
 				// if the vertex is outside the trm rotation bounds
 				if ( !tw->bounds.ContainsPoint( v->p ) ) {
@@ -1249,10 +1249,10 @@ void idCollisionModelManagerLocal::BoundsForRotation( const idVec3 &origin, cons
 idCollisionModelManagerLocal::Rotation180
 ================
 */
-void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &rorg, const idVec3 &axis,
+void idCollisionModelManagerLocal::Rotation180( cm_queryContext_t *context, trace_t *results, const idVec3 &rorg, const idVec3 &axis,
 										const float startAngle, const float endAngle, const idVec3 &start,
 										const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
-										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
+										cm_model_t *model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
 	int i, j, edgeNum;
 	float d, maxErr, initialTan;
 	bool model_rotated, trm_rotated;
@@ -1263,18 +1263,7 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 	cm_trmPolygon_t *poly;
 	cm_trmEdge_t *edge;
 	cm_trmVertex_t *vert;
-	ALIGN16( static cm_traceWork_t tw );
-
-	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
-		common->Printf("idCollisionModelManagerLocal::Rotation180: invalid model handle\n");
-		return;
-	}
-	if ( !idCollisionModelManagerLocal::models[model] ) {
-		common->Printf("idCollisionModelManagerLocal::Rotation180: invalid model\n");
-		return;
-	}
-
-	idCollisionModelManagerLocal::checkCount++;
+	cm_traceWork_t &tw = *context->rotationWork;
 
 	tw.trace.fraction = 1.0f;
 	tw.trace.c.contents = 0;
@@ -1288,7 +1277,8 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 	tw.angle = endAngle - startAngle;
 	assert( tw.angle > -180.0f && tw.angle < 180.0f );
 	tw.maxTan = initialTan = idMath::Fabs( tan( ( idMath::PI / 360.0f ) * tw.angle ) );
-	tw.model = idCollisionModelManagerLocal::models[model];
+	tw.model = model;
+	idCollisionModelManagerLocal::SetupQueryMarks( context, &tw );
 	tw.start = start - modelOrigin;
 	// rotation axis, axis is assumed to be normalized
 	tw.axis = axis;
@@ -1610,24 +1600,33 @@ void idCollisionModelManagerLocal::Rotation180( trace_t *results, const idVec3 &
 idCollisionModelManagerLocal::Rotation
 ================
 */
-#ifdef _DEBUG
-static int entered = 0;
-#endif
-
 void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &start, const idRotation &rotation,
 										const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
 										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
 	idVec3 tmp;
 	float maxa, stepa, a, lasta;
+	cm_queryContext_t *context;
+	cm_model_t *cmodel;
 
 	assert( ((byte *)&start) < ((byte *)results) || ((byte *)&start) > (((byte *)results) + sizeof( trace_t )) );
 	assert( ((byte *)&trmAxis) < ((byte *)results) || ((byte *)&trmAxis) > (((byte *)results) + sizeof( trace_t )) );
 
 	memset( results, 0, sizeof( *results ) );
 
+	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
+		common->Printf("idCollisionModelManagerLocal::Rotation: invalid model handle\n");
+		return;
+	}
+	context = idCollisionModelManagerLocal::GetQueryContext();
+	cmodel = idCollisionModelManagerLocal::ModelForHandle( model );
+	if ( !cmodel ) {
+		common->Printf("idCollisionModelManagerLocal::Rotation: invalid model\n");
+		return;
+	}
+
 	// if special position test
 	if ( rotation.GetAngle() == 0.0f ) {
-		idCollisionModelManagerLocal::ContentsTrm( results, start, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
+		idCollisionModelManagerLocal::ContentsTrm( context, results, start, trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis );
 		return;
 	}
 
@@ -1635,13 +1634,13 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 	bool startsolid = false;
 	// test whether or not stuck to begin with
 	if ( cm_debugCollision.GetBool() ) {
-		if ( !entered ) {
-			entered = 1;
+		if ( !context->debugEntered ) {
+			context->debugEntered = 1;
 			// if already messed up to begin with
 			if ( idCollisionModelManagerLocal::Contents( start, trm, trmAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
 				startsolid = true;
 			}
-			entered = 0;
+			context->debugEntered = 0;
 		}
 	}
 #endif
@@ -1659,7 +1658,7 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 		}
 		for ( lasta = 0.0f, a = stepa; fabs( a ) < fabs( maxa ) + 1.0f; lasta = a, a += stepa ) {
 			// partial rotation
-			idCollisionModelManagerLocal::Rotation180( results, rotation.GetOrigin(), rotation.GetVec(), lasta, a, start, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
+			idCollisionModelManagerLocal::Rotation180( context, results, rotation.GetOrigin(), rotation.GetVec(), lasta, a, start, trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis );
 			// if there is a collision
 			if ( results->fraction < 1.0f ) {
 				// fraction of total rotation
@@ -1671,13 +1670,13 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 		return;
 	}
 
-	idCollisionModelManagerLocal::Rotation180( results, rotation.GetOrigin(), rotation.GetVec(), 0.0f, rotation.GetAngle(), start, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
+	idCollisionModelManagerLocal::Rotation180( context, results, rotation.GetOrigin(), rotation.GetVec(), 0.0f, rotation.GetAngle(), start, trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis );
 
 #ifdef _DEBUG
 	// test for missed collisions
 	if ( cm_debugCollision.GetBool() ) {
-		if ( !entered ) {
-			entered = 1;
+		if ( !context->debugEntered ) {
+			context->debugEntered = 1;
 			// if the trm is stuck in the model
 			if ( idCollisionModelManagerLocal::Contents( results->endpos, trm, results->endAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
 				trace_t tr;
@@ -1687,7 +1686,7 @@ void idCollisionModelManagerLocal::Rotation( trace_t *results, const idVec3 &sta
 				// re-run collision detection to find out where it failed
 				idCollisionModelManagerLocal::Rotation( &tr, start, rotation, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
 			}
-			entered = 0;
+			context->debugEntered = 0;
 		}
 	}
 #endif
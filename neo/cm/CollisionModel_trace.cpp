@@ -42,6 +42,117 @@ If you have questions concerning this license or the applicable additional terms
 /*
 ===============================================================================
 
+Query contexts
+
+===============================================================================
+*/
+
+/*
+================
+idCollisionModelManagerLocal::GetQueryContext
+
+  only the calling thread ever uses its context so it can be created on first use
+================
+*/
+cm_queryContext_t *idCollisionModelManagerLocal::GetQueryContext( void ) {
+	cm_queryContext_t *context;
+	int threadIndex;
+
+	threadIndex = jobManager->GetThreadIndex();
+	assert( threadIndex >= 0 && threadIndex < MAX_QUERY_CONTEXTS );
+
+	context = queryContexts[threadIndex];
+	if ( !context ) {
+		context = new cm_queryContext_t;
+		context->checkCount = 0;
+		context->translationWork = (cm_traceWork_t *) Mem_Alloc16( sizeof( cm_traceWork_t ) );
+		memset( context->translationWork, 0, sizeof( cm_traceWork_t ) );
+		context->rotationWork = (cm_traceWork_t *) Mem_Alloc16( sizeof( cm_traceWork_t ) );
+		memset( context->rotationWork, 0, sizeof( cm_traceWork_t ) );
+		context->trmModel = NULL;
+		context->getContacts = false;
+		context->contacts = NULL;
+		context->maxContacts = 0;
+		context->numContacts = 0;
+		context->debugEntered = 0;
+		queryContexts[threadIndex] = context;
+	}
+	if ( !context->trmModel ) {
+		SetupTrmModelStructure( context );
+	}
+	return context;
+}
+
+/*
+================
+idCollisionModelManagerLocal::FreeQueryContexts
+================
+*/
+void idCollisionModelManagerLocal::FreeQueryContexts( void ) {
+	int i;
+
+	for ( i = 0; i < MAX_QUERY_CONTEXTS; i++ ) {
+		if ( !queryContexts[i] ) {
+			continue;
+		}
+		FreeTrmModelStructure( queryContexts[i] );
+		Mem_Free16( queryContexts[i]->translationWork );
+		Mem_Free16( queryContexts[i]->rotationWork );
+		delete queryContexts[i];
+		queryContexts[i] = NULL;
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::ModelForHandle
+
+  the trace model handle refers to the trace model of the calling thread
+================
+*/
+cm_model_t *idCollisionModelManagerLocal::ModelForHandle( cmHandle_t model ) {
+	if ( model == TRACE_MODEL_HANDLE ) {
+		return GetQueryContext()->trmModel;
+	}
+	return models[model];
+}
+
+/*
+================
+idCollisionModelManagerLocal::SetupQueryMarks
+
+  starts a new query in the context and makes sure there are marks for all features of the model
+================
+*/
+void idCollisionModelManagerLocal::SetupQueryMarks( cm_queryContext_t *context, cm_traceWork_t *tw ) {
+	static const cm_queryMark_t clearMark = { 0, 0, 0 };
+	const cm_model_t *model = tw->model;
+
+	if ( context->polygonMarks.Num() < model->numPolygonIndexes ) {
+		context->polygonMarks.AssureSize( model->numPolygonIndexes, 0 );
+	}
+	if ( context->brushMarks.Num() < model->numBrushIndexes ) {
+		context->brushMarks.AssureSize( model->numBrushIndexes, 0 );
+	}
+	if ( context->vertexMarks.Num() < model->maxVertices ) {
+		context->vertexMarks.AssureSize( model->maxVertices, clearMark );
+	}
+	if ( context->edgeMarks.Num() < model->maxEdges ) {
+		context->edgeMarks.AssureSize( model->maxEdges, clearMark );
+	}
+
+	context->checkCount++;
+
+	tw->checkCount = context->checkCount;
+	tw->polygonMarks = context->polygonMarks.Ptr();
+	tw->brushMarks = context->brushMarks.Ptr();
+	tw->vertexMarks = context->vertexMarks.Ptr();
+	tw->edgeMarks = context->edgeMarks.Ptr();
+}
+
+/*
+===============================================================================
+
 Trace through the spatial subdivision
 
 ===============================================================================
@@ -56,6 +167,11 @@ void idCollisionModelManagerLocal::TraceTrmThroughNode( cm_traceWork_t *tw, cm_n
 	cm_polygonRef_t *pref;
 	cm_brushRef_t *bref;
 
+	if ( tw->model->polygonRefNums ) {
+		idCollisionModelManagerLocal::TraceTrmThroughFlatNode( tw, node );
+		return;
+	}
+
 	// position test
 	if ( tw->positionTest ) {
 		// if already stuck in solid
@@ -97,6 +213,81 @@ void idCollisionModelManagerLocal::TraceTrmThroughNode( cm_traceWork_t *tw, cm_n
 	}
 }
 
+/*
+================
+idCollisionModelManagerLocal::TraceTrmThroughFlatNode
+
+  the references of a flattened node are contiguous and the polygon contents
+  and planes can be checked without touching the polygons
+================
+*/
+void idCollisionModelManagerLocal::TraceTrmThroughFlatNode( cm_traceWork_t *tw, cm_node_t *node ) {
+	int i, num, numPolygons;
+	const int *polygonNums, *contents;
+	const float *a, *b, *c;
+
+	numPolygons = tw->model->numPolygonIndexes;
+	polygonNums = tw->model->polygonRefNums + node->firstPolygonRef;
+	contents = tw->model->polygonContents;
+
+	// position test
+	if ( tw->positionTest ) {
+		// if already stuck in solid
+		if ( tw->trace.fraction == 0.0f ) {
+			return;
+		}
+		// test if any of the trm vertices is inside a brush
+		for ( i = 0; i < node->numBrushRefs; i++ ) {
+			if ( idCollisionModelManagerLocal::TestTrmVertsInBrush( tw, node->brushes[i].b ) ) {
+				return;
+			}
+		}
+		// if just testing a point we're done
+		if ( tw->pointTrace ) {
+			return;
+		}
+		// test if the trm is stuck in any polygons
+		for ( i = 0; i < node->numPolygonRefs; i++ ) {
+			if ( !( contents[polygonNums[i]] & tw->contents ) ) {
+				continue;
+			}
+			if ( idCollisionModelManagerLocal::TestTrmInPolygon( tw, node->polygons[i].p ) ) {
+				return;
+			}
+		}
+	}
+	else if ( tw->rotation ) {
+		// rotate through all polygons in this leaf
+		for ( i = 0; i < node->numPolygonRefs; i++ ) {
+			if ( !( contents[polygonNums[i]] & tw->contents ) ) {
+				continue;
+			}
+			if ( idCollisionModelManagerLocal::RotateTrmThroughPolygon( tw, node->polygons[i].p ) ) {
+				return;
+			}
+		}
+	}
+	else {
+		a = tw->model->polygonPlanes;
+		b = a + numPolygons;
+		c = b + numPolygons;
+		// trace through all polygons in this leaf
+		for ( i = 0; i < node->numPolygonRefs; i++ ) {
+			num = polygonNums[i];
+			if ( !( contents[num] & tw->contents ) ) {
+				continue;
+			}
+			// only collide with the polygon if approaching at the front
+			if ( a[num] * tw->dir[0] + b[num] * tw->dir[1] + c[num] * tw->dir[2] > 0.0f ) {
+				continue;
+			}
+			if ( idCollisionModelManagerLocal::TranslateTrmThroughPolygon( tw, node->polygons[i].p ) ) {
+				return;
+			}
+		}
+	}
+}
+
 /*
 ================
 idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r
@@ -254,3 +445,142 @@ void idCollisionModelManagerLocal::TraceThroughModel( cm_traceWork_t *tw ) {
 		idCollisionModelManagerLocal::TraceThroughAxialBSPTree_r( tw, tw->model->node, 0, 1, start, tw->end );
 	}
 }
+
+/*
+===============================================================================
+
+Trace a batch of translations through the polygons of a packet
+
+===============================================================================
+*/
+
+/*
+================
+idCollisionModelManagerLocal::GatherPacketPolygons_r
+================
+*/
+void idCollisionModelManagerLocal::GatherPacketPolygons_r( cm_queryContext_t *context, cm_traceWork_t *tw, cm_node_t *node, const idBounds &bounds ) {
+	cm_polygonRef_t *pref;
+	cm_polygon_t *p;
+
+	while ( node ) {
+		for ( pref = node->polygons; pref; pref = pref->next ) {
+			p = pref->p;
+			// if already added
+			if ( tw->polygonMarks[p->index] == tw->checkCount ) {
+				continue;
+			}
+			tw->polygonMarks[p->index] = tw->checkCount;
+			// if this polygon does not have the right contents behind it
+			if ( !(p->contents & tw->contents) ) {
+				continue;
+			}
+			if ( !bounds.IntersectsBounds( p->bounds ) ) {
+				continue;
+			}
+			context->packetPolygons.Append( p );
+		}
+		// if this is a leaf node
+		if ( node->planeType == -1 ) {
+			break;
+		}
+		if ( bounds[0][node->planeType] > node->planeDist ) {
+			node = node->children[0];
+		}
+		else if ( bounds[1][node->planeType] < node->planeDist ) {
+			node = node->children[1];
+		}
+		else {
+			idCollisionModelManagerLocal::GatherPacketPolygons_r( context, tw, node->children[1], bounds );
+			node = node->children[0];
+		}
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::GatherPacketPolygons
+
+  collects the polygons touching the packet bounds in model space
+  returns false if there are too many polygons to be worth sharing
+================
+*/
+bool idCollisionModelManagerLocal::GatherPacketPolygons( cm_queryContext_t *context, cm_model_t *model, const idBounds &bounds, int contentMask ) {
+	int i, j, num;
+	cm_traceWork_t *tw;
+
+	tw = context->translationWork;
+	tw->model = model;
+	tw->contents = contentMask;
+	idCollisionModelManagerLocal::SetupQueryMarks( context, tw );
+
+	context->packetPolygons.SetNum( 0, false );
+	idCollisionModelManagerLocal::GatherPacketPolygons_r( context, tw, model->node, bounds );
+
+	num = context->packetPolygons.Num();
+	if ( num > CM_MAX_PACKET_POLYGONS ) {
+		return false;
+	}
+
+	// store the polygon bounds per axis so every trace can test them in one straight loop
+	for ( j = 0; j < 6; j++ ) {
+		context->packetBounds[j].SetNum( num, false );
+	}
+	context->packetHits.SetNum( num, false );
+	for ( i = 0; i < num; i++ ) {
+		const idBounds &b = context->packetPolygons[i]->bounds;
+		for ( j = 0; j < 3; j++ ) {
+			context->packetBounds[j][i] = b[0][j];
+			context->packetBounds[3+j][i] = b[1][j];
+		}
+	}
+	return true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::TraceThroughPacket
+================
+*/
+void idCollisionModelManagerLocal::TraceThroughPacket( cm_queryContext_t *context, cm_traceWork_t *tw ) {
+	int i, num;
+	int *hits;
+	const float *minx, *miny, *minz, *maxx, *maxy, *maxz;
+	float tminx, tminy, tminz, tmaxx, tmaxy, tmaxz;
+
+	num = context->packetPolygons.Num();
+	hits = context->packetHits.Ptr();
+	minx = context->packetBounds[0].Ptr();
+	miny = context->packetBounds[1].Ptr();
+	minz = context->packetBounds[2].Ptr();
+	maxx = context->packetBounds[3].Ptr();
+	maxy = context->packetBounds[4].Ptr();
+	maxz = context->packetBounds[5].Ptr();
+
+	tminx = tw->bounds[0][0];
+	tminy = tw->bounds[0][1];
+	tminz = tw->bounds[0][2];
+	tmaxx = tw->bounds[1][0];
+	tmaxy = tw->bounds[1][1];
+	tmaxz = tw->bounds[1][2];
+
+	// test the trace bounds against all packet polygon bounds without branches
+	for ( i = 0; i < num; i++ ) {
+		hits[i] = ( minx[i] <= tmaxx ) & ( maxx[i] >= tminx ) &
+					( miny[i] <= tmaxy ) & ( maxy[i] >= tminy ) &
+					( minz[i] <= tmaxz ) & ( maxz[i] >= tminz );
+	}
+
+	// trace through the polygons the trace bounds touch
+	for ( i = 0; i < num; i++ ) {
+		if ( !hits[i] ) {
+			continue;
+		}
+		if ( idCollisionModelManagerLocal::TranslateTrmThroughPolygon( tw, context->packetPolygons[i] ) ) {
+			return;
+		}
+		if ( tw->quickExit ) {
+			return;
+		}
+	}
+}
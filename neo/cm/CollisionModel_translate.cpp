@@ -39,6 +39,8 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "CollisionModel_local.h"
 
+static idCVar cm_packetTraces( "cm_packetTraces", "1", CVAR_GAME | CVAR_BOOL, "share the walk through the spatial subdivision between the traces of a batch" );
+
 /*
 ===============================================================================
 
@@ -200,7 +202,7 @@ CM_SetVertexSidedness
   stores for the given model vertex at which side of one of the trm edges it passes
 ================
 */
-ID_INLINE void CM_SetVertexSidedness( cm_vertex_t *v, const idPluecker &vpl, const idPluecker &epl, const int bitNum ) {
+ID_INLINE void CM_SetVertexSidedness( cm_queryMark_t *v, const idPluecker &vpl, const idPluecker &epl, const int bitNum ) {
 	if ( !(v->sideSet & (1<<bitNum)) ) {
 		float fl;
 		fl = vpl.PermutedInnerProduct( epl );
@@ -216,7 +218,7 @@ CM_SetEdgeSidedness
   stores for the given model edge at which side one of the trm vertices
 ================
 */
-ID_INLINE void CM_SetEdgeSidedness( cm_edge_t *edge, const idPluecker &vpl, const idPluecker &epl, const int bitNum ) {
+ID_INLINE void CM_SetEdgeSidedness( cm_queryMark_t *edge, const idPluecker &vpl, const idPluecker &epl, const int bitNum ) {
 	if ( !(edge->sideSet & (1<<bitNum)) ) {
 		float fl;
 		fl = vpl.PermutedInnerProduct( epl );
@@ -235,15 +237,16 @@ void idCollisionModelManagerLocal::TranslateTrmEdgeThroughPolygon( cm_traceWork_
 	float f1, f2, dist, d1, d2;
 	idVec3 start, end, normal;
 	cm_edge_t *edge;
-	cm_vertex_t *v1, *v2;
+	cm_queryMark_t *edgeMark, *v1, *v2;
 	idPluecker *pl, epsPl;
 
 	// check edges for a collision
 	for ( i = 0; i < poly->numEdges; i++) {
 		edgeNum = poly->edges[i];
 		edge = tw->model->edges + abs(edgeNum);
+		edgeMark = tw->edgeMarks + abs(edgeNum);
 		// if this edge is already checked
-		if ( edge->checkcount == idCollisionModelManagerLocal::checkCount ) {
+		if ( edgeMark->checkcount == tw->checkCount ) {
 			continue;
 		}
 		// can never collide with internal edges
@@ -252,16 +255,16 @@ void idCollisionModelManagerLocal::TranslateTrmEdgeThroughPolygon( cm_traceWork_
 		}
 		pl = &tw->polygonEdgePlueckerCache[i];
 		// get the sides at which the trm edge vertices pass the polygon edge
-		CM_SetEdgeSidedness( edge, *pl, tw->vertices[trmEdge->vertexNum[0]].pl, trmEdge->vertexNum[0] );
-		CM_SetEdgeSidedness( edge, *pl, tw->vertices[trmEdge->vertexNum[1]].pl, trmEdge->vertexNum[1] );
+		CM_SetEdgeSidedness( edgeMark, *pl, tw->vertices[trmEdge->vertexNum[0]].pl, trmEdge->vertexNum[0] );
+		CM_SetEdgeSidedness( edgeMark, *pl, tw->vertices[trmEdge->vertexNum[1]].pl, trmEdge->vertexNum[1] );
 		// if the trm edge start and end vertex do not pass the polygon edge at different sides
-		if ( !(((edge->side >> trmEdge->vertexNum[0]) ^ (edge->side >> trmEdge->vertexNum[1])) & 1) ) {
+		if ( !(((edgeMark->side >> trmEdge->vertexNum[0]) ^ (edgeMark->side >> trmEdge->vertexNum[1])) & 1) ) {
 			continue;
 		}
 		// get the sides at which the polygon edge vertices pass the trm edge
-		v1 = tw->model->vertices + edge->vertexNum[INTSIGNBITSET(edgeNum)];
+		v1 = tw->vertexMarks + edge->vertexNum[INTSIGNBITSET(edgeNum)];
 		CM_SetVertexSidedness( v1, tw->polygonVertexPlueckerCache[i], trmEdge->pl, trmEdge->bitNum );
-		v2 = tw->model->vertices + edge->vertexNum[INTSIGNBITNOTSET(edgeNum)];
+		v2 = tw->vertexMarks + edge->vertexNum[INTSIGNBITNOTSET(edgeNum)];
 		CM_SetVertexSidedness( v2, tw->polygonVertexPlueckerCache[i+1], trmEdge->pl, trmEdge->bitNum );
 		// if the polygon edge start and end vertex do not pass the trm edge at different sides
 		if ( !((v1->side ^ v2->side) & (1<<trmEdge->bitNum)) ) {
@@ -396,14 +399,14 @@ idCollisionModelManagerLocal::TranslateTrmVertexThroughPolygon
 void idCollisionModelManagerLocal::TranslateTrmVertexThroughPolygon( cm_traceWork_t *tw, cm_polygon_t *poly, cm_trmVertex_t *v, int bitNum ) {
 	int i, edgeNum;
 	float f;
-	cm_edge_t *edge;
+	cm_queryMark_t *edge;
 
 	f = CM_TranslationPlaneFraction( poly->plane, v->p, v->endp );
 	if ( f < tw->trace.fraction ) {
 
 		for ( i = 0; i < poly->numEdges; i++ ) {
 			edgeNum = poly->edges[i];
-			edge = tw->model->edges + abs(edgeNum);
+			edge = tw->edgeMarks + abs(edgeNum);
 			CM_SetEdgeSidedness( edge, tw->polygonEdgePlueckerCache[i], v->pl, bitNum );
 			if ( INTSIGNBITSET(edgeNum) ^ ((edge->side >> bitNum) & 1) ) {
 				return;
@@ -440,6 +443,7 @@ void idCollisionModelManagerLocal::TranslatePointThroughPolygon( cm_traceWork_t
 	int i, edgeNum;
 	float f;
 	cm_edge_t *edge;
+	cm_queryMark_t *edgeMark;
 	idPluecker pl;
 
 	f = CM_TranslationPlaneFraction( poly->plane, v->p, v->endp );
@@ -448,17 +452,18 @@ void idCollisionModelManagerLocal::TranslatePointThroughPolygon( cm_traceWork_t
 		for ( i = 0; i < poly->numEdges; i++ ) {
 			edgeNum = poly->edges[i];
 			edge = tw->model->edges + abs(edgeNum);
+			edgeMark = tw->edgeMarks + abs(edgeNum);
 			// if we didn't yet calculate the sidedness for this edge
-			if ( edge->checkcount != idCollisionModelManagerLocal::checkCount ) {
+			if ( edgeMark->checkcount != tw->checkCount ) {
 				float fl;
-				edge->checkcount = idCollisionModelManagerLocal::checkCount;
+				edgeMark->checkcount = tw->checkCount;
 				pl.FromLine(tw->model->vertices[edge->vertexNum[0]].p, tw->model->vertices[edge->vertexNum[1]].p);
 				fl = v->pl.PermutedInnerProduct( pl );
-				edge->side = FLOATSIGNBITSET(fl);
+				edgeMark->side = FLOATSIGNBITSET(fl);
 			}
 			// if the point passes the edge at the wrong side
 			//if ( (edgeNum > 0) == edge->side ) {
-			if ( INTSIGNBITSET(edgeNum) ^ edge->side ) {
+			if ( INTSIGNBITSET(edgeNum) ^ edgeMark->side ) {
 				return;
 			}
 		}
@@ -493,16 +498,19 @@ void idCollisionModelManagerLocal::TranslateVertexThroughTrmPolygon( cm_traceWor
 	int i, edgeNum;
 	float f;
 	cm_trmEdge_t *edge;
+	cm_queryMark_t *vertexMark;
 
 	f = CM_TranslationPlaneFraction( trmpoly->plane, v->p, endp );
 	if ( f < tw->trace.fraction ) {
 
+		vertexMark = tw->vertexMarks + ( v - tw->model->vertices );
+
 		for ( i = 0; i < trmpoly->numEdges; i++ ) {
 			edgeNum = trmpoly->edges[i];
 			edge = tw->edges + abs(edgeNum);
 
-			CM_SetVertexSidedness( v, pl, edge->pl, edge->bitNum );
-			if ( INTSIGNBITSET(edgeNum) ^ ((v->side >> edge->bitNum) & 1) ) {
+			CM_SetVertexSidedness( vertexMark, pl, edge->pl, edge->bitNum );
+			if ( INTSIGNBITSET(edgeNum) ^ ((vertexMark->side >> edge->bitNum) & 1) ) {
 				return;
 			}
 		}
@@ -543,12 +551,13 @@ bool idCollisionModelManagerLocal::TranslateTrmThroughPolygon( cm_traceWork_t *t
 	cm_trmPolygon_t *bp;
 	cm_vertex_t *v;
 	cm_edge_t *e;
+	cm_queryMark_t *vm;
 
 	// if already checked this polygon
-	if ( p->checkcount == idCollisionModelManagerLocal::checkCount ) {
+	if ( tw->polygonMarks[p->index] == tw->checkCount ) {
 		return false;
 	}
-	p->checkcount = idCollisionModelManagerLocal::checkCount;
+	tw->polygonMarks[p->index] = tw->checkCount;
 
 	// if this polygon does not have the right contents behind it
 	if ( !(p->contents & tw->contents) ) {
@@ -602,8 +611,8 @@ bool idCollisionModelManagerLocal::TranslateTrmThroughPolygon( cm_traceWork_t *t
 			edgeNum = p->edges[i];
 			e = tw->model->edges + abs(edgeNum);
 			// reset sidedness cache if this is the first time we encounter this edge during this trace
-			if ( e->checkcount != idCollisionModelManagerLocal::checkCount ) {
-				e->sideSet = 0;
+			if ( tw->edgeMarks[abs(edgeNum)].checkcount != tw->checkCount ) {
+				tw->edgeMarks[abs(edgeNum)].sideSet = 0;
 			}
 			// pluecker coordinate for edge
 			tw->polygonEdgePlueckerCache[i].FromLine( tw->model->vertices[e->vertexNum[0]].p,
@@ -611,8 +620,9 @@ bool idCollisionModelManagerLocal::TranslateTrmThroughPolygon( cm_traceWork_t *t
 
 			v = &tw->model->vertices[e->vertexNum[INTSIGNBITSET(edgeNum)]];
 			// reset sidedness cache if this is the first time we encounter this vertex during this trace
-			if ( v->checkcount != idCollisionModelManagerLocal::checkCount ) {
-				v->sideSet = 0;
+			vm = &tw->vertexMarks[e->vertexNum[INTSIGNBITSET(edgeNum)]];
+			if ( vm->checkcount != tw->checkCount ) {
+				vm->sideSet = 0;
 			}
 			// pluecker coordinate for vertex movement vector
 			tw->polygonVertexPlueckerCache[i].FromRay( v->p, -tw->dir );
@@ -641,11 +651,11 @@ bool idCollisionModelManagerLocal::TranslateTrmThroughPolygon( cm_traceWork_t *t
 			edgeNum = p->edges[i];
 			e = tw->model->edges + abs(edgeNum);
 
-			if ( e->checkcount == idCollisionModelManagerLocal::checkCount ) {
+			if ( tw->edgeMarks[abs(edgeNum)].checkcount == tw->checkCount ) {
 				continue;
 			}
 			// set edge check count
-			e->checkcount = idCollisionModelManagerLocal::checkCount;
+			tw->edgeMarks[abs(edgeNum)].checkcount = tw->checkCount;
 			// can never collide with internal edges
 			if ( e->internal ) {
 				continue;
@@ -654,12 +664,13 @@ bool idCollisionModelManagerLocal::TranslateTrmThroughPolygon( cm_traceWork_t *t
 			for ( k = 0; k < 2; k++ ) {
 
 				v = tw->model->vertices + e->vertexNum[k ^ INTSIGNBITSET(edgeNum)];
+				vm = tw->vertexMarks + e->vertexNum[k ^ INTSIGNBITSET(edgeNum)];
 				// if this vertex is already checked
-				if ( v->checkcount == idCollisionModelManagerLocal::checkCount ) {
+				if ( vm->checkcount == tw->checkCount ) {
 					continue;
 				}
 				// set vertex check count
-				v->checkcount = idCollisionModelManagerLocal::checkCount;
+				vm->checkcount = tw->checkCount;
 
 				// if the vertex is outside the trace bounds
 				if ( !tw->bounds.ContainsPoint( v->p ) ) {
@@ -756,85 +767,46 @@ void idCollisionModelManagerLocal::SetupTranslationHeartPlanes( cm_traceWork_t *
 
 /*
 ================
-idCollisionModelManagerLocal::Translation
+idCollisionModelManagerLocal::SetupTranslation
+
+  sets up the trace work for a translation in model space
+  returns false if the translation is not possible in which case the results are already set
 ================
 */
-#ifdef _DEBUG
-static int entered = 0;
-#endif
-
-void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &start, const idVec3 &end,
+bool idCollisionModelManagerLocal::SetupTranslation( cm_queryContext_t *context, cm_traceWork_t *tw, trace_t *results,
+										const idVec3 &start, const idVec3 &end,
 										const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
-										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
-
+										cm_model_t *cmodel, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
 	int i, j;
 	float dist;
-	bool model_rotated, trm_rotated;
-	idVec3 dir1, dir2, dir;
-	idMat3 invModelAxis, tmpAxis;
+	bool trm_rotated;
+	idVec3 dir;
+	idMat3 tmpAxis;
 	cm_trmPolygon_t *poly;
 	cm_trmEdge_t *edge;
 	cm_trmVertex_t *vert;
-	ALIGN16( static cm_traceWork_t tw );
-
-	assert( ((byte *)&start) < ((byte *)results) || ((byte *)&start) >= (((byte *)results) + sizeof( trace_t )) );
-	assert( ((byte *)&end) < ((byte *)results) || ((byte *)&end) >= (((byte *)results) + sizeof( trace_t )) );
-	assert( ((byte *)&trmAxis) < ((byte *)results) || ((byte *)&trmAxis) >= (((byte *)results) + sizeof( trace_t )) );
-
-	memset( results, 0, sizeof( *results ) );
-
-	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
-		common->Printf("idCollisionModelManagerLocal::Translation: invalid model handle\n");
-		return;
-	}
-	if ( !idCollisionModelManagerLocal::models[model] ) {
-		common->Printf("idCollisionModelManagerLocal::Translation: invalid model\n");
-		return;
-	}
-
-	// if case special position test
-	if ( start[0] == end[0] && start[1] == end[1] && start[2] == end[2] ) {
-		idCollisionModelManagerLocal::ContentsTrm( results, start, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
-		return;
-	}
 
-#ifdef _DEBUG
-	bool startsolid = false;
-	// test whether or not stuck to begin with
-	if ( cm_debugCollision.GetBool() ) {
-		if ( !entered && !idCollisionModelManagerLocal::getContacts ) {
-			entered = 1;
-			// if already messed up to begin with
-			if ( idCollisionModelManagerLocal::Contents( start, trm, trmAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
-				startsolid = true;
-			}
-			entered = 0;
-		}
-	}
-#endif
-
-	idCollisionModelManagerLocal::checkCount++;
-
-	tw.trace.fraction = 1.0f;
-	tw.trace.c.contents = 0;
-	tw.trace.c.type = CONTACT_NONE;
-	tw.contents = contentMask;
-	tw.isConvex = true;
-	tw.rotation = false;
-	tw.positionTest = false;
-	tw.quickExit = false;
-	tw.getContacts = idCollisionModelManagerLocal::getContacts;
-	tw.contacts = idCollisionModelManagerLocal::contacts;
-	tw.maxContacts = idCollisionModelManagerLocal::maxContacts;
-	tw.numContacts = 0;
-	tw.model = idCollisionModelManagerLocal::models[model];
-	tw.start = start - modelOrigin;
-	tw.end = end - modelOrigin;
-	tw.dir = end - start;
-
-	model_rotated = modelAxis.IsRotated();
-	if ( model_rotated ) {
-		invModelAxis = modelAxis.Transpose();
+	tw->trace.fraction = 1.0f;
+	tw->trace.c.contents = 0;
+	tw->trace.c.type = CONTACT_NONE;
+	tw->contents = contentMask;
+	tw->isConvex = true;
+	tw->rotation = false;
+	tw->positionTest = false;
+	tw->quickExit = false;
+	tw->getContacts = context->getContacts;
+	tw->contacts = context->contacts;
+	tw->maxContacts = context->maxContacts;
+	tw->numContacts = 0;
+	tw->model = cmodel;
+	idCollisionModelManagerLocal::SetupQueryMarks( context, tw );
+	tw->start = start - modelOrigin;
+	tw->end = end - modelOrigin;
+	tw->dir = end - start;
+
+	tw->modelRotated = modelAxis.IsRotated();
+	if ( tw->modelRotated ) {
+		tw->invModelAxis = modelAxis.Transpose();
 	}
 
 	// if optimized point trace
@@ -842,60 +814,43 @@ void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &
 					trm->bounds[1][1] - trm->bounds[0][1] <= 0.0f &&
 					trm->bounds[1][2] - trm->bounds[0][2] <= 0.0f ) ) {
 
-		if ( model_rotated ) {
+		if ( tw->modelRotated ) {
 			// rotate trace instead of model
-			tw.start *= invModelAxis;
-			tw.end *= invModelAxis;
-			tw.dir *= invModelAxis;
+			tw->start *= tw->invModelAxis;
+			tw->end *= tw->invModelAxis;
+			tw->dir *= tw->invModelAxis;
 		}
 
 		// trace bounds
 		for ( i = 0; i < 3; i++ ) {
-			if ( tw.start[i] < tw.end[i] ) {
-				tw.bounds[0][i] = tw.start[i] - CM_BOX_EPSILON;
-				tw.bounds[1][i] = tw.end[i] + CM_BOX_EPSILON;
+			if ( tw->start[i] < tw->end[i] ) {
+				tw->bounds[0][i] = tw->start[i] - CM_BOX_EPSILON;
+				tw->bounds[1][i] = tw->end[i] + CM_BOX_EPSILON;
 			}
 			else {
-				tw.bounds[0][i] = tw.end[i] - CM_BOX_EPSILON;
-				tw.bounds[1][i] = tw.start[i] + CM_BOX_EPSILON;
+				tw->bounds[0][i] = tw->end[i] - CM_BOX_EPSILON;
+				tw->bounds[1][i] = tw->start[i] + CM_BOX_EPSILON;
 			}
 		}
-		tw.extents[0] = tw.extents[1] = tw.extents[2] = CM_BOX_EPSILON;
-		tw.size.Zero();
+		tw->extents[0] = tw->extents[1] = tw->extents[2] = CM_BOX_EPSILON;
+		tw->size.Zero();
 
 		// setup trace heart planes
-		idCollisionModelManagerLocal::SetupTranslationHeartPlanes( &tw );
-		tw.maxDistFromHeartPlane1 = CM_BOX_EPSILON;
-		tw.maxDistFromHeartPlane2 = CM_BOX_EPSILON;
+		idCollisionModelManagerLocal::SetupTranslationHeartPlanes( tw );
+		tw->maxDistFromHeartPlane1 = CM_BOX_EPSILON;
+		tw->maxDistFromHeartPlane2 = CM_BOX_EPSILON;
 		// collision with single point
-		tw.numVerts = 1;
-		tw.vertices[0].p = tw.start;
-		tw.vertices[0].endp = tw.vertices[0].p + tw.dir;
-		tw.vertices[0].pl.FromRay( tw.vertices[0].p, tw.dir );
-		tw.numEdges = tw.numPolys = 0;
-		tw.pointTrace = true;
-		// trace through the model
-		idCollisionModelManagerLocal::TraceThroughModel( &tw );
-		// store results
-		*results = tw.trace;
-		results->endpos = start + results->fraction * (end - start);
-		results->endAxis = mat3_identity;
-
-		if ( results->fraction < 1.0f ) {
-			// rotate trace plane normal if there was a collision with a rotated model
-			if ( model_rotated ) {
-				results->c.normal *= modelAxis;
-				results->c.point *= modelAxis;
-			}
-			results->c.point += modelOrigin;
-			results->c.dist += modelOrigin * results->c.normal;
-		}
-		idCollisionModelManagerLocal::numContacts = tw.numContacts;
-		return;
+		tw->numVerts = 1;
+		tw->vertices[0].p = tw->start;
+		tw->vertices[0].endp = tw->vertices[0].p + tw->dir;
+		tw->vertices[0].pl.FromRay( tw->vertices[0].p, tw->dir );
+		tw->numEdges = tw->numPolys = 0;
+		tw->pointTrace = true;
+		return true;
 	}
 
 	// the trace fraction is too inaccurate to describe translations over huge distances
-	if ( tw.dir.LengthSqr() > Square( CM_MAX_TRACE_DIST ) ) {
+	if ( tw->dir.LengthSqr() > Square( CM_MAX_TRACE_DIST ) ) {
 		results->fraction = 0.0f;
 		results->endpos = start;
 		results->endAxis = trmAxis;
@@ -906,181 +861,211 @@ void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &
 			session->rw->DebugArrow( colorRed, start, end, 1 );
 		}
 		common->Printf( "idCollisionModelManagerLocal::Translation: huge translation\n" );
-		return;
+		return false;
 	}
 
-	tw.pointTrace = false;
-	tw.size.Clear();
+	tw->pointTrace = false;
+	tw->size.Clear();
 
 	// setup trm structure
-	idCollisionModelManagerLocal::SetupTrm( &tw, trm );
+	idCollisionModelManagerLocal::SetupTrm( tw, trm );
 
 	trm_rotated = trmAxis.IsRotated();
 
 	// calculate vertex positions
 	if ( trm_rotated ) {
-		for ( i = 0; i < tw.numVerts; i++ ) {
+		for ( i = 0; i < tw->numVerts; i++ ) {
 			// rotate trm around the start position
-			tw.vertices[i].p *= trmAxis;
+			tw->vertices[i].p *= trmAxis;
 		}
 	}
-	for ( i = 0; i < tw.numVerts; i++ ) {
+	for ( i = 0; i < tw->numVerts; i++ ) {
 		// set trm at start position
-		tw.vertices[i].p += tw.start;
+		tw->vertices[i].p += tw->start;
 	}
-	if ( model_rotated ) {
-		for ( i = 0; i < tw.numVerts; i++ ) {
+	if ( tw->modelRotated ) {
+		for ( i = 0; i < tw->numVerts; i++ ) {
 			// rotate trm around model instead of rotating the model
-			tw.vertices[i].p *= invModelAxis;
+			tw->vertices[i].p *= tw->invModelAxis;
 		}
 	}
 
 	// add offset to start point
 	if ( trm_rotated ) {
 		dir = trm->offset * trmAxis;
-		tw.start += dir;
-		tw.end += dir;
+		tw->start += dir;
+		tw->end += dir;
 	} else {
-		tw.start += trm->offset;
-		tw.end += trm->offset;
+		tw->start += trm->offset;
+		tw->end += trm->offset;
 	}
-	if ( model_rotated ) {
+	if ( tw->modelRotated ) {
 		// rotate trace instead of model
-		tw.start *= invModelAxis;
-		tw.end *= invModelAxis;
-		tw.dir *= invModelAxis;
+		tw->start *= tw->invModelAxis;
+		tw->end *= tw->invModelAxis;
+		tw->dir *= tw->invModelAxis;
 	}
 
 	// rotate trm polygon planes
-	if ( trm_rotated & model_rotated ) {
-		tmpAxis = trmAxis * invModelAxis;
-		for ( poly = tw.polys, i = 0; i < tw.numPolys; i++, poly++ ) {
+	if ( trm_rotated & tw->modelRotated ) {
+		tmpAxis = trmAxis * tw->invModelAxis;
+		for ( poly = tw->polys, i = 0; i < tw->numPolys; i++, poly++ ) {
 			poly->plane *= tmpAxis;
 		}
 	} else if ( trm_rotated ) {
-		for ( poly = tw.polys, i = 0; i < tw.numPolys; i++, poly++ ) {
+		for ( poly = tw->polys, i = 0; i < tw->numPolys; i++, poly++ ) {
 			poly->plane *= trmAxis;
 		}
-	} else if ( model_rotated ) {
-		for ( poly = tw.polys, i = 0; i < tw.numPolys; i++, poly++ ) {
-			poly->plane *= invModelAxis;
+	} else if ( tw->modelRotated ) {
+		for ( poly = tw->polys, i = 0; i < tw->numPolys; i++, poly++ ) {
+			poly->plane *= tw->invModelAxis;
 		}
 	}
 
 	// setup trm polygons
-	for ( poly = tw.polys, i = 0; i < tw.numPolys; i++, poly++ ) {
+	for ( poly = tw->polys, i = 0; i < tw->numPolys; i++, poly++ ) {
 		// if the trm poly plane is facing in the movement direction
-		dist = poly->plane.Normal() * tw.dir;
+		dist = poly->plane.Normal() * tw->dir;
 		if ( dist > 0.0f || ( !trm->isConvex && dist == 0.0f ) ) {
 			// this trm poly and it's edges and vertices need to be used for collision
 			poly->used = true;
 			for ( j = 0; j < poly->numEdges; j++ ) {
-				edge = &tw.edges[abs( poly->edges[j] )];
+				edge = &tw->edges[abs( poly->edges[j] )];
 				edge->used = true;
-				tw.vertices[edge->vertexNum[0]].used = true;
-				tw.vertices[edge->vertexNum[1]].used = true;
+				tw->vertices[edge->vertexNum[0]].used = true;
+				tw->vertices[edge->vertexNum[1]].used = true;
 			}
 		}
 	}
 
 	// setup trm vertices
-	for ( vert = tw.vertices, i = 0; i < tw.numVerts; i++, vert++ ) {
+	for ( vert = tw->vertices, i = 0; i < tw->numVerts; i++, vert++ ) {
 		if ( !vert->used ) {
 			continue;
 		}
 		// get axial trm size after rotations
-		tw.size.AddPoint( vert->p - tw.start );
+		tw->size.AddPoint( vert->p - tw->start );
 		// calculate the end position of each vertex for a full trace
-		vert->endp = vert->p + tw.dir;
+		vert->endp = vert->p + tw->dir;
 		// pluecker coordinate for vertex movement line
-		vert->pl.FromRay( vert->p, tw.dir );
+		vert->pl.FromRay( vert->p, tw->dir );
 	}
 
 	// setup trm edges
-	for ( edge = tw.edges + 1, i = 1; i <= tw.numEdges; i++, edge++ ) {
+	for ( edge = tw->edges + 1, i = 1; i <= tw->numEdges; i++, edge++ ) {
 		if ( !edge->used ) {
 			continue;
 		}
 		// edge start, end and pluecker coordinate
-		edge->start = tw.vertices[edge->vertexNum[0]].p;
-		edge->end = tw.vertices[edge->vertexNum[1]].p;
+		edge->start = tw->vertices[edge->vertexNum[0]].p;
+		edge->end = tw->vertices[edge->vertexNum[1]].p;
 		edge->pl.FromLine( edge->start, edge->end );
 		// calculate normal of plane through movement plane created by the edge
 		dir = edge->start - edge->end;
-		edge->cross[0] = dir[0] * tw.dir[1] - dir[1] * tw.dir[0];
-		edge->cross[1] = dir[0] * tw.dir[2] - dir[2] * tw.dir[0];
-		edge->cross[2] = dir[1] * tw.dir[2] - dir[2] * tw.dir[1];
+		edge->cross[0] = dir[0] * tw->dir[1] - dir[1] * tw->dir[0];
+		edge->cross[1] = dir[0] * tw->dir[2] - dir[2] * tw->dir[0];
+		edge->cross[2] = dir[1] * tw->dir[2] - dir[2] * tw->dir[1];
 		// bit for vertex sidedness bit cache
 		edge->bitNum = i;
 	}
 
 	// set trm plane distances
-	for ( poly = tw.polys, i = 0; i < tw.numPolys; i++, poly++ ) {
+	for ( poly = tw->polys, i = 0; i < tw->numPolys; i++, poly++ ) {
 		if ( poly->used ) {
-			poly->plane.FitThroughPoint( tw.edges[abs(poly->edges[0])].start );
+			poly->plane.FitThroughPoint( tw->edges[abs(poly->edges[0])].start );
 		}
 	}
 
 	// bounds for full trace, a little bit larger for epsilons
 	for ( i = 0; i < 3; i++ ) {
-		if ( tw.start[i] < tw.end[i] ) {
-			tw.bounds[0][i] = tw.start[i] + tw.size[0][i] - CM_BOX_EPSILON;
-			tw.bounds[1][i] = tw.end[i] + tw.size[1][i] + CM_BOX_EPSILON;
+		if ( tw->start[i] < tw->end[i] ) {
+			tw->bounds[0][i] = tw->start[i] + tw->size[0][i] - CM_BOX_EPSILON;
+			tw->bounds[1][i] = tw->end[i] + tw->size[1][i] + CM_BOX_EPSILON;
 		} else {
-			tw.bounds[0][i] = tw.end[i] + tw.size[0][i] - CM_BOX_EPSILON;
-			tw.bounds[1][i] = tw.start[i] + tw.size[1][i] + CM_BOX_EPSILON;
+			tw->bounds[0][i] = tw->end[i] + tw->size[0][i] - CM_BOX_EPSILON;
+			tw->bounds[1][i] = tw->start[i] + tw->size[1][i] + CM_BOX_EPSILON;
 		}
-		if ( idMath::Fabs( tw.size[0][i] ) > idMath::Fabs( tw.size[1][i] ) ) {
-			tw.extents[i] = idMath::Fabs( tw.size[0][i] ) + CM_BOX_EPSILON;
+		if ( idMath::Fabs( tw->size[0][i] ) > idMath::Fabs( tw->size[1][i] ) ) {
+			tw->extents[i] = idMath::Fabs( tw->size[0][i] ) + CM_BOX_EPSILON;
 		} else {
-			tw.extents[i] = idMath::Fabs( tw.size[1][i] ) + CM_BOX_EPSILON;
+			tw->extents[i] = idMath::Fabs( tw->size[1][i] ) + CM_BOX_EPSILON;
 		}
 	}
 
 	// setup trace heart planes
-	idCollisionModelManagerLocal::SetupTranslationHeartPlanes( &tw );
-	tw.maxDistFromHeartPlane1 = 0;
-	tw.maxDistFromHeartPlane2 = 0;
+	idCollisionModelManagerLocal::SetupTranslationHeartPlanes( tw );
+	tw->maxDistFromHeartPlane1 = 0;
+	tw->maxDistFromHeartPlane2 = 0;
 	// calculate maximum trm vertex distance from both heart planes
-	for ( vert = tw.vertices, i = 0; i < tw.numVerts; i++, vert++ ) {
+	for ( vert = tw->vertices, i = 0; i < tw->numVerts; i++, vert++ ) {
 		if ( !vert->used ) {
 			continue;
 		}
-		dist = idMath::Fabs( tw.heartPlane1.Distance( vert->p ) );
-		if ( dist > tw.maxDistFromHeartPlane1 ) {
-			tw.maxDistFromHeartPlane1 = dist;
+		dist = idMath::Fabs( tw->heartPlane1.Distance( vert->p ) );
+		if ( dist > tw->maxDistFromHeartPlane1 ) {
+			tw->maxDistFromHeartPlane1 = dist;
 		}
-		dist = idMath::Fabs( tw.heartPlane2.Distance( vert->p ) );
-		if ( dist > tw.maxDistFromHeartPlane2 ) {
-			tw.maxDistFromHeartPlane2 = dist;
+		dist = idMath::Fabs( tw->heartPlane2.Distance( vert->p ) );
+		if ( dist > tw->maxDistFromHeartPlane2 ) {
+			tw->maxDistFromHeartPlane2 = dist;
 		}
 	}
 	// for epsilons
-	tw.maxDistFromHeartPlane1 += CM_BOX_EPSILON;
-	tw.maxDistFromHeartPlane2 += CM_BOX_EPSILON;
+	tw->maxDistFromHeartPlane1 += CM_BOX_EPSILON;
+	tw->maxDistFromHeartPlane2 += CM_BOX_EPSILON;
+	return true;
+}
 
-	// trace through the model
-	idCollisionModelManagerLocal::TraceThroughModel( &tw );
+/*
+================
+idCollisionModelManagerLocal::FinishTranslation
+
+  moves the trace results or contacts back from model space to world space
+================
+*/
+void idCollisionModelManagerLocal::FinishTranslation( cm_queryContext_t *context, cm_traceWork_t *tw, trace_t *results,
+										const idVec3 &start, const idVec3 &end, const idMat3 &trmAxis,
+										const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
+	int i;
+
+	if ( tw->pointTrace ) {
+		// store results
+		*results = tw->trace;
+		results->endpos = start + results->fraction * (end - start);
+		results->endAxis = mat3_identity;
+
+		if ( results->fraction < 1.0f ) {
+			// rotate trace plane normal if there was a collision with a rotated model
+			if ( tw->modelRotated ) {
+				results->c.normal *= modelAxis;
+				results->c.point *= modelAxis;
+			}
+			results->c.point += modelOrigin;
+			results->c.dist += modelOrigin * results->c.normal;
+		}
+		context->numContacts = tw->numContacts;
+		return;
+	}
 
 	// if we're getting contacts
-	if ( tw.getContacts ) {
+	if ( tw->getContacts ) {
 		// move all contacts to world space
-		if ( model_rotated ) {
-			for ( i = 0; i < tw.numContacts; i++ ) {
-				tw.contacts[i].normal *= modelAxis;
-				tw.contacts[i].point *= modelAxis;
+		if ( tw->modelRotated ) {
+			for ( i = 0; i < tw->numContacts; i++ ) {
+				tw->contacts[i].normal *= modelAxis;
+				tw->contacts[i].point *= modelAxis;
 			}
 		}
 		if ( modelOrigin != vec3_origin ) {
-			for ( i = 0; i < tw.numContacts; i++ ) {
-				tw.contacts[i].point += modelOrigin;
-				tw.contacts[i].dist += modelOrigin * tw.contacts[i].normal;
+			for ( i = 0; i < tw->numContacts; i++ ) {
+				tw->contacts[i].point += modelOrigin;
+				tw->contacts[i].dist += modelOrigin * tw->contacts[i].normal;
 			}
 		}
-		idCollisionModelManagerLocal::numContacts = tw.numContacts;
+		context->numContacts = tw->numContacts;
 	} else {
 		// store results
-		*results = tw.trace;
+		*results = tw->trace;
 		results->endpos = start + results->fraction * ( end - start );
 		results->endAxis = trmAxis;
 
@@ -1090,7 +1075,7 @@ void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &
 				results->fraction = 0.0f;
 			}
 			// rotate trace plane normal if there was a collision with a rotated model
-			if ( model_rotated ) {
+			if ( tw->modelRotated ) {
 				results->c.normal *= modelAxis;
 				results->c.point *= modelAxis;
 			}
@@ -1098,12 +1083,78 @@ void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &
 			results->c.dist += modelOrigin * results->c.normal;
 		}
 	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::Translation
+================
+*/
+void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &start, const idVec3 &end,
+										const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
+										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
+
+	cm_queryContext_t *context;
+	cm_model_t *cmodel;
+
+	assert( ((byte *)&start) < ((byte *)results) || ((byte *)&start) >= (((byte *)results) + sizeof( trace_t )) );
+	assert( ((byte *)&end) < ((byte *)results) || ((byte *)&end) >= (((byte *)results) + sizeof( trace_t )) );
+	assert( ((byte *)&trmAxis) < ((byte *)results) || ((byte *)&trmAxis) >= (((byte *)results) + sizeof( trace_t )) );
+
+	memset( results, 0, sizeof( *results ) );
+
+	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
+		common->Printf("idCollisionModelManagerLocal::Translation: invalid model handle\n");
+		return;
+	}
+	context = idCollisionModelManagerLocal::GetQueryContext();
+	cmodel = idCollisionModelManagerLocal::ModelForHandle( model );
+	if ( !cmodel ) {
+		common->Printf("idCollisionModelManagerLocal::Translation: invalid model\n");
+		return;
+	}
+
+	// if case special position test
+	if ( start[0] == end[0] && start[1] == end[1] && start[2] == end[2] ) {
+		idCollisionModelManagerLocal::ContentsTrm( context, results, start, trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis );
+		return;
+	}
+
+#ifdef _DEBUG
+	bool startsolid = false;
+	// test whether or not stuck to begin with
+	if ( cm_debugCollision.GetBool() ) {
+		if ( !context->debugEntered && !context->getContacts ) {
+			context->debugEntered = 1;
+			// if already messed up to begin with
+			if ( idCollisionModelManagerLocal::Contents( start, trm, trmAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
+				startsolid = true;
+			}
+			context->debugEntered = 0;
+		}
+	}
+#endif
+
+	cm_traceWork_t &tw = *context->translationWork;
+
+	if ( !idCollisionModelManagerLocal::SetupTranslation( context, &tw, results, start, end, trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis ) ) {
+		return;
+	}
+
+	// trace through the model
+	idCollisionModelManagerLocal::TraceThroughModel( &tw );
+
+	idCollisionModelManagerLocal::FinishTranslation( context, &tw, results, start, end, trmAxis, modelOrigin, modelAxis );
+
+	if ( tw.pointTrace ) {
+		return;
+	}
 
 #ifdef _DEBUG
 	// test for missed collisions
 	if ( cm_debugCollision.GetBool() ) {
-		if ( !entered && !idCollisionModelManagerLocal::getContacts ) {
-			entered = 1;
+		if ( !context->debugEntered && !context->getContacts ) {
+			context->debugEntered = 1;
 			// if the trm is stuck in the model
 			if ( idCollisionModelManagerLocal::Contents( results->endpos, trm, trmAxis, -1, model, modelOrigin, modelAxis ) & contentMask ) {
 				trace_t tr;
@@ -1113,8 +1164,100 @@ void idCollisionModelManagerLocal::Translation( trace_t *results, const idVec3 &
 				// re-run collision detection to find out where it failed
 				idCollisionModelManagerLocal::Translation( &tr, start, end, trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
 			}
-			entered = 0;
+			context->debugEntered = 0;
 		}
 	}
 #endif
 }
+
+/*
+================
+idCollisionModelManagerLocal::TranslationBatch
+
+  All traces of the batch share a single walk of the spatial subdivision.
+  The polygons touching the bounds of the whole packet are gathered once and
+  every trace only runs the exact tests on the polygons its own bounds overlap.
+================
+*/
+void idCollisionModelManagerLocal::TranslationBatch( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numTraces,
+										const idTraceModel *trm, const idMat3 &trmAxis, int contentMask,
+										cmHandle_t model, const idVec3 &modelOrigin, const idMat3 &modelAxis ) {
+	int i;
+	idBounds bounds, traceBounds;
+	cm_queryContext_t *context;
+	cm_model_t *cmodel;
+
+	if ( numTraces <= 0 ) {
+		return;
+	}
+
+	if ( model < 0 || model > MAX_SUBMODELS || model > idCollisionModelManagerLocal::maxModels ) {
+		common->Printf("idCollisionModelManagerLocal::TranslationBatch: invalid model handle\n");
+		memset( results, 0, numTraces * sizeof( results[0] ) );
+		return;
+	}
+	context = idCollisionModelManagerLocal::GetQueryContext();
+	cmodel = idCollisionModelManagerLocal::ModelForHandle( model );
+	if ( !cmodel ) {
+		common->Printf("idCollisionModelManagerLocal::TranslationBatch: invalid model\n");
+		memset( results, 0, numTraces * sizeof( results[0] ) );
+		return;
+	}
+
+	// a single trace or contact retrieval gains nothing from a packet
+	if ( numTraces == 1 || context->getContacts || !cm_packetTraces.GetBool() ) {
+		for ( i = 0; i < numTraces; i++ ) {
+			idCollisionModelManagerLocal::Translation( &results[i], starts[i], ends[i], trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
+		}
+		return;
+	}
+
+	// bounds of the whole packet in world space
+	bounds.Clear();
+	for ( i = 0; i < numTraces; i++ ) {
+		if ( !trm ) {
+			traceBounds.FromPointTranslation( starts[i], ends[i] - starts[i] );
+		} else {
+			traceBounds.FromBoundsTranslation( trm->bounds, starts[i], trmAxis, ends[i] - starts[i] );
+		}
+		bounds += traceBounds;
+	}
+	bounds.ExpandSelf( CM_BOX_EPSILON );
+
+	// move the packet bounds into model space
+	if ( modelAxis.IsRotated() ) {
+		bounds.FromTransformedBounds( bounds.Translate( -modelOrigin ), vec3_origin, modelAxis.Transpose() );
+	} else {
+		bounds.TranslateSelf( -modelOrigin );
+	}
+
+	// walk the spatial subdivision once for all traces
+	if ( !idCollisionModelManagerLocal::GatherPacketPolygons( context, cmodel, bounds, contentMask ) ) {
+		// the traces are too far apart to share the polygons
+		for ( i = 0; i < numTraces; i++ ) {
+			idCollisionModelManagerLocal::Translation( &results[i], starts[i], ends[i], trm, trmAxis, contentMask, model, modelOrigin, modelAxis );
+		}
+		return;
+	}
+
+	cm_traceWork_t &tw = *context->translationWork;
+
+	for ( i = 0; i < numTraces; i++ ) {
+		memset( &results[i], 0, sizeof( results[i] ) );
+
+		// if case special position test
+		if ( starts[i][0] == ends[i][0] && starts[i][1] == ends[i][1] && starts[i][2] == ends[i][2] ) {
+			idCollisionModelManagerLocal::ContentsTrm( context, &results[i], starts[i], trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis );
+			continue;
+		}
+
+		if ( !idCollisionModelManagerLocal::SetupTranslation( context, &tw, &results[i], starts[i], ends[i], trm, trmAxis, contentMask, cmodel, modelOrigin, modelAxis ) ) {
+			continue;
+		}
+
+		// trace through the polygons of the packet
+		idCollisionModelManagerLocal::TraceThroughPacket( context, &tw );
+
+		idCollisionModelManagerLocal::FinishTranslation( context, &tw, &results[i], starts[i], ends[i], trmAxis, modelOrigin, modelAxis );
+	}
+}
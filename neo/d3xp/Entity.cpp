@@ -1522,6 +1522,10 @@ idEntity::UpdateRenderEntity
 ================
 */
 bool idEntity::UpdateRenderEntity( renderEntity_s *renderEntity, const renderView_t *renderView ) {
+	int			numJoints;
+	idJointMat	*joints;
+	bool		changed;
+
 	if ( gameLocal.inCinematic && gameLocal.skipCinematic ) {
 		return false;
 	}
@@ -1532,7 +1536,16 @@ bool idEntity::UpdateRenderEntity( renderEntity_s *renderEntity, const renderVie
 		SetTimeState ts( timeGroup );
 #endif
 
-		return animator->CreateFrame( gameLocal.time, false );
+		changed = animator->CreateFrame( gameLocal.time, false, true );
+		if ( animator->CreatedFrameAhead() ) {
+			changed = true;
+		}
+
+		// the serial is only valid for the joints of the animator
+		animator->GetJoints( &numJoints, &joints );
+		renderEntity->jointsSerial = ( renderEntity->joints == joints ) ? animator->GetJointsSerial() : 0;
+
+		return changed;
 	}
 
 	return false;
@@ -2618,6 +2631,7 @@ bool idEntity::RunPhysics( void ) {
 	idEntity *	part, *blockedPart, *blockingEntity;
 	trace_t		results;
 	bool		moved;
+	idGameTiming	timing( GAME_TIMING_PHYSICS );
 
 	// don't run physics if not enabled
 	if ( !( thinkFlags & TH_PHYSICS ) ) {
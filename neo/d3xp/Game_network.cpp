@@ -1553,6 +1553,9 @@ gameReturn_t idGameLocal::ClientPrediction( int clientNum, const usercmd_t *clie
 	// service any pending events
 	idEvent::ServiceEvents();
 
+	// remove the clip models that were unlinked this frame from the clip model tree
+	clip.RemoveUnlinkedLeaves();
+
 	// show any debug info for this frame
 	if ( isNewFrame ) {
 		RunDebugInfo();
@@ -39,6 +39,9 @@ If you have questions concerning this license or the applicable additional terms
 
 #define LEDGE_TRAVELTIME_PANALTY	250
 
+// the goal area of an area cache has no travel times within the area when the cache is repaired
+static unsigned short repairStartAreaTravelTimes[MAX_REACH_PER_AREA];
+
 /*
 ============
 idRoutingCache::idRoutingCache
@@ -50,6 +53,8 @@ idRoutingCache::idRoutingCache( int size ) {
 	next = prev = NULL;
 	time_next = time_prev = NULL;
 	travelFlags = 0;
+	dirty = true;
+	repair = false;
 	startTravelTime = 0;
 	type = 0;
 	this->size = size;
@@ -210,8 +215,13 @@ void idAASLocal::SetupRoutingCache( void ) {
 
 	goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( unsigned short ) );
 
+	// the update memory for the job threads is allocated the first time caches are calculated in parallel
+	memset( threadAreaUpdate, 0, sizeof( threadAreaUpdate ) );
+	memset( threadPortalUpdate, 0, sizeof( threadPortalUpdate ) );
+
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
+	cacheDirty = false;
 }
 
 /*
@@ -250,6 +260,40 @@ void idAASLocal::DeletePortalCache( void ) {
 	}
 }
 
+/*
+============
+idAASLocal::InvalidateClusterCache
+============
+*/
+void idAASLocal::InvalidateClusterCache( int clusterNum ) {
+	int i;
+	idRoutingCache *cache;
+
+	for ( i = 0; i < file->GetCluster( clusterNum ).numReachableAreas; i++ ) {
+		for ( cache = areaCacheIndex[clusterNum][i]; cache; cache = cache->next ) {
+			cache->dirty = true;
+		}
+	}
+	cacheDirty = true;
+}
+
+/*
+============
+idAASLocal::InvalidatePortalCache
+============
+*/
+void idAASLocal::InvalidatePortalCache( void ) {
+	int i;
+	idRoutingCache *cache;
+
+	for ( i = 0; i < file->GetNumAreas(); i++ ) {
+		for ( cache = portalCacheIndex[i]; cache; cache = cache->next ) {
+			cache->dirty = true;
+		}
+	}
+	cacheDirty = true;
+}
+
 /*
 ============
 idAASLocal::ShutdownRoutingCache
@@ -276,9 +320,18 @@ void idAASLocal::ShutdownRoutingCache( void ) {
 	portalUpdate = NULL;
 	Mem_Free( goalAreaTravelTimes );
 	goalAreaTravelTimes = NULL;
+	for ( i = 0; i < MAX_JOB_THREADS; i++ ) {
+		Mem_Free( threadAreaUpdate[i] );
+		threadAreaUpdate[i] = NULL;
+		Mem_Free( threadPortalUpdate[i] );
+		threadPortalUpdate[i] = NULL;
+	}
 
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
+	cacheDirty = false;
+	cacheUpdateList.Clear();
+	changedAreas.Clear();
 }
 
 /*
@@ -289,6 +342,8 @@ idAASLocal::SetupRouting
 bool idAASLocal::SetupRouting( void ) {
 	CalculateAreaTravelTimes();
 	SetupRoutingCache();
+	// every route between clusters uses the cache of the portal areas, create them for the default monster travel flags
+	CreatePortalAreaCaches( TFL_WALK|TFL_AIR );
 	return true;
 }
 
@@ -334,23 +389,17 @@ void idAASLocal::RoutingStats( void ) const {
 
 /*
 ============
-idAASLocal::RemoveRoutingCacheUsingArea
+idAASLocal::InvalidateRoutingCacheUsingArea
+
+  The area is only remembered here. Before the next route is calculated the area
+  cache of the clusters the area is in is repaired on the job threads, which only
+  recalculates the travel times of the areas that route through a changed area
+  or can now be reached through one. The portal cache is cheap and recalculated.
 ============
 */
-void idAASLocal::RemoveRoutingCacheUsingArea( int areaNum ) {
-	int clusterNum;
-
-	clusterNum = file->GetArea( areaNum ).cluster;
-	if ( clusterNum > 0 ) {
-		// remove all the cache in the cluster the area is in
-		DeleteClusterCache( clusterNum );
-	}
-	else {
-		// if this is a portal remove all cache in both the front and back cluster
-		DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[0] );
-		DeleteClusterCache( file->GetPortal( -clusterNum ).clusters[1] );
-	}
-	DeletePortalCache();
+void idAASLocal::InvalidateRoutingCacheUsingArea( int areaNum ) {
+	changedAreas.AddUnique( areaNum );
+	InvalidatePortalCache();
 }
 
 /*
@@ -367,7 +416,7 @@ void idAASLocal::DisableArea( int areaNum ) {
 
 	file->SetAreaTravelFlag( areaNum, TFL_INVALID );
 
-	RemoveRoutingCacheUsingArea( areaNum );
+	InvalidateRoutingCacheUsingArea( areaNum );
 }
 
 /*
@@ -384,7 +433,7 @@ void idAASLocal::EnableArea( int areaNum ) {
 
 	file->RemoveAreaTravelFlag( areaNum, TFL_INVALID );
 
-	RemoveRoutingCacheUsingArea( areaNum );
+	InvalidateRoutingCacheUsingArea( areaNum );
 }
 
 /*
@@ -488,7 +537,7 @@ void idAASLocal::SetObstacleState( const idRoutingObstacle *obstacle, bool enabl
 
 	for ( i = 0; i < obstacle->areas.Num(); i++ ) {
 
-		RemoveRoutingCacheUsingArea( obstacle->areas[i] );
+		InvalidateRoutingCacheUsingArea( obstacle->areas[i] );
 
 		area = &file->GetArea( obstacle->areas[i] );
 
@@ -708,16 +757,20 @@ ID_INLINE int idAASLocal::ClusterAreaNum( int clusterNum, int areaNum ) const {
 idAASLocal::UpdateAreaRoutingCache
 ============
 */
-void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
-	int i, nextAreaNum, cluster, badTravelFlags, clusterAreaNum, numReachableAreas;
-	unsigned short t, startAreaTravelTimes[MAX_REACH_PER_AREA];
-	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
-	idReachability *reach;
-	const aasArea_t *nextArea;
+void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *updates ) const {
+	int clusterAreaNum, numReachableAreas;
+	unsigned short startAreaTravelTimes[MAX_REACH_PER_AREA];
+	idRoutingUpdate *curUpdate;
 
 	// number of reachability areas within this cluster
 	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
 
+	// start from scratch when recalculating the cache
+	memset( areaCache->travelTimes, 0, areaCache->size * sizeof( areaCache->travelTimes[0] ) );
+	memset( areaCache->reachabilities, 0, areaCache->size * sizeof( areaCache->reachabilities[0] ) );
+	areaCache->dirty = false;
+	areaCache->repair = false;
+
 	// number of the start area within the cluster
 	clusterAreaNum = ClusterAreaNum( areaCache->cluster, areaCache->areaNum );
 	if ( clusterAreaNum >= numReachableAreas ) {
@@ -725,18 +778,35 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 	}
 
 	areaCache->travelTimes[clusterAreaNum] = areaCache->startTravelTime;
-	badTravelFlags = ~areaCache->travelFlags;
 	memset( startAreaTravelTimes, 0, sizeof( startAreaTravelTimes ) );
 
 	// initialize first update
-	curUpdate = &areaUpdate[clusterAreaNum];
+	curUpdate = &updates[clusterAreaNum];
 	curUpdate->areaNum = areaCache->areaNum;
 	curUpdate->areaTravelTimes = startAreaTravelTimes;
 	curUpdate->tmpTravelTime = areaCache->startTravelTime;
 	curUpdate->next = NULL;
 	curUpdate->prev = NULL;
-	updateListStart = curUpdate;
-	updateListEnd = curUpdate;
+
+	FloodAreaRoutingCache( areaCache, updates, curUpdate, curUpdate );
+}
+
+/*
+============
+idAASLocal::FloodAreaRoutingCache
+
+  Floods the travel times through the cluster starting with the areas in the update list.
+============
+*/
+void idAASLocal::FloodAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *updates, idRoutingUpdate *updateListStart, idRoutingUpdate *updateListEnd ) const {
+	int i, nextAreaNum, cluster, badTravelFlags, clusterAreaNum, numReachableAreas;
+	unsigned short t;
+	idRoutingUpdate *curUpdate, *nextUpdate;
+	idReachability *reach;
+	const aasArea_t *nextArea;
+
+	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
+	badTravelFlags = ~areaCache->travelFlags;
 
 	// while there are updates in the list
 	while( updateListStart ) {
@@ -791,7 +861,7 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 
 				areaCache->travelTimes[clusterAreaNum] = t;
 				areaCache->reachabilities[clusterAreaNum] = reach->number; // reversed reachability used to get into this area
-				nextUpdate = &areaUpdate[clusterAreaNum];
+				nextUpdate = &updates[clusterAreaNum];
 				nextUpdate->areaNum = nextAreaNum;
 				nextUpdate->tmpTravelTime = t;
 				nextUpdate->areaTravelTimes = reach->areaTravelTimes;
@@ -823,10 +893,220 @@ void idAASLocal::UpdateAreaRoutingCache( idRoutingCache *areaCache ) const {
 
 /*
 ============
-idAASLocal::GetAreaRoutingCache
+idAASLocal::CacheContainsArea
 ============
 */
-idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
+bool idAASLocal::CacheContainsArea( const idRoutingCache *areaCache, int areaNum ) const {
+	int areaCluster;
+	const aasPortal_t *portal;
+
+	areaCluster = file->GetArea( areaNum ).cluster;
+	if ( areaCluster > 0 ) {
+		return ( areaCluster == areaCache->cluster );
+	}
+	portal = &file->GetPortal( -areaCluster );
+	return ( portal->clusters[0] == areaCache->cluster || portal->clusters[1] == areaCache->cluster );
+}
+
+/*
+============
+idAASLocal::AddRepairUpdate
+
+  Adds an area with a valid travel time to the update list to flood the travel times from.
+============
+*/
+void idAASLocal::AddRepairUpdate( idRoutingCache *areaCache, idRoutingUpdate *updates, int areaNum, idRoutingUpdate *&updateListStart, idRoutingUpdate *&updateListEnd ) const {
+	int clusterAreaNum;
+	idRoutingUpdate *update;
+
+	if ( !CacheContainsArea( areaCache, areaNum ) ) {
+		return;
+	}
+	clusterAreaNum = ClusterAreaNum( areaCache->cluster, areaNum );
+	if ( clusterAreaNum >= file->GetCluster( areaCache->cluster ).numReachableAreas || !areaCache->travelTimes[clusterAreaNum] ) {
+		return;
+	}
+	update = &updates[clusterAreaNum];
+	if ( update->isInList ) {
+		return;
+	}
+
+	update->areaNum = areaNum;
+	update->tmpTravelTime = areaCache->travelTimes[clusterAreaNum];
+	if ( areaNum == areaCache->areaNum ) {
+		update->areaTravelTimes = repairStartAreaTravelTimes;
+	} else {
+		update->areaTravelTimes = GetAreaReachability( areaNum, areaCache->reachabilities[clusterAreaNum] )->areaTravelTimes;
+		// same ledge penalty as when the travel time was calculated
+		if ( ( ~areaCache->travelFlags & TFL_FLY ) && ( file->GetArea( areaNum ).flags & AREA_LEDGE ) ) {
+			update->tmpTravelTime += LEDGE_TRAVELTIME_PANALTY;
+		}
+	}
+
+	update->next = NULL;
+	update->prev = updateListEnd;
+	if ( updateListEnd ) {
+		updateListEnd->next = update;
+	} else {
+		updateListStart = update;
+	}
+	updateListEnd = update;
+	update->isInList = true;
+}
+
+/*
+============
+idAASLocal::RemoveRepairRoute
+
+  Removes the travel time of an area that routes through an area or reachability that can no longer be used.
+============
+*/
+void idAASLocal::RemoveRepairRoute( idRoutingCache *areaCache, idRoutingUpdate *updates, int areaNum, int clusterAreaNum, idRoutingUpdate *&removedListStart, idRoutingUpdate *&removedListEnd ) const {
+	idRoutingUpdate *update;
+
+	areaCache->travelTimes[clusterAreaNum] = 0;
+	areaCache->reachabilities[clusterAreaNum] = 0;
+
+	update = &updates[clusterAreaNum];
+	update->areaNum = areaNum;
+	update->next = NULL;
+	if ( removedListEnd ) {
+		removedListEnd->next = update;
+	} else {
+		removedListStart = update;
+	}
+	removedListEnd = update;
+}
+
+/*
+============
+idAASLocal::RepairAreaRoutingCache
+
+  Repairs the travel times after the areas in the changedAreas list were enabled or
+  disabled or the reachabilities into them were blocked by an obstacle. Only the
+  areas with a route through such an area or reachability lose their travel time.
+  The travel times are then flooded in again from the areas around the removed
+  routes and from the changed areas, which also propagates any shorter routes
+  through an area that was enabled. The repaired cache may use a different route
+  of similar travel time than a complete recalculation would.
+============
+*/
+void idAASLocal::RepairAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *updates ) const {
+	int i, areaNum, nextAreaNum, clusterAreaNum, goalClusterAreaNum, numReachableAreas, badTravelFlags;
+	idRoutingUpdate *removedListStart, *removedListEnd, *updateListStart, *updateListEnd, *curUpdate;
+	idReachability *reach;
+	bool areaDisabled;
+
+	areaCache->repair = false;
+
+	numReachableAreas = file->GetCluster( areaCache->cluster ).numReachableAreas;
+	goalClusterAreaNum = ClusterAreaNum( areaCache->cluster, areaCache->areaNum );
+	if ( goalClusterAreaNum >= numReachableAreas ) {
+		return;
+	}
+	badTravelFlags = ~areaCache->travelFlags;
+
+	removedListStart = removedListEnd = NULL;
+
+	// remove the routes that start with a changed area or with a reachability into a changed area that can no longer be used
+	for ( i = 0; i < changedAreas.Num(); i++ ) {
+		areaNum = changedAreas[i];
+		if ( !CacheContainsArea( areaCache, areaNum ) ) {
+			continue;
+		}
+		clusterAreaNum = ClusterAreaNum( areaCache->cluster, areaNum );
+		// no route goes through an area that cannot be reached
+		if ( clusterAreaNum >= numReachableAreas || !areaCache->travelTimes[clusterAreaNum] ) {
+			continue;
+		}
+		areaDisabled = ( clusterAreaNum != goalClusterAreaNum && ( file->GetArea( areaNum ).travelFlags & badTravelFlags ) != 0 );
+		if ( areaDisabled ) {
+			RemoveRepairRoute( areaCache, updates, areaNum, clusterAreaNum, removedListStart, removedListEnd );
+		} else {
+			for ( reach = file->GetArea( areaNum ).rev_reach; reach; reach = reach->rev_next ) {
+				if ( !( reach->travelType & badTravelFlags ) ) {
+					continue;
+				}
+				nextAreaNum = reach->fromAreaNum;
+				if ( !CacheContainsArea( areaCache, nextAreaNum ) ) {
+					continue;
+				}
+				clusterAreaNum = ClusterAreaNum( areaCache->cluster, nextAreaNum );
+				if ( clusterAreaNum >= numReachableAreas || clusterAreaNum == goalClusterAreaNum || !areaCache->travelTimes[clusterAreaNum] ) {
+					continue;
+				}
+				if ( areaCache->reachabilities[clusterAreaNum] == reach->number ) {
+					RemoveRepairRoute( areaCache, updates, nextAreaNum, clusterAreaNum, removedListStart, removedListEnd );
+				}
+			}
+		}
+	}
+
+	// remove the routes of all the areas that route through an area with a removed route
+	for ( curUpdate = removedListStart; curUpdate; curUpdate = curUpdate->next ) {
+		for ( reach = file->GetArea( curUpdate->areaNum ).rev_reach; reach; reach = reach->rev_next ) {
+			nextAreaNum = reach->fromAreaNum;
+			if ( !CacheContainsArea( areaCache, nextAreaNum ) ) {
+				continue;
+			}
+			clusterAreaNum = ClusterAreaNum( areaCache->cluster, nextAreaNum );
+			if ( clusterAreaNum >= numReachableAreas || clusterAreaNum == goalClusterAreaNum || !areaCache->travelTimes[clusterAreaNum] ) {
+				continue;
+			}
+			if ( areaCache->reachabilities[clusterAreaNum] == reach->number ) {
+				RemoveRepairRoute( areaCache, updates, nextAreaNum, clusterAreaNum, removedListStart, removedListEnd );
+			}
+		}
+	}
+
+	updateListStart = updateListEnd = NULL;
+
+	// flood in again from the areas the removed routes can continue through
+	for ( curUpdate = removedListStart; curUpdate; curUpdate = curUpdate->next ) {
+		for ( reach = file->GetArea( curUpdate->areaNum ).reach; reach; reach = reach->next ) {
+			AddRepairUpdate( areaCache, updates, reach->toAreaNum, updateListStart, updateListEnd );
+		}
+	}
+
+	// flood from the changed areas and the areas they lead to for routes that became available
+	for ( i = 0; i < changedAreas.Num(); i++ ) {
+		areaNum = changedAreas[i];
+		AddRepairUpdate( areaCache, updates, areaNum, updateListStart, updateListEnd );
+		for ( reach = file->GetArea( areaNum ).reach; reach; reach = reach->next ) {
+			AddRepairUpdate( areaCache, updates, reach->toAreaNum, updateListStart, updateListEnd );
+		}
+	}
+
+	if ( updateListStart ) {
+		FloodAreaRoutingCache( areaCache, updates, updateListStart, updateListEnd );
+	}
+}
+
+/*
+============
+idAASLocal::FindAreaRoutingCache
+============
+*/
+idRoutingCache *idAASLocal::FindAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
+	idRoutingCache *cache;
+
+	// check if cache without undesired travel flags already exists
+	for ( cache = areaCacheIndex[clusterNum][ClusterAreaNum( clusterNum, areaNum )]; cache; cache = cache->next ) {
+		if ( cache->travelFlags == travelFlags ) {
+			return cache;
+		}
+	}
+	return NULL;
+}
+
+/*
+============
+idAASLocal::AllocAreaRoutingCache
+
+  the cache is added to the area cache index but the travel times still have to be calculated
+============
+*/
+idRoutingCache *idAASLocal::AllocAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
 	int clusterAreaNum;
 	idRoutingCache *cache, *clusterCache;
 
@@ -834,27 +1114,35 @@ idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, in
 	clusterAreaNum = ClusterAreaNum( clusterNum, areaNum );
 	// pointer to the cache for the area in the cluster
 	clusterCache = areaCacheIndex[clusterNum][clusterAreaNum];
-	// check if cache without undesired travel flags already exists
-	for ( cache = clusterCache; cache; cache = cache->next ) {
-		if ( cache->travelFlags == travelFlags ) {
-			break;
-		}
+
+	cache = new idRoutingCache( file->GetCluster( clusterNum ).numReachableAreas );
+	cache->type = CACHETYPE_AREA;
+	cache->cluster = clusterNum;
+	cache->areaNum = areaNum;
+	cache->startTravelTime = 1;
+	cache->travelFlags = travelFlags;
+	cache->prev = NULL;
+	cache->next = clusterCache;
+	if ( clusterCache ) {
+		clusterCache->prev = cache;
 	}
+	areaCacheIndex[clusterNum][clusterAreaNum] = cache;
+	return cache;
+}
+
+/*
+============
+idAASLocal::GetAreaRoutingCache
+============
+*/
+idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const {
+	idRoutingCache *cache;
+
+	cache = FindAreaRoutingCache( clusterNum, areaNum, travelFlags );
 	// if no cache found
 	if ( !cache ) {
-		cache = new idRoutingCache( file->GetCluster( clusterNum ).numReachableAreas );
-		cache->type = CACHETYPE_AREA;
-		cache->cluster = clusterNum;
-		cache->areaNum = areaNum;
-		cache->startTravelTime = 1;
-		cache->travelFlags = travelFlags;
-		cache->prev = NULL;
-		cache->next = clusterCache;
-		if ( clusterCache ) {
-			clusterCache->prev = cache;
-		}
-		areaCacheIndex[clusterNum][clusterAreaNum] = cache;
-		UpdateAreaRoutingCache( cache );
+		cache = AllocAreaRoutingCache( clusterNum, areaNum, travelFlags );
+		UpdateAreaRoutingCache( cache, areaUpdate );
 	}
 	LinkCache( cache );
 	return cache;
@@ -865,7 +1153,7 @@ idRoutingCache *idAASLocal::GetAreaRoutingCache( int clusterNum, int areaNum, in
 idAASLocal::UpdatePortalRoutingCache
 ============
 */
-void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
+void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache, idRoutingUpdate *updates ) const {
 	int i, portalNum, clusterAreaNum;
 	unsigned short t;
 	const aasPortal_t *portal;
@@ -873,7 +1161,12 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 	idRoutingCache *cache;
 	idRoutingUpdate *updateListStart, *updateListEnd, *curUpdate, *nextUpdate;
 
-	curUpdate = &portalUpdate[ file->GetNumPortals() ];
+	// start from scratch when recalculating the cache
+	memset( portalCache->travelTimes, 0, portalCache->size * sizeof( portalCache->travelTimes[0] ) );
+	memset( portalCache->reachabilities, 0, portalCache->size * sizeof( portalCache->reachabilities[0] ) );
+	portalCache->dirty = false;
+
+	curUpdate = &updates[ file->GetNumPortals() ];
 	curUpdate->cluster = portalCache->cluster;
 	curUpdate->areaNum = portalCache->areaNum;
 	curUpdate->tmpTravelTime = portalCache->startTravelTime;
@@ -900,7 +1193,11 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 		curUpdate->isInList = false;
 
 		cluster = &file->GetCluster( curUpdate->cluster );
-		cache = GetAreaRoutingCache( curUpdate->cluster, curUpdate->areaNum, portalCache->travelFlags );
+		// the cache of the portal areas is created up front by CreatePortalAreaCaches
+		cache = FindAreaRoutingCache( curUpdate->cluster, curUpdate->areaNum, portalCache->travelFlags );
+		if ( !cache ) {
+			continue;
+		}
 
 		// take all portals of the cluster
 		for ( i = 0; i < cluster->numPortals; i++ ) {
@@ -923,7 +1220,7 @@ void idAASLocal::UpdatePortalRoutingCache( idRoutingCache *portalCache ) const {
 
 				portalCache->travelTimes[portalNum] = t;
 				portalCache->reachabilities[portalNum] = cache->reachabilities[clusterAreaNum];
-				nextUpdate = &portalUpdate[portalNum];
+				nextUpdate = &updates[portalNum];
 				if ( portal->clusters[0] == curUpdate->cluster ) {
 					nextUpdate->cluster = portal->clusters[1];
 				}
@@ -980,12 +1277,176 @@ idRoutingCache *idAASLocal::GetPortalRoutingCache( int clusterNum, int areaNum,
 			portalCacheIndex[areaNum]->prev = cache;
 		}
 		portalCacheIndex[areaNum] = cache;
-		UpdatePortalRoutingCache( cache );
+		CreatePortalAreaCaches( travelFlags );
+		UpdatePortalRoutingCache( cache, portalUpdate );
 	}
 	LinkCache( cache );
 	return cache;
 }
 
+/*
+============
+idAASLocal::CreatePortalAreaCaches
+
+  Makes sure the cache of all portal areas exists and is up to date for the given travel flags.
+  The portal cache is calculated from this cache. Missing cache is calculated on the job threads.
+============
+*/
+void idAASLocal::CreatePortalAreaCaches( int travelFlags ) const {
+	int i, j, portalNum;
+	const aasCluster_t *cluster;
+	const aasPortal_t *portal;
+	idRoutingCache *cache;
+
+	cacheUpdateList.SetNum( 0, false );
+
+	for ( i = 0; i < file->GetNumClusters(); i++ ) {
+		cluster = &file->GetCluster( i );
+		for ( j = 0; j < cluster->numPortals; j++ ) {
+			portalNum = file->GetPortalIndex( cluster->firstPortal + j );
+			portal = &file->GetPortal( portalNum );
+			if ( ClusterAreaNum( i, portal->areaNum ) >= cluster->numReachableAreas ) {
+				continue;
+			}
+			cache = FindAreaRoutingCache( i, portal->areaNum, travelFlags );
+			if ( !cache ) {
+				cache = AllocAreaRoutingCache( i, portal->areaNum, travelFlags );
+			}
+			if ( cache->dirty ) {
+				cacheUpdateList.Append( cache );
+			}
+			LinkCache( cache );
+		}
+	}
+
+	UpdateCacheList();
+}
+
+/*
+============
+idAASLocal::UpdateCacheJob
+============
+*/
+void idAASLocal::UpdateCacheJob( void *data, int first, int last ) {
+	const idAASLocal *aas = (const idAASLocal *)data;
+	int i, threadIndex;
+	idRoutingUpdate *areaUpdate, *portalUpdate;
+	idRoutingCache *cache;
+
+	// every job thread has its own update memory, the thread waiting for the jobs uses the regular update memory
+	threadIndex = jobManager->GetThreadIndex();
+	if ( threadIndex > 0 ) {
+		areaUpdate = aas->threadAreaUpdate[threadIndex - 1];
+		portalUpdate = aas->threadPortalUpdate[threadIndex - 1];
+	} else {
+		areaUpdate = aas->areaUpdate;
+		portalUpdate = aas->portalUpdate;
+	}
+
+	for ( i = first; i < last; i++ ) {
+		cache = aas->cacheUpdateList[i];
+		if ( cache->type != CACHETYPE_AREA ) {
+			aas->UpdatePortalRoutingCache( cache, portalUpdate );
+		} else if ( cache->dirty ) {
+			aas->UpdateAreaRoutingCache( cache, areaUpdate );
+		} else if ( cache->repair ) {
+			aas->RepairAreaRoutingCache( cache, areaUpdate );
+		}
+	}
+}
+
+/*
+============
+idAASLocal::UpdateCacheList
+
+  Calculates the travel times of all cache in the update list on the job threads.
+  The cache in the list all have to be of the same type because portal cache is
+  calculated from area cache.
+============
+*/
+void idAASLocal::UpdateCacheList( void ) const {
+	int i, numThreads, granularity;
+
+	if ( !cacheUpdateList.Num() ) {
+		return;
+	}
+
+	numThreads = aas_routingThreads.GetInteger();
+	if ( numThreads <= 0 ) {
+		granularity = 0;
+	} else {
+		granularity = ( cacheUpdateList.Num() + numThreads - 1 ) / numThreads;
+	}
+
+	if ( cacheUpdateList.Num() > 1 && numThreads != 1 ) {
+		for ( i = 0; i < jobManager->GetNumThreads(); i++ ) {
+			if ( !threadAreaUpdate[i] ) {
+				threadAreaUpdate[i] = (idRoutingUpdate *) Mem_ClearedAlloc( file->GetNumAreas() * sizeof( idRoutingUpdate ) );
+				threadPortalUpdate[i] = (idRoutingUpdate *) Mem_ClearedAlloc( (file->GetNumPortals()+1) * sizeof( idRoutingUpdate ) );
+			}
+		}
+	}
+
+	jobManager->ParallelFor( "aasRoutingCache", cacheUpdateList.Num(), granularity, UpdateCacheJob, (void *)this );
+
+	cacheUpdateList.SetNum( 0, false );
+}
+
+/*
+============
+idAASLocal::UpdateDirtyCache
+
+  Repairs the area cache in the clusters with areas or obstacles that changed state
+  and recalculates the dirty cache. The area cache is updated before the portal
+  cache which is calculated from it.
+============
+*/
+void idAASLocal::UpdateDirtyCache( void ) const {
+	int i, clusterNum;
+	idRoutingCache *cache;
+	idList<int> portalTravelFlags, repairClusters;
+
+	for ( i = 0; i < changedAreas.Num(); i++ ) {
+		clusterNum = file->GetArea( changedAreas[i] ).cluster;
+		if ( clusterNum > 0 ) {
+			repairClusters.AddUnique( clusterNum );
+		} else {
+			repairClusters.AddUnique( file->GetPortal( -clusterNum ).clusters[0] );
+			repairClusters.AddUnique( file->GetPortal( -clusterNum ).clusters[1] );
+		}
+	}
+
+	cacheUpdateList.SetNum( 0, false );
+	for ( cache = cacheListStart; cache; cache = cache->time_next ) {
+		if ( cache->type == CACHETYPE_AREA ) {
+			if ( cache->dirty ) {
+				cacheUpdateList.Append( cache );
+			} else if ( repairClusters.FindIndex( cache->cluster ) >= 0 ) {
+				cache->repair = true;
+				cacheUpdateList.Append( cache );
+			}
+		} else if ( cache->dirty ) {
+			portalTravelFlags.AddUnique( cache->travelFlags );
+		}
+	}
+	UpdateCacheList();
+	changedAreas.SetNum( 0, false );
+
+	// make sure all the portal area cache exists for the portal cache
+	for ( i = 0; i < portalTravelFlags.Num(); i++ ) {
+		CreatePortalAreaCaches( portalTravelFlags[i] );
+	}
+
+	for ( cache = cacheListStart; cache; cache = cache->time_next ) {
+		if ( cache->dirty && cache->type == CACHETYPE_PORTAL ) {
+			cacheUpdateList.Append( cache );
+		}
+	}
+	UpdateCacheList();
+
+	cacheDirty = false;
+}
+
 /*
 ============
 idAASLocal::RouteToGoalArea
@@ -998,6 +1459,7 @@ bool idAASLocal::RouteToGoalArea( int areaNum, const idVec3 origin, int goalArea
 	const aasCluster_t *cluster;
 	idRoutingCache *areaCache, *portalCache, *clusterCache;
 	idReachability *bestReach, *r, *nextr;
+	idGameTiming timing( GAME_TIMING_PATHING );
 
 	travelTime = 0;
 	*reach = NULL;
@@ -1019,6 +1481,10 @@ bool idAASLocal::RouteToGoalArea( int areaNum, const idVec3 origin, int goalArea
 		return false;
 	}
 
+	if ( cacheDirty ) {
+		UpdateDirtyCache();
+	}
+
 	while( totalCacheMemory > MAX_ROUTING_CACHE_MEMORY ) {
 		DeleteOldestCache();
 	}
@@ -1174,6 +1640,7 @@ bool idAASLocal::FindNearestGoal( aasGoal_t &goal, int areaNum, const idVec3 ori
 	const aasArea_t *nextArea;
 	idVec3 v1, v2, p;
 	float targetDist, dist;
+	idGameTiming timing( GAME_TIMING_PATHING );
 
 	if ( file == NULL || areaNum <= 0 ) {
 		goal.areaNum = areaNum;
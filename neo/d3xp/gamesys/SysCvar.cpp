@@ -133,6 +133,11 @@ idCVar g_skipParticles(				"g_skipParticles",			"0",			CVAR_GAME | CVAR_BOOL, ""
 idCVar g_disasm(					"g_disasm",					"0",			CVAR_GAME | CVAR_BOOL, "disassemble script into base/script/disasm.txt on the local drive when script is compiled" );
 idCVar g_debugBounds(				"g_debugBounds",			"0",			CVAR_GAME | CVAR_BOOL, "checks for models with bounds > 2048" );
 idCVar g_debugAnim(					"g_debugAnim",				"-1",			CVAR_GAME | CVAR_INTEGER, "displays information on which animations are playing on the specified entity number.  set to -1 to disable." );
+idCVar g_animLOD(					"g_animLOD",				"1",			CVAR_GAME | CVAR_BOOL, "blend the animations of entities that cover little of the screen at a lower rate and interpolate in between" );
+idCVar g_animLODScreenSize(			"g_animLODScreenSize",		"0.1",			CVAR_GAME | CVAR_FLOAT, "fraction of the screen width below which an entity uses the next animation lod, halved for each further lod" );
+idCVar g_animLODInterval(			"g_animLODInterval",		"50",			CVAR_GAME | CVAR_INTEGER, "msec between animation blends at the first animation lod, doubled for each further lod", 1, 1000 );
+idCVar g_animThreads(				"g_animThreads",			"0",			CVAR_GAME | CVAR_INTEGER, "number of threads the animation frames of entities in view are created on before the renderer asks for them, 0 = all job threads, 1 = game thread only", 0, MAX_JOB_THREADS );
+idCVar g_useBinaryAnims(			"g_useBinaryAnims",			"1",			CVAR_GAME | CVAR_BOOL, "load md5 animations from the binary files in generated/, which are written when an animation is parsed" );
 idCVar g_debugMove(					"g_debugMove",				"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_debugDamage(				"g_debugDamage",			"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_debugWeapon(				"g_debugWeapon",			"0",			CVAR_GAME | CVAR_BOOL, "" );
@@ -157,6 +162,9 @@ idCVar g_showTriggers(				"g_showTriggers",			"0",			CVAR_GAME | CVAR_BOOL, "dra
 idCVar g_showCollisionWorld(		"g_showCollisionWorld",		"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_showCollisionModels(		"g_showCollisionModels",	"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_showCollisionTraces(		"g_showCollisionTraces",	"0",			CVAR_GAME | CVAR_BOOL, "" );
+idCVar g_showPhysicsIslands(		"g_showPhysicsIslands",		"0",			CVAR_GAME | CVAR_BOOL, "prints how many rigid bodies were stepped on the job threads" );
+idCVar g_physicsThreads(			"g_physicsThreads",			"0",			CVAR_GAME | CVAR_INTEGER, "number of threads rigid body islands are stepped on, 0 = all job threads, 1 = game thread only, articulated figures and monsters always run on the game thread", 0, MAX_JOB_THREADS );
+idCVar g_showClipTree(				"g_showClipTree",			"0",			CVAR_GAME | CVAR_INTEGER, "draws the clip model tree near the player, 1 = leaf nodes, 2 = all nodes", 0, 2 );
 idCVar g_maxShowDistance(			"g_maxShowDistance",		"128",			CVAR_GAME | CVAR_FLOAT, "" );
 idCVar g_showEntityInfo(			"g_showEntityInfo",			"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_showviewpos(				"g_showviewpos",			"0",			CVAR_GAME | CVAR_BOOL, "" );
@@ -279,6 +287,9 @@ idCVar af_showTotalMass(			"af_showTotalMass",			"0",			CVAR_GAME | CVAR_BOOL, "
 idCVar af_showInertia(				"af_showInertia",			"0",			CVAR_GAME | CVAR_BOOL, "show the inertia tensor of each body" );
 idCVar af_showVelocity(				"af_showVelocity",			"0",			CVAR_GAME | CVAR_BOOL, "show the velocity of each body" );
 idCVar af_showActive(				"af_showActive",			"0",			CVAR_GAME | CVAR_BOOL, "show tree-like structures of articulated figures not at rest" );
+idCVar af_forceSolver(				"af_forceSolver",			"-1",			CVAR_GAME | CVAR_INTEGER, "force the auxiliary constraint solver: -1 = articulated figure setting, 0 = lcp, 1 = sparse", -1, 1 );
+idCVar af_sparseIterations(			"af_sparseIterations",		"32",			CVAR_GAME | CVAR_INTEGER, "maximum number of iterations of the sparse auxiliary constraint solver", 1, 1000 );
+idCVar af_compareSolvers(			"af_compareSolvers",		"0",			CVAR_GAME | CVAR_BOOL, "solve auxiliary constraints with both the lcp and sparse solver and collect statistics for afSolverStats" );
 idCVar af_testSolid(				"af_testSolid",				"1",			CVAR_GAME | CVAR_BOOL, "test for bodies initially stuck in solid" );
 
 idCVar rb_showTimings(				"rb_showTimings",			"0",			CVAR_GAME | CVAR_BOOL, "show rigid body cpu usage" );
@@ -366,6 +377,7 @@ idCVar aas_pullPlayer(				"aas_pullPlayer",			"0",			CVAR_GAME | CVAR_INTEGER, "
 idCVar aas_randomPullPlayer(		"aas_randomPullPlayer",		"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar aas_goalArea(				"aas_goalArea",				"0",			CVAR_GAME | CVAR_INTEGER, "" );
 idCVar aas_showPushIntoArea(		"aas_showPushIntoArea",		"0",			CVAR_GAME | CVAR_BOOL, "" );
+idCVar aas_routingThreads(			"aas_routingThreads",		"0",			CVAR_GAME | CVAR_INTEGER, "number of threads routing cache is calculated on, 0 = all job threads, 1 = game thread only", 0, MAX_JOB_THREADS );
 
 idCVar g_password(					"g_password",				"",				CVAR_GAME | CVAR_ARCHIVE, "game password" );
 idCVar password(					"password",					"",				CVAR_GAME | CVAR_NOCHEAT, "client password used when connecting" );
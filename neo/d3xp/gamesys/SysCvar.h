@@ -51,6 +51,11 @@ extern idCVar	g_muzzleFlash;
 extern idCVar	g_disasm;
 extern idCVar	g_debugBounds;
 extern idCVar	g_debugAnim;
+extern idCVar	g_animLOD;
+extern idCVar	g_animLODScreenSize;
+extern idCVar	g_animLODInterval;
+extern idCVar	g_animThreads;
+extern idCVar	g_useBinaryAnims;
 extern idCVar	g_debugMove;
 extern idCVar	g_debugDamage;
 extern idCVar	g_debugWeapon;
@@ -73,6 +78,9 @@ extern idCVar	g_showTriggers;
 extern idCVar	g_showCollisionWorld;
 extern idCVar	g_showCollisionModels;
 extern idCVar	g_showCollisionTraces;
+extern idCVar	g_showClipTree;
+extern idCVar	g_showPhysicsIslands;
+extern idCVar	g_physicsThreads;
 extern idCVar	g_maxShowDistance;
 extern idCVar	g_showEntityInfo;
 extern idCVar	g_showviewpos;
@@ -158,6 +166,9 @@ extern idCVar	af_showInertia;
 extern idCVar	af_showVelocity;
 extern idCVar	af_showActive;
 extern idCVar	af_testSolid;
+extern idCVar	af_forceSolver;
+extern idCVar	af_sparseIterations;
+extern idCVar	af_compareSolvers;
 
 extern idCVar	rb_showTimings;
 extern idCVar	rb_showBodies;
@@ -265,6 +276,7 @@ extern idCVar	aas_pullPlayer;
 extern idCVar	aas_randomPullPlayer;
 extern idCVar	aas_goalArea;
 extern idCVar	aas_showPushIntoArea;
+extern idCVar	aas_routingThreads;
 
 extern idCVar	net_clientPredictGUI;
 
@@ -31,23 +31,17 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "../Game_local.h"
 
-#define	MAX_SECTOR_DEPTH				12
-#define MAX_SECTORS						((1<<(MAX_SECTOR_DEPTH+1))-1)
-
-typedef struct clipSector_s {
-	int						axis;		// -1 = leaf node
-	float					dist;
-	struct clipSector_s *	children[2];
-	struct clipLink_s *		clipLinks;
-} clipSector_t;
-
-typedef struct clipLink_s {
-	idClipModel *			clipModel;
-	struct clipSector_s *	sector;
-	struct clipLink_s *		prevInSector;
-	struct clipLink_s *		nextInSector;
-	struct clipLink_s *		nextLink;
-} clipLink_t;
+#define CLIP_NODE_MARGIN				8.0f		// leaf bounds are expanded so small moves do not change the tree
+#define CLIP_TREE_STACK					256
+#define CLIP_TREE_MIN_NODES				256
+
+typedef struct clipNode_s {
+	idBounds				bounds;			// expanded clip model bounds for leaf nodes
+	int						parent;			// next free node for nodes on the free list
+	int						children[2];
+	int						height;			// 0 = leaf node, -1 = free node
+	idClipModel *			clipModel;		// clip model for leaf nodes
+} clipNode_t;
 
 typedef struct trmCache_s {
 	idTraceModel			trm;
@@ -59,8 +53,6 @@ typedef struct trmCache_s {
 
 idVec3 vec3_boxEpsilon( CM_BOX_EPSILON, CM_BOX_EPSILON, CM_BOX_EPSILON );
 
-idBlockAlloc<clipLink_t, 1024>	clipLinkAllocator;
-
 
 /*
 ===============================================================
@@ -283,8 +275,10 @@ void idClipModel::Init( void ) {
 	collisionModelHandle = 0;
 	renderModelHandle = -1;
 	traceModelIndex = -1;
-	clipLinks = NULL;
-	touchCount = -1;
+	clip = NULL;
+	clipNode = -1;
+	linked = false;
+	linkCount = 0;
 }
 
 /*
@@ -349,8 +343,10 @@ idClipModel::idClipModel( const idClipModel *model ) {
 		LoadModel( *GetCachedTraceModel( model->traceModelIndex ) );
 	}
 	renderModelHandle = model->renderModelHandle;
-	clipLinks = NULL;
-	touchCount = -1;
+	clip = NULL;
+	clipNode = -1;
+	linked = false;
+	linkCount = 0;
 }
 
 /*
@@ -359,8 +355,10 @@ idClipModel::~idClipModel
 ================
 */
 idClipModel::~idClipModel( void ) {
-	// make sure the clip model is no longer linked
-	Unlink();
+	// make sure the clip model is no longer in the clip model tree
+	if ( clip ) {
+		clip->RemoveClipModel( this );
+	}
 	if ( traceModelIndex != -1 ) {
 		FreeTraceModel( traceModelIndex );
 	}
@@ -389,8 +387,8 @@ void idClipModel::Save( idSaveGame *savefile ) const {
 	}
 	savefile->WriteInt( traceModelIndex );
 	savefile->WriteInt( renderModelHandle );
-	savefile->WriteBool( clipLinks != NULL );
-	savefile->WriteInt( touchCount );
+	savefile->WriteBool( linked );
+	savefile->WriteInt( -1 );		// unused touch count
 }
 
 /*
@@ -400,7 +398,8 @@ idClipModel::Restore
 */
 void idClipModel::Restore( idRestoreGame *savefile ) {
 	idStr collisionModelName;
-	bool linked;
+	bool wasLinked;
+	int unused;
 
 	savefile->ReadBool( enabled );
 	savefile->ReadObject( reinterpret_cast<idClass *&>( entity ) );
@@ -423,15 +422,14 @@ void idClipModel::Restore( idRestoreGame *savefile ) {
 		traceModelCache[traceModelIndex]->refCount++;
 	}
 	savefile->ReadInt( renderModelHandle );
-	savefile->ReadBool( linked );
-	savefile->ReadInt( touchCount );
+	savefile->ReadBool( wasLinked );
+	savefile->ReadInt( unused );
 
 	// the render model will be set when the clip model is linked
 	renderModelHandle = -1;
-	clipLinks = NULL;
-	touchCount = -1;
+	linked = false;
 
-	if ( linked ) {
+	if ( wasLinked ) {
 		Link( gameLocal.clip, entity, id, origin, axis, renderModelHandle );
 	}
 }
@@ -442,7 +440,7 @@ idClipModel::SetPosition
 ================
 */
 void idClipModel::SetPosition( const idVec3 &newOrigin, const idMat3 &newAxis ) {
-	if ( clipLinks ) {
+	if ( linked ) {
 		Unlink();	// unlink from old position
 	}
 	origin = newOrigin;
@@ -486,55 +484,17 @@ void idClipModel::GetMassProperties( const float density, float &mass, idVec3 &c
 /*
 ===============
 idClipModel::Unlink
-===============
-*/
-void idClipModel::Unlink( void ) {
-	clipLink_t *link;
 
-	for ( link = clipLinks; link; link = clipLinks ) {
-		clipLinks = link->nextLink;
-		if ( link->prevInSector ) {
-			link->prevInSector->nextInSector = link->nextInSector;
-		} else {
-			link->sector->clipLinks = link->nextInSector;
-		}
-		if ( link->nextInSector ) {
-			link->nextInSector->prevInSector = link->prevInSector;
-		}
-		clipLinkAllocator.Free( link );
-	}
-}
-
-/*
-===============
-idClipModel::Link_r
+  The leaf node stays in the clip model tree until the end of the game frame,
+  so the model can be linked again without changing the tree when it did not
+  move far.  Queries skip the leaf while the model is unlinked.
 ===============
 */
-void idClipModel::Link_r( struct clipSector_s *node ) {
-	clipLink_t *link;
-
-	while( node->axis != -1 ) {
-		if ( absBounds[0][node->axis] > node->dist ) {
-			node = node->children[0];
-		} else if ( absBounds[1][node->axis] < node->dist ) {
-			node = node->children[1];
-		} else {
-			Link_r( node->children[0] );
-			node = node->children[1];
-		}
-	}
-
-	link = clipLinkAllocator.Alloc();
-	link->clipModel = this;
-	link->sector = node;
-	link->nextInSector = node->clipLinks;
-	link->prevInSector = NULL;
-	if ( node->clipLinks ) {
-		node->clipLinks->prevInSector = link;
+void idClipModel::Unlink( void ) {
+	if ( linked ) {
+		clip->unlinkedLeaves.Append( clipNode );
 	}
-	node->clipLinks = link;
-	link->nextLink = clipLinks;
-	clipLinks = link;
+	linked = false;
 }
 
 /*
@@ -549,7 +509,7 @@ void idClipModel::Link( idClip &clp ) {
 		return;
 	}
 
-	if ( clipLinks ) {
+	if ( linked ) {
 		Unlink();	// unlink from old position
 	}
 
@@ -572,7 +532,7 @@ void idClipModel::Link( idClip &clp ) {
 	absBounds[0] -= vec3_boxEpsilon;
 	absBounds[1] += vec3_boxEpsilon;
 
-	Link_r( clp.clipSectors );
+	clp.LinkClipModel( this );
 }
 
 /*
@@ -620,60 +580,14 @@ idClip::idClip
 ===============
 */
 idClip::idClip( void ) {
-	numClipSectors = 0;
-	clipSectors = NULL;
+	clipNodes = NULL;
+	numClipNodes = 0;
+	maxClipNodes = 0;
+	freeClipNode = -1;
+	clipRoot = -1;
+	linkCount = 0;
 	worldBounds.Zero();
-	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
-}
-
-/*
-===============
-idClip::CreateClipSectors_r
-
-Builds a uniformly subdivided tree for the given world size
-===============
-*/
-clipSector_t *idClip::CreateClipSectors_r( const int depth, const idBounds &bounds, idVec3 &maxSector ) {
-	int				i;
-	clipSector_t	*anode;
-	idVec3			size;
-	idBounds		front, back;
-
-	anode = &clipSectors[idClip::numClipSectors];
-	idClip::numClipSectors++;
-
-	if ( depth == MAX_SECTOR_DEPTH ) {
-		anode->axis = -1;
-		anode->children[0] = anode->children[1] = NULL;
-
-		for ( i = 0; i < 3; i++ ) {
-			if ( bounds[1][i] - bounds[0][i] > maxSector[i] ) {
-				maxSector[i] = bounds[1][i] - bounds[0][i];
-			}
-		}
-		return anode;
-	}
-
-	size = bounds[1] - bounds[0];
-	if ( size[0] >= size[1] && size[0] >= size[2] ) {
-		anode->axis = 0;
-	} else if ( size[1] >= size[0] && size[1] >= size[2] ) {
-		anode->axis = 1;
-	} else {
-		anode->axis = 2;
-	}
-
-	anode->dist = 0.5f * ( bounds[1][anode->axis] + bounds[0][anode->axis] );
-
-	front = bounds;
-	back = bounds;
-	
-	front[0][anode->axis] = back[1][anode->axis] = anode->dist;
-	
-	anode->children[0] = CreateClipSectors_r( depth+1, front, maxSector );
-	anode->children[1] = CreateClipSectors_r( depth+1, back, maxSector );
-
-	return anode;
+	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = numTreeUpdates = 0;
 }
 
 /*
@@ -683,28 +597,27 @@ idClip::Init
 */
 void idClip::Init( void ) {
 	cmHandle_t h;
-	idVec3 size, maxSector = vec3_origin;
-
-	// clear clip sectors
-	clipSectors = new clipSector_t[MAX_SECTORS];
-	memset( clipSectors, 0, MAX_SECTORS * sizeof( clipSector_t ) );
-	numClipSectors = 0;
-	touchCount = -1;
+	idVec3 size;
+
+	// clear the clip model tree
+	clipNodes = NULL;
+	numClipNodes = 0;
+	maxClipNodes = 0;
+	freeClipNode = -1;
+	clipRoot = -1;
+	unlinkedLeaves.Clear();
 	// get world map bounds
 	h = collisionModelManager->LoadModel( "worldMap", false );
 	collisionModelManager->GetModelBounds( h, worldBounds );
-	// create world sectors
-	CreateClipSectors_r( 0, worldBounds, maxSector );
 
 	size = worldBounds[1] - worldBounds[0];
 	gameLocal.Printf( "map bounds are (%1.1f, %1.1f, %1.1f)\n", size[0], size[1], size[2] );
-	gameLocal.Printf( "max clip sector is (%1.1f, %1.1f, %1.1f)\n", maxSector[0], maxSector[1], maxSector[2] );
 
 	// initialize a default clip model
 	defaultClipModel.LoadModel( idTraceModel( idBounds( idVec3( 0, 0, 0 ) ).Expand( 8 ) ) );
 
 	// set counters to zero
-	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
+	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = numTreeUpdates = 0;
 }
 
 /*
@@ -713,8 +626,23 @@ idClip::Shutdown
 ===============
 */
 void idClip::Shutdown( void ) {
-	delete[] clipSectors;
-	clipSectors = NULL;
+	int i;
+
+	// clip models that outlive the tree should not reference it
+	for ( i = 0; i < maxClipNodes; i++ ) {
+		if ( clipNodes[i].height == 0 && clipNodes[i].clipModel ) {
+			clipNodes[i].clipModel->clip = NULL;
+			clipNodes[i].clipModel->clipNode = -1;
+			clipNodes[i].clipModel->linked = false;
+		}
+	}
+	delete[] clipNodes;
+	clipNodes = NULL;
+	numClipNodes = 0;
+	maxClipNodes = 0;
+	freeClipNode = -1;
+	clipRoot = -1;
+	unlinkedLeaves.Clear();
 
 	// free the trace model used for the temporaryClipModel
 	if ( temporaryClipModel.traceModelIndex != -1 ) {
@@ -727,82 +655,419 @@ void idClip::Shutdown( void ) {
 		idClipModel::FreeTraceModel( defaultClipModel.traceModelIndex );
 		defaultClipModel.traceModelIndex = -1;
 	}
+}
 
-	clipLinkAllocator.Shutdown();
+/*
+===============
+idClip::AllocClipNode
+===============
+*/
+int idClip::AllocClipNode( void ) {
+	int i, nodeNum, newMaxNodes;
+	clipNode_t *newNodes, *node;
+
+	if ( freeClipNode == -1 ) {
+		// grow the node array and put the new nodes on the free list
+		newMaxNodes = Max( maxClipNodes * 2, CLIP_TREE_MIN_NODES );
+		newNodes = new clipNode_t[newMaxNodes];
+		if ( clipNodes ) {
+			memcpy( newNodes, clipNodes, maxClipNodes * sizeof( clipNode_t ) );
+			delete[] clipNodes;
+		}
+		for ( i = maxClipNodes; i < newMaxNodes; i++ ) {
+			newNodes[i].parent = ( i + 1 < newMaxNodes ) ? i + 1 : -1;
+			newNodes[i].children[0] = newNodes[i].children[1] = -1;
+			newNodes[i].height = -1;
+			newNodes[i].clipModel = NULL;
+		}
+		freeClipNode = maxClipNodes;
+		clipNodes = newNodes;
+		maxClipNodes = newMaxNodes;
+	}
+
+	nodeNum = freeClipNode;
+	node = &clipNodes[nodeNum];
+	freeClipNode = node->parent;
+	node->parent = -1;
+	node->children[0] = node->children[1] = -1;
+	node->height = 0;
+	node->clipModel = NULL;
+	numClipNodes++;
+
+	return nodeNum;
 }
 
 /*
-====================
-idClip::ClipModelsTouchingBounds_r
-====================
+===============
+idClip::FreeClipNode
+===============
 */
-typedef struct listParms_s {
-	idBounds		bounds;
-	int				contentMask;
-	idClipModel	**	list;
-	int				count;
-	int				maxCount;
-} listParms_t;
-
-void idClip::ClipModelsTouchingBounds_r( const struct clipSector_s *node, listParms_t &parms ) const {
-
-	while( node->axis != -1 ) {
-		if ( parms.bounds[0][node->axis] > node->dist ) {
-			node = node->children[0];
-		} else if ( parms.bounds[1][node->axis] < node->dist ) {
-			node = node->children[1];
+void idClip::FreeClipNode( int nodeNum ) {
+	clipNode_t *node = &clipNodes[nodeNum];
+
+	node->parent = freeClipNode;
+	node->height = -1;
+	node->clipModel = NULL;
+	freeClipNode = nodeNum;
+	numClipNodes--;
+}
+
+/*
+===============
+ClipNodeArea
+
+  half the surface area, used as the cost of a node
+===============
+*/
+static ID_INLINE float ClipNodeArea( const idBounds &bounds ) {
+	idVec3 size = bounds[1] - bounds[0];
+	return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+/*
+===============
+ClipNodeDescendCost
+===============
+*/
+static ID_INLINE float ClipNodeDescendCost( const clipNode_t &child, const idBounds &leafBounds ) {
+	float area = ClipNodeArea( child.bounds + leafBounds );
+	if ( child.height == 0 ) {
+		return area;
+	}
+	return area - ClipNodeArea( child.bounds );
+}
+
+/*
+===============
+idClip::InsertLeaf
+
+  Puts the leaf next to the sibling for which the increase in surface area is smallest.
+===============
+*/
+void idClip::InsertLeaf( int leaf ) {
+	int index, sibling, oldParent, newParent, child0, child1;
+	float area, combinedArea, cost, inheritanceCost, cost0, cost1;
+	idBounds leafBounds;
+
+	if ( clipRoot == -1 ) {
+		clipRoot = leaf;
+		clipNodes[leaf].parent = -1;
+		return;
+	}
+
+	// find the best sibling
+	leafBounds = clipNodes[leaf].bounds;
+	index = clipRoot;
+	while ( clipNodes[index].height > 0 ) {
+		const clipNode_t &node = clipNodes[index];
+
+		area = ClipNodeArea( node.bounds );
+		combinedArea = ClipNodeArea( node.bounds + leafBounds );
+
+		// cost of a new parent for this node and the leaf
+		cost = 2.0f * combinedArea;
+		// minimum cost of pushing the leaf further down the tree
+		inheritanceCost = 2.0f * ( combinedArea - area );
+
+		child0 = node.children[0];
+		child1 = node.children[1];
+		cost0 = ClipNodeDescendCost( clipNodes[child0], leafBounds ) + inheritanceCost;
+		cost1 = ClipNodeDescendCost( clipNodes[child1], leafBounds ) + inheritanceCost;
+
+		if ( cost < cost0 && cost < cost1 ) {
+			break;
+		}
+		index = ( cost0 < cost1 ) ? child0 : child1;
+	}
+	sibling = index;
+
+	// create a new parent for the sibling and the leaf
+	oldParent = clipNodes[sibling].parent;
+	newParent = AllocClipNode();
+	clipNodes[newParent].parent = oldParent;
+	clipNodes[newParent].bounds = leafBounds + clipNodes[sibling].bounds;
+	clipNodes[newParent].height = clipNodes[sibling].height + 1;
+	clipNodes[newParent].children[0] = sibling;
+	clipNodes[newParent].children[1] = leaf;
+	clipNodes[sibling].parent = newParent;
+	clipNodes[leaf].parent = newParent;
+
+	if ( oldParent != -1 ) {
+		if ( clipNodes[oldParent].children[0] == sibling ) {
+			clipNodes[oldParent].children[0] = newParent;
 		} else {
-			ClipModelsTouchingBounds_r( node->children[0], parms );
-			node = node->children[1];
+			clipNodes[oldParent].children[1] = newParent;
 		}
+	} else {
+		clipRoot = newParent;
 	}
 
-	for ( clipLink_t *link = node->clipLinks; link; link = link->nextInSector ) {
-		idClipModel	*check = link->clipModel;
+	// walk back up fixing heights and bounds
+	for ( index = clipNodes[leaf].parent; index != -1; index = clipNodes[index].parent ) {
+		index = BalanceNode( index );
 
-		// if the clip model is enabled
-		if ( !check->enabled ) {
-			continue;
+		clipNode_t &node = clipNodes[index];
+		node.height = 1 + Max( clipNodes[node.children[0]].height, clipNodes[node.children[1]].height );
+		node.bounds = clipNodes[node.children[0]].bounds + clipNodes[node.children[1]].bounds;
+	}
+}
+
+/*
+===============
+idClip::RemoveLeaf
+
+  Removes the leaf from the tree but does not free it.
+===============
+*/
+void idClip::RemoveLeaf( int leaf ) {
+	int index, parent, grandParent, sibling;
+
+	if ( leaf == clipRoot ) {
+		clipRoot = -1;
+		return;
+	}
+
+	parent = clipNodes[leaf].parent;
+	grandParent = clipNodes[parent].parent;
+	sibling = ( clipNodes[parent].children[0] == leaf ) ? clipNodes[parent].children[1] : clipNodes[parent].children[0];
+
+	if ( grandParent == -1 ) {
+		clipRoot = sibling;
+		clipNodes[sibling].parent = -1;
+		FreeClipNode( parent );
+		return;
+	}
+
+	// replace the parent with the sibling
+	if ( clipNodes[grandParent].children[0] == parent ) {
+		clipNodes[grandParent].children[0] = sibling;
+	} else {
+		clipNodes[grandParent].children[1] = sibling;
+	}
+	clipNodes[sibling].parent = grandParent;
+	FreeClipNode( parent );
+
+	for ( index = grandParent; index != -1; index = clipNodes[index].parent ) {
+		index = BalanceNode( index );
+
+		clipNode_t &node = clipNodes[index];
+		node.height = 1 + Max( clipNodes[node.children[0]].height, clipNodes[node.children[1]].height );
+		node.bounds = clipNodes[node.children[0]].bounds + clipNodes[node.children[1]].bounds;
+	}
+}
+
+/*
+===============
+idClip::BalanceNode
+
+  Rotates the taller child up if the children of the node differ more than one in height.
+  Returns the node that took the place of the given node.
+===============
+*/
+int idClip::BalanceNode( int nodeNum ) {
+	int iB, iC, iUp, iDown, i0, i1, side, balance;
+
+	clipNode_t &A = clipNodes[nodeNum];
+	if ( A.height < 2 ) {
+		return nodeNum;
+	}
+
+	iB = A.children[0];
+	iC = A.children[1];
+	balance = clipNodes[iC].height - clipNodes[iB].height;
+
+	if ( balance > 1 ) {
+		iUp = iC;
+		iDown = iB;
+		side = 1;
+	} else if ( balance < -1 ) {
+		iUp = iB;
+		iDown = iC;
+		side = 0;
+	} else {
+		return nodeNum;
+	}
+
+	clipNode_t &up = clipNodes[iUp];
+	clipNode_t &down = clipNodes[iDown];
+	i0 = up.children[0];
+	i1 = up.children[1];
+
+	// the taller child takes the place of the node
+	up.children[0] = nodeNum;
+	up.parent = A.parent;
+	A.parent = iUp;
+
+	if ( up.parent != -1 ) {
+		if ( clipNodes[up.parent].children[0] == nodeNum ) {
+			clipNodes[up.parent].children[0] = iUp;
+		} else {
+			clipNodes[up.parent].children[1] = iUp;
 		}
+	} else {
+		clipRoot = iUp;
+	}
 
-		// avoid duplicates in the list
-		if ( check->touchCount == touchCount ) {
-			continue;
+	// the node keeps the shorter grandchild
+	if ( clipNodes[i0].height > clipNodes[i1].height ) {
+		up.children[1] = i0;
+		A.children[side] = i1;
+		clipNodes[i1].parent = nodeNum;
+	} else {
+		up.children[1] = i1;
+		A.children[side] = i0;
+		clipNodes[i0].parent = nodeNum;
+	}
+
+	A.bounds = down.bounds + clipNodes[A.children[side]].bounds;
+	A.height = 1 + Max( down.height, clipNodes[A.children[side]].height );
+	up.bounds = A.bounds + clipNodes[up.children[1]].bounds;
+	up.height = 1 + Max( A.height, clipNodes[up.children[1]].height );
+
+	return iUp;
+}
+
+/*
+===============
+ClipBoundsContain
+===============
+*/
+static ID_INLINE bool ClipBoundsContain( const idBounds &outer, const idBounds &inner ) {
+	return ( inner[0][0] >= outer[0][0] && inner[0][1] >= outer[0][1] && inner[0][2] >= outer[0][2] &&
+			inner[1][0] <= outer[1][0] && inner[1][1] <= outer[1][1] && inner[1][2] <= outer[1][2] );
+}
+
+/*
+===============
+idClip::LinkClipModel
+
+  The leaf of a clip model that moved only a little is kept as is.
+===============
+*/
+void idClip::LinkClipModel( idClipModel *clipModel ) {
+	int leaf;
+
+	if ( clipModel->clip != NULL && clipModel->clip != this ) {
+		clipModel->clip->RemoveClipModel( clipModel );
+	}
+
+	clipModel->linkCount = ++linkCount;
+
+	leaf = clipModel->clipNode;
+	if ( leaf != -1 ) {
+		// keep the leaf if it still contains the clip model and is not much larger
+		if ( ClipBoundsContain( clipNodes[leaf].bounds, clipModel->absBounds ) &&
+				ClipBoundsContain( clipModel->absBounds.Expand( 2.0f * CLIP_NODE_MARGIN ), clipNodes[leaf].bounds ) ) {
+			clipModel->linked = true;
+			return;
 		}
+		RemoveLeaf( leaf );
+	} else {
+		leaf = AllocClipNode();
+		clipNodes[leaf].clipModel = clipModel;
+	}
 
-		// if the clip model does not have any contents we are looking for
-		if ( !( check->contents & parms.contentMask ) ) {
+	clipNodes[leaf].bounds = clipModel->absBounds.Expand( CLIP_NODE_MARGIN );
+	InsertLeaf( leaf );
+
+	clipModel->clip = this;
+	clipModel->clipNode = leaf;
+	clipModel->linked = true;
+
+	numTreeUpdates++;
+}
+
+/*
+===============
+idClip::RemoveClipModel
+===============
+*/
+void idClip::RemoveClipModel( idClipModel *clipModel ) {
+	assert( clipModel->clip == this );
+
+	RemoveLeaf( clipModel->clipNode );
+	FreeClipNode( clipModel->clipNode );
+
+	clipModel->clip = NULL;
+	clipModel->clipNode = -1;
+	clipModel->linked = false;
+}
+
+/*
+===============
+idClip::RemoveUnlinkedLeaves
+
+  Called at the end of every game frame, so clip models that were removed
+  from the world do not keep their leaves in the tree.
+===============
+*/
+void idClip::RemoveUnlinkedLeaves( void ) {
+	int i, leaf;
+	idClipModel *clipModel;
+
+	for ( i = 0; i < unlinkedLeaves.Num(); i++ ) {
+		leaf = unlinkedLeaves[i];
+
+		// the leaf may have been freed or reused since the clip model was unlinked
+		if ( clipNodes[leaf].height != 0 ) {
 			continue;
 		}
-
-		// if the bounds really do overlap
-		if (	check->absBounds[0][0] > parms.bounds[1][0] ||
-				check->absBounds[1][0] < parms.bounds[0][0] ||
-				check->absBounds[0][1] > parms.bounds[1][1] ||
-				check->absBounds[1][1] < parms.bounds[0][1] ||
-				check->absBounds[0][2] > parms.bounds[1][2] ||
-				check->absBounds[1][2] < parms.bounds[0][2] ) {
+		clipModel = clipNodes[leaf].clipModel;
+		if ( clipModel == NULL || clipModel->linked ) {
 			continue;
 		}
+		RemoveClipModel( clipModel );
+		numTreeUpdates++;
+	}
+	unlinkedLeaves.SetNum( 0, false );
+}
 
-		if ( parms.count >= parms.maxCount ) {
-			gameLocal.Warning( "idClip::ClipModelsTouchingBounds_r: max count" );
-			return;
-		}
+/*
+================
+SortClipModelsByLinkCount
 
-		check->touchCount = touchCount;
-		parms.list[parms.count] = check;
-		parms.count++;
+  The clip sector lists returned the most recently linked clip model first,
+  the tree results are sorted the same way so they do not depend on the
+  shape of the tree.
+================
+*/
+static void SortClipModelsByLinkCount( idClipModel **clipModelList, int *boundsMasks, int count ) {
+	int i, j, gap, mask;
+	idClipModel *check;
+
+	mask = 0;
+	for ( gap = count >> 1; gap > 0; gap = ( gap == 2 ) ? 1 : ( gap * 5 ) / 11 ) {
+		for ( i = gap; i < count; i++ ) {
+			check = clipModelList[i];
+			if ( boundsMasks ) {
+				mask = boundsMasks[i];
+			}
+			for ( j = i; j >= gap && clipModelList[j - gap]->GetLinkCount() < check->GetLinkCount(); j -= gap ) {
+				clipModelList[j] = clipModelList[j - gap];
+				if ( boundsMasks ) {
+					boundsMasks[j] = boundsMasks[j - gap];
+				}
+			}
+			clipModelList[j] = check;
+			if ( boundsMasks ) {
+				boundsMasks[j] = mask;
+			}
+		}
 	}
 }
 
 /*
 ================
 idClip::ClipModelsTouchingBounds
+
+  Every clip model has a single leaf so there are no duplicates to check
+  for and the query does not modify anything.
 ================
 */
 int idClip::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, idClipModel **clipModelList, int maxCount ) const {
-	listParms_t parms;
+	int count, stackSize, nodeStack[CLIP_TREE_STACK];
+	idBounds queryBounds;
+	idClipModel *check;
 
 	if (	bounds[0][0] > bounds[1][0] ||
 			bounds[0][1] > bounds[1][1] ||
@@ -812,17 +1077,149 @@ int idClip::ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, i
 		return 0;
 	}
 
-	parms.bounds[0] = bounds[0] - vec3_boxEpsilon;
-	parms.bounds[1] = bounds[1] + vec3_boxEpsilon;
-	parms.contentMask = contentMask;
-	parms.list = clipModelList;
-	parms.count = 0;
-	parms.maxCount = maxCount;
+	if ( clipRoot == -1 ) {
+		return 0;
+	}
+
+	queryBounds[0] = bounds[0] - vec3_boxEpsilon;
+	queryBounds[1] = bounds[1] + vec3_boxEpsilon;
+
+	count = 0;
+	nodeStack[0] = clipRoot;
+	stackSize = 1;
+
+	while ( stackSize > 0 ) {
+		const clipNode_t &node = clipNodes[nodeStack[--stackSize]];
+
+		if ( !node.bounds.IntersectsBounds( queryBounds ) ) {
+			continue;
+		}
+
+		if ( node.height > 0 ) {
+			assert( stackSize + 2 <= CLIP_TREE_STACK );
+			nodeStack[stackSize++] = node.children[0];
+			nodeStack[stackSize++] = node.children[1];
+			continue;
+		}
+
+		check = node.clipModel;
+
+		// if the clip model is linked and enabled
+		if ( !check->linked || !check->enabled ) {
+			continue;
+		}
+
+		// if the clip model does not have any contents we are looking for
+		if ( !( check->contents & contentMask ) ) {
+			continue;
+		}
+
+		// if the bounds really do overlap
+		if (	check->absBounds[0][0] > queryBounds[1][0] ||
+				check->absBounds[1][0] < queryBounds[0][0] ||
+				check->absBounds[0][1] > queryBounds[1][1] ||
+				check->absBounds[1][1] < queryBounds[0][1] ||
+				check->absBounds[0][2] > queryBounds[1][2] ||
+				check->absBounds[1][2] < queryBounds[0][2] ) {
+			continue;
+		}
+
+		if ( count >= maxCount ) {
+			gameLocal.Warning( "idClip::ClipModelsTouchingBounds: max count" );
+			break;
+		}
+
+		clipModelList[count++] = check;
+	}
+
+	SortClipModelsByLinkCount( clipModelList, NULL, count );
+
+	return count;
+}
+
+/*
+================
+idClip::ClipModelsTouchingBoundsBatch
+
+  Walks the tree once for all bounds. Cleared bounds do not touch anything.
+================
+*/
+int idClip::ClipModelsTouchingBoundsBatch( const idBounds *bounds, int numBounds, int contentMask, idClipModel **clipModelList, int *boundsMasks, int maxCount ) const {
+	int i, count, stackSize, mask, nodeMask;
+	int nodeStack[CLIP_TREE_STACK], maskStack[CLIP_TREE_STACK];
+	idBounds queryBounds[MAX_CLIP_BATCH_BOUNDS];
+	idClipModel *check;
+
+	assert( numBounds <= MAX_CLIP_BATCH_BOUNDS );
+	numBounds = Min( numBounds, MAX_CLIP_BATCH_BOUNDS );
+
+	mask = 0;
+	for ( i = 0; i < numBounds; i++ ) {
+		if (	bounds[i][0][0] > bounds[i][1][0] ||
+				bounds[i][0][1] > bounds[i][1][1] ||
+				bounds[i][0][2] > bounds[i][1][2] ) {
+			continue;
+		}
+		queryBounds[i][0] = bounds[i][0] - vec3_boxEpsilon;
+		queryBounds[i][1] = bounds[i][1] + vec3_boxEpsilon;
+		mask |= BIT( i );
+	}
+
+	if ( !mask || clipRoot == -1 ) {
+		return 0;
+	}
+
+	count = 0;
+	nodeStack[0] = clipRoot;
+	maskStack[0] = mask;
+	stackSize = 1;
+
+	while ( stackSize > 0 ) {
+		stackSize--;
+		const clipNode_t &node = clipNodes[nodeStack[stackSize]];
+		mask = maskStack[stackSize];
 
-	touchCount++;
-	ClipModelsTouchingBounds_r( clipSectors, parms );
+		if ( node.height == 0 ) {
+			check = node.clipModel;
+			if ( !check->linked || !check->enabled || !( check->contents & contentMask ) ) {
+				continue;
+			}
+		}
 
-	return parms.count;
+		// test the node against the bounds that touched its parent
+		nodeMask = 0;
+		const idBounds &nodeBounds = ( node.height > 0 ) ? node.bounds : node.clipModel->absBounds;
+		for ( i = 0; i < numBounds; i++ ) {
+			if ( ( mask & BIT( i ) ) && nodeBounds.IntersectsBounds( queryBounds[i] ) ) {
+				nodeMask |= BIT( i );
+			}
+		}
+		if ( !nodeMask ) {
+			continue;
+		}
+
+		if ( node.height > 0 ) {
+			assert( stackSize + 2 <= CLIP_TREE_STACK );
+			nodeStack[stackSize] = node.children[0];
+			maskStack[stackSize++] = nodeMask;
+			nodeStack[stackSize] = node.children[1];
+			maskStack[stackSize++] = nodeMask;
+			continue;
+		}
+
+		if ( count >= maxCount ) {
+			gameLocal.Warning( "idClip::ClipModelsTouchingBoundsBatch: max count" );
+			break;
+		}
+
+		clipModelList[count] = node.clipModel;
+		boundsMasks[count] = nodeMask;
+		count++;
+	}
+
+	SortClipModelsByLinkCount( clipModelList, boundsMasks, count );
+
+	return count;
 }
 
 /*
@@ -858,7 +1255,7 @@ int idClip::EntitiesTouchingBounds( const idBounds &bounds, int contentMask, idE
 
 /*
 ====================
-idClip::GetTraceClipModels
+idClip::FilterTraceClipModels
 
   an ent will be excluded from testing if:
   cm->entity == passEntity ( don't clip against the pass entity )
@@ -867,15 +1264,13 @@ idClip::GetTraceClipModels
   cm->owner == passOwner ( don't interact with other missiles from same owner )
 ====================
 */
-int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList ) const {
-	int i, num;
+void idClip::FilterTraceClipModels( int num, const idEntity *passEntity, idClipModel **clipModelList ) const {
+	int i;
 	idClipModel	*cm;
 	idEntity *passOwner;
 
-	num = ClipModelsTouchingBounds( bounds, contentMask, clipModelList, MAX_GENTITIES );
-
 	if ( !passEntity ) {
-		return num;
+		return;
 	}
 
 	if ( passEntity->GetPhysics()->GetNumClipModels() > 0 ) {
@@ -902,6 +1297,19 @@ int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const i
 		}
 	}
 
+}
+
+/*
+====================
+idClip::GetTraceClipModels
+====================
+*/
+int idClip::GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList ) const {
+	int num;
+
+	num = ClipModelsTouchingBounds( bounds, contentMask, clipModelList, MAX_GENTITIES );
+	FilterTraceClipModels( num, passEntity, clipModelList );
+
 	return num;
 }
 
@@ -1061,6 +1469,7 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 	float radius;
 	trace_t trace;
 	const idTraceModel *trm;
+	idGameTiming timing( GAME_TIMING_COLLISION );
 
 	if ( TestHugeTranslation( results, mdl, start, end, trmAxis ) ) {
 		return true;
@@ -1122,6 +1531,131 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 	return ( results.fraction < 1.0f );
 }
 
+/*
+============
+idClip::TranslationBatch
+
+  Translates the same model along several paths that are close together.
+  The world is traced as a single packet and the clip models touching
+  the paths are gathered with a single walk of the clip model tree.
+  Returns the number of paths that hit something.
+============
+*/
+int idClip::TranslationBatch( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numTraces,
+						const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity ) {
+	int i, j, first, numBounds, num, numHits;
+	idClipModel *touch, *clipModelList[MAX_GENTITIES];
+	int touchMasks[MAX_GENTITIES];
+	idBounds traceBounds[MAX_CLIP_BATCH_BOUNDS];
+	float radius;
+	trace_t trace;
+	const idTraceModel *trm;
+	idGameTiming timing( GAME_TIMING_COLLISION );
+
+	if ( numTraces <= 0 ) {
+		return 0;
+	}
+
+	if ( mdl != NULL ) {
+		for ( i = 0; i < numTraces; i++ ) {
+			if ( ( ends[i] - starts[i] ).LengthSqr() > Square( CM_MAX_TRACE_DIST ) ) {
+				break;
+			}
+		}
+		if ( i < numTraces ) {
+			// let the single translations report the huge translation
+			for ( numHits = i = 0; i < numTraces; i++ ) {
+				numHits += Translation( results[i], starts[i], ends[i], mdl, trmAxis, contentMask, passEntity );
+			}
+			return numHits;
+		}
+	}
+
+	trm = TraceModelForClipModel( mdl );
+
+	if ( !passEntity || passEntity->entityNumber != ENTITYNUM_WORLD ) {
+		// test world
+		idClip::numTranslations += numTraces;
+		collisionModelManager->TranslationBatch( results, starts, ends, numTraces, trm, trmAxis, contentMask, 0, vec3_origin, mat3_default );
+		for ( i = 0; i < numTraces; i++ ) {
+			results[i].c.entityNum = results[i].fraction != 1.0f ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+		}
+	} else {
+		for ( i = 0; i < numTraces; i++ ) {
+			memset( &results[i], 0, sizeof( results[i] ) );
+			results[i].fraction = 1.0f;
+			results[i].endpos = ends[i];
+			results[i].endAxis = trmAxis;
+		}
+	}
+
+	if ( !trm ) {
+		radius = 0.0f;
+	} else {
+		radius = trm->bounds.GetRadius();
+	}
+
+	for ( first = 0; first < numTraces; first += MAX_CLIP_BATCH_BOUNDS ) {
+		numBounds = Min( numTraces - first, MAX_CLIP_BATCH_BOUNDS );
+
+		// get the clip models touching the paths that are not blocked immediately by the world
+		for ( i = 0; i < numBounds; i++ ) {
+			const trace_t &result = results[first + i];
+			if ( result.fraction == 0.0f ) {
+				traceBounds[i].Clear();
+			} else if ( !trm ) {
+				traceBounds[i].FromPointTranslation( starts[first + i], result.endpos - starts[first + i] );
+			} else {
+				traceBounds[i].FromBoundsTranslation( trm->bounds, starts[first + i], trmAxis, result.endpos - starts[first + i] );
+			}
+		}
+
+		num = ClipModelsTouchingBoundsBatch( traceBounds, numBounds, contentMask, clipModelList, touchMasks, MAX_GENTITIES );
+		FilterTraceClipModels( num, passEntity, clipModelList );
+
+		for ( j = 0; j < num; j++ ) {
+			touch = clipModelList[j];
+
+			if ( !touch ) {
+				continue;
+			}
+
+			for ( i = 0; i < numBounds; i++ ) {
+				trace_t &result = results[first + i];
+
+				// if the clip model is not near this path or the path is already blocked
+				if ( !( touchMasks[j] & BIT( i ) ) || result.fraction == 0.0f ) {
+					continue;
+				}
+
+				if ( touch->renderModelHandle != -1 ) {
+					idClip::numRenderModelTraces++;
+					TraceRenderModel( trace, starts[first + i], ends[first + i], radius, trmAxis, touch );
+				} else {
+					idClip::numTranslations++;
+					collisionModelManager->Translation( &trace, starts[first + i], ends[first + i], trm, trmAxis, contentMask,
+											touch->Handle(), touch->origin, touch->axis );
+				}
+
+				if ( trace.fraction < result.fraction ) {
+					result = trace;
+					result.c.entityNum = touch->entity->entityNumber;
+					result.c.id = touch->id;
+				}
+			}
+		}
+	}
+
+	numHits = 0;
+	for ( i = 0; i < numTraces; i++ ) {
+		if ( results[i].fraction < 1.0f ) {
+			numHits++;
+		}
+	}
+
+	return numHits;
+}
+
 /*
 ============
 idClip::Rotation
@@ -1134,6 +1668,7 @@ bool idClip::Rotation( trace_t &results, const idVec3 &start, const idRotation &
 	idBounds traceBounds;
 	trace_t trace;
 	const idTraceModel *trm;
+	idGameTiming timing( GAME_TIMING_COLLISION );
 
 	trm = TraceModelForClipModel( mdl );
 
@@ -1204,6 +1739,7 @@ bool idClip::Motion( trace_t &results, const idVec3 &start, const idVec3 &end, c
 	trace_t translationalTrace, rotationalTrace, trace;
 	idRotation endRotation;
 	const idTraceModel *trm;
+	idGameTiming timing( GAME_TIMING_COLLISION );
 
 	assert( rotation.GetOrigin() == start );
 
@@ -1361,6 +1897,7 @@ int idClip::Contacts( contactInfo_t *contacts, const int maxContacts, const idVe
 	idClipModel *touch, *clipModelList[MAX_GENTITIES];
 	idBounds traceBounds;
 	const idTraceModel *trm;
+	idGameTiming timing( GAME_TIMING_COLLISION );
 
 	trm = TraceModelForClipModel( mdl );
 
@@ -1431,6 +1968,7 @@ int idClip::Contents( const idVec3 &start, const idClipModel *mdl, const idMat3
 	idClipModel *touch, *clipModelList[MAX_GENTITIES];
 	idBounds traceBounds;
 	const idTraceModel *trm;
+	idGameTiming timing( GAME_TIMING_COLLISION );
 
 	trm = TraceModelForClipModel( mdl );
 
@@ -1604,9 +2142,9 @@ idClip::PrintStatistics
 ============
 */
 void idClip::PrintStatistics( void ) {
-	gameLocal.Printf( "t = %-3d, r = %-3d, m = %-3d, render = %-3d, contents = %-3d, contacts = %-3d\n",
-					numTranslations, numRotations, numMotions, numRenderModelTraces, numContents, numContacts );
-	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = 0;
+	gameLocal.Printf( "t = %-3d, r = %-3d, m = %-3d, render = %-3d, contents = %-3d, contacts = %-3d, tree updates = %-3d, tree nodes = %d\n",
+					numTranslations, numRotations, numMotions, numRenderModelTraces, numContents, numContacts, numTreeUpdates, numClipNodes );
+	numRotations = numTranslations = numMotions = numRenderModelTraces = numContents = numContacts = numTreeUpdates = 0;
 }
 
 /*
@@ -1637,6 +2175,46 @@ void idClip::DrawClipModels( const idVec3 &eye, const float radius, const idEnti
 	}
 }
 
+/*
+============
+idClip::DrawClipTree
+
+  leaf nodes of linked clip models are green, leaf nodes kept for unlinked clip models are red
+============
+*/
+void idClip::DrawClipTree( const idVec3 &eye, const float radius, bool showNodes ) const {
+	int stackSize, nodeStack[CLIP_TREE_STACK];
+	idBounds bounds;
+
+	if ( clipRoot == -1 ) {
+		return;
+	}
+
+	bounds = idBounds( eye ).Expand( radius );
+
+	nodeStack[0] = clipRoot;
+	stackSize = 1;
+
+	while ( stackSize > 0 ) {
+		const clipNode_t &node = clipNodes[nodeStack[--stackSize]];
+
+		if ( !node.bounds.IntersectsBounds( bounds ) ) {
+			continue;
+		}
+
+		if ( node.height > 0 ) {
+			if ( showNodes ) {
+				gameRenderWorld->DebugBounds( node.height > 1 ? colorBlue : colorYellow, node.bounds );
+			}
+			nodeStack[stackSize++] = node.children[0];
+			nodeStack[stackSize++] = node.children[1];
+			continue;
+		}
+
+		gameRenderWorld->DebugBounds( node.clipModel->linked ? colorGreen : colorRed, node.bounds );
+	}
+}
+
 /*
 ============
 idClip::DrawModelContactFeature
@@ -40,6 +40,8 @@ If you have questions concerning this license or the applicable additional terms
 #define CLIPMODEL_ID_TO_JOINT_HANDLE( id )	( ( id ) >= 0 ? INVALID_JOINT : ((jointHandle_t) ( -1 - id )) )
 #define JOINT_HANDLE_TO_CLIPMODEL_ID( id )	( -1 - id )
 
+#define MAX_CLIP_BATCH_BOUNDS				32
+
 class idClip;
 class idClipModel;
 class idEntity;
@@ -72,7 +74,7 @@ public:
 
 	void					Link( idClip &clp );				// must have been linked with an entity and id before
 	void					Link( idClip &clp, idEntity *ent, int newId, const idVec3 &newOrigin, const idMat3 &newAxis, int renderModelHandle = -1 );
-	void					Unlink( void );						// unlink from sectors
+	void					Unlink( void );						// unlink from the clip model tree
 	void					SetPosition( const idVec3 &newOrigin, const idMat3 &newAxis );	// unlinks the clip model
 	void					Translate( const idVec3 &translation );							// unlinks the clip model
 	void					Rotate( const idRotation &rotation );							// unlinks the clip model
@@ -96,6 +98,7 @@ public:
 	bool					IsRenderModel( void ) const;		// returns true if this is a render model
 	bool					IsLinked( void ) const;				// returns true if the clip model is linked
 	bool					IsEnabled( void ) const;			// returns true if enabled for collision detection
+	int						GetLinkCount( void ) const;			// clip link count when last linked
 	bool					IsEqual( const idTraceModel &trm ) const;
 	cmHandle_t				Handle( void ) const;				// returns handle used to collide vs this model
 	const idTraceModel *	GetTraceModel( void ) const;
@@ -123,11 +126,12 @@ private:
 	int						traceModelIndex;		// trace model used for collision detection
 	int						renderModelHandle;		// render model def handle
 
-	struct clipLink_s *		clipLinks;				// links into sectors
-	int						touchCount;
+	idClip *				clip;					// clip the model has a leaf node in
+	int						clipNode;				// leaf node in the clip model tree
+	bool					linked;					// true if linked for clipping
+	int						linkCount;				// clip link count when last linked
 
 	void					Init( void );			// initialize
-	void					Link_r( struct clipSector_s *node );
 
 	static int				AllocTraceModel( const idTraceModel &trm );
 	static void				FreeTraceModel( int traceModelIndex );
@@ -220,13 +224,17 @@ ID_INLINE bool idClipModel::IsTraceModel( void ) const {
 }
 
 ID_INLINE bool idClipModel::IsLinked( void ) const {
-	return ( clipLinks != NULL );
+	return linked;
 }
 
 ID_INLINE bool idClipModel::IsEnabled( void ) const {
 	return enabled;
 }
 
+ID_INLINE int idClipModel::GetLinkCount( void ) const {
+	return linkCount;
+}
+
 ID_INLINE bool idClipModel::IsEqual( const idTraceModel &trm ) const {
 	return ( traceModelIndex != -1 && *GetCachedTraceModel( traceModelIndex ) == trm );
 }
@@ -258,6 +266,8 @@ public:
 	// clip versus the rest of the world
 	bool					Translation( trace_t &results, const idVec3 &start, const idVec3 &end,
 								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity );
+	int						TranslationBatch( trace_t *results, const idVec3 *starts, const idVec3 *ends, int numTraces,
+								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity );
 	bool					Rotation( trace_t &results, const idVec3 &start, const idRotation &rotation,
 								const idClipModel *mdl, const idMat3 &trmAxis, int contentMask, const idEntity *passEntity );
 	bool					Motion( trace_t &results, const idVec3 &start, const idVec3 &end, const idRotation &rotation,
@@ -294,25 +304,36 @@ public:
 	// get a contact feature
 	bool					GetModelContactFeature( const contactInfo_t &contact, const idClipModel *clipModel, idFixedWinding &winding ) const;
 
-	// get entities/clip models within or touching the given bounds
+	// get entities/clip models within or touching the given bounds, the most recently linked clip model comes first
 	int						EntitiesTouchingBounds( const idBounds &bounds, int contentMask, idEntity **entityList, int maxCount ) const;
 	int						ClipModelsTouchingBounds( const idBounds &bounds, int contentMask, idClipModel **clipModelList, int maxCount ) const;
+							// get clip models touching any of up to MAX_CLIP_BATCH_BOUNDS bounds, boundsMasks gets a bit set for each bounds touched
+	int						ClipModelsTouchingBoundsBatch( const idBounds *bounds, int numBounds, int contentMask, idClipModel **clipModelList, int *boundsMasks, int maxCount ) const;
 
 	const idBounds &		GetWorldBounds( void ) const;
 	idClipModel *			DefaultClipModel( void );
+							// incremented every time a clip model is linked
+	int						GetLinkCount( void ) const;
+							// removes the leaves of the clip models that were unlinked and not linked again
+	void					RemoveUnlinkedLeaves( void );
 
 							// stats and debug drawing
 	void					PrintStatistics( void );
 	void					DrawClipModels( const idVec3 &eye, const float radius, const idEntity *passEntity );
+	void					DrawClipTree( const idVec3 &eye, const float radius, bool showNodes ) const;
 	bool					DrawModelContactFeature( const contactInfo_t &contact, const idClipModel *clipModel, int lifetime ) const;
 
 private:
-	int						numClipSectors;
-	struct clipSector_s *	clipSectors;
+	struct clipNode_s *		clipNodes;				// dynamic bounding box tree with a leaf per clip model
+	int						numClipNodes;
+	int						maxClipNodes;
+	int						freeClipNode;
+	int						clipRoot;
+	idList<int>				unlinkedLeaves;			// leaves of clip models unlinked since the last RemoveUnlinkedLeaves
+	int						linkCount;
 	idBounds				worldBounds;
 	idClipModel				temporaryClipModel;
 	idClipModel				defaultClipModel;
-	mutable int				touchCount;
 							// statistics
 	int						numTranslations;
 	int						numRotations;
@@ -320,10 +341,17 @@ private:
 	int						numRenderModelTraces;
 	int						numContents;
 	int						numContacts;
+	int						numTreeUpdates;
 
 private:
-	struct clipSector_s *	CreateClipSectors_r( const int depth, const idBounds &bounds, idVec3 &maxSector );
-	void					ClipModelsTouchingBounds_r( const struct clipSector_s *node, struct listParms_s &parms ) const;
+	int						AllocClipNode( void );
+	void					FreeClipNode( int nodeNum );
+	void					InsertLeaf( int leaf );
+	void					RemoveLeaf( int leaf );
+	int						BalanceNode( int nodeNum );
+	void					LinkClipModel( idClipModel *clipModel );
+	void					RemoveClipModel( idClipModel *clipModel );
+	void					FilterTraceClipModels( int num, const idEntity *passEntity, idClipModel **clipModelList ) const;
 	const idTraceModel *	TraceModelForClipModel( const idClipModel *mdl ) const;
 	int						GetTraceClipModels( const idBounds &bounds, int contentMask, const idEntity *passEntity, idClipModel **clipModelList ) const;
 	void					TraceRenderModel( trace_t &trace, const idVec3 &start, const idVec3 &end, const float radius, const idMat3 &axis, idClipModel *touch ) const;
@@ -349,4 +377,8 @@ ID_INLINE idClipModel *idClip::DefaultClipModel( void ) {
 	return &defaultClipModel;
 }
 
+ID_INLINE int idClip::GetLinkCount( void ) const {
+	return linkCount;
+}
+
 #endif /* !__CLIP_H__ */
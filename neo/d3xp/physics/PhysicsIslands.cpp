@@ -0,0 +1,284 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "../Game_local.h"
+
+#define ISLAND_MARGIN				8.0f		// extra space around the bounds of a body
+
+/*
+================
+idPhysicsIslands::idPhysicsIslands
+================
+*/
+idPhysicsIslands::idPhysicsIslands( void ) {
+	memset( bodyForEntity, -1, sizeof( bodyForEntity ) );
+	timeStepMSec = 0;
+	endTimeMSec = 0;
+	numBodies = numIslands = numSerialIslands = numParallel = numDiscarded = 0;
+}
+
+/*
+================
+idPhysicsIslands::Clear
+================
+*/
+void idPhysicsIslands::Clear( void ) {
+	bodies.Clear();
+	sortedBodies.Clear();
+	islandShared.Clear();
+	parallelBodies.Clear();
+	numBodies = numIslands = numSerialIslands = numParallel = numDiscarded = 0;
+}
+
+/*
+================
+idPhysicsIslands::FindIsland
+================
+*/
+int idPhysicsIslands::FindIsland( int body ) {
+	int root, next;
+
+	for ( root = body; bodies[root].parent != root; root = bodies[root].parent ) {
+	}
+	// point the whole path straight at the root
+	while ( bodies[body].parent != root ) {
+		next = bodies[body].parent;
+		bodies[body].parent = root;
+		body = next;
+	}
+	return root;
+}
+
+/*
+================
+idPhysicsIslands::MergeIslands
+================
+*/
+void idPhysicsIslands::MergeIslands( int body1, int body2 ) {
+	int root1, root2;
+
+	root1 = FindIsland( body1 );
+	root2 = FindIsland( body2 );
+	if ( root1 == root2 ) {
+		return;
+	}
+	// the body that thinks first stays the root
+	if ( root1 < root2 ) {
+		bodies[root2].parent = root1;
+	} else {
+		bodies[root1].parent = root2;
+	}
+}
+
+/*
+================
+idPhysicsIslands::SortByMinX
+================
+*/
+int idPhysicsIslands::SortByMinX( const islandSort_s *a, const islandSort_s *b ) {
+	if ( a->minX < b->minX ) {
+		return -1;
+	}
+	if ( a->minX > b->minX ) {
+		return 1;
+	}
+	return a->body - b->body;
+}
+
+/*
+================
+idPhysicsIslands::StepBodies
+================
+*/
+void idPhysicsIslands::StepBodies( void *data, int first, int last ) {
+	idPhysicsIslands *islands = static_cast<idPhysicsIslands *>( data );
+
+	for ( int i = first; i < last; i++ ) {
+		islands->parallelBodies[i]->StepInParallel( islands->timeStepMSec, islands->endTimeMSec );
+	}
+}
+
+/*
+================
+idPhysicsIslands::StepIslands
+
+  Bodies are in the same island when they are in contact or when the space
+  they may sweep through during the frame overlaps. Islands with an entity
+  other than a free rigid body, like a pusher, actor or articulated figure,
+  are left to the game thread. Within an island only the first body in think
+  order is stepped in advance because the others will see it move.
+================
+*/
+void idPhysicsIslands::StepIslands( void ) {
+	int i, j, k, root, numThreads, granularity;
+	idEntity *ent;
+	idPhysics *physics;
+	idVec3 move;
+	islandBody_s body;
+	idGameTiming timing( GAME_TIMING_PHYSICS );
+
+	numBodies = numIslands = numSerialIslands = numParallel = numDiscarded = 0;
+	parallelBodies.SetNum( 0, false );
+
+	if ( g_physicsThreads.GetInteger() == 1 ) {
+		return;
+	}
+
+	timeStepMSec = gameLocal.time - gameLocal.previousTime;
+	endTimeMSec = gameLocal.time;
+
+	// gather the entities that will run physics this frame in think order
+	bodies.SetNum( 0, false );
+	for ( ent = gameLocal.activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
+		if ( !( ent->thinkFlags & TH_PHYSICS ) ) {
+			continue;
+		}
+		if ( gameLocal.inCinematic && g_cinematic.GetBool() && !ent->cinematic ) {
+			continue;
+		}
+		physics = ent->GetPhysics();
+		if ( physics->GetAbsBounds().IsCleared() ) {
+			continue;
+		}
+
+		body.ent = ent;
+		body.rigidBody = NULL;
+		body.parent = bodies.Num();
+
+		if ( ent->GetTeamMaster() == NULL && physics->IsType( idPhysics_RigidBody::Type ) ) {
+			idPhysics_RigidBody *rigidBody = static_cast<idPhysics_RigidBody *>( physics );
+			if ( rigidBody->CanStepInParallel() ) {
+				body.rigidBody = rigidBody;
+			}
+		}
+#ifdef _D3XP
+		// the second time group runs after everything else with a different time
+		if ( ent->timeGroup != TIME_GROUP1 ) {
+			body.rigidBody = NULL;
+		}
+#endif
+		if ( body.rigidBody != NULL ) {
+			numBodies++;
+		}
+
+		move = physics->GetLinearVelocity() * MS2SEC( timeStepMSec );
+		body.bounds = physics->GetAbsBounds();
+		body.bounds.AddBounds( body.bounds + move );
+		body.bounds.ExpandSelf( ISLAND_MARGIN );
+
+		bodyForEntity[ent->entityNumber] = bodies.Num();
+		bodies.Append( body );
+	}
+
+	if ( numBodies >= 2 ) {
+		// bodies in contact are in the same island
+		for ( i = 0; i < bodies.Num(); i++ ) {
+			physics = bodies[i].ent->GetPhysics();
+			for ( j = 0; j < physics->GetNumContacts(); j++ ) {
+				k = physics->GetContact( j ).entityNum;
+				if ( k >= 0 && k < MAX_GENTITIES && bodyForEntity[k] >= 0 ) {
+					MergeIslands( i, bodyForEntity[k] );
+				}
+			}
+		}
+
+		// bodies that may touch during the frame are in the same island
+		sortedBodies.SetNum( bodies.Num(), false );
+		for ( i = 0; i < bodies.Num(); i++ ) {
+			sortedBodies[i].minX = bodies[i].bounds[0].x;
+			sortedBodies[i].body = i;
+		}
+		sortedBodies.Sort( SortByMinX );
+
+		for ( i = 0; i < sortedBodies.Num(); i++ ) {
+			const idBounds &bounds = bodies[sortedBodies[i].body].bounds;
+			for ( j = i + 1; j < sortedBodies.Num() && sortedBodies[j].minX <= bounds[1].x; j++ ) {
+				if ( bounds.IntersectsBounds( bodies[sortedBodies[j].body].bounds ) ) {
+					MergeIslands( sortedBodies[i].body, sortedBodies[j].body );
+				}
+			}
+		}
+
+		// the root of an island is the body that thinks first
+		islandShared.SetNum( bodies.Num(), false );
+		for ( i = 0; i < bodies.Num(); i++ ) {
+			islandShared[i] = false;
+		}
+		for ( i = 0; i < bodies.Num(); i++ ) {
+			root = FindIsland( i );
+			if ( root == i ) {
+				numIslands++;
+			}
+			if ( bodies[i].rigidBody == NULL ) {
+				islandShared[root] = true;
+			}
+		}
+		for ( i = 0; i < bodies.Num(); i++ ) {
+			if ( bodies[i].parent != i ) {
+				continue;
+			}
+			if ( islandShared[i] ) {
+				numSerialIslands++;
+			} else {
+				parallelBodies.Append( bodies[i].rigidBody );
+			}
+		}
+	}
+
+	for ( i = 0; i < bodies.Num(); i++ ) {
+		bodyForEntity[bodies[i].ent->entityNumber] = -1;
+	}
+
+	// a single body is stepped as fast on the game thread
+	if ( parallelBodies.Num() < 2 ) {
+		parallelBodies.SetNum( 0, false );
+		return;
+	}
+	numParallel = parallelBodies.Num();
+
+	numThreads = g_physicsThreads.GetInteger();
+	if ( numThreads <= 0 ) {
+		granularity = 0;
+	} else {
+		granularity = ( parallelBodies.Num() + numThreads - 1 ) / numThreads;
+	}
+	jobManager->ParallelFor( "physicsIslands", parallelBodies.Num(), granularity, StepBodies, this );
+}
+
+/*
+================
+idPhysicsIslands::PrintStatistics
+================
+*/
+void idPhysicsIslands::PrintStatistics( void ) const {
+	gameLocal.Printf( "rigid bodies = %-3d, islands = %-3d, serial islands = %-3d, parallel = %-3d, discarded = %-3d\n",
+					numBodies, numIslands, numSerialIslands, numParallel, numDiscarded );
+}
@@ -51,6 +51,8 @@ const float SUSPEND_LINEAR_VELOCITY			= 10.0f;
 const float SUSPEND_ANGULAR_VELOCITY		= 15.0f;
 const float SUSPEND_LINEAR_ACCELERATION		= 20.0f;
 const float SUSPEND_ANGULAR_ACCELERATION	= 30.0f;
+const float SPARSE_SOLVER_EPSILON			= 1e-4f;
+const float WARM_START_CONTACT_DISTANCE		= 1.0f;
 const idVec6 vec6_lcp_epsilon				= idVec6( LCP_EPSILON, LCP_EPSILON, LCP_EPSILON,
 													 LCP_EPSILON, LCP_EPSILON, LCP_EPSILON );
 
@@ -62,6 +64,14 @@ static int numArticulatedFigures = 0;
 static idTimer timer_total, timer_pc, timer_ac, timer_collision, timer_lcp;
 #endif
 
+// statistics gathered with af_compareSolvers
+static int solverCompareSolves = 0;
+static int solverCompareRows = 0;
+static int solverCompareIterations = 0;
+static float solverCompareMaxError = 0.0f;
+static double solverCompareLcpTime = 0.0;
+static double solverCompareSparseTime = 0.0;
+
 
 
 //===============================================================
@@ -3005,6 +3015,15 @@ void idAFConstraint_Contact::Setup( idAFBody *b1, idAFBody *b2, contactInfo_t &c
 
 	assert( b1 );
 
+	// only keep the multipliers of the previous frame for warm starting if this is still the same contact
+	if ( body1 != b1 || body2 != b2 || contact.entityNum != c.entityNum || contact.id != c.id ||
+			( contact.point - c.point ).LengthSqr() > Square( WARM_START_CONTACT_DISTANCE ) ) {
+		lm.Zero();
+		if ( fc ) {
+			fc->ClearMultiplier();
+		}
+	}
+
 	body1 = b1;
 	body2 = b2;
 	contact = c;
@@ -5044,13 +5063,17 @@ idPhysics_AF::AuxiliaryForces
 */
 void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 	int i, j, k, l, n, m, s, numAuxConstraints, *index, *boxIndex;
-	float *ptr, *j1, *j2, *dstPtr, *forcePtr;
-	float invStep, u;
+	int n1, n2, num1, num2, *index1, *index2, numElements, *rowStart, *column, iterations;
+	int *fullRowStart, *fullColumn, *cursor;
+	float *ptr, *j1, *j2, *dstPtr, *forcePtr, *ptr1, *ptr2, *value, *diagonal, *fullValue;
+	float invStep, u, error;
+	bool useSparse, compare, buildDense, buildSparse, useSymmetry;
 	idAFBody *body;
 	idAFConstraint *constraint;
-	idVecX tmp;
+	idVecX tmp, tmp2;
 	idMatX jmk;
-	idVecX rhs, w, lm, lo, hi;
+	idVecX rhs, w, lm, lo, hi, compareLm;
+	idTimer lcpTimer, sparseTimer;
 
 	// get the number of one dimensional auxiliary constraints
 	for ( numAuxConstraints = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
@@ -5061,6 +5084,17 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 		return;
 	}
 
+	// select the solver, when comparing the solvers both matrices are built
+	if ( af_forceSolver.GetInteger() >= 0 ) {
+		useSparse = ( af_forceSolver.GetInteger() == 1 );
+	} else {
+		useSparse = sparseSolver;
+	}
+	compare = af_compareSolvers.GetBool();
+	buildDense = !useSparse || compare;
+	buildSparse = useSparse || compare;
+	useSymmetry = af_useSymmetry.GetBool();
+
 	// allocate memory to store the body response to auxiliary constraint forces
 	forcePtr = (float *) _alloca16( bodies.Num() * numAuxConstraints * 8 * sizeof( float ) );
 	index = (int *) _alloca16( bodies.Num() * numAuxConstraints * sizeof( int ) );
@@ -5075,7 +5109,7 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 	}
 
 	// set on each body the largest index of an auxiliary constraint constraining the body
-	if ( af_useSymmetry.GetBool() ) {
+	if ( useSymmetry ) {
 		for ( k = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
 			constraint = auxiliaryConstraints[i];
 			for ( j = 0; j < constraint->J1.GetNumRows(); j++, k++ ) {
@@ -5108,12 +5142,144 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 		}
 	}
 
-	// NOTE: the rows are 16 byte padded
-	jmk.SetData( numAuxConstraints, ((numAuxConstraints+3)&~3), MATX_ALLOCA( numAuxConstraints * ((numAuxConstraints+3)&~3) ) );
+	invStep = 1.0f / timeStep;
+
 	tmp.SetData( 6, VECX_ALLOCA( 6 ) );
+	tmp2.SetData( 6, VECX_ALLOCA( 6 ) );
+
+	rowStart = NULL;
+	column = NULL;
+	value = NULL;
+	diagonal = NULL;
+
+	if ( buildSparse ) {
+
+		// the rows only store the elements for the auxiliary constraints the constrained bodies respond to
+		for ( numElements = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
+			constraint = auxiliaryConstraints[i];
+			n = constraint->body1->numResponses;
+			if ( constraint->body2 ) {
+				n += constraint->body2->numResponses;
+			}
+			numElements += constraint->J1.GetNumRows() * n;
+		}
+
+		rowStart = (int *) _alloca16( ( numAuxConstraints + 1 ) * sizeof( int ) );
+		column = (int *) _alloca16( numElements * sizeof( int ) );
+		value = (float *) _alloca16( numElements * sizeof( float ) );
+		diagonal = (float *) _alloca16( numAuxConstraints * sizeof( float ) );
+
+		// create sparse constraint matrix rows by merging the sorted response lists of the constrained bodies,
+		// with symmetry the bodies only respond to the auxiliary constraints up to the diagonal
+		for ( l = 0, k = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
+			constraint = auxiliaryConstraints[i];
+
+			for ( j = 0; j < constraint->J1.GetNumRows(); j++, k++ ) {
+
+				constraint->body1->InverseWorldSpatialInertiaMultiply( tmp, constraint->J1[j] );
+				j1 = tmp.ToFloatPtr();
+				ptr1 = constraint->body1->response;
+				index1 = constraint->body1->responseIndex;
+				num1 = constraint->body1->numResponses;
+
+				if ( constraint->body2 ) {
+					constraint->body2->InverseWorldSpatialInertiaMultiply( tmp2, constraint->J2[j] );
+					j2 = tmp2.ToFloatPtr();
+					ptr2 = constraint->body2->response;
+					index2 = constraint->body2->responseIndex;
+					num2 = constraint->body2->numResponses;
+				} else {
+					j2 = NULL;
+					ptr2 = NULL;
+					index2 = NULL;
+					num2 = 0;
+				}
+
+				rowStart[k] = l;
+				diagonal[k] = 0.0f;
+				for ( n1 = n2 = 0; n1 < num1 || n2 < num2; ) {
+					if ( n2 >= num2 || ( n1 < num1 && index1[n1] <= index2[n2] ) ) {
+						m = index1[n1];
+					} else {
+						m = index2[n2];
+					}
+					if ( useSymmetry && m > k ) {
+						break;
+					}
+					u = 0.0f;
+					if ( n1 < num1 && index1[n1] == m ) {
+						u += j1[0] * ptr1[0] + j1[1] * ptr1[1] + j1[2] * ptr1[2] +
+								j1[3] * ptr1[3] + j1[4] * ptr1[4] + j1[5] * ptr1[5];
+						ptr1 += 8;
+						n1++;
+					}
+					if ( n2 < num2 && index2[n2] == m ) {
+						u += j2[0] * ptr2[0] + j2[1] * ptr2[1] + j2[2] * ptr2[2] +
+								j2[3] * ptr2[3] + j2[4] * ptr2[4] + j2[5] * ptr2[5];
+						ptr2 += 8;
+						n2++;
+					}
+					if ( m == k ) {
+						u += constraint->e[j] * invStep;
+						diagonal[k] = u;
+					}
+					column[l] = m;
+					value[l] = u;
+					l++;
+				}
+			}
+		}
+		rowStart[k] = l;
+
+		// mirror the elements below the diagonal to complete the rows
+		if ( useSymmetry ) {
+			cursor = (int *) _alloca16( numAuxConstraints * sizeof( int ) );
+			memset( cursor, 0, numAuxConstraints * sizeof( int ) );
+			for ( k = 0; k < numAuxConstraints; k++ ) {
+				for ( l = rowStart[k]; l < rowStart[k+1]; l++ ) {
+					cursor[k]++;
+					if ( column[l] != k ) {
+						cursor[column[l]]++;
+					}
+				}
+			}
+
+			fullRowStart = (int *) _alloca16( ( numAuxConstraints + 1 ) * sizeof( int ) );
+			fullRowStart[0] = 0;
+			for ( k = 0; k < numAuxConstraints; k++ ) {
+				fullRowStart[k+1] = fullRowStart[k] + cursor[k];
+				cursor[k] = fullRowStart[k];
+			}
+			numElements = fullRowStart[numAuxConstraints];
+			fullColumn = (int *) _alloca16( numElements * sizeof( int ) );
+			fullValue = (float *) _alloca16( numElements * sizeof( float ) );
+
+			// the rows stay sorted because the mirrored elements are appended in row order
+			for ( k = 0; k < numAuxConstraints; k++ ) {
+				for ( l = rowStart[k]; l < rowStart[k+1]; l++ ) {
+					m = column[l];
+					fullColumn[cursor[k]] = m;
+					fullValue[cursor[k]++] = value[l];
+					if ( m != k ) {
+						fullColumn[cursor[m]] = k;
+						fullValue[cursor[m]++] = value[l];
+					}
+				}
+			}
+
+			rowStart = fullRowStart;
+			column = fullColumn;
+			value = fullValue;
+		}
+	}
+
+	// NOTE: the rows are 16 byte padded
+	if ( buildDense ) {
+		jmk.SetData( numAuxConstraints, ((numAuxConstraints+3)&~3), MATX_ALLOCA( numAuxConstraints * ((numAuxConstraints+3)&~3) ) );
+	}
 
 	// create constraint matrix for auxiliary constraints using a mass matrix adjusted for the primary constraints
-	for ( k = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
+	for ( k = 0, i = 0; buildDense && i < auxiliaryConstraints.Num(); i++ ) {
 		constraint = auxiliaryConstraints[i];
 
 		for ( j = 0; j < constraint->J1.GetNumRows(); j++, k++ ) {
@@ -5122,7 +5288,7 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 			ptr = constraint->body1->response;
 			index = constraint->body1->responseIndex;
 			dstPtr = jmk[k];
-			s = af_useSymmetry.GetBool() ? k + 1 : numAuxConstraints;
+			s = useSymmetry ? k + 1 : numAuxConstraints;
 			for ( l = n = 0, m = index[n]; n < constraint->body1->numResponses && m < s; n++, m = index[n] ) {
 				while( l < m ) {
 					dstPtr[l++] = 0.0f;
@@ -5150,7 +5316,7 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 		}
 	}
 
-	if ( af_useSymmetry.GetBool() ) {
+	if ( buildDense && useSymmetry ) {
 		n = jmk.GetNumColumns();
 		for ( i = 0; i < numAuxConstraints; i++ ) {
 			ptr = jmk.ToFloatPtr() + ( i + 1 ) * n + i;
@@ -5162,8 +5328,6 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 		}
 	}
 
-	invStep = 1.0f / timeStep;
-
 	// calculate body acceleration
 	for ( i = 0; i < bodies.Num(); i++ ) {
 		body = bodies[i];
@@ -5215,23 +5379,84 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 			else {
 				boxIndex[k] = -1;
 			}
-			jmk[k][k] += constraint->e[j] * invStep;
+			if ( buildDense ) {
+				jmk[k][k] += constraint->e[j] * invStep;
+			}
 		}
 	}
 
+	if ( compare ) {
+		compareLm.SetData( numAuxConstraints, VECX_ALLOCA( numAuxConstraints ) );
+	}
+
+	iterations = 0;
+
+	if ( useSparse ) {
+
+		// warm start with the lagrange multipliers from the previous frame
+		GetAuxiliaryMultipliers( lm );
+
 #ifdef AF_TIMINGS
-	timer_lcp.Start();
+		timer_lcp.Start();
 #endif
+		sparseTimer.Start();
 
-	// calculate lagrange multipliers for auxiliary constraints
-	if ( !lcp->Solve( jmk, lm, rhs, lo, hi, boxIndex ) ) {
-		return;		// bad monkey!
-	}
+		// calculate lagrange multipliers for auxiliary constraints
+		iterations = SolveSparse( numAuxConstraints, rowStart, column, value, diagonal, lm, rhs, lo, hi, boxIndex );
+
+		sparseTimer.Stop();
+#ifdef AF_TIMINGS
+		timer_lcp.Stop();
+#endif
+
+		if ( compare ) {
+			lcpTimer.Start();
+			if ( !lcp->Solve( jmk, compareLm, rhs, lo, hi, boxIndex ) ) {
+				compare = false;
+			}
+			lcpTimer.Stop();
+		}
+	} else {
+
+#ifdef AF_TIMINGS
+		timer_lcp.Start();
+#endif
+		lcpTimer.Start();
+
+		// calculate lagrange multipliers for auxiliary constraints
+		if ( !lcp->Solve( jmk, lm, rhs, lo, hi, boxIndex ) ) {
+			return;		// bad monkey!
+		}
 
+		lcpTimer.Stop();
 #ifdef AF_TIMINGS
-	timer_lcp.Stop();
+		timer_lcp.Stop();
 #endif
 
+		if ( compare ) {
+			GetAuxiliaryMultipliers( compareLm );
+			sparseTimer.Start();
+			iterations = SolveSparse( numAuxConstraints, rowStart, column, value, diagonal, compareLm, rhs, lo, hi, boxIndex );
+			sparseTimer.Stop();
+		}
+	}
+
+	// the relative difference between the lcp and sparse solutions
+	if ( compare ) {
+		error = 0.0f;
+		u = 1.0f;
+		for ( k = 0; k < numAuxConstraints; k++ ) {
+			error = Max( error, idMath::Fabs( lm[k] - compareLm[k] ) );
+			u = Max( u, idMath::Fabs( lm[k] ) );
+		}
+		solverCompareSolves++;
+		solverCompareRows += numAuxConstraints;
+		solverCompareIterations += iterations;
+		solverCompareLcpTime += lcpTimer.Milliseconds();
+		solverCompareSparseTime += sparseTimer.Milliseconds();
+		solverCompareMaxError = Max( solverCompareMaxError, error / u );
+	}
+
 	// calculate auxiliary constraint forces
 	for ( k = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
 		constraint = auxiliaryConstraints[i];
@@ -5264,6 +5489,127 @@ void idPhysics_AF::AuxiliaryForces( float timeStep ) {
 	}
 }
 
+/*
+================
+idPhysics_AF::GetAuxiliaryMultipliers
+
+  get the lagrange multipliers of the auxiliary constraints from the previous frame
+================
+*/
+void idPhysics_AF::GetAuxiliaryMultipliers( idVecX &lm ) const {
+	int i, j, k;
+	idAFConstraint *constraint;
+
+	for ( k = 0, i = 0; i < auxiliaryConstraints.Num(); i++ ) {
+		constraint = auxiliaryConstraints[i];
+		for ( j = 0; j < constraint->J1.GetNumRows(); j++, k++ ) {
+			if ( j < constraint->lm.GetSize() ) {
+				lm[k] = constraint->lm[j];
+			} else {
+				lm[k] = 0.0f;
+			}
+		}
+	}
+}
+
+/*
+================
+idPhysics_AF::SolveSparse
+
+  Projected Gauss-Seidel on the sparse rows of the auxiliary constraint matrix.
+  The bounds of box constrained variables are scaled with the current value of
+  the variable they reference, the same as the lcp solver does.
+  Returns the number of iterations used.
+================
+*/
+int idPhysics_AF::SolveSparse( int numRows, const int *rowStart, const int *column, const float *value, const float *diagonal,
+									idVecX &x, const idVecX &b, const idVecX &lo, const idVecX &hi, const int *boxIndex ) const {
+	int i, j, iteration, maxIterations;
+	float s, l, h, delta, maxDelta, maxX;
+
+	maxIterations = af_sparseIterations.GetInteger();
+
+	for ( iteration = 0; iteration < maxIterations; iteration++ ) {
+
+		maxDelta = 0.0f;
+		maxX = 1.0f;
+
+		for ( i = 0; i < numRows; i++ ) {
+
+			if ( diagonal[i] <= 0.0f ) {
+				x[i] = 0.0f;
+				continue;
+			}
+
+			l = lo[i];
+			h = hi[i];
+			if ( boxIndex[i] >= 0 ) {
+				s = x[boxIndex[i]];
+				if ( l != -idMath::INFINITY ) {
+					l = - idMath::Fabs( l * s );
+				}
+				if ( h != idMath::INFINITY ) {
+					h = idMath::Fabs( h * s );
+				}
+			}
+
+			s = b[i];
+			for ( j = rowStart[i]; j < rowStart[i+1]; j++ ) {
+				s -= value[j] * x[column[j]];
+			}
+			s = x[i] + s / diagonal[i];
+
+			if ( s < l ) {
+				s = l;
+			} else if ( s > h ) {
+				s = h;
+			}
+
+			delta = idMath::Fabs( s - x[i] );
+			if ( delta > maxDelta ) {
+				maxDelta = delta;
+			}
+			if ( idMath::Fabs( s ) > maxX ) {
+				maxX = idMath::Fabs( s );
+			}
+			x[i] = s;
+		}
+
+		if ( maxDelta <= SPARSE_SOLVER_EPSILON * maxX ) {
+			return iteration + 1;
+		}
+	}
+	return maxIterations;
+}
+
+/*
+================
+idPhysics_AF::SolverStats_f
+================
+*/
+void idPhysics_AF::SolverStats_f( const idCmdArgs &args ) {
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "clear" ) ) {
+		solverCompareSolves = 0;
+		solverCompareRows = 0;
+		solverCompareIterations = 0;
+		solverCompareMaxError = 0.0f;
+		solverCompareLcpTime = 0.0;
+		solverCompareSparseTime = 0.0;
+		return;
+	}
+
+	if ( !solverCompareSolves ) {
+		gameLocal.Printf( "no solver statistics, set af_compareSolvers 1 to collect them\n" );
+		return;
+	}
+
+	gameLocal.Printf( "%d auxiliary constraint solves, %1.1f rows per solve\n", solverCompareSolves, (float) solverCompareRows / solverCompareSolves );
+	gameLocal.Printf( "lcp   : %8.3f msec, %1.4f msec per solve\n", solverCompareLcpTime, solverCompareLcpTime / solverCompareSolves );
+	gameLocal.Printf( "sparse: %8.3f msec, %1.4f msec per solve, %1.1f iterations per solve\n", solverCompareSparseTime,
+						solverCompareSparseTime / solverCompareSolves, (float) solverCompareIterations / solverCompareSolves );
+	gameLocal.Printf( "max relative lagrange multiplier difference %f\n", solverCompareMaxError );
+}
+
 /*
 ================
 idPhysics_AF::VerifyContactConstraints
@@ -6640,6 +6986,7 @@ idPhysics_AF::idPhysics_AF( void ) {
 	selfCollision = true;
 	comeToRest = true;
 	linearTime = true;
+	sparseSolver = false;
 	noImpact = false;
 	worldConstraintsLocked = false;
 	forcePushable = false;
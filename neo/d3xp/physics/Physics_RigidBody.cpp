@@ -469,6 +469,8 @@ idPhysics_RigidBody::idPhysics_RigidBody( void ) {
 	hasMaster = false;
 	isOrientated = false;
 
+	memset( &parallelStep, 0, sizeof( parallelStep ) );
+
 #ifdef RB_TIMINGS
 	lastTimerReset = 0;
 #endif
@@ -609,6 +611,7 @@ void idPhysics_RigidBody::SetClipModel( idClipModel *model, const float density,
 		delete clipModel;
 	}
 	clipModel = model;
+	parallelStep.valid = false;
 	clipModel->Link( gameLocal.clip, self, 0, current.i.position, current.i.orientation );
 
 	// get mass properties from the trace model
@@ -820,6 +823,143 @@ const idBounds &idPhysics_RigidBody::GetAbsBounds( int id ) const {
 	return clipModel->GetAbsBounds();
 }
 
+/*
+================
+idPhysics_RigidBody::CanStepInParallel
+
+  Only free bodies that do not collide with render models can be stepped
+  before the entity thinks.
+================
+*/
+bool idPhysics_RigidBody::CanStepInParallel( void ) const {
+	return ( current.atRest < 0 && !hasMaster && !dropToFloor && clipModel != NULL && clipModel->IsTraceModel() &&
+				!( clipMask & CONTENTS_RENDERMODEL ) );
+}
+
+/*
+================
+idPhysics_RigidBody::GetParallelStepTouching
+================
+*/
+void idPhysics_RigidBody::GetParallelStepTouching( const idBounds &bounds, int &numTouching, unsigned int &touchHash, int &lastLinkCount ) const {
+	int i, num;
+	idClipModel *cm, *clipModelList[MAX_GENTITIES];
+
+	num = gameLocal.clip.ClipModelsTouchingBounds( bounds, clipMask, clipModelList, MAX_GENTITIES );
+
+	numTouching = 0;
+	touchHash = 0;
+	lastLinkCount = 0;
+	for ( i = 0; i < num; i++ ) {
+		cm = clipModelList[i];
+		if ( cm->GetEntity() == self ) {
+			continue;
+		}
+		numTouching++;
+		// the list order depends on the tree so the hash should not
+		touchHash += ( (unsigned int) cm->GetLinkCount() * 31 + (unsigned int) cm->GetContents() ) * 31 + (unsigned int) cm->GetId();
+		lastLinkCount = Max( lastLinkCount, cm->GetLinkCount() );
+	}
+}
+
+/*
+================
+idPhysics_RigidBody::StepInParallel
+
+  Does the integration, collision detection and contact determination of
+  Evaluate without changing anything but the parallel step. Evaluate uses
+  the result if nothing that went into the step changed in the mean time.
+  Runs on a worker thread.
+================
+*/
+void idPhysics_RigidBody::StepInParallel( int timeStepMSec, int endTimeMSec ) {
+	float timeStep;
+	int lastLinkCount;
+	idVec6 dir;
+	rigidBodyParallelStep_t &step = parallelStep;
+
+	step.valid = false;
+
+	timeStep = MS2SEC( timeStepMSec );
+	if ( timeStep <= 0.0f || !CanStepInParallel() ) {
+		return;
+	}
+
+	step.timeStepMSec = timeStepMSec;
+	step.endTimeMSec = endTimeMSec;
+	step.linkCount = gameLocal.clip.GetLinkCount();
+
+	// Evaluate sets the time step before it starts
+	step.start = current;
+	step.start.lastTimeStep = timeStep;
+	step.gravityVector = gravityVector;
+	step.mass = mass;
+	step.linearFriction = linearFriction;
+	step.angularFriction = angularFriction;
+	step.clipMask = clipMask;
+
+	step.next = step.start;
+	Integrate( timeStep, step.next );
+	step.collided = CheckForCollisions( timeStep, step.next, step.collision );
+
+	// without a collision the momentum does not change before the contacts are determined
+	if ( !step.collided && !noContact ) {
+		dir.SubVec3(0) = step.next.i.linearMomentum + timeStep * gravityVector * mass;
+		dir.SubVec3(1) = step.next.i.angularMomentum;
+		dir.SubVec3(0).Normalize();
+		dir.SubVec3(1).Normalize();
+		step.numContacts = gameLocal.clip.Contacts( step.contacts, RB_MAX_CONTACTS, step.next.i.position,
+						dir, CONTACT_EPSILON, clipModel, step.next.i.orientation, clipMask, self );
+	} else {
+		step.numContacts = -1;
+	}
+
+	// anything that moves within these bounds before Evaluate invalidates the step
+	step.bounds.Clear();
+	step.bounds.AddPoint( step.start.i.position );
+	step.bounds.AddPoint( step.next.i.position );
+	step.bounds.ExpandSelf( clipModel->GetBounds().GetRadius() + CONTACT_EPSILON + 1.0f );
+	GetParallelStepTouching( step.bounds, step.numTouching, step.touchHash, lastLinkCount );
+
+	step.valid = true;
+}
+
+/*
+================
+idPhysics_RigidBody::UseParallelStep
+================
+*/
+bool idPhysics_RigidBody::UseParallelStep( int timeStepMSec, int endTimeMSec, rigidBodyPState_t &next, trace_t &collision, bool &collided ) {
+	int numTouching, lastLinkCount;
+	unsigned int touchHash;
+
+	if ( !parallelStep.valid ) {
+		return false;
+	}
+	parallelStep.valid = false;
+
+	if ( parallelStep.timeStepMSec != timeStepMSec || parallelStep.endTimeMSec != endTimeMSec ||
+			memcmp( &parallelStep.start, &current, sizeof( current ) ) != 0 ||
+				parallelStep.gravityVector != gravityVector || parallelStep.mass != mass ||
+					parallelStep.linearFriction != linearFriction || parallelStep.angularFriction != angularFriction ||
+						parallelStep.clipMask != clipMask ) {
+		gameLocal.physicsIslands.ParallelStepDiscarded();
+		return false;
+	}
+
+	GetParallelStepTouching( parallelStep.bounds, numTouching, touchHash, lastLinkCount );
+	if ( numTouching != parallelStep.numTouching || touchHash != parallelStep.touchHash || lastLinkCount > parallelStep.linkCount ) {
+		gameLocal.physicsIslands.ParallelStepDiscarded();
+		return false;
+	}
+
+	next = parallelStep.next;
+	collision = parallelStep.collision;
+	collided = parallelStep.collided;
+
+	return true;
+}
+
 /*
 ================
 idPhysics_RigidBody::Evaluate
@@ -838,7 +978,7 @@ bool idPhysics_RigidBody::Evaluate( int timeStepMSec, int endTimeMSec ) {
 	idVec3 oldOrigin, masterOrigin;
 	idMat3 oldAxis, masterAxis;
 	float timeStep;
-	bool collided, cameToRest = false;
+	bool collided, cameToRest = false, parallel;
 
 	timeStep = MS2SEC( timeStepMSec );
 	current.lastTimeStep = timeStep;
@@ -887,21 +1027,25 @@ bool idPhysics_RigidBody::Evaluate( int timeStepMSec, int endTimeMSec ) {
 
 	clipModel->Unlink();
 
-	next = current;
+	parallel = UseParallelStep( timeStepMSec, endTimeMSec, next, collision, collided );
+
+	if ( !parallel ) {
+		next = current;
 
-	// calculate next position and orientation
-	Integrate( timeStep, next );
+		// calculate next position and orientation
+		Integrate( timeStep, next );
 
 #ifdef RB_TIMINGS
-	timer_collision.Start();
+		timer_collision.Start();
 #endif
 
-	// check for collisions from the current to the next state
-	collided = CheckForCollisions( timeStep, next, collision );
+		// check for collisions from the current to the next state
+		collided = CheckForCollisions( timeStep, next, collision );
 
 #ifdef RB_TIMINGS
-	timer_collision.Stop();
+		timer_collision.Stop();
 #endif
+	}
 
 	// set the new state
 	current = next;
@@ -924,7 +1068,16 @@ bool idPhysics_RigidBody::Evaluate( int timeStepMSec, int endTimeMSec ) {
 		timer_collision.Start();
 #endif
 		// get contacts
-		EvaluateContacts();
+		if ( parallel && parallelStep.numContacts >= 0 ) {
+			ClearContacts();
+			contacts.SetNum( parallelStep.numContacts, false );
+			for ( int i = 0; i < parallelStep.numContacts; i++ ) {
+				contacts[i] = parallelStep.contacts[i];
+			}
+			AddContactEntitiesForContacts();
+		} else {
+			EvaluateContacts();
+		}
 
 #ifdef RB_TIMINGS
 		timer_collision.Stop();
@@ -1357,13 +1510,13 @@ bool idPhysics_RigidBody::EvaluateContacts( void ) {
 
 	ClearContacts();
 
-	contacts.SetNum( 10, false );
+	contacts.SetNum( RB_MAX_CONTACTS, false );
 
 	dir.SubVec3(0) = current.i.linearMomentum + current.lastTimeStep * gravityVector * mass;
 	dir.SubVec3(1) = current.i.angularMomentum;
 	dir.SubVec3(0).Normalize();
 	dir.SubVec3(1).Normalize();
-	num = gameLocal.clip.Contacts( &contacts[0], 10, clipModel->GetOrigin(),
+	num = gameLocal.clip.Contacts( &contacts[0], RB_MAX_CONTACTS, clipModel->GetOrigin(),
 					dir, CONTACT_EPSILON, clipModel, clipModel->GetAxis(), clipMask, self );
 	contacts.SetNum( num, false );
 
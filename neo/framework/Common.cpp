@@ -2367,6 +2367,7 @@ void idCommonLocal::InitCommands( void ) {
 	// idLib commands
 	cmdSystem->AddCommand( "memoryDump", Mem_Dump_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "creates a memory dump" );
 	cmdSystem->AddCommand( "memoryDumpCompressed", Mem_DumpCompressed_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "creates a compressed memory dump" );
+	cmdSystem->AddCommand( "memoryThreadStats", Mem_ThreadStats_f, CMD_FL_SYSTEM, "shows per thread heap usage and allocation churn" );
 	cmdSystem->AddCommand( "showStringMemory", idStr::ShowMemoryUsage_f, CMD_FL_SYSTEM, "shows memory used by strings" );
 	cmdSystem->AddCommand( "showDictMemory", idDict::ShowMemoryUsage_f, CMD_FL_SYSTEM, "shows memory used by dictionaries" );
 	cmdSystem->AddCommand( "listDictKeys", idDict::ListKeys_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "lists all keys used by dictionaries" );
@@ -2438,6 +2439,7 @@ idCommonLocal::Frame
 */
 void idCommonLocal::Frame( void ) {
 	try {
+		idProfileZone zone( "Common::Frame" );
 
 		// pump all the events
 		Sys_GenerateEvents();
@@ -2484,6 +2486,8 @@ void idCommonLocal::Frame( void ) {
 		// set idLib frame number for frame based memory dumps
 		idLib::frameNumber = com_frameNumber;
 
+		profiler->EndFrame();
+
 		// the FPU stack better be empty at this point or some bad code or compiler bug left values on the stack
 		if ( !Sys_FPU_StackIsEmpty() ) {
 			Printf( Sys_FPU_GetState() );
@@ -2586,6 +2590,8 @@ void idCommonLocal::Async( void ) {
 		return;
 	}
 
+	profiler->SetThreadName( "async" );
+
 	int	msec = Sys_Milliseconds();
 	if ( !lastTicMsec ) {
 		lastTicMsec = msec - USERCMD_MSEC;
@@ -2669,6 +2675,8 @@ void idCommonLocal::LoadGameDLL( void ) {
 	gameImport.declManager				= ::declManager;
 	gameImport.AASFileManager			= ::AASFileManager;
 	gameImport.collisionModelManager	= ::collisionModelManager;
+	gameImport.jobManager				= ::jobManager;
+	gameImport.profiler					= ::profiler;
 
 	gameExport							= *GetGameAPI( &gameImport );
 
@@ -2822,6 +2830,11 @@ void idCommonLocal::Init( int argc, const char **argv, const char *cmdline ) {
 		// initialize processor specific SIMD implementation
 		InitSIMD();
 
+		// start the job worker threads
+		jobManager->Init();
+
+		profiler->Init();
+
 		// init commands
 		InitCommands();
 
@@ -2880,6 +2893,11 @@ void idCommonLocal::Shutdown( void ) {
 	// game specific shut down
 	ShutdownGame( false );
 
+	// stop the job worker threads
+	jobManager->Shutdown();
+
+	profiler->Shutdown();
+
 	// shut down non-portable system services
 	Sys_Shutdown();
 
@@ -231,6 +231,13 @@ float SCR_DrawMemoryUsage( float y ) {
 	Mem_GetFrameStats( allocs, frees );
 	SCR_DrawTextRightAlign( y, "frame alloc: %4d, %4dkB  frame free: %4d, %4dkB", allocs.num, allocs.totalSize>>10, frees.num, frees.totalSize>>10 );
 
+	if ( Mem_GetNumThreads() > 1 ) {
+		for ( int i = 0; i < Mem_GetNumThreads(); i++ ) {
+			Mem_GetThreadFrameStats( i, allocs, frees );
+			SCR_DrawTextRightAlign( y, "thread %d alloc: %4d, %4dkB  free: %4d, %4dkB", i, allocs.num, allocs.totalSize>>10, frees.num, frees.totalSize>>10 );
+		}
+	}
+
 	Mem_ClearFrameStats();
 
 	return y;
@@ -589,6 +589,9 @@ bool idDeclAF::WriteSettings( idFile *f ) const {
 	f->WriteFloatString( "\tcontents %s\n", ContentsToString( contents, str ) );
 	f->WriteFloatString( "\tclipMask %s\n", ContentsToString( clipMask, str ) );
 	f->WriteFloatString( "\tselfCollision %d\n", selfCollision );
+	if ( sparseSolver ) {
+		f->WriteFloatString( "\tsparseSolver %d\n", sparseSolver );
+	}
 	f->WriteFloatString( "}\n" );
 	return true;
 }
@@ -1411,6 +1414,8 @@ bool idDeclAF::ParseSettings( idLexer &src ) {
 			ParseContents( src, clipMask );
 		} else if ( !token.Icmp( "selfCollision" ) ) {
 			selfCollision = src.ParseBool();
+		} else if ( !token.Icmp( "sparseSolver" ) ) {
+			sparseSolver = src.ParseBool();
 		} else if ( token == "}" ) {
 			break;
 		} else {
@@ -1576,6 +1581,7 @@ void idDeclAF::FreeData( void ) {
 	minMoveTime = -1.0f;
 	maxMoveTime = -1.0f;
 	selfCollision = true;
+	sparseSolver = false;
 	contents = CONTENTS_CORPSE;
 	clipMask = CONTENTS_SOLID | CONTENTS_CORPSE;
 	bodies.DeleteContents( true );
@@ -368,6 +368,8 @@ public:
 	virtual int				GetOSMask( void );
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp );
 	virtual void			FreeFile( void *buffer );
+	virtual int				MapFile( const char *relativePath, const void **buffer, ID_TIME_T *timestamp );
+	virtual void			UnmapFile( const void *buffer );
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" );
 	virtual void			RemoveFile( const char *relativePath );	
 	virtual idFile *		OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak = NULL, bool allowCopyFiles = true, const char* gamedir = NULL );
@@ -447,6 +449,14 @@ private:
 
 	int						d3xp;	// 0: didn't check, -1: not installed, 1: installed
 
+	typedef struct {
+		const void *		buffer;
+		int					length;
+		bool				mapped;			// false if the file was read into memory
+	} mappedFile_t;
+
+	idList<mappedFile_t>	mappedFiles;
+
 private:
 	void					ReplaceSeparators( idStr &path, char sep = PATHSEPERATOR_CHAR );
 	long					HashFileName( const char *fname ) const;
@@ -1156,6 +1166,97 @@ void idFileSystemLocal::FreeFile( void *buffer ) {
 	Mem_Free( buffer );
 }
 
+/*
+============
+idFileSystemLocal::MapFile
+
+Files in directories are mapped into memory, files inside pak files
+are read like ReadFile does, with a trailing 0
+============
+*/
+int idFileSystemLocal::MapFile( const char *relativePath, const void **buffer, ID_TIME_T *timestamp ) {
+	mappedFile_t	mapped;
+	idFile *		f;
+	int				len;
+
+	if ( !searchPaths ) {
+		common->FatalError( "Filesystem call made without initialization\n" );
+	}
+
+	if ( !relativePath || !relativePath[0] ) {
+		common->FatalError( "idFileSystemLocal::MapFile with empty name\n" );
+	}
+
+	*buffer = NULL;
+	if ( timestamp ) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+
+	f = OpenFileRead( relativePath );
+	if ( f == NULL ) {
+		return -1;
+	}
+	len = f->Length();
+
+	if ( timestamp ) {
+		*timestamp = f->Timestamp();
+	}
+
+	mapped.buffer = NULL;
+	mapped.length = len;
+	mapped.mapped = false;
+
+	idFile_Permanent *permanent = dynamic_cast<idFile_Permanent *>( f );
+	if ( permanent != NULL && len > 0 ) {
+		mapped.buffer = Sys_MapFile( permanent->GetFilePtr(), len );
+		mapped.mapped = ( mapped.buffer != NULL );
+	}
+
+	if ( !mapped.mapped ) {
+		byte *buf = (byte *)Mem_Alloc( len + 1 );
+		f->Read( buf, len );
+		buf[len] = 0;
+		mapped.buffer = buf;
+	}
+
+	CloseFile( f );
+
+	loadCount++;
+	loadStack++;
+
+	mappedFiles.Append( mapped );
+
+	*buffer = mapped.buffer;
+	return len;
+}
+
+/*
+============
+idFileSystemLocal::UnmapFile
+============
+*/
+void idFileSystemLocal::UnmapFile( const void *buffer ) {
+	if ( !buffer ) {
+		common->FatalError( "idFileSystemLocal::UnmapFile( NULL )" );
+	}
+
+	for ( int i = 0; i < mappedFiles.Num(); i++ ) {
+		if ( mappedFiles[i].buffer != buffer ) {
+			continue;
+		}
+		if ( mappedFiles[i].mapped ) {
+			Sys_UnmapFile( mappedFiles[i].buffer, mappedFiles[i].length );
+		} else {
+			Mem_Free( const_cast<void *>( mappedFiles[i].buffer ) );
+		}
+		mappedFiles.RemoveIndex( i );
+		loadStack--;
+		return;
+	}
+
+	common->FatalError( "idFileSystemLocal::UnmapFile: buffer wasn't mapped" );
+}
+
 /*
 ============
 idFileSystemLocal::WriteFile
@@ -220,6 +220,12 @@ public:
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
 							// Frees the memory allocated by ReadFile.
 	virtual void			FreeFile( void *buffer ) = 0;
+							// Maps a complete file into memory read only, files inside pak files
+							// or files that can't be mapped are read into memory instead.
+							// Returns the length of the file, or -1 on failure.
+	virtual int				MapFile( const char *relativePath, const void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+							// Releases the memory returned by MapFile.
+	virtual void			UnmapFile( const void *buffer ) = 0;
 							// Writes a complete file, will create any needed subdirectories.
 							// Returns the length of the file, or -1 on failure.
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" ) = 0;
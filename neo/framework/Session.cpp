@@ -317,6 +317,7 @@ void idSessionLocal::Clear() {
 	writeDemo = NULL;
 	renderdemoVersion = 0;
 	cmdDemoFile = NULL;
+	mapSpawnRandSeed = -1;
 
 	syncNextGameFrame = false;
 	mapSpawned = false;
@@ -763,6 +764,19 @@ static void Session_EndOfDemo_f( const idCmdArgs &args ) {
 }
 #endif
 
+/*
+================
+Session_BenchGame_f
+================
+*/
+static void Session_BenchGame_f( const idCmdArgs &args ) {
+	if ( args.Argc() < 3 ) {
+		common->Printf( "usage: benchGame <map> <frames> [cmdDemo]\n" );
+		return;
+	}
+	sessLocal.BenchGame( args.Argv( 1 ), atoi( args.Argv( 2 ) ), args.Argc() > 3 ? args.Argv( 3 ) : NULL );
+}
+
 /*
 ================
 Session_ExitCmdDemo_f
@@ -1401,6 +1415,153 @@ void idSessionLocal::TimeCmdDemo( const char *demoName ) {
 	common->Printf( "%i seconds of game, replayed in %5.1f seconds\n", count / 60, sec );
 }
 
+/*
+===============
+idSessionLocal::BenchGame
+
+Loads a map and runs the game logic as fast as possible without rendering,
+either with idle user commands or with the user commands from a command demo.
+The map is always spawned with the same random seed so the state hash can be
+compared between runs to detect divergence.
+===============
+*/
+void idSessionLocal::BenchGame( const char *mapName, int numFrames, const char *demoName ) {
+	static const char *timingNames[GAME_TIMING_NUM] = { "think", "physics", "script", "pathing", "collision", "events", "animation" };
+	int				i, numRun;
+	idFile *		demoFile;
+	idStr			fullDemoName;
+	logCmd_t		logCmd;
+	usercmd_t		cmd;
+	gameReturn_t	ret;
+	gameTimings_t	timings;
+	idTimer			totalTimer, frameTimer;
+	double			frameMsec, minMsec, maxMsec, otherMsec;
+
+	if ( idAsyncNetwork::IsActive() ) {
+		common->Printf( "benchGame can't be used while a network game is running\n" );
+		return;
+	}
+
+	// exit any current game
+	Stop();
+
+	demoFile = NULL;
+	if ( demoName && demoName[0] ) {
+		fullDemoName = "demos/";
+		fullDemoName += demoName;
+		fullDemoName.DefaultFileExtension( ".cdemo" );
+		demoFile = fileSystem->OpenFileRead( fullDemoName );
+		if ( !demoFile ) {
+			common->Printf( "Couldn't open %s\n", fullDemoName.c_str() );
+			return;
+		}
+		LoadCmdDemoFromFile( demoFile );
+		fileSystem->CloseFile( demoFile );
+		demoFile = NULL;
+
+		if ( idStr::Icmp( mapSpawnData.serverInfo.GetString( "si_map" ), mapName ) != 0 ) {
+			common->Printf( "%s was recorded on %s\n", fullDemoName.c_str(), mapSpawnData.serverInfo.GetString( "si_map" ) );
+			return;
+		}
+	} else {
+		// same setup as a new single player game with default user info
+		mapSpawnData.userInfo[0].Clear();
+		mapSpawnData.persistentPlayerInfo[0].Clear();
+		mapSpawnData.userInfo[0] = *cvarSystem->MoveCVarsToDict( CVAR_USERINFO );
+
+		mapSpawnData.serverInfo.Clear();
+		mapSpawnData.serverInfo = *cvarSystem->MoveCVarsToDict( CVAR_SERVERINFO );
+		mapSpawnData.serverInfo.Set( "si_gameType", "singleplayer" );
+		mapSpawnData.serverInfo.Set( "si_map", mapName );
+
+		mapSpawnData.syncedCVars.Clear();
+		mapSpawnData.syncedCVars = *cvarSystem->MoveCVarsToDict( CVAR_NETWORKSYNC );
+	}
+
+	// spawn the map with a fixed random seed
+	mapSpawnRandSeed = BENCH_GAME_RANDSEED;
+	ExecuteMapChange( true );
+	mapSpawnRandSeed = -1;
+	ClearWipe();
+
+	if ( !mapSpawned ) {
+		return;
+	}
+
+	// reopen the demo and skip the map spawn data, the map change closes any command demo
+	if ( fullDemoName.Length() ) {
+		demoFile = fileSystem->OpenFileRead( fullDemoName );
+		if ( demoFile ) {
+			LoadCmdDemoFromFile( demoFile );
+		}
+	}
+
+	common->Printf( "--------- Game Benchmark ----------\n" );
+
+	memset( &cmd, 0, sizeof( cmd ) );
+	minMsec = idMath::INFINITY;
+	maxMsec = 0.0;
+
+	game->EnableTimings( true );
+	totalTimer.Start();
+
+	for ( numRun = 0; numRun < numFrames; numRun++ ) {
+		if ( demoFile ) {
+			if ( demoFile->Read( &logCmd, sizeof( logCmd ) ) == sizeof( logCmd ) ) {
+				cmd = logCmd.cmd;
+				cmd.ByteSwap();
+			} else {
+				common->Printf( "command demo ended after %d frames, continuing with idle commands\n", numRun );
+				fileSystem->CloseFile( demoFile );
+				demoFile = NULL;
+				memset( &cmd, 0, sizeof( cmd ) );
+			}
+		}
+
+		frameTimer.Clear();
+		frameTimer.Start();
+		ret = game->RunFrame( &cmd );
+		frameTimer.Stop();
+
+		frameMsec = frameTimer.Milliseconds();
+		if ( frameMsec < minMsec ) {
+			minMsec = frameMsec;
+		}
+		if ( frameMsec > maxMsec ) {
+			maxMsec = frameMsec;
+		}
+
+		if ( ret.sessionCommand[0] ) {
+			common->Printf( "stopped after %d frames by session command '%s'\n", numRun + 1, ret.sessionCommand );
+			numRun++;
+			break;
+		}
+	}
+
+	totalTimer.Stop();
+	game->GetTimings( timings );
+	game->EnableTimings( false );
+
+	if ( demoFile ) {
+		fileSystem->CloseFile( demoFile );
+	}
+
+	if ( numRun == 0 ) {
+		return;
+	}
+
+	common->Printf( "map %s, %d frames, %d entities\n", mapName, numRun, timings.numEntities );
+	common->Printf( "%8.3f ms/frame (min %1.3f, max %1.3f)\n", totalTimer.Milliseconds() / numRun, minMsec, maxMsec );
+	otherMsec = totalTimer.Milliseconds();
+	for ( i = 0; i < GAME_TIMING_NUM; i++ ) {
+		common->Printf( "%8.3f ms/frame %s\n", timings.msec[i] / numRun, timingNames[i] );
+		otherMsec -= timings.msec[i];
+	}
+	common->Printf( "%8.3f ms/frame other\n", otherMsec / numRun );
+	common->Printf( "state hash 0x%08x\n", timings.stateHash );
+	common->Printf( "-----------------------------------\n" );
+}
+
 /*
 ===============
 idSessionLocal::UnloadMap
@@ -1608,6 +1769,7 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	} 
 	
 	int start = Sys_Milliseconds();
+	int randSeed = ( mapSpawnRandSeed >= 0 ) ? mapSpawnRandSeed : start;
 
 	common->Printf( "--------- Map Initialization ---------\n" );
 	common->Printf( "Map: %s\n", mapString.c_str() );
@@ -1637,11 +1799,11 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 			savegameFile = NULL;
 
 			game->SetServerInfo( mapSpawnData.serverInfo );
-			game->InitFromNewMap( fullMapName + ".map", rw, sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), Sys_Milliseconds() );
+			game->InitFromNewMap( fullMapName + ".map", rw, sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), randSeed );
 		}
 	} else {
 		game->SetServerInfo( mapSpawnData.serverInfo );
-		game->InitFromNewMap( fullMapName + ".map", rw, sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), Sys_Milliseconds() );
+		game->InitFromNewMap( fullMapName + ".map", rw, sw, idAsyncNetwork::server.IsActive(), idAsyncNetwork::client.IsActive(), randSeed );
 	}
 
 	if ( !idAsyncNetwork::IsActive() && !loadingSaveGame ) {
@@ -2873,6 +3035,8 @@ void idSessionLocal::Init() {
 
 	cmdSystem->AddCommand( "disconnect", Session_Disconnect_f, CMD_FL_SYSTEM, "disconnects from a game" );
 
+	cmdSystem->AddCommand( "benchGame", Session_BenchGame_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "runs the game logic of a map without rendering and reports the time per game system", idCmdSystem::ArgCompletion_MapName );
+
 #ifdef ID_DEMO_BUILD
 	cmdSystem->AddCommand( "endOfDemo", Session_EndOfDemo_f, CMD_FL_SYSTEM, "ends the demo version of the game" );
 #endif
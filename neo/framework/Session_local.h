@@ -77,6 +77,7 @@ typedef enum {
 } timeDemo_t;
 
 const int USERCMD_PER_DEMO_FRAME	= 2;
+const int BENCH_GAME_RANDSEED		= 0;
 const int CONNECT_TRANSMIT_TIME		= 1000;
 const int MAX_LOGGED_USERCMDS		= 60*60*60;	// one hour of single player, 15 minutes of four player
 
@@ -209,6 +210,7 @@ public:
 	int					savegameVersion;
 
 	idFile *			cmdDemoFile;		// if non-zero, we are reading commands from a file
+	int					mapSpawnRandSeed;	// if >= 0 the game random numbers are seeded with this instead of the time
 
 	int					latchedTicNumber;	// set to com_ticNumber each frame
 	int					lastGameTic;		// while latchedTicNumber > lastGameTic, run game frames
@@ -272,6 +274,7 @@ public:
 	void				WriteCmdDemo( const char *name, bool save = false);
 	void				StartPlayingCmdDemo( const char *demoName);
 	void				TimeCmdDemo( const char *demoName);
+	void				BenchGame( const char *mapName, int numFrames, const char *demoName );
 	void				SaveCmdDemoToFile(idFile *file);
 	void				LoadCmdDemoFromFile(idFile *file);
 	void				StartRecordingRenderDemo( const char *name );
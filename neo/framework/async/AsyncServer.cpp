@@ -2378,6 +2378,7 @@ void idAsyncServer::RunFrame( void ) {
 	netadr_t	from;
 	int			outgoingRate, incomingRate;
 	float		outgoingCompression, incomingCompression;
+	idProfileZone zone( "idAsyncServer::RunFrame" );
 
 	msec = UpdateTime( 100 );
 
@@ -1434,13 +1434,26 @@ idEntity::UpdateRenderEntity
 ================
 */
 bool idEntity::UpdateRenderEntity( renderEntity_s *renderEntity, const renderView_t *renderView ) {
+	int			numJoints;
+	idJointMat	*joints;
+	bool		changed;
+
 	if ( gameLocal.inCinematic && gameLocal.skipCinematic ) {
 		return false;
 	}
 
 	idAnimator *animator = GetAnimator();
 	if ( animator ) {
-		return animator->CreateFrame( gameLocal.time, false );
+		changed = animator->CreateFrame( gameLocal.time, false, true );
+		if ( animator->CreatedFrameAhead() ) {
+			changed = true;
+		}
+
+		// the serial is only valid for the joints of the animator
+		animator->GetJoints( &numJoints, &joints );
+		renderEntity->jointsSerial = ( renderEntity->joints == joints ) ? animator->GetJointsSerial() : 0;
+
+		return changed;
 	}
 
 	return false;
@@ -2526,6 +2539,7 @@ bool idEntity::RunPhysics( void ) {
 	idEntity *	part, *blockedPart, *blockingEntity;
 	trace_t		results;
 	bool		moved;
+	idGameTiming	timing( GAME_TIMING_PHYSICS );
 
 	// don't run physics if not enabled
 	if ( !( thinkFlags & TH_PHYSICS ) ) {
@@ -53,6 +53,23 @@ typedef struct {
 													// keep the game time in sync with real time
 } gameReturn_t;
 
+typedef enum {
+	GAME_TIMING_THINK,								// entity think time not spent in any of the other systems
+	GAME_TIMING_PHYSICS,
+	GAME_TIMING_SCRIPT,
+	GAME_TIMING_PATHING,
+	GAME_TIMING_COLLISION,
+	GAME_TIMING_EVENTS,
+	GAME_TIMING_ANIMATION,							// animation frames created on the job threads
+	GAME_TIMING_NUM
+} gameTiming_t;
+
+typedef struct {
+	double		msec[GAME_TIMING_NUM];				// milliseconds spent in each system since the timings were enabled
+	int			numEntities;						// number of spawned entities
+	int			stateHash;							// hash over the game time and entity positions to check for divergence
+} gameTimings_t;
+
 typedef enum {
 	ALLOW_YES = 0,
 	ALLOW_BADPASS,	// core will prompt for password and connect again
@@ -190,6 +207,12 @@ public:
 	virtual bool				DownloadRequest( const char *IP, const char *guid, const char *paks, char urls[ MAX_STRING_CHARS ] ) = 0;
 
 	virtual void				GetMapLoadingGUI( char gui[ MAX_STRING_CHARS ] ) = 0;
+
+	// Enables and clears or disables the timings of the game systems.
+	virtual void				EnableTimings( bool enable ) = 0;
+
+	// Returns the time spent in the game systems since the timings were enabled.
+	virtual void				GetTimings( gameTimings_t &timings ) = 0;
 };
 
 extern idGame *					game;
@@ -318,7 +341,7 @@ extern idGameEdit *				gameEdit;
 ===============================================================================
 */
 
-const int GAME_API_VERSION		= 8;
+const int GAME_API_VERSION		= 13;
 
 typedef struct {
 
@@ -336,6 +359,8 @@ typedef struct {
 	idDeclManager *				declManager;			// declaration manager
 	idAASFileManager *			AASFileManager;			// AAS file manager
 	idCollisionModelManager *	collisionModelManager;	// collision model manager
+	idJobManager *				jobManager;				// job system
+	idProfiler *				profiler;				// frame profiler
 
 } gameImport_t;
 
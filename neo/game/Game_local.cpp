@@ -46,6 +46,8 @@ idUserInterfaceManager *	uiManager = NULL;
 idDeclManager *				declManager = NULL;
 idAASFileManager *			AASFileManager = NULL;
 idCollisionModelManager *	collisionModelManager = NULL;
+idJobManager *				jobManager = NULL;
+idProfiler *				profiler = NULL;
 idCVar *					idCVar::staticVars = NULL;
 
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL|CVAR_SYSTEM, "force generic platform independent SIMD" );
@@ -64,6 +66,10 @@ idAnimManager				animationLib;
 idGameLocal					gameLocal;
 idGame *					game = &gameLocal;	// statically pointed at an idGameLocal
 
+// timings of the game systems, only gathered on the thread that enabled them
+idGameTimings				gameTimings;
+ID_THREAD_LOCAL bool		gameTimingsThread = false;
+
 const char *idGameLocal::sufaceTypeNames[ MAX_SURFACE_TYPES ] = {
 	"none",	"metal", "stone", "flesh", "wood", "cardboard", "liquid", "glass", "plastic",
 	"ricochet", "surftype10", "surftype11", "surftype12", "surftype13", "surftype14", "surftype15"
@@ -101,6 +107,8 @@ extern "C" gameExport_t *GetGameAPI( gameImport_t *import ) {
 		declManager					= import->declManager;
 		AASFileManager				= import->AASFileManager;
 		collisionModelManager		= import->collisionModelManager;
+		jobManager					= import->jobManager;
+		profiler					= import->profiler;
 	}
 
 	// set interface pointers used by idLib
@@ -1487,6 +1495,7 @@ void idGameLocal::MapShutdown( void ) {
 
 	clip.Shutdown();
 	idClipModel::ClearTraceModelCache();
+	physicsIslands.Clear();
 
 	ShutdownAsyncNetwork();
 
@@ -2018,6 +2027,42 @@ void idGameLocal::FreePlayerPVS( void ) {
 	}
 }
 
+/*
+================
+idGameLocal::CreateAnimationFrames
+
+  Creates the animation frames of the entities that were in view during the
+  previous frame on the job threads. The renderer only creates the frames
+  of entities that came into view itself.
+================
+*/
+void idGameLocal::CreateAnimationFrames( void ) {
+	idEntity *ent;
+	idAnimator *animator;
+	animatorFrame_t frame;
+	idGameTiming timing( GAME_TIMING_ANIMATION );
+
+	animatorFrames.SetNum( 0, false );
+
+	if ( g_animThreads.GetInteger() == 1 || ( inCinematic && skipCinematic ) ) {
+		return;
+	}
+
+	for ( ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
+		animator = ent->GetAnimator();
+		if ( !animator ) {
+			continue;
+		}
+		if ( animator->FrameNeeded( time, previousTime ) ) {
+			frame.animator = animator;
+			frame.time = time;
+			animatorFrames.Append( frame );
+		}
+	}
+
+	idAnimator::CreateFrames( animatorFrames.Ptr(), animatorFrames.Num() );
+}
+
 /*
 ================
 idGameLocal::InPlayerPVS
@@ -2162,6 +2207,7 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 	gameReturn_t ret;
 	idPlayer	*player;
 	const renderView_t *view;
+	idProfileZone	zone( "idGameLocal::RunFrame" );
 
 #ifdef _DEBUG
 	if ( isMultiplayer ) {
@@ -2233,6 +2279,10 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 
 		timer_think.Clear();
 		timer_think.Start();
+		gameTimings.Start( GAME_TIMING_THINK );
+
+		// step rigid bodies that do not interact with other entities on the job threads
+		physicsIslands.StepIslands();
 
 		// let entities think
 		if ( g_timeentities.GetFloat() ) {
@@ -2287,15 +2337,24 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 			numEntitiesToDeactivate = 0;
 		}
 
+		gameTimings.Stop();
 		timer_think.Stop();
 		timer_events.Clear();
 		timer_events.Start();
+		gameTimings.Start( GAME_TIMING_EVENTS );
 
 		// service any pending events
 		idEvent::ServiceEvents();
 
+		gameTimings.Stop();
 		timer_events.Stop();
 
+		// remove the clip models that were unlinked this frame from the clip model tree
+		clip.RemoveUnlinkedLeaves();
+
+		// create the animation frames of the entities in view on the job threads
+		CreateAnimationFrames();
+
 		// free the player pvs
 		FreePlayerPVS();
 
@@ -2737,10 +2796,18 @@ void idGameLocal::RunDebugInfo( void ) {
 		clip.DrawClipModels( player->GetEyePosition(), g_maxShowDistance.GetFloat(), pm_thirdPerson.GetBool() ? NULL : player );
 	}
 
+	if ( g_showClipTree.GetInteger() ) {
+		clip.DrawClipTree( player->GetEyePosition(), g_maxShowDistance.GetFloat(), g_showClipTree.GetInteger() == 2 );
+	}
+
 	if ( g_showCollisionTraces.GetBool() ) {
 		clip.PrintStatistics();
 	}
 
+	if ( g_showPhysicsIslands.GetBool() ) {
+		physicsIslands.PrintStatistics();
+	}
+
 	if ( g_showPVS.GetInteger() ) {
 		pvs.DrawPVS( origin, ( g_showPVS.GetInteger() == 2 ) ? PVS_ALL_PORTALS_OPEN : PVS_NORMAL );
 	}
@@ -4366,3 +4433,41 @@ idGameLocal::GetMapLoadingGUI
 */
 void idGameLocal::GetMapLoadingGUI( char gui[ MAX_STRING_CHARS ] ) { }
 
+/*
+===============
+idGameLocal::EnableTimings
+===============
+*/
+void idGameLocal::EnableTimings( bool enable ) {
+	gameTimings.Enable( enable );
+}
+
+/*
+===============
+idGameLocal::GetTimings
+===============
+*/
+void idGameLocal::GetTimings( gameTimings_t &timings ) {
+	int i;
+	unsigned int hash;
+	const int *origin;
+	idEntity *ent;
+
+	for ( i = 0; i < GAME_TIMING_NUM; i++ ) {
+		timings.msec[i] = gameTimings.Milliseconds( (gameTiming_t) i );
+	}
+
+	// hash the game time and the exact position of every entity
+	hash = time;
+	timings.numEntities = 0;
+	for ( ent = spawnedEntities.Next(); ent != NULL; ent = ent->spawnNode.Next() ) {
+		origin = reinterpret_cast<const int *>( ent->GetPhysics()->GetOrigin().ToFloatPtr() );
+		hash = hash * 31 + ent->entityNumber;
+		hash = hash * 31 + origin[0];
+		hash = hash * 31 + origin[1];
+		hash = hash * 31 + origin[2];
+		timings.numEntities++;
+	}
+	timings.stateHash = (int) hash;
+}
+
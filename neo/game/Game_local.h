@@ -95,6 +95,7 @@ void gameError( const char *fmt, ... );
 #include "gamesys/SysCmds.h"
 #include "gamesys/SaveGame.h"
 #include "gamesys/DebugGraph.h"
+#include "gamesys/GameTimings.h"
 
 #include "script/Script_Program.h"
 
@@ -104,6 +105,7 @@ void gameError( const char *fmt, ... );
 
 #include "physics/Clip.h"
 #include "physics/Push.h"
+#include "physics/PhysicsIslands.h"
 
 #include "Pvs.h"
 #include "MultiplayerGame.h"
@@ -269,6 +271,8 @@ public:
 
 	idClip					clip;					// collision detection
 	idPush					push;					// geometric pushing
+	idPhysicsIslands		physicsIslands;			// rigid bodies stepped on the job threads
+	idList<animatorFrame_t>	animatorFrames;			// animators with a frame created on the job threads
 	idPVS					pvs;					// potential visible set
 
 	idTestModel *			testmodel;				// for development testing of models
@@ -357,6 +361,9 @@ public:
 
 	virtual bool			DownloadRequest( const char *IP, const char *guid, const char *paks, char urls[ MAX_STRING_CHARS ] );
 
+	virtual void			EnableTimings( bool enable );
+	virtual void			GetTimings( gameTimings_t &timings );
+
 	// ---------------------- Public idGameLocal Interface -------------------
 
 	void					Printf( const char *fmt, ... ) const id_attribute((format(printf,2,3)));
@@ -531,6 +538,7 @@ private:
 	pvsHandle_t				GetClientPVS( idPlayer *player, pvsType_t type );
 	void					SetupPlayerPVS( void );
 	void					FreePlayerPVS( void );
+	void					CreateAnimationFrames( void );
 	void					UpdateGravity( void );
 	void					SortActiveEntityList( void );
 	void					ShowTargets( void );
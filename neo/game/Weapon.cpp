@@ -2878,17 +2878,26 @@ void idWeapon::Event_LaunchProjectiles( int num_projectiles, float spread, float
 	if ( gameLocal.isClient ) {
 
 		// predict instant hit projectiles
-		if ( projectileDict.GetBool( "net_instanthit" ) ) {
+		if ( projectileDict.GetBool( "net_instanthit" ) && num_projectiles > 0 ) {
 			float spreadRad = DEG2RAD( spread );
+			idVec3 *starts = (idVec3 *) _alloca16( num_projectiles * sizeof( starts[0] ) );
+			idVec3 *ends = (idVec3 *) _alloca16( num_projectiles * sizeof( ends[0] ) );
+			trace_t *traces = (trace_t *) _alloca16( num_projectiles * sizeof( traces[0] ) );
 			muzzle_pos = muzzleOrigin + playerViewAxis[ 0 ] * 2.0f;
 			for( i = 0; i < num_projectiles; i++ ) {
 				ang = idMath::Sin( spreadRad * gameLocal.random.RandomFloat() );
 				spin = (float)DEG2RAD( 360.0f ) * gameLocal.random.RandomFloat();
 				dir = playerViewAxis[ 0 ] + playerViewAxis[ 2 ] * ( ang * idMath::Sin( spin ) ) - playerViewAxis[ 1 ] * ( ang * idMath::Cos( spin ) );
 				dir.Normalize();
-				gameLocal.clip.Translation( tr, muzzle_pos, muzzle_pos + dir * 4096.0f, NULL, mat3_identity, MASK_SHOT_RENDERMODEL, owner );
-				if ( tr.fraction < 1.0f ) {
-					idProjectile::ClientPredictionCollide( this, projectileDict, tr, vec3_origin, true );
+				starts[i] = muzzle_pos;
+				ends[i] = muzzle_pos + dir * 4096.0f;
+			}
+			// all pellets leave the same muzzle so they are traced as one batch
+			if ( gameLocal.clip.TranslationBatch( traces, starts, ends, num_projectiles, NULL, mat3_identity, MASK_SHOT_RENDERMODEL, owner ) ) {
+				for( i = 0; i < num_projectiles; i++ ) {
+					if ( traces[i].fraction < 1.0f ) {
+						idProjectile::ClientPredictionCollide( this, projectileDict, traces[i], vec3_origin, true );
+					}
 				}
 			}
 		}
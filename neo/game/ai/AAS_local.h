@@ -48,6 +48,8 @@ private:
 	int							cluster;				// cluster of the cache
 	int							areaNum;				// area of the cache
 	int							travelFlags;			// combinations of the travel flags
+	bool						dirty;					// travel times have to be recalculated
+	bool						repair;					// travel times have to be repaired around the changed areas
 	idRoutingCache *			next;					// next in list
 	idRoutingCache *			prev;					// previous in list
 	idRoutingCache *			time_next;				// next in time based list
@@ -136,6 +138,11 @@ private:	// routing data
 	mutable idRoutingCache *	cacheListStart;			// start of list with cache sorted from oldest to newest
 	mutable idRoutingCache *	cacheListEnd;			// end of list with cache sorted from oldest to newest
 	mutable int					totalCacheMemory;		// total cache memory used
+	mutable bool				cacheDirty;				// true if any cache has to be recalculated
+	mutable idList<idRoutingCache *> cacheUpdateList;	// cache recalculated on the job threads
+	mutable idList<int>			changedAreas;			// areas that changed state since the cache was last updated
+	mutable idRoutingUpdate *	threadAreaUpdate[MAX_JOB_THREADS];		// area update memory for each job thread
+	mutable idRoutingUpdate *	threadPortalUpdate[MAX_JOB_THREADS];	// portal update memory for each job thread
 	idList<idRoutingObstacle *>	obstacleList;			// list with obstacles
 
 private:	// routing
@@ -147,6 +154,8 @@ private:	// routing
 	void						SetupRoutingCache( void );
 	void						DeleteClusterCache( int clusterNum );
 	void						DeletePortalCache( void );
+	void						InvalidateClusterCache( int clusterNum );
+	void						InvalidatePortalCache( void );
 	void						ShutdownRoutingCache( void );
 	void						RoutingStats( void ) const;
 	void						LinkCache( idRoutingCache *cache ) const;
@@ -154,11 +163,22 @@ private:	// routing
 	void						DeleteOldestCache( void ) const;
 	idReachability *			GetAreaReachability( int areaNum, int reachabilityNum ) const;
 	int							ClusterAreaNum( int clusterNum, int areaNum ) const;
-	void						UpdateAreaRoutingCache( idRoutingCache *areaCache ) const;
+	void						UpdateAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *updates ) const;
+	void						FloodAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *updates, idRoutingUpdate *updateListStart, idRoutingUpdate *updateListEnd ) const;
+	bool						CacheContainsArea( const idRoutingCache *areaCache, int areaNum ) const;
+	void						AddRepairUpdate( idRoutingCache *areaCache, idRoutingUpdate *updates, int areaNum, idRoutingUpdate *&updateListStart, idRoutingUpdate *&updateListEnd ) const;
+	void						RemoveRepairRoute( idRoutingCache *areaCache, idRoutingUpdate *updates, int areaNum, int clusterAreaNum, idRoutingUpdate *&removedListStart, idRoutingUpdate *&removedListEnd ) const;
+	void						RepairAreaRoutingCache( idRoutingCache *areaCache, idRoutingUpdate *updates ) const;
+	idRoutingCache *			FindAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const;
+	idRoutingCache *			AllocAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const;
 	idRoutingCache *			GetAreaRoutingCache( int clusterNum, int areaNum, int travelFlags ) const;
-	void						UpdatePortalRoutingCache( idRoutingCache *portalCache ) const;
+	void						UpdatePortalRoutingCache( idRoutingCache *portalCache, idRoutingUpdate *updates ) const;
 	idRoutingCache *			GetPortalRoutingCache( int clusterNum, int areaNum, int travelFlags ) const;
-	void						RemoveRoutingCacheUsingArea( int areaNum );
+	void						CreatePortalAreaCaches( int travelFlags ) const;
+	void						UpdateCacheList( void ) const;
+	void						UpdateDirtyCache( void ) const;
+	static void					UpdateCacheJob( void *data, int first, int last );
+	void						InvalidateRoutingCacheUsingArea( int areaNum );
 	void						DisableArea( int areaNum );
 	void						EnableArea( int areaNum );
 	bool						SetAreaState_r( int nodeNum, const idBounds &bounds, const int areaContents, bool disabled );
@@ -30,6 +30,7 @@ If you have questions concerning this license or the applicable additional terms
 #pragma hdrstop
 
 #include "AAS_local.h"
+#include "../Game_local.h"		// for timings
 
 #define SUBSAMPLE_WALK_PATH		1
 #define SUBSAMPLE_FLY_PATH		0
@@ -282,6 +283,7 @@ bool idAASLocal::WalkPathToGoal( aasPath_t &path, int areaNum, const idVec3 &ori
 	int i, travelTime, curAreaNum, lastAreas[4], lastAreaIndex, endAreaNum;
 	idReachability *reach;
 	idVec3 endPos;
+	idGameTiming timing( GAME_TIMING_PATHING );
 
 	path.type = PATHTYPE_WALK;
 	path.moveGoal = origin;
@@ -458,6 +460,7 @@ bool idAASLocal::FlyPathToGoal( aasPath_t &path, int areaNum, const idVec3 &orig
 	int i, travelTime, curAreaNum, lastAreas[4], lastAreaIndex, endAreaNum;
 	idReachability *reach;
 	idVec3 endPos;
+	idGameTiming timing( GAME_TIMING_PATHING );
 
 	path.type = PATHTYPE_WALK;
 	path.moveGoal = origin;
@@ -33,6 +33,120 @@ If you have questions concerning this license or the applicable additional terms
 
 bool idAnimManager::forceExport = false;
 
+/*
+===========================================================================
+
+Binary md5anim files are written to generated/ the first time an animation
+is parsed.  They start with a header, followed by the joint info, the
+bounds, the base frame and the animated components, all little endian.
+The length and timestamp of the text file are stored to detect a text file
+that changed, and everything read from the file is checked the same way
+the text file is checked.
+
+===========================================================================
+*/
+
+#define MD5_ANIM_BINARY_ID			"BMA1"
+#define MD5_ANIM_BINARY_VERSION		2
+#define MD5_ANIM_BINARY_EXT			"bmd5anim"
+
+/*
+====================
+MD5AnimBinaryFileName
+====================
+*/
+static idStr MD5AnimBinaryFileName( const char *filename ) {
+	idStr binaryName;
+
+	binaryName = "generated/";
+	binaryName += filename;
+	binaryName.SetFileExtension( MD5_ANIM_BINARY_EXT );
+	return binaryName;
+}
+
+/*
+====================
+MD5AnimReadBinaryData
+
+Returns NULL if the file doesn't have count items left
+====================
+*/
+static const byte *MD5AnimReadBinaryData( const byte *&data, const byte *end, int count, int itemSize ) {
+	const byte *ptr = data;
+
+	if ( count < 0 || count > ( end - data ) / itemSize ) {
+		return NULL;
+	}
+	data += count * itemSize;
+	return ptr;
+}
+
+/*
+====================
+MD5AnimReadBinaryInt
+
+The strings in the file don't keep the data aligned
+====================
+*/
+static bool MD5AnimReadBinaryInt( const byte *&data, const byte *end, int &value ) {
+	const byte *ptr = MD5AnimReadBinaryData( data, end, 1, sizeof( value ) );
+
+	if ( ptr == NULL ) {
+		return false;
+	}
+	memcpy( &value, ptr, sizeof( value ) );
+	value = LittleLong( value );
+	return true;
+}
+
+/*
+====================
+MD5AnimReadBinaryString
+====================
+*/
+static bool MD5AnimReadBinaryString( const byte *&data, const byte *end, idStr &string ) {
+	const byte *ptr;
+	int length;
+
+	if ( !MD5AnimReadBinaryInt( data, end, length ) || length < 0 || length >= MAX_STRING_CHARS ) {
+		return false;
+	}
+	ptr = MD5AnimReadBinaryData( data, end, length, 1 );
+	if ( ptr == NULL ) {
+		return false;
+	}
+	string.Empty();
+	string.Append( (const char *)ptr, length );
+	return true;
+}
+
+/*
+====================
+MD5AnimReadBinaryFloats
+====================
+*/
+static bool MD5AnimReadBinaryFloats( const byte *&data, const byte *end, float *dest, int count ) {
+	const byte *ptr = MD5AnimReadBinaryData( data, end, count, sizeof( float ) );
+
+	if ( ptr == NULL ) {
+		return false;
+	}
+	memcpy( dest, ptr, count * sizeof( float ) );
+	LittleRevBytes( dest, sizeof( float ), count );
+	return true;
+}
+
+/*
+====================
+MD5AnimWriteBinaryFloats
+====================
+*/
+static void MD5AnimWriteBinaryFloats( idFile *f, const float *src, int count ) {
+	for ( int i = 0; i < count; i++ ) {
+		f->WriteFloat( src[i] );
+	}
+}
+
 /***********************************************************************
 
 	idMD5Anim
@@ -79,6 +193,13 @@ void idMD5Anim::Free( void ) {
 	jointInfo.Clear();
 	bounds.Clear();
 	componentFrames.Clear();
+
+	baseFrameSoA.Clear();
+	animatedJoints.Clear();
+	soaComponents.Clear();
+	soaOffsets.Clear();
+	soaJointComponents.Clear();
+	rotationJoints.Clear();
 }
 
 /*
@@ -147,15 +268,222 @@ idMD5Anim::Allocated
 */
 size_t idMD5Anim::Allocated( void ) const {
 	size_t	size = bounds.Allocated() + jointInfo.Allocated() + componentFrames.Allocated() + name.Allocated();
+	size += baseFrameSoA.Allocated() + animatedJoints.Allocated() + soaComponents.Allocated() + soaOffsets.Allocated() + soaJointComponents.Allocated() + rotationJoints.Allocated();
 	return size;
 }
 
 /*
 ====================
 idMD5Anim::LoadAnim
+
+The binary file skips the tokenizing of the text file, it is written the
+first time the text file is parsed
 ====================
 */
 bool idMD5Anim::LoadAnim( const char *filename ) {
+	if ( g_useBinaryAnims.GetBool() && LoadBinaryAnim( filename ) ) {
+		return true;
+	}
+
+	if ( !LoadTextAnim( filename ) ) {
+		return false;
+	}
+
+	if ( g_useBinaryAnims.GetBool() ) {
+		WriteBinaryAnim();
+	}
+
+	return true;
+}
+
+/*
+====================
+idMD5Anim::LoadBinaryAnim
+
+The whole file is mapped and parsed from memory.
+Returns false if there is no up to date binary file.
+====================
+*/
+bool idMD5Anim::LoadBinaryAnim( const char *filename ) {
+	idStr		binaryName;
+	idStr		jointName;
+	const void *buffer;
+	const byte *data;
+	const byte *end;
+	ID_TIME_T	textTimeStamp;
+	int			i, length, version, textLength, fileTextLength, fileTimeStamp;
+	bool		ok;
+
+	textLength = fileSystem->ReadFile( filename, NULL, &textTimeStamp );
+	if ( textLength < 0 ) {
+		return false;
+	}
+
+	binaryName = MD5AnimBinaryFileName( filename );
+	length = fileSystem->MapFile( binaryName, &buffer );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	data = (const byte *)buffer;
+	end = data + length;
+
+	if ( !MD5AnimReadBinaryData( data, end, 1, 4 ) || !MD5AnimReadBinaryInt( data, end, version )
+			|| !MD5AnimReadBinaryInt( data, end, fileTextLength ) || !MD5AnimReadBinaryInt( data, end, fileTimeStamp ) ) {
+		gameLocal.Warning( "%s is corrupt", binaryName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	if ( memcmp( buffer, MD5_ANIM_BINARY_ID, 4 ) != 0 || version != MD5_ANIM_BINARY_VERSION
+			|| fileTextLength != textLength || (unsigned int)fileTimeStamp != (unsigned int)textTimeStamp ) {
+		gameLocal.Printf( "%s is out of date\n", binaryName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	Free();
+
+	name = filename;
+
+	// the same checks as the text file
+	ok = MD5AnimReadBinaryInt( data, end, numFrames ) && MD5AnimReadBinaryInt( data, end, frameRate )
+			&& MD5AnimReadBinaryInt( data, end, animLength ) && MD5AnimReadBinaryInt( data, end, numJoints )
+				&& MD5AnimReadBinaryInt( data, end, numAnimatedComponents )
+					&& MD5AnimReadBinaryFloats( data, end, totaldelta.ToFloatPtr(), 3 );
+	if ( ok ) {
+		ok = ( numFrames > 0 && numJoints > 0 && frameRate >= 0
+				&& numAnimatedComponents >= 0 && numAnimatedComponents <= numJoints * 6
+					&& numJoints <= ( end - data ) / ( 4 * (int)sizeof( int ) ) );
+	}
+
+	if ( ok ) {
+		jointInfo.SetGranularity( 1 );
+		jointInfo.SetNum( numJoints );
+	}
+	for( i = 0; ok && i < numJoints; i++ ) {
+		ok = MD5AnimReadBinaryString( data, end, jointName ) && MD5AnimReadBinaryInt( data, end, jointInfo[ i ].parentNum )
+				&& MD5AnimReadBinaryInt( data, end, jointInfo[ i ].animBits ) && MD5AnimReadBinaryInt( data, end, jointInfo[ i ].firstComponent );
+		if ( !ok ) {
+			break;
+		}
+		jointInfo[ i ].nameIndex = animationLib.JointIndex( jointName );
+
+		if ( jointInfo[ i ].parentNum >= i || ( i != 0 && jointInfo[ i ].parentNum < 0 ) ) {
+			ok = false;
+		} else if ( jointInfo[ i ].animBits & ~63 ) {
+			ok = false;
+		} else if ( numAnimatedComponents > 0 && ( jointInfo[ i ].firstComponent < 0 || jointInfo[ i ].firstComponent >= numAnimatedComponents ) ) {
+			ok = false;
+		}
+	}
+
+	if ( ok ) {
+		bounds.SetGranularity( 1 );
+		ok = ( numFrames <= ( end - data ) / (int)sizeof( bounds[0] ) );
+	}
+	if ( ok ) {
+		bounds.SetNum( numFrames );
+		ok = MD5AnimReadBinaryFloats( data, end, bounds[0][0].ToFloatPtr(), numFrames * 6 );
+	}
+
+	if ( ok ) {
+		baseFrame.SetGranularity( 1 );
+		baseFrame.SetNum( numJoints );
+		for( i = 0; ok && i < numJoints; i++ ) {
+			ok = MD5AnimReadBinaryFloats( data, end, baseFrame[ i ].q.ToFloatPtr(), 4 )
+					&& MD5AnimReadBinaryFloats( data, end, baseFrame[ i ].t.ToFloatPtr(), 3 );
+		}
+	}
+
+	if ( ok && numAnimatedComponents > 0 ) {
+		ok = ( numFrames <= ( end - data ) / ( numAnimatedComponents * (int)sizeof( float ) ) );
+		if ( ok ) {
+			componentFrames.SetGranularity( 1 );
+			componentFrames.SetNum( numAnimatedComponents * numFrames );
+			ok = MD5AnimReadBinaryFloats( data, end, componentFrames.Ptr(), componentFrames.Num() );
+		}
+	}
+
+	if ( ok ) {
+		ok = ( data == end );
+	}
+
+	fileSystem->UnmapFile( buffer );
+
+	if ( !ok ) {
+		gameLocal.Warning( "%s is corrupt", binaryName.c_str() );
+		Free();
+		return false;
+	}
+
+	SetupFrameDecode();
+
+	return true;
+}
+
+/*
+====================
+idMD5Anim::WriteBinaryAnim
+====================
+*/
+bool idMD5Anim::WriteBinaryAnim( void ) const {
+	idStr		binaryName;
+	idFile *	f;
+	ID_TIME_T	textTimeStamp;
+	int			i, textLength;
+
+	textLength = fileSystem->ReadFile( name, NULL, &textTimeStamp );
+	if ( textLength < 0 ) {
+		return false;
+	}
+
+	binaryName = MD5AnimBinaryFileName( name );
+	f = fileSystem->OpenFileWrite( binaryName );
+	if ( !f ) {
+		gameLocal.Warning( "couldn't write %s", binaryName.c_str() );
+		return false;
+	}
+
+	f->Write( MD5_ANIM_BINARY_ID, 4 );
+	f->WriteInt( MD5_ANIM_BINARY_VERSION );
+	f->WriteInt( textLength );
+	f->WriteUnsignedInt( (unsigned int)textTimeStamp );
+
+	f->WriteInt( numFrames );
+	f->WriteInt( frameRate );
+	f->WriteInt( animLength );
+	f->WriteInt( numJoints );
+	f->WriteInt( numAnimatedComponents );
+	f->WriteVec3( totaldelta );
+
+	for( i = 0; i < numJoints; i++ ) {
+		f->WriteString( animationLib.JointName( jointInfo[ i ].nameIndex ) );
+		f->WriteInt( jointInfo[ i ].parentNum );
+		f->WriteInt( jointInfo[ i ].animBits );
+		f->WriteInt( jointInfo[ i ].firstComponent );
+	}
+
+	MD5AnimWriteBinaryFloats( f, bounds[0][0].ToFloatPtr(), numFrames * 6 );
+
+	for( i = 0; i < numJoints; i++ ) {
+		MD5AnimWriteBinaryFloats( f, baseFrame[ i ].q.ToFloatPtr(), 4 );
+		MD5AnimWriteBinaryFloats( f, baseFrame[ i ].t.ToFloatPtr(), 3 );
+	}
+
+	MD5AnimWriteBinaryFloats( f, componentFrames.Ptr(), componentFrames.Num() );
+
+	fileSystem->CloseFile( f );
+
+	return true;
+}
+
+/*
+====================
+idMD5Anim::LoadTextAnim
+====================
+*/
+bool idMD5Anim::LoadTextAnim( const char *filename ) {
 	int		version;
 	idLexer	parser( LEXFL_ALLOWPATHNAMES | LEXFL_NOSTRINGESCAPECHARS | LEXFL_NOSTRINGCONCAT );
 	idToken	token;
@@ -323,6 +651,8 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	// we don't count last frame because it would cause a 1 frame pause at the end
 	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
 
+	SetupFrameDecode();
+
 	// done
 	return true;
 }
@@ -880,6 +1210,183 @@ void idMD5Anim::GetSingleFrame( int framenum, idJointQuat *joints, const int *in
 	}
 }
 
+/*
+====================
+idMD5Anim::SetupFrameDecode
+
+Builds the tables that decode the frames straight into the structure of
+arrays layout the animator blends the joints in.
+====================
+*/
+void idMD5Anim::SetupFrameDecode( void ) {
+	int			i, j;
+	int			stride;
+	int			component;
+	int			animBits;
+	static const int animComponentBits[ 6 ] = { ANIM_TX, ANIM_TY, ANIM_TZ, ANIM_QX, ANIM_QY, ANIM_QZ };
+	static const int soaComponentIndex[ 6 ] = { 4, 5, 6, 0, 1, 2 };
+
+	stride = JointQuatSoAStride( numJoints );
+
+	baseFrameSoA.SetNum( JOINTQUAT_SOA_COMPONENTS * stride );
+	JointQuatsToSoA( baseFrameSoA.Ptr(), baseFrame.Ptr(), numJoints );
+
+	animatedJoints.SetNum( stride );
+	memset( animatedJoints.Ptr(), 0, stride * sizeof( animatedJoints[ 0 ] ) );
+
+	soaComponents.SetNum( 0, false );
+	soaOffsets.SetNum( 0, false );
+	soaJointComponents.SetNum( numJoints + 1 );
+	rotationJoints.SetNum( 0, false );
+
+	for ( i = 0; i < numJoints; i++ ) {
+		soaJointComponents[ i ] = soaComponents.Num();
+
+		animBits = jointInfo[ i ].animBits;
+		if ( !animBits ) {
+			continue;
+		}
+
+		animatedJoints[ i ] = 1.0f;
+
+		component = jointInfo[ i ].firstComponent;
+		for ( j = 0; j < 6; j++ ) {
+			if ( ( animBits & animComponentBits[ j ] ) && component < numAnimatedComponents ) {
+				soaComponents.Append( component++ );
+				soaOffsets.Append( soaComponentIndex[ j ] * stride + i );
+			}
+		}
+
+		if ( animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) {
+			rotationJoints.Append( i );
+		}
+	}
+
+	soaJointComponents[ numJoints ] = soaComponents.Num();
+}
+
+/*
+====================
+idMD5Anim::DecodeFrameSoA
+
+Copies the animated components of a frame over the joints and calculates
+the w of the animated rotations. When the index list does not hold all
+joints only the listed joints are decoded.
+====================
+*/
+void idMD5Anim::DecodeFrameSoA( int framenum, float *joints, const int *index, int numIndexes ) const {
+	int				i, j, k;
+	int				stride;
+	int				numComponents;
+	const float *	frame;
+	const int *		components;
+	const int *		offsets;
+
+	stride = JointQuatSoAStride( numJoints );
+	frame = &componentFrames[ framenum * numAnimatedComponents ];
+	components = soaComponents.Ptr();
+	offsets = soaOffsets.Ptr();
+
+	if ( numIndexes >= numJoints ) {
+		numComponents = soaComponents.Num();
+		for ( i = 0; i < numComponents; i++ ) {
+			joints[ offsets[ i ] ] = frame[ components[ i ] ];
+		}
+
+		for ( i = 0; i < rotationJoints.Num(); i++ ) {
+			j = rotationJoints[ i ];
+			idQuat q( joints[ 0 * stride + j ], joints[ 1 * stride + j ], joints[ 2 * stride + j ], 0.0f );
+			joints[ 3 * stride + j ] = q.CalcW();
+		}
+		return;
+	}
+
+	for ( i = 0; i < numIndexes; i++ ) {
+		j = index[ i ];
+		numComponents = soaJointComponents[ j + 1 ];
+		for ( k = soaJointComponents[ j ]; k < numComponents; k++ ) {
+			joints[ offsets[ k ] ] = frame[ components[ k ] ];
+		}
+
+		if ( jointInfo[ j ].animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) {
+			idQuat q( joints[ 0 * stride + j ], joints[ 1 * stride + j ], joints[ 2 * stride + j ], 0.0f );
+			joints[ 3 * stride + j ] = q.CalcW();
+		}
+	}
+}
+
+/*
+====================
+idMD5Anim::GetInterpolatedFrameSoA
+
+Same as GetInterpolatedFrame but decodes into the structure of arrays layout
+of JointTransform.h. Joints that are not in the index list are left at the
+base frame.
+====================
+*/
+void idMD5Anim::GetInterpolatedFrameSoA( const frameBlend_t &frame, float *joints, const int *index, int numIndexes ) const {
+	int			i, j;
+	int			stride;
+	int			frameSize;
+	float *		blendJoints;
+	float *		lerps;
+
+	stride = JointQuatSoAStride( numJoints );
+	frameSize = JOINTQUAT_SOA_COMPONENTS * stride;
+
+	// copy the baseframe
+	SIMDProcessor->Memcpy( joints, baseFrameSoA.Ptr(), frameSize * sizeof( joints[ 0 ] ) );
+
+	if ( !numAnimatedComponents ) {
+		// just use the base frame
+		return;
+	}
+
+	blendJoints = (float *)_alloca16( frameSize * sizeof( blendJoints[ 0 ] ) );
+	lerps = (float *)_alloca16( stride * sizeof( lerps[ 0 ] ) );
+
+	SIMDProcessor->Memcpy( blendJoints, baseFrameSoA.Ptr(), frameSize * sizeof( blendJoints[ 0 ] ) );
+
+	DecodeFrameSoA( frame.frame1, joints, index, numIndexes );
+	DecodeFrameSoA( frame.frame2, blendJoints, index, numIndexes );
+
+	// only the animated joints are interpolated
+	if ( numIndexes >= numJoints ) {
+		SIMDProcessor->Mul( lerps, frame.backlerp, animatedJoints.Ptr(), stride );
+	} else {
+		memset( lerps, 0, stride * sizeof( lerps[ 0 ] ) );
+		for ( i = 0; i < numIndexes; i++ ) {
+			j = index[ i ];
+			lerps[ j ] = frame.backlerp * animatedJoints[ j ];
+		}
+	}
+	SIMDProcessor->BlendJointsSoA( joints, &blendJoints, &lerps, 1, numJoints );
+
+	if ( frame.cycleCount ) {
+		joints[ 4 * stride ] += totaldelta.x * ( float )frame.cycleCount;
+		joints[ 5 * stride ] += totaldelta.y * ( float )frame.cycleCount;
+		joints[ 6 * stride ] += totaldelta.z * ( float )frame.cycleCount;
+	}
+}
+
+/*
+====================
+idMD5Anim::GetSingleFrameSoA
+====================
+*/
+void idMD5Anim::GetSingleFrameSoA( int framenum, float *joints, const int *index, int numIndexes ) const {
+
+	// copy the baseframe
+	SIMDProcessor->Memcpy( joints, baseFrameSoA.Ptr(), JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( numJoints ) * sizeof( joints[ 0 ] ) );
+
+	if ( ( framenum == 0 ) || !numAnimatedComponents ) {
+		// just use the base frame
+		return;
+	}
+
+	DecodeFrameSoA( framenum, joints, index, numIndexes );
+}
+
 /*
 ====================
 idMD5Anim::CheckModelHierarchy
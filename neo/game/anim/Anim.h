@@ -34,6 +34,9 @@ If you have questions concerning this license or the applicable additional terms
 const int ANIM_NumAnimChannels		= 5;
 const int ANIM_MaxAnimsPerChannel	= 3;
 const int ANIM_MaxSyncedAnims		= 3;
+const int ANIM_MaxLODLevels			= 3;
+const int ANIM_MaxBlendLayers		= ANIM_NumAnimChannels * ANIM_MaxAnimsPerChannel + 1;	// all anims and the articulated figure pose
+const int ANIM_MaxFrameBatch		= 16;	// animators of the same model transformed with one call
 
 //
 // animation channels.  make sure to change script/doom_defs.script if you add any channels, or change their order
@@ -232,6 +235,13 @@ private:
 	idVec3					totaldelta;
 	mutable int				ref_count;
 
+	idList<float>			baseFrameSoA;		// base frame in the structure of arrays layout of JointTransform.h
+	idList<float>			animatedJoints;		// 1 for joints with any animated component, 0 for the others
+	idList<int>				soaComponents;		// animated component of a frame
+	idList<int>				soaOffsets;			// offset of the component in the structure of arrays
+	idList<int>				soaJointComponents;	// first decode table entry of each joint
+	idList<int>				rotationJoints;		// joints with an animated rotation
+
 public:
 							idMD5Anim();
 							~idMD5Anim();
@@ -241,6 +251,9 @@ public:
 	size_t					Allocated( void ) const;
 	size_t					Size( void ) const { return sizeof( *this ) + Allocated(); };
 	bool					LoadAnim( const char *filename );
+	bool					LoadTextAnim( const char *filename );
+	bool					LoadBinaryAnim( const char *filename );
+	bool					WriteBinaryAnim( void ) const;
 
 	void					IncreaseRefs( void ) const;
 	void					DecreaseRefs( void ) const;
@@ -249,6 +262,8 @@ public:
 	void					CheckModelHierarchy( const idRenderModel *model ) const;
 	void					GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints, const int *index, int numIndexes ) const;
 	void					GetSingleFrame( int framenum, idJointQuat *joints, const int *index, int numIndexes ) const;
+	void					GetInterpolatedFrameSoA( const frameBlend_t &frame, float *joints, const int *index, int numIndexes ) const;
+	void					GetSingleFrameSoA( int framenum, float *joints, const int *index, int numIndexes ) const;
 	int						Length( void ) const;
 	int						NumFrames( void ) const;
 	int						NumJoints( void ) const;
@@ -261,6 +276,10 @@ public:
 	void					GetOrigin( idVec3 &offset, int currentTime, int cyclecount ) const;
 	void					GetOriginRotation( idQuat &rotation, int time, int cyclecount ) const;
 	void					GetBounds( idBounds &bounds, int currentTime, int cyclecount ) const;
+
+private:
+	void					SetupFrameDecode( void );
+	void					DecodeFrameSoA( int framenum, float *joints, const int *index, int numIndexes ) const;
 };
 
 /*
@@ -402,7 +421,7 @@ private:
 	void						SetFrame( const idDeclModelDef *modelDef, int animnum, int frame, int currenttime, int blendtime );
 	void						CycleAnim( const idDeclModelDef *modelDef, int animnum, int currenttime, int blendtime );
 	void						PlayAnim( const idDeclModelDef *modelDef, int animnum, int currenttime, int blendtime );
-	bool						BlendAnim( int currentTime, int channel, int numJoints, idJointQuat *blendFrame, float &blendWeight, bool removeOrigin, bool overrideBlend, bool printInfo ) const;
+	bool						BlendAnim( int currentTime, int channel, int numJoints, float *layerFrame, float *layerLerps, float &blendWeight, bool removeOrigin, bool overrideBlend, bool printInfo ) const;
 	void						BlendOrigin( int currentTime, idVec3 &blendPos, float &blendWeight, bool removeOriginOffset ) const;
 	void						BlendDelta( int fromtime, int totime, idVec3 &blendDelta, float &blendWeight ) const;
 	void						BlendDeltaRotation( int fromtime, int totime, idQuat &blendDelta, float &blendWeight ) const;
@@ -469,6 +488,12 @@ ID_INLINE idAFPoseJointMod::idAFPoseJointMod( void ) {
 	origin.Zero();
 }
 
+// an animator to create a frame for with idAnimator::CreateFrames
+typedef struct animatorFrame_s {
+	idAnimator *				animator;
+	int							time;
+} animatorFrame_t;
+
 /*
 ==============================================================================================
 
@@ -504,6 +529,7 @@ public:
 	bool						IsAnimating( int currentTime ) const;
 
 	void						GetJoints( int *numJoints, idJointMat **jointsPtr );
+	int							GetJointsSerial( void ) const;
 	int							NumJoints( void ) const;
 	jointHandle_t				GetFirstChild( jointHandle_t jointnum ) const;
 	jointHandle_t				GetFirstChild( const char *name ) const;
@@ -514,7 +540,11 @@ public:
 
 	void						ForceUpdate( void );
 	void						ClearForceUpdate( void );
-	bool						CreateFrame( int animtime, bool force );
+	bool						CreateFrame( int animtime, bool force, bool renderFrame = false );
+	bool						FrameNeeded( int currentTime, int previousTime ) const;
+	bool						CreatedFrameAhead( void );
+	static void					CreateFrames( animatorFrame_t *frames, int numFrames );
+	int							GetLODLevel( void ) const;
 	bool						FrameHasChanged( int animtime ) const;
 	void						GetDelta( int fromtime, int totime, idVec3 &delta ) const;
 	bool						GetDeltaRotation( int fromtime, int totime, idMat3 &delta ) const;
@@ -540,7 +570,7 @@ public:
 	void						SetAFPoseJointMod( const jointHandle_t jointNum, const AFJointModType_t mod, const idMat3 &axis, const idVec3 &origin );
 	void						FinishAFPose( int animnum, const idBounds &bounds, const int time );
 	void						SetAFPoseBlendWeight( float blendWeight );
-	bool						BlendAFPose( idJointQuat *blendFrame ) const;
+	bool						BlendAFPose( float *layerFrame, float *layerLerps ) const;
 	void						ClearAFPose( void );
 
 	void						ClearAllAnims( int currentTime, int cleartime );
@@ -562,6 +592,12 @@ public:
 private:
 	void						FreeData( void );
 	void						PushAnims( int channel, int currentTime, int blendTime );
+	bool						BlendChannels( int currentTime, int numJoints, float *jointFrame, bool debugInfo ) const;
+	int							CalcLODLevel( void ) const;
+	bool						BlendFrame( int currentTime, bool force, bool renderFrame, float *jointFrame );
+	void						TransformJointMods( const float *jointFrame );
+	static void					CreateFrameBatch( const animatorFrame_t *frames, int numFrames );
+	static void					CreateFramesJob( void *data, int first, int last );
 
 private:
 	const idDeclModelDef *		modelDef;
@@ -573,12 +609,20 @@ private:
 	idJointMat *				joints;
 
 	mutable int					lastTransformTime;		// mutable because the value is updated in CreateFrame
+	mutable int					jointsSerial;			// changes each time CreateFrame recalculates the joints
 	mutable bool				stoppedAnimatingUpdate;
 	bool						removeOriginOffset;
 	bool						forceUpdate;
+	bool						createdFrameAhead;		// CreateFrames created a frame the renderer has not asked for yet
 
 	idBounds					frameBounds;
 
+	int							lodLevel;				// 0 = animations are blended every frame, only used for render frames
+	int							lodUpdateTime;			// time the animations were last blended at a lower lod
+	idList<float>				lodPrevFrame;			// the last two blended poses, interpolated
+	idList<float>				lodNextFrame;			// in between blends at a lower lod
+	bool						lodFramesValid;			// the lists are allocated with the joints so CreateFrame never allocates
+
 	float						AFPoseBlendWeight;
 	idList<int>					AFPoseJoints;
 	idList<idAFPoseJointMod>	AFPoseJointMods;
@@ -31,6 +31,11 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "../Game_local.h"
 
+// shared by all animators so a serial is never reused for another joint array
+static volatile int jointsSerialCount = 0;
+
+static idCVar r_showSkel( "r_showSkel", "0", CVAR_RENDERER | CVAR_INTEGER, "", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+
 static const char *channelNames[ ANIM_NumAnimChannels ] = {
 	"all", "torso", "legs", "head", "eyelids"
 };
@@ -1718,17 +1723,23 @@ void idAnimBlend::CallFrameCommands( idEntity *ent, int fromtime, int totime ) c
 /*
 =====================
 idAnimBlend::BlendAnim
+
+Decodes the anim into a layer that idAnimator::BlendChannels blends over the
+joint frame. The layer lerps hold the blend factor for the joints on the
+channel and zero for the others, the first anim on a channel replaces the
+joints.
 =====================
 */
-bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJointQuat *blendFrame, float &blendWeight, bool removeOriginOffset, bool overrideBlend, bool printInfo ) const {
+bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, float *layerFrame, float *layerLerps, float &blendWeight, bool removeOriginOffset, bool overrideBlend, bool printInfo ) const {
 	int				i;
+	int				stride;
 	float			lerp;
 	float			mixWeight;
 	const idMD5Anim	*md5anim;
-	idJointQuat		*ptr;
+	float			*ptr;
 	frameBlend_t	frametime;
-	idJointQuat		*jointFrame;
-	idJointQuat		*mixFrame;
+	float			*mixFrame;
+	float			*mixLerps;
 	int				numAnims;
 	int				time;
 
@@ -1750,13 +1761,11 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 		}
 	}
 
-	if ( ( channel == ANIMCHANNEL_ALL ) && !blendWeight ) {
-		// we don't need a temporary buffer, so just store it directly in the blend frame
-		jointFrame = blendFrame;
-	} else {
-		// allocate a temporary buffer to copy the joints from
-		jointFrame = ( idJointQuat * )_alloca16( numJoints * sizeof( *jointFrame ) );
-	}
+	stride = JointQuatSoAStride( numJoints );
+
+	// only the joints on the channel are decoded
+	const int *index = modelDef->GetChannelJoints( channel );
+	const int num = modelDef->NumJointsOnChannel( channel );
 
 	time = AnimTime( currentTime );
 
@@ -1764,23 +1773,24 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 	if ( numAnims == 1 ) {
 		md5anim = anim->MD5Anim( 0 );
 		if ( frame ) {
-			md5anim->GetSingleFrame( frame - 1, jointFrame, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+			md5anim->GetSingleFrameSoA( frame - 1, layerFrame, index, num );
 		} else {
 			md5anim->ConvertTimeToFrame( time, cycle, frametime );
-			md5anim->GetInterpolatedFrame( frametime, jointFrame, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+			md5anim->GetInterpolatedFrameSoA( frametime, layerFrame, index, num );
 		}
 	} else {
 		//
 		// need to mix the multipoint anim together first
 		//
 		// allocate a temporary buffer to copy the joints to
-		mixFrame = ( idJointQuat * )_alloca16( numJoints * sizeof( *jointFrame ) );
+		mixFrame = ( float * )_alloca16( JOINTQUAT_SOA_COMPONENTS * stride * sizeof( mixFrame[0] ) );
+		mixLerps = ( float * )_alloca16( stride * sizeof( mixLerps[0] ) );
 
 		if ( !frame ) {
 			anim->MD5Anim( 0 )->ConvertTimeToFrame( time, cycle, frametime );
 		}
 
-		ptr = jointFrame;
+		ptr = layerFrame;
 		mixWeight = 0.0f;
 		for( i = 0; i < numAnims; i++ ) {
 			if ( animWeights[ i ] > 0.0f ) {
@@ -1788,14 +1798,18 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 				lerp = animWeights[ i ] / mixWeight;
 				md5anim = anim->MD5Anim( i );
 				if ( frame ) {
-					md5anim->GetSingleFrame( frame - 1, ptr, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+					md5anim->GetSingleFrameSoA( frame - 1, ptr, index, num );
 				} else {
-					md5anim->GetInterpolatedFrame( frametime, ptr, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+					md5anim->GetInterpolatedFrameSoA( frametime, ptr, index, num );
 				}
 
 				// only blend after the first anim is mixed in
-				if ( ptr != jointFrame ) {
-					SIMDProcessor->BlendJoints( jointFrame, ptr, lerp, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+				if ( ptr != layerFrame ) {
+					memset( mixLerps, 0, stride * sizeof( mixLerps[0] ) );
+					for ( int j = 0; j < num; j++ ) {
+						mixLerps[ index[j] ] = lerp;
+					}
+					SIMDProcessor->BlendJointsSoA( layerFrame, &ptr, &mixLerps, 1, numJoints );
 				}
 
 				ptr = mixFrame;
@@ -1810,32 +1824,33 @@ bool idAnimBlend::BlendAnim( int currentTime, int channel, int numJoints, idJoin
 	if ( removeOriginOffset ) {
 		if ( allowMove ) {
 #ifdef VELOCITY_MOVE
-			jointFrame[ 0 ].t.x = 0.0f;
+			layerFrame[ 4 * stride ] = 0.0f;
 #else
-			jointFrame[ 0 ].t.Zero();
+			layerFrame[ 4 * stride ] = 0.0f;
+			layerFrame[ 5 * stride ] = 0.0f;
+			layerFrame[ 6 * stride ] = 0.0f;
 #endif
 		}
 
 		if ( anim->GetAnimFlags().anim_turn ) {
-			jointFrame[ 0 ].q.Set( -0.70710677f, 0.0f, 0.0f, 0.70710677f );
+			layerFrame[ 0 * stride ] = -0.70710677f;
+			layerFrame[ 1 * stride ] = 0.0f;
+			layerFrame[ 2 * stride ] = 0.0f;
+			layerFrame[ 3 * stride ] = 0.70710677f;
 		}
 	}
 
 	if ( !blendWeight ) {
 		blendWeight = weight;
-		if ( channel != ANIMCHANNEL_ALL ) {
-			const int *index = modelDef->GetChannelJoints( channel );
-			const int num = modelDef->NumJointsOnChannel( channel );
-			for( i = 0; i < num; i++ ) {
-				int j = index[i];
-				blendFrame[j].t = jointFrame[j].t;
-				blendFrame[j].q = jointFrame[j].q;
-			}
-		}
+		lerp = 1.0f;
     } else {
 		blendWeight += weight;
 		lerp = weight / blendWeight;
-		SIMDProcessor->BlendJoints( blendFrame, jointFrame, lerp, modelDef->GetChannelJoints( channel ), modelDef->NumJointsOnChannel( channel ) );
+	}
+
+	memset( layerLerps, 0, stride * sizeof( layerLerps[0] ) );
+	for( i = 0; i < num; i++ ) {
+		layerLerps[ index[i] ] = lerp;
 	}
 
 	if ( printInfo ) {
@@ -3006,9 +3021,14 @@ idAnimator::idAnimator() {
 	numJoints				= 0;
 	joints					= NULL;
 	lastTransformTime		= -1;
+	jointsSerial			= 0;
+	lodLevel				= 0;
+	lodUpdateTime			= 0;
 	stoppedAnimatingUpdate	= false;
 	removeOriginOffset		= false;
 	forceUpdate				= false;
+	createdFrameAhead		= false;
+	lodFramesValid			= false;
 
 	frameBounds.Clear();
 
@@ -3146,6 +3166,8 @@ void idAnimator::Restore( idRestoreGame *savefile ) {
 	
 	savefile->ReadInt( numJoints );
 	joints = (idJointMat *) Mem_Alloc16( numJoints * sizeof( joints[0] ) );
+	lodPrevFrame.SetNum( JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( numJoints ), false );
+	lodNextFrame.SetNum( JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( numJoints ), false );
 	for ( i = 0; i < numJoints; i++ ) {
 		float *data = joints[i].ToFloatPtr();
 		for ( j = 0; j < 12; j++ ) {
@@ -3223,6 +3245,11 @@ void idAnimator::FreeData( void ) {
 	joints = NULL;
 	numJoints = 0;
 
+	lodPrevFrame.Clear();
+	lodNextFrame.Clear();
+	lodFramesValid = false;
+	createdFrameAhead = false;
+
 	modelDef = NULL;
 
 	ForceUpdate();
@@ -3283,6 +3310,9 @@ idRenderModel *idAnimator::SetModel( const char *modelname ) {
 	modelDef->SetupJoints( &numJoints, &joints, frameBounds, removeOriginOffset );
 	modelDef->ModelHandle()->Reset();
 
+	lodPrevFrame.SetNum( JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( numJoints ), false );
+	lodNextFrame.SetNum( JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( numJoints ), false );
+
 	// set the modelDef on all channels
 	for( i = ANIMCHANNEL_ALL; i < ANIM_NumAnimChannels; i++ ) {
 		for( j = 0; j < ANIM_MaxAnimsPerChannel; j++ ) {
@@ -4036,15 +4066,22 @@ void idAnimator::SetAFPoseBlendWeight( float blendWeight ) {
 /*
 =====================
 idAnimator::BlendAFPose
+
+Sets up the articulated figure pose as a layer blended over the joints.
 =====================
 */
-bool idAnimator::BlendAFPose( idJointQuat *blendFrame ) const {
+bool idAnimator::BlendAFPose( float *layerFrame, float *layerLerps ) const {
+	int i;
 
 	if ( !AFPoseJoints.Num() ) {
 		return false;
 	}
 
-	SIMDProcessor->BlendJoints( blendFrame, AFPoseJointFrame.Ptr(), AFPoseBlendWeight, AFPoseJoints.Ptr(), AFPoseJoints.Num() );
+	JointQuatsToSoA( layerFrame, AFPoseJointFrame.Ptr(), numJoints );
+	memset( layerLerps, 0, JointQuatSoAStride( numJoints ) * sizeof( layerLerps[0] ) );
+	for ( i = 0; i < AFPoseJoints.Num(); i++ ) {
+		layerLerps[ AFPoseJoints[i] ] = AFPoseBlendWeight;
+	}
 
 	return true;
 }
@@ -4163,76 +4200,60 @@ bool idAnimator::FrameHasChanged( int currentTime ) const {
 
 /*
 =====================
-idAnimator::CreateFrame
+idAnimator::BlendChannels
+
+Decodes the animations of all channels and the articulated figure pose into
+layers and blends them over the joint frame in a single pass.
+Returns true if any animation was blended.
 =====================
 */
-bool idAnimator::CreateFrame( int currentTime, bool force ) {
+bool idAnimator::BlendChannels( int currentTime, int numJoints, float *jointFrame, bool debugInfo ) const {
 	int					i, j;
-	int					numJoints;
-	int					parentNum;
+	int					stride;
+	int					layerSize;
+	int					numLayers;
+	int					maxLayers;
 	bool				hasAnim;
-	bool				debugInfo;
 	float				baseBlend;
 	float				blendWeight;
+	float *				layerData;
+	float *				layerFrames[ ANIM_MaxBlendLayers ];
+	float *				layerLerps[ ANIM_MaxBlendLayers ];
 	const idAnimBlend *	blend;
-	const int *			jointParent;
-	const jointMod_t *	jointMod;
-	const idJointQuat *	defaultPose;
-
-	static idCVar		r_showSkel( "r_showSkel", "0", CVAR_RENDERER | CVAR_INTEGER, "", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 
-	if ( gameLocal.inCinematic && gameLocal.skipCinematic ) {
-		return false;
-	}
-
-	if ( !modelDef || !modelDef->ModelHandle() ) {
-		return false;
-	}
-
-	if ( !force && !r_showSkel.GetInteger() ) {
-		if ( lastTransformTime == currentTime ) {
-			return false;
-		}
-		if ( lastTransformTime != -1 && !stoppedAnimatingUpdate && !IsAnimating( currentTime ) ) {
-			return false;
+	// only allocate layers for the anims that may be blended
+	maxLayers = AFPoseJoints.Num() ? 1 : 0;
+	for( i = ANIMCHANNEL_ALL; i < ANIM_NumAnimChannels; i++ ) {
+		blend = channels[ i ];
+		for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
+			if ( blend->Anim() ) {
+				maxLayers++;
+			}
 		}
 	}
 
-	lastTransformTime = currentTime;
-	stoppedAnimatingUpdate = false;
-
-	if ( entity && ( ( g_debugAnim.GetInteger() == entity->entityNumber ) || ( g_debugAnim.GetInteger() == -2 ) ) ) {
-		debugInfo = true;
-		gameLocal.Printf( "---------------\n%d: entity '%s':\n", gameLocal.time, entity->GetName() );
- 		gameLocal.Printf( "model '%s':\n", modelDef->GetModelName() );
-	} else {
-		debugInfo = false;
-	}
-
-	// init the joint buffer
-	if ( AFPoseJoints.Num() ) {
-		// initialize with AF pose anim for the case where there are no other animations and no AF pose joint modifications
-		defaultPose = AFPoseJointFrame.Ptr();
-	} else {
-		defaultPose = modelDef->GetDefaultPose();
-	}
-
-	if ( !defaultPose ) {
-		//gameLocal.Warning( "idAnimator::CreateFrame: no defaultPose on '%s'", modelDef->Name() );
-		return false;
+	stride = JointQuatSoAStride( numJoints );
+	layerSize = ( JOINTQUAT_SOA_COMPONENTS + 1 ) * stride;
+	layerData = ( float * )_alloca16( maxLayers * layerSize * sizeof( layerData[0] ) );
+	for ( i = 0; i < ANIM_MaxBlendLayers; i++ ) {
+		if ( i < maxLayers ) {
+			layerFrames[i] = layerData + i * layerSize;
+			layerLerps[i] = layerFrames[i] + JOINTQUAT_SOA_COMPONENTS * stride;
+		} else {
+			layerFrames[i] = NULL;
+			layerLerps[i] = NULL;
+		}
 	}
 
-	numJoints = modelDef->Joints().Num();
-	idJointQuat *jointFrame = ( idJointQuat * )_alloca16( numJoints * sizeof( jointFrame[0] ) );
-	SIMDProcessor->Memcpy( jointFrame, defaultPose, numJoints * sizeof( jointFrame[0] ) );
-
 	hasAnim = false;
+	numLayers = 0;
 
 	// blend the all channel
 	baseBlend = 0.0f;
 	blend = channels[ ANIMCHANNEL_ALL ];
 	for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
-		if ( blend->BlendAnim( currentTime, ANIMCHANNEL_ALL, numJoints, jointFrame, baseBlend, removeOriginOffset, false, debugInfo ) ) {
+		if ( blend->BlendAnim( currentTime, ANIMCHANNEL_ALL, numJoints, layerFrames[ numLayers ], layerLerps[ numLayers ], baseBlend, removeOriginOffset, false, debugInfo ) ) {
+			numLayers++;
 			hasAnim = true;
 			if ( baseBlend >= 1.0f ) {
 				break;
@@ -4253,7 +4274,8 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 			blendWeight = baseBlend;
 			blend = channels[ i ];
 			for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
-				if ( blend->BlendAnim( currentTime, i, numJoints, jointFrame, blendWeight, removeOriginOffset, false, debugInfo ) ) {
+				if ( blend->BlendAnim( currentTime, i, numJoints, layerFrames[ numLayers ], layerLerps[ numLayers ], blendWeight, removeOriginOffset, false, debugInfo ) ) {
+					numLayers++;
 					hasAnim = true;
 					if ( blendWeight >= 1.0f ) {
 						// fully blended
@@ -4273,7 +4295,8 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 		blend = channels[ ANIMCHANNEL_EYELIDS ];
 		blendWeight = baseBlend;
 		for( j = 0; j < ANIM_MaxAnimsPerChannel; j++, blend++ ) {
-			if ( blend->BlendAnim( currentTime, ANIMCHANNEL_EYELIDS, numJoints, jointFrame, blendWeight, removeOriginOffset, true, debugInfo ) ) {
+			if ( blend->BlendAnim( currentTime, ANIMCHANNEL_EYELIDS, numJoints, layerFrames[ numLayers ], layerLerps[ numLayers ], blendWeight, removeOriginOffset, true, debugInfo ) ) {
+				numLayers++;
 				hasAnim = true;
 				if ( blendWeight >= 1.0f ) {
 					// fully blended
@@ -4284,17 +4307,419 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 	}
 
 	// blend the articulated figure pose
-	if ( BlendAFPose( jointFrame ) ) {
+	if ( BlendAFPose( layerFrames[ numLayers ], layerLerps[ numLayers ] ) ) {
+		numLayers++;
 		hasAnim = true;
 	}
 
+	// the layers replace or blend over the joints in order
+	if ( numLayers ) {
+		SIMDProcessor->BlendJointsSoA( jointFrame, layerFrames, layerLerps, numLayers, numJoints );
+	}
+
+	return hasAnim;
+}
+
+/*
+=====================
+idAnimator::CalcLODLevel
+
+Entities covering little of the local player's view get a higher lod.
+The joints would differ between the server and clients, so multiplayer
+games always blend at full rate. The lod only applies to the frames
+created for the render entity, see BlendFrame.
+=====================
+*/
+int idAnimator::CalcLODLevel( void ) const {
+	idPlayer	*player;
+	float		radius;
+	float		distance;
+	float		size;
+	float		lodSize;
+	int			level;
+
+	if ( !g_animLOD.GetBool() || !entity || gameLocal.isMultiplayer || AFPoseJoints.Num() || frameBounds.IsCleared() ) {
+		return 0;
+	}
+
+	player = gameLocal.GetLocalPlayer();
+	if ( !player || player == entity ) {
+		return 0;
+	}
+
+	radius = frameBounds.GetRadius();
+	distance = ( entity->GetPhysics()->GetOrigin() - player->GetEyePosition() ).Length();
+	if ( distance <= radius ) {
+		return 0;
+	}
+
+	// fraction of the screen width covered by the bounds
+	size = radius / ( distance * idMath::Tan( DEG2RAD( g_fov.GetFloat() * 0.5f ) ) );
+
+	lodSize = g_animLODScreenSize.GetFloat();
+	for ( level = 0; level < ANIM_MaxLODLevels && size < lodSize; level++ ) {
+		lodSize *= 0.5f;
+	}
+	return level;
+}
+
+/*
+=====================
+idAnimator::GetLODLevel
+=====================
+*/
+int idAnimator::GetLODLevel( void ) const {
+	return lodLevel;
+}
+
+/*
+=====================
+idAnimator::FrameNeeded
+
+Returns true if the animator was transformed during the previous frame and
+its animations will change the joints at the current time.
+=====================
+*/
+bool idAnimator::FrameNeeded( int currentTime, int previousTime ) const {
+	if ( !modelDef || !modelDef->ModelHandle() || !joints ) {
+		return false;
+	}
+	if ( entity && entity->IsHidden() ) {
+		return false;
+	}
+	if ( lastTransformTime == currentTime || lastTransformTime < previousTime ) {
+		return false;
+	}
+	return ( stoppedAnimatingUpdate || IsAnimating( currentTime ) );
+}
+
+/*
+=====================
+idAnimator::CreatedFrameAhead
+
+Returns true once after CreateFrames created a frame for the animator, so the
+first render entity update still sees the joints changed.
+=====================
+*/
+bool idAnimator::CreatedFrameAhead( void ) {
+	bool created = createdFrameAhead;
+	createdFrameAhead = false;
+	return created;
+}
+
+typedef struct animFrameBatch_s {
+	int							firstFrame;
+	int							numFrames;
+} animFrameBatch_t;
+
+typedef struct animFrameJob_s {
+	const animatorFrame_t *		frames;
+	const animFrameBatch_t *	batches;
+} animFrameJob_t;
+
+/*
+=====================
+ANIM_AddModelOffset
+=====================
+*/
+static void ANIM_AddModelOffset( float *jointFrame, int numJoints, const idVec3 &offset ) {
+	int stride = JointQuatSoAStride( numJoints );
+
+	jointFrame[ 4 * stride ] += offset.x;
+	jointFrame[ 5 * stride ] += offset.y;
+	jointFrame[ 6 * stride ] += offset.z;
+}
+
+/*
+=====================
+ANIM_SortFramesByModel
+=====================
+*/
+static int ANIM_SortFramesByModel( const void *a, const void *b ) {
+	const idDeclModelDef *modelA = static_cast<const animatorFrame_t *>( a )->animator->ModelDef();
+	const idDeclModelDef *modelB = static_cast<const animatorFrame_t *>( b )->animator->ModelDef();
+
+	if ( modelA < modelB ) {
+		return -1;
+	}
+	if ( modelA > modelB ) {
+		return 1;
+	}
+	return 0;
+}
+
+/*
+=====================
+idAnimator::CreateFrameBatch
+
+The animators share a model. Their animations are blended one animator at a
+time, then the joints of all of them are converted to matrices and
+transformed with a single call, which works on eight skeletons at a time.
+Animators with joint modifications are transformed on their own.
+=====================
+*/
+void idAnimator::CreateFrameBatch( const animatorFrame_t *frames, int numFrames ) {
+	int						i;
+	int						numJoints;
+	int						frameSize;
+	int						numSkeletons;
+	idAnimator *			animator;
+	float *					jointFrames;
+	float *					jointFrame;
+	idJointMat *			jointMats[ ANIM_MaxFrameBatch ];
+	const idDeclModelDef *	modelDef;
+
+	assert( numFrames <= ANIM_MaxFrameBatch );
+
+	modelDef = frames[0].animator->modelDef;
+	if ( !modelDef || !modelDef->ModelHandle() ) {
+		return;
+	}
+
+	numJoints = modelDef->NumJoints();
+	frameSize = JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( numJoints );
+	jointFrames = ( float * )_alloca16( numFrames * frameSize * sizeof( jointFrames[0] ) );
+
+	numSkeletons = 0;
+	for ( i = 0; i < numFrames; i++ ) {
+		animator = frames[i].animator;
+		jointFrame = jointFrames + numSkeletons * frameSize;
+
+		if ( !animator->BlendFrame( frames[i].time, false, true, jointFrame ) ) {
+			continue;
+		}
+		animator->createdFrameAhead = true;
+
+		if ( animator->jointMods.Num() ) {
+			animator->TransformJointMods( jointFrame );
+			continue;
+		}
+
+		// add in the model offset
+		ANIM_AddModelOffset( jointFrame, numJoints, modelDef->GetVisualOffset() );
+		jointMats[ numSkeletons++ ] = animator->joints;
+	}
+
+	if ( numSkeletons ) {
+		SIMDProcessor->TransformJointsSoA( jointMats, jointFrames, numSkeletons, modelDef->JointParents(), numJoints );
+	}
+}
+
+/*
+=====================
+idAnimator::CreateFramesJob
+=====================
+*/
+void idAnimator::CreateFramesJob( void *data, int first, int last ) {
+	const animFrameJob_t *job = static_cast<const animFrameJob_t *>( data );
+
+	for ( int i = first; i < last; i++ ) {
+		CreateFrameBatch( job->frames + job->batches[i].firstFrame, job->batches[i].numFrames );
+	}
+}
+
+/*
+=====================
+idAnimator::CreateFrames
+
+Creates the frames of many animators on the job threads before the renderer
+asks for them. The animators are sorted by model, and up to ANIM_MaxFrameBatch
+animators of the same model are transformed together by CreateFrameBatch.
+The animators may not share any state, and CreateFrame may not allocate memory.
+=====================
+*/
+void idAnimator::CreateFrames( animatorFrame_t *frames, int numFrames ) {
+	int					i;
+	int					numThreads;
+	int					numBatches;
+	int					granularity;
+	animFrameBatch_t *	batches;
+	animFrameJob_t		job;
+
+	numThreads = g_animThreads.GetInteger();
+	if ( numThreads == 1 || numFrames <= 0 ) {
+		return;
+	}
+
+	// the debug output is printed and drawn from CreateFrame
+	if ( g_debugAnim.GetInteger() != -1 || r_showSkel.GetInteger() || cvarSystem->GetCVarBool( "r_showAnimLOD" ) ) {
+		return;
+	}
+
+	qsort( frames, numFrames, sizeof( frames[0] ), ANIM_SortFramesByModel );
+
+	batches = ( animFrameBatch_t * )_alloca( numFrames * sizeof( batches[0] ) );
+	numBatches = 0;
+	for ( i = 0; i < numFrames; i++ ) {
+		if ( numBatches > 0 && batches[numBatches-1].numFrames < ANIM_MaxFrameBatch &&
+				frames[i].animator->modelDef == frames[ batches[numBatches-1].firstFrame ].animator->modelDef ) {
+			batches[numBatches-1].numFrames++;
+		} else {
+			batches[numBatches].firstFrame = i;
+			batches[numBatches].numFrames = 1;
+			numBatches++;
+		}
+	}
+
+	if ( numThreads <= 0 ) {
+		granularity = 0;
+	} else {
+		granularity = ( numBatches + numThreads - 1 ) / numThreads;
+	}
+
+	job.frames = frames;
+	job.batches = batches;
+	jobManager->ParallelFor( "animFrames", numBatches, granularity, CreateFramesJob, &job );
+}
+
+/*
+=====================
+idAnimator::BlendFrame
+
+Blends the animations into the joint frame, which is in the structure of
+arrays layout of JointTransform.h. Returns false if the joints don't have
+to be recalculated.
+
+At a lower lod the animations are only blended every g_animLODInterval
+milliseconds. In between the joints are interpolated between the last two
+blended poses, so the entity lags one interval behind its animations.
+Only render frames use a lower lod, the joints game code reads for muzzles,
+attachments and the like are always blended at full rate.
+=====================
+*/
+bool idAnimator::BlendFrame( int currentTime, bool force, bool renderFrame, float *jointFrame ) {
+	int					i;
+	int					numJoints;
+	int					stride;
+	int					frameSize;
+	int					lodInterval;
+	bool				hasAnim;
+	bool				debugInfo;
+	bool				finalUpdate;
+	bool				forcedUpdate;
+	const idJointQuat *	defaultPose;
+
+	if ( gameLocal.inCinematic && gameLocal.skipCinematic ) {
+		return false;
+	}
+
+	if ( !modelDef || !modelDef->ModelHandle() ) {
+		return false;
+	}
+
+	if ( !force && !r_showSkel.GetInteger() ) {
+		if ( lastTransformTime == currentTime ) {
+			return false;
+		}
+		if ( lastTransformTime != -1 && !stoppedAnimatingUpdate && !IsAnimating( currentTime ) ) {
+			return false;
+		}
+	}
+
+	finalUpdate = stoppedAnimatingUpdate;
+	forcedUpdate = ( lastTransformTime == -1 );
+	lastTransformTime = currentTime;
+	stoppedAnimatingUpdate = false;
+	jointsSerial = Sys_InterlockedIncrement( jointsSerialCount );
+
+	if ( entity && ( ( g_debugAnim.GetInteger() == entity->entityNumber ) || ( g_debugAnim.GetInteger() == -2 ) ) ) {
+		debugInfo = true;
+		gameLocal.Printf( "---------------\n%d: entity '%s':\n", gameLocal.time, entity->GetName() );
+ 		gameLocal.Printf( "model '%s':\n", modelDef->GetModelName() );
+	} else {
+		debugInfo = false;
+	}
+
+	// init the joint buffer
+	if ( AFPoseJoints.Num() ) {
+		// initialize with AF pose anim for the case where there are no other animations and no AF pose joint modifications
+		defaultPose = AFPoseJointFrame.Ptr();
+	} else {
+		defaultPose = modelDef->GetDefaultPose();
+	}
+
+	if ( !defaultPose ) {
+		//gameLocal.Warning( "idAnimator::CreateFrame: no defaultPose on '%s'", modelDef->Name() );
+		return false;
+	}
+
+	numJoints = modelDef->Joints().Num();
+	stride = JointQuatSoAStride( numJoints );
+	frameSize = JOINTQUAT_SOA_COMPONENTS * stride;
+	JointQuatsToSoA( jointFrame, defaultPose, numJoints );
+
+	// the last update after the animations stopped has to reach the final pose
+	if ( !renderFrame || force || finalUpdate || lodNextFrame.Num() != frameSize ) {
+		lodLevel = 0;
+	} else {
+		lodLevel = CalcLODLevel();
+	}
+
+	if ( entity && gameLocal.GetLocalPlayer() && cvarSystem->GetCVarBool( "r_showAnimLOD" ) ) {
+		static const idVec4 *lodColors[ ANIM_MaxLODLevels + 1 ] = { &colorWhite, &colorGreen, &colorYellow, &colorRed };
+		gameRenderWorld->DrawText( va( "anim lod %d", lodLevel ), entity->GetPhysics()->GetOrigin() + idVec3( 0.0f, 0.0f, frameBounds[1].z + 8.0f ),
+									0.25f, *lodColors[ lodLevel ], gameLocal.GetLocalPlayer()->viewAngles.ToMat3(), 1 );
+	}
+
+	if ( lodLevel > 0 ) {
+		lodInterval = g_animLODInterval.GetInteger() << ( lodLevel - 1 );
+		// blend again after a ForceUpdate, the previous pose is kept to interpolate from
+		if ( !forcedUpdate && lodFramesValid && currentTime >= lodUpdateTime && currentTime < lodUpdateTime + lodInterval ) {
+			// interpolate in between blends
+			hasAnim = true;
+		} else {
+			hasAnim = BlendChannels( currentTime, numJoints, jointFrame, debugInfo );
+
+			if ( lodFramesValid ) {
+				SIMDProcessor->Memcpy( lodPrevFrame.Ptr(), lodNextFrame.Ptr(), frameSize * sizeof( jointFrame[0] ) );
+			} else {
+				SIMDProcessor->Memcpy( lodPrevFrame.Ptr(), jointFrame, frameSize * sizeof( jointFrame[0] ) );
+			}
+			SIMDProcessor->Memcpy( lodNextFrame.Ptr(), jointFrame, frameSize * sizeof( jointFrame[0] ) );
+			lodFramesValid = true;
+			lodUpdateTime = currentTime;
+		}
+
+		float *lerps = ( float * )_alloca16( stride * sizeof( lerps[0] ) );
+		const float *nextFrame = lodNextFrame.Ptr();
+		const float lerp = (float)( currentTime - lodUpdateTime ) / lodInterval;
+		for ( i = 0; i < stride; i++ ) {
+			lerps[i] = lerp;
+		}
+		SIMDProcessor->Memcpy( jointFrame, lodPrevFrame.Ptr(), frameSize * sizeof( jointFrame[0] ) );
+		SIMDProcessor->BlendJointsSoA( jointFrame, &nextFrame, &lerps, 1, numJoints );
+	} else {
+		hasAnim = BlendChannels( currentTime, numJoints, jointFrame, debugInfo );
+		lodFramesValid = false;
+	}
+
 	if ( !hasAnim && !jointMods.Num() ) {
 		// no animations were updated
 		return false;
 	}
 
+	return true;
+}
+
+/*
+=====================
+idAnimator::TransformJointMods
+
+Converts the joint frame to matrices and transforms the hierarchy with the
+joint modifications applied.
+=====================
+*/
+void idAnimator::TransformJointMods( const float *jointFrame ) {
+	int					i, j;
+	int					parentNum;
+	const int *			jointParent;
+	const jointMod_t *	jointMod;
+
+	idJointQuat *jointQuats = ( idJointQuat * )_alloca16( numJoints * sizeof( jointQuats[0] ) );
+	JointQuatsFromSoA( jointQuats, jointFrame, numJoints );
+
 	// convert the joint quaternions to rotation matrices
-	SIMDProcessor->ConvertJointQuatsToJointMats( joints, jointFrame, numJoints );
+	SIMDProcessor->ConvertJointQuatsToJointMats( joints, jointQuats, numJoints );
 
 	// check if we need to modify the origin
 	if ( jointMods.Num() && ( jointMods[0]->jointnum == 0 ) ) {
@@ -4402,6 +4827,40 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 
 	// transform the rest of the hierarchy
 	SIMDProcessor->TransformJoints( joints, jointParent, i, numJoints - 1 );
+}
+
+
+/*
+=====================
+idAnimator::CreateFrame
+
+Only frames created for the render entity may use a lower animation lod.
+=====================
+*/
+bool idAnimator::CreateFrame( int currentTime, bool force, bool renderFrame ) {
+	float *jointFrame;
+
+	if ( !modelDef || !modelDef->ModelHandle() ) {
+		return false;
+	}
+
+	// the joints were interpolated at a lower lod, blend them again at full rate for game code
+	if ( !renderFrame && lodLevel > 0 ) {
+		force = true;
+	}
+
+	jointFrame = ( float * )_alloca16( JOINTQUAT_SOA_COMPONENTS * JointQuatSoAStride( modelDef->NumJoints() ) * sizeof( jointFrame[0] ) );
+	if ( !BlendFrame( currentTime, force, renderFrame, jointFrame ) ) {
+		return false;
+	}
+
+	if ( jointMods.Num() ) {
+		TransformJointMods( jointFrame );
+	} else {
+		// add in the model offset
+		ANIM_AddModelOffset( jointFrame, numJoints, modelDef->GetVisualOffset() );
+		SIMDProcessor->TransformJointsSoA( &joints, jointFrame, 1, modelDef->JointParents(), numJoints );
+	}
 
 	return true;
 }
@@ -4565,6 +5024,18 @@ void idAnimator::GetJoints( int *numJoints, idJointMat **jointsPtr ) {
 	*jointsPtr	= this->joints;
 }
 
+/*
+=====================
+idAnimator::GetJointsSerial
+
+Lets the renderer reuse the skinned vertexes until the joints change.
+Zero if the joints were never calculated.
+=====================
+*/
+int idAnimator::GetJointsSerial( void ) const {
+	return jointsSerial;
+}
+
 /*
 =====================
 idAnimator::GetAnimFlags
@@ -0,0 +1,128 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __GAME_TIMINGS_H__
+#define __GAME_TIMINGS_H__
+
+/*
+===============================================================================
+
+	Game system timings.
+
+	Timings are only gathered on the thread that enabled them. A system only
+	gets the time not spent in other systems started while it was running, so
+	the timings of all systems add up to at most the game frame time.
+
+===============================================================================
+*/
+
+#define MAX_GAME_TIMING_DEPTH		32
+
+extern ID_THREAD_LOCAL bool			gameTimingsThread;
+
+class idGameTimings {
+public:
+							idGameTimings( void );
+
+	void					Enable( bool enable );
+	bool					IsEnabled( void ) const { return enabled; }
+	void					Clear( void );
+	void					Start( gameTiming_t timing );
+	void					Stop( void );
+	double					Milliseconds( gameTiming_t timing ) const;
+
+private:
+	bool					enabled;
+	int						depth;
+	double					startTicks;
+	double					ticks[GAME_TIMING_NUM];
+	gameTiming_t			stack[MAX_GAME_TIMING_DEPTH];
+};
+
+extern idGameTimings		gameTimings;
+
+ID_INLINE idGameTimings::idGameTimings( void ) {
+	enabled = false;
+	Clear();
+}
+
+ID_INLINE void idGameTimings::Enable( bool enable ) {
+	enabled = enable;
+	gameTimingsThread = enable;
+	Clear();
+}
+
+ID_INLINE void idGameTimings::Clear( void ) {
+	depth = 0;
+	startTicks = 0.0;
+	memset( ticks, 0, sizeof( ticks ) );
+}
+
+ID_INLINE void idGameTimings::Start( gameTiming_t timing ) {
+	double now;
+
+	if ( !enabled || !gameTimingsThread ) {
+		return;
+	}
+	now = idLib::sys->GetClockTicks();
+	if ( depth > 0 && depth <= MAX_GAME_TIMING_DEPTH ) {
+		ticks[stack[depth - 1]] += now - startTicks;
+	}
+	if ( depth < MAX_GAME_TIMING_DEPTH ) {
+		stack[depth] = timing;
+	}
+	depth++;
+	startTicks = now;
+}
+
+ID_INLINE void idGameTimings::Stop( void ) {
+	double now;
+
+	if ( !enabled || !gameTimingsThread || depth <= 0 ) {
+		return;
+	}
+	now = idLib::sys->GetClockTicks();
+	depth--;
+	if ( depth < MAX_GAME_TIMING_DEPTH ) {
+		ticks[stack[depth]] += now - startTicks;
+	}
+	startTicks = now;
+}
+
+ID_INLINE double idGameTimings::Milliseconds( gameTiming_t timing ) const {
+	return ticks[timing] / ( idLib::sys->ClockTicksPerSecond() * 0.001 );
+}
+
+// times the scope it is declared in
+class idGameTiming {
+public:
+							idGameTiming( gameTiming_t timing ) { gameTimings.Start( timing ); }
+							~idGameTiming( void ) { gameTimings.Stop(); }
+};
+
+#endif /* !__GAME_TIMINGS_H__ */
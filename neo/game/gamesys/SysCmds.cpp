@@ -1324,6 +1324,83 @@ static void Cmd_CollisionModelInfo_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==================
+Cmd_CollisionModelBenchmark_f
+
+  traces the same set of random translations through the collision map every time
+==================
+*/
+static void Cmd_CollisionModelBenchmark_f( const idCmdArgs &args ) {
+	int i, numTraces, numPointHits, numBoxHits, numInSolid;
+	idBounds bounds;
+	idRandom random;
+	idVec3 dir, *starts, *ends;
+	trace_t trace;
+	idTimer pointTimer, boxTimer, contentsTimer;
+
+	if ( !gameLocal.CheatsOk() ) {
+		return;
+	}
+
+	if ( !collisionModelManager->GetModelBounds( 0, bounds ) ) {
+		gameLocal.Printf( "no collision map loaded\n" );
+		return;
+	}
+
+	numTraces = 10000;
+	if ( args.Argc() > 1 ) {
+		numTraces = Max( atoi( args.Argv( 1 ) ), 1 );
+	}
+
+	const idTraceModel trm( idBounds( idVec3( -16, -16, 0 ), idVec3( 16, 16, 68 ) ) );
+
+	// fixed seed so runs can be compared
+	random.SetSeed( 0 );
+	starts = new idVec3[numTraces];
+	ends = new idVec3[numTraces];
+	for ( i = 0; i < numTraces; i++ ) {
+		starts[i].x = bounds[0].x + random.RandomFloat() * ( bounds[1].x - bounds[0].x );
+		starts[i].y = bounds[0].y + random.RandomFloat() * ( bounds[1].y - bounds[0].y );
+		starts[i].z = bounds[0].z + random.RandomFloat() * ( bounds[1].z - bounds[0].z );
+		dir.Set( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() );
+		if ( dir.Normalize() == 0.0f ) {
+			dir = idVec3( 1, 0, 0 );
+		}
+		ends[i] = starts[i] + dir * ( 64.0f + random.RandomFloat() * 960.0f );
+	}
+
+	numPointHits = 0;
+	pointTimer.Start();
+	for ( i = 0; i < numTraces; i++ ) {
+		collisionModelManager->Translation( &trace, starts[i], ends[i], NULL, mat3_identity, MASK_SOLID, 0, vec3_origin, mat3_identity );
+		numPointHits += ( trace.fraction < 1.0f );
+	}
+	pointTimer.Stop();
+
+	numBoxHits = 0;
+	boxTimer.Start();
+	for ( i = 0; i < numTraces; i++ ) {
+		collisionModelManager->Translation( &trace, starts[i], ends[i], &trm, mat3_identity, MASK_SOLID, 0, vec3_origin, mat3_identity );
+		numBoxHits += ( trace.fraction < 1.0f );
+	}
+	boxTimer.Stop();
+
+	numInSolid = 0;
+	contentsTimer.Start();
+	for ( i = 0; i < numTraces; i++ ) {
+		numInSolid += ( collisionModelManager->Contents( starts[i], &trm, mat3_identity, MASK_SOLID, 0, vec3_origin, mat3_identity ) != 0 );
+	}
+	contentsTimer.Stop();
+
+	delete[] starts;
+	delete[] ends;
+
+	gameLocal.Printf( "%6d point traces: %7.2f ms, %d hits\n", numTraces, pointTimer.Milliseconds(), numPointHits );
+	gameLocal.Printf( "%6d box traces:   %7.2f ms, %d hits\n", numTraces, boxTimer.Milliseconds(), numBoxHits );
+	gameLocal.Printf( "%6d box contents: %7.2f ms, %d in solid\n", numTraces, contentsTimer.Milliseconds(), numInSolid );
+}
+
 /*
 ==================
 Cmd_ExportModels_f
@@ -1376,6 +1453,42 @@ static void Cmd_ReexportModels_f( const idCmdArgs &args ) {
 	idAnimManager::forceExport = false;
 }
 
+/*
+==================
+Cmd_BuildAnimCache_f
+
+Writes the binary files of all md5 animations and meshes, including the ones in pak files
+==================
+*/
+static void Cmd_BuildAnimCache_f( const idCmdArgs &args ) {
+	idFileList *	files;
+	int				i, numBuilt, numFailed;
+
+	if ( !g_useBinaryAnims.GetBool() ) {
+		gameLocal.Printf( "binary animations are disabled with g_useBinaryAnims 0\n" );
+		return;
+	}
+
+	numBuilt = numFailed = 0;
+	files = fileSystem->ListFilesTree( "models", "." MD5_ANIM_EXT, true );
+	for ( i = 0; i < files->GetNumFiles(); i++ ) {
+		idMD5Anim anim;
+		if ( anim.LoadBinaryAnim( files->GetFile( i ) ) ) {
+			continue;
+		}
+		if ( anim.LoadTextAnim( files->GetFile( i ) ) && anim.WriteBinaryAnim() ) {
+			numBuilt++;
+		} else {
+			numFailed++;
+		}
+	}
+	gameLocal.Printf( "%i md5 animations, %i written to generated/, %i failed\n", files->GetNumFiles(), numBuilt, numFailed );
+	fileSystem->FreeFileList( files );
+
+	// the meshes are loaded by the renderer
+	cmdSystem->BufferCommandText( CMD_EXEC_NOW, "buildMD5MeshCache\n" );
+}
+
 /*
 ==================
 Cmd_ReloadAnims_f
@@ -2351,9 +2464,11 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "script",				Cmd_Script_f,				CMD_FL_GAME|CMD_FL_CHEAT,	"executes a line of script" );
 	cmdSystem->AddCommand( "listCollisionModels",	Cmd_ListCollisionModels_f,	CMD_FL_GAME,				"lists collision models" );
 	cmdSystem->AddCommand( "collisionModelInfo",	Cmd_CollisionModelInfo_f,	CMD_FL_GAME,				"shows collision model info" );
+	cmdSystem->AddCommand( "cm_benchmark",			Cmd_CollisionModelBenchmark_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"traces a fixed set of random translations through the collision map" );
 	cmdSystem->AddCommand( "reexportmodels",		Cmd_ReexportModels_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"reexports models", ArgCompletion_DefFile );
 	cmdSystem->AddCommand( "reloadanims",			Cmd_ReloadAnims_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads animations" );
 	cmdSystem->AddCommand( "listAnims",				Cmd_ListAnims_f,			CMD_FL_GAME,				"lists all animations" );
+	cmdSystem->AddCommand( "buildAnimCache",		Cmd_BuildAnimCache_f,		CMD_FL_GAME,				"writes the binary files of all md5 animations and meshes to generated/" );
 	cmdSystem->AddCommand( "aasStats",				Cmd_AASStats_f,				CMD_FL_GAME,				"shows AAS stats" );
 	cmdSystem->AddCommand( "testDamage",			Cmd_TestDamage_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests a damage def", idCmdSystem::ArgCompletion_Decl<DECL_ENTITYDEF> );
 	cmdSystem->AddCommand( "weaponSplat",			Cmd_WeaponSplat_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"projects a blood splat on the player weapon" );
@@ -2361,6 +2476,7 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "deleteSelected",		Cmd_DeleteSelected_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"deletes selected entity" );
 	cmdSystem->AddCommand( "saveMoveables",			Cmd_SaveMoveables_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"save all moveables to the .map file" );
 	cmdSystem->AddCommand( "saveRagdolls",			Cmd_SaveRagdolls_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"save all ragdoll poses to the .map file" );
+	cmdSystem->AddCommand( "afSolverStats",			idPhysics_AF::SolverStats_f,	CMD_FL_GAME|CMD_FL_CHEAT,	"prints the lcp versus sparse articulated figure solver statistics, 'clear' resets them" );
 	cmdSystem->AddCommand( "bindRagdoll",			Cmd_BindRagdoll_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"binds ragdoll at the current drag position" );
 	cmdSystem->AddCommand( "unbindRagdoll",			Cmd_UnbindRagdoll_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"unbinds the selected ragdoll" );
 	cmdSystem->AddCommand( "saveLights",			Cmd_SaveLights_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"saves all lights to the .map file" );
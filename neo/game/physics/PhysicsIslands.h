@@ -0,0 +1,97 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#ifndef __PHYSICSISLANDS_H__
+#define __PHYSICSISLANDS_H__
+
+/*
+===============================================================================
+
+  Finds islands of active entities that may touch each other during a frame.
+  Before the entities think the first rigid body of every island that only
+  holds free rigid bodies is stepped on the job threads. Evaluate uses the
+  result when the entity runs its physics in the usual order, so the outcome
+  is the same as stepping everything on the game thread.
+
+  Only free rigid bodies are stepped in parallel. An island that holds an
+  articulated figure, a monster, an actor or a pusher stays on the game
+  thread. The AF solver uses the shared idMatX and idVecX temp memory and
+  carries constraint multipliers over from the previous frame, so a ragdoll
+  cannot be stepped in advance and thrown away like a rigid body step.
+
+===============================================================================
+*/
+
+class idPhysics_RigidBody;
+
+class idPhysicsIslands {
+public:
+							idPhysicsIslands( void );
+
+	void					Clear( void );
+							// step the rigid bodies that start an island on the job threads
+	void					StepIslands( void );
+							// called when a body could not use its parallel step
+	void					ParallelStepDiscarded( void ) { numDiscarded++; }
+	void					PrintStatistics( void ) const;
+
+private:
+	struct islandBody_s {
+		idEntity *			ent;
+		idPhysics_RigidBody *rigidBody;			// NULL if the body cannot be stepped in parallel
+		idBounds			bounds;				// bounds the body may touch during the frame
+		int					parent;				// union-find parent, the root identifies the island
+	};
+	struct islandSort_s {
+		float				minX;
+		int					body;
+	};
+
+	idList<islandBody_s>	bodies;
+	idList<islandSort_s>	sortedBodies;
+	idList<bool>			islandShared;
+	idList<idPhysics_RigidBody *> parallelBodies;
+	int						bodyForEntity[MAX_GENTITIES];
+	int						timeStepMSec;
+	int						endTimeMSec;
+
+	int						numBodies;
+	int						numIslands;
+	int						numSerialIslands;	// islands left to the game thread because of other physics
+	int						numParallel;
+	int						numDiscarded;
+
+private:
+	int						FindIsland( int body );
+	void					MergeIslands( int body1, int body2 );
+	static int				SortByMinX( const islandSort_s *a, const islandSort_s *b );
+	static void				StepBodies( void *data, int first, int last );
+};
+
+#endif /* !__PHYSICSISLANDS_H__ */
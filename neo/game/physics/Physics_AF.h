@@ -104,6 +104,7 @@ public:
 	idAFBody *				GetBody2( void ) const { return body2; }
 	void					SetPhysics( idPhysics_AF *p ) { physics = p; }
 	const idVecX &			GetMultiplier( void );
+	void					ClearMultiplier( void ) { lm.Zero(); }
 	virtual void			SetBody1( idAFBody *body );
 	virtual void			SetBody2( idAFBody *body );
 	virtual void			DebugDraw( void );
@@ -888,6 +889,10 @@ public:
 	void					SetForcePushable( const bool enable ) { forcePushable = enable; }
 							// update the clip model positions
 	void					UpdateClipModels( void );
+							// use the sparse warm started solver instead of the lcp for the auxiliary constraints
+	void					SetSparseSolver( const bool enable ) { sparseSolver = enable; }
+							// print or clear the statistics gathered with af_compareSolvers
+	static void				SolverStats_f( const idCmdArgs &args );
 
 public:	// common physics interface
 	void					SetClipModel( idClipModel *model, float density, int id = 0, bool freeOld = true );
@@ -1005,6 +1010,7 @@ private:
 	bool					selfCollision;					// if true the self collision is allowed
 	bool					comeToRest;						// if true the figure can come to rest
 	bool					linearTime;						// if true use the linear time algorithm
+	bool					sparseSolver;					// if true use the sparse solver for auxiliary constraints
 	bool					noImpact;						// if true do not activate when another object collides
 	bool					worldConstraintsLocked;			// if true world constraints cannot be moved
 	bool					forcePushable;					// if true can be pushed even when bound to a master
@@ -1027,6 +1033,9 @@ private:
 	void					ApplyFriction( float timeStep, float endTimeMSec );
 	void					PrimaryForces( float timeStep  );
 	void					AuxiliaryForces( float timeStep );
+	void					GetAuxiliaryMultipliers( idVecX &lm ) const;
+	int						SolveSparse( int numRows, const int *rowStart, const int *column, const float *value, const float *diagonal,
+										idVecX &x, const idVecX &b, const idVecX &lo, const idVecX &hi, const int *boxIndex ) const;
 	void					VerifyContactConstraints( void );
 	void					SetupContactConstraints( void );
 	void					ApplyContactForces( void );
@@ -63,6 +63,29 @@ typedef struct rigidBodyPState_s {
 	rigidBodyIState_t		i;							// state used for integration
 } rigidBodyPState_t;
 
+#define RB_MAX_CONTACTS				10
+
+typedef struct rigidBodyParallelStep_s {
+	bool					valid;
+	int						timeStepMSec;
+	int						endTimeMSec;
+	rigidBodyPState_t		start;						// state the step started from
+	idVec3					gravityVector;				// properties the step was taken with
+	float					mass;
+	float					linearFriction;
+	float					angularFriction;
+	int						clipMask;
+	rigidBodyPState_t		next;						// state at the end of the step
+	bool					collided;
+	trace_t					collision;
+	int						numContacts;				// -1 if the contacts depend on the collision response
+	contactInfo_t			contacts[RB_MAX_CONTACTS];
+	idBounds				bounds;						// bounds of everything the step may have touched
+	int						linkCount;					// clip link count when the step was taken
+	int						numTouching;				// other clip models within the bounds
+	unsigned int			touchHash;
+} rigidBodyParallelStep_t;
+
 class idPhysics_RigidBody : public idPhysics_Base {
 
 public:
@@ -85,6 +108,9 @@ public:
 							// enable/disable activation by impact
 	void					EnableImpact( void );
 	void					DisableImpact( void );
+							// step taken on a worker thread before the entity thinks, see idPhysicsIslands
+	bool					CanStepInParallel( void ) const;
+	void					StepInParallel( int timeStepMSec, int endTimeMSec );
 
 public:	// common physics interface
 	void					SetClipModel( idClipModel *model, float density, int id = 0, bool freeOld = true );
@@ -181,6 +207,9 @@ private:
 	bool					hasMaster;
 	bool					isOrientated;
 
+	// result of StepInParallel
+	rigidBodyParallelStep_t	parallelStep;
+
 private:
 	friend void				RigidBodyDerivatives( const float t, const void *clientData, const float *state, float *derivatives );
 	void					Integrate( const float deltaTime, rigidBodyPState_t &next );
@@ -191,6 +220,8 @@ private:
 	bool					TestIfAtRest( void ) const;
 	void					Rest( void );
 	void					DebugDraw( void );
+	void					GetParallelStepTouching( const idBounds &bounds, int &numTouching, unsigned int &touchHash, int &lastLinkCount ) const;
+	bool					UseParallelStep( int timeStepMSec, int endTimeMSec, rigidBodyPState_t &next, trace_t &collision, bool &collided );
 };
 
 #endif /* !__PHYSICS_RIGIDBODY_H__ */
@@ -646,6 +646,7 @@ idThread::Execute
 bool idThread::Execute( void ) {
 	idThread	*oldThread;
 	bool		done;
+	idGameTiming	timing( GAME_TIMING_SCRIPT );
 
 	if ( manualControl && ( waitingUntil > gameLocal.time ) ) {
 		return false;
@@ -41,9 +41,17 @@ If you have questions concerning this license or the applicable additional terms
 //
 //	idHeap
 //
+//	Small and medium allocations are served from per-thread caches
+//	so threads never contend on the common paths. Every thread gets
+//	its own small-block free lists and medium page lists the first
+//	time it allocates. Blocks freed by a thread that does not own
+//	them are pushed lock-free onto the owner's remote free list and
+//	reclaimed by the owner on its next allocation. Only page requests
+//	to the OS and the large heap go through the page lock.
+//
 //===============================================================
 
-#define SMALL_HEADER_SIZE		( (int) ( sizeof( byte ) + sizeof( byte ) ) )
+#define SMALL_HEADER_SIZE		( (int) ( sizeof( byte ) + sizeof( byte ) + sizeof( byte ) ) )
 #define MEDIUM_HEADER_SIZE		( (int) ( sizeof( mediumHeapEntry_s ) + sizeof( byte ) ) )
 #define LARGE_HEADER_SIZE		( (int) ( sizeof( dword * ) + sizeof( byte ) ) )
 
@@ -51,10 +59,19 @@ If you have questions concerning this license or the applicable additional terms
 #define SMALL_ALIGN( bytes )	( ALIGN_SIZE( (bytes) + SMALL_HEADER_SIZE ) - SMALL_HEADER_SIZE )
 #define MEDIUM_SMALLEST_SIZE	( ALIGN_SIZE( 256 ) + ALIGN_SIZE( MEDIUM_HEADER_SIZE ) )
 
+// the thread cache index and heap generation of the calling thread
+static ID_THREAD_LOCAL int	heap_threadCacheIndex = 0;
+static ID_THREAD_LOCAL int	heap_threadCacheGeneration = 0;
+static int					heap_generation = 0;
+
 
 class idHeap {
 
 public:
+	enum {
+		MAX_THREAD_CACHES = 32						// the last cache is shared by any threads beyond that
+	};
+
 					idHeap( void );
 					~idHeap( void );				// frees all associated data
 	void			Init( void );					// initialize
@@ -67,6 +84,13 @@ public:
 
 	void 			AllocDefragBlock( void );		// hack for huge renderbumps
 
+	int				GetThreadCacheIndex( void ) { return GetThreadCache()->index; }
+	int				GetNumThreadCaches( void ) const { return numThreadCaches; }
+	int				GetThreadCachePages( int index ) const;
+	int				GetThreadCacheRemoteFrees( int index ) const;
+	void			LockSharedCache( void );		// guards per thread data of the overflow cache outside the heap
+	void			UnlockSharedCache( void );
+
 private:
 
 	enum {
@@ -87,6 +111,7 @@ private:
 		page_s *			prev;					// used only when allocated
 		dword				largestFree;			// this data used by the medium-size heap manager
 		void *				firstFree;				// pointer to first free entry
+		int					cache;					// thread cache owning this medium page
 	};
 
 	struct mediumHeapEntry_s {
@@ -99,15 +124,30 @@ private:
 		dword				freeBlock;				// non-zero if free block
 	};
 
+	struct threadCache_s {							// per-thread small and medium heap state
+		void *				smallFirstFree[256/ALIGN+1];	// small heap allocator lists (for allocs of 1-255 bytes)
+		page_s *			smallCurPage;			// current page for small allocations
+		dword				smallCurPageOffset;		// byte offset in current page
+		page_s *			smallFirstUsedPage;		// first used page of the small heap manager
+
+		page_s *			mediumFirstFreePage;	// first partially free page
+		page_s *			mediumLastFreePage;		// last partially free page
+		page_s *			mediumFirstUsedPage;	// completely used page
+
+		void * volatile		remoteFree;				// blocks freed by other threads
+		volatile int		remoteFreeCount;		// number of blocks returned through remoteFree
+		volatile int		lock;					// only used when the cache is shared
+		bool				shared;					// true for the overflow cache
+		int					index;					// index in threadCaches
+		int					pagesAllocated;			// number of small and medium pages owned
+	};
+
 	// variables
-	void *			smallFirstFree[256/ALIGN+1];	// small heap allocator lists (for allocs of 1-255 bytes)
-	page_s *		smallCurPage;					// current page for small allocations
-	dword			smallCurPageOffset;				// byte offset in current page
-	page_s *		smallFirstUsedPage;				// first used page of the small heap manager
+	threadCache_s *	threadCaches[MAX_THREAD_CACHES];
+	int				numThreadCaches;
+	int				generation;						// distinguishes this heap from previous ones in thread local storage
 
-	page_s *		mediumFirstFreePage;			// first partially free page
-	page_s *		mediumLastFreePage;				// last partially free page
-	page_s *		mediumFirstUsedPage;			// completely used page
+	volatile int	pageLock;						// guards the page allocator, the large heap and the cache table
 
 	page_s *		largeFirstUsedPage;				// first page used by the large heap manager
 
@@ -119,8 +159,6 @@ private:
 	dword			pageRequests;					// page requests
 	dword			OSAllocs;						// number of allocs made to the OS
 
-	int				c_heapAllocRunningCount;
-
 	void			*defragBlock;					// a single huge block that can be allocated
 													// at startup, then freed when needed
 
@@ -128,16 +166,27 @@ private:
 	page_s *		AllocatePage( dword bytes );	// allocate page from the OS
 	void			FreePage( idHeap::page_s *p );	// free an OS allocated page
 
-	void *			SmallAllocate( dword bytes );	// allocate memory (1-255 bytes) from small heap manager
-	void			SmallFree( void *ptr );			// free memory allocated by small heap manager
+	threadCache_s *	GetThreadCache( void );			// get the calling thread's cache
+	threadCache_s *	CreateThreadCache( void );		// assign a cache to the calling thread
+	void			FreeThreadCache( threadCache_s *tc );
+	void			LockCache( threadCache_s *tc );
+	void			UnlockCache( threadCache_s *tc );
+	void			RemoteFree( threadCache_s *tc, void *ptr );	// return a block to another thread's cache
+	void			ReclaimRemoteFrees( threadCache_s *tc );	// free blocks returned by other threads
 
-	void *			MediumAllocateFromPage( idHeap::page_s *p, dword sizeNeeded );
-	void *			MediumAllocate( dword bytes );	// allocate memory (256-32768 bytes) from medium heap manager
-	void			MediumFree( void *ptr );		// free memory allocated by medium heap manager
+	void *			SmallAllocate( threadCache_s *tc, dword bytes );	// allocate memory (1-255 bytes) from small heap manager
+	void			SmallFree( threadCache_s *tc, void *ptr );			// free memory allocated by small heap manager
+
+	void *			MediumAllocateFromPage( threadCache_s *tc, idHeap::page_s *p, dword sizeNeeded );
+	void *			MediumAllocate( threadCache_s *tc, dword bytes );	// allocate memory (256-32768 bytes) from medium heap manager
+	void			MediumFree( threadCache_s *tc, void *ptr );			// free memory allocated by medium heap manager
 
 	void *			LargeAllocate( dword bytes );	// allocate large block from OS directly
 	void			LargeFree( void *ptr );			// free memory allocated by large heap manager
 
+	void			LockPages( void );
+	void			UnlockPages( void );
+
 	void			ReleaseSwappedPages( void );
 	void			FreePageReal( idHeap::page_s *p );
 };
@@ -153,23 +202,18 @@ void idHeap::Init () {
 	pageRequests		= 0;
 	pageSize			= 65536 - sizeof( idHeap::page_s );
 	pagesAllocated		= 0;								// reset page allocation counter
+	pageLock			= 0;
 
 	largeFirstUsedPage	= NULL;								// init large heap manager
 	swapPage			= NULL;
 
-	memset( smallFirstFree, 0, sizeof(smallFirstFree) );	// init small heap manager
-	smallFirstUsedPage	= NULL;
-	smallCurPage		= AllocatePage( pageSize );
-	assert( smallCurPage );
-	smallCurPageOffset	= SMALL_ALIGN( 0 );
-
 	defragBlock = NULL;
 
-	mediumFirstFreePage	= NULL;								// init medium heap manager
-	mediumLastFreePage	= NULL;
-	mediumFirstUsedPage	= NULL;
+	memset( threadCaches, 0, sizeof( threadCaches ) );		// init thread caches
+	numThreadCaches		= 0;
+	generation			= ++heap_generation;
 
-	c_heapAllocRunningCount = 0;
+	CreateThreadCache();									// the initializing thread gets the first cache
 }
 
 /*
@@ -192,14 +236,11 @@ idHeap::~idHeap( void ) {
 
 	idHeap::page_s	*p;
 
-	if ( smallCurPage ) {
-		FreePage( smallCurPage );			// free small-heap current allocation page
-	}
-	p = smallFirstUsedPage;					// free small-heap allocated pages 
-	while( p ) {
-		idHeap::page_s *next = p->next;
-		FreePage( p );
-		p= next;
+	for ( int i = 0; i < MAX_THREAD_CACHES; i++ ) {
+		if ( threadCaches[i] ) {
+			FreeThreadCache( threadCaches[i] );
+			threadCaches[i] = NULL;
+		}
 	}
 
 	p = largeFirstUsedPage;					// free large-heap allocated pages
@@ -209,21 +250,7 @@ idHeap::~idHeap( void ) {
 		p = next;
 	}
 
-	p = mediumFirstFreePage;				// free medium-heap allocated pages
-	while( p ) {
-		idHeap::page_s *next = p->next;
-		FreePage( p );
-		p = next;
-	}
-
-	p = mediumFirstUsedPage;				// free medium-heap allocated completely used pages
-	while( p ) {
-		idHeap::page_s *next = p->next;
-		FreePage( p );
-		p = next;
-	}
-
-	ReleaseSwappedPages();			
+	ReleaseSwappedPages();
 
 	if ( defragBlock ) {
 		free( defragBlock );
@@ -253,6 +280,224 @@ void idHeap::AllocDefragBlock( void ) {
 	idLib::common->Printf( "Allocated a %i mb defrag block\n", size / (1024*1024) );
 }
 
+/*
+================
+idHeap::LockPages
+================
+*/
+ID_INLINE void idHeap::LockPages( void ) {
+	while ( Sys_InterlockedCompareExchange( pageLock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+}
+
+/*
+================
+idHeap::UnlockPages
+================
+*/
+ID_INLINE void idHeap::UnlockPages( void ) {
+	Sys_InterlockedExchange( pageLock, 0 );
+}
+
+/*
+================
+idHeap::LockCache
+================
+*/
+ID_INLINE void idHeap::LockCache( threadCache_s *tc ) {
+	while ( Sys_InterlockedCompareExchange( tc->lock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+}
+
+/*
+================
+idHeap::UnlockCache
+================
+*/
+ID_INLINE void idHeap::UnlockCache( threadCache_s *tc ) {
+	Sys_InterlockedExchange( tc->lock, 0 );
+}
+
+/*
+================
+idHeap::LockSharedCache
+================
+*/
+void idHeap::LockSharedCache( void ) {
+	LockCache( threadCaches[MAX_THREAD_CACHES - 1] );
+}
+
+/*
+================
+idHeap::UnlockSharedCache
+================
+*/
+void idHeap::UnlockSharedCache( void ) {
+	UnlockCache( threadCaches[MAX_THREAD_CACHES - 1] );
+}
+
+/*
+================
+idHeap::GetThreadCache
+
+  the thread local index is only trusted when it was assigned by this heap
+================
+*/
+ID_INLINE idHeap::threadCache_s *idHeap::GetThreadCache( void ) {
+	if ( heap_threadCacheGeneration != generation ) {
+		return CreateThreadCache();
+	}
+	return threadCaches[heap_threadCacheIndex];
+}
+
+/*
+================
+idHeap::CreateThreadCache
+
+  Threads keep their cache until the heap is destroyed. Blocks owned by a
+  thread that exits stay allocated, which is fine for the long lived
+  threads the engine creates. Once all private caches are handed out the
+  remaining threads share the last cache under a lock.
+================
+*/
+idHeap::threadCache_s *idHeap::CreateThreadCache( void ) {
+	threadCache_s *tc;
+	int index;
+
+	LockPages();
+
+	if ( numThreadCaches < MAX_THREAD_CACHES - 1 ) {
+		index = numThreadCaches++;
+	} else {
+		index = MAX_THREAD_CACHES - 1;
+		numThreadCaches = MAX_THREAD_CACHES;
+	}
+
+	tc = threadCaches[index];
+	if ( !tc ) {
+		tc = (threadCache_s *) ::malloc( sizeof( threadCache_s ) );
+		if ( !tc ) {
+			UnlockPages();
+			common->FatalError( "malloc failure for heap thread cache" );
+		}
+		memset( tc, 0, sizeof( threadCache_s ) );
+		tc->index = index;
+		tc->shared = ( index == MAX_THREAD_CACHES - 1 );
+		// the first small allocation grabs a page
+		tc->smallCurPageOffset = pageSize;
+		threadCaches[index] = tc;
+	}
+
+	UnlockPages();
+
+	heap_threadCacheIndex = index;
+	heap_threadCacheGeneration = generation;
+
+	return tc;
+}
+
+/*
+================
+idHeap::FreeThreadCache
+================
+*/
+void idHeap::FreeThreadCache( threadCache_s *tc ) {
+	idHeap::page_s	*p;
+
+	if ( tc->smallCurPage ) {
+		FreePage( tc->smallCurPage );		// free small-heap current allocation page
+	}
+	p = tc->smallFirstUsedPage;				// free small-heap allocated pages
+	while( p ) {
+		idHeap::page_s *next = p->next;
+		FreePage( p );
+		p= next;
+	}
+
+	p = tc->mediumFirstFreePage;			// free medium-heap allocated pages
+	while( p ) {
+		idHeap::page_s *next = p->next;
+		FreePage( p );
+		p = next;
+	}
+
+	p = tc->mediumFirstUsedPage;			// free medium-heap allocated completely used pages
+	while( p ) {
+		idHeap::page_s *next = p->next;
+		FreePage( p );
+		p = next;
+	}
+
+	::free( tc );
+}
+
+/*
+================
+idHeap::GetThreadCachePages
+================
+*/
+int idHeap::GetThreadCachePages( int index ) const {
+	if ( index < 0 || index >= MAX_THREAD_CACHES || !threadCaches[index] ) {
+		return 0;
+	}
+	return threadCaches[index]->pagesAllocated;
+}
+
+/*
+================
+idHeap::GetThreadCacheRemoteFrees
+================
+*/
+int idHeap::GetThreadCacheRemoteFrees( int index ) const {
+	if ( index < 0 || index >= MAX_THREAD_CACHES || !threadCaches[index] ) {
+		return 0;
+	}
+	return threadCaches[index]->remoteFreeCount;
+}
+
+/*
+================
+idHeap::RemoteFree
+
+  pushes a block on the remote free list of the owning thread cache
+  the first bytes of the block are used as the link
+================
+*/
+void idHeap::RemoteFree( threadCache_s *tc, void *ptr ) {
+	void *head;
+
+	do {
+		head = tc->remoteFree;
+		*((void **)ptr) = head;
+	} while ( Sys_InterlockedCompareExchangePointer( tc->remoteFree, head, ptr ) != head );
+
+	Sys_InterlockedIncrement( tc->remoteFreeCount );
+}
+
+/*
+================
+idHeap::ReclaimRemoteFrees
+
+  only the owner takes the whole list at once so there is no ABA problem
+================
+*/
+void idHeap::ReclaimRemoteFrees( threadCache_s *tc ) {
+	void *ptr, *next;
+
+	ptr = Sys_InterlockedExchangePointer( tc->remoteFree, NULL );
+	while( ptr ) {
+		next = *((void **)ptr);
+		if ( ((byte *)(ptr))[-1] == SMALL_ALLOC ) {
+			SmallFree( tc, ptr );
+		} else {
+			MediumFree( tc, ptr );
+		}
+		ptr = next;
+	}
+}
+
 /*
 ================
 idHeap::Allocate
@@ -262,18 +507,32 @@ void *idHeap::Allocate( const dword bytes ) {
 	if ( !bytes ) {
 		return NULL;
 	}
-	c_heapAllocRunningCount++;
 
 #if USE_LIBC_MALLOC
 	return malloc( bytes );
 #else
+	void *p;
+
+	if ( bytes & ~32767 ) {
+		return LargeAllocate( bytes );
+	}
+
+	threadCache_s *tc = GetThreadCache();
+	if ( tc->shared ) {
+		LockCache( tc );
+	}
+	if ( tc->remoteFree ) {
+		ReclaimRemoteFrees( tc );
+	}
 	if ( !(bytes & ~255) ) {
-		return SmallAllocate( bytes );
+		p = SmallAllocate( tc, bytes );
+	} else {
+		p = MediumAllocate( tc, bytes );
 	}
-	if ( !(bytes & ~32767) ) {
-		return MediumAllocate( bytes );
+	if ( tc->shared ) {
+		UnlockCache( tc );
 	}
-	return LargeAllocate( bytes );
+	return p;
 #endif
 }
 
@@ -286,29 +545,47 @@ void idHeap::Free( void *p ) {
 	if ( !p ) {
 		return;
 	}
-	c_heapAllocRunningCount--;
 
 #if USE_LIBC_MALLOC
 	free( p );
 #else
+	threadCache_s *owner;
+
 	switch( ((byte *)(p))[-1] ) {
 		case SMALL_ALLOC: {
-			SmallFree( p );
+			owner = threadCaches[((byte *)(p))[-2]];
 			break;
 		}
 		case MEDIUM_ALLOC: {
-			MediumFree( p );
+			owner = threadCaches[((mediumHeapEntry_s *)(((byte *)(p)) - ALIGN_SIZE( MEDIUM_HEADER_SIZE )))->page->cache];
 			break;
 		}
 		case LARGE_ALLOC: {
 			LargeFree( p );
-			break;
+			return;
 		}
 		default: {
 			idLib::common->FatalError( "idHeap::Free: invalid memory block (%s)", idLib::sys->GetCallStackCurStr( 4 ) );
-			break;
+			return;
 		}
 	}
+
+	if ( owner->shared ) {
+		LockCache( owner );
+	} else if ( owner != GetThreadCache() ) {
+		RemoteFree( owner, p );
+		return;
+	}
+
+	if ( ((byte *)(p))[-1] == SMALL_ALLOC ) {
+		SmallFree( owner, p );
+	} else {
+		MediumFree( owner, p );
+	}
+
+	if ( owner->shared ) {
+		UnlockCache( owner );
+	}
 #endif
 }
 
@@ -326,7 +603,7 @@ void *idHeap::Allocate16( const dword bytes ) {
 			idLib::common->Printf( "Freeing defragBlock on alloc of %i.\n", bytes );
 			free( defragBlock );
 			defragBlock = NULL;
-			ptr = (byte *) malloc( bytes + 16 + 4 );			
+			ptr = (byte *) malloc( bytes + 16 + 4 );
 			AllocDefragBlock();
 		}
 		if ( !ptr ) {
@@ -401,23 +678,32 @@ idHeap::Dump
 void idHeap::Dump( void ) {
 	idHeap::page_s	*pg;
 
-	for ( pg = smallFirstUsedPage; pg; pg = pg->next ) {
-		idLib::common->Printf( "%p  bytes %-8d  (in use by small heap)\n", pg->data, pg->dataSize);
-	}
+	for ( int i = 0; i < MAX_THREAD_CACHES; i++ ) {
+		threadCache_s *tc = threadCaches[i];
+		if ( !tc ) {
+			continue;
+		}
 
-	if ( smallCurPage ) {
-		pg = smallCurPage;
-		idLib::common->Printf( "%p  bytes %-8d  (small heap active page)\n", pg->data, pg->dataSize );
-	}
+		idLib::common->Printf( "thread cache %d:\n", i );
 
-	for ( pg = mediumFirstUsedPage; pg; pg = pg->next ) {
-		idLib::common->Printf( "%p  bytes %-8d  (completely used by medium heap)\n", pg->data, pg->dataSize );
-	}
+		for ( pg = tc->smallFirstUsedPage; pg; pg = pg->next ) {
+			idLib::common->Printf( "%p  bytes %-8d  (in use by small heap)\n", pg->data, pg->dataSize);
+		}
+
+		if ( tc->smallCurPage ) {
+			pg = tc->smallCurPage;
+			idLib::common->Printf( "%p  bytes %-8d  (small heap active page)\n", pg->data, pg->dataSize );
+		}
+
+		for ( pg = tc->mediumFirstUsedPage; pg; pg = pg->next ) {
+			idLib::common->Printf( "%p  bytes %-8d  (completely used by medium heap)\n", pg->data, pg->dataSize );
+		}
 
-	for ( pg = mediumFirstFreePage; pg; pg = pg->next ) {
-		idLib::common->Printf( "%p  bytes %-8d  (partially used by medium heap)\n", pg->data, pg->dataSize );
+		for ( pg = tc->mediumFirstFreePage; pg; pg = pg->next ) {
+			idLib::common->Printf( "%p  bytes %-8d  (partially used by medium heap)\n", pg->data, pg->dataSize );
+		}
 	}
-	
+
 	for ( pg = largeFirstUsedPage; pg; pg = pg->next ) {
 		idLib::common->Printf( "%p  bytes %-8d  (fully used by large heap)\n", pg->data, pg->dataSize );
 	}
@@ -464,6 +750,8 @@ idHeap::AllocatePage
 idHeap::page_s* idHeap::AllocatePage( dword bytes ) {
 	idHeap::page_s*	p;
 
+	LockPages();
+
 	pageRequests++;
 
 	if ( swapPage && swapPage->dataSize == bytes ) {			// if we've got a swap page somewhere
@@ -481,10 +769,11 @@ idHeap::page_s* idHeap::AllocatePage( dword bytes ) {
 				idLib::common->Printf( "Freeing defragBlock on alloc of %i.\n", size + ALIGN - 1 );
 				free( defragBlock );
 				defragBlock = NULL;
-				p = (idHeap::page_s *) ::malloc( size + ALIGN - 1 );			
+				p = (idHeap::page_s *) ::malloc( size + ALIGN - 1 );
 				AllocDefragBlock();
 			}
 			if ( !p ) {
+				UnlockPages();
 				common->FatalError( "malloc failure for %i", bytes );
 			}
 		}
@@ -498,9 +787,12 @@ idHeap::page_s* idHeap::AllocatePage( dword bytes ) {
 
 	p->prev = NULL;
 	p->next = NULL;
+	p->cache = -1;
 
 	pagesAllocated++;
-	
+
+	UnlockPages();
+
 	return p;
 }
 
@@ -515,6 +807,8 @@ idHeap::FreePage
 void idHeap::FreePage( idHeap::page_s *p ) {
 	assert( p );
 
+	LockPages();
+
 	if ( p->dataSize == pageSize && !swapPage ) {			// add to swap list?
 		swapPage = p;
 	}
@@ -523,6 +817,8 @@ void idHeap::FreePage( idHeap::page_s *p ) {
 	}
 
 	pagesAllocated--;
+
+	UnlockPages();
 }
 
 //===============================================================
@@ -536,46 +832,51 @@ void idHeap::FreePage( idHeap::page_s *p ) {
 idHeap::SmallAllocate
 
   allocate memory (1-255 bytes) from the small heap manager
+  tc = thread cache of the calling thread
   bytes = number of bytes to allocate
   returns pointer to allocated memory
 ================
 */
-void *idHeap::SmallAllocate( dword bytes ) {
-	// we need the at least sizeof( dword ) bytes for the free list
-	if ( bytes < sizeof( dword ) ) {
-		bytes = sizeof( dword );
+void *idHeap::SmallAllocate( threadCache_s *tc, dword bytes ) {
+	// we need the at least sizeof( void * ) bytes for the free list
+	if ( bytes < sizeof( void * ) ) {
+		bytes = sizeof( void * );
 	}
 
 	// increase the number of bytes if necessary to make sure the next small allocation is aligned
 	bytes = SMALL_ALIGN( bytes );
 
-	byte *smallBlock = (byte *)(smallFirstFree[bytes / ALIGN]);
+	byte *smallBlock = (byte *)(tc->smallFirstFree[bytes / ALIGN]);
 	if ( smallBlock ) {
-		dword *link = (dword *)(smallBlock + SMALL_HEADER_SIZE);
-		smallBlock[1] = SMALL_ALLOC;					// allocation identifier
-		smallFirstFree[bytes / ALIGN] = (void *)(*link);
+		void **link = (void **)(smallBlock + SMALL_HEADER_SIZE);
+		smallBlock[2] = SMALL_ALLOC;					// allocation identifier
+		tc->smallFirstFree[bytes / ALIGN] = *link;
 		return (void *)(link);
 	}
 
-	dword bytesLeft = (long)(pageSize) - smallCurPageOffset;
+	dword bytesLeft = (long)(pageSize) - tc->smallCurPageOffset;
 	// if we need to allocate a new page
 	if ( bytes >= bytesLeft ) {
 
-		smallCurPage->next	= smallFirstUsedPage;
-		smallFirstUsedPage	= smallCurPage;
-		smallCurPage		= AllocatePage( pageSize );
-		if ( !smallCurPage ) {
+		if ( tc->smallCurPage ) {
+			tc->smallCurPage->next	= tc->smallFirstUsedPage;
+			tc->smallFirstUsedPage	= tc->smallCurPage;
+		}
+		tc->smallCurPage		= AllocatePage( pageSize );
+		if ( !tc->smallCurPage ) {
 			return NULL;
 		}
+		tc->pagesAllocated++;
 		// make sure the first allocation is aligned
-		smallCurPageOffset	= SMALL_ALIGN( 0 );
+		tc->smallCurPageOffset	= SMALL_ALIGN( 0 );
 	}
 
-	smallBlock			= ((byte *)smallCurPage->data) + smallCurPageOffset;
+	smallBlock			= ((byte *)tc->smallCurPage->data) + tc->smallCurPageOffset;
 	smallBlock[0]		= (byte)(bytes / ALIGN);		// write # of bytes/ALIGN
-	smallBlock[1]		= SMALL_ALLOC;					// allocation identifier
-	smallCurPageOffset  += bytes + SMALL_HEADER_SIZE;	// increase the offset on the current page
-	return ( smallBlock + SMALL_HEADER_SIZE );			// skip the first two bytes
+	smallBlock[1]		= (byte)tc->index;				// owning thread cache
+	smallBlock[2]		= SMALL_ALLOC;					// allocation identifier
+	tc->smallCurPageOffset += bytes + SMALL_HEADER_SIZE;	// increase the offset on the current page
+	return ( smallBlock + SMALL_HEADER_SIZE );			// skip the header bytes
 }
 
 /*
@@ -583,14 +884,15 @@ void *idHeap::SmallAllocate( dword bytes ) {
 idHeap::SmallFree
 
   frees a block of memory allocated by SmallAllocate() call
+  tc = thread cache owning the block
   data = pointer to block of memory
 ================
 */
-void idHeap::SmallFree( void *ptr ) {
+void idHeap::SmallFree( threadCache_s *tc, void *ptr ) {
 	((byte *)(ptr))[-1] = INVALID_ALLOC;
 
 	byte *d = ( (byte *)ptr ) - SMALL_HEADER_SIZE;
-	dword *dt = (dword *)ptr;
+	void **dt = (void **)ptr;
 	// index into the table with free small memory blocks
 	dword ix = *d;
 
@@ -599,8 +901,8 @@ void idHeap::SmallFree( void *ptr ) {
 		idLib::common->FatalError( "SmallFree: invalid memory block" );
 	}
 
-	*dt = (dword)smallFirstFree[ix];	// write next index
-	smallFirstFree[ix] = (void *)d;		// link
+	*dt = tc->smallFirstFree[ix];		// write next index
+	tc->smallFirstFree[ix] = (void *)d;	// link
 }
 
 //===============================================================
@@ -622,7 +924,7 @@ idHeap::MediumAllocateFromPage
   returns pointer to allocated memory
 ================
 */
-void *idHeap::MediumAllocateFromPage( idHeap::page_s *p, dword sizeNeeded ) {
+void *idHeap::MediumAllocateFromPage( threadCache_s *tc, idHeap::page_s *p, dword sizeNeeded ) {
 
 	mediumHeapEntry_s	*best,*nw = NULL;
 	byte				*ret;
@@ -632,6 +934,7 @@ void *idHeap::MediumAllocateFromPage( idHeap::page_s *p, dword sizeNeeded ) {
 	assert( best );
 	assert( best->size == p->largestFree );
 	assert( best->size >= sizeNeeded );
+	assert( p->cache == tc->index );
 
 	// if we can allocate another block from this page after allocating sizeNeeded bytes
 	if ( best->size >= (dword)( sizeNeeded + MEDIUM_SMALLEST_SIZE ) ) {
@@ -648,7 +951,7 @@ void *idHeap::MediumAllocateFromPage( idHeap::page_s *p, dword sizeNeeded ) {
 		}
 		best->next	= nw;
 		best->size	-= sizeNeeded;
-		
+
 		p->largestFree = best->size;
 	}
 	else {
@@ -681,18 +984,19 @@ void *idHeap::MediumAllocateFromPage( idHeap::page_s *p, dword sizeNeeded ) {
 idHeap::MediumAllocate
 
   allocate memory (256-32768 bytes) from medium heap manager
+  tc	= thread cache of the calling thread
   bytes	= number of bytes to allocate
   returns pointer to allocated memory
 ================
 */
-void *idHeap::MediumAllocate( dword bytes ) {
+void *idHeap::MediumAllocate( threadCache_s *tc, dword bytes ) {
 	idHeap::page_s		*p;
 	void				*data;
 
 	dword sizeNeeded = ALIGN_SIZE( bytes ) + ALIGN_SIZE( MEDIUM_HEADER_SIZE );
 
 	// find first page with enough space
-	for ( p = mediumFirstFreePage; p; p = p->next ) {
+	for ( p = tc->mediumFirstFreePage; p; p = p->next ) {
 		if ( p->largestFree >= sizeNeeded ) {
 			break;
 		}
@@ -703,17 +1007,19 @@ void *idHeap::MediumAllocate( dword bytes ) {
 		if ( !p ) {
 			return NULL;					// malloc failure!
 		}
+		tc->pagesAllocated++;
+		p->cache	= tc->index;
 		p->prev		= NULL;
-		p->next		= mediumFirstFreePage;
+		p->next		= tc->mediumFirstFreePage;
 		if (p->next) {
 			p->next->prev = p;
 		}
 		else {
-			mediumLastFreePage	= p;
+			tc->mediumLastFreePage	= p;
 		}
 
-		mediumFirstFreePage		= p;
-		
+		tc->mediumFirstFreePage		= p;
+
 		p->largestFree	= pageSize;
 		p->firstFree	= (void *)p->data;
 
@@ -729,7 +1035,7 @@ void *idHeap::MediumAllocate( dword bytes ) {
 		e->freeBlock	= 1;
 	}
 
-	data = MediumAllocateFromPage( p, sizeNeeded );		// allocate data from page
+	data = MediumAllocateFromPage( tc, p, sizeNeeded );		// allocate data from page
 
     // if the page can no longer serve memory, move it away from free list
 	// (so that it won't slow down the later alloc queries)
@@ -737,12 +1043,12 @@ void *idHeap::MediumAllocate( dword bytes ) {
 	// a call to free may swap this page back to the free list
 
 	if ( p->largestFree < MEDIUM_SMALLEST_SIZE ) {
-		if ( p == mediumLastFreePage ) {
-			mediumLastFreePage = p->prev;
+		if ( p == tc->mediumLastFreePage ) {
+			tc->mediumLastFreePage = p->prev;
 		}
 
-		if ( p == mediumFirstFreePage ) {
-			mediumFirstFreePage = p->next;
+		if ( p == tc->mediumFirstFreePage ) {
+			tc->mediumFirstFreePage = p->next;
 		}
 
 		if ( p->prev ) {
@@ -754,28 +1060,28 @@ void *idHeap::MediumAllocate( dword bytes ) {
 
 		// link to "completely used" list
 		p->prev = NULL;
-		p->next = mediumFirstUsedPage;
+		p->next = tc->mediumFirstUsedPage;
 		if ( p->next ) {
 			p->next->prev = p;
 		}
-		mediumFirstUsedPage = p;
+		tc->mediumFirstUsedPage = p;
 		return data;
-	} 
+	}
 
 	// re-order linked list (so that next malloc query starts from current
 	// matching block) -- this speeds up both the page walks and block walks
 
-	if ( p != mediumFirstFreePage ) {
-		assert( mediumLastFreePage );
-		assert( mediumFirstFreePage );
+	if ( p != tc->mediumFirstFreePage ) {
+		assert( tc->mediumLastFreePage );
+		assert( tc->mediumFirstFreePage );
 		assert( p->prev);
 
-		mediumLastFreePage->next	= mediumFirstFreePage;
-		mediumFirstFreePage->prev	= mediumLastFreePage;
-		mediumLastFreePage			= p->prev;
-		p->prev->next				= NULL;
-		p->prev						= NULL;
-		mediumFirstFreePage			= p;
+		tc->mediumLastFreePage->next	= tc->mediumFirstFreePage;
+		tc->mediumFirstFreePage->prev	= tc->mediumLastFreePage;
+		tc->mediumLastFreePage			= p->prev;
+		p->prev->next					= NULL;
+		p->prev							= NULL;
+		tc->mediumFirstFreePage			= p;
 	}
 
 	return data;
@@ -786,10 +1092,11 @@ void *idHeap::MediumAllocate( dword bytes ) {
 idHeap::MediumFree
 
   frees a block allocated by the medium heap manager
+  tc	= thread cache owning the block
   ptr	= pointer to data block
 ================
 */
-void idHeap::MediumFree( void *ptr ) {
+void idHeap::MediumFree( threadCache_s *tc, void *ptr ) {
 	((byte *)(ptr))[-1] = INVALID_ALLOC;
 
 	mediumHeapEntry_s	*e = (mediumHeapEntry_s *)((byte *)ptr - ALIGN_SIZE( MEDIUM_HEADER_SIZE ));
@@ -800,6 +1107,7 @@ void idHeap::MediumFree( void *ptr ) {
 
 	assert( e->size );
 	assert( e->freeBlock == 0 );
+	assert( p->cache == tc->index );
 
 	mediumHeapEntry_s *prev = e->prev;
 
@@ -824,18 +1132,18 @@ void idHeap::MediumFree( void *ptr ) {
 		p->largestFree	= e->size;
 		e->freeBlock	= 1;				// mark block as free
 	}
-			
+
 	mediumHeapEntry_s *next = e->next;
 
 	// if the next block is free we can merge
 	if ( next && next->freeBlock ) {
 		e->size += next->size;
 		e->next = next->next;
-		
+
 		if ( next->next ) {
 			next->next->prev = e;
 		}
-		
+
 		if ( next->prevFree ) {
 			next->prevFree->nextFree = next->nextFree;
 		}
@@ -868,7 +1176,7 @@ void idHeap::MediumFree( void *ptr ) {
 		if ( e->nextFree ) {
 			e->nextFree->prevFree = e->prevFree;
 		}
-		
+
 		e->nextFree = (mediumHeapEntry_s *)p->firstFree;
 		e->prevFree = NULL;
 		if ( e->nextFree ) {
@@ -887,21 +1195,21 @@ void idHeap::MediumFree( void *ptr ) {
 		if ( p->next ) {
 			p->next->prev = p->prev;
 		}
-		if ( p == mediumFirstUsedPage ) {
-			mediumFirstUsedPage = p->next;
+		if ( p == tc->mediumFirstUsedPage ) {
+			tc->mediumFirstUsedPage = p->next;
 		}
 
 		p->next = NULL;
-		p->prev = mediumLastFreePage;
+		p->prev = tc->mediumLastFreePage;
 
-		if ( mediumLastFreePage ) {
-			mediumLastFreePage->next = p;
+		if ( tc->mediumLastFreePage ) {
+			tc->mediumLastFreePage->next = p;
 		}
-		mediumLastFreePage = p;
-		if ( !mediumFirstFreePage ) {
-			mediumFirstFreePage = p;
+		tc->mediumLastFreePage = p;
+		if ( !tc->mediumFirstFreePage ) {
+			tc->mediumFirstFreePage = p;
 		}
-	} 
+	}
 }
 
 //===============================================================
@@ -933,6 +1241,8 @@ void *idHeap::LargeAllocate( dword bytes ) {
 	dw[0]		= (dword)p;				// write pointer back to page table
 	d[-1]		= LARGE_ALLOC;			// allocation identifier
 
+	LockPages();
+
 	// link to 'large used page list'
 	p->prev = NULL;
 	p->next = largeFirstUsedPage;
@@ -941,6 +1251,8 @@ void *idHeap::LargeAllocate( dword bytes ) {
 	}
 	largeFirstUsedPage = p;
 
+	UnlockPages();
+
 	return (void *)(d);
 }
 
@@ -960,6 +1272,8 @@ void idHeap::LargeFree( void *ptr) {
 	// get page pointer
 	pg = (idHeap::page_s *)(*((dword *)(((byte *)ptr) - ALIGN_SIZE( LARGE_HEADER_SIZE ))));
 
+	LockPages();
+
 	// unlink from doubly linked list
 	if ( pg->prev ) {
 		pg->prev->next = pg->next;
@@ -972,6 +1286,8 @@ void idHeap::LargeFree( void *ptr) {
 	}
 	pg->next = pg->prev = NULL;
 
+	UnlockPages();
+
 	FreePage(pg);
 }
 
@@ -984,9 +1300,58 @@ void idHeap::LargeFree( void *ptr) {
 #undef new
 
 static idHeap *			mem_heap = NULL;
-static memoryStats_t	mem_total_allocs = { 0, 0x0fffffff, -1, 0 };
-static memoryStats_t	mem_frame_allocs;
-static memoryStats_t	mem_frame_frees;
+
+// statistics are kept per heap thread cache so updating them never
+// needs a lock, the totals are summed when they are queried. A block
+// can be freed by another thread than the one that allocated it, so
+// only the sum over all threads of the allocs minus the frees is the
+// memory in use.
+static memoryStats_t	mem_total_allocs[idHeap::MAX_THREAD_CACHES];
+static memoryStats_t	mem_total_frees[idHeap::MAX_THREAD_CACHES];
+static memoryStats_t	mem_frame_allocs[idHeap::MAX_THREAD_CACHES];
+static memoryStats_t	mem_frame_frees[idHeap::MAX_THREAD_CACHES];
+
+/*
+==================
+Mem_ResetStats
+==================
+*/
+static void Mem_ResetStats( memoryStats_t &stats ) {
+	stats.num = 0;
+	stats.minSize = 0x0fffffff;
+	stats.maxSize = -1;
+	stats.totalSize = 0;
+}
+
+/*
+==================
+Mem_AccumulateStats
+==================
+*/
+static void Mem_AccumulateStats( memoryStats_t &total, const memoryStats_t &stats ) {
+	total.num += stats.num;
+	if ( stats.minSize < total.minSize ) {
+		total.minSize = stats.minSize;
+	}
+	if ( stats.maxSize > total.maxSize ) {
+		total.maxSize = stats.maxSize;
+	}
+	total.totalSize += stats.totalSize;
+}
+
+/*
+==================
+Mem_InitStats
+==================
+*/
+static void Mem_InitStats( void ) {
+	for ( int i = 0; i < idHeap::MAX_THREAD_CACHES; i++ ) {
+		Mem_ResetStats( mem_total_allocs[i] );
+		Mem_ResetStats( mem_total_frees[i] );
+		Mem_ResetStats( mem_frame_allocs[i] );
+		Mem_ResetStats( mem_frame_frees[i] );
+	}
+}
 
 /*
 ==================
@@ -994,10 +1359,10 @@ Mem_ClearFrameStats
 ==================
 */
 void Mem_ClearFrameStats( void ) {
-	mem_frame_allocs.num = mem_frame_frees.num = 0;
-	mem_frame_allocs.minSize = mem_frame_frees.minSize = 0x0fffffff;
-	mem_frame_allocs.maxSize = mem_frame_frees.maxSize = -1;
-	mem_frame_allocs.totalSize = mem_frame_frees.totalSize = 0;
+	for ( int i = 0; i < idHeap::MAX_THREAD_CACHES; i++ ) {
+		Mem_ResetStats( mem_frame_allocs[i] );
+		Mem_ResetStats( mem_frame_frees[i] );
+	}
 }
 
 /*
@@ -1006,8 +1371,12 @@ Mem_GetFrameStats
 ==================
 */
 void Mem_GetFrameStats( memoryStats_t &allocs, memoryStats_t &frees ) {
-	allocs = mem_frame_allocs;
-	frees = mem_frame_frees;
+	Mem_ResetStats( allocs );
+	Mem_ResetStats( frees );
+	for ( int i = 0; i < idHeap::MAX_THREAD_CACHES; i++ ) {
+		Mem_AccumulateStats( allocs, mem_frame_allocs[i] );
+		Mem_AccumulateStats( frees, mem_frame_frees[i] );
+	}
 }
 
 /*
@@ -1016,7 +1385,73 @@ Mem_GetStats
 ==================
 */
 void Mem_GetStats( memoryStats_t &stats ) {
-	stats = mem_total_allocs;
+	Mem_ResetStats( stats );
+	for ( int i = 0; i < idHeap::MAX_THREAD_CACHES; i++ ) {
+		Mem_AccumulateStats( stats, mem_total_allocs[i] );
+		stats.num -= mem_total_frees[i].num;
+		stats.totalSize -= mem_total_frees[i].totalSize;
+	}
+}
+
+/*
+==================
+Mem_GetNumThreads
+==================
+*/
+int Mem_GetNumThreads( void ) {
+	if ( !mem_heap ) {
+		return 0;
+	}
+	return mem_heap->GetNumThreadCaches();
+}
+
+/*
+==================
+Mem_GetThreadFrameStats
+==================
+*/
+void Mem_GetThreadFrameStats( int threadNum, memoryStats_t &allocs, memoryStats_t &frees ) {
+	assert( threadNum >= 0 && threadNum < idHeap::MAX_THREAD_CACHES );
+	allocs = mem_frame_allocs[threadNum];
+	frees = mem_frame_frees[threadNum];
+}
+
+/*
+==================
+Mem_GetThreadStats
+==================
+*/
+void Mem_GetThreadStats( int threadNum, memoryStats_t &allocs, memoryStats_t &frees ) {
+	assert( threadNum >= 0 && threadNum < idHeap::MAX_THREAD_CACHES );
+	allocs = mem_total_allocs[threadNum];
+	frees = mem_total_frees[threadNum];
+}
+
+/*
+==================
+Mem_ThreadStats_f
+==================
+*/
+void Mem_ThreadStats_f( const idCmdArgs &args ) {
+	memoryStats_t allocs, frees, totalAllocs, totalFrees, inUse;
+
+	if ( !mem_heap ) {
+		return;
+	}
+
+	idLib::common->Printf( "thread  pages  remote    allocs       kB     frees       kB   frame allocs      kB   frame frees      kB\n" );
+	for ( int i = 0; i < mem_heap->GetNumThreadCaches(); i++ ) {
+		Mem_GetThreadStats( i, totalAllocs, totalFrees );
+		Mem_GetThreadFrameStats( i, allocs, frees );
+		idLib::common->Printf( "%4d%s %6d %7d %9d %8d %9d %8d %14d %7d %13d %7d\n", i, ( i == idHeap::MAX_THREAD_CACHES - 1 ) ? "*" : " ",
+			mem_heap->GetThreadCachePages( i ), mem_heap->GetThreadCacheRemoteFrees( i ),
+			totalAllocs.num, totalAllocs.totalSize >> 10, totalFrees.num, totalFrees.totalSize >> 10,
+			allocs.num, allocs.totalSize >> 10, frees.num, frees.totalSize >> 10 );
+	}
+	Mem_GetStats( inUse );
+	idLib::common->Printf( "%d blocks in use, %d kB\n", inUse.num, inUse.totalSize >> 10 );
+	idLib::common->Printf( "thread 0 is the main thread, a * marks the cache shared by overflow threads\n" );
+	idLib::common->Printf( "frees are counted on the freeing thread, only the sum over all threads is in use\n" );
 }
 
 /*
@@ -1038,11 +1473,22 @@ void Mem_UpdateStats( memoryStats_t &stats, int size ) {
 /*
 ==================
 Mem_UpdateAllocStats
+
+  the stats of the overflow cache are updated by several threads
 ==================
 */
 void Mem_UpdateAllocStats( int size ) {
-	Mem_UpdateStats( mem_frame_allocs, size );
-	Mem_UpdateStats( mem_total_allocs, size );
+	int thread = mem_heap->GetThreadCacheIndex();
+	bool shared = ( thread == idHeap::MAX_THREAD_CACHES - 1 );
+
+	if ( shared ) {
+		mem_heap->LockSharedCache();
+	}
+	Mem_UpdateStats( mem_frame_allocs[thread], size );
+	Mem_UpdateStats( mem_total_allocs[thread], size );
+	if ( shared ) {
+		mem_heap->UnlockSharedCache();
+	}
 }
 
 /*
@@ -1051,11 +1497,18 @@ Mem_UpdateFreeStats
 ==================
 */
 void Mem_UpdateFreeStats( int size ) {
-	Mem_UpdateStats( mem_frame_frees, size );
-	mem_total_allocs.num--;
-	mem_total_allocs.totalSize -= size;
-}
+	int thread = mem_heap->GetThreadCacheIndex();
+	bool shared = ( thread == idHeap::MAX_THREAD_CACHES - 1 );
 
+	if ( shared ) {
+		mem_heap->LockSharedCache();
+	}
+	Mem_UpdateStats( mem_frame_frees[thread], size );
+	Mem_UpdateStats( mem_total_frees[thread], size );
+	if ( shared ) {
+		mem_heap->UnlockSharedCache();
+	}
+}
 
 #ifndef ID_DEBUG_MEMORY
 
@@ -1197,7 +1650,7 @@ Mem_Init
 */
 void Mem_Init( void ) {
 	mem_heap = new idHeap;
-	Mem_ClearFrameStats();
+	Mem_InitStats();
 }
 
 /*
@@ -1738,6 +2191,7 @@ Mem_Init
 */
 void Mem_Init( void ) {
 	mem_heap = new idHeap;
+	Mem_InitStats();
 }
 
 /*
@@ -56,6 +56,10 @@ void		Mem_EnableLeakTest( const char *name );
 void		Mem_ClearFrameStats( void );
 void		Mem_GetFrameStats( memoryStats_t &allocs, memoryStats_t &frees );
 void		Mem_GetStats( memoryStats_t &stats );
+int			Mem_GetNumThreads( void );
+void		Mem_GetThreadFrameStats( int threadNum, memoryStats_t &allocs, memoryStats_t &frees );
+void		Mem_GetThreadStats( int threadNum, memoryStats_t &allocs, memoryStats_t &frees );
+void		Mem_ThreadStats_f( const class idCmdArgs &args );
 void		Mem_Dump_f( const class idCmdArgs &args );
 void		Mem_DumpCompressed_f( const class idCmdArgs &args );
 void		Mem_AllocDefragBlock( void );
@@ -242,4 +242,8 @@ template<class T> ID_INLINE T	Min( T x, T y ) { return ( x < y ) ? x : y; }
 #include "MapFile.h"
 #include "Timer.h"
 
+// threading
+#include "sys/JobManager.h"
+#include "sys/Profiler.h"
+
 #endif	/* !__LIB_H__ */
@@ -45,6 +45,56 @@ public:
 };
 
 
+/*
+===============================================================================
+
+  Joint Quaternions in structure of arrays layout
+
+  float qx[stride], qy[stride], qz[stride], qw[stride];
+  float tx[stride], ty[stride], tz[stride];
+
+  The stride is the number of joints rounded up to a multiple of eight so
+  the SIMD code can always work on full registers. The padding is zeroed.
+
+===============================================================================
+*/
+
+#define JOINTQUAT_SOA_COMPONENTS	7
+
+ID_INLINE int JointQuatSoAStride( const int numJoints ) {
+	return ( numJoints + 7 ) & ~7;
+}
+
+ID_INLINE void JointQuatsToSoA( float *soa, const idJointQuat *jointQuats, const int numJoints ) {
+	int stride = JointQuatSoAStride( numJoints );
+
+	memset( soa, 0, JOINTQUAT_SOA_COMPONENTS * stride * sizeof( soa[0] ) );
+	for ( int i = 0; i < numJoints; i++ ) {
+		soa[0 * stride + i] = jointQuats[i].q.x;
+		soa[1 * stride + i] = jointQuats[i].q.y;
+		soa[2 * stride + i] = jointQuats[i].q.z;
+		soa[3 * stride + i] = jointQuats[i].q.w;
+		soa[4 * stride + i] = jointQuats[i].t.x;
+		soa[5 * stride + i] = jointQuats[i].t.y;
+		soa[6 * stride + i] = jointQuats[i].t.z;
+	}
+}
+
+ID_INLINE void JointQuatsFromSoA( idJointQuat *jointQuats, const float *soa, const int numJoints ) {
+	int stride = JointQuatSoAStride( numJoints );
+
+	for ( int i = 0; i < numJoints; i++ ) {
+		jointQuats[i].q.x = soa[0 * stride + i];
+		jointQuats[i].q.y = soa[1 * stride + i];
+		jointQuats[i].q.z = soa[2 * stride + i];
+		jointQuats[i].q.w = soa[3 * stride + i];
+		jointQuats[i].t.x = soa[4 * stride + i];
+		jointQuats[i].t.y = soa[5 * stride + i];
+		jointQuats[i].t.z = soa[6 * stride + i];
+	}
+}
+
+
 /*
 ===============================================================================
 
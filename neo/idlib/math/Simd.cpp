@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "Simd_SSE.h"
 #include "Simd_SSE2.h"
 #include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
 #include "Simd_AltiVec.h"
 
 
@@ -75,6 +76,10 @@ void idSIMD::InitProcessor( const char *module, bool forceGeneric ) {
 		if ( !processor ) {
 			if ( ( cpuid & CPUID_ALTIVEC ) ) {
 				processor = new idSIMD_AltiVec;
+#ifdef ID_SIMD_AVX2
+			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) && ( cpuid & CPUID_AVX2 ) && ( cpuid & CPUID_FMA3 ) ) {
+				processor = new idSIMD_AVX2;
+#endif
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) ) {
 				processor = new idSIMD_SSE3;
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) ) {
@@ -289,6 +294,22 @@ TIME_TYPE time_in_millisec( void ) {
 #define StopRecordTime( end )				\
 	end = mach_absolute_time();
 #endif
+#elif defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+
+#include <x86intrin.h>
+
+#define TIME_TYPE int
+
+#define StartRecordTime( start )			\
+	_mm_lfence();							\
+	start = (int) __rdtsc();				\
+	_mm_lfence();
+
+#define StopRecordTime( end )				\
+	_mm_lfence();							\
+	end = (int) __rdtsc();					\
+	_mm_lfence();
+
 #else
 
 #define TIME_TYPE int
@@ -2354,6 +2375,86 @@ void TestBlendJoints( void ) {
 	PrintClocks( va( "   simd->BlendJoints() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestBlendJointsSoA
+============
+*/
+void TestBlendJointsSoA( void ) {
+	int i, j, k;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( float baseJoints[JOINTQUAT_SOA_COMPONENTS*COUNT] );
+	ALIGN16( float joints1[JOINTQUAT_SOA_COMPONENTS*COUNT] );
+	ALIGN16( float joints2[JOINTQUAT_SOA_COMPONENTS*COUNT] );
+	ALIGN16( float layerJoints[2][JOINTQUAT_SOA_COMPONENTS*COUNT] );
+	ALIGN16( float layerLerps[2][COUNT] );
+	const float *blendJoints[2] = { layerJoints[0], layerJoints[1] };
+	const float *lerps[2] = { layerLerps[0], layerLerps[1] };
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			float *soa = ( j == 0 ) ? baseJoints : layerJoints[j-1];
+			idAngles angles;
+			angles[0] = srnd.CRandomFloat() * 180.0f;
+			angles[1] = srnd.CRandomFloat() * 180.0f;
+			angles[2] = srnd.CRandomFloat() * 180.0f;
+			idQuat q = angles.ToQuat();
+			soa[0*COUNT+i] = q.x;
+			soa[1*COUNT+i] = q.y;
+			soa[2*COUNT+i] = q.z;
+			soa[3*COUNT+i] = q.w;
+			soa[4*COUNT+i] = srnd.CRandomFloat() * 10.0f;
+			soa[5*COUNT+i] = srnd.CRandomFloat() * 10.0f;
+			soa[6*COUNT+i] = srnd.CRandomFloat() * 10.0f;
+		}
+		layerLerps[0][i] = ( i & 1 ) ? 1.0f : 0.0f;
+		layerLerps[1][i] = srnd.RandomFloat() * 1.5f - 0.25f;
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		memcpy( joints1, baseJoints, sizeof( joints1 ) );
+		StartRecordTime( start );
+		p_generic->BlendJointsSoA( joints1, blendJoints, lerps, 2, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->BlendJointsSoA()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		memcpy( joints2, baseJoints, sizeof( joints2 ) );
+		StartRecordTime( start );
+		p_simd->BlendJointsSoA( joints2, blendJoints, lerps, 2, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( k = 4; k < JOINTQUAT_SOA_COMPONENTS; k++ ) {
+			if ( idMath::Fabs( joints1[k*COUNT+i] - joints2[k*COUNT+i] ) > 1e-3f ) {
+				break;
+			}
+		}
+		if ( k < JOINTQUAT_SOA_COMPONENTS ) {
+			break;
+		}
+		for ( k = 0; k < 4; k++ ) {
+			if ( idMath::Fabs( joints1[k*COUNT+i] - joints2[k*COUNT+i] ) > 1e-2f ) {
+				break;
+			}
+		}
+		if ( k < 4 ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->BlendJointsSoA() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestConvertJointQuatsToJointMats
@@ -2527,6 +2628,76 @@ void TestTransformJoints( void ) {
 	PrintClocks( va( "   simd->TransformJoints() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestTransformJointsSoA
+============
+*/
+#define SOA_SKELETONS	11
+#define SOA_JOINTS		( COUNT / 8 )
+
+void TestTransformJointsSoA( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( float jointQuats[SOA_SKELETONS*JOINTQUAT_SOA_COMPONENTS*SOA_JOINTS] );
+	ALIGN16( idJointMat joints1[SOA_SKELETONS][SOA_JOINTS] );
+	ALIGN16( idJointMat joints2[SOA_SKELETONS][SOA_JOINTS] );
+	ALIGN16( int parents[SOA_JOINTS] );
+	idJointMat *jointMats1[SOA_SKELETONS];
+	idJointMat *jointMats2[SOA_SKELETONS];
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < SOA_SKELETONS; i++ ) {
+		float *soa = jointQuats + i * JOINTQUAT_SOA_COMPONENTS * SOA_JOINTS;
+		for ( j = 0; j < SOA_JOINTS; j++ ) {
+			idAngles angles;
+			angles[0] = srnd.CRandomFloat() * 180.0f;
+			angles[1] = srnd.CRandomFloat() * 180.0f;
+			angles[2] = srnd.CRandomFloat() * 180.0f;
+			idQuat q = angles.ToQuat();
+			soa[0*SOA_JOINTS+j] = q.x;
+			soa[1*SOA_JOINTS+j] = q.y;
+			soa[2*SOA_JOINTS+j] = q.z;
+			soa[3*SOA_JOINTS+j] = q.w;
+			soa[4*SOA_JOINTS+j] = srnd.CRandomFloat() * 2.0f;
+			soa[5*SOA_JOINTS+j] = srnd.CRandomFloat() * 2.0f;
+			soa[6*SOA_JOINTS+j] = srnd.CRandomFloat() * 2.0f;
+		}
+		jointMats1[i] = joints1[i];
+		jointMats2[i] = joints2[i];
+	}
+	for ( j = 0; j < SOA_JOINTS; j++ ) {
+		parents[j] = ( j - 1 ) / 2;
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->TransformJointsSoA( jointMats1, jointQuats, SOA_SKELETONS, parents, SOA_JOINTS );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->TransformJointsSoA()", SOA_SKELETONS * SOA_JOINTS, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->TransformJointsSoA( jointMats2, jointQuats, SOA_SKELETONS, parents, SOA_JOINTS );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < SOA_SKELETONS * SOA_JOINTS; i++ ) {
+		if ( !joints1[i/SOA_JOINTS][i%SOA_JOINTS].Compare( joints2[i/SOA_JOINTS][i%SOA_JOINTS], 1e-4f ) ) {
+			break;
+		}
+	}
+	result = ( i >= SOA_SKELETONS * SOA_JOINTS ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->TransformJointsSoA() %s", result ), SOA_SKELETONS * SOA_JOINTS, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestUntransformJoints
@@ -4144,6 +4315,14 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 				return;
 			}
 			p_simd = new idSIMD_SSE3();
+#ifdef ID_SIMD_AVX2
+		} else if ( idStr::Icmp( argString, "AVX2" ) == 0 ) {
+			if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) || !( cpuid & CPUID_SSE2 ) || !( cpuid & CPUID_SSE3 ) || !( cpuid & CPUID_AVX2 ) || !( cpuid & CPUID_FMA3 ) ) {
+				common->Printf( "CPU does not support MMX & SSE & SSE2 & SSE3 & AVX2 & FMA\n" );
+				return;
+			}
+			p_simd = new idSIMD_AVX2();
+#endif
 		} else if ( idStr::Icmp( argString, "AltiVec" ) == 0 ) {
 			if ( !( cpuid & CPUID_ALTIVEC ) ) {
 				common->Printf( "CPU does not support AltiVec\n" );
@@ -4151,7 +4330,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 			}
 			p_simd = new idSIMD_AltiVec();
 		} else {
-			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
+			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AVX2, AltiVec\n" );
 			return;
 		}
 	}
@@ -4190,9 +4369,11 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	idLib::common->Printf("====================================\n" );
 
 	TestBlendJoints();
+	TestBlendJointsSoA();
 	TestConvertJointQuatsToJointMats();
 	TestConvertJointMatsToJointQuats();
 	TestTransformJoints();
+	TestTransformJointsSoA();
 	TestUntransformJoints();
 	TestTransformVerts();
 	TestTracePointCull();
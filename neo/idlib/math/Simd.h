@@ -63,6 +63,19 @@ public:
 #define VPCALL
 #endif
 
+// the SSE code paths are implemented with compiler intrinsics on x86-64 Linux. The port
+// needs SSE2 for the double precision sums that keep it bit-identical to the generic code,
+// so a 32 bit build for a plain SSE target such as -march=pentium3 uses the generic code
+// for these routines and only gets the SSE joint kernels below.
+#if defined(__GNUC__) && defined(__linux__) && defined(__SSE2__)
+#define ID_SIMD_SSE_INTRINSICS
+#endif
+
+// the structure of arrays joint kernels only use SSE so they are also built for 32 bit x86
+#if defined(_WIN32) || ( defined(__GNUC__) && defined(__linux__) && defined(__SSE__) )
+#define ID_SIMD_SSE_SOA
+#endif
+
 class idVec2;
 class idVec3;
 class idVec4;
@@ -176,6 +189,10 @@ public:
 	virtual void VPCALL TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) = 0;
 	virtual void VPCALL UntransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) = 0;
 	virtual void VPCALL TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) = 0;
+
+	// joints in structure of arrays layout, see JointTransform.h
+	virtual void VPCALL BlendJointsSoA( float *joints, const float * const *blendJoints, const float * const *lerps, const int numBlends, const int numJoints ) = 0;
+	virtual void VPCALL TransformJointsSoA( idJointMat * const *jointMats, const float *jointQuats, const int numSkeletons, const int *parents, const int numJoints ) = 0;
 	virtual void VPCALL TracePointCull( byte *cullBits, byte &totalOr, const float radius, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL DecalPointCull( byte *cullBits, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL OverlayPointCull( byte *cullBits, idVec2 *texCoords, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
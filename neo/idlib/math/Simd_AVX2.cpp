@@ -0,0 +1,1857 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../precompiled.h"
+#pragma hdrstop
+
+#include "Simd_Generic.h"
+#include "Simd_MMX.h"
+#include "Simd_SSE.h"
+#include "Simd_SSE2.h"
+#include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
+
+
+//===============================================================
+//
+//	AVX2 & FMA implementation of idSIMDProcessor
+//
+//===============================================================
+
+#ifdef ID_SIMD_AVX2
+
+#include <immintrin.h>
+
+// GCC only accepts AVX2 and FMA intrinsics in functions compiled for those
+// targets, so the target is set per function instead of for the whole file.
+// This keeps the compiler from using VEX encodings in code that may run
+// before the CPUID check in idSIMD::InitProcessor.
+#if defined(__GNUC__)
+#define AVX2_TARGET						__attribute__ ((target ("avx2,fma")))
+#define AVX2_NO_CONTRACT				__attribute__ ((optimize ("fp-contract=off")))
+#else
+#define AVX2_TARGET
+#define AVX2_NO_CONTRACT
+#endif
+
+#define DRAWVERT_SIZE				60
+#define JOINTQUAT_SIZE				(7*4)
+#define JOINTMAT_SIZE				(4*3*4)
+
+static const float AVX2_SP_tiny			= 1e-10f;
+static const float AVX2_SP_rsqrtMin		= 1e-30f;
+
+static const float AVX2_SP_sin_c0		= -2.39e-08f;
+static const float AVX2_SP_sin_c1		=  2.7526e-06f;
+static const float AVX2_SP_sin_c2		= -1.98409e-04f;
+static const float AVX2_SP_sin_c3		=  8.3333315e-03f;
+static const float AVX2_SP_sin_c4		= -1.666666664e-01f;
+
+static const float AVX2_SP_atan_c0		=  0.0028662257f;
+static const float AVX2_SP_atan_c1		= -0.0161657367f;
+static const float AVX2_SP_atan_c2		=  0.0429096138f;
+static const float AVX2_SP_atan_c3		= -0.0752896400f;
+static const float AVX2_SP_atan_c4		=  0.1065626393f;
+static const float AVX2_SP_atan_c5		= -0.1420889944f;
+static const float AVX2_SP_atan_c6		=  0.1999355085f;
+static const float AVX2_SP_atan_c7		= -0.3333314528f;
+
+/*
+============
+AVX2_HorizontalSum
+============
+*/
+static AVX2_TARGET ID_INLINE float AVX2_HorizontalSum( const __m256 v ) {
+	__m128 s = _mm_add_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	s = _mm_add_ps( s, _mm_movehl_ps( s, s ) );
+	s = _mm_add_ss( s, _mm_shuffle_ps( s, s, 0x55 ) );
+	return _mm_cvtss_f32( s );
+}
+
+/*
+============
+AVX2_Dot
+
+  returns a[0] * b[0] + a[1] * b[1] + ... + a[n-1] * b[n-1]
+============
+*/
+static AVX2_TARGET float AVX2_Dot( const float *a, const float *b, const int n ) {
+	__m256 s0 = _mm256_setzero_ps();
+	__m256 s1 = _mm256_setzero_ps();
+	int i;
+
+	for ( i = 0; i + 16 <= n; i += 16 ) {
+		s0 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i + 0 ), _mm256_loadu_ps( b + i + 0 ), s0 );
+		s1 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i + 8 ), _mm256_loadu_ps( b + i + 8 ), s1 );
+	}
+	if ( i + 8 <= n ) {
+		s0 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ), s0 );
+		i += 8;
+	}
+	float sum = AVX2_HorizontalSum( _mm256_add_ps( s0, s1 ) );
+	for ( ; i < n; i++ ) {
+		sum += a[i] * b[i];
+	}
+	return sum;
+}
+
+/*
+============
+AVX2_MulAdd
+
+  dst[i] += s * src[i] for 0 <= i < n
+============
+*/
+static AVX2_TARGET void AVX2_MulAdd( float *dst, const float s, const float *src, const int n ) {
+	const __m256 vs = _mm256_set1_ps( s );
+	int i;
+
+	for ( i = 0; i + 8 <= n; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_fmadd_ps( vs, _mm256_loadu_ps( src + i ), _mm256_loadu_ps( dst + i ) ) );
+	}
+	for ( ; i < n; i++ ) {
+		dst[i] += s * src[i];
+	}
+}
+
+/*
+============
+AVX2_RSqrt
+
+  reciprocal square root with one Newton-Raphson iteration, x is clamped to a tiny positive value
+============
+*/
+static AVX2_TARGET ID_INLINE __m256 AVX2_RSqrt( const __m256 x ) {
+	const __m256 c = _mm256_max_ps( x, _mm256_set1_ps( AVX2_SP_rsqrtMin ) );
+	const __m256 r = _mm256_rsqrt_ps( c );
+	// r * ( 1.5f - 0.5f * c * r * r )
+	const __m256 h = _mm256_mul_ps( _mm256_mul_ps( c, _mm256_set1_ps( 0.5f ) ), r );
+	return _mm256_mul_ps( r, _mm256_fnmadd_ps( h, r, _mm256_set1_ps( 1.5f ) ) );
+}
+
+/*
+============
+AVX2_SinZeroHalfPI
+
+  The angles must be between zero and half PI.
+============
+*/
+static AVX2_TARGET ID_INLINE __m256 AVX2_SinZeroHalfPI( const __m256 a ) {
+	const __m256 s = _mm256_mul_ps( a, a );
+	__m256 t = _mm256_set1_ps( AVX2_SP_sin_c0 );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_sin_c1 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_sin_c2 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_sin_c3 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_sin_c4 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 1.0f ) );
+	return _mm256_mul_ps( t, a );
+}
+
+/*
+============
+AVX2_ATanPositive
+
+  Both 'x' and 'y' must be positive.
+============
+*/
+static AVX2_TARGET ID_INLINE __m256 AVX2_ATanPositive( const __m256 y, const __m256 x ) {
+	const __m256 gt = _mm256_cmp_ps( y, x, _CMP_GT_OQ );
+	const __m256 num = _mm256_blendv_ps( y, x, gt );
+	const __m256 den = _mm256_blendv_ps( x, y, gt );
+	// a = -x / y or y / x
+	const __m256 a = _mm256_xor_ps( _mm256_div_ps( num, den ), _mm256_and_ps( gt, _mm256_set1_ps( -0.0f ) ) );
+	const __m256 d = _mm256_and_ps( gt, _mm256_set1_ps( idMath::HALF_PI ) );
+	const __m256 s = _mm256_mul_ps( a, a );
+	__m256 t = _mm256_set1_ps( AVX2_SP_atan_c0 );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c1 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c2 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c3 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c4 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c5 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c6 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( AVX2_SP_atan_c7 ) );
+	t = _mm256_fmadd_ps( t, s, _mm256_set1_ps( 1.0f ) );
+	return _mm256_fmadd_ps( t, a, d );
+}
+
+/*
+============
+AVX2_DotStrided
+
+  dst[i] = cx * src[i*stride+0] + cy * src[i*stride+1] + cz * src[i*stride+2] + ( useW ? cw * src[i*stride+3] : 0 ) + cd;
+============
+*/
+static AVX2_TARGET void AVX2_DotStrided( float *dst, const float *src, const int stride, const int count,
+											const float cx, const float cy, const float cz, const float cw, const float cd, const bool useW ) {
+	const __m256i offsets = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( stride ) );
+	const __m256 vx = _mm256_set1_ps( cx );
+	const __m256 vy = _mm256_set1_ps( cy );
+	const __m256 vz = _mm256_set1_ps( cz );
+	const __m256 vw = _mm256_set1_ps( cw );
+	const __m256 vd = _mm256_set1_ps( cd );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const float *s = src + i * stride;
+		__m256 d = _mm256_fmadd_ps( vx, _mm256_i32gather_ps( s + 0, offsets, 4 ), vd );
+		d = _mm256_fmadd_ps( vy, _mm256_i32gather_ps( s + 1, offsets, 4 ), d );
+		d = _mm256_fmadd_ps( vz, _mm256_i32gather_ps( s + 2, offsets, 4 ), d );
+		if ( useW ) {
+			d = _mm256_fmadd_ps( vw, _mm256_i32gather_ps( s + 3, offsets, 4 ), d );
+		}
+		_mm256_storeu_ps( dst + i, d );
+	}
+	for ( ; i < count; i++ ) {
+		const float *s = src + i * stride;
+		dst[i] = cx * s[0] + cy * s[1] + cz * s[2] + ( useW ? cw * s[3] : 0.0f ) + cd;
+	}
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char * idSIMD_AVX2::GetName( void ) const {
+	return "MMX & SSE & SSE2 & SSE3 & AVX2 & FMA";
+}
+
+/*
+============
+idSIMD_AVX2::Mul
+
+  dst[i] = constant * src[i];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Mul( float *dst, const float constant, const float *src, const int count ) {
+	const __m256 c = _mm256_set1_ps( constant );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_mul_ps( c, _mm256_loadu_ps( src + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant * src[i];
+	}
+}
+
+/*
+============
+idSIMD_AVX2::Mul
+
+  dst[i] = src0[i] * src1[i];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Mul( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_mul_ps( _mm256_loadu_ps( src0 + i ), _mm256_loadu_ps( src1 + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MulAdd
+
+  dst[i] += constant * src[i];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MulAdd( float *dst, const float constant, const float *src, const int count ) {
+	AVX2_MulAdd( dst, constant, src, count );
+}
+
+/*
+============
+idSIMD_AVX2::MulAdd
+
+  dst[i] += src0[i] * src1[i];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MulAdd( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		_mm256_storeu_ps( dst + i, _mm256_fmadd_ps( _mm256_loadu_ps( src0 + i ), _mm256_loadu_ps( src1 + i ), _mm256_loadu_ps( dst + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] += src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant * src[i];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idVec3 &constant, const idVec3 *src, const int count ) {
+	AVX2_DotStrided( dst, src->ToFloatPtr(), 3, count, constant[0], constant[1], constant[2], 0.0f, 0.0f, false );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant * src[i].Normal() + src[i][3];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idVec3 &constant, const idPlane *src, const int count ) {
+	AVX2_DotStrided( dst, src->ToFloatPtr(), 4, count, constant[0], constant[1], constant[2], 1.0f, 0.0f, true );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant * src[i].xyz;
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idVec3 &constant, const idDrawVert *src, const int count ) {
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	AVX2_DotStrided( dst, src->xyz.ToFloatPtr(), DRAWVERT_SIZE / sizeof( float ), count, constant[0], constant[1], constant[2], 0.0f, 0.0f, false );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant.Normal() * src[i] + constant[3];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idPlane &constant, const idVec3 *src, const int count ) {
+	AVX2_DotStrided( dst, src->ToFloatPtr(), 3, count, constant[0], constant[1], constant[2], 0.0f, constant[3], false );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant.Normal() * src[i].Normal() + constant[3] * src[i][3];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idPlane &constant, const idPlane *src, const int count ) {
+	AVX2_DotStrided( dst, src->ToFloatPtr(), 4, count, constant[0], constant[1], constant[2], constant[3], 0.0f, true );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = constant.Normal() * src[i].xyz + constant[3];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idPlane &constant, const idDrawVert *src, const int count ) {
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	AVX2_DotStrided( dst, src->xyz.ToFloatPtr(), DRAWVERT_SIZE / sizeof( float ), count, constant[0], constant[1], constant[2], 0.0f, constant[3], false );
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dst[i] = src0[i] * src1[i];
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float *dst, const idVec3 *src0, const idVec3 *src1, const int count ) {
+	const __m256i offsets = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+	const float *s0 = src0->ToFloatPtr();
+	const float *s1 = src1->ToFloatPtr();
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const float *a = s0 + i * 3;
+		const float *b = s1 + i * 3;
+		__m256 d = _mm256_mul_ps( _mm256_i32gather_ps( a + 0, offsets, 4 ), _mm256_i32gather_ps( b + 0, offsets, 4 ) );
+		d = _mm256_fmadd_ps( _mm256_i32gather_ps( a + 1, offsets, 4 ), _mm256_i32gather_ps( b + 1, offsets, 4 ), d );
+		d = _mm256_fmadd_ps( _mm256_i32gather_ps( a + 2, offsets, 4 ), _mm256_i32gather_ps( b + 2, offsets, 4 ), d );
+		_mm256_storeu_ps( dst + i, d );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_AVX2::Dot
+
+  dot = src1[0] * src2[0] + src1[1] * src2[1] + src1[2] * src2[2] + ...
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::Dot( float &dot, const float *src1, const float *src2, const int count ) {
+	if ( count < 8 ) {
+		idSIMD_SSE3::Dot( dot, src1, src2, count );
+		return;
+	}
+	dot = AVX2_Dot( src1, src2, count );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( float &min, float &max, const float *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const __m256 v = _mm256_loadu_ps( src + i );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 m0 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 m1 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	m0 = _mm_min_ps( m0, _mm_movehl_ps( m0, m0 ) );
+	m1 = _mm_max_ps( m1, _mm_movehl_ps( m1, m1 ) );
+	m0 = _mm_min_ss( m0, _mm_shuffle_ps( m0, m0, 0x55 ) );
+	m1 = _mm_max_ss( m1, _mm_shuffle_ps( m1, m1, 0x55 ) );
+	min = _mm_cvtss_f32( m0 );
+	max = _mm_cvtss_f32( m1 );
+
+	for ( ; i < count; i++ ) {
+		if ( src[i] < min ) {
+			min = src[i];
+		}
+		if ( src[i] > max ) {
+			max = src[i];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec2 &min, idVec2 &max, const idVec2 *src, const int count ) {
+	const float *s = src->ToFloatPtr();
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	// four vectors per register, the even lanes hold x and the odd lanes y
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		const __m256 v = _mm256_loadu_ps( s + i * 2 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 m0 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 m1 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	m0 = _mm_min_ps( m0, _mm_movehl_ps( m0, m0 ) );
+	m1 = _mm_max_ps( m1, _mm_movehl_ps( m1, m1 ) );
+	min[0] = _mm_cvtss_f32( m0 );
+	min[1] = _mm_cvtss_f32( _mm_shuffle_ps( m0, m0, 0x55 ) );
+	max[0] = _mm_cvtss_f32( m1 );
+	max[1] = _mm_cvtss_f32( _mm_shuffle_ps( m1, m1, 0x55 ) );
+
+	for ( ; i < count; i++ ) {
+		const idVec2 &v = src[i];
+		if ( v[0] < min[0] ) {
+			min[0] = v[0];
+		}
+		if ( v[0] > max[0] ) {
+			max[0] = v[0];
+		}
+		if ( v[1] < min[1] ) {
+			min[1] = v[1];
+		}
+		if ( v[1] > max[1] ) {
+			max[1] = v[1];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idVec3 *src, const int count ) {
+	const float *s = src->ToFloatPtr();
+	__m256 vmin0, vmin1, vmin2, vmax0, vmax1, vmax2;
+	int i, j;
+
+	vmin0 = vmin1 = vmin2 = _mm256_set1_ps( idMath::INFINITY );
+	vmax0 = vmax1 = vmax2 = _mm256_set1_ps( -idMath::INFINITY );
+
+	// eight vectors per three registers, lane k of register r holds component ( 8 * r + k ) % 3
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const __m256 v0 = _mm256_loadu_ps( s + i * 3 + 0 );
+		const __m256 v1 = _mm256_loadu_ps( s + i * 3 + 8 );
+		const __m256 v2 = _mm256_loadu_ps( s + i * 3 + 16 );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+		vmin2 = _mm256_min_ps( vmin2, v2 );
+		vmax2 = _mm256_max_ps( vmax2, v2 );
+	}
+
+	float mins[24], maxs[24];
+	_mm256_storeu_ps( mins + 0, vmin0 );
+	_mm256_storeu_ps( mins + 8, vmin1 );
+	_mm256_storeu_ps( mins + 16, vmin2 );
+	_mm256_storeu_ps( maxs + 0, vmax0 );
+	_mm256_storeu_ps( maxs + 8, vmax1 );
+	_mm256_storeu_ps( maxs + 16, vmax2 );
+
+	min[0] = min[1] = min[2] = idMath::INFINITY;
+	max[0] = max[1] = max[2] = -idMath::INFINITY;
+	for ( j = 0; j < 24; j++ ) {
+		if ( mins[j] < min[j % 3] ) {
+			min[j % 3] = mins[j];
+		}
+		if ( maxs[j] > max[j % 3] ) {
+			max[j % 3] = maxs[j];
+		}
+	}
+
+	for ( ; i < count; i++ ) {
+		const idVec3 &v = src[i];
+		if ( v[0] < min[0] ) {
+			min[0] = v[0];
+		}
+		if ( v[0] > max[0] ) {
+			max[0] = v[0];
+		}
+		if ( v[1] < min[1] ) {
+			min[1] = v[1];
+		}
+		if ( v[1] > max[1] ) {
+			max[1] = v[1];
+		}
+		if ( v[2] < min[2] ) {
+			min[2] = v[2];
+		}
+		if ( v[2] > max[2] ) {
+			max[2] = v[2];
+		}
+	}
+}
+
+/*
+============
+AVX2_StoreMinMax3
+
+  stores the xyz components of the two halves of each register in min and max
+============
+*/
+static AVX2_TARGET ID_INLINE void AVX2_StoreMinMax3( idVec3 &min, idVec3 &max, const __m256 vmin, const __m256 vmax ) {
+	const __m128 m0 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	const __m128 m1 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	ALIGN16( float t[8] );
+	_mm_storeu_ps( t + 0, m0 );
+	_mm_storeu_ps( t + 4, m1 );
+	min[0] = t[0];
+	min[1] = t[1];
+	min[2] = t[2];
+	max[0] = t[4];
+	max[1] = t[5];
+	max[2] = t[6];
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+
+	// the fourth lane of each half holds st[0] and is ignored
+	for ( i = 0; i + 2 <= count; i += 2 ) {
+		const __m256 v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[i+0].xyz.ToFloatPtr() ) ),
+												_mm_loadu_ps( src[i+1].xyz.ToFloatPtr() ), 1 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+	if ( i < count ) {
+		const __m128 v = _mm_loadu_ps( src[i].xyz.ToFloatPtr() );
+		const __m256 vv = _mm256_insertf128_ps( _mm256_castps128_ps256( v ), v, 1 );
+		vmin = _mm256_min_ps( vmin, vv );
+		vmax = _mm256_max_ps( vmax, vv );
+	}
+
+	AVX2_StoreMinMax3( min, max, vmin, vmax );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int *indexes, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+
+	// the fourth lane of each half holds st[0] and is ignored
+	for ( i = 0; i + 2 <= count; i += 2 ) {
+		const __m256 v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[indexes[i+0]].xyz.ToFloatPtr() ) ),
+												_mm_loadu_ps( src[indexes[i+1]].xyz.ToFloatPtr() ), 1 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+	if ( i < count ) {
+		const __m128 v = _mm_loadu_ps( src[indexes[i]].xyz.ToFloatPtr() );
+		const __m256 vv = _mm256_insertf128_ps( _mm256_castps128_ps256( v ), v, 1 );
+		vmin = _mm256_min_ps( vmin, vv );
+		vmax = _mm256_max_ps( vmax, vv );
+	}
+
+	AVX2_StoreMinMax3( min, max, vmin, vmax );
+}
+
+/*
+============
+AVX2_MultiplyVecX
+
+  dst[i] = op( dst[i], mat[i] * vec ) with op 0 = assign, 1 = add, -1 = subtract
+============
+*/
+static AVX2_TARGET void AVX2_MultiplyVecX( float *dst, const idMatX &mat, const float *vec, const int op ) {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
+	const float *mPtr = mat.ToFloatPtr();
+
+	for ( int i = 0; i < numRows; i++ ) {
+		const float sum = AVX2_Dot( mPtr, vec, numColumns );
+		if ( op == 0 ) {
+			dst[i] = sum;
+		} else if ( op > 0 ) {
+			dst[i] += sum;
+		} else {
+			dst[i] -= sum;
+		}
+		mPtr += numColumns;
+	}
+}
+
+/*
+============
+AVX2_TransposeMultiplyVecX
+
+  dst[i] = op( dst[i], mat.Transpose()[i] * vec ) with op 0 = assign, 1 = add, -1 = subtract
+  the rows of the matrix are accumulated into dst to keep the memory accesses sequential
+============
+*/
+static AVX2_TARGET void AVX2_TransposeMultiplyVecX( float *dst, const idMatX &mat, const float *vec, const int op ) {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
+	const float *mPtr = mat.ToFloatPtr();
+	int i;
+
+	if ( op == 0 ) {
+		memset( dst, 0, numColumns * sizeof( float ) );
+	}
+	for ( i = 0; i < numRows; i++ ) {
+		AVX2_MulAdd( dst, ( op < 0 ) ? -vec[i] : vec[i], mPtr, numColumns );
+		mPtr += numColumns;
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplyVecX
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_MultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+
+	if ( mat.GetNumColumns() < 8 ) {
+		idSIMD_SSE3::MatX_MultiplyVecX( dst, mat, vec );
+		return;
+	}
+	AVX2_MultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 0 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplyAddVecX
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_MultiplyAddVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+
+	if ( mat.GetNumColumns() < 8 ) {
+		idSIMD_SSE3::MatX_MultiplyAddVecX( dst, mat, vec );
+		return;
+	}
+	AVX2_MultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_MultiplySubVecX
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_MultiplySubVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+
+	if ( mat.GetNumColumns() < 8 ) {
+		idSIMD_SSE3::MatX_MultiplySubVecX( dst, mat, vec );
+		return;
+	}
+	AVX2_MultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), -1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_TransposeMultiplyVecX
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_TransposeMultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+
+	if ( mat.GetNumColumns() < 8 ) {
+		idSIMD_SSE3::MatX_TransposeMultiplyVecX( dst, mat, vec );
+		return;
+	}
+	AVX2_TransposeMultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 0 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_TransposeMultiplyAddVecX
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_TransposeMultiplyAddVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+
+	if ( mat.GetNumColumns() < 8 ) {
+		idSIMD_SSE3::MatX_TransposeMultiplyAddVecX( dst, mat, vec );
+		return;
+	}
+	AVX2_TransposeMultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_TransposeMultiplySubVecX
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_TransposeMultiplySubVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+
+	if ( mat.GetNumColumns() < 8 ) {
+		idSIMD_SSE3::MatX_TransposeMultiplySubVecX( dst, mat, vec );
+		return;
+	}
+	AVX2_TransposeMultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), -1 );
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LowerTriangularSolve
+
+  solves x in Lx = b for the n * n sub-matrix of L
+  if skip > 0 the first skip elements of x are assumed to be valid already
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_LowerTriangularSolve( const idMatX &L, float *x, const float *b, const int n, int skip ) {
+	if ( n < 8 ) {
+		idSIMD_SSE3::MatX_LowerTriangularSolve( L, x, b, n, skip );
+		return;
+	}
+
+	const float *lptr = L[skip];
+	const int nc = L.GetNumColumns();
+
+	for ( int i = skip; i < n; i++ ) {
+		x[i] = b[i] - AVX2_Dot( lptr, x, i );
+		lptr += nc;
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LowerTriangularSolveTranspose
+
+  solves x in L'x = b for the n * n sub-matrix of L
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+
+  Instead of walking the columns of L, every solved x[i] is subtracted
+  from the remaining right hand side using the contiguous row i of L.
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MatX_LowerTriangularSolveTranspose( const idMatX &L, float *x, const float *b, const int n ) {
+	if ( n < 8 ) {
+		idSIMD_SSE3::MatX_LowerTriangularSolveTranspose( L, x, b, n );
+		return;
+	}
+
+	if ( x != b ) {
+		memcpy( x, b, n * sizeof( float ) );
+	}
+
+	for ( int i = n - 1; i > 0; i-- ) {
+		AVX2_MulAdd( x, -x[i], L[i], i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MatX_LDLTFactor
+
+  in-place factorization LDL' of the n * n sub-matrix of mat
+  the reciprocal of the diagonal elements are stored in invDiag
+============
+*/
+AVX2_TARGET bool VPCALL idSIMD_AVX2::MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const int n ) {
+	int i, j, k, nc;
+	float *v, *diag, *mptr;
+	float sum, d;
+
+	if ( n < 8 ) {
+		return idSIMD_SSE3::MatX_LDLTFactor( mat, invDiag, n );
+	}
+
+	v = (float *) _alloca16( n * sizeof( float ) );
+	diag = (float *) _alloca16( n * sizeof( float ) );
+
+	nc = mat.GetNumColumns();
+
+	for ( i = 0; i < n; i++ ) {
+
+		mptr = mat[i];
+
+		// v[k] = diag[k] * mat[i][k]
+		for ( k = 0; k + 8 <= i; k += 8 ) {
+			_mm256_storeu_ps( v + k, _mm256_mul_ps( _mm256_loadu_ps( diag + k ), _mm256_loadu_ps( mptr + k ) ) );
+		}
+		for ( ; k < i; k++ ) {
+			v[k] = diag[k] * mptr[k];
+		}
+
+		sum = mptr[i] - AVX2_Dot( v, mptr, i );
+
+		if ( sum == 0.0f ) {
+			return false;
+		}
+
+		mptr[i] = sum;
+		diag[i] = sum;
+		invDiag[i] = d = 1.0f / sum;
+
+		if ( i + 1 >= n ) {
+			return true;
+		}
+
+		mptr = mat[i+1];
+		for ( j = i + 1; j < n; j++ ) {
+			mptr[i] = ( mptr[i] - AVX2_Dot( mptr, v, i ) ) * d;
+			mptr += nc;
+		}
+	}
+
+	return true;
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+
+  Eight joints are blended at a time. The joint data is gathered into
+  registers holding one component of eight joints each, a partial group
+  repeats the last valid joint in the unused lanes.
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	int i, j;
+
+	if ( lerp <= 0.0f ) {
+		return;
+	} else if ( lerp >= 1.0f ) {
+		for ( i = 0; i < numJoints; i++ ) {
+			j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+
+	const float *jointPtr = joints->q.ToFloatPtr();
+	const float *blendPtr = blendJoints->q.ToFloatPtr();
+	const __m256i stride = _mm256_set1_epi32( JOINTQUAT_SIZE / sizeof( float ) );
+	const __m256 vlerp = _mm256_set1_ps( lerp );
+	const __m256 signBitMask = _mm256_set1_ps( -0.0f );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+
+	for ( i = 0; i < numJoints; i += 8 ) {
+		int count = numJoints - i;
+		int n[8];
+		ALIGN16( float out[7][8] );
+
+		if ( count > 8 ) {
+			count = 8;
+		}
+		for ( j = 0; j < count; j++ ) {
+			n[j] = index[i+j];
+		}
+		for ( ; j < 8; j++ ) {
+			n[j] = n[count-1];
+		}
+
+		const __m256i offsets = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) n ), stride );
+
+		__m256 jq0 = _mm256_i32gather_ps( jointPtr + 0, offsets, 4 );
+		__m256 jq1 = _mm256_i32gather_ps( jointPtr + 1, offsets, 4 );
+		__m256 jq2 = _mm256_i32gather_ps( jointPtr + 2, offsets, 4 );
+		__m256 jq3 = _mm256_i32gather_ps( jointPtr + 3, offsets, 4 );
+		__m256 jt0 = _mm256_i32gather_ps( jointPtr + 4, offsets, 4 );
+		__m256 jt1 = _mm256_i32gather_ps( jointPtr + 5, offsets, 4 );
+		__m256 jt2 = _mm256_i32gather_ps( jointPtr + 6, offsets, 4 );
+
+		const __m256 bq0 = _mm256_i32gather_ps( blendPtr + 0, offsets, 4 );
+		const __m256 bq1 = _mm256_i32gather_ps( blendPtr + 1, offsets, 4 );
+		const __m256 bq2 = _mm256_i32gather_ps( blendPtr + 2, offsets, 4 );
+		const __m256 bq3 = _mm256_i32gather_ps( blendPtr + 3, offsets, 4 );
+		const __m256 bt0 = _mm256_i32gather_ps( blendPtr + 4, offsets, 4 );
+		const __m256 bt1 = _mm256_i32gather_ps( blendPtr + 5, offsets, 4 );
+		const __m256 bt2 = _mm256_i32gather_ps( blendPtr + 6, offsets, 4 );
+
+		jt0 = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bt0, jt0 ), jt0 );
+		jt1 = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bt1, jt1 ), jt1 );
+		jt2 = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bt2, jt2 ), jt2 );
+
+		__m256 cosom = _mm256_mul_ps( jq0, bq0 );
+		cosom = _mm256_fmadd_ps( jq1, bq1, cosom );
+		cosom = _mm256_fmadd_ps( jq2, bq2, cosom );
+		cosom = _mm256_fmadd_ps( jq3, bq3, cosom );
+
+		const __m256 signBit = _mm256_and_ps( cosom, signBitMask );
+		cosom = _mm256_xor_ps( cosom, signBit );
+
+		__m256 scale0 = _mm256_fnmadd_ps( cosom, cosom, one );
+		scale0 = _mm256_blendv_ps( scale0, _mm256_set1_ps( AVX2_SP_tiny ), _mm256_cmp_ps( scale0, _mm256_setzero_ps(), _CMP_LE_OQ ) );
+		const __m256 sinom = AVX2_RSqrt( scale0 );
+		scale0 = _mm256_mul_ps( scale0, sinom );
+
+		__m256 omega0 = AVX2_ATanPositive( scale0, cosom );
+		const __m256 omega1 = _mm256_mul_ps( vlerp, omega0 );
+		omega0 = _mm256_sub_ps( omega0, omega1 );
+
+		scale0 = _mm256_mul_ps( AVX2_SinZeroHalfPI( omega0 ), sinom );
+		__m256 scale1 = _mm256_mul_ps( AVX2_SinZeroHalfPI( omega1 ), sinom );
+		scale1 = _mm256_xor_ps( scale1, signBit );
+
+		jq0 = _mm256_fmadd_ps( scale0, jq0, _mm256_mul_ps( scale1, bq0 ) );
+		jq1 = _mm256_fmadd_ps( scale0, jq1, _mm256_mul_ps( scale1, bq1 ) );
+		jq2 = _mm256_fmadd_ps( scale0, jq2, _mm256_mul_ps( scale1, bq2 ) );
+		jq3 = _mm256_fmadd_ps( scale0, jq3, _mm256_mul_ps( scale1, bq3 ) );
+
+		_mm256_storeu_ps( out[0], jq0 );
+		_mm256_storeu_ps( out[1], jq1 );
+		_mm256_storeu_ps( out[2], jq2 );
+		_mm256_storeu_ps( out[3], jq3 );
+		_mm256_storeu_ps( out[4], jt0 );
+		_mm256_storeu_ps( out[5], jt1 );
+		_mm256_storeu_ps( out[6], jt2 );
+
+		for ( j = 0; j < count; j++ ) {
+			float *q = joints[n[j]].q.ToFloatPtr();
+			q[0] = out[0][j];
+			q[1] = out[1][j];
+			q[2] = out[2][j];
+			q[3] = out[3][j];
+			q[4] = out[4][j];
+			q[5] = out[5][j];
+			q[6] = out[6][j];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ConvertJointQuatsToJointMats
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) {
+	int i, j;
+
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+	assert( sizeof( idJointMat ) == JOINTMAT_SIZE );
+
+	const __m256i offsets = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( JOINTQUAT_SIZE / sizeof( float ) ) );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+
+	for ( i = 0; i + 8 <= numJoints; i += 8 ) {
+		const float *q = jointQuats[i].q.ToFloatPtr();
+		ALIGN16( float m[12][8] );
+
+		const __m256 qx = _mm256_i32gather_ps( q + 0, offsets, 4 );
+		const __m256 qy = _mm256_i32gather_ps( q + 1, offsets, 4 );
+		const __m256 qz = _mm256_i32gather_ps( q + 2, offsets, 4 );
+		const __m256 qw = _mm256_i32gather_ps( q + 3, offsets, 4 );
+
+		const __m256 x2 = _mm256_add_ps( qx, qx );
+		const __m256 y2 = _mm256_add_ps( qy, qy );
+		const __m256 z2 = _mm256_add_ps( qz, qz );
+
+		const __m256 xx = _mm256_mul_ps( qx, x2 );
+		const __m256 yy = _mm256_mul_ps( qy, y2 );
+		const __m256 zz = _mm256_mul_ps( qz, z2 );
+		const __m256 yz = _mm256_mul_ps( qy, z2 );
+		const __m256 wx = _mm256_mul_ps( qw, x2 );
+		const __m256 xy = _mm256_mul_ps( qx, y2 );
+		const __m256 wz = _mm256_mul_ps( qw, z2 );
+		const __m256 xz = _mm256_mul_ps( qx, z2 );
+		const __m256 wy = _mm256_mul_ps( qw, y2 );
+
+		_mm256_storeu_ps( m[0*4+0], _mm256_sub_ps( _mm256_sub_ps( one, yy ), zz ) );
+		_mm256_storeu_ps( m[1*4+1], _mm256_sub_ps( _mm256_sub_ps( one, xx ), zz ) );
+		_mm256_storeu_ps( m[2*4+2], _mm256_sub_ps( _mm256_sub_ps( one, xx ), yy ) );
+		_mm256_storeu_ps( m[2*4+1], _mm256_sub_ps( yz, wx ) );
+		_mm256_storeu_ps( m[1*4+2], _mm256_add_ps( yz, wx ) );
+		_mm256_storeu_ps( m[1*4+0], _mm256_sub_ps( xy, wz ) );
+		_mm256_storeu_ps( m[0*4+1], _mm256_add_ps( xy, wz ) );
+		_mm256_storeu_ps( m[0*4+2], _mm256_sub_ps( xz, wy ) );
+		_mm256_storeu_ps( m[2*4+0], _mm256_add_ps( xz, wy ) );
+		_mm256_storeu_ps( m[0*4+3], _mm256_i32gather_ps( q + 4, offsets, 4 ) );
+		_mm256_storeu_ps( m[1*4+3], _mm256_i32gather_ps( q + 5, offsets, 4 ) );
+		_mm256_storeu_ps( m[2*4+3], _mm256_i32gather_ps( q + 6, offsets, 4 ) );
+
+		for ( j = 0; j < 8; j++ ) {
+			float *dst = jointMats[i+j].ToFloatPtr();
+			for ( int k = 0; k < 12; k++ ) {
+				dst[k] = m[k][j];
+			}
+		}
+	}
+
+	if ( i < numJoints ) {
+		idSIMD_SSE3::ConvertJointQuatsToJointMats( jointMats + i, jointQuats + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformVerts
+
+  The first two rows of a joint matrix are weighted in one register and
+  the third row in another, the rows are summed once per vertex.
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) {
+	int i, j;
+	const byte *jointsPtr = (byte *)joints;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	assert( sizeof( idJointMat ) == JOINTMAT_SIZE );
+
+	for( j = i = 0; i < numVerts; i++ ) {
+		const float *m = (const float *) ( jointsPtr + index[j*2+0] );
+		__m256 w = _mm256_broadcast_ps( (const __m128 *) weights[j].ToFloatPtr() );
+		__m256 r01 = _mm256_mul_ps( _mm256_loadu_ps( m + 0 ), w );
+		__m128 r2 = _mm_mul_ps( _mm_loadu_ps( m + 8 ), _mm256_castps256_ps128( w ) );
+
+		while( index[j*2+1] == 0 ) {
+			j++;
+			m = (const float *) ( jointsPtr + index[j*2+0] );
+			w = _mm256_broadcast_ps( (const __m128 *) weights[j].ToFloatPtr() );
+			r01 = _mm256_fmadd_ps( _mm256_loadu_ps( m + 0 ), w, r01 );
+			r2 = _mm_fmadd_ps( _mm_loadu_ps( m + 8 ), _mm256_castps256_ps128( w ), r2 );
+		}
+		j++;
+
+		const __m128 t0 = _mm_hadd_ps( _mm256_castps256_ps128( r01 ), _mm256_extractf128_ps( r01, 1 ) );
+		const __m128 t1 = _mm_hadd_ps( r2, r2 );
+		const __m128 s = _mm_hadd_ps( t0, t1 );
+
+		float *xyz = verts[i].xyz.ToFloatPtr();
+		_mm_storel_pi( (__m64 *) xyz, s );
+		_mm_store_ss( xyz + 2, _mm_movehl_ps( s, s ) );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::BlendJointsSoA
+
+  Eight joints are blended at a time. The joints stay in registers while all
+  layers are blended over them, lanes with a layer lerp of zero or less keep
+  the joint and lanes with a lerp of one or more take the layer joint.
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::BlendJointsSoA( float *joints, const float * const *blendJoints, const float * const *lerps, const int numBlends, const int numJoints ) {
+	int i, j;
+	const int stride = JointQuatSoAStride( numJoints );
+
+	const __m256 signBitMask = _mm256_set1_ps( -0.0f );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 zero = _mm256_setzero_ps();
+
+	for ( i = 0; i < numJoints; i += 8 ) {
+		float *jointPtr = joints + i;
+
+		__m256 jq0 = _mm256_loadu_ps( jointPtr + 0 * stride );
+		__m256 jq1 = _mm256_loadu_ps( jointPtr + 1 * stride );
+		__m256 jq2 = _mm256_loadu_ps( jointPtr + 2 * stride );
+		__m256 jq3 = _mm256_loadu_ps( jointPtr + 3 * stride );
+		__m256 jt0 = _mm256_loadu_ps( jointPtr + 4 * stride );
+		__m256 jt1 = _mm256_loadu_ps( jointPtr + 5 * stride );
+		__m256 jt2 = _mm256_loadu_ps( jointPtr + 6 * stride );
+
+		for ( j = 0; j < numBlends; j++ ) {
+			const __m256 vlerp = _mm256_loadu_ps( lerps[j] + i );
+			const __m256 keep = _mm256_cmp_ps( vlerp, zero, _CMP_LE_OQ );
+
+			if ( _mm256_movemask_ps( keep ) == 0xFF ) {
+				continue;
+			}
+
+			const float *blendPtr = blendJoints[j] + i;
+			const __m256 copy = _mm256_cmp_ps( vlerp, one, _CMP_GE_OQ );
+
+			const __m256 bq0 = _mm256_loadu_ps( blendPtr + 0 * stride );
+			const __m256 bq1 = _mm256_loadu_ps( blendPtr + 1 * stride );
+			const __m256 bq2 = _mm256_loadu_ps( blendPtr + 2 * stride );
+			const __m256 bq3 = _mm256_loadu_ps( blendPtr + 3 * stride );
+			const __m256 bt0 = _mm256_loadu_ps( blendPtr + 4 * stride );
+			const __m256 bt1 = _mm256_loadu_ps( blendPtr + 5 * stride );
+			const __m256 bt2 = _mm256_loadu_ps( blendPtr + 6 * stride );
+
+			if ( _mm256_movemask_ps( _mm256_or_ps( keep, copy ) ) == 0xFF ) {
+				jq0 = _mm256_blendv_ps( bq0, jq0, keep );
+				jq1 = _mm256_blendv_ps( bq1, jq1, keep );
+				jq2 = _mm256_blendv_ps( bq2, jq2, keep );
+				jq3 = _mm256_blendv_ps( bq3, jq3, keep );
+				jt0 = _mm256_blendv_ps( bt0, jt0, keep );
+				jt1 = _mm256_blendv_ps( bt1, jt1, keep );
+				jt2 = _mm256_blendv_ps( bt2, jt2, keep );
+				continue;
+			}
+
+			__m256 t0 = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bt0, jt0 ), jt0 );
+			__m256 t1 = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bt1, jt1 ), jt1 );
+			__m256 t2 = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bt2, jt2 ), jt2 );
+
+			__m256 cosom = _mm256_mul_ps( jq0, bq0 );
+			cosom = _mm256_fmadd_ps( jq1, bq1, cosom );
+			cosom = _mm256_fmadd_ps( jq2, bq2, cosom );
+			cosom = _mm256_fmadd_ps( jq3, bq3, cosom );
+
+			const __m256 signBit = _mm256_and_ps( cosom, signBitMask );
+			cosom = _mm256_xor_ps( cosom, signBit );
+
+			__m256 scale0 = _mm256_fnmadd_ps( cosom, cosom, one );
+			scale0 = _mm256_blendv_ps( scale0, _mm256_set1_ps( AVX2_SP_tiny ), _mm256_cmp_ps( scale0, zero, _CMP_LE_OQ ) );
+			const __m256 sinom = AVX2_RSqrt( scale0 );
+			scale0 = _mm256_mul_ps( scale0, sinom );
+
+			__m256 omega0 = AVX2_ATanPositive( scale0, cosom );
+			const __m256 omega1 = _mm256_mul_ps( vlerp, omega0 );
+			omega0 = _mm256_sub_ps( omega0, omega1 );
+
+			scale0 = _mm256_mul_ps( AVX2_SinZeroHalfPI( omega0 ), sinom );
+			__m256 scale1 = _mm256_mul_ps( AVX2_SinZeroHalfPI( omega1 ), sinom );
+			scale1 = _mm256_xor_ps( scale1, signBit );
+
+			__m256 q0 = _mm256_fmadd_ps( scale0, jq0, _mm256_mul_ps( scale1, bq0 ) );
+			__m256 q1 = _mm256_fmadd_ps( scale0, jq1, _mm256_mul_ps( scale1, bq1 ) );
+			__m256 q2 = _mm256_fmadd_ps( scale0, jq2, _mm256_mul_ps( scale1, bq2 ) );
+			__m256 q3 = _mm256_fmadd_ps( scale0, jq3, _mm256_mul_ps( scale1, bq3 ) );
+
+			jq0 = _mm256_blendv_ps( _mm256_blendv_ps( q0, bq0, copy ), jq0, keep );
+			jq1 = _mm256_blendv_ps( _mm256_blendv_ps( q1, bq1, copy ), jq1, keep );
+			jq2 = _mm256_blendv_ps( _mm256_blendv_ps( q2, bq2, copy ), jq2, keep );
+			jq3 = _mm256_blendv_ps( _mm256_blendv_ps( q3, bq3, copy ), jq3, keep );
+			jt0 = _mm256_blendv_ps( _mm256_blendv_ps( t0, bt0, copy ), jt0, keep );
+			jt1 = _mm256_blendv_ps( _mm256_blendv_ps( t1, bt1, copy ), jt1, keep );
+			jt2 = _mm256_blendv_ps( _mm256_blendv_ps( t2, bt2, copy ), jt2, keep );
+		}
+
+		_mm256_storeu_ps( jointPtr + 0 * stride, jq0 );
+		_mm256_storeu_ps( jointPtr + 1 * stride, jq1 );
+		_mm256_storeu_ps( jointPtr + 2 * stride, jq2 );
+		_mm256_storeu_ps( jointPtr + 3 * stride, jq3 );
+		_mm256_storeu_ps( jointPtr + 4 * stride, jt0 );
+		_mm256_storeu_ps( jointPtr + 5 * stride, jt1 );
+		_mm256_storeu_ps( jointPtr + 6 * stride, jt2 );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformJointsSoA
+
+  Eight skeletons are transformed at a time, each lane holds the same joint
+  of another skeleton. The model space matrices of the eight skeletons are
+  kept with one register per matrix element so the parent of a joint can be
+  loaded without any shuffling. A partial group repeats the last skeleton
+  in the unused lanes. The products are not contracted to keep the results
+  of idJointMat::operator*=.
+============
+*/
+AVX2_TARGET AVX2_NO_CONTRACT void VPCALL idSIMD_AVX2::TransformJointsSoA( idJointMat * const *jointMats, const float *jointQuats, const int numSkeletons, const int *parents, const int numJoints ) {
+	int i, j, k, s;
+	const int stride = JointQuatSoAStride( numJoints );
+
+	assert( sizeof( idJointMat ) == JOINTMAT_SIZE );
+
+	float *world = (float *) _alloca16( numJoints * 12 * 8 * sizeof( float ) );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+
+	for ( s = 0; s < numSkeletons; s += 8 ) {
+		int count = numSkeletons - s;
+		int n[8];
+
+		if ( count > 8 ) {
+			count = 8;
+		}
+		for ( j = 0; j < count; j++ ) {
+			n[j] = ( s + j ) * JOINTQUAT_SOA_COMPONENTS * stride;
+		}
+		for ( ; j < 8; j++ ) {
+			n[j] = n[count-1];
+		}
+
+		const __m256i offsets = _mm256_loadu_si256( (const __m256i *) n );
+
+		for ( i = 0; i < numJoints; i++ ) {
+			const float *q = jointQuats + i;
+			float *w = world + i * 12 * 8;
+			__m256 m[12];
+
+			const __m256 qx = _mm256_i32gather_ps( q + 0 * stride, offsets, 4 );
+			const __m256 qy = _mm256_i32gather_ps( q + 1 * stride, offsets, 4 );
+			const __m256 qz = _mm256_i32gather_ps( q + 2 * stride, offsets, 4 );
+			const __m256 qw = _mm256_i32gather_ps( q + 3 * stride, offsets, 4 );
+
+			const __m256 x2 = _mm256_add_ps( qx, qx );
+			const __m256 y2 = _mm256_add_ps( qy, qy );
+			const __m256 z2 = _mm256_add_ps( qz, qz );
+
+			const __m256 xx = _mm256_mul_ps( qx, x2 );
+			const __m256 yy = _mm256_mul_ps( qy, y2 );
+			const __m256 zz = _mm256_mul_ps( qz, z2 );
+			const __m256 yz = _mm256_mul_ps( qy, z2 );
+			const __m256 wx = _mm256_mul_ps( qw, x2 );
+			const __m256 xy = _mm256_mul_ps( qx, y2 );
+			const __m256 wz = _mm256_mul_ps( qw, z2 );
+			const __m256 xz = _mm256_mul_ps( qx, z2 );
+			const __m256 wy = _mm256_mul_ps( qw, y2 );
+
+			m[0*4+0] = _mm256_sub_ps( _mm256_sub_ps( one, yy ), zz );
+			m[1*4+1] = _mm256_sub_ps( _mm256_sub_ps( one, xx ), zz );
+			m[2*4+2] = _mm256_sub_ps( _mm256_sub_ps( one, xx ), yy );
+			m[2*4+1] = _mm256_sub_ps( yz, wx );
+			m[1*4+2] = _mm256_add_ps( yz, wx );
+			m[1*4+0] = _mm256_sub_ps( xy, wz );
+			m[0*4+1] = _mm256_add_ps( xy, wz );
+			m[0*4+2] = _mm256_sub_ps( xz, wy );
+			m[2*4+0] = _mm256_add_ps( xz, wy );
+			m[0*4+3] = _mm256_i32gather_ps( q + 4 * stride, offsets, 4 );
+			m[1*4+3] = _mm256_i32gather_ps( q + 5 * stride, offsets, 4 );
+			m[2*4+3] = _mm256_i32gather_ps( q + 6 * stride, offsets, 4 );
+
+			if ( i > 0 ) {
+				assert( parents[i] < i );
+				const float *p = world + parents[i] * 12 * 8;
+				__m256 pm[12];
+
+				for ( k = 0; k < 12; k++ ) {
+					pm[k] = _mm256_loadu_ps( p + k * 8 );
+				}
+				for ( k = 0; k < 4; k++ ) {
+					const __m256 m0 = m[0*4+k];
+					const __m256 m1 = m[1*4+k];
+					const __m256 m2 = m[2*4+k];
+					m[0*4+k] = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( m0, pm[0*4+0] ), _mm256_mul_ps( m1, pm[0*4+1] ) ), _mm256_mul_ps( m2, pm[0*4+2] ) );
+					m[1*4+k] = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( m0, pm[1*4+0] ), _mm256_mul_ps( m1, pm[1*4+1] ) ), _mm256_mul_ps( m2, pm[1*4+2] ) );
+					m[2*4+k] = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( m0, pm[2*4+0] ), _mm256_mul_ps( m1, pm[2*4+1] ) ), _mm256_mul_ps( m2, pm[2*4+2] ) );
+				}
+				m[0*4+3] = _mm256_add_ps( m[0*4+3], pm[0*4+3] );
+				m[1*4+3] = _mm256_add_ps( m[1*4+3], pm[1*4+3] );
+				m[2*4+3] = _mm256_add_ps( m[2*4+3], pm[2*4+3] );
+			}
+
+			for ( k = 0; k < 12; k++ ) {
+				_mm256_storeu_ps( w + k * 8, m[k] );
+			}
+
+			for ( j = 0; j < count; j++ ) {
+				float *dst = jointMats[s+j][i].ToFloatPtr();
+				for ( k = 0; k < 12; k++ ) {
+					dst[k] = w[k * 8 + j];
+				}
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::DeriveTangents
+
+	Derives the normal and orthogonal tangent vectors for the triangle vertices.
+	For each vertex the normal and tangent vectors are derived from all triangles
+	using the vertex which results in smooth tangents across the mesh.
+	In the process the triangle planes are calculated as well.
+
+	The per triangle math is done for eight triangles at a time, the results
+	are then added to the vertices in triangle order like the generic code.
+============
+*/
+AVX2_TARGET AVX2_NO_CONTRACT void VPCALL idSIMD_AVX2::DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	int i, j;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+
+	bool *used = (bool *)_alloca16( numVerts * sizeof( used[0] ) );
+	memset( used, 0, numVerts * sizeof( used[0] ) );
+
+	const float *vertPtr = verts->xyz.ToFloatPtr();
+	const __m256i triOffsets = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+	const __m256i vertStride = _mm256_set1_epi32( DRAWVERT_SIZE / sizeof( float ) );
+	const __m256 signBitMask = _mm256_set1_ps( -0.0f );
+
+	idPlane *planesPtr = planes;
+	for ( i = 0; i < numIndexes; i += 3 * 8 ) {
+		int count = ( numIndexes - i ) / 3;
+		ALIGN16( float out[10][8] );
+
+		if ( count > 8 ) {
+			count = 8;
+		}
+
+		// unused lanes use vertex zero
+		const __m256i mask = _mm256_cmpgt_epi32( _mm256_set1_epi32( count ), _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+		const __m256i v0 = _mm256_mullo_epi32( _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), indexes + i + 0, triOffsets, mask, 4 ), vertStride );
+		const __m256i v1 = _mm256_mullo_epi32( _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), indexes + i + 1, triOffsets, mask, 4 ), vertStride );
+		const __m256i v2 = _mm256_mullo_epi32( _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), indexes + i + 2, triOffsets, mask, 4 ), vertStride );
+
+		const __m256 ax = _mm256_i32gather_ps( vertPtr + 0, v0, 4 );
+		const __m256 ay = _mm256_i32gather_ps( vertPtr + 1, v0, 4 );
+		const __m256 az = _mm256_i32gather_ps( vertPtr + 2, v0, 4 );
+		const __m256 as = _mm256_i32gather_ps( vertPtr + 3, v0, 4 );
+		const __m256 at = _mm256_i32gather_ps( vertPtr + 4, v0, 4 );
+
+		const __m256 d0x = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 0, v1, 4 ), ax );
+		const __m256 d0y = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 1, v1, 4 ), ay );
+		const __m256 d0z = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 2, v1, 4 ), az );
+		const __m256 d0s = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 3, v1, 4 ), as );
+		const __m256 d0t = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 4, v1, 4 ), at );
+
+		const __m256 d1x = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 0, v2, 4 ), ax );
+		const __m256 d1y = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 1, v2, 4 ), ay );
+		const __m256 d1z = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 2, v2, 4 ), az );
+		const __m256 d1s = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 3, v2, 4 ), as );
+		const __m256 d1t = _mm256_sub_ps( _mm256_i32gather_ps( vertPtr + 4, v2, 4 ), at );
+
+		__m256 f;
+
+		// normal
+		__m256 nx = _mm256_sub_ps( _mm256_mul_ps( d1y, d0z ), _mm256_mul_ps( d1z, d0y ) );
+		__m256 ny = _mm256_sub_ps( _mm256_mul_ps( d1z, d0x ), _mm256_mul_ps( d1x, d0z ) );
+		__m256 nz = _mm256_sub_ps( _mm256_mul_ps( d1x, d0y ), _mm256_mul_ps( d1y, d0x ) );
+
+		f = AVX2_RSqrt( _mm256_fmadd_ps( nz, nz, _mm256_fmadd_ps( ny, ny, _mm256_mul_ps( nx, nx ) ) ) );
+		nx = _mm256_mul_ps( nx, f );
+		ny = _mm256_mul_ps( ny, f );
+		nz = _mm256_mul_ps( nz, f );
+
+		_mm256_storeu_ps( out[0], nx );
+		_mm256_storeu_ps( out[1], ny );
+		_mm256_storeu_ps( out[2], nz );
+		_mm256_storeu_ps( out[3], _mm256_fmadd_ps( nz, az, _mm256_fmadd_ps( ny, ay, _mm256_mul_ps( nx, ax ) ) ) );
+
+		// area sign bit
+		const __m256 signBit = _mm256_and_ps( _mm256_sub_ps( _mm256_mul_ps( d0s, d1t ), _mm256_mul_ps( d0t, d1s ) ), signBitMask );
+
+		// first tangent
+		__m256 t0x = _mm256_sub_ps( _mm256_mul_ps( d0x, d1t ), _mm256_mul_ps( d0t, d1x ) );
+		__m256 t0y = _mm256_sub_ps( _mm256_mul_ps( d0y, d1t ), _mm256_mul_ps( d0t, d1y ) );
+		__m256 t0z = _mm256_sub_ps( _mm256_mul_ps( d0z, d1t ), _mm256_mul_ps( d0t, d1z ) );
+
+		f = AVX2_RSqrt( _mm256_fmadd_ps( t0z, t0z, _mm256_fmadd_ps( t0y, t0y, _mm256_mul_ps( t0x, t0x ) ) ) );
+		f = _mm256_xor_ps( f, signBit );
+		_mm256_storeu_ps( out[4], _mm256_mul_ps( t0x, f ) );
+		_mm256_storeu_ps( out[5], _mm256_mul_ps( t0y, f ) );
+		_mm256_storeu_ps( out[6], _mm256_mul_ps( t0z, f ) );
+
+		// second tangent
+		__m256 t1x = _mm256_sub_ps( _mm256_mul_ps( d0s, d1x ), _mm256_mul_ps( d0x, d1s ) );
+		__m256 t1y = _mm256_sub_ps( _mm256_mul_ps( d0s, d1y ), _mm256_mul_ps( d0y, d1s ) );
+		__m256 t1z = _mm256_sub_ps( _mm256_mul_ps( d0s, d1z ), _mm256_mul_ps( d0z, d1s ) );
+
+		f = AVX2_RSqrt( _mm256_fmadd_ps( t1z, t1z, _mm256_fmadd_ps( t1y, t1y, _mm256_mul_ps( t1x, t1x ) ) ) );
+		f = _mm256_xor_ps( f, signBit );
+		_mm256_storeu_ps( out[7], _mm256_mul_ps( t1x, f ) );
+		_mm256_storeu_ps( out[8], _mm256_mul_ps( t1y, f ) );
+		_mm256_storeu_ps( out[9], _mm256_mul_ps( t1z, f ) );
+
+		for ( j = 0; j < count; j++ ) {
+			const idVec3 n( out[0][j], out[1][j], out[2][j] );
+			const idVec3 t0( out[4][j], out[5][j], out[6][j] );
+			const idVec3 t1( out[7][j], out[8][j], out[9][j] );
+
+			planesPtr->SetNormal( n );
+			planesPtr->SetDist( out[3][j] );
+			planesPtr++;
+
+			for ( int k = 0; k < 3; k++ ) {
+				const int v = indexes[i + j * 3 + k];
+				idDrawVert *a = verts + v;
+				if ( used[v] ) {
+					a->normal += n;
+					a->tangents[0] += t0;
+					a->tangents[1] += t1;
+				} else {
+					a->normal = n;
+					a->tangents[0] = t0;
+					a->tangents[1] = t1;
+					used[v] = true;
+				}
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::CreateShadowCache
+============
+*/
+AVX2_TARGET int VPCALL idSIMD_AVX2::CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) {
+	int i, outVerts = 0;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+
+	// the lower half is the vertex with w = 1 and the upper half the
+	// vertex projected away from the light with w = 0
+	const __m256 light = _mm256_setr_ps( 0.0f, 0.0f, 0.0f, 0.0f, lightOrigin[0], lightOrigin[1], lightOrigin[2], 0.0f );
+	const __m256 w = _mm256_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f );
+
+	for ( i = 0; i < numVerts; i++ ) {
+		// skip eight vertices at a time when they are all remapped already
+		if ( ( i & 7 ) == 0 && i + 8 <= numVerts ) {
+			const __m256i remap = _mm256_loadu_si256( (const __m256i *) ( vertRemap + i ) );
+			if ( _mm256_movemask_epi8( _mm256_cmpeq_epi32( remap, _mm256_setzero_si256() ) ) == 0 ) {
+				i += 7;
+				continue;
+			}
+		}
+		if ( vertRemap[i] ) {
+			continue;
+		}
+		const __m128 v = _mm_loadu_ps( verts[i].xyz.ToFloatPtr() );
+		__m256 vv = _mm256_insertf128_ps( _mm256_castps128_ps256( v ), v, 1 );
+		vv = _mm256_blend_ps( _mm256_sub_ps( vv, light ), w, 0x88 );
+		_mm256_storeu_ps( vertexCache[outVerts].ToFloatPtr(), vv );
+		vertRemap[i] = outVerts;
+		outVerts += 2;
+	}
+	return outVerts;
+}
+
+/*
+============
+AVX2_StoreDup2
+
+  stores every element of f twice
+============
+*/
+static AVX2_TARGET ID_INLINE void AVX2_StoreDup2( float *dest, const __m256 f ) {
+	const __m256 lo = _mm256_unpacklo_ps( f, f );
+	const __m256 hi = _mm256_unpackhi_ps( f, f );
+	_mm256_storeu_ps( dest + 0, _mm256_permute2f128_ps( lo, hi, 0x20 ) );
+	_mm256_storeu_ps( dest + 8, _mm256_permute2f128_ps( lo, hi, 0x31 ) );
+}
+
+/*
+============
+AVX2_StorePairsDup2
+
+  stores every pair of elements of f twice
+============
+*/
+static AVX2_TARGET ID_INLINE void AVX2_StorePairsDup2( float *dest, const __m256 f ) {
+	const __m256 lo = _mm256_castpd_ps( _mm256_unpacklo_pd( _mm256_castps_pd( f ), _mm256_castps_pd( f ) ) );
+	const __m256 hi = _mm256_castpd_ps( _mm256_unpackhi_pd( _mm256_castps_pd( f ), _mm256_castps_pd( f ) ) );
+	_mm256_storeu_ps( dest + 0, _mm256_permute2f128_ps( lo, hi, 0x20 ) );
+	_mm256_storeu_ps( dest + 8, _mm256_permute2f128_ps( lo, hi, 0x31 ) );
+}
+
+/*
+============
+AVX2_StoreDup4
+
+  stores every element of f four times
+============
+*/
+static AVX2_TARGET ID_INLINE void AVX2_StoreDup4( float *dest, const __m256 f ) {
+	_mm256_storeu_ps( dest +  0, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 0, 0, 0, 0, 1, 1, 1, 1 ) ) );
+	_mm256_storeu_ps( dest +  8, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 2, 2, 2, 2, 3, 3, 3, 3 ) ) );
+	_mm256_storeu_ps( dest + 16, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 4, 4, 4, 4, 5, 5, 5, 5 ) ) );
+	_mm256_storeu_ps( dest + 24, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 6, 6, 6, 6, 7, 7, 7, 7 ) ) );
+}
+
+/*
+============
+AVX2_StorePairsDup4
+
+  stores every pair of elements of f four times
+============
+*/
+static AVX2_TARGET ID_INLINE void AVX2_StorePairsDup4( float *dest, const __m256 f ) {
+	_mm256_storeu_ps( dest +  0, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 0, 1, 0, 1, 0, 1, 0, 1 ) ) );
+	_mm256_storeu_ps( dest +  8, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 2, 3, 2, 3, 2, 3, 2, 3 ) ) );
+	_mm256_storeu_ps( dest + 16, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 4, 5, 4, 5, 4, 5, 4, 5 ) ) );
+	_mm256_storeu_ps( dest + 24, _mm256_permutevar8x32_ps( f, _mm256_setr_epi32( 6, 7, 6, 7, 6, 7, 6, 7 ) ) );
+}
+
+/*
+============
+AVX2_LoadPCM
+
+  converts eight 16 bit samples to floats
+============
+*/
+static AVX2_TARGET ID_INLINE __m256 AVX2_LoadPCM( const short *pcm ) {
+	return _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i *) pcm ) ) );
+}
+
+/*
+============
+AVX2_LoadOGGStereo
+
+  interleaves four samples of the left and right channel and scales them to 16 bit range
+============
+*/
+static AVX2_TARGET ID_INLINE __m256 AVX2_LoadOGGStereo( const float *left, const float *right ) {
+	const __m128 l = _mm_loadu_ps( left );
+	const __m128 r = _mm_loadu_ps( right );
+	const __m256 f = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_unpacklo_ps( l, r ) ), _mm_unpackhi_ps( l, r ), 1 );
+	return _mm256_mul_ps( f, _mm256_set1_ps( 32768.0f ) );
+}
+
+/*
+============
+idSIMD_AVX2::UpSamplePCMTo44kHz
+
+  Duplicate samples for 44kHz output.
+============
+*/
+AVX2_TARGET void idSIMD_AVX2::UpSamplePCMTo44kHz( float *dest, const short *src, const int numSamples, const int kHz, const int numChannels ) {
+	int i;
+
+	if ( kHz == 11025 ) {
+		if ( numChannels == 1 ) {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				AVX2_StoreDup4( dest + i * 4, AVX2_LoadPCM( src + i ) );
+			}
+			for ( ; i < numSamples; i++ ) {
+				dest[i*4+0] = dest[i*4+1] = dest[i*4+2] = dest[i*4+3] = (float) src[i+0];
+			}
+		} else {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				AVX2_StorePairsDup4( dest + i * 4, AVX2_LoadPCM( src + i ) );
+			}
+			for ( ; i < numSamples; i += 2 ) {
+				dest[i*4+0] = dest[i*4+2] = dest[i*4+4] = dest[i*4+6] = (float) src[i+0];
+				dest[i*4+1] = dest[i*4+3] = dest[i*4+5] = dest[i*4+7] = (float) src[i+1];
+			}
+		}
+	} else if ( kHz == 22050 ) {
+		if ( numChannels == 1 ) {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				AVX2_StoreDup2( dest + i * 2, AVX2_LoadPCM( src + i ) );
+			}
+			for ( ; i < numSamples; i++ ) {
+				dest[i*2+0] = dest[i*2+1] = (float) src[i+0];
+			}
+		} else {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				AVX2_StorePairsDup2( dest + i * 2, AVX2_LoadPCM( src + i ) );
+			}
+			for ( ; i < numSamples; i += 2 ) {
+				dest[i*2+0] = dest[i*2+2] = (float) src[i+0];
+				dest[i*2+1] = dest[i*2+3] = (float) src[i+1];
+			}
+		}
+	} else if ( kHz == 44100 ) {
+		for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+			_mm256_storeu_ps( dest + i, AVX2_LoadPCM( src + i ) );
+		}
+		for ( ; i < numSamples; i++ ) {
+			dest[i] = (float) src[i];
+		}
+	} else {
+		assert( 0 );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::UpSampleOGGTo44kHz
+
+  Duplicate samples for 44kHz output.
+============
+*/
+AVX2_TARGET void idSIMD_AVX2::UpSampleOGGTo44kHz( float *dest, const float * const *ogg, const int numSamples, const int kHz, const int numChannels ) {
+	const __m256 scale = _mm256_set1_ps( 32768.0f );
+	int i;
+
+	if ( kHz == 11025 ) {
+		if ( numChannels == 1 ) {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				AVX2_StoreDup4( dest + i * 4, _mm256_mul_ps( _mm256_loadu_ps( ogg[0] + i ), scale ) );
+			}
+			for ( ; i < numSamples; i++ ) {
+				dest[i*4+0] = dest[i*4+1] = dest[i*4+2] = dest[i*4+3] = ogg[0][i] * 32768.0f;
+			}
+		} else {
+			for ( i = 0; i + 4 <= numSamples >> 1; i += 4 ) {
+				AVX2_StorePairsDup4( dest + i * 8, AVX2_LoadOGGStereo( ogg[0] + i, ogg[1] + i ) );
+			}
+			for ( ; i < numSamples >> 1; i++ ) {
+				dest[i*8+0] = dest[i*8+2] = dest[i*8+4] = dest[i*8+6] = ogg[0][i] * 32768.0f;
+				dest[i*8+1] = dest[i*8+3] = dest[i*8+5] = dest[i*8+7] = ogg[1][i] * 32768.0f;
+			}
+		}
+	} else if ( kHz == 22050 ) {
+		if ( numChannels == 1 ) {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				AVX2_StoreDup2( dest + i * 2, _mm256_mul_ps( _mm256_loadu_ps( ogg[0] + i ), scale ) );
+			}
+			for ( ; i < numSamples; i++ ) {
+				dest[i*2+0] = dest[i*2+1] = ogg[0][i] * 32768.0f;
+			}
+		} else {
+			for ( i = 0; i + 4 <= numSamples >> 1; i += 4 ) {
+				AVX2_StorePairsDup2( dest + i * 4, AVX2_LoadOGGStereo( ogg[0] + i, ogg[1] + i ) );
+			}
+			for ( ; i < numSamples >> 1; i++ ) {
+				dest[i*4+0] = dest[i*4+2] = ogg[0][i] * 32768.0f;
+				dest[i*4+1] = dest[i*4+3] = ogg[1][i] * 32768.0f;
+			}
+		}
+	} else if ( kHz == 44100 ) {
+		if ( numChannels == 1 ) {
+			for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+				_mm256_storeu_ps( dest + i, _mm256_mul_ps( _mm256_loadu_ps( ogg[0] + i ), scale ) );
+			}
+			for ( ; i < numSamples; i++ ) {
+				dest[i*1+0] = ogg[0][i] * 32768.0f;
+			}
+		} else {
+			for ( i = 0; i + 4 <= numSamples >> 1; i += 4 ) {
+				_mm256_storeu_ps( dest + i * 2, AVX2_LoadOGGStereo( ogg[0] + i, ogg[1] + i ) );
+			}
+			for ( ; i < numSamples >> 1; i++ ) {
+				dest[i*2+0] = ogg[0][i] * 32768.0f;
+				dest[i*2+1] = ogg[1][i] * 32768.0f;
+			}
+		}
+	} else {
+		assert( 0 );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundTwoSpeakerMono
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundTwoSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	const float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	const float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+	const __m256i dup = _mm256_setr_epi32( 0, 0, 1, 1, 2, 2, 3, 3 );
+	const __m256 inc = _mm256_setr_ps( 4*incL, 4*incR, 4*incL, 4*incR, 4*incL, 4*incR, 4*incL, 4*incR );
+	__m256 vol = _mm256_setr_ps( lastV[0], lastV[1], lastV[0] + incL, lastV[1] + incR,
+									lastV[0] + 2*incL, lastV[1] + 2*incR, lastV[0] + 3*incL, lastV[1] + 3*incR );
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+	assert( ( MIXBUFFER_SAMPLES & 3 ) == 0 );
+
+	for ( int j = 0; j < MIXBUFFER_SAMPLES; j += 4 ) {
+		const __m256 s = _mm256_permutevar8x32_ps( _mm256_castps128_ps256( _mm_loadu_ps( samples + j ) ), dup );
+		_mm256_storeu_ps( mixBuffer + j*2, _mm256_fmadd_ps( s, vol, _mm256_loadu_ps( mixBuffer + j*2 ) ) );
+		vol = _mm256_add_ps( vol, inc );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundTwoSpeakerStereo
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundTwoSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	const float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	const float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+	const __m256 inc = _mm256_setr_ps( 4*incL, 4*incR, 4*incL, 4*incR, 4*incL, 4*incR, 4*incL, 4*incR );
+	__m256 vol = _mm256_setr_ps( lastV[0], lastV[1], lastV[0] + incL, lastV[1] + incR,
+									lastV[0] + 2*incL, lastV[1] + 2*incR, lastV[0] + 3*incL, lastV[1] + 3*incR );
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+	assert( ( MIXBUFFER_SAMPLES & 3 ) == 0 );
+
+	for ( int j = 0; j < MIXBUFFER_SAMPLES; j += 4 ) {
+		const __m256 s = _mm256_loadu_ps( samples + j*2 );
+		_mm256_storeu_ps( mixBuffer + j*2, _mm256_fmadd_ps( s, vol, _mm256_loadu_ps( mixBuffer + j*2 ) ) );
+		vol = _mm256_add_ps( vol, inc );
+	}
+}
+
+/*
+============
+AVX2_MixSoundSixSpeaker
+
+  Mixes four sample frames into 24 output floats per iteration. The
+  sample permutations select the input sample for every output lane.
+============
+*/
+static AVX2_TARGET void AVX2_MixSoundSixSpeaker( float *mixBuffer, const float *samples, const int sampleStride, const __m256i perm[3], const float lastV[6], const float currentV[6] ) {
+	ALIGN16( float vol[24] );
+	ALIGN16( float inc[24] );
+	float incV[6];
+	int j;
+
+	for ( j = 0; j < 6; j++ ) {
+		incV[j] = ( currentV[j] - lastV[j] ) / MIXBUFFER_SAMPLES;
+	}
+	for ( j = 0; j < 24; j++ ) {
+		vol[j] = lastV[j % 6] + incV[j % 6] * ( j / 6 );
+		inc[j] = incV[j % 6] * 4;
+	}
+
+	__m256 vol0 = _mm256_loadu_ps( vol + 0 );
+	__m256 vol1 = _mm256_loadu_ps( vol + 8 );
+	__m256 vol2 = _mm256_loadu_ps( vol + 16 );
+	const __m256 inc0 = _mm256_loadu_ps( inc + 0 );
+	const __m256 inc1 = _mm256_loadu_ps( inc + 8 );
+	const __m256 inc2 = _mm256_loadu_ps( inc + 16 );
+
+	assert( ( MIXBUFFER_SAMPLES & 3 ) == 0 );
+
+	for ( j = 0; j < MIXBUFFER_SAMPLES; j += 4 ) {
+		__m256 s;
+		if ( sampleStride == 1 ) {
+			s = _mm256_castps128_ps256( _mm_loadu_ps( samples + j ) );
+		} else {
+			s = _mm256_loadu_ps( samples + j * 2 );
+		}
+		float *mix = mixBuffer + j * 6;
+		_mm256_storeu_ps( mix +  0, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, perm[0] ), vol0, _mm256_loadu_ps( mix +  0 ) ) );
+		_mm256_storeu_ps( mix +  8, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, perm[1] ), vol1, _mm256_loadu_ps( mix +  8 ) ) );
+		_mm256_storeu_ps( mix + 16, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, perm[2] ), vol2, _mm256_loadu_ps( mix + 16 ) ) );
+		vol0 = _mm256_add_ps( vol0, inc0 );
+		vol1 = _mm256_add_ps( vol1, inc1 );
+		vol2 = _mm256_add_ps( vol2, inc2 );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundSixSpeakerMono
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundSixSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	__m256i perm[3];
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	perm[0] = _mm256_setr_epi32( 0, 0, 0, 0, 0, 0, 1, 1 );
+	perm[1] = _mm256_setr_epi32( 1, 1, 1, 1, 2, 2, 2, 2 );
+	perm[2] = _mm256_setr_epi32( 2, 2, 3, 3, 3, 3, 3, 3 );
+
+	AVX2_MixSoundSixSpeaker( mixBuffer, samples, 1, perm, lastV, currentV );
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundSixSpeakerStereo
+
+  speakers 0, 2, 3 and 4 take the left sample, speakers 1 and 5 the right sample
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MixSoundSixSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	__m256i perm[3];
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	perm[0] = _mm256_setr_epi32( 0, 1, 0, 0, 0, 1, 2, 3 );
+	perm[1] = _mm256_setr_epi32( 2, 2, 2, 3, 4, 5, 4, 4 );
+	perm[2] = _mm256_setr_epi32( 4, 5, 6, 7, 6, 6, 6, 7 );
+
+	AVX2_MixSoundSixSpeaker( mixBuffer, samples, 2, perm, lastV, currentV );
+}
+
+/*
+============
+idSIMD_AVX2::MixedSoundToSamples
+============
+*/
+AVX2_TARGET void VPCALL idSIMD_AVX2::MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples ) {
+	const __m256 minSample = _mm256_set1_ps( -32768.0f );
+	const __m256 maxSample = _mm256_set1_ps( 32767.0f );
+	int i;
+
+	for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+		const __m256 f = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( mixBuffer + i ), minSample ), maxSample );
+		const __m256i s = _mm256_cvttps_epi32( f );
+		_mm_storeu_si128( (__m128i *) ( samples + i ), _mm_packs_epi32( _mm256_castsi256_si128( s ), _mm256_extracti128_si256( s, 1 ) ) );
+	}
+	for ( ; i < numSamples; i++ ) {
+		if ( mixBuffer[i] <= -32768.0f ) {
+			samples[i] = -32768;
+		} else if ( mixBuffer[i] >= 32767.0f ) {
+			samples[i] = 32767;
+		} else {
+			samples[i] = (short) mixBuffer[i];
+		}
+	}
+}
+
+#endif /* ID_SIMD_AVX2 */
@@ -2331,6 +2331,74 @@ void VPCALL idSIMD_Generic::TransformVerts( idDrawVert *verts, const int numVert
 	}
 }
 
+/*
+============
+idSIMD_Generic::BlendJointsSoA
+
+  Blends all layers over the joints in a single pass. A layer lerp of zero
+  or less keeps the joint, one or more replaces it with the layer joint.
+============
+*/
+void VPCALL idSIMD_Generic::BlendJointsSoA( float *joints, const float * const *blendJoints, const float * const *lerps, const int numBlends, const int numJoints ) {
+	int i, j;
+	int stride = JointQuatSoAStride( numJoints );
+
+	for ( i = 0; i < numJoints; i++ ) {
+		idQuat q( joints[0 * stride + i], joints[1 * stride + i], joints[2 * stride + i], joints[3 * stride + i] );
+		idVec3 t( joints[4 * stride + i], joints[5 * stride + i], joints[6 * stride + i] );
+
+		for ( j = 0; j < numBlends; j++ ) {
+			const float *b = blendJoints[j];
+			float lerp = lerps[j][i];
+
+			if ( lerp <= 0.0f ) {
+				continue;
+			}
+			idQuat bq( b[0 * stride + i], b[1 * stride + i], b[2 * stride + i], b[3 * stride + i] );
+			idVec3 bt( b[4 * stride + i], b[5 * stride + i], b[6 * stride + i] );
+			q.Slerp( q, bq, lerp );
+			t.Lerp( t, bt, lerp );
+		}
+
+		joints[0 * stride + i] = q.x;
+		joints[1 * stride + i] = q.y;
+		joints[2 * stride + i] = q.z;
+		joints[3 * stride + i] = q.w;
+		joints[4 * stride + i] = t.x;
+		joints[5 * stride + i] = t.y;
+		joints[6 * stride + i] = t.z;
+	}
+}
+
+/*
+============
+idSIMD_Generic::TransformJointsSoA
+
+  Converts the joints of skeletons that share the hierarchy to matrices and
+  transforms them to model space. The joints of skeleton i start at
+  jointQuats + i * JOINTQUAT_SOA_COMPONENTS * stride. Joint 0 is the root.
+============
+*/
+void VPCALL idSIMD_Generic::TransformJointsSoA( idJointMat * const *jointMats, const float *jointQuats, const int numSkeletons, const int *parents, const int numJoints ) {
+	int i, j;
+	int stride = JointQuatSoAStride( numJoints );
+
+	for ( i = 0; i < numSkeletons; i++ ) {
+		const float *q = jointQuats + i * JOINTQUAT_SOA_COMPONENTS * stride;
+		idJointMat *mats = jointMats[i];
+
+		for ( j = 0; j < numJoints; j++ ) {
+			idQuat jq( q[0 * stride + j], q[1 * stride + j], q[2 * stride + j], q[3 * stride + j] );
+			mats[j].SetRotation( jq.ToMat3() );
+			mats[j].SetTranslation( idVec3( q[4 * stride + j], q[5 * stride + j], q[6 * stride + j] ) );
+		}
+		for ( j = 1; j < numJoints; j++ ) {
+			assert( parents[j] < j );
+			mats[j] *= mats[parents[j]];
+		}
+	}
+}
+
 /*
 ============
 idSIMD_Generic::TracePointCull
@@ -2499,7 +2567,7 @@ void VPCALL idSIMD_Generic::DeriveTangents( idPlane *planes, idDrawVert *verts,
 	idPlane *planesPtr = planes;
 	for ( i = 0; i < numIndexes; i += 3 ) {
 		idDrawVert *a, *b, *c;
-		unsigned long signBit;
+		unsigned int signBit;
 		float d0[5], d1[5], f, area;
 		idVec3 n, t0, t1;
 
@@ -2540,7 +2608,7 @@ void VPCALL idSIMD_Generic::DeriveTangents( idPlane *planes, idDrawVert *verts,
 
 		// area sign bit
 		area = d0[3] * d1[4] - d0[4] * d1[3];
-		signBit = ( *(unsigned long *)&area ) & ( 1 << 31 );
+		signBit = ( *(unsigned int *)&area ) & ( 1 << 31 );
 
 		// first tangent
 		t0[0] = d0[0] * d1[4] - d0[4] * d1[0];
@@ -2548,7 +2616,7 @@ void VPCALL idSIMD_Generic::DeriveTangents( idPlane *planes, idDrawVert *verts,
 		t0[2] = d0[2] * d1[4] - d0[4] * d1[2];
 
 		f = idMath::RSqrt( t0.x * t0.x + t0.y * t0.y + t0.z * t0.z );
-		*(unsigned long *)&f ^= signBit;
+		*(unsigned int *)&f ^= signBit;
 
 		t0.x *= f;
 		t0.y *= f;
@@ -2560,7 +2628,7 @@ void VPCALL idSIMD_Generic::DeriveTangents( idPlane *planes, idDrawVert *verts,
 		t1[2] = d0[3] * d1[2] - d0[2] * d1[3];
 
 		f = idMath::RSqrt( t1.x * t1.x + t1.y * t1.y + t1.z * t1.z );
-		*(unsigned long *)&f ^= signBit;
+		*(unsigned int *)&f ^= signBit;
 
 		t1.x *= f;
 		t1.y *= f;
@@ -364,4 +364,15 @@ loop2:
 	}
 }
 
-#endif /* _WIN32 */
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+
+/*
+============
+idSIMD_MMX::GetName
+============
+*/
+const char * idSIMD_MMX::GetName( void ) const {
+	return "MMX";
+}
+
+#endif /* ID_SIMD_SSE_INTRINSICS */
@@ -48,6 +48,9 @@ public:
 	virtual void VPCALL Memcpy( void *dst,			const void *src,		const int count );
 	virtual void VPCALL Memset( void *dst,			const int val,			const int count );
 
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+	virtual const char * VPCALL GetName( void ) const;
+
 #endif
 };
 
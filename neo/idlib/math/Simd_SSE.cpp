@@ -18084,4 +18084,3420 @@ void VPCALL idSIMD_SSE::MixedSoundToSamples( short *samples, const float *mixBuf
 #endif
 }
 
-#endif /* _WIN32 */
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+
+/*
+===============================================================================
+
+	GCC/Clang intrinsics port of the SSE code paths.
+
+	Every routine evaluates exactly the same floating point operations in exactly
+	the same order as idSIMD_Generic so the results are bit-identical. Whenever the
+	generic code accumulates in double precision the SSE2 double instructions are
+	used, and whenever the generic code uses a lookup table or branches per element
+	the affected lanes are evaluated with the scalar idMath routines.
+
+===============================================================================
+*/
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+#define R_SHUFFLEPS( x, y, z, w )	(( (w) & 3 ) << 6 | ( (z) & 3 ) << 4 | ( (y) & 3 ) << 2 | ( (x) & 3 ))
+
+#define DRAWVERT_XYZ_OFFSET			(0*4)
+#define DRAWVERT_ST_OFFSET			(3*4)
+#define DRAWVERT_NORMAL_OFFSET		(5*4)
+#define DRAWVERT_TANGENT0_OFFSET	(8*4)
+#define DRAWVERT_TANGENT1_OFFSET	(11*4)
+
+#define JOINTQUAT_SIZE				(7*4)
+
+/*
+============
+SSE_Select
+
+  returns mask ? b : a for each lane
+============
+*/
+static ID_INLINE __m128 SSE_Select( const __m128 a, const __m128 b, const __m128 mask ) {
+	return _mm_or_ps( _mm_and_ps( mask, b ), _mm_andnot_ps( mask, a ) );
+}
+
+/*
+============
+SSE_SignBit
+============
+*/
+static ID_INLINE __m128 SSE_SignBit( void ) {
+	return _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) );
+}
+
+/*
+============
+SSE_LoadVec3
+
+  loads x, y, z without reading past the end of the vector, w is set to zero
+============
+*/
+static ID_INLINE __m128 SSE_LoadVec3( const float *p ) {
+	__m128 xy = _mm_castpd_ps( _mm_load_sd( (const double *) p ) );
+	return _mm_movelh_ps( xy, _mm_load_ss( p + 2 ) );
+}
+
+/*
+============
+SSE_StoreVec3
+============
+*/
+static ID_INLINE void SSE_StoreVec3( float *p, const __m128 v ) {
+	_mm_store_sd( (double *) p, _mm_castps_pd( v ) );
+	_mm_store_ss( p + 2, _mm_movehl_ps( v, v ) );
+}
+
+/*
+============
+SSE_LoadDrawVerts
+
+  loads the four floats at the given offset of four consecutive idDrawVerts and transposes them
+============
+*/
+static ID_INLINE void SSE_LoadDrawVerts( const idDrawVert *verts, const int offset, __m128 &x, __m128 &y, __m128 &z, __m128 &w ) {
+	const byte *p = (const byte *) verts + offset;
+	x = _mm_loadu_ps( (const float *) ( p + 0 * sizeof( idDrawVert ) ) );
+	y = _mm_loadu_ps( (const float *) ( p + 1 * sizeof( idDrawVert ) ) );
+	z = _mm_loadu_ps( (const float *) ( p + 2 * sizeof( idDrawVert ) ) );
+	w = _mm_loadu_ps( (const float *) ( p + 3 * sizeof( idDrawVert ) ) );
+	_MM_TRANSPOSE4_PS( x, y, z, w );
+}
+
+/*
+============
+SSE_LoadVec3s
+
+  loads four consecutive idVec3 and transposes them
+============
+*/
+static ID_INLINE void SSE_LoadVec3s( const idVec3 *src, __m128 &x, __m128 &y, __m128 &z ) {
+	const float *p = src->ToFloatPtr();
+	__m128 w;
+	x = _mm_loadu_ps( p + 0 );
+	y = _mm_loadu_ps( p + 3 );
+	z = _mm_loadu_ps( p + 6 );
+	w = SSE_LoadVec3( p + 9 );
+	_MM_TRANSPOSE4_PS( x, y, z, w );
+}
+
+/*
+============
+SSE_Dot3
+
+  ( x0 * x1 + y0 * y1 ) + z0 * z1 like idVec3::operator*
+============
+*/
+static ID_INLINE __m128 SSE_Dot3( const __m128 x0, const __m128 y0, const __m128 z0, const __m128 x1, const __m128 y1, const __m128 z1 ) {
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( x0, x1 ), _mm_mul_ps( y0, y1 ) ), _mm_mul_ps( z0, z1 ) );
+}
+
+/*
+============
+SSE_RSqrt
+
+  same bit trick and single Newton-Raphson step as idMath::RSqrt
+============
+*/
+static ID_INLINE __m128 SSE_RSqrt( const __m128 x ) {
+	__m128 y = _mm_mul_ps( x, _mm_set1_ps( 0.5f ) );
+	__m128i i = _mm_sub_epi32( _mm_set1_epi32( 0x5f3759df ), _mm_srai_epi32( _mm_castps_si128( x ), 1 ) );
+	__m128 r = _mm_castsi128_ps( i );
+	return _mm_mul_ps( r, _mm_sub_ps( _mm_set1_ps( 1.5f ), _mm_mul_ps( _mm_mul_ps( r, r ), y ) ) );
+}
+
+/*
+============
+SSE_FloatBits
+============
+*/
+static ID_INLINE unsigned int SSE_FloatBits( const float f ) {
+	union { float f; unsigned int i; } u;
+	u.f = f;
+	return u.i;
+}
+
+/*
+============
+SSE_BitsFloat
+============
+*/
+static ID_INLINE float SSE_BitsFloat( const unsigned int i ) {
+	union { float f; unsigned int i; } u;
+	u.i = i;
+	return u.f;
+}
+
+/*
+============
+SSE_SignBits
+
+  returns the sign bit of each lane shifted to the given bit position
+============
+*/
+static ID_INLINE __m128i SSE_SignBits( const __m128 v, const int bit ) {
+	return _mm_slli_epi32( _mm_srli_epi32( _mm_castps_si128( v ), 31 ), bit );
+}
+
+/*
+============
+SSE_StoreBytes
+
+  stores the low byte of each of the four lanes
+============
+*/
+static ID_INLINE void SSE_StoreBytes( byte *dst, const __m128i bits ) {
+	__m128i b = _mm_packus_epi16( _mm_packs_epi32( bits, bits ), _mm_setzero_si128() );
+	*(int *) dst = _mm_cvtsi128_si32( b );
+}
+
+/*
+============
+SSE_DotDouble
+
+  dot product of n >= 4 floats with the four double accumulators of idSIMD_Generic::Dot
+============
+*/
+static double SSE_DotDouble( const float *src1, const float *src2, const int n ) {
+	__m128 p;
+	__m128d s01, s23;
+	double s[4], sum;
+	int i;
+
+	p = _mm_mul_ps( _mm_loadu_ps( src1 ), _mm_loadu_ps( src2 ) );
+	s01 = _mm_cvtps_pd( p );
+	s23 = _mm_cvtps_pd( _mm_movehl_ps( p, p ) );
+	for ( i = 4; i < n-7; i += 8 ) {
+		p = _mm_mul_ps( _mm_loadu_ps( src1 + i + 0 ), _mm_loadu_ps( src2 + i + 0 ) );
+		s01 = _mm_add_pd( s01, _mm_cvtps_pd( p ) );
+		s23 = _mm_add_pd( s23, _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) );
+		p = _mm_mul_ps( _mm_loadu_ps( src1 + i + 4 ), _mm_loadu_ps( src2 + i + 4 ) );
+		s01 = _mm_add_pd( s01, _mm_cvtps_pd( p ) );
+		s23 = _mm_add_pd( s23, _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) );
+	}
+	_mm_storeu_pd( s + 0, s01 );
+	_mm_storeu_pd( s + 2, s23 );
+	switch( n - i ) {
+		case 7: s[0] += src1[i+6] * src2[i+6];
+		case 6: s[1] += src1[i+5] * src2[i+5];
+		case 5: s[2] += src1[i+4] * src2[i+4];
+		case 4: s[3] += src1[i+3] * src2[i+3];
+		case 3: s[0] += src1[i+2] * src2[i+2];
+		case 2: s[1] += src1[i+1] * src2[i+1];
+		case 1: s[2] += src1[i+0] * src2[i+0];
+		case 0: break;
+	}
+	sum = s[3];
+	sum += s[2];
+	sum += s[1];
+	sum += s[0];
+	return sum;
+}
+
+/*
+============
+idSIMD_SSE::GetName
+============
+*/
+const char * idSIMD_SSE::GetName( void ) const {
+	return "MMX & SSE";
+}
+
+/*
+============
+idSIMD_SSE::Add
+
+  dst[i] = constant + src[i];
+============
+*/
+void VPCALL idSIMD_SSE::Add( float *dst, const float constant, const float *src, const int count ) {
+	__m128 c = _mm_set1_ps( constant );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( src + i ), c ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src[i] + constant;
+	}
+}
+
+/*
+============
+idSIMD_SSE::Add
+
+  dst[i] = src0[i] + src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::Add( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( src0 + i ), _mm_loadu_ps( src1 + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] + src1[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Sub
+
+  dst[i] = constant - src[i];
+
+  a single double precision operation on float operands rounds to the same float
+  as the single precision operation, so the double constant of the generic code is not needed
+============
+*/
+void VPCALL idSIMD_SSE::Sub( float *dst, const float constant, const float *src, const int count ) {
+	__m128 c = _mm_set1_ps( constant );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_sub_ps( c, _mm_loadu_ps( src + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant - src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Sub
+
+  dst[i] = src0[i] - src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::Sub( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_sub_ps( _mm_loadu_ps( src0 + i ), _mm_loadu_ps( src1 + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] - src1[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Mul
+
+  dst[i] = constant * src[i];
+============
+*/
+void VPCALL idSIMD_SSE::Mul( float *dst, const float constant, const float *src, const int count ) {
+	__m128 c = _mm_set1_ps( constant );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_mul_ps( c, _mm_loadu_ps( src + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant * src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Mul
+
+  dst[i] = src0[i] * src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::Mul( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_mul_ps( _mm_loadu_ps( src0 + i ), _mm_loadu_ps( src1 + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Div
+
+  dst[i] = constant / src[i];
+============
+*/
+void VPCALL idSIMD_SSE::Div( float *dst, const float constant, const float *src, const int count ) {
+	__m128 c = _mm_set1_ps( constant );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_div_ps( c, _mm_loadu_ps( src + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant / src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Div
+
+  dst[i] = src0[i] / src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::Div( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_div_ps( _mm_loadu_ps( src0 + i ), _mm_loadu_ps( src1 + i ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] / src1[i];
+	}
+}
+
+/*
+============
+SSE_MulAddDouble
+
+  dst[i] += constant * src[i] evaluated in double precision like the generic code
+============
+*/
+static void SSE_MulAddDouble( float *dst, const double constant, const float *src, const int count ) {
+	__m128d c = _mm_set1_pd( constant );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 d = _mm_loadu_ps( dst + i );
+		__m128 s = _mm_loadu_ps( src + i );
+		__m128d lo = _mm_add_pd( _mm_cvtps_pd( d ), _mm_mul_pd( c, _mm_cvtps_pd( s ) ) );
+		__m128d hi = _mm_add_pd( _mm_cvtps_pd( _mm_movehl_ps( d, d ) ), _mm_mul_pd( c, _mm_cvtps_pd( _mm_movehl_ps( s, s ) ) ) );
+		_mm_storeu_ps( dst + i, _mm_movelh_ps( _mm_cvtpd_ps( lo ), _mm_cvtpd_ps( hi ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] += constant * src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::MulAdd
+
+  dst[i] += constant * src[i];
+============
+*/
+void VPCALL idSIMD_SSE::MulAdd( float *dst, const float constant, const float *src, const int count ) {
+	SSE_MulAddDouble( dst, constant, src, count );
+}
+
+/*
+============
+idSIMD_SSE::MulAdd
+
+  dst[i] += src0[i] * src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::MulAdd( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 p = _mm_mul_ps( _mm_loadu_ps( src0 + i ), _mm_loadu_ps( src1 + i ) );
+		_mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( dst + i ), p ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] += src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::MulSub
+
+  dst[i] -= constant * src[i];
+============
+*/
+void VPCALL idSIMD_SSE::MulSub( float *dst, const float constant, const float *src, const int count ) {
+	// dst + (-c) * src is the exact same operation as dst - c * src
+	SSE_MulAddDouble( dst, -(double)constant, src, count );
+}
+
+/*
+============
+idSIMD_SSE::MulSub
+
+  dst[i] -= src0[i] * src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::MulSub( float *dst, const float *src0, const float *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 p = _mm_mul_ps( _mm_loadu_ps( src0 + i ), _mm_loadu_ps( src1 + i ) );
+		_mm_storeu_ps( dst + i, _mm_sub_ps( _mm_loadu_ps( dst + i ), p ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] -= src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant * src[i];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idVec3 &constant, const idVec3 *src, const int count ) {
+	__m128 cx = _mm_set1_ps( constant.x );
+	__m128 cy = _mm_set1_ps( constant.y );
+	__m128 cz = _mm_set1_ps( constant.z );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		SSE_LoadVec3s( src + i, x, y, z );
+		_mm_storeu_ps( dst + i, SSE_Dot3( cx, cy, cz, x, y, z ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant * src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant * src[i].Normal() + src[i][3];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idVec3 &constant, const idPlane *src, const int count ) {
+	__m128 cx = _mm_set1_ps( constant.x );
+	__m128 cy = _mm_set1_ps( constant.y );
+	__m128 cz = _mm_set1_ps( constant.z );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x = _mm_loadu_ps( src[i+0].ToFloatPtr() );
+		__m128 y = _mm_loadu_ps( src[i+1].ToFloatPtr() );
+		__m128 z = _mm_loadu_ps( src[i+2].ToFloatPtr() );
+		__m128 w = _mm_loadu_ps( src[i+3].ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+		_mm_storeu_ps( dst + i, _mm_add_ps( SSE_Dot3( cx, cy, cz, x, y, z ), w ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant * src[i].Normal() + src[i][3];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant * src[i].xyz;
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idVec3 &constant, const idDrawVert *src, const int count ) {
+	__m128 cx = _mm_set1_ps( constant.x );
+	__m128 cy = _mm_set1_ps( constant.y );
+	__m128 cz = _mm_set1_ps( constant.z );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z, w;
+		SSE_LoadDrawVerts( src + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		_mm_storeu_ps( dst + i, SSE_Dot3( cx, cy, cz, x, y, z ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant * src[i].xyz;
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant.Normal() * src[i] + constant[3];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idPlane &constant, const idVec3 *src, const int count ) {
+	__m128 cx = _mm_set1_ps( constant[0] );
+	__m128 cy = _mm_set1_ps( constant[1] );
+	__m128 cz = _mm_set1_ps( constant[2] );
+	__m128 cw = _mm_set1_ps( constant[3] );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z;
+		SSE_LoadVec3s( src + i, x, y, z );
+		_mm_storeu_ps( dst + i, _mm_add_ps( SSE_Dot3( cx, cy, cz, x, y, z ), cw ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant.Normal() * src[i] + constant[3];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant.Normal() * src[i].Normal() + constant[3] * src[i][3];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idPlane &constant, const idPlane *src, const int count ) {
+	__m128 cx = _mm_set1_ps( constant[0] );
+	__m128 cy = _mm_set1_ps( constant[1] );
+	__m128 cz = _mm_set1_ps( constant[2] );
+	__m128 cw = _mm_set1_ps( constant[3] );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x = _mm_loadu_ps( src[i+0].ToFloatPtr() );
+		__m128 y = _mm_loadu_ps( src[i+1].ToFloatPtr() );
+		__m128 z = _mm_loadu_ps( src[i+2].ToFloatPtr() );
+		__m128 w = _mm_loadu_ps( src[i+3].ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+		_mm_storeu_ps( dst + i, _mm_add_ps( SSE_Dot3( cx, cy, cz, x, y, z ), _mm_mul_ps( cw, w ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant.Normal() * src[i].Normal() + constant[3] * src[i][3];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = constant.Normal() * src[i].xyz + constant[3];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idPlane &constant, const idDrawVert *src, const int count ) {
+	__m128 cx = _mm_set1_ps( constant[0] );
+	__m128 cy = _mm_set1_ps( constant[1] );
+	__m128 cz = _mm_set1_ps( constant[2] );
+	__m128 cw = _mm_set1_ps( constant[3] );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x, y, z, w;
+		SSE_LoadDrawVerts( src + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		_mm_storeu_ps( dst + i, _mm_add_ps( SSE_Dot3( cx, cy, cz, x, y, z ), cw ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = constant.Normal() * src[i].xyz + constant[3];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dst[i] = src0[i] * src1[i];
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float *dst, const idVec3 *src0, const idVec3 *src1, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 x0, y0, z0, x1, y1, z1;
+		SSE_LoadVec3s( src0 + i, x0, y0, z0 );
+		SSE_LoadVec3s( src1 + i, x1, y1, z1 );
+		_mm_storeu_ps( dst + i, SSE_Dot3( x0, y0, z0, x1, y1, z1 ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src0[i] * src1[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Dot
+
+  dot = src1[0] * src2[0] + src1[1] * src2[1] + src1[2] * src2[2] + ...
+============
+*/
+void VPCALL idSIMD_SSE::Dot( float &dot, const float *src1, const float *src2, const int count ) {
+	switch( count ) {
+		case 0:
+			dot = 0.0f;
+			return;
+		case 1:
+			dot = src1[0] * src2[0];
+			return;
+		case 2:
+			dot = src1[0] * src2[0] + src1[1] * src2[1];
+			return;
+		case 3:
+			dot = src1[0] * src2[0] + src1[1] * src2[1] + src1[2] * src2[2];
+			return;
+		default:
+			dot = SSE_DotDouble( src1, src2, count );
+			return;
+	}
+}
+
+/*
+============
+SSE_CmpToBytes
+
+  writes the compare masks of 16 floats as 0 or 1 bytes, or ors them in at the given bit
+============
+*/
+static ID_INLINE void SSE_CmpToBytes( byte *dst, const __m128 m0, const __m128 m1, const __m128 m2, const __m128 m3, const __m128i bit, const bool merge ) {
+	__m128i lo = _mm_packs_epi32( _mm_castps_si128( m0 ), _mm_castps_si128( m1 ) );
+	__m128i hi = _mm_packs_epi32( _mm_castps_si128( m2 ), _mm_castps_si128( m3 ) );
+	__m128i b = _mm_and_si128( _mm_packs_epi16( lo, hi ), bit );
+	if ( merge ) {
+		b = _mm_or_si128( b, _mm_loadu_si128( (const __m128i *) dst ) );
+	}
+	_mm_storeu_si128( (__m128i *) dst, b );
+}
+
+#define SSE_CMP_LOOP( CMPPS, OP, MERGE )														\
+	__m128 c = _mm_set1_ps( constant );															\
+	__m128i bit = _mm_set1_epi8( (char)( MERGE ? ( 1 << bitNum ) : 1 ) );						\
+	int i;																						\
+	for ( i = 0; i + 16 <= count; i += 16 ) {													\
+		SSE_CmpToBytes( dst + i,	CMPPS( _mm_loadu_ps( src0 + i +  0 ), c ),					\
+									CMPPS( _mm_loadu_ps( src0 + i +  4 ), c ),					\
+									CMPPS( _mm_loadu_ps( src0 + i +  8 ), c ),					\
+									CMPPS( _mm_loadu_ps( src0 + i + 12 ), c ), bit, MERGE );	\
+	}																							\
+	for ( ; i < count; i++ ) {																	\
+		if ( MERGE ) {																			\
+			dst[i] |= ( src0[i] OP constant ) << bitNum;										\
+		} else {																				\
+			dst[i] = src0[i] OP constant;														\
+		}																						\
+	}
+
+/*
+============
+idSIMD_SSE::CmpGT
+
+  dst[i] = src0[i] > constant;
+============
+*/
+void VPCALL idSIMD_SSE::CmpGT( byte *dst, const float *src0, const float constant, const int count ) {
+	const int bitNum = 0;
+	SSE_CMP_LOOP( _mm_cmpgt_ps, >, false )
+}
+
+/*
+============
+idSIMD_SSE::CmpGT
+
+  dst[i] |= ( src0[i] > constant ) << bitNum;
+============
+*/
+void VPCALL idSIMD_SSE::CmpGT( byte *dst, const byte bitNum, const float *src0, const float constant, const int count ) {
+	SSE_CMP_LOOP( _mm_cmpgt_ps, >, true )
+}
+
+/*
+============
+idSIMD_SSE::CmpGE
+
+  dst[i] = src0[i] >= constant;
+============
+*/
+void VPCALL idSIMD_SSE::CmpGE( byte *dst, const float *src0, const float constant, const int count ) {
+	const int bitNum = 0;
+	SSE_CMP_LOOP( _mm_cmpge_ps, >=, false )
+}
+
+/*
+============
+idSIMD_SSE::CmpGE
+
+  dst[i] |= ( src0[i] >= constant ) << bitNum;
+============
+*/
+void VPCALL idSIMD_SSE::CmpGE( byte *dst, const byte bitNum, const float *src0, const float constant, const int count ) {
+	SSE_CMP_LOOP( _mm_cmpge_ps, >=, true )
+}
+
+/*
+============
+idSIMD_SSE::CmpLT
+
+  dst[i] = src0[i] < constant;
+============
+*/
+void VPCALL idSIMD_SSE::CmpLT( byte *dst, const float *src0, const float constant, const int count ) {
+	const int bitNum = 0;
+	SSE_CMP_LOOP( _mm_cmplt_ps, <, false )
+}
+
+/*
+============
+idSIMD_SSE::CmpLT
+
+  dst[i] |= ( src0[i] < constant ) << bitNum;
+============
+*/
+void VPCALL idSIMD_SSE::CmpLT( byte *dst, const byte bitNum, const float *src0, const float constant, const int count ) {
+	SSE_CMP_LOOP( _mm_cmplt_ps, <, true )
+}
+
+/*
+============
+idSIMD_SSE::CmpLE
+
+  dst[i] = src0[i] <= constant;
+============
+*/
+void VPCALL idSIMD_SSE::CmpLE( byte *dst, const float *src0, const float constant, const int count ) {
+	const int bitNum = 0;
+	SSE_CMP_LOOP( _mm_cmple_ps, <=, false )
+}
+
+/*
+============
+idSIMD_SSE::CmpLE
+
+  dst[i] |= ( src0[i] <= constant ) << bitNum;
+============
+*/
+void VPCALL idSIMD_SSE::CmpLE( byte *dst, const byte bitNum, const float *src0, const float constant, const int count ) {
+	SSE_CMP_LOOP( _mm_cmple_ps, <=, true )
+}
+
+#undef SSE_CMP_LOOP
+
+/*
+============
+SSE_FirstEqual
+
+  The generic code keeps the first of several values that compare equal. The only
+  values that compare equal but differ in their bits are +0 and -0 so when lanes are
+  merged and the result is zero the first zero in the source determines the sign.
+============
+*/
+static ID_INLINE float SSE_FirstEqual( const float value, const float *src, const int stride, const int count ) {
+	if ( value != 0.0f ) {
+		return value;
+	}
+	for ( int i = 0; i < count; i++ ) {
+		if ( src[i*stride] == 0.0f ) {
+			return src[i*stride];
+		}
+	}
+	return value;
+}
+
+/*
+============
+idSIMD_SSE::MinMax
+============
+*/
+void VPCALL idSIMD_SSE::MinMax( float &min, float &max, const float *src, const int count ) {
+	__m128 vmin = _mm_set1_ps( idMath::INFINITY );
+	__m128 vmax = _mm_set1_ps( -idMath::INFINITY );
+	float lmin[4], lmax[4];
+	int i;
+
+	// each lane keeps the first smallest and largest value like the generic code
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 v = _mm_loadu_ps( src + i );
+		vmin = _mm_min_ps( v, vmin );
+		vmax = _mm_max_ps( v, vmax );
+	}
+	_mm_storeu_ps( lmin, vmin );
+	_mm_storeu_ps( lmax, vmax );
+	min = idMath::INFINITY;
+	max = -idMath::INFINITY;
+	for ( int j = 0; j < 4; j++ ) {
+		if ( lmin[j] < min ) {
+			min = lmin[j];
+		}
+		if ( lmax[j] > max ) {
+			max = lmax[j];
+		}
+	}
+	for ( ; i < count; i++ ) {
+		if ( src[i] < min ) {
+			min = src[i];
+		}
+		if ( src[i] > max ) {
+			max = src[i];
+		}
+	}
+	min = SSE_FirstEqual( min, src, 1, count );
+	max = SSE_FirstEqual( max, src, 1, count );
+}
+
+/*
+============
+idSIMD_SSE::MinMax
+============
+*/
+void VPCALL idSIMD_SSE::MinMax( idVec2 &min, idVec2 &max, const idVec2 *src, const int count ) {
+	const float *ptr = src->ToFloatPtr();
+	__m128 vmin = _mm_set1_ps( idMath::INFINITY );
+	__m128 vmax = _mm_set1_ps( -idMath::INFINITY );
+	float lmin[4], lmax[4];
+	int i;
+
+	for ( i = 0; i + 2 <= count; i += 2 ) {
+		__m128 v = _mm_loadu_ps( ptr + i * 2 );
+		vmin = _mm_min_ps( v, vmin );
+		vmax = _mm_max_ps( v, vmax );
+	}
+	_mm_storeu_ps( lmin, vmin );
+	_mm_storeu_ps( lmax, vmax );
+	for ( int j = 0; j < 2; j++ ) {
+		min[j] = lmin[j];
+		max[j] = lmax[j];
+		if ( lmin[j+2] < min[j] ) {
+			min[j] = lmin[j+2];
+		}
+		if ( lmax[j+2] > max[j] ) {
+			max[j] = lmax[j+2];
+		}
+	}
+	for ( ; i < count; i++ ) {
+		const idVec2 &v = src[i];
+		if ( v[0] < min[0] ) { min[0] = v[0]; } if ( v[0] > max[0] ) { max[0] = v[0]; }
+		if ( v[1] < min[1] ) { min[1] = v[1]; } if ( v[1] > max[1] ) { max[1] = v[1]; }
+	}
+	for ( int j = 0; j < 2; j++ ) {
+		min[j] = SSE_FirstEqual( min[j], ptr + j, 2, count );
+		max[j] = SSE_FirstEqual( max[j], ptr + j, 2, count );
+	}
+}
+
+/*
+============
+SSE_StoreMinMax3
+============
+*/
+static ID_INLINE void SSE_StoreMinMax3( idVec3 &min, idVec3 &max, const __m128 vmin, const __m128 vmax ) {
+	SSE_StoreVec3( min.ToFloatPtr(), vmin );
+	SSE_StoreVec3( max.ToFloatPtr(), vmax );
+}
+
+/*
+============
+idSIMD_SSE::MinMax
+
+  a single vector holds x, y and z so every component is processed in source order
+============
+*/
+void VPCALL idSIMD_SSE::MinMax( idVec3 &min, idVec3 &max, const idVec3 *src, const int count ) {
+	__m128 vmin = _mm_set1_ps( idMath::INFINITY );
+	__m128 vmax = _mm_set1_ps( -idMath::INFINITY );
+	int i;
+	for ( i = 0; i < count - 1; i++ ) {
+		__m128 v = _mm_loadu_ps( src[i].ToFloatPtr() );
+		vmin = _mm_min_ps( v, vmin );
+		vmax = _mm_max_ps( v, vmax );
+	}
+	if ( i < count ) {
+		__m128 v = SSE_LoadVec3( src[i].ToFloatPtr() );
+		vmin = _mm_min_ps( v, vmin );
+		vmax = _mm_max_ps( v, vmax );
+	}
+	SSE_StoreMinMax3( min, max, vmin, vmax );
+}
+
+/*
+============
+idSIMD_SSE::MinMax
+============
+*/
+void VPCALL idSIMD_SSE::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int count ) {
+	__m128 vmin = _mm_set1_ps( idMath::INFINITY );
+	__m128 vmax = _mm_set1_ps( -idMath::INFINITY );
+	for ( int i = 0; i < count; i++ ) {
+		__m128 v = _mm_loadu_ps( src[i].xyz.ToFloatPtr() );
+		vmin = _mm_min_ps( v, vmin );
+		vmax = _mm_max_ps( v, vmax );
+	}
+	SSE_StoreMinMax3( min, max, vmin, vmax );
+}
+
+/*
+============
+idSIMD_SSE::MinMax
+============
+*/
+void VPCALL idSIMD_SSE::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int *indexes, const int count ) {
+	__m128 vmin = _mm_set1_ps( idMath::INFINITY );
+	__m128 vmax = _mm_set1_ps( -idMath::INFINITY );
+	for ( int i = 0; i < count; i++ ) {
+		__m128 v = _mm_loadu_ps( src[indexes[i]].xyz.ToFloatPtr() );
+		vmin = _mm_min_ps( v, vmin );
+		vmax = _mm_max_ps( v, vmax );
+	}
+	SSE_StoreMinMax3( min, max, vmin, vmax );
+}
+
+/*
+============
+idSIMD_SSE::Clamp
+============
+*/
+void VPCALL idSIMD_SSE::Clamp( float *dst, const float *src, const float min, const float max, const int count ) {
+	__m128 vmin = _mm_set1_ps( min );
+	__m128 vmax = _mm_set1_ps( max );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 v = _mm_loadu_ps( src + i );
+		__m128 r = SSE_Select( v, vmax, _mm_cmpgt_ps( v, vmax ) );
+		_mm_storeu_ps( dst + i, SSE_Select( r, vmin, _mm_cmplt_ps( v, vmin ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src[i] < min ? min : src[i] > max ? max : src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::ClampMin
+============
+*/
+void VPCALL idSIMD_SSE::ClampMin( float *dst, const float *src, const float min, const int count ) {
+	__m128 vmin = _mm_set1_ps( min );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 v = _mm_loadu_ps( src + i );
+		_mm_storeu_ps( dst + i, SSE_Select( v, vmin, _mm_cmplt_ps( v, vmin ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src[i] < min ? min : src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::ClampMax
+============
+*/
+void VPCALL idSIMD_SSE::ClampMax( float *dst, const float *src, const float max, const int count ) {
+	__m128 vmax = _mm_set1_ps( max );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 v = _mm_loadu_ps( src + i );
+		_mm_storeu_ps( dst + i, SSE_Select( v, vmax, _mm_cmpgt_ps( v, vmax ) ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src[i] > max ? max : src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Zero16
+============
+*/
+void VPCALL idSIMD_SSE::Zero16( float *dst, const int count ) {
+	__m128 zero = _mm_setzero_ps();
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, zero );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = 0.0f;
+	}
+}
+
+/*
+============
+idSIMD_SSE::Negate16
+============
+*/
+void VPCALL idSIMD_SSE::Negate16( float *dst, const int count ) {
+	__m128 sign = SSE_SignBit();
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_xor_ps( _mm_loadu_ps( dst + i ), sign ) );
+	}
+	for ( ; i < count; i++ ) {
+		reinterpret_cast<unsigned int *>(dst)[i] ^= ( 1 << 31 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::Copy16
+============
+*/
+void VPCALL idSIMD_SSE::Copy16( float *dst, const float *src, const int count ) {
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_loadu_ps( src + i ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src[i];
+	}
+}
+
+/*
+============
+idSIMD_SSE::Add16
+============
+*/
+void VPCALL idSIMD_SSE::Add16( float *dst, const float *src1, const float *src2, const int count ) {
+	Add( dst, src1, src2, count );
+}
+
+/*
+============
+idSIMD_SSE::Sub16
+============
+*/
+void VPCALL idSIMD_SSE::Sub16( float *dst, const float *src1, const float *src2, const int count ) {
+	Sub( dst, src1, src2, count );
+}
+
+/*
+============
+idSIMD_SSE::Mul16
+============
+*/
+void VPCALL idSIMD_SSE::Mul16( float *dst, const float *src1, const float constant, const int count ) {
+	__m128 c = _mm_set1_ps( constant );
+	int i;
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( dst + i, _mm_mul_ps( _mm_loadu_ps( src1 + i ), c ) );
+	}
+	for ( ; i < count; i++ ) {
+		dst[i] = src1[i] * constant;
+	}
+}
+
+/*
+============
+idSIMD_SSE::AddAssign16
+============
+*/
+void VPCALL idSIMD_SSE::AddAssign16( float *dst, const float *src, const int count ) {
+	Add( dst, dst, src, count );
+}
+
+/*
+============
+idSIMD_SSE::SubAssign16
+============
+*/
+void VPCALL idSIMD_SSE::SubAssign16( float *dst, const float *src, const int count ) {
+	Sub( dst, dst, src, count );
+}
+
+/*
+============
+idSIMD_SSE::MulAssign16
+============
+*/
+void VPCALL idSIMD_SSE::MulAssign16( float *dst, const float constant, const int count ) {
+	Mul16( dst, dst, constant, count );
+}
+
+/*
+============
+SSE_MultiplyVecX
+
+  Four rows are processed at a time. Every lane accumulates the products of its row
+  in column order which is the same single precision sum the generic code evaluates.
+  op: 0 = dst = mat * vec, 1 = dst += mat * vec, 2 = dst -= mat * vec
+============
+*/
+static void SSE_MultiplyVecX( float *dstPtr, const idMatX &mat, const float *vPtr, const int op ) {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
+	const float *mPtr = mat.ToFloatPtr();
+	int i, j;
+
+	for ( i = 0; i + 4 <= numRows; i += 4 ) {
+		const float *m0 = mPtr + ( i + 0 ) * numColumns;
+		const float *m1 = mPtr + ( i + 1 ) * numColumns;
+		const float *m2 = mPtr + ( i + 2 ) * numColumns;
+		const float *m3 = mPtr + ( i + 3 ) * numColumns;
+		__m128 sum;
+
+		if ( numColumns >= 4 ) {
+			__m128 c0 = _mm_loadu_ps( m0 );
+			__m128 c1 = _mm_loadu_ps( m1 );
+			__m128 c2 = _mm_loadu_ps( m2 );
+			__m128 c3 = _mm_loadu_ps( m3 );
+			_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+			sum = _mm_mul_ps( c0, _mm_set1_ps( vPtr[0] ) );
+			sum = _mm_add_ps( sum, _mm_mul_ps( c1, _mm_set1_ps( vPtr[1] ) ) );
+			sum = _mm_add_ps( sum, _mm_mul_ps( c2, _mm_set1_ps( vPtr[2] ) ) );
+			sum = _mm_add_ps( sum, _mm_mul_ps( c3, _mm_set1_ps( vPtr[3] ) ) );
+			for ( j = 4; j + 4 <= numColumns; j += 4 ) {
+				c0 = _mm_loadu_ps( m0 + j );
+				c1 = _mm_loadu_ps( m1 + j );
+				c2 = _mm_loadu_ps( m2 + j );
+				c3 = _mm_loadu_ps( m3 + j );
+				_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+				sum = _mm_add_ps( sum, _mm_mul_ps( c0, _mm_set1_ps( vPtr[j+0] ) ) );
+				sum = _mm_add_ps( sum, _mm_mul_ps( c1, _mm_set1_ps( vPtr[j+1] ) ) );
+				sum = _mm_add_ps( sum, _mm_mul_ps( c2, _mm_set1_ps( vPtr[j+2] ) ) );
+				sum = _mm_add_ps( sum, _mm_mul_ps( c3, _mm_set1_ps( vPtr[j+3] ) ) );
+			}
+		} else {
+			sum = _mm_mul_ps( _mm_setr_ps( m0[0], m1[0], m2[0], m3[0] ), _mm_set1_ps( vPtr[0] ) );
+			j = 1;
+		}
+		for ( ; j < numColumns; j++ ) {
+			sum = _mm_add_ps( sum, _mm_mul_ps( _mm_setr_ps( m0[j], m1[j], m2[j], m3[j] ), _mm_set1_ps( vPtr[j] ) ) );
+		}
+
+		switch( op ) {
+			case 0: _mm_storeu_ps( dstPtr + i, sum ); break;
+			case 1: _mm_storeu_ps( dstPtr + i, _mm_add_ps( _mm_loadu_ps( dstPtr + i ), sum ) ); break;
+			case 2: _mm_storeu_ps( dstPtr + i, _mm_sub_ps( _mm_loadu_ps( dstPtr + i ), sum ) ); break;
+		}
+	}
+	for ( ; i < numRows; i++ ) {
+		const float *m = mPtr + i * numColumns;
+		float sum = m[0] * vPtr[0];
+		for ( j = 1; j < numColumns; j++ ) {
+			sum += m[j] * vPtr[j];
+		}
+		switch( op ) {
+			case 0: dstPtr[i] = sum; break;
+			case 1: dstPtr[i] += sum; break;
+			case 2: dstPtr[i] -= sum; break;
+		}
+	}
+}
+
+/*
+============
+SSE_TransposeMultiplyVecX
+
+  Four columns are processed at a time with the rows accumulated in order.
+  op: 0 = dst = mat' * vec, 1 = dst += mat' * vec, 2 = dst -= mat' * vec
+============
+*/
+static void SSE_TransposeMultiplyVecX( float *dstPtr, const idMatX &mat, const float *vPtr, const int op ) {
+	const int numRows = mat.GetNumRows();
+	const int numColumns = mat.GetNumColumns();
+	const float *mPtr = mat.ToFloatPtr();
+	int i, j;
+
+	for ( i = 0; i + 4 <= numColumns; i += 4 ) {
+		__m128 sum = _mm_mul_ps( _mm_loadu_ps( mPtr + i ), _mm_set1_ps( vPtr[0] ) );
+		for ( j = 1; j < numRows; j++ ) {
+			sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( mPtr + j * numColumns + i ), _mm_set1_ps( vPtr[j] ) ) );
+		}
+		switch( op ) {
+			case 0: _mm_storeu_ps( dstPtr + i, sum ); break;
+			case 1: _mm_storeu_ps( dstPtr + i, _mm_add_ps( _mm_loadu_ps( dstPtr + i ), sum ) ); break;
+			case 2: _mm_storeu_ps( dstPtr + i, _mm_sub_ps( _mm_loadu_ps( dstPtr + i ), sum ) ); break;
+		}
+	}
+	for ( ; i < numColumns; i++ ) {
+		float sum = mPtr[i] * vPtr[0];
+		for ( j = 1; j < numRows; j++ ) {
+			sum += mPtr[j * numColumns + i] * vPtr[j];
+		}
+		switch( op ) {
+			case 0: dstPtr[i] = sum; break;
+			case 1: dstPtr[i] += sum; break;
+			case 2: dstPtr[i] -= sum; break;
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE::MatX_MultiplyVecX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_MultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+	SSE_MultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 0 );
+}
+
+/*
+============
+idSIMD_SSE::MatX_MultiplyAddVecX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_MultiplyAddVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+	SSE_MultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 1 );
+}
+
+/*
+============
+idSIMD_SSE::MatX_MultiplySubVecX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_MultiplySubVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumColumns() );
+	assert( dst.GetSize() >= mat.GetNumRows() );
+	SSE_MultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 2 );
+}
+
+/*
+============
+idSIMD_SSE::MatX_TransposeMultiplyVecX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_TransposeMultiplyVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+	SSE_TransposeMultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 0 );
+}
+
+/*
+============
+idSIMD_SSE::MatX_TransposeMultiplyAddVecX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_TransposeMultiplyAddVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+	SSE_TransposeMultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 1 );
+}
+
+/*
+============
+idSIMD_SSE::MatX_TransposeMultiplySubVecX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_TransposeMultiplySubVecX( idVecX &dst, const idMatX &mat, const idVecX &vec ) {
+	assert( vec.GetSize() >= mat.GetNumRows() );
+	assert( dst.GetSize() >= mat.GetNumColumns() );
+	SSE_TransposeMultiplyVecX( dst.ToFloatPtr(), mat, vec.ToFloatPtr(), 2 );
+}
+
+/*
+============
+SSE_MultiplyRows
+
+  dst[j] = sum over n of a[n*aStride] * b[n*bStride+j] for j in [0, l)
+
+  The generic matrix multiplications sum in single precision when the inner dimension
+  is at most six and in double precision otherwise. Both are reproduced here with four
+  columns of the result evaluated at a time.
+============
+*/
+static void SSE_MultiplyRows( float *dst, const float *a, const int aStride, const float *b, const int bStride, const int inner, const int l ) {
+	int j, n;
+
+	if ( inner <= 6 ) {
+		for ( j = 0; j + 4 <= l; j += 4 ) {
+			__m128 sum = _mm_mul_ps( _mm_set1_ps( a[0] ), _mm_loadu_ps( b + j ) );
+			for ( n = 1; n < inner; n++ ) {
+				sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( a[n*aStride] ), _mm_loadu_ps( b + n * bStride + j ) ) );
+			}
+			_mm_storeu_ps( dst + j, sum );
+		}
+		for ( ; j < l; j++ ) {
+			float sum = a[0] * b[j];
+			for ( n = 1; n < inner; n++ ) {
+				sum += a[n*aStride] * b[n*bStride+j];
+			}
+			dst[j] = sum;
+		}
+	} else {
+		for ( j = 0; j + 4 <= l; j += 4 ) {
+			__m128 p = _mm_mul_ps( _mm_set1_ps( a[0] ), _mm_loadu_ps( b + j ) );
+			__m128d lo = _mm_cvtps_pd( p );
+			__m128d hi = _mm_cvtps_pd( _mm_movehl_ps( p, p ) );
+			for ( n = 1; n < inner; n++ ) {
+				p = _mm_mul_ps( _mm_set1_ps( a[n*aStride] ), _mm_loadu_ps( b + n * bStride + j ) );
+				lo = _mm_add_pd( lo, _mm_cvtps_pd( p ) );
+				hi = _mm_add_pd( hi, _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) );
+			}
+			_mm_storeu_ps( dst + j, _mm_movelh_ps( _mm_cvtpd_ps( lo ), _mm_cvtpd_ps( hi ) ) );
+		}
+		for ( ; j < l; j++ ) {
+			double sum = a[0] * b[j];
+			for ( n = 1; n < inner; n++ ) {
+				sum += a[n*aStride] * b[n*bStride+j];
+			}
+			dst[j] = sum;
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE::MatX_MultiplyMatX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_MultiplyMatX( idMatX &dst, const idMatX &m1, const idMatX &m2 ) {
+	int i, k, l, inner;
+	float *dstPtr;
+	const float *m1Ptr, *m2Ptr;
+
+	assert( m1.GetNumColumns() == m2.GetNumRows() );
+
+	dstPtr = dst.ToFloatPtr();
+	m1Ptr = m1.ToFloatPtr();
+	m2Ptr = m2.ToFloatPtr();
+	k = m1.GetNumRows();
+	l = m2.GetNumColumns();
+	inner = m1.GetNumColumns();
+
+	for ( i = 0; i < k; i++ ) {
+		SSE_MultiplyRows( dstPtr, m1Ptr, 1, m2Ptr, l, inner, l );
+		dstPtr += l;
+		m1Ptr += inner;
+	}
+}
+
+/*
+============
+idSIMD_SSE::MatX_TransposeMultiplyMatX
+============
+*/
+void VPCALL idSIMD_SSE::MatX_TransposeMultiplyMatX( idMatX &dst, const idMatX &m1, const idMatX &m2 ) {
+	int i, k, l, inner;
+	float *dstPtr;
+	const float *m1Ptr, *m2Ptr;
+
+	assert( m1.GetNumRows() == m2.GetNumRows() );
+
+	dstPtr = dst.ToFloatPtr();
+	m1Ptr = m1.ToFloatPtr();
+	m2Ptr = m2.ToFloatPtr();
+	k = m1.GetNumColumns();
+	l = m2.GetNumColumns();
+	inner = m1.GetNumRows();
+
+	for ( i = 0; i < k; i++ ) {
+		SSE_MultiplyRows( dstPtr, m1Ptr + i, k, m2Ptr, l, inner, l );
+		dstPtr += l;
+	}
+}
+
+/*
+============
+idSIMD_SSE::MatX_LowerTriangularSolve
+
+  solves x in Lx = b for the n * n sub-matrix of L
+  if skip > 0 the first skip elements of x are assumed to be valid already
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+============
+*/
+void VPCALL idSIMD_SSE::MatX_LowerTriangularSolve( const idMatX &L, float *x, const float *b, const int n, int skip ) {
+	int i, nc;
+	const float *lptr;
+
+	if ( skip >= n ) {
+		return;
+	}
+
+	// the unrolled small systems have nothing to vectorize
+	if ( n < 8 ) {
+		idSIMD_Generic::MatX_LowerTriangularSolve( L, x, b, n, skip );
+		return;
+	}
+
+	lptr = L.ToFloatPtr();
+	nc = L.GetNumColumns();
+
+	// process first 4 rows
+	switch( skip ) {
+		case 0: x[0] = b[0];
+		case 1: x[1] = b[1] - lptr[1*nc+0] * x[0];
+		case 2: x[2] = b[2] - lptr[2*nc+0] * x[0] - lptr[2*nc+1] * x[1];
+		case 3: x[3] = b[3] - lptr[3*nc+0] * x[0] - lptr[3*nc+1] * x[1] - lptr[3*nc+2] * x[2];
+				skip = 4;
+	}
+
+	lptr = L[skip];
+
+	for ( i = skip; i < n; i++ ) {
+		double sum = SSE_DotDouble( lptr, x, i );
+		sum -= b[i];
+		x[i] = -sum;
+		lptr += nc;
+	}
+}
+
+/*
+============
+idSIMD_SSE::MatX_LowerTriangularSolveTranspose
+
+  solves x in L'x = b for the n * n sub-matrix of L
+  L has to be a lower triangular matrix with (implicit) ones on the diagonal
+  x == b is allowed
+============
+*/
+void VPCALL idSIMD_SSE::MatX_LowerTriangularSolveTranspose( const idMatX &L, float *x, const float *b, const int n ) {
+	int i, j, nc;
+	const float *lptr;
+	float *xptr;
+	double s[4];
+
+	if ( n < 8 ) {
+		idSIMD_Generic::MatX_LowerTriangularSolveTranspose( L, x, b, n );
+		return;
+	}
+
+	nc = L.GetNumColumns();
+	lptr = L.ToFloatPtr() + n * nc + n - 4;
+	xptr = x + n;
+
+	// process 4 rows at a time
+	for ( i = n; i >= 4; i -= 4 ) {
+		__m128d s01 = _mm_cvtps_pd( _mm_castpd_ps( _mm_load_sd( (const double *) ( b + i - 4 ) ) ) );
+		__m128d s23 = _mm_cvtps_pd( _mm_castpd_ps( _mm_load_sd( (const double *) ( b + i - 2 ) ) ) );
+
+		// process 4x4 blocks
+		for ( j = 0; j < n-i; j++ ) {
+			__m128 p = _mm_mul_ps( _mm_loadu_ps( lptr + j * nc ), _mm_set1_ps( xptr[j] ) );
+			s01 = _mm_sub_pd( s01, _mm_cvtps_pd( p ) );
+			s23 = _mm_sub_pd( s23, _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) );
+		}
+		_mm_storeu_pd( s + 0, s01 );
+		_mm_storeu_pd( s + 2, s23 );
+
+		// process left over of the 4 rows
+		s[0] -= lptr[0-1*nc] * s[3];
+		s[1] -= lptr[1-1*nc] * s[3];
+		s[2] -= lptr[2-1*nc] * s[3];
+		s[0] -= lptr[0-2*nc] * s[2];
+		s[1] -= lptr[1-2*nc] * s[2];
+		s[0] -= lptr[0-3*nc] * s[1];
+		// store result
+		xptr[-4] = s[0];
+		xptr[-3] = s[1];
+		xptr[-2] = s[2];
+		xptr[-1] = s[3];
+		// update pointers for next four rows
+		lptr -= 4 + 4 * nc;
+		xptr -= 4;
+	}
+	// process left over rows
+	for ( i--; i >= 0; i-- ) {
+		double s0 = b[i];
+		lptr = L[0] + i;
+		for ( j = i + 1; j < n; j++ ) {
+			s0 -= lptr[j*nc] * x[j];
+		}
+		x[i] = s0;
+	}
+}
+
+/*
+============
+idSIMD_SSE::MatX_LDLTFactor
+
+  in-place factorization LDL' of the n * n sub-matrix of mat
+  the reciprocal of the diagonal elements are stored in invDiag
+============
+*/
+bool VPCALL idSIMD_SSE::MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const int n ) {
+	int i, j, k, nc;
+	float *v, *diag, *mptr;
+	double s0, s1, s2, sum, d;
+
+	if ( n < 5 ) {
+		return idSIMD_Generic::MatX_LDLTFactor( mat, invDiag, n );
+	}
+
+	v = (float *) _alloca16( n * sizeof( float ) );
+	diag = (float *) _alloca16( n * sizeof( float ) );
+
+	nc = mat.GetNumColumns();
+
+	mptr = mat[0];
+
+	sum = mptr[0];
+
+	if ( sum == 0.0f ) {
+		return false;
+	}
+
+	diag[0] = sum;
+	invDiag[0] = d = 1.0f / sum;
+
+	mptr = mat[0];
+	for ( j = 1; j < n; j++ ) {
+		mptr[j*nc+0] = ( mptr[j*nc+0] ) * d;
+	}
+
+	mptr = mat[1];
+
+	v[0] = diag[0] * mptr[0]; s0 = v[0] * mptr[0];
+	sum = mptr[1] - s0;
+
+	if ( sum == 0.0f ) {
+		return false;
+	}
+
+	mat[1][1] = sum;
+	diag[1] = sum;
+	invDiag[1] = d = 1.0f / sum;
+
+	mptr = mat[0];
+	for ( j = 2; j < n; j++ ) {
+		mptr[j*nc+1] = ( mptr[j*nc+1] - v[0] * mptr[j*nc+0] ) * d;
+	}
+
+	mptr = mat[2];
+
+	v[0] = diag[0] * mptr[0]; s0 = v[0] * mptr[0];
+	v[1] = diag[1] * mptr[1]; s1 = v[1] * mptr[1];
+	sum = mptr[2] - s0 - s1;
+
+	if ( sum == 0.0f ) {
+		return false;
+	}
+
+	mat[2][2] = sum;
+	diag[2] = sum;
+	invDiag[2] = d = 1.0f / sum;
+
+	mptr = mat[0];
+	for ( j = 3; j < n; j++ ) {
+		mptr[j*nc+2] = ( mptr[j*nc+2] - v[0] * mptr[j*nc+0] - v[1] * mptr[j*nc+1] ) * d;
+	}
+
+	mptr = mat[3];
+
+	v[0] = diag[0] * mptr[0]; s0 = v[0] * mptr[0];
+	v[1] = diag[1] * mptr[1]; s1 = v[1] * mptr[1];
+	v[2] = diag[2] * mptr[2]; s2 = v[2] * mptr[2];
+	sum = mptr[3] - s0 - s1 - s2;
+
+	if ( sum == 0.0f ) {
+		return false;
+	}
+
+	mat[3][3] = sum;
+	diag[3] = sum;
+	invDiag[3] = d = 1.0f / sum;
+
+	mptr = mat[0];
+	for ( j = 4; j < n; j++ ) {
+		mptr[j*nc+3] = ( mptr[j*nc+3] - v[0] * mptr[j*nc+0] - v[1] * mptr[j*nc+1] - v[2] * mptr[j*nc+2] ) * d;
+	}
+
+	for ( i = 4; i < n; i++ ) {
+		double s[4];
+		__m128 vk, p;
+		__m128d s01, s23;
+
+		mptr = mat[i];
+
+		vk = _mm_mul_ps( _mm_loadu_ps( diag ), _mm_loadu_ps( mptr ) );
+		_mm_storeu_ps( v, vk );
+		p = _mm_mul_ps( vk, _mm_loadu_ps( mptr ) );
+		s01 = _mm_cvtps_pd( p );
+		s23 = _mm_cvtps_pd( _mm_movehl_ps( p, p ) );
+		for ( k = 4; k < i-3; k += 4 ) {
+			vk = _mm_mul_ps( _mm_loadu_ps( diag + k ), _mm_loadu_ps( mptr + k ) );
+			_mm_storeu_ps( v + k, vk );
+			p = _mm_mul_ps( vk, _mm_loadu_ps( mptr + k ) );
+			s01 = _mm_add_pd( s01, _mm_cvtps_pd( p ) );
+			s23 = _mm_add_pd( s23, _mm_cvtps_pd( _mm_movehl_ps( p, p ) ) );
+		}
+		_mm_storeu_pd( s + 0, s01 );
+		_mm_storeu_pd( s + 2, s23 );
+		switch( i - k ) {
+			case 3: v[k+2] = diag[k+2] * mptr[k+2]; s[0] += v[k+2] * mptr[k+2];
+			case 2: v[k+1] = diag[k+1] * mptr[k+1]; s[1] += v[k+1] * mptr[k+1];
+			case 1: v[k+0] = diag[k+0] * mptr[k+0]; s[2] += v[k+0] * mptr[k+0];
+			case 0: break;
+		}
+		sum = s[3];
+		sum += s[2];
+		sum += s[1];
+		sum += s[0];
+
+		sum = mptr[i] - sum;
+
+		if ( sum == 0.0f ) {
+			return false;
+		}
+
+		mat[i][i] = sum;
+		diag[i] = sum;
+		invDiag[i] = d = 1.0f / sum;
+
+		if ( i + 1 >= n ) {
+			return true;
+		}
+
+		mptr = mat[i+1];
+		for ( j = i+1; j < n; j++ ) {
+			sum = SSE_DotDouble( mptr, v, i );
+			mptr[i] = ( mptr[i] - sum ) * d;
+			mptr += nc;
+		}
+	}
+
+	return true;
+}
+
+/*
+============
+SSE_ATan16
+
+  idMath::ATan16( y, x ) for four lanes
+============
+*/
+static ID_INLINE __m128 SSE_ATan16( const __m128 y, const __m128 x ) {
+	__m128 absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+	__m128 swap = _mm_cmpgt_ps( _mm_and_ps( y, absMask ), _mm_and_ps( x, absMask ) );
+	__m128 a = SSE_Select( _mm_div_ps( y, x ), _mm_div_ps( x, y ), swap );
+	__m128 s = _mm_mul_ps( a, a );
+	__m128 p;
+	p = _mm_sub_ps( _mm_mul_ps( _mm_set1_ps( 0.0028662257f ), s ), _mm_set1_ps( 0.0161657367f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 0.0429096138f ) );
+	p = _mm_sub_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 0.0752896400f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 0.1065626393f ) );
+	p = _mm_sub_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 0.1420889944f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 0.1999355085f ) );
+	p = _mm_sub_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 0.3333314528f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 1.0f ) );
+	__m128 r = _mm_mul_ps( p, a );
+	__m128 nr = _mm_mul_ps( _mm_xor_ps( p, SSE_SignBit() ), a );
+	__m128 negative = _mm_castsi128_ps( _mm_srai_epi32( _mm_castps_si128( a ), 31 ) );
+	__m128 q = SSE_Select( _mm_add_ps( nr, _mm_set1_ps( idMath::HALF_PI ) ), _mm_sub_ps( nr, _mm_set1_ps( idMath::HALF_PI ) ), negative );
+	return SSE_Select( r, q, swap );
+}
+
+/*
+============
+SSE_Sin16
+
+  idMath::Sin16 for four lanes, lanes outside [0, 2*PI) use the scalar version
+============
+*/
+static ID_INLINE __m128 SSE_Sin16( __m128 a ) {
+	__m128 reduce = _mm_or_ps( _mm_cmplt_ps( a, _mm_setzero_ps() ), _mm_cmpge_ps( a, _mm_set1_ps( idMath::TWO_PI ) ) );
+	if ( _mm_movemask_ps( reduce ) ) {
+		float f[4];
+		_mm_storeu_ps( f, a );
+		return _mm_setr_ps( idMath::Sin16( f[0] ), idMath::Sin16( f[1] ), idMath::Sin16( f[2] ), idMath::Sin16( f[3] ) );
+	}
+	__m128 pi = _mm_set1_ps( idMath::PI );
+	__m128 piMinusA = _mm_sub_ps( pi, a );
+	__m128 low = _mm_cmplt_ps( a, pi );
+	__m128 r0 = SSE_Select( a, piMinusA, _mm_cmpgt_ps( a, _mm_set1_ps( idMath::HALF_PI ) ) );
+	__m128 r1 = SSE_Select( piMinusA, _mm_sub_ps( a, _mm_set1_ps( idMath::TWO_PI ) ), _mm_cmpgt_ps( a, _mm_set1_ps( idMath::PI + idMath::HALF_PI ) ) );
+	a = SSE_Select( r1, r0, low );
+	__m128 s = _mm_mul_ps( a, a );
+	__m128 p;
+	p = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( -2.39e-08f ), s ), _mm_set1_ps( 2.7526e-06f ) );
+	p = _mm_sub_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 1.98409e-04f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 8.3333315e-03f ) );
+	p = _mm_sub_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 1.666666664e-01f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, s ), _mm_set1_ps( 1.0f ) );
+	return _mm_mul_ps( a, p );
+}
+
+/*
+============
+idSIMD_SSE::BlendJoints
+
+  Four joints are blended at a time with the same arithmetic as idQuat::Slerp and idVec3::Lerp.
+  The table based idMath::InvSqrt is evaluated per lane.
+============
+*/
+void VPCALL idSIMD_SSE::BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	int i;
+
+	if ( lerp <= 0.0f ) {
+		return;
+	}
+	if ( lerp >= 1.0f ) {
+		for ( i = 0; i < numJoints; i++ ) {
+			int j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	__m128 vlerp = _mm_set1_ps( lerp );
+	__m128 vinvLerp = _mm_set1_ps( 1.0f - lerp );
+	__m128 one = _mm_set1_ps( 1.0f );
+	__m128 sign = SSE_SignBit();
+
+	for ( i = 0; i + 4 <= numJoints; i += 4 ) {
+		idJointQuat *j0 = &joints[index[i+0]];
+		idJointQuat *j1 = &joints[index[i+1]];
+		idJointQuat *j2 = &joints[index[i+2]];
+		idJointQuat *j3 = &joints[index[i+3]];
+		const idJointQuat *b0 = &blendJoints[index[i+0]];
+		const idJointQuat *b1 = &blendJoints[index[i+1]];
+		const idJointQuat *b2 = &blendJoints[index[i+2]];
+		const idJointQuat *b3 = &blendJoints[index[i+3]];
+
+		__m128 fx = _mm_loadu_ps( j0->q.ToFloatPtr() );
+		__m128 fy = _mm_loadu_ps( j1->q.ToFloatPtr() );
+		__m128 fz = _mm_loadu_ps( j2->q.ToFloatPtr() );
+		__m128 fw = _mm_loadu_ps( j3->q.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( fx, fy, fz, fw );
+		__m128 tx = _mm_loadu_ps( b0->q.ToFloatPtr() );
+		__m128 ty = _mm_loadu_ps( b1->q.ToFloatPtr() );
+		__m128 tz = _mm_loadu_ps( b2->q.ToFloatPtr() );
+		__m128 tw = _mm_loadu_ps( b3->q.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( tx, ty, tz, tw );
+
+		__m128 equal = _mm_and_ps( _mm_and_ps( _mm_cmpeq_ps( fx, tx ), _mm_cmpeq_ps( fy, ty ) ),
+									_mm_and_ps( _mm_cmpeq_ps( fz, tz ), _mm_cmpeq_ps( fw, tw ) ) );
+
+		__m128 cosom = _mm_add_ps( SSE_Dot3( fx, fy, fz, tx, ty, tz ), _mm_mul_ps( fw, tw ) );
+		__m128 flip = _mm_and_ps( _mm_cmplt_ps( cosom, _mm_setzero_ps() ), sign );
+		cosom = _mm_xor_ps( cosom, flip );
+
+		__m128 scale0 = vinvLerp;
+		__m128 scale1 = vlerp;
+		__m128 slerp = _mm_cmpgt_ps( _mm_sub_ps( one, cosom ), _mm_set1_ps( 1e-6f ) );
+		if ( _mm_movemask_ps( slerp ) ) {
+			float f[4];
+			__m128 s0 = _mm_sub_ps( one, _mm_mul_ps( cosom, cosom ) );
+			_mm_storeu_ps( f, s0 );
+			__m128 sinom = _mm_setr_ps( idMath::InvSqrt( f[0] ), idMath::InvSqrt( f[1] ), idMath::InvSqrt( f[2] ), idMath::InvSqrt( f[3] ) );
+			__m128 omega = SSE_ATan16( _mm_mul_ps( s0, sinom ), cosom );
+			s0 = _mm_mul_ps( SSE_Sin16( _mm_mul_ps( vinvLerp, omega ) ), sinom );
+			__m128 s1 = _mm_mul_ps( SSE_Sin16( _mm_mul_ps( vlerp, omega ) ), sinom );
+			scale0 = SSE_Select( scale0, s0, slerp );
+			scale1 = SSE_Select( scale1, s1, slerp );
+		}
+
+		__m128 rx = _mm_add_ps( _mm_mul_ps( scale0, fx ), _mm_mul_ps( scale1, _mm_xor_ps( tx, flip ) ) );
+		__m128 ry = _mm_add_ps( _mm_mul_ps( scale0, fy ), _mm_mul_ps( scale1, _mm_xor_ps( ty, flip ) ) );
+		__m128 rz = _mm_add_ps( _mm_mul_ps( scale0, fz ), _mm_mul_ps( scale1, _mm_xor_ps( tz, flip ) ) );
+		__m128 rw = _mm_add_ps( _mm_mul_ps( scale0, fw ), _mm_mul_ps( scale1, _mm_xor_ps( tw, flip ) ) );
+		rx = SSE_Select( rx, tx, equal );
+		ry = SSE_Select( ry, ty, equal );
+		rz = SSE_Select( rz, tz, equal );
+		rw = SSE_Select( rw, tw, equal );
+		_MM_TRANSPOSE4_PS( rx, ry, rz, rw );
+
+		// translation lerp, the translations are loaded together with the preceding quaternion w
+		__m128 f0 = _mm_loadu_ps( j0->t.ToFloatPtr() - 1 );
+		__m128 f1 = _mm_loadu_ps( j1->t.ToFloatPtr() - 1 );
+		__m128 f2 = _mm_loadu_ps( j2->t.ToFloatPtr() - 1 );
+		__m128 f3 = _mm_loadu_ps( j3->t.ToFloatPtr() - 1 );
+		f0 = _mm_add_ps( f0, _mm_mul_ps( vlerp, _mm_sub_ps( _mm_loadu_ps( b0->t.ToFloatPtr() - 1 ), f0 ) ) );
+		f1 = _mm_add_ps( f1, _mm_mul_ps( vlerp, _mm_sub_ps( _mm_loadu_ps( b1->t.ToFloatPtr() - 1 ), f1 ) ) );
+		f2 = _mm_add_ps( f2, _mm_mul_ps( vlerp, _mm_sub_ps( _mm_loadu_ps( b2->t.ToFloatPtr() - 1 ), f2 ) ) );
+		f3 = _mm_add_ps( f3, _mm_mul_ps( vlerp, _mm_sub_ps( _mm_loadu_ps( b3->t.ToFloatPtr() - 1 ), f3 ) ) );
+
+		// lane 0 of the translation vectors overlaps the quaternion w, so write the quaternions last
+		_mm_storeu_ps( j0->t.ToFloatPtr() - 1, f0 );
+		_mm_storeu_ps( j0->q.ToFloatPtr(), rx );
+		_mm_storeu_ps( j1->t.ToFloatPtr() - 1, f1 );
+		_mm_storeu_ps( j1->q.ToFloatPtr(), ry );
+		_mm_storeu_ps( j2->t.ToFloatPtr() - 1, f2 );
+		_mm_storeu_ps( j2->q.ToFloatPtr(), rz );
+		_mm_storeu_ps( j3->t.ToFloatPtr() - 1, f3 );
+		_mm_storeu_ps( j3->q.ToFloatPtr(), rw );
+	}
+
+	for ( ; i < numJoints; i++ ) {
+		int j = index[i];
+		joints[j].q.Slerp( joints[j].q, blendJoints[j].q, lerp );
+		joints[j].t.Lerp( joints[j].t, blendJoints[j].t, lerp );
+	}
+}
+
+/*
+============
+idSIMD_SSE::ConvertJointQuatsToJointMats
+
+  four joints at a time with the arithmetic of idQuat::ToMat3
+============
+*/
+void VPCALL idSIMD_SSE::ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) {
+	__m128 one = _mm_set1_ps( 1.0f );
+	int i;
+
+	assert( sizeof( idJointQuat ) == JOINTQUAT_SIZE );
+
+	for ( i = 0; i + 4 <= numJoints; i += 4 ) {
+		const idJointQuat *q = jointQuats + i;
+		__m128 x = _mm_loadu_ps( q[0].q.ToFloatPtr() );
+		__m128 y = _mm_loadu_ps( q[1].q.ToFloatPtr() );
+		__m128 z = _mm_loadu_ps( q[2].q.ToFloatPtr() );
+		__m128 w = _mm_loadu_ps( q[3].q.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+		// the translations are loaded together with the preceding quaternion w
+		__m128 tw = _mm_loadu_ps( q[0].t.ToFloatPtr() - 1 );
+		__m128 tx = _mm_loadu_ps( q[1].t.ToFloatPtr() - 1 );
+		__m128 ty = _mm_loadu_ps( q[2].t.ToFloatPtr() - 1 );
+		__m128 tz = _mm_loadu_ps( q[3].t.ToFloatPtr() - 1 );
+		_MM_TRANSPOSE4_PS( tw, tx, ty, tz );
+
+		__m128 x2 = _mm_add_ps( x, x );
+		__m128 y2 = _mm_add_ps( y, y );
+		__m128 z2 = _mm_add_ps( z, z );
+
+		__m128 xx = _mm_mul_ps( x, x2 );
+		__m128 xy = _mm_mul_ps( x, y2 );
+		__m128 xz = _mm_mul_ps( x, z2 );
+
+		__m128 yy = _mm_mul_ps( y, y2 );
+		__m128 yz = _mm_mul_ps( y, z2 );
+		__m128 zz = _mm_mul_ps( z, z2 );
+
+		__m128 wx = _mm_mul_ps( w, x2 );
+		__m128 wy = _mm_mul_ps( w, y2 );
+		__m128 wz = _mm_mul_ps( w, z2 );
+
+		__m128 m00 = _mm_sub_ps( one, _mm_add_ps( yy, zz ) );
+		__m128 m01 = _mm_add_ps( xy, wz );
+		__m128 m02 = _mm_sub_ps( xz, wy );
+		__m128 m03 = tx;
+		_MM_TRANSPOSE4_PS( m00, m01, m02, m03 );
+
+		__m128 m10 = _mm_sub_ps( xy, wz );
+		__m128 m11 = _mm_sub_ps( one, _mm_add_ps( xx, zz ) );
+		__m128 m12 = _mm_add_ps( yz, wx );
+		__m128 m13 = ty;
+		_MM_TRANSPOSE4_PS( m10, m11, m12, m13 );
+
+		__m128 m20 = _mm_add_ps( xz, wy );
+		__m128 m21 = _mm_sub_ps( yz, wx );
+		__m128 m22 = _mm_sub_ps( one, _mm_add_ps( xx, yy ) );
+		__m128 m23 = tz;
+		_MM_TRANSPOSE4_PS( m20, m21, m22, m23 );
+
+		float *m = jointMats[i].ToFloatPtr();
+		_mm_storeu_ps( m + 0*12 + 0, m00 );
+		_mm_storeu_ps( m + 0*12 + 4, m10 );
+		_mm_storeu_ps( m + 0*12 + 8, m20 );
+		_mm_storeu_ps( m + 1*12 + 0, m01 );
+		_mm_storeu_ps( m + 1*12 + 4, m11 );
+		_mm_storeu_ps( m + 1*12 + 8, m21 );
+		_mm_storeu_ps( m + 2*12 + 0, m02 );
+		_mm_storeu_ps( m + 2*12 + 4, m12 );
+		_mm_storeu_ps( m + 2*12 + 8, m22 );
+		_mm_storeu_ps( m + 3*12 + 0, m03 );
+		_mm_storeu_ps( m + 3*12 + 4, m13 );
+		_mm_storeu_ps( m + 3*12 + 8, m23 );
+	}
+
+	for ( ; i < numJoints; i++ ) {
+		jointMats[i].SetRotation( jointQuats[i].q.ToMat3() );
+		jointMats[i].SetTranslation( jointQuats[i].t );
+	}
+}
+
+/*
+============
+idSIMD_SSE::TransformJoints
+
+  the rows of a joint matrix are processed in parallel with the column order of idJointMat::operator*=
+============
+*/
+void VPCALL idSIMD_SSE::TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	__m128 translation = _mm_castsi128_ps( _mm_setr_epi32( 0, 0, 0, -1 ) );
+	int i;
+
+	for( i = firstJoint; i <= lastJoint; i++ ) {
+		assert( parents[i] < i );
+		float *m = jointMats[i].ToFloatPtr();
+		const float *a = jointMats[parents[i]].ToFloatPtr();
+		__m128 r0 = _mm_loadu_ps( m + 0 );
+		__m128 r1 = _mm_loadu_ps( m + 4 );
+		__m128 r2 = _mm_loadu_ps( m + 8 );
+		__m128 d0, d1, d2;
+
+		d0 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r0, _mm_set1_ps( a[0*4+0] ) ), _mm_mul_ps( r1, _mm_set1_ps( a[0*4+1] ) ) ), _mm_mul_ps( r2, _mm_set1_ps( a[0*4+2] ) ) );
+		d1 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r0, _mm_set1_ps( a[1*4+0] ) ), _mm_mul_ps( r1, _mm_set1_ps( a[1*4+1] ) ) ), _mm_mul_ps( r2, _mm_set1_ps( a[1*4+2] ) ) );
+		d2 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r0, _mm_set1_ps( a[2*4+0] ) ), _mm_mul_ps( r1, _mm_set1_ps( a[2*4+1] ) ) ), _mm_mul_ps( r2, _mm_set1_ps( a[2*4+2] ) ) );
+
+		d0 = SSE_Select( d0, _mm_add_ps( d0, _mm_set1_ps( a[0*4+3] ) ), translation );
+		d1 = SSE_Select( d1, _mm_add_ps( d1, _mm_set1_ps( a[1*4+3] ) ), translation );
+		d2 = SSE_Select( d2, _mm_add_ps( d2, _mm_set1_ps( a[2*4+3] ) ), translation );
+
+		_mm_storeu_ps( m + 0, d0 );
+		_mm_storeu_ps( m + 4, d1 );
+		_mm_storeu_ps( m + 8, d2 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::UntransformJoints
+============
+*/
+void VPCALL idSIMD_SSE::UntransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	__m128 translation = _mm_castsi128_ps( _mm_setr_epi32( 0, 0, 0, -1 ) );
+	int i;
+
+	for( i = lastJoint; i >= firstJoint; i-- ) {
+		assert( parents[i] < i );
+		float *m = jointMats[i].ToFloatPtr();
+		const float *a = jointMats[parents[i]].ToFloatPtr();
+		__m128 r0 = _mm_loadu_ps( m + 0 );
+		__m128 r1 = _mm_loadu_ps( m + 4 );
+		__m128 r2 = _mm_loadu_ps( m + 8 );
+		__m128 d0, d1, d2;
+
+		r0 = SSE_Select( r0, _mm_sub_ps( r0, _mm_set1_ps( a[0*4+3] ) ), translation );
+		r1 = SSE_Select( r1, _mm_sub_ps( r1, _mm_set1_ps( a[1*4+3] ) ), translation );
+		r2 = SSE_Select( r2, _mm_sub_ps( r2, _mm_set1_ps( a[2*4+3] ) ), translation );
+
+		d0 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r0, _mm_set1_ps( a[0*4+0] ) ), _mm_mul_ps( r1, _mm_set1_ps( a[1*4+0] ) ) ), _mm_mul_ps( r2, _mm_set1_ps( a[2*4+0] ) ) );
+		d1 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r0, _mm_set1_ps( a[0*4+1] ) ), _mm_mul_ps( r1, _mm_set1_ps( a[1*4+1] ) ) ), _mm_mul_ps( r2, _mm_set1_ps( a[2*4+1] ) ) );
+		d2 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r0, _mm_set1_ps( a[0*4+2] ) ), _mm_mul_ps( r1, _mm_set1_ps( a[1*4+2] ) ) ), _mm_mul_ps( r2, _mm_set1_ps( a[2*4+2] ) ) );
+
+		_mm_storeu_ps( m + 0, d0 );
+		_mm_storeu_ps( m + 4, d1 );
+		_mm_storeu_ps( m + 8, d2 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::TransformVerts
+
+  the joint matrix is transposed so each column is scaled by one weight component,
+  which adds the products in the order of idJointMat::operator*( const idVec4 & )
+============
+*/
+void VPCALL idSIMD_SSE::TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) {
+	const byte *jointsPtr = (const byte *)joints;
+	int i, j;
+
+	for( j = i = 0; i < numVerts; i++ ) {
+		__m128 v, sum;
+		bool first = true;
+
+		do {
+			const float *m = ( (const idJointMat *) ( jointsPtr + index[j*2+0] ) )->ToFloatPtr();
+			__m128 c0 = _mm_loadu_ps( m + 0 );
+			__m128 c1 = _mm_loadu_ps( m + 4 );
+			__m128 c2 = _mm_loadu_ps( m + 8 );
+			__m128 c3 = _mm_setzero_ps();
+			__m128 w = _mm_loadu_ps( weights[j].ToFloatPtr() );
+			_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+			v = _mm_mul_ps( c0, _mm_shuffle_ps( w, w, R_SHUFFLEPS( 0, 0, 0, 0 ) ) );
+			v = _mm_add_ps( v, _mm_mul_ps( c1, _mm_shuffle_ps( w, w, R_SHUFFLEPS( 1, 1, 1, 1 ) ) ) );
+			v = _mm_add_ps( v, _mm_mul_ps( c2, _mm_shuffle_ps( w, w, R_SHUFFLEPS( 2, 2, 2, 2 ) ) ) );
+			v = _mm_add_ps( v, _mm_mul_ps( c3, _mm_shuffle_ps( w, w, R_SHUFFLEPS( 3, 3, 3, 3 ) ) ) );
+			sum = first ? v : _mm_add_ps( sum, v );
+			first = false;
+		} while( index[(j++)*2+1] == 0 );
+
+		SSE_StoreVec3( verts[i].xyz.ToFloatPtr(), sum );
+	}
+}
+
+/*
+============
+SSE_PlaneDistance
+
+  idPlane::Distance for four transposed vertices
+============
+*/
+static ID_INLINE __m128 SSE_PlaneDistance( const idPlane &plane, const __m128 x, const __m128 y, const __m128 z ) {
+	__m128 d = SSE_Dot3( _mm_set1_ps( plane[0] ), _mm_set1_ps( plane[1] ), _mm_set1_ps( plane[2] ), x, y, z );
+	return _mm_add_ps( d, _mm_set1_ps( plane[3] ) );
+}
+
+/*
+============
+idSIMD_SSE::TracePointCull
+============
+*/
+void VPCALL idSIMD_SSE::TracePointCull( byte *cullBits, byte &totalOr, const float radius, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	__m128 r = _mm_set1_ps( radius );
+	__m128i vOr = _mm_setzero_si128();
+	byte tOr;
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		__m128 x, y, z, w;
+		__m128i bits = _mm_setzero_si128();
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		for ( int j = 0; j < 4; j++ ) {
+			__m128 d = SSE_PlaneDistance( planes[j], x, y, z );
+			bits = _mm_or_si128( bits, SSE_SignBits( _mm_add_ps( d, r ), j ) );
+			bits = _mm_or_si128( bits, SSE_SignBits( _mm_sub_ps( d, r ), j + 4 ) );
+		}
+		bits = _mm_xor_si128( bits, _mm_set1_epi32( 0x0F ) );		// flip lower four bits
+		vOr = _mm_or_si128( vOr, bits );
+		SSE_StoreBytes( cullBits + i, bits );
+	}
+
+	vOr = _mm_or_si128( vOr, _mm_shuffle_epi32( vOr, R_SHUFFLEPS( 2, 3, 0, 1 ) ) );
+	vOr = _mm_or_si128( vOr, _mm_shuffle_epi32( vOr, R_SHUFFLEPS( 1, 0, 3, 2 ) ) );
+	tOr = (byte) _mm_cvtsi128_si32( vOr );
+
+	for ( ; i < numVerts; i++ ) {
+		byte bits;
+		float d0, d1, d2, d3, t;
+		const idVec3 &v = verts[i].xyz;
+
+		d0 = planes[0].Distance( v );
+		d1 = planes[1].Distance( v );
+		d2 = planes[2].Distance( v );
+		d3 = planes[3].Distance( v );
+
+		t = d0 + radius;
+		bits  = FLOATSIGNBITSET( t ) << 0;
+		t = d1 + radius;
+		bits |= FLOATSIGNBITSET( t ) << 1;
+		t = d2 + radius;
+		bits |= FLOATSIGNBITSET( t ) << 2;
+		t = d3 + radius;
+		bits |= FLOATSIGNBITSET( t ) << 3;
+
+		t = d0 - radius;
+		bits |= FLOATSIGNBITSET( t ) << 4;
+		t = d1 - radius;
+		bits |= FLOATSIGNBITSET( t ) << 5;
+		t = d2 - radius;
+		bits |= FLOATSIGNBITSET( t ) << 6;
+		t = d3 - radius;
+		bits |= FLOATSIGNBITSET( t ) << 7;
+
+		bits ^= 0x0F;		// flip lower four bits
+
+		tOr |= bits;
+		cullBits[i] = bits;
+	}
+
+	totalOr = tOr;
+}
+
+/*
+============
+idSIMD_SSE::DecalPointCull
+============
+*/
+void VPCALL idSIMD_SSE::DecalPointCull( byte *cullBits, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		__m128 x, y, z, w;
+		__m128i bits = _mm_setzero_si128();
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		for ( int j = 0; j < 6; j++ ) {
+			bits = _mm_or_si128( bits, SSE_SignBits( SSE_PlaneDistance( planes[j], x, y, z ), j ) );
+		}
+		SSE_StoreBytes( cullBits + i, _mm_xor_si128( bits, _mm_set1_epi32( 0x3F ) ) );		// flip lower 6 bits
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		byte bits;
+		float d0, d1, d2, d3, d4, d5;
+		const idVec3 &v = verts[i].xyz;
+
+		d0 = planes[0].Distance( v );
+		d1 = planes[1].Distance( v );
+		d2 = planes[2].Distance( v );
+		d3 = planes[3].Distance( v );
+		d4 = planes[4].Distance( v );
+		d5 = planes[5].Distance( v );
+
+		bits  = FLOATSIGNBITSET( d0 ) << 0;
+		bits |= FLOATSIGNBITSET( d1 ) << 1;
+		bits |= FLOATSIGNBITSET( d2 ) << 2;
+		bits |= FLOATSIGNBITSET( d3 ) << 3;
+		bits |= FLOATSIGNBITSET( d4 ) << 4;
+		bits |= FLOATSIGNBITSET( d5 ) << 5;
+
+		cullBits[i] = bits ^ 0x3F;		// flip lower 6 bits
+	}
+}
+
+/*
+============
+idSIMD_SSE::OverlayPointCull
+============
+*/
+void VPCALL idSIMD_SSE::OverlayPointCull( byte *cullBits, idVec2 *texCoords, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	__m128 one = _mm_set1_ps( 1.0f );
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		__m128 x, y, z, w;
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		__m128 d0 = SSE_PlaneDistance( planes[0], x, y, z );
+		__m128 d1 = SSE_PlaneDistance( planes[1], x, y, z );
+		_mm_storeu_ps( texCoords[i+0].ToFloatPtr(), _mm_unpacklo_ps( d0, d1 ) );
+		_mm_storeu_ps( texCoords[i+2].ToFloatPtr(), _mm_unpackhi_ps( d0, d1 ) );
+		__m128i bits = SSE_SignBits( d0, 0 );
+		bits = _mm_or_si128( bits, SSE_SignBits( d1, 1 ) );
+		bits = _mm_or_si128( bits, SSE_SignBits( _mm_sub_ps( one, d0 ), 2 ) );
+		bits = _mm_or_si128( bits, SSE_SignBits( _mm_sub_ps( one, d1 ), 3 ) );
+		SSE_StoreBytes( cullBits + i, bits );
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		byte bits;
+		float d0, d1;
+		const idVec3 &v = verts[i].xyz;
+
+		texCoords[i][0] = d0 = planes[0].Distance( v );
+		texCoords[i][1] = d1 = planes[1].Distance( v );
+
+		bits  = FLOATSIGNBITSET( d0 ) << 0;
+		d0 = 1.0f - d0;
+		bits |= FLOATSIGNBITSET( d1 ) << 1;
+		d1 = 1.0f - d1;
+		bits |= FLOATSIGNBITSET( d0 ) << 2;
+		bits |= FLOATSIGNBITSET( d1 ) << 3;
+
+		cullBits[i] = bits;
+	}
+}
+
+/*
+============
+SSE_LoadTriangleVerts
+
+  loads the xyz and st of the vertices at the given indexes of four triangles
+============
+*/
+static ID_INLINE void SSE_LoadTriangleVerts( const idDrawVert *verts, const int *indexes, const int corner, __m128 &x, __m128 &y, __m128 &z, __m128 &s, __m128 &t ) {
+	const idDrawVert *v0 = verts + indexes[0*3+corner];
+	const idDrawVert *v1 = verts + indexes[1*3+corner];
+	const idDrawVert *v2 = verts + indexes[2*3+corner];
+	const idDrawVert *v3 = verts + indexes[3*3+corner];
+	x = _mm_loadu_ps( v0->xyz.ToFloatPtr() );
+	y = _mm_loadu_ps( v1->xyz.ToFloatPtr() );
+	z = _mm_loadu_ps( v2->xyz.ToFloatPtr() );
+	s = _mm_loadu_ps( v3->xyz.ToFloatPtr() );
+	_MM_TRANSPOSE4_PS( x, y, z, s );
+	t = _mm_setr_ps( v0->st[1], v1->st[1], v2->st[1], v3->st[1] );
+}
+
+/*
+============
+SSE_StorePlanes
+============
+*/
+static ID_INLINE void SSE_StorePlanes( idPlane *planes, __m128 nx, __m128 ny, __m128 nz, __m128 d ) {
+	_MM_TRANSPOSE4_PS( nx, ny, nz, d );
+	_mm_storeu_ps( planes[0].ToFloatPtr(), nx );
+	_mm_storeu_ps( planes[1].ToFloatPtr(), ny );
+	_mm_storeu_ps( planes[2].ToFloatPtr(), nz );
+	_mm_storeu_ps( planes[3].ToFloatPtr(), d );
+}
+
+/*
+============
+idSIMD_SSE::DeriveTriPlanes
+
+	Derives a plane equation for each triangle.
+============
+*/
+void VPCALL idSIMD_SSE::DeriveTriPlanes( idPlane *planes, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	int i;
+
+	for ( i = 0; i + 4*3 <= numIndexes; i += 4*3 ) {
+		__m128 ax, ay, az, as, at;
+		__m128 bx, by, bz, bs, bt;
+		__m128 cx, cy, cz, cs, ct;
+
+		SSE_LoadTriangleVerts( verts, indexes + i, 0, ax, ay, az, as, at );
+		SSE_LoadTriangleVerts( verts, indexes + i, 1, bx, by, bz, bs, bt );
+		SSE_LoadTriangleVerts( verts, indexes + i, 2, cx, cy, cz, cs, ct );
+
+		__m128 d0x = _mm_sub_ps( bx, ax );
+		__m128 d0y = _mm_sub_ps( by, ay );
+		__m128 d0z = _mm_sub_ps( bz, az );
+		__m128 d1x = _mm_sub_ps( cx, ax );
+		__m128 d1y = _mm_sub_ps( cy, ay );
+		__m128 d1z = _mm_sub_ps( cz, az );
+
+		__m128 nx = _mm_sub_ps( _mm_mul_ps( d1y, d0z ), _mm_mul_ps( d1z, d0y ) );
+		__m128 ny = _mm_sub_ps( _mm_mul_ps( d1z, d0x ), _mm_mul_ps( d1x, d0z ) );
+		__m128 nz = _mm_sub_ps( _mm_mul_ps( d1x, d0y ), _mm_mul_ps( d1y, d0x ) );
+
+		__m128 f = SSE_RSqrt( SSE_Dot3( nx, ny, nz, nx, ny, nz ) );
+		nx = _mm_mul_ps( nx, f );
+		ny = _mm_mul_ps( ny, f );
+		nz = _mm_mul_ps( nz, f );
+
+		__m128 d = _mm_xor_ps( SSE_Dot3( nx, ny, nz, ax, ay, az ), SSE_SignBit() );
+
+		SSE_StorePlanes( planes, nx, ny, nz, d );
+		planes += 4;
+	}
+
+	for ( ; i < numIndexes; i += 3 ) {
+		const idDrawVert *a, *b, *c;
+		float d0[3], d1[3], f;
+		idVec3 n;
+
+		a = verts + indexes[i + 0];
+		b = verts + indexes[i + 1];
+		c = verts + indexes[i + 2];
+
+		d0[0] = b->xyz[0] - a->xyz[0];
+		d0[1] = b->xyz[1] - a->xyz[1];
+		d0[2] = b->xyz[2] - a->xyz[2];
+
+		d1[0] = c->xyz[0] - a->xyz[0];
+		d1[1] = c->xyz[1] - a->xyz[1];
+		d1[2] = c->xyz[2] - a->xyz[2];
+
+		n[0] = d1[1] * d0[2] - d1[2] * d0[1];
+		n[1] = d1[2] * d0[0] - d1[0] * d0[2];
+		n[2] = d1[0] * d0[1] - d1[1] * d0[0];
+
+		f = idMath::RSqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+
+		n.x *= f;
+		n.y *= f;
+		n.z *= f;
+
+		planes->SetNormal( n );
+		planes->FitThroughPoint( a->xyz );
+		planes++;
+	}
+}
+
+/*
+============
+SSE_AddTangents
+
+  accumulates the normal and tangents of a triangle onto one of its vertices
+============
+*/
+static ID_INLINE void SSE_AddTangents( idDrawVert *v, bool &used, const float *n, const float *t0, const float *t1 ) {
+	if ( used ) {
+		v->normal[0] += n[0*4];
+		v->normal[1] += n[1*4];
+		v->normal[2] += n[2*4];
+		v->tangents[0][0] += t0[0*4];
+		v->tangents[0][1] += t0[1*4];
+		v->tangents[0][2] += t0[2*4];
+		v->tangents[1][0] += t1[0*4];
+		v->tangents[1][1] += t1[1*4];
+		v->tangents[1][2] += t1[2*4];
+	} else {
+		v->normal[0] = n[0*4];
+		v->normal[1] = n[1*4];
+		v->normal[2] = n[2*4];
+		v->tangents[0][0] = t0[0*4];
+		v->tangents[0][1] = t0[1*4];
+		v->tangents[0][2] = t0[2*4];
+		v->tangents[1][0] = t1[0*4];
+		v->tangents[1][1] = t1[1*4];
+		v->tangents[1][2] = t1[2*4];
+		used = true;
+	}
+}
+
+/*
+============
+idSIMD_SSE::DeriveTangents
+
+	Derives the normal and orthogonal tangent vectors for the triangle vertices.
+	For each vertex the normal and tangent vectors are derived from all triangles
+	using the vertex which results in smooth tangents across the mesh.
+	In the process the triangle planes are calculated as well.
+
+	The triangle vectors are calculated for four triangles at a time and then
+	accumulated onto the vertices in triangle order like the generic code.
+============
+*/
+void VPCALL idSIMD_SSE::DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	int i;
+
+	bool *used = (bool *)_alloca16( numVerts * sizeof( used[0] ) );
+	memset( used, 0, numVerts * sizeof( used[0] ) );
+
+	idPlane *planesPtr = planes;
+	__m128 sign = SSE_SignBit();
+
+	for ( i = 0; i + 4*3 <= numIndexes; i += 4*3 ) {
+		__m128 ax, ay, az, as, at;
+		__m128 bx, by, bz, bs, bt;
+		__m128 cx, cy, cz, cs, ct;
+		float n[3*4], t0[3*4], t1[3*4];
+
+		SSE_LoadTriangleVerts( verts, indexes + i, 0, ax, ay, az, as, at );
+		SSE_LoadTriangleVerts( verts, indexes + i, 1, bx, by, bz, bs, bt );
+		SSE_LoadTriangleVerts( verts, indexes + i, 2, cx, cy, cz, cs, ct );
+
+		__m128 d0x = _mm_sub_ps( bx, ax );
+		__m128 d0y = _mm_sub_ps( by, ay );
+		__m128 d0z = _mm_sub_ps( bz, az );
+		__m128 d0s = _mm_sub_ps( bs, as );
+		__m128 d0t = _mm_sub_ps( bt, at );
+		__m128 d1x = _mm_sub_ps( cx, ax );
+		__m128 d1y = _mm_sub_ps( cy, ay );
+		__m128 d1z = _mm_sub_ps( cz, az );
+		__m128 d1s = _mm_sub_ps( cs, as );
+		__m128 d1t = _mm_sub_ps( ct, at );
+
+		// normal
+		__m128 nx = _mm_sub_ps( _mm_mul_ps( d1y, d0z ), _mm_mul_ps( d1z, d0y ) );
+		__m128 ny = _mm_sub_ps( _mm_mul_ps( d1z, d0x ), _mm_mul_ps( d1x, d0z ) );
+		__m128 nz = _mm_sub_ps( _mm_mul_ps( d1x, d0y ), _mm_mul_ps( d1y, d0x ) );
+
+		__m128 f = SSE_RSqrt( SSE_Dot3( nx, ny, nz, nx, ny, nz ) );
+		nx = _mm_mul_ps( nx, f );
+		ny = _mm_mul_ps( ny, f );
+		nz = _mm_mul_ps( nz, f );
+
+		_mm_storeu_ps( n + 0*4, nx );
+		_mm_storeu_ps( n + 1*4, ny );
+		_mm_storeu_ps( n + 2*4, nz );
+
+		__m128 d = _mm_xor_ps( SSE_Dot3( nx, ny, nz, ax, ay, az ), sign );
+		SSE_StorePlanes( planesPtr, nx, ny, nz, d );
+		planesPtr += 4;
+
+		// area sign bit
+		__m128 area = _mm_sub_ps( _mm_mul_ps( d0s, d1t ), _mm_mul_ps( d0t, d1s ) );
+		__m128 signBit = _mm_and_ps( area, sign );
+
+		// first tangent
+		__m128 tx = _mm_sub_ps( _mm_mul_ps( d0x, d1t ), _mm_mul_ps( d0t, d1x ) );
+		__m128 ty = _mm_sub_ps( _mm_mul_ps( d0y, d1t ), _mm_mul_ps( d0t, d1y ) );
+		__m128 tz = _mm_sub_ps( _mm_mul_ps( d0z, d1t ), _mm_mul_ps( d0t, d1z ) );
+
+		f = _mm_xor_ps( SSE_RSqrt( SSE_Dot3( tx, ty, tz, tx, ty, tz ) ), signBit );
+		_mm_storeu_ps( t0 + 0*4, _mm_mul_ps( tx, f ) );
+		_mm_storeu_ps( t0 + 1*4, _mm_mul_ps( ty, f ) );
+		_mm_storeu_ps( t0 + 2*4, _mm_mul_ps( tz, f ) );
+
+		// second tangent
+		tx = _mm_sub_ps( _mm_mul_ps( d0s, d1x ), _mm_mul_ps( d0x, d1s ) );
+		ty = _mm_sub_ps( _mm_mul_ps( d0s, d1y ), _mm_mul_ps( d0y, d1s ) );
+		tz = _mm_sub_ps( _mm_mul_ps( d0s, d1z ), _mm_mul_ps( d0z, d1s ) );
+
+		f = _mm_xor_ps( SSE_RSqrt( SSE_Dot3( tx, ty, tz, tx, ty, tz ) ), signBit );
+		_mm_storeu_ps( t1 + 0*4, _mm_mul_ps( tx, f ) );
+		_mm_storeu_ps( t1 + 1*4, _mm_mul_ps( ty, f ) );
+		_mm_storeu_ps( t1 + 2*4, _mm_mul_ps( tz, f ) );
+
+		for ( int j = 0; j < 4; j++ ) {
+			for ( int k = 0; k < 3; k++ ) {
+				int v = indexes[i + j*3 + k];
+				SSE_AddTangents( verts + v, used[v], n + j, t0 + j, t1 + j );
+			}
+		}
+	}
+
+	for ( ; i < numIndexes; i += 3 ) {
+		idDrawVert *a, *b, *c;
+		unsigned int signBit;
+		float d0[5], d1[5], f, area;
+		float n[3*4], t0[3*4], t1[3*4];
+
+		int v0 = indexes[i + 0];
+		int v1 = indexes[i + 1];
+		int v2 = indexes[i + 2];
+
+		a = verts + v0;
+		b = verts + v1;
+		c = verts + v2;
+
+		d0[0] = b->xyz[0] - a->xyz[0];
+		d0[1] = b->xyz[1] - a->xyz[1];
+		d0[2] = b->xyz[2] - a->xyz[2];
+		d0[3] = b->st[0] - a->st[0];
+		d0[4] = b->st[1] - a->st[1];
+
+		d1[0] = c->xyz[0] - a->xyz[0];
+		d1[1] = c->xyz[1] - a->xyz[1];
+		d1[2] = c->xyz[2] - a->xyz[2];
+		d1[3] = c->st[0] - a->st[0];
+		d1[4] = c->st[1] - a->st[1];
+
+		// normal
+		n[0*4] = d1[1] * d0[2] - d1[2] * d0[1];
+		n[1*4] = d1[2] * d0[0] - d1[0] * d0[2];
+		n[2*4] = d1[0] * d0[1] - d1[1] * d0[0];
+
+		f = idMath::RSqrt( n[0*4] * n[0*4] + n[1*4] * n[1*4] + n[2*4] * n[2*4] );
+
+		n[0*4] *= f;
+		n[1*4] *= f;
+		n[2*4] *= f;
+
+		planesPtr->SetNormal( idVec3( n[0*4], n[1*4], n[2*4] ) );
+		planesPtr->FitThroughPoint( a->xyz );
+		planesPtr++;
+
+		// area sign bit
+		area = d0[3] * d1[4] - d0[4] * d1[3];
+		signBit = SSE_FloatBits( area ) & 0x80000000;
+
+		// first tangent
+		t0[0*4] = d0[0] * d1[4] - d0[4] * d1[0];
+		t0[1*4] = d0[1] * d1[4] - d0[4] * d1[1];
+		t0[2*4] = d0[2] * d1[4] - d0[4] * d1[2];
+
+		f = idMath::RSqrt( t0[0*4] * t0[0*4] + t0[1*4] * t0[1*4] + t0[2*4] * t0[2*4] );
+		f = SSE_BitsFloat( SSE_FloatBits( f ) ^ signBit );
+
+		t0[0*4] *= f;
+		t0[1*4] *= f;
+		t0[2*4] *= f;
+
+		// second tangent
+		t1[0*4] = d0[3] * d1[0] - d0[0] * d1[3];
+		t1[1*4] = d0[3] * d1[1] - d0[1] * d1[3];
+		t1[2*4] = d0[3] * d1[2] - d0[2] * d1[3];
+
+		f = idMath::RSqrt( t1[0*4] * t1[0*4] + t1[1*4] * t1[1*4] + t1[2*4] * t1[2*4] );
+		f = SSE_BitsFloat( SSE_FloatBits( f ) ^ signBit );
+
+		t1[0*4] *= f;
+		t1[1*4] *= f;
+		t1[2*4] *= f;
+
+		SSE_AddTangents( a, used[v0], n, t0, t1 );
+		SSE_AddTangents( b, used[v1], n, t0, t1 );
+		SSE_AddTangents( c, used[v2], n, t0, t1 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::DeriveUnsmoothedTangents
+
+	Derives the normal and orthogonal tangent vectors for the triangle vertices.
+	For each vertex the normal and tangent vectors are derived from a single dominant triangle.
+============
+*/
+void VPCALL idSIMD_SSE::DeriveUnsmoothedTangents( idDrawVert *verts, const dominantTri_s *dominantTris, const int numVerts ) {
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		const dominantTri_s *dt = dominantTris + i;
+		int b[4] = { dt[0].v2, dt[1].v2, dt[2].v2, dt[3].v2 };
+		int c[4] = { dt[0].v3, dt[1].v3, dt[2].v3, dt[3].v3 };
+		__m128 ax, ay, az, as, at;
+		__m128 bx, by, bz, bs, bt;
+		__m128 cx, cy, cz, cs, ct;
+		__m128 w;
+
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_XYZ_OFFSET, ax, ay, az, as );
+		at = _mm_setr_ps( verts[i+0].st[1], verts[i+1].st[1], verts[i+2].st[1], verts[i+3].st[1] );
+
+		bx = _mm_loadu_ps( verts[b[0]].xyz.ToFloatPtr() );
+		by = _mm_loadu_ps( verts[b[1]].xyz.ToFloatPtr() );
+		bz = _mm_loadu_ps( verts[b[2]].xyz.ToFloatPtr() );
+		bs = _mm_loadu_ps( verts[b[3]].xyz.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( bx, by, bz, bs );
+		bt = _mm_setr_ps( verts[b[0]].st[1], verts[b[1]].st[1], verts[b[2]].st[1], verts[b[3]].st[1] );
+
+		cx = _mm_loadu_ps( verts[c[0]].xyz.ToFloatPtr() );
+		cy = _mm_loadu_ps( verts[c[1]].xyz.ToFloatPtr() );
+		cz = _mm_loadu_ps( verts[c[2]].xyz.ToFloatPtr() );
+		cs = _mm_loadu_ps( verts[c[3]].xyz.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( cx, cy, cz, cs );
+		ct = _mm_setr_ps( verts[c[0]].st[1], verts[c[1]].st[1], verts[c[2]].st[1], verts[c[3]].st[1] );
+
+		__m128 s0 = _mm_setr_ps( dt[0].normalizationScale[0], dt[1].normalizationScale[0], dt[2].normalizationScale[0], dt[3].normalizationScale[0] );
+		__m128 s1 = _mm_setr_ps( dt[0].normalizationScale[1], dt[1].normalizationScale[1], dt[2].normalizationScale[1], dt[3].normalizationScale[1] );
+		__m128 s2 = _mm_setr_ps( dt[0].normalizationScale[2], dt[1].normalizationScale[2], dt[2].normalizationScale[2], dt[3].normalizationScale[2] );
+
+		__m128 d0 = _mm_sub_ps( bx, ax );
+		__m128 d1 = _mm_sub_ps( by, ay );
+		__m128 d2 = _mm_sub_ps( bz, az );
+		__m128 d4 = _mm_sub_ps( bt, at );
+		__m128 d5 = _mm_sub_ps( cx, ax );
+		__m128 d6 = _mm_sub_ps( cy, ay );
+		__m128 d7 = _mm_sub_ps( cz, az );
+		__m128 d9 = _mm_sub_ps( ct, at );
+
+		__m128 n0 = _mm_mul_ps( s2, _mm_sub_ps( _mm_mul_ps( d6, d2 ), _mm_mul_ps( d7, d1 ) ) );
+		__m128 n1 = _mm_mul_ps( s2, _mm_sub_ps( _mm_mul_ps( d7, d0 ), _mm_mul_ps( d5, d2 ) ) );
+		__m128 n2 = _mm_mul_ps( s2, _mm_sub_ps( _mm_mul_ps( d5, d1 ), _mm_mul_ps( d6, d0 ) ) );
+
+		__m128 t0 = _mm_mul_ps( s0, _mm_sub_ps( _mm_mul_ps( d0, d9 ), _mm_mul_ps( d4, d5 ) ) );
+		__m128 t1 = _mm_mul_ps( s0, _mm_sub_ps( _mm_mul_ps( d1, d9 ), _mm_mul_ps( d4, d6 ) ) );
+		__m128 t2 = _mm_mul_ps( s0, _mm_sub_ps( _mm_mul_ps( d2, d9 ), _mm_mul_ps( d4, d7 ) ) );
+
+		// the generic code is compiled with DERIVE_UNSMOOTHED_BITANGENT
+		__m128 t3 = _mm_mul_ps( s1, _mm_sub_ps( _mm_mul_ps( n2, t1 ), _mm_mul_ps( n1, t2 ) ) );
+		__m128 t4 = _mm_mul_ps( s1, _mm_sub_ps( _mm_mul_ps( n0, t2 ), _mm_mul_ps( n2, t0 ) ) );
+		__m128 t5 = _mm_mul_ps( s1, _mm_sub_ps( _mm_mul_ps( n1, t0 ), _mm_mul_ps( n0, t1 ) ) );
+
+		// the normal and both tangents are 9 consecutive floats
+		w = t0;
+		_MM_TRANSPOSE4_PS( n0, n1, n2, w );
+		_MM_TRANSPOSE4_PS( t1, t2, t3, t4 );
+		float f[4];
+		_mm_storeu_ps( f, t5 );
+		for ( int j = 0; j < 4; j++ ) {
+			float *p = verts[i+j].normal.ToFloatPtr();
+			__m128 r0 = j == 0 ? n0 : j == 1 ? n1 : j == 2 ? n2 : w;
+			__m128 r1 = j == 0 ? t1 : j == 1 ? t2 : j == 2 ? t3 : t4;
+			_mm_storeu_ps( p + 0, r0 );
+			_mm_storeu_ps( p + 4, r1 );
+			p[8] = f[j];
+		}
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		idDrawVert *a, *b, *c;
+		float d0, d1, d2, d4;
+		float d5, d6, d7, d9;
+		float s0, s1, s2;
+		float n0, n1, n2;
+		float t0, t1, t2;
+		float t3, t4, t5;
+
+		const dominantTri_s &dt = dominantTris[i];
+
+		a = verts + i;
+		b = verts + dt.v2;
+		c = verts + dt.v3;
+
+		d0 = b->xyz[0] - a->xyz[0];
+		d1 = b->xyz[1] - a->xyz[1];
+		d2 = b->xyz[2] - a->xyz[2];
+		d4 = b->st[1] - a->st[1];
+
+		d5 = c->xyz[0] - a->xyz[0];
+		d6 = c->xyz[1] - a->xyz[1];
+		d7 = c->xyz[2] - a->xyz[2];
+		d9 = c->st[1] - a->st[1];
+
+		s0 = dt.normalizationScale[0];
+		s1 = dt.normalizationScale[1];
+		s2 = dt.normalizationScale[2];
+
+		n0 = s2 * ( d6 * d2 - d7 * d1 );
+		n1 = s2 * ( d7 * d0 - d5 * d2 );
+		n2 = s2 * ( d5 * d1 - d6 * d0 );
+
+		t0 = s0 * ( d0 * d9 - d4 * d5 );
+		t1 = s0 * ( d1 * d9 - d4 * d6 );
+		t2 = s0 * ( d2 * d9 - d4 * d7 );
+
+		t3 = s1 * ( n2 * t1 - n1 * t2 );
+		t4 = s1 * ( n0 * t2 - n2 * t0 );
+		t5 = s1 * ( n1 * t0 - n0 * t1 );
+
+		a->normal[0] = n0;
+		a->normal[1] = n1;
+		a->normal[2] = n2;
+
+		a->tangents[0][0] = t0;
+		a->tangents[0][1] = t1;
+		a->tangents[0][2] = t2;
+
+		a->tangents[1][0] = t3;
+		a->tangents[1][1] = t4;
+		a->tangents[1][2] = t5;
+	}
+}
+
+/*
+============
+idSIMD_SSE::NormalizeTangents
+
+	Normalizes each vertex normal and projects and normalizes the
+	tangent vectors onto the plane orthogonal to the vertex normal.
+============
+*/
+void VPCALL idSIMD_SSE::NormalizeTangents( idDrawVert *verts, const int numVerts ) {
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		__m128 nx, ny, nz, t0x, t0y, t0z, t1x, t1y, t1z, w;
+
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_NORMAL_OFFSET, nx, ny, nz, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_TANGENT0_OFFSET, t0x, t0y, t0z, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_TANGENT1_OFFSET, t1x, t1y, t1z, w );
+
+		__m128 f = SSE_RSqrt( SSE_Dot3( nx, ny, nz, nx, ny, nz ) );
+		nx = _mm_mul_ps( nx, f );
+		ny = _mm_mul_ps( ny, f );
+		nz = _mm_mul_ps( nz, f );
+
+		__m128 d = SSE_Dot3( t0x, t0y, t0z, nx, ny, nz );
+		t0x = _mm_sub_ps( t0x, _mm_mul_ps( nx, d ) );
+		t0y = _mm_sub_ps( t0y, _mm_mul_ps( ny, d ) );
+		t0z = _mm_sub_ps( t0z, _mm_mul_ps( nz, d ) );
+		f = SSE_RSqrt( SSE_Dot3( t0x, t0y, t0z, t0x, t0y, t0z ) );
+		t0x = _mm_mul_ps( t0x, f );
+		t0y = _mm_mul_ps( t0y, f );
+		t0z = _mm_mul_ps( t0z, f );
+
+		d = SSE_Dot3( t1x, t1y, t1z, nx, ny, nz );
+		t1x = _mm_sub_ps( t1x, _mm_mul_ps( nx, d ) );
+		t1y = _mm_sub_ps( t1y, _mm_mul_ps( ny, d ) );
+		t1z = _mm_sub_ps( t1z, _mm_mul_ps( nz, d ) );
+		f = SSE_RSqrt( SSE_Dot3( t1x, t1y, t1z, t1x, t1y, t1z ) );
+		t1x = _mm_mul_ps( t1x, f );
+		t1y = _mm_mul_ps( t1y, f );
+		t1z = _mm_mul_ps( t1z, f );
+
+		// the normal and both tangents are 9 consecutive floats
+		_MM_TRANSPOSE4_PS( nx, ny, nz, t0x );
+		_MM_TRANSPOSE4_PS( t0y, t0z, t1x, t1y );
+		float last[4];
+		_mm_storeu_ps( last, t1z );
+		for ( int j = 0; j < 4; j++ ) {
+			float *p = verts[i+j].normal.ToFloatPtr();
+			__m128 r0 = j == 0 ? nx : j == 1 ? ny : j == 2 ? nz : t0x;
+			__m128 r1 = j == 0 ? t0y : j == 1 ? t0z : j == 2 ? t1x : t1y;
+			_mm_storeu_ps( p + 0, r0 );
+			_mm_storeu_ps( p + 4, r1 );
+			p[8] = last[j];
+		}
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		idVec3 &v = verts[i].normal;
+		float f;
+
+		f = idMath::RSqrt( v.x * v.x + v.y * v.y + v.z * v.z );
+		v.x *= f; v.y *= f; v.z *= f;
+
+		for ( int j = 0; j < 2; j++ ) {
+			idVec3 &t = verts[i].tangents[j];
+
+			t -= ( t * v ) * v;
+			f = idMath::RSqrt( t.x * t.x + t.y * t.y + t.z * t.z );
+			t.x *= f; t.y *= f; t.z *= f;
+		}
+	}
+}
+
+/*
+============
+SSE_MarkUsedVerts
+============
+*/
+static bool *SSE_MarkUsedVerts( bool *used, const int numVerts, const int *indexes, const int numIndexes ) {
+	memset( used, 0, numVerts * sizeof( used[0] ) );
+	for ( int i = numIndexes - 1; i >= 0; i-- ) {
+		used[indexes[i]] = true;
+	}
+	return used;
+}
+
+/*
+============
+idSIMD_SSE::CreateTextureSpaceLightVectors
+
+	Calculates light vectors in texture space for the given triangle vertices.
+	For each vertex the direction towards the light origin is projected onto texture space.
+	The light vectors are only calculated for the vertices referenced by the indexes.
+============
+*/
+void VPCALL idSIMD_SSE::CreateTextureSpaceLightVectors( idVec3 *lightVectors, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	bool *used = SSE_MarkUsedVerts( (bool *)_alloca16( numVerts * sizeof( bool ) ), numVerts, indexes, numIndexes );
+	__m128 lx = _mm_set1_ps( lightOrigin.x );
+	__m128 ly = _mm_set1_ps( lightOrigin.y );
+	__m128 lz = _mm_set1_ps( lightOrigin.z );
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		if ( !( used[i+0] | used[i+1] | used[i+2] | used[i+3] ) ) {
+			continue;
+		}
+		__m128 x, y, z, w;
+		__m128 nx, ny, nz, t0x, t0y, t0z, t1x, t1y, t1z;
+
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_NORMAL_OFFSET, nx, ny, nz, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_TANGENT0_OFFSET, t0x, t0y, t0z, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_TANGENT1_OFFSET, t1x, t1y, t1z, w );
+
+		x = _mm_sub_ps( lx, x );
+		y = _mm_sub_ps( ly, y );
+		z = _mm_sub_ps( lz, z );
+
+		__m128 r0 = SSE_Dot3( x, y, z, t0x, t0y, t0z );
+		__m128 r1 = SSE_Dot3( x, y, z, t1x, t1y, t1z );
+		__m128 r2 = SSE_Dot3( x, y, z, nx, ny, nz );
+		__m128 r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+		if ( used[i+0] ) SSE_StoreVec3( lightVectors[i+0].ToFloatPtr(), r0 );
+		if ( used[i+1] ) SSE_StoreVec3( lightVectors[i+1].ToFloatPtr(), r1 );
+		if ( used[i+2] ) SSE_StoreVec3( lightVectors[i+2].ToFloatPtr(), r2 );
+		if ( used[i+3] ) SSE_StoreVec3( lightVectors[i+3].ToFloatPtr(), r3 );
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		if ( !used[i] ) {
+			continue;
+		}
+
+		const idDrawVert *v = &verts[i];
+
+		idVec3 lightDir = lightOrigin - v->xyz;
+
+		lightVectors[i][0] = lightDir * v->tangents[0];
+		lightVectors[i][1] = lightDir * v->tangents[1];
+		lightVectors[i][2] = lightDir * v->normal;
+	}
+}
+
+/*
+============
+idSIMD_SSE::CreateSpecularTextureCoords
+
+	Calculates specular texture coordinates for the given triangle vertices.
+	For each vertex the normalized direction towards the light origin is added to the
+	normalized direction towards the view origin and the result is projected onto texture space.
+	The texture coordinates are only calculated for the vertices referenced by the indexes.
+============
+*/
+void VPCALL idSIMD_SSE::CreateSpecularTextureCoords( idVec4 *texCoords, const idVec3 &lightOrigin, const idVec3 &viewOrigin, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	bool *used = SSE_MarkUsedVerts( (bool *)_alloca16( numVerts * sizeof( bool ) ), numVerts, indexes, numIndexes );
+	__m128 lx = _mm_set1_ps( lightOrigin.x );
+	__m128 ly = _mm_set1_ps( lightOrigin.y );
+	__m128 lz = _mm_set1_ps( lightOrigin.z );
+	__m128 vx = _mm_set1_ps( viewOrigin.x );
+	__m128 vy = _mm_set1_ps( viewOrigin.y );
+	__m128 vz = _mm_set1_ps( viewOrigin.z );
+	int i;
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		if ( !( used[i+0] | used[i+1] | used[i+2] | used[i+3] ) ) {
+			continue;
+		}
+		__m128 x, y, z, w;
+		__m128 nx, ny, nz, t0x, t0y, t0z, t1x, t1y, t1z;
+
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_XYZ_OFFSET, x, y, z, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_NORMAL_OFFSET, nx, ny, nz, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_TANGENT0_OFFSET, t0x, t0y, t0z, w );
+		SSE_LoadDrawVerts( verts + i, DRAWVERT_TANGENT1_OFFSET, t1x, t1y, t1z, w );
+
+		__m128 ldx = _mm_sub_ps( lx, x );
+		__m128 ldy = _mm_sub_ps( ly, y );
+		__m128 ldz = _mm_sub_ps( lz, z );
+		__m128 vdx = _mm_sub_ps( vx, x );
+		__m128 vdy = _mm_sub_ps( vy, y );
+		__m128 vdz = _mm_sub_ps( vz, z );
+
+		__m128 f = SSE_RSqrt( SSE_Dot3( ldx, ldy, ldz, ldx, ldy, ldz ) );
+		ldx = _mm_mul_ps( ldx, f );
+		ldy = _mm_mul_ps( ldy, f );
+		ldz = _mm_mul_ps( ldz, f );
+
+		f = SSE_RSqrt( SSE_Dot3( vdx, vdy, vdz, vdx, vdy, vdz ) );
+		ldx = _mm_add_ps( ldx, _mm_mul_ps( vdx, f ) );
+		ldy = _mm_add_ps( ldy, _mm_mul_ps( vdy, f ) );
+		ldz = _mm_add_ps( ldz, _mm_mul_ps( vdz, f ) );
+
+		__m128 r0 = SSE_Dot3( ldx, ldy, ldz, t0x, t0y, t0z );
+		__m128 r1 = SSE_Dot3( ldx, ldy, ldz, t1x, t1y, t1z );
+		__m128 r2 = SSE_Dot3( ldx, ldy, ldz, nx, ny, nz );
+		__m128 r3 = _mm_set1_ps( 1.0f );
+		_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+		if ( used[i+0] ) _mm_storeu_ps( texCoords[i+0].ToFloatPtr(), r0 );
+		if ( used[i+1] ) _mm_storeu_ps( texCoords[i+1].ToFloatPtr(), r1 );
+		if ( used[i+2] ) _mm_storeu_ps( texCoords[i+2].ToFloatPtr(), r2 );
+		if ( used[i+3] ) _mm_storeu_ps( texCoords[i+3].ToFloatPtr(), r3 );
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		if ( !used[i] ) {
+			continue;
+		}
+
+		const idDrawVert *v = &verts[i];
+
+		idVec3 lightDir = lightOrigin - v->xyz;
+		idVec3 viewDir = viewOrigin - v->xyz;
+
+		float ilength;
+
+		ilength = idMath::RSqrt( lightDir * lightDir );
+		lightDir[0] *= ilength;
+		lightDir[1] *= ilength;
+		lightDir[2] *= ilength;
+
+		ilength = idMath::RSqrt( viewDir * viewDir );
+		viewDir[0] *= ilength;
+		viewDir[1] *= ilength;
+		viewDir[2] *= ilength;
+
+		lightDir += viewDir;
+
+		texCoords[i][0] = lightDir * v->tangents[0];
+		texCoords[i][1] = lightDir * v->tangents[1];
+		texCoords[i][2] = lightDir * v->normal;
+		texCoords[i][3] = 1.0f;
+	}
+}
+
+/*
+============
+idSIMD_SSE::CreateShadowCache
+============
+*/
+int VPCALL idSIMD_SSE::CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) {
+	__m128 xyzMask = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+	__m128 one = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+	__m128 light = SSE_LoadVec3( lightOrigin.ToFloatPtr() );
+	int outVerts = 0;
+
+	for ( int i = 0; i < numVerts; i++ ) {
+		if ( vertRemap[i] ) {
+			continue;
+		}
+		__m128 v = _mm_and_ps( _mm_loadu_ps( verts[i].xyz.ToFloatPtr() ), xyzMask );
+
+		// R_SetupProjection() builds the projection matrix with a slight crunch
+		// for depth, which keeps this w=0 division from rasterizing right at the
+		// wrap around point and causing depth fighting with the rear caps
+		_mm_storeu_ps( vertexCache[outVerts+0].ToFloatPtr(), _mm_or_ps( v, one ) );
+		_mm_storeu_ps( vertexCache[outVerts+1].ToFloatPtr(), _mm_and_ps( _mm_sub_ps( v, light ), xyzMask ) );
+		vertRemap[i] = outVerts;
+		outVerts += 2;
+	}
+	return outVerts;
+}
+
+/*
+============
+idSIMD_SSE::CreateVertexProgramShadowCache
+============
+*/
+int VPCALL idSIMD_SSE::CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) {
+	__m128 xyzMask = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+	__m128 one = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+
+	for ( int i = 0; i < numVerts; i++ ) {
+		__m128 v = _mm_and_ps( _mm_loadu_ps( verts[i].xyz.ToFloatPtr() ), xyzMask );
+		_mm_storeu_ps( vertexCache[i*2+0].ToFloatPtr(), _mm_or_ps( v, one ) );
+		_mm_storeu_ps( vertexCache[i*2+1].ToFloatPtr(), v );
+	}
+	return numVerts * 2;
+}
+
+/*
+============
+SSE_StoreUpSampled
+
+  stores four consecutive interleaved samples duplicated for 44kHz output
+============
+*/
+static ID_INLINE void SSE_StoreUpSampled( float *dest, const __m128 v, const int kHz, const int numChannels ) {
+	if ( kHz == 11025 ) {
+		if ( numChannels == 1 ) {
+			_mm_storeu_ps( dest +  0, _mm_shuffle_ps( v, v, R_SHUFFLEPS( 0, 0, 0, 0 ) ) );
+			_mm_storeu_ps( dest +  4, _mm_shuffle_ps( v, v, R_SHUFFLEPS( 1, 1, 1, 1 ) ) );
+			_mm_storeu_ps( dest +  8, _mm_shuffle_ps( v, v, R_SHUFFLEPS( 2, 2, 2, 2 ) ) );
+			_mm_storeu_ps( dest + 12, _mm_shuffle_ps( v, v, R_SHUFFLEPS( 3, 3, 3, 3 ) ) );
+		} else {
+			__m128 lo = _mm_movelh_ps( v, v );
+			__m128 hi = _mm_movehl_ps( v, v );
+			_mm_storeu_ps( dest +  0, lo );
+			_mm_storeu_ps( dest +  4, lo );
+			_mm_storeu_ps( dest +  8, hi );
+			_mm_storeu_ps( dest + 12, hi );
+		}
+	} else if ( kHz == 22050 ) {
+		if ( numChannels == 1 ) {
+			_mm_storeu_ps( dest + 0, _mm_unpacklo_ps( v, v ) );
+			_mm_storeu_ps( dest + 4, _mm_unpackhi_ps( v, v ) );
+		} else {
+			_mm_storeu_ps( dest + 0, _mm_movelh_ps( v, v ) );
+			_mm_storeu_ps( dest + 4, _mm_movehl_ps( v, v ) );
+		}
+	} else {
+		_mm_storeu_ps( dest, v );
+	}
+}
+
+/*
+============
+idSIMD_SSE::UpSamplePCMTo44kHz
+
+  Duplicate samples for 44kHz output.
+============
+*/
+void idSIMD_SSE::UpSamplePCMTo44kHz( float *dest, const short *src, const int numSamples, const int kHz, const int numChannels ) {
+	int scale;
+
+	if ( kHz == 11025 ) {
+		scale = 4;
+	} else if ( kHz == 22050 ) {
+		scale = 2;
+	} else if ( kHz == 44100 ) {
+		scale = 1;
+	} else {
+		assert( 0 );
+		return;
+	}
+
+	int i;
+	for ( i = 0; i + 4 <= numSamples; i += 4 ) {
+		__m128i s = _mm_loadl_epi64( (const __m128i *) ( src + i ) );
+		s = _mm_srai_epi32( _mm_unpacklo_epi16( s, s ), 16 );
+		SSE_StoreUpSampled( dest + i * scale, _mm_cvtepi32_ps( s ), kHz, numChannels );
+	}
+	if ( i < numSamples ) {
+		idSIMD_Generic::UpSamplePCMTo44kHz( dest + i * scale, src + i, numSamples - i, kHz, numChannels );
+	}
+}
+
+/*
+============
+idSIMD_SSE::UpSampleOGGTo44kHz
+
+  Duplicate samples for 44kHz output.
+============
+*/
+void idSIMD_SSE::UpSampleOGGTo44kHz( float *dest, const float * const *ogg, const int numSamples, const int kHz, const int numChannels ) {
+	__m128 scale = _mm_set1_ps( 32768.0f );
+	int destScale;
+
+	if ( kHz == 11025 ) {
+		destScale = 4;
+	} else if ( kHz == 22050 ) {
+		destScale = 2;
+	} else if ( kHz == 44100 ) {
+		destScale = 1;
+	} else {
+		assert( 0 );
+		return;
+	}
+
+	int i;
+	if ( numChannels == 1 ) {
+		for ( i = 0; i + 4 <= numSamples; i += 4 ) {
+			SSE_StoreUpSampled( dest + i * destScale, _mm_mul_ps( _mm_loadu_ps( ogg[0] + i ), scale ), kHz, 1 );
+		}
+		for ( ; i < numSamples; i++ ) {
+			float s = ogg[0][i] * 32768.0f;
+			for ( int j = 0; j < destScale; j++ ) {
+				dest[i*destScale+j] = s;
+			}
+		}
+	} else {
+		for ( i = 0; i + 4 <= ( numSamples >> 1 ); i += 4 ) {
+			__m128 l = _mm_mul_ps( _mm_loadu_ps( ogg[0] + i ), scale );
+			__m128 r = _mm_mul_ps( _mm_loadu_ps( ogg[1] + i ), scale );
+			SSE_StoreUpSampled( dest + ( i * 2 + 0 ) * destScale, _mm_unpacklo_ps( l, r ), kHz, 2 );
+			SSE_StoreUpSampled( dest + ( i * 2 + 4 ) * destScale, _mm_unpackhi_ps( l, r ), kHz, 2 );
+		}
+		for ( ; i < ( numSamples >> 1 ); i++ ) {
+			float l = ogg[0][i] * 32768.0f;
+			float r = ogg[1][i] * 32768.0f;
+			for ( int j = 0; j < destScale; j++ ) {
+				dest[i*2*destScale+j*2+0] = l;
+				dest[i*2*destScale+j*2+1] = r;
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE::MixSoundTwoSpeakerMono
+
+  The volume ramp is advanced with the same sequence of additions as the generic code.
+  Each vector holds the left and right volume of two consecutive samples.
+============
+*/
+void VPCALL idSIMD_SSE::MixSoundTwoSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+	__m128 inc = _mm_setr_ps( incL, incR, incL, incR );
+	__m128 ramp = _mm_setr_ps( lastV[0], lastV[1], lastV[0] + incL, lastV[1] + incR );
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	for( int j = 0; j < MIXBUFFER_SAMPLES; j += 2 ) {
+		__m128 s = _mm_castpd_ps( _mm_load_sd( (const double *) ( samples + j ) ) );
+		s = _mm_unpacklo_ps( s, s );
+		_mm_storeu_ps( mixBuffer + j * 2, _mm_add_ps( _mm_loadu_ps( mixBuffer + j * 2 ), _mm_mul_ps( s, ramp ) ) );
+		__m128 next = _mm_add_ps( _mm_movehl_ps( ramp, ramp ), inc );
+		ramp = _mm_movelh_ps( next, _mm_add_ps( next, inc ) );
+	}
+}
+
+/*
+============
+idSIMD_SSE::MixSoundTwoSpeakerStereo
+============
+*/
+void VPCALL idSIMD_SSE::MixSoundTwoSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+	__m128 inc = _mm_setr_ps( incL, incR, incL, incR );
+	__m128 ramp = _mm_setr_ps( lastV[0], lastV[1], lastV[0] + incL, lastV[1] + incR );
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	for( int j = 0; j < MIXBUFFER_SAMPLES; j += 2 ) {
+		__m128 s = _mm_loadu_ps( samples + j * 2 );
+		_mm_storeu_ps( mixBuffer + j * 2, _mm_add_ps( _mm_loadu_ps( mixBuffer + j * 2 ), _mm_mul_ps( s, ramp ) ) );
+		__m128 next = _mm_add_ps( _mm_movehl_ps( ramp, ramp ), inc );
+		ramp = _mm_movelh_ps( next, _mm_add_ps( next, inc ) );
+	}
+}
+
+/*
+============
+SSE_MixSoundSixSpeaker
+
+  Two samples are mixed per iteration into three vectors. The six volumes are kept
+  in two vectors which are advanced one addition per sample like the generic code.
+============
+*/
+static void SSE_MixSoundSixSpeaker( float *mixBuffer, const float *samples, const bool stereo, const float lastV[6], const float currentV[6] ) {
+	float inc[6];
+	for ( int k = 0; k < 6; k++ ) {
+		inc[k] = ( currentV[k] - lastV[k] ) / MIXBUFFER_SAMPLES;
+	}
+	__m128 inc0 = _mm_loadu_ps( inc );
+	__m128 inc1 = _mm_setr_ps( inc[4], inc[5], 0.0f, 0.0f );
+	__m128 g0 = _mm_loadu_ps( lastV );
+	__m128 g1 = _mm_setr_ps( lastV[4], lastV[5], 0.0f, 0.0f );
+
+	for( int i = 0; i < MIXBUFFER_SAMPLES; i += 2 ) {
+		__m128 s0, s1, s2;
+		if ( stereo ) {
+			__m128 p = _mm_loadu_ps( samples + i * 2 );
+			s0 = _mm_shuffle_ps( p, p, R_SHUFFLEPS( 0, 1, 0, 0 ) );
+			s1 = p;
+			s2 = _mm_shuffle_ps( p, p, R_SHUFFLEPS( 2, 2, 2, 3 ) );
+		} else {
+			__m128 p = _mm_castpd_ps( _mm_load_sd( (const double *) ( samples + i ) ) );
+			s0 = _mm_shuffle_ps( p, p, R_SHUFFLEPS( 0, 0, 0, 0 ) );
+			s1 = _mm_shuffle_ps( p, p, R_SHUFFLEPS( 0, 0, 1, 1 ) );
+			s2 = _mm_shuffle_ps( p, p, R_SHUFFLEPS( 1, 1, 1, 1 ) );
+		}
+
+		__m128 h0 = _mm_add_ps( g0, inc0 );
+		__m128 h1 = _mm_add_ps( g1, inc1 );
+
+		float *mix = mixBuffer + i * 6;
+		_mm_storeu_ps( mix + 0, _mm_add_ps( _mm_loadu_ps( mix + 0 ), _mm_mul_ps( s0, g0 ) ) );
+		_mm_storeu_ps( mix + 4, _mm_add_ps( _mm_loadu_ps( mix + 4 ), _mm_mul_ps( s1, _mm_movelh_ps( g1, h0 ) ) ) );
+		_mm_storeu_ps( mix + 8, _mm_add_ps( _mm_loadu_ps( mix + 8 ), _mm_mul_ps( s2, _mm_shuffle_ps( h0, h1, R_SHUFFLEPS( 2, 3, 0, 1 ) ) ) ) );
+
+		g0 = _mm_add_ps( h0, inc0 );
+		g1 = _mm_add_ps( h1, inc1 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::MixSoundSixSpeakerMono
+============
+*/
+void VPCALL idSIMD_SSE::MixSoundSixSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	assert( numSamples == MIXBUFFER_SAMPLES );
+	SSE_MixSoundSixSpeaker( mixBuffer, samples, false, lastV, currentV );
+}
+
+/*
+============
+idSIMD_SSE::MixSoundSixSpeakerStereo
+============
+*/
+void VPCALL idSIMD_SSE::MixSoundSixSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	assert( numSamples == MIXBUFFER_SAMPLES );
+	SSE_MixSoundSixSpeaker( mixBuffer, samples, true, lastV, currentV );
+}
+
+#endif /* ID_SIMD_SSE_INTRINSICS */
+
+#if defined(ID_SIMD_SSE_SOA)
+
+/*
+===============================================================================
+
+	Structure of arrays joint kernels.
+
+	These only use SSE instructions so they are shared by the MSVC and the
+	intrinsics builds, including the 32 bit pentium3 build which does not
+	get any of the SSE2 intrinsics routines above.
+
+===============================================================================
+*/
+
+#include <xmmintrin.h>
+
+static const float SSE_SoA_tiny			= 1e-10f;
+static const float SSE_SoA_rsqrtMin		= 1e-30f;
+
+static const float SSE_SoA_sin_c0		= -2.39e-08f;
+static const float SSE_SoA_sin_c1		=  2.7526e-06f;
+static const float SSE_SoA_sin_c2		= -1.98409e-04f;
+static const float SSE_SoA_sin_c3		=  8.3333315e-03f;
+static const float SSE_SoA_sin_c4		= -1.666666664e-01f;
+
+static const float SSE_SoA_atan_c0		=  0.0028662257f;
+static const float SSE_SoA_atan_c1		= -0.0161657367f;
+static const float SSE_SoA_atan_c2		=  0.0429096138f;
+static const float SSE_SoA_atan_c3		= -0.0752896400f;
+static const float SSE_SoA_atan_c4		=  0.1065626393f;
+static const float SSE_SoA_atan_c5		= -0.1420889944f;
+static const float SSE_SoA_atan_c6		=  0.1999355085f;
+static const float SSE_SoA_atan_c7		= -0.3333314528f;
+
+/*
+============
+SSE_SoASelect
+
+  returns mask ? b : a for each lane
+============
+*/
+static ID_INLINE __m128 SSE_SoASelect( const __m128 a, const __m128 b, const __m128 mask ) {
+	return _mm_or_ps( _mm_and_ps( mask, b ), _mm_andnot_ps( mask, a ) );
+}
+
+/*
+============
+SSE_SoARSqrt
+
+  reciprocal square root with one Newton-Raphson iteration
+============
+*/
+static ID_INLINE __m128 SSE_SoARSqrt( const __m128 x ) {
+	const __m128 c = _mm_max_ps( x, _mm_set1_ps( SSE_SoA_rsqrtMin ) );
+	const __m128 r = _mm_rsqrt_ps( c );
+	// r * ( 1.5f - 0.5f * c * r * r )
+	const __m128 h = _mm_mul_ps( _mm_mul_ps( c, _mm_set1_ps( 0.5f ) ), r );
+	return _mm_mul_ps( r, _mm_sub_ps( _mm_set1_ps( 1.5f ), _mm_mul_ps( h, r ) ) );
+}
+
+/*
+============
+SSE_SoASinZeroHalfPI
+
+  The angles must be between zero and half PI.
+============
+*/
+static ID_INLINE __m128 SSE_SoASinZeroHalfPI( const __m128 a ) {
+	const __m128 s = _mm_mul_ps( a, a );
+	__m128 t = _mm_set1_ps( SSE_SoA_sin_c0 );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_sin_c1 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_sin_c2 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_sin_c3 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_sin_c4 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( 1.0f ) );
+	return _mm_mul_ps( t, a );
+}
+
+/*
+============
+SSE_SoAATanPositive
+
+  Both 'x' and 'y' must be positive.
+============
+*/
+static ID_INLINE __m128 SSE_SoAATanPositive( const __m128 y, const __m128 x ) {
+	const __m128 gt = _mm_cmpgt_ps( y, x );
+	const __m128 num = SSE_SoASelect( y, x, gt );
+	const __m128 den = SSE_SoASelect( x, y, gt );
+	// a = -x / y or y / x
+	const __m128 a = _mm_xor_ps( _mm_div_ps( num, den ), _mm_and_ps( gt, _mm_set1_ps( -0.0f ) ) );
+	const __m128 d = _mm_and_ps( gt, _mm_set1_ps( idMath::HALF_PI ) );
+	const __m128 s = _mm_mul_ps( a, a );
+	__m128 t = _mm_set1_ps( SSE_SoA_atan_c0 );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c1 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c2 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c3 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c4 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c5 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c6 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( SSE_SoA_atan_c7 ) );
+	t = _mm_add_ps( _mm_mul_ps( t, s ), _mm_set1_ps( 1.0f ) );
+	return _mm_add_ps( _mm_mul_ps( t, a ), d );
+}
+
+/*
+============
+idSIMD_SSE::BlendJointsSoA
+
+  Four joints are blended at a time. The joints stay in registers while all
+  layers are blended over them, lanes with a layer lerp of zero or less keep
+  the joint and lanes with a lerp of one or more take the layer joint.
+============
+*/
+void VPCALL idSIMD_SSE::BlendJointsSoA( float *joints, const float * const *blendJoints, const float * const *lerps, const int numBlends, const int numJoints ) {
+	int i, j;
+	const int stride = JointQuatSoAStride( numJoints );
+
+	const __m128 signBitMask = _mm_set1_ps( -0.0f );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 zero = _mm_setzero_ps();
+
+	for ( i = 0; i < numJoints; i += 4 ) {
+		float *jointPtr = joints + i;
+
+		__m128 jq0 = _mm_loadu_ps( jointPtr + 0 * stride );
+		__m128 jq1 = _mm_loadu_ps( jointPtr + 1 * stride );
+		__m128 jq2 = _mm_loadu_ps( jointPtr + 2 * stride );
+		__m128 jq3 = _mm_loadu_ps( jointPtr + 3 * stride );
+		__m128 jt0 = _mm_loadu_ps( jointPtr + 4 * stride );
+		__m128 jt1 = _mm_loadu_ps( jointPtr + 5 * stride );
+		__m128 jt2 = _mm_loadu_ps( jointPtr + 6 * stride );
+
+		for ( j = 0; j < numBlends; j++ ) {
+			const __m128 vlerp = _mm_loadu_ps( lerps[j] + i );
+			const __m128 keep = _mm_cmple_ps( vlerp, zero );
+
+			if ( _mm_movemask_ps( keep ) == 0xF ) {
+				continue;
+			}
+
+			const float *blendPtr = blendJoints[j] + i;
+			const __m128 copy = _mm_cmpge_ps( vlerp, one );
+
+			const __m128 bq0 = _mm_loadu_ps( blendPtr + 0 * stride );
+			const __m128 bq1 = _mm_loadu_ps( blendPtr + 1 * stride );
+			const __m128 bq2 = _mm_loadu_ps( blendPtr + 2 * stride );
+			const __m128 bq3 = _mm_loadu_ps( blendPtr + 3 * stride );
+			const __m128 bt0 = _mm_loadu_ps( blendPtr + 4 * stride );
+			const __m128 bt1 = _mm_loadu_ps( blendPtr + 5 * stride );
+			const __m128 bt2 = _mm_loadu_ps( blendPtr + 6 * stride );
+
+			if ( _mm_movemask_ps( _mm_or_ps( keep, copy ) ) == 0xF ) {
+				jq0 = SSE_SoASelect( bq0, jq0, keep );
+				jq1 = SSE_SoASelect( bq1, jq1, keep );
+				jq2 = SSE_SoASelect( bq2, jq2, keep );
+				jq3 = SSE_SoASelect( bq3, jq3, keep );
+				jt0 = SSE_SoASelect( bt0, jt0, keep );
+				jt1 = SSE_SoASelect( bt1, jt1, keep );
+				jt2 = SSE_SoASelect( bt2, jt2, keep );
+				continue;
+			}
+
+			__m128 t0 = _mm_add_ps( _mm_mul_ps( vlerp, _mm_sub_ps( bt0, jt0 ) ), jt0 );
+			__m128 t1 = _mm_add_ps( _mm_mul_ps( vlerp, _mm_sub_ps( bt1, jt1 ) ), jt1 );
+			__m128 t2 = _mm_add_ps( _mm_mul_ps( vlerp, _mm_sub_ps( bt2, jt2 ) ), jt2 );
+
+			__m128 cosom = _mm_mul_ps( jq0, bq0 );
+			cosom = _mm_add_ps( _mm_mul_ps( jq1, bq1 ), cosom );
+			cosom = _mm_add_ps( _mm_mul_ps( jq2, bq2 ), cosom );
+			cosom = _mm_add_ps( _mm_mul_ps( jq3, bq3 ), cosom );
+
+			const __m128 signBit = _mm_and_ps( cosom, signBitMask );
+			cosom = _mm_xor_ps( cosom, signBit );
+
+			__m128 scale0 = _mm_sub_ps( one, _mm_mul_ps( cosom, cosom ) );
+			scale0 = SSE_SoASelect( scale0, _mm_set1_ps( SSE_SoA_tiny ), _mm_cmple_ps( scale0, zero ) );
+			const __m128 sinom = SSE_SoARSqrt( scale0 );
+			scale0 = _mm_mul_ps( scale0, sinom );
+
+			__m128 omega0 = SSE_SoAATanPositive( scale0, cosom );
+			const __m128 omega1 = _mm_mul_ps( vlerp, omega0 );
+			omega0 = _mm_sub_ps( omega0, omega1 );
+
+			scale0 = _mm_mul_ps( SSE_SoASinZeroHalfPI( omega0 ), sinom );
+			__m128 scale1 = _mm_mul_ps( SSE_SoASinZeroHalfPI( omega1 ), sinom );
+			scale1 = _mm_xor_ps( scale1, signBit );
+
+			__m128 q0 = _mm_add_ps( _mm_mul_ps( scale0, jq0 ), _mm_mul_ps( scale1, bq0 ) );
+			__m128 q1 = _mm_add_ps( _mm_mul_ps( scale0, jq1 ), _mm_mul_ps( scale1, bq1 ) );
+			__m128 q2 = _mm_add_ps( _mm_mul_ps( scale0, jq2 ), _mm_mul_ps( scale1, bq2 ) );
+			__m128 q3 = _mm_add_ps( _mm_mul_ps( scale0, jq3 ), _mm_mul_ps( scale1, bq3 ) );
+
+			jq0 = SSE_SoASelect( SSE_SoASelect( q0, bq0, copy ), jq0, keep );
+			jq1 = SSE_SoASelect( SSE_SoASelect( q1, bq1, copy ), jq1, keep );
+			jq2 = SSE_SoASelect( SSE_SoASelect( q2, bq2, copy ), jq2, keep );
+			jq3 = SSE_SoASelect( SSE_SoASelect( q3, bq3, copy ), jq3, keep );
+			jt0 = SSE_SoASelect( SSE_SoASelect( t0, bt0, copy ), jt0, keep );
+			jt1 = SSE_SoASelect( SSE_SoASelect( t1, bt1, copy ), jt1, keep );
+			jt2 = SSE_SoASelect( SSE_SoASelect( t2, bt2, copy ), jt2, keep );
+		}
+
+		_mm_storeu_ps( jointPtr + 0 * stride, jq0 );
+		_mm_storeu_ps( jointPtr + 1 * stride, jq1 );
+		_mm_storeu_ps( jointPtr + 2 * stride, jq2 );
+		_mm_storeu_ps( jointPtr + 3 * stride, jq3 );
+		_mm_storeu_ps( jointPtr + 4 * stride, jt0 );
+		_mm_storeu_ps( jointPtr + 5 * stride, jt1 );
+		_mm_storeu_ps( jointPtr + 6 * stride, jt2 );
+	}
+}
+
+/*
+============
+idSIMD_SSE::TransformJointsSoA
+
+  Four joints of a skeleton are converted to matrices at a time straight
+  from the component arrays, the conversion is the same as idQuat::ToMat3.
+  The matrices are then transformed to model space in hierarchy order with
+  one joint at a time in the registers like the AoS TransformJoints.
+============
+*/
+void VPCALL idSIMD_SSE::TransformJointsSoA( idJointMat * const *jointMats, const float *jointQuats, const int numSkeletons, const int *parents, const int numJoints ) {
+	int i, j, k, s;
+	const int stride = JointQuatSoAStride( numJoints );
+
+	assert( sizeof( idJointMat ) == 4 * 3 * 4 );
+
+	const __m128 one = _mm_set1_ps( 1.0f );
+	// the translation column only adds the parent translation
+	const __m128 tmask = _mm_cmpgt_ps( _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f ), _mm_setzero_ps() );
+
+	for ( s = 0; s < numSkeletons; s++ ) {
+		const float *q = jointQuats + s * JOINTQUAT_SOA_COMPONENTS * stride;
+		idJointMat *mats = jointMats[s];
+
+		for ( i = 0; i < numJoints; i += 4 ) {
+			ALIGN16( float m[12][4] );
+			int count = numJoints - i;
+
+			if ( count > 4 ) {
+				count = 4;
+			}
+
+			// the arrays are padded to a multiple of eight joints so the last group can be loaded whole
+			const __m128 qx = _mm_loadu_ps( q + 0 * stride + i );
+			const __m128 qy = _mm_loadu_ps( q + 1 * stride + i );
+			const __m128 qz = _mm_loadu_ps( q + 2 * stride + i );
+			const __m128 qw = _mm_loadu_ps( q + 3 * stride + i );
+
+			const __m128 x2 = _mm_add_ps( qx, qx );
+			const __m128 y2 = _mm_add_ps( qy, qy );
+			const __m128 z2 = _mm_add_ps( qz, qz );
+
+			const __m128 xx = _mm_mul_ps( qx, x2 );
+			const __m128 yy = _mm_mul_ps( qy, y2 );
+			const __m128 zz = _mm_mul_ps( qz, z2 );
+			const __m128 yz = _mm_mul_ps( qy, z2 );
+			const __m128 wx = _mm_mul_ps( qw, x2 );
+			const __m128 xy = _mm_mul_ps( qx, y2 );
+			const __m128 wz = _mm_mul_ps( qw, z2 );
+			const __m128 xz = _mm_mul_ps( qx, z2 );
+			const __m128 wy = _mm_mul_ps( qw, y2 );
+
+			_mm_store_ps( m[0*4+0], _mm_sub_ps( _mm_sub_ps( one, yy ), zz ) );
+			_mm_store_ps( m[1*4+1], _mm_sub_ps( _mm_sub_ps( one, xx ), zz ) );
+			_mm_store_ps( m[2*4+2], _mm_sub_ps( _mm_sub_ps( one, xx ), yy ) );
+			_mm_store_ps( m[2*4+1], _mm_sub_ps( yz, wx ) );
+			_mm_store_ps( m[1*4+2], _mm_add_ps( yz, wx ) );
+			_mm_store_ps( m[1*4+0], _mm_sub_ps( xy, wz ) );
+			_mm_store_ps( m[0*4+1], _mm_add_ps( xy, wz ) );
+			_mm_store_ps( m[0*4+2], _mm_sub_ps( xz, wy ) );
+			_mm_store_ps( m[2*4+0], _mm_add_ps( xz, wy ) );
+			_mm_store_ps( m[0*4+3], _mm_loadu_ps( q + 4 * stride + i ) );
+			_mm_store_ps( m[1*4+3], _mm_loadu_ps( q + 5 * stride + i ) );
+			_mm_store_ps( m[2*4+3], _mm_loadu_ps( q + 6 * stride + i ) );
+
+			for ( j = 0; j < count; j++ ) {
+				float *dst = mats[i+j].ToFloatPtr();
+				for ( k = 0; k < 12; k++ ) {
+					dst[k] = m[k][j];
+				}
+			}
+		}
+
+		for ( i = 1; i < numJoints; i++ ) {
+			assert( parents[i] < i );
+			float *m = mats[i].ToFloatPtr();
+			const float *p = mats[parents[i]].ToFloatPtr();
+
+			const __m128 p0 = _mm_loadu_ps( p + 0 );
+			const __m128 p1 = _mm_loadu_ps( p + 4 );
+			const __m128 p2 = _mm_loadu_ps( p + 8 );
+			const __m128 m0 = _mm_loadu_ps( m + 0 );
+			const __m128 m1 = _mm_loadu_ps( m + 4 );
+			const __m128 m2 = _mm_loadu_ps( m + 8 );
+
+
+			__m128 r0 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( m0, _mm_shuffle_ps( p0, p0, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ),
+								_mm_mul_ps( m1, _mm_shuffle_ps( p0, p0, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ),
+								_mm_mul_ps( m2, _mm_shuffle_ps( p0, p0, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+			__m128 r1 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( m0, _mm_shuffle_ps( p1, p1, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ),
+								_mm_mul_ps( m1, _mm_shuffle_ps( p1, p1, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ),
+								_mm_mul_ps( m2, _mm_shuffle_ps( p1, p1, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+			__m128 r2 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( m0, _mm_shuffle_ps( p2, p2, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ),
+								_mm_mul_ps( m1, _mm_shuffle_ps( p2, p2, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ),
+								_mm_mul_ps( m2, _mm_shuffle_ps( p2, p2, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+
+			_mm_storeu_ps( m + 0, _mm_add_ps( r0, _mm_and_ps( p0, tmask ) ) );
+			_mm_storeu_ps( m + 4, _mm_add_ps( r1, _mm_and_ps( p1, tmask ) ) );
+			_mm_storeu_ps( m + 8, _mm_add_ps( r2, _mm_and_ps( p2, tmask ) ) );
+		}
+	}
+}
+
+#endif /* ID_SIMD_SSE_SOA */
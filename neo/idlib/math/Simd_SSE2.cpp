@@ -874,4 +874,58 @@ void VPCALL idSIMD_SSE2::MixedSoundToSamples( short *samples, const float *mixBu
 	}
 }
 
-#endif /* _WIN32 */
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+/*
+============
+idSIMD_SSE2::GetName
+============
+*/
+const char * idSIMD_SSE2::GetName( void ) const {
+	return "MMX & SSE & SSE2";
+}
+
+/*
+============
+idSIMD_SSE2::MixedSoundToSamples
+
+  Samples are clamped to the short range and truncated like the generic code.
+============
+*/
+void VPCALL idSIMD_SSE2::MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples ) {
+	__m128 vmin = _mm_set1_ps( -32768.0f );
+	__m128 vmax = _mm_set1_ps( 32767.0f );
+	__m128i imin = _mm_set1_epi32( -32768 );
+	__m128i imax = _mm_set1_epi32( 32767 );
+	int i;
+
+	for ( i = 0; i + 8 <= numSamples; i += 8 ) {
+		__m128i s[2];
+		for ( int j = 0; j < 2; j++ ) {
+			__m128 m = _mm_loadu_ps( mixBuffer + i + j * 4 );
+			__m128i le = _mm_castps_si128( _mm_cmple_ps( m, vmin ) );
+			__m128i ge = _mm_castps_si128( _mm_cmpge_ps( m, vmax ) );
+			__m128i t = _mm_cvttps_epi32( m );
+			t = _mm_or_si128( _mm_andnot_si128( ge, t ), _mm_and_si128( ge, imax ) );
+			t = _mm_or_si128( _mm_andnot_si128( le, t ), _mm_and_si128( le, imin ) );
+			// keep the low 16 bits like the (short) cast of the generic code
+			s[j] = _mm_srai_epi32( _mm_slli_epi32( t, 16 ), 16 );
+		}
+		_mm_storeu_si128( (__m128i *) ( samples + i ), _mm_packs_epi32( s[0], s[1] ) );
+	}
+
+	for ( ; i < numSamples; i++ ) {
+		if ( mixBuffer[i] <= -32768.0f ) {
+			samples[i] = -32768;
+		} else if ( mixBuffer[i] >= 32767.0f ) {
+			samples[i] = 32767;
+		} else {
+			samples[i] = (short) mixBuffer[i];
+		}
+	}
+}
+
+#endif /* ID_SIMD_SSE_INTRINSICS */
@@ -51,6 +51,11 @@ public:
 
 	virtual void VPCALL MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples );
 
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+	virtual const char * VPCALL GetName( void ) const;
+
+	virtual void VPCALL MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples );
+
 #endif
 };
 
@@ -364,4 +364,15 @@ void VPCALL idSIMD_SSE3::TransformVerts( idDrawVert *verts, const int numVerts,
 #endif
 }
 
-#endif /* _WIN32 */
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+
+/*
+============
+idSIMD_SSE3::GetName
+============
+*/
+const char * idSIMD_SSE3::GetName( void ) const {
+	return "MMX & SSE & SSE2 & SSE3";
+}
+
+#endif /* ID_SIMD_SSE_INTRINSICS */
@@ -47,6 +47,9 @@ public:
 
 	virtual void VPCALL TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights );
 
+#elif defined(ID_SIMD_SSE_INTRINSICS)
+	virtual const char * VPCALL GetName( void ) const;
+
 #endif
 };
 
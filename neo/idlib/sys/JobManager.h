@@ -0,0 +1,104 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#ifndef __JOBMANAGER_H__
+#define __JOBMANAGER_H__
+
+/*
+===============================================================================
+
+	Job system
+
+	Work is handed to the worker threads as job lists. A job list is filled
+	with jobs, optionally made dependent on other job lists and submitted.
+	A submitted list starts once all the lists it depends on have completed.
+	The jobs of a list can run in any order on any of the worker threads.
+
+	Every worker thread owns a job queue. Jobs are spread over the queues when
+	a list starts, each worker runs the jobs from its own queue and steals jobs
+	from the other queues when it runs out of work. A thread waiting for a job
+	list helps running jobs until the list is done.
+
+	There is one worker thread per core minus one for the main thread unless
+	sys_jobThreads says otherwise.
+
+===============================================================================
+*/
+
+typedef void (*jobRun_t)( void *data );
+
+// runs the range [first, last)
+typedef void (*parallelForRun_t)( void *data, int first, int last );
+
+const int MAX_JOB_THREADS			= 32;
+
+class idJobList {
+public:
+	virtual						~idJobList( void ) {}
+
+	virtual const char *		GetName( void ) const = 0;
+
+								// removes all jobs and dependencies so the list can be filled again
+	virtual void				Clear( void ) = 0;
+								// the list may not be running while jobs are added
+	virtual void				AddJob( jobRun_t function, void *data ) = 0;
+	virtual int					NumJobs( void ) const = 0;
+								// the list will not start before the given list completed since it was last cleared
+	virtual void				AddDependency( idJobList *list ) = 0;
+
+	virtual void				Submit( void ) = 0;
+								// returns when all jobs completed, runs jobs on the calling thread while waiting
+	virtual void				Wait( void ) = 0;
+	virtual bool				IsSubmitted( void ) const = 0;
+	virtual bool				IsDone( void ) const = 0;
+};
+
+class idJobManager {
+public:
+	virtual						~idJobManager( void ) {}
+
+	virtual void				Init( void ) = 0;
+	virtual void				Shutdown( void ) = 0;
+
+	virtual idJobList *			AllocJobList( const char *name ) = 0;
+	virtual void				FreeJobList( idJobList *list ) = 0;
+
+								// splits [0, count) in ranges of granularity elements and waits for all of them
+								// a granularity of zero spreads the range over all threads
+	virtual void				ParallelFor( const char *name, int count, int granularity, parallelForRun_t function, void *data ) = 0;
+
+								// number of worker threads, zero if all jobs run on the waiting threads
+	virtual int					GetNumThreads( void ) const = 0;
+								// 1 to GetNumThreads() on the worker threads, 0 on any other thread
+	virtual int					GetThreadIndex( void ) const = 0;
+};
+
+extern idJobManager *			jobManager;
+
+#endif /* !__JOBMANAGER_H__ */
@@ -0,0 +1,108 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+/*
+===============================================================================
+
+	Frame profiler
+
+	Code is marked up with named zones which are recorded with the clock
+	ticks they started and ended at while a capture is running. Zones nest
+	and every thread records its zones into its own ring buffer so the
+	markers never lock. When the capture ends the zones of all threads are
+	written as a Chrome trace event file which can be loaded in
+	chrome://tracing or any other viewer that understands the format.
+
+	When no capture is running a marker costs a single flag test.
+
+	Zone names are stored as pointers and must stay valid until the capture
+	is written, string literals are best.
+
+===============================================================================
+*/
+
+class idProfiler {
+public:
+	virtual						~idProfiler( void ) {}
+
+	virtual void				Init( void ) = 0;
+	virtual void				Shutdown( void ) = 0;
+
+	bool						IsCapturing( void ) const { return capturing; }
+
+								// starts capturing for the given number of frames, the trace is written when done
+	virtual void				StartCapture( int numFrames, const char *fileName ) = 0;
+								// called once per engine frame to count down and write the capture
+	virtual void				EndFrame( void ) = 0;
+								// names the calling thread in the trace, threads without a name are numbered
+	virtual void				SetThreadName( const char *name ) = 0;
+
+								// only called while capturing, use idProfileZone instead of calling these directly
+	virtual void				BeginZone( const char *name ) = 0;
+	virtual void				EndZone( void ) = 0;
+
+protected:
+	volatile bool				capturing;
+};
+
+extern idProfiler *				profiler;
+
+/*
+===============================================================================
+
+	Profiles the scope it is declared in.
+
+===============================================================================
+*/
+
+class idProfileZone {
+public:
+								idProfileZone( const char *name );
+								~idProfileZone( void );
+
+private:
+	bool						active;
+};
+
+ID_INLINE idProfileZone::idProfileZone( const char *name ) {
+	active = ( profiler != NULL && profiler->IsCapturing() );
+	if ( active ) {
+		profiler->BeginZone( name );
+	}
+}
+
+ID_INLINE idProfileZone::~idProfileZone( void ) {
+	if ( active ) {
+		profiler->EndZone();
+	}
+}
+
+#endif /* !__PROFILER_H__ */
@@ -938,6 +938,8 @@ static filterName_t textureFilters[] = {
 	{"GL_NEAREST_MIPMAP_LINEAR", GL_NEAREST_MIPMAP_LINEAR, GL_NEAREST}
 };
 
+	R_SyncRenderThread();
+
 	// if these are changed dynamically, it will force another ChangeTextureFilter
 	image_filter.ClearModified();
 	image_anisotropy.ClearModified();
@@ -1550,6 +1550,10 @@ void	idImage::ActuallyLoadImage( bool checkForPrecompressed, bool fromBackEnd )
 	int		width, height;
 	byte	*pic;
 
+	// the front end may load an image while the r_smp back end thread
+	// has the GL context
+	R_SyncRenderThread();
+
 	// this is the ONLY place generatorFunction will ever be called
 	if ( generatorFunction ) {
 		generatorFunction( this );
@@ -1645,6 +1649,8 @@ PurgeImage
 */
 void idImage::PurgeImage() {
 	if ( texnum != TEXTURE_NOT_LOADED ) {
+		R_SyncRenderThread();
+
 		// sometimes is NULL when exiting with an error
 		if ( qglDeleteTextures ) {
 			qglDeleteTextures( 1, &texnum );	// this should be the ONLY place it is ever called!
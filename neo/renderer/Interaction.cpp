@@ -290,7 +290,7 @@ static srfTriangles_t *R_CreateLightTris( const idRenderEntityLocal *ent,
 	bool		includeBackFaces;
 	int			faceNum;
 
-	tr.pc.c_createLightTris++;
+	Sys_InterlockedIncrement( tr.pc.c_createLightTris );
 	c_backfaced = 0;
 	c_distance = 0;
 
@@ -821,21 +821,62 @@ The results of this are cached and valid until the light or entity change.
 ====================
 */
 void idInteraction::CreateInteraction( const idRenderModel *model ) {
-	const idMaterial *	lightShader = lightDef->lightShader;
-	const idMaterial*	shader;
-	bool				interactionGenerated;
-	idBounds			bounds;
+	CreateInteractionSurfaces( model );
+
+	if ( IsEmpty() ) {
+		MakeEmpty();
+	}
+}
 
-	tr.pc.c_createInteractions++;
+/*
+====================
+idInteraction::CreateInteractionSurfaces
+
+Does all the work of CreateInteraction, but only marks the interaction
+empty instead of relinking it, because the entity and light lists are
+shared with other entities.
+====================
+*/
+void idInteraction::CreateInteractionSurfaces( const idRenderModel *model ) {
+	interactionCacheKey_t	key;
+	idBounds				bounds;
+
+	Sys_InterlockedIncrement( tr.pc.c_createInteractions );
 
 	bounds = model->Bounds( &entityDef->parms );
 
 	// if it doesn't contact the light frustum, none of the surfaces will
 	if ( R_CullLocalBox( bounds, entityDef->modelMatrix, 6, lightDef->frustum ) ) {
-		MakeEmpty();
+		numSurfaces = 0;
 		return;
 	}
 
+	// interactions with static models may have been saved with the map
+	idInteractionCache &cache = entityDef->world->interactionCache;
+	bool cached = cache.GetKey( this, model, key );
+	if ( cached && cache.RestoreInteraction( this, model, key ) ) {
+		return;
+	}
+
+	GenerateInteractionSurfaces( model, bounds );
+
+	if ( cached ) {
+		cache.StoreInteraction( this, key );
+	}
+}
+
+/*
+====================
+idInteraction::GenerateInteractionSurfaces
+
+Creates the light and shadow surfaces for each model surface
+====================
+*/
+void idInteraction::GenerateInteractionSurfaces( const idRenderModel *model, const idBounds &bounds ) {
+	const idMaterial *	lightShader = lightDef->lightShader;
+	const idMaterial*	shader;
+	bool				interactionGenerated;
+
 	// use the turbo shadow path
 	shadowGen_t shadowGen = SG_DYNAMIC;
 
@@ -933,7 +974,7 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 
 	// if none of the surfaces generated anything, don't even bother checking?
 	if ( !interactionGenerated ) {
-		MakeEmpty();
+		numSurfaces = 0;
 	}
 }
 
@@ -1022,12 +1063,41 @@ instantiate the dynamic model to find out
 ==================
 */
 void idInteraction::AddActiveInteraction( void ) {
+	idScreenRect	shadowScissor;
+
+	if ( !CullActiveInteraction( shadowScissor ) ) {
+		return;
+	}
+
+	// We will need the dynamic surface created to make interactions, even if the
+	// model itself wasn't visible.  This just returns a cached value after it
+	// has been generated once in the view.
+	idRenderModel *model = R_EntityDefDynamicModel( entityDef );
+	if ( model == NULL || model->NumSurfaces() <= 0 ) {
+		return;
+	}
+
+	CreateActiveInteraction( model );
+
+	// relink the interaction if it turned out to be empty
+	if ( IsEmpty() ) {
+		MakeEmpty();
+	}
+
+	LinkActiveInteraction( shadowScissor );
+}
+
+/*
+==================
+idInteraction::CullActiveInteraction
+
+Returns false if the interaction does not need to be added to the current view,
+otherwise sets the shadow scissor rectangle
+==================
+*/
+bool idInteraction::CullActiveInteraction( idScreenRect &shadowScissor ) {
 	viewLight_t *	vLight;
 	viewEntity_t *	vEntity;
-	idScreenRect	shadowScissor;
-	idScreenRect	lightScissor;
-	idVec3			localLightOrigin;
-	idVec3			localViewOrigin;
 
 	vLight = lightDef->viewLight;
 	vEntity = entityDef->viewEntity;
@@ -1050,7 +1120,7 @@ void idInteraction::AddActiveInteraction( void ) {
 		// this will also cull the case where the light origin is inside the
 		// view frustum and the entity bounds are outside the view frustum
 		if ( CullInteractionByViewFrustum( tr.viewDef->viewFrustum ) ) {
-			return;
+			return false;
 		}
 
 		// calculate the shadow scissor rectangle
@@ -1059,16 +1129,31 @@ void idInteraction::AddActiveInteraction( void ) {
 
 	// get out before making the dynamic model if the shadow scissor rectangle is empty
 	if ( shadowScissor.IsEmpty() ) {
-		return;
+		return false;
 	}
 
-	// We will need the dynamic surface created to make interactions, even if the
-	// model itself wasn't visible.  This just returns a cached value after it
-	// has been generated once in the view.
-	idRenderModel *model = R_EntityDefDynamicModel( entityDef );
-	if ( model == NULL || model->NumSurfaces() <= 0 ) {
-		return;
-	}
+	return true;
+}
+
+/*
+==================
+idInteraction::IsOutOfDate
+
+Returns true if CreateActiveInteraction has to build the surfaces
+==================
+*/
+bool idInteraction::IsOutOfDate( void ) const {
+	return ( IsDeferred() || entityDef->dynamicModelFrameCount != dynamicModelFrameCount );
+}
+
+/*
+==================
+idInteraction::CreateActiveInteraction
+
+Makes sure the light and shadow surfaces are created for the current dynamic model
+==================
+*/
+void idInteraction::CreateActiveInteraction( const idRenderModel *model ) {
 
 	// the dynamic model may have changed since we built the surface list
 	if ( !IsDeferred() && entityDef->dynamicModelFrameCount != dynamicModelFrameCount ) {
@@ -1078,8 +1163,26 @@ void idInteraction::AddActiveInteraction( void ) {
 
 	// actually create the interaction if needed, building light and shadow surfaces as needed
 	if ( IsDeferred() ) {
-		CreateInteraction( model );
+		CreateInteractionSurfaces( model );
 	}
+}
+
+/*
+==================
+idInteraction::LinkActiveInteraction
+
+Adds the light and shadow surfaces of a created interaction to the view light
+==================
+*/
+void idInteraction::LinkActiveInteraction( const idScreenRect &shadowScissor ) {
+	viewLight_t *	vLight;
+	viewEntity_t *	vEntity;
+	idScreenRect	lightScissor;
+	idVec3			localLightOrigin;
+	idVec3			localViewOrigin;
+
+	vLight = lightDef->viewLight;
+	vEntity = entityDef->viewEntity;
 
 	R_GlobalPointToLocal( vEntity->modelMatrix, lightDef->globalLightOrigin, localLightOrigin );
 	R_GlobalPointToLocal( vEntity->modelMatrix, tr.viewDef->renderView.vieworg, localViewOrigin );
@@ -1116,11 +1219,9 @@ void idInteraction::AddActiveInteraction( void ) {
 
 					// make sure the original surface has its ambient cache created
 					srfTriangles_t *tri = sint->ambientTris;
-					if ( !tri->ambientCache ) {
-						if ( !R_CreateAmbientCache( tri, sint->shader->ReceivesLighting() ) ) {
-							// skip if we were out of vertex memory
-							continue;
-						}
+					if ( !R_CreateAmbientCache( tri, sint->shader->ReceivesLighting() ) ) {
+						// skip if we were out of vertex memory
+						continue;
 					}
 
 					// reference the original surface's ambient cache
@@ -1202,23 +1303,20 @@ void idInteraction::AddActiveInteraction( void ) {
 			// if we are using shared shadowVertexes and letting a vertex program fix them up,
 			// get the shadowCache from the parent ambient surface
 			if ( !shadowTris->shadowVertexes ) {
-				// the data may have been purged, so get the latest from the "home position"
+				// the data may have been purged or be from an earlier frame for
+				// skinned surfaces, so get the latest from the "home position"
+				if ( !vertexCache.CacheIsCurrent( &sint->ambientTris->shadowCache ) ) {
+					R_CreateVertexProgramShadowCache( sint->ambientTris );
+				}
 				shadowTris->shadowCache = sint->ambientTris->shadowCache;
+			} else if ( !shadowTris->shadowCache ) {
+				// each interaction has unique vertexes, re-upload them if they have been purged
+				R_CreatePrivateShadowCache( shadowTris );
 			}
 
-			// if we have been purged, re-upload the shadowVertexes
+			// if we are out of vertex cache space, skip the interaction
 			if ( !shadowTris->shadowCache ) {
-				if ( shadowTris->shadowVertexes ) {
-					// each interaction has unique vertexes
-					R_CreatePrivateShadowCache( shadowTris );
-				} else {
-					R_CreateVertexProgramShadowCache( sint->ambientTris );
-					shadowTris->shadowCache = sint->ambientTris->shadowCache;
-				}
-				// if we are out of vertex cache space, skip the interaction
-				if ( !shadowTris->shadowCache ) {
-					continue;
-				}
+				continue;
 			}
 
 			// touch the shadow surface so it won't get purged
@@ -135,6 +135,9 @@ public:
 	// returns true if the interaction is not yet completely created
 	bool					IsDeferred( void ) const { return ( numSurfaces == -1 ); }
 
+	// returns true if the surfaces have to be created for the current dynamic model
+	bool					IsOutOfDate( void ) const;
+
 	// returns true if the interaction has shadows
 	bool					HasShadows( void ) const;
 
@@ -146,6 +149,19 @@ public:
 	// calls R_LinkLightSurf() for each one
 	void					AddActiveInteraction( void );
 
+	// AddActiveInteraction() split up so the surfaces can be created in a job:
+	// returns false if the interaction can be skipped for the current view
+	bool					CullActiveInteraction( idScreenRect &shadowScissor );
+
+	// frees the surfaces if the dynamic model changed and creates them if needed,
+	// an interaction that turned out to be empty is not relinked, so this is
+	// safe to run in parallel with the other entities as long as the model
+	// surfaces are private to the entity
+	void					CreateActiveInteraction( const idRenderModel *model );
+
+	// links the light and shadow surfaces to the view light
+	void					LinkActiveInteraction( const idScreenRect &shadowScissor );
+
 private:
 	enum {
 		FRUSTUM_UNINITIALIZED,
@@ -162,6 +178,12 @@ private:
 	// actually create the interaction
 	void					CreateInteraction( const idRenderModel *model );
 
+	// creates the surfaces but leaves empty interactions linked in place
+	void					CreateInteractionSurfaces( const idRenderModel *model );
+
+	// creates the surfaces when they can't be restored from the interaction cache
+	void					GenerateInteractionSurfaces( const idRenderModel *model, const idBounds &bounds );
+
 	// unlink from entity and light lists
 	void					Unlink( void );
 
@@ -0,0 +1,748 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+===========================================================================
+
+Interaction cache files start with a header, followed by the entries and
+then the surface data of all the entries.  The surface data of an entry
+has an int with ICS_* flags for each model surface, each followed by the
+light and shadow triangles that are present.  All data is padded to a
+multiple of four bytes.
+
+===========================================================================
+*/
+
+#define INTERACTION_CACHE_ID			"BIC1"
+#define INTERACTION_CACHE_VERSION		1
+#define INTERACTION_CACHE_EXT			"bic"
+
+typedef struct {
+	char					id[4];
+	int						version;
+	unsigned int			mapCrc;
+	int						numEntries;
+	int						surfaceDataSize;
+} interactionCacheHeader_t;
+
+// surface flags
+enum {
+	ICS_AMBIENT				= BIT(0),		// the surface has a shader and ambient triangles
+	ICS_LIGHT_TRIS			= BIT(1),
+	ICS_LIGHT_DEFERRED		= BIT(2),		// the light triangles are created when the surface is in view
+	ICS_SHADOW_TRIS			= BIT(3)
+};
+
+// triangle flags
+enum {
+	ICT_AMBIENT_VERTS		= BIT(0),		// the triangles reference the verts of the ambient surface
+	ICT_AMBIENT_INDEXES		= BIT(1),		// the triangles reference the indexes of the ambient surface
+	ICT_SHADOW_VERTEXES		= BIT(2)		// followed by numVerts shadowCache_t after the indexes
+};
+
+typedef struct {
+	idBounds				bounds;
+	int						flags;
+	int						numVerts;
+	int						numIndexes;
+	int						numShadowIndexesNoFrontCaps;
+	int						numShadowIndexesNoCaps;
+	int						shadowCapPlaneBits;
+} interactionCacheTris_t;
+
+idCVar r_useInteractionCache( "r_useInteractionCache", "1", CVAR_RENDERER | CVAR_BOOL, "save the interactions of static models per map and load them from generated/ on the next run" );
+
+/*
+====================
+R_CacheDataSize
+====================
+*/
+static ID_INLINE int R_CacheDataSize( int size ) {
+	return ( size + 3 ) & ~3;
+}
+
+/*
+====================
+R_CacheKeyHash
+====================
+*/
+static ID_INLINE int R_CacheKeyHash( const interactionCacheKey_t &key ) {
+	return (int)( key.lightCrc ^ key.entityCrc );
+}
+
+/*
+====================
+R_ChecksumInt
+====================
+*/
+static void R_ChecksumInt( unsigned long &crc, int value ) {
+	CRC32_UpdateChecksum( crc, &value, sizeof( value ) );
+}
+
+/*
+====================
+R_ChecksumString
+====================
+*/
+static void R_ChecksumString( unsigned long &crc, const char *string ) {
+	CRC32_UpdateChecksum( crc, string, strlen( string ) + 1 );
+}
+
+/*
+====================
+R_AppendCacheData
+====================
+*/
+static void R_AppendCacheData( idList<byte> &data, const void *src, int size ) {
+	int offset = data.Num();
+
+	data.AssureSize( offset + R_CacheDataSize( size ) );
+	memcpy( data.Ptr() + offset, src, size );
+	memset( data.Ptr() + offset + size, 0, data.Num() - offset - size );
+}
+
+/*
+====================
+R_AppendCacheTris
+
+Returns false if the triangles have verts of their own, which only
+happens if they weren't created by R_CreateLightTris or R_CreateShadowVolume
+====================
+*/
+static bool R_AppendCacheTris( idList<byte> &data, const srfTriangles_t *tri ) {
+	interactionCacheTris_t	cached;
+
+	cached.bounds = tri->bounds;
+	cached.flags = 0;
+	cached.numVerts = tri->numVerts;
+	cached.numIndexes = tri->numIndexes;
+	cached.numShadowIndexesNoFrontCaps = tri->numShadowIndexesNoFrontCaps;
+	cached.numShadowIndexesNoCaps = tri->numShadowIndexesNoCaps;
+	cached.shadowCapPlaneBits = tri->shadowCapPlaneBits;
+
+	if ( tri->verts != NULL ) {
+		if ( tri->ambientSurface == NULL || tri->verts != tri->ambientSurface->verts ) {
+			return false;
+		}
+		cached.flags |= ICT_AMBIENT_VERTS;
+	}
+	if ( tri->ambientSurface != NULL && tri->indexes == tri->ambientSurface->indexes ) {
+		cached.flags |= ICT_AMBIENT_INDEXES;
+	}
+	if ( tri->shadowVertexes != NULL ) {
+		cached.flags |= ICT_SHADOW_VERTEXES;
+	}
+
+	R_AppendCacheData( data, &cached, sizeof( cached ) );
+	if ( !( cached.flags & ICT_AMBIENT_INDEXES ) ) {
+		R_AppendCacheData( data, tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+	}
+	if ( cached.flags & ICT_SHADOW_VERTEXES ) {
+		R_AppendCacheData( data, tri->shadowVertexes, tri->numVerts * sizeof( tri->shadowVertexes[0] ) );
+	}
+	return true;
+}
+
+/*
+====================
+R_ReadCacheTris
+
+The triangles are copied out of the cache file, because they are
+freed with the interaction like any other triangles
+====================
+*/
+static srfTriangles_t *R_ReadCacheTris( const byte *&data, const byte *end, const srfTriangles_t *ambient ) {
+	const interactionCacheTris_t *cached = (const interactionCacheTris_t *)data;
+
+	if ( data + sizeof( *cached ) > end ) {
+		return NULL;
+	}
+	if ( cached->numVerts < 0 || cached->numIndexes <= 0 ) {
+		return NULL;
+	}
+	if ( ( cached->flags & ICT_AMBIENT_VERTS ) && ( ambient == NULL || ambient->numVerts != cached->numVerts ) ) {
+		return NULL;
+	}
+	if ( ( cached->flags & ICT_AMBIENT_INDEXES ) && ( ambient == NULL || ambient->numIndexes != cached->numIndexes ) ) {
+		return NULL;
+	}
+
+	const byte *indexes = data + sizeof( *cached );
+	const byte *shadowVertexes = indexes;
+	if ( !( cached->flags & ICT_AMBIENT_INDEXES ) ) {
+		shadowVertexes += R_CacheDataSize( cached->numIndexes * sizeof( glIndex_t ) );
+	}
+	const byte *next = shadowVertexes;
+	if ( cached->flags & ICT_SHADOW_VERTEXES ) {
+		next += R_CacheDataSize( cached->numVerts * sizeof( shadowCache_t ) );
+	}
+	if ( next > end ) {
+		return NULL;
+	}
+
+	srfTriangles_t *tri = R_AllocStaticTriSurf();
+
+	tri->bounds = cached->bounds;
+	tri->numVerts = cached->numVerts;
+	tri->numIndexes = cached->numIndexes;
+	tri->numShadowIndexesNoFrontCaps = cached->numShadowIndexesNoFrontCaps;
+	tri->numShadowIndexesNoCaps = cached->numShadowIndexesNoCaps;
+	tri->shadowCapPlaneBits = cached->shadowCapPlaneBits;
+
+	if ( cached->flags & ( ICT_AMBIENT_VERTS | ICT_AMBIENT_INDEXES ) ) {
+		tri->ambientSurface = const_cast<srfTriangles_t *>( ambient );
+	}
+	if ( cached->flags & ICT_AMBIENT_VERTS ) {
+		R_ReferenceStaticTriSurfVerts( tri, ambient );
+	}
+	if ( cached->flags & ICT_AMBIENT_INDEXES ) {
+		R_ReferenceStaticTriSurfIndexes( tri, ambient );
+	} else {
+		R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+		SIMDProcessor->Memcpy( tri->indexes, indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+	}
+	if ( cached->flags & ICT_SHADOW_VERTEXES ) {
+		R_AllocStaticTriSurfShadowVerts( tri, tri->numVerts );
+		SIMDProcessor->Memcpy( tri->shadowVertexes, shadowVertexes, tri->numVerts * sizeof( tri->shadowVertexes[0] ) );
+	}
+
+	data = next;
+
+	return tri;
+}
+
+/*
+====================
+idInteractionCache::idInteractionCache
+====================
+*/
+idInteractionCache::idInteractionCache( void ) {
+	mapCrc = 0;
+	fileData = NULL;
+	entries = NULL;
+	surfaceData = NULL;
+	surfaceDataSize = 0;
+	numEntries = 0;
+	lock = 0;
+	newSurfaceData.SetGranularity( 65536 );
+}
+
+/*
+====================
+idInteractionCache::~idInteractionCache
+====================
+*/
+idInteractionCache::~idInteractionCache( void ) {
+	Clear();
+}
+
+/*
+====================
+idInteractionCache::Clear
+====================
+*/
+void idInteractionCache::Clear( void ) {
+	if ( fileData != NULL ) {
+		fileSystem->UnmapFile( fileData );
+		fileData = NULL;
+	}
+	entries = NULL;
+	surfaceData = NULL;
+	surfaceDataSize = 0;
+	numEntries = 0;
+	entryHash.Free();
+	entryUsed.Clear();
+
+	newEntries.Clear();
+	newSurfaceData.Clear();
+	newEntryHash.Free();
+
+	models.Clear();
+	modelHash.Free();
+
+	fileName.Clear();
+	mapCrc = 0;
+}
+
+/*
+====================
+idInteractionCache::Init
+====================
+*/
+void idInteractionCache::Init( const char *procFileName, unsigned int procCrc ) {
+	const void *	buffer;
+	int				length;
+
+	Shutdown();
+
+	// all cached interactions are invalid when the map changed
+	mapCrc = procCrc;
+
+	fileName = "generated/";
+	fileName += procFileName;
+	fileName.SetFileExtension( INTERACTION_CACHE_EXT );
+
+	if ( !r_useInteractionCache.GetBool() ) {
+		return;
+	}
+
+	length = fileSystem->MapFile( fileName, &buffer );
+	if ( length < 0 ) {
+		return;
+	}
+
+	const interactionCacheHeader_t *header = (const interactionCacheHeader_t *)buffer;
+
+	if ( length < (int)sizeof( *header ) || memcmp( header->id, INTERACTION_CACHE_ID, sizeof( header->id ) ) != 0
+			|| header->version != INTERACTION_CACHE_VERSION || header->mapCrc != mapCrc
+				|| header->numEntries < 0 || header->surfaceDataSize < 0
+					|| length != (int)( sizeof( *header ) + header->numEntries * sizeof( entries[0] ) ) + header->surfaceDataSize ) {
+		common->Printf( "%s is out of date\n", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return;
+	}
+
+	const interactionCacheEntry_t *fileEntries = (const interactionCacheEntry_t *)( header + 1 );
+	for ( int i = 0; i < header->numEntries; i++ ) {
+		const interactionCacheEntry_t &entry = fileEntries[i];
+		if ( entry.numSurfaces < 0 || entry.dataOffset < 0 || entry.dataSize < 0 || entry.dataOffset + entry.dataSize > header->surfaceDataSize ) {
+			common->Printf( "%s is corrupt\n", fileName.c_str() );
+			fileSystem->UnmapFile( buffer );
+			return;
+		}
+	}
+
+	fileData = (const byte *)buffer;
+	entries = fileEntries;
+	numEntries = header->numEntries;
+	surfaceData = (const byte *)( entries + numEntries );
+	surfaceDataSize = header->surfaceDataSize;
+
+	entryUsed.SetNum( numEntries );
+	memset( entryUsed.Ptr(), 0, numEntries * sizeof( entryUsed[0] ) );
+
+	entryHash.Clear( idMath::CeilPowerOfTwo( Max( numEntries, 1024 ) ), numEntries );
+	for ( int i = 0; i < numEntries; i++ ) {
+		entryHash.Add( R_CacheKeyHash( entries[i].key ), i );
+	}
+
+	common->Printf( "%i cached interactions in %s\n", numEntries, fileName.c_str() );
+}
+
+/*
+====================
+idInteractionCache::Shutdown
+====================
+*/
+void idInteractionCache::Shutdown( void ) {
+	int numUsed = 0;
+	for ( int i = 0; i < numEntries; i++ ) {
+		numUsed += entryUsed[i];
+	}
+	if ( ( newEntries.Num() > 0 || numUsed < numEntries ) && r_useInteractionCache.GetBool() && fileSystem->IsInitialized() ) {
+		Write();
+	}
+	Clear();
+}
+
+/*
+====================
+idInteractionCache::Write
+
+Writes the mapped entries that were used this session followed by the
+new entries, the surface data of the unused entries is dropped
+====================
+*/
+void idInteractionCache::Write( void ) {
+	interactionCacheHeader_t	header;
+	int							i, length;
+	int							numUsed, usedDataSize;
+	byte *						buffer;
+	byte *						ptr;
+	byte *						dataStart;
+	byte *						data;
+
+	numUsed = 0;
+	usedDataSize = 0;
+	for ( i = 0; i < numEntries; i++ ) {
+		if ( entryUsed[i] ) {
+			numUsed++;
+			usedDataSize += entries[i].dataSize;
+		}
+	}
+
+	memcpy( header.id, INTERACTION_CACHE_ID, sizeof( header.id ) );
+	header.version = INTERACTION_CACHE_VERSION;
+	header.mapCrc = mapCrc;
+	header.numEntries = numUsed + newEntries.Num();
+	header.surfaceDataSize = usedDataSize + newSurfaceData.Num();
+
+	length = sizeof( header ) + header.numEntries * sizeof( interactionCacheEntry_t ) + header.surfaceDataSize;
+
+	// the file has to be unmapped before it can be written
+	buffer = (byte *)Mem_Alloc( length );
+
+	ptr = buffer;
+	memcpy( ptr, &header, sizeof( header ) );
+	ptr += sizeof( header );
+
+	// the surface data follows the entries and is packed in the same order
+	dataStart = ptr + header.numEntries * sizeof( interactionCacheEntry_t );
+	data = dataStart;
+
+	for ( i = 0; i < numEntries; i++ ) {
+		if ( !entryUsed[i] ) {
+			continue;
+		}
+		interactionCacheEntry_t entry = entries[i];
+		memcpy( data, surfaceData + entry.dataOffset, entry.dataSize );
+		entry.dataOffset = data - dataStart;
+		data += entry.dataSize;
+		memcpy( ptr, &entry, sizeof( entry ) );
+		ptr += sizeof( entry );
+	}
+
+	for ( i = 0; i < newEntries.Num(); i++ ) {
+		interactionCacheEntry_t entry = newEntries[i];
+		entry.dataOffset += usedDataSize;
+		memcpy( ptr, &entry, sizeof( entry ) );
+		ptr += sizeof( entry );
+	}
+
+	assert( ptr == dataStart && data == dataStart + usedDataSize );
+	memcpy( data, newSurfaceData.Ptr(), newSurfaceData.Num() );
+	data += newSurfaceData.Num();
+
+	assert( data == buffer + length );
+
+	if ( fileData != NULL ) {
+		fileSystem->UnmapFile( fileData );
+		fileData = NULL;
+		entries = NULL;
+		surfaceData = NULL;
+	}
+
+	fileSystem->WriteFile( fileName, buffer, length );
+
+	common->Printf( "wrote %i new interactions to %s, dropped %i unused\n", newEntries.Num(), fileName.c_str(), numEntries - numUsed );
+
+	Mem_Free( buffer );
+}
+
+/*
+====================
+idInteractionCache::FindEntry
+====================
+*/
+int idInteractionCache::FindEntry( const interactionCacheKey_t &key ) const {
+	for ( int i = entryHash.First( R_CacheKeyHash( key ) ); i != -1; i = entryHash.Next( i ) ) {
+		if ( entries[i].key.lightCrc == key.lightCrc && entries[i].key.entityCrc == key.entityCrc ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+====================
+idInteractionCache::FindNewEntry
+====================
+*/
+int idInteractionCache::FindNewEntry( const interactionCacheKey_t &key ) const {
+	for ( int i = newEntryHash.First( R_CacheKeyHash( key ) ); i != -1; i = newEntryHash.Next( i ) ) {
+		if ( newEntries[i].key.lightCrc == key.lightCrc && newEntries[i].key.entityCrc == key.entityCrc ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+====================
+idInteractionCache::ModelCrc
+
+The CRC of the model geometry is calculated once per model and timestamp
+====================
+*/
+unsigned int idInteractionCache::ModelCrc( const idRenderModel *model ) {
+	interactionCacheModel_t	cached;
+	unsigned long			crc;
+	int						i, j, hash;
+
+	cached.model = model;
+	cached.timestamp = model->Timestamp();
+	hash = (int)( (intptr_t)model >> 4 );
+
+	while ( Sys_InterlockedCompareExchange( lock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+	for ( i = modelHash.First( hash ); i != -1; i = modelHash.Next( i ) ) {
+		if ( models[i].model == model && models[i].timestamp == cached.timestamp ) {
+			cached.crc = models[i].crc;
+			Sys_InterlockedExchange( lock, 0 );
+			return cached.crc;
+		}
+	}
+	Sys_InterlockedExchange( lock, 0 );
+
+	CRC32_InitChecksum( crc );
+	R_ChecksumString( crc, model->Name() );
+	for ( i = 0; i < model->NumSurfaces(); i++ ) {
+		const modelSurface_t *surf = model->Surface( i );
+		const srfTriangles_t *tri = surf->geometry;
+
+		R_ChecksumString( crc, surf->shader != NULL ? surf->shader->GetName() : "" );
+		if ( tri == NULL ) {
+			R_ChecksumInt( crc, -1 );
+			continue;
+		}
+		R_ChecksumInt( crc, tri->numVerts );
+		R_ChecksumInt( crc, tri->numIndexes );
+		R_ChecksumInt( crc, tri->numSilEdges );
+		for ( j = 0; j < tri->numVerts; j++ ) {
+			CRC32_UpdateChecksum( crc, tri->verts[j].xyz.ToFloatPtr(), 3 * sizeof( float ) );
+		}
+		CRC32_UpdateChecksum( crc, tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+	}
+	CRC32_FinishChecksum( crc );
+
+	cached.crc = (unsigned int)crc;
+
+	while ( Sys_InterlockedCompareExchange( lock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+	modelHash.Add( hash, models.Append( cached ) );
+	Sys_InterlockedExchange( lock, 0 );
+
+	return cached.crc;
+}
+
+/*
+====================
+idInteractionCache::GetKey
+
+Only entities with static models that don't have a callback are cached,
+and only if neither the light nor the entity moved after the map was loaded.
+The keys include everything CreateInteractionSurfaces reads from the light,
+the entity and the cvars.
+====================
+*/
+bool idInteractionCache::GetKey( const idInteraction *inter, const idRenderModel *model, interactionCacheKey_t &key ) {
+	const idRenderEntityLocal *	def = inter->entityDef;
+	const idRenderLightLocal *	light = inter->lightDef;
+	unsigned long				crc;
+	int							i;
+
+	if ( !r_useInteractionCache.GetBool() || fileName.IsEmpty() ) {
+		return false;
+	}
+	if ( def->parms.callback != NULL || def->parms.hModel != model ) {
+		return false;
+	}
+	if ( def->movedAfterLoad || light->movedAfterLoad ) {
+		return false;
+	}
+	if ( model->IsDynamicModel() != DM_STATIC || model->IsDefaultModel() ) {
+		return false;
+	}
+
+	CRC32_InitChecksum( crc );
+	R_ChecksumString( crc, light->lightShader->GetName() );
+	CRC32_UpdateChecksum( crc, light->frustum, sizeof( light->frustum ) );
+	CRC32_UpdateChecksum( crc, light->lightProject, sizeof( light->lightProject ) );
+	CRC32_UpdateChecksum( crc, light->globalLightOrigin.ToFloatPtr(), 3 * sizeof( float ) );
+	R_ChecksumInt( crc, light->numShadowFrustums );
+	for ( i = 0; i < light->numShadowFrustums; i++ ) {
+		const shadowFrustum_t &frustum = light->shadowFrustums[i];
+		R_ChecksumInt( crc, frustum.numPlanes );
+		R_ChecksumInt( crc, frustum.makeClippedPlanes );
+		CRC32_UpdateChecksum( crc, frustum.planes, frustum.numPlanes * sizeof( frustum.planes[0] ) );
+	}
+	R_ChecksumInt( crc, ( light->parms.noShadows << 0 ) | ( light->parms.parallel << 1 ) | ( light->parms.pointLight << 2 )
+							| ( ( light->parms.prelightModel != NULL ) << 3 ) );
+	CRC32_FinishChecksum( crc );
+	key.lightCrc = (unsigned int)crc;
+
+	CRC32_InitChecksum( crc );
+	R_ChecksumInt( crc, ModelCrc( model ) );
+	CRC32_UpdateChecksum( crc, def->modelMatrix, sizeof( def->modelMatrix ) );
+	R_ChecksumString( crc, def->parms.customSkin != NULL ? def->parms.customSkin->GetName() : "" );
+	R_ChecksumString( crc, def->parms.customShader != NULL ? def->parms.customShader->GetName() : "" );
+	R_ChecksumInt( crc, ( def->parms.noShadow << 0 ) | ( def->parms.noSelfShadow << 1 ) | ( ( def->parms.suppressSurfaceInViewID != 0 ) << 2 ) );
+	R_ChecksumInt( crc, ( r_shadows.GetBool() << 0 ) | ( r_lightAllBackFaces.GetBool() << 1 ) | ( r_usePreciseTriangleInteractions.GetBool() << 2 )
+							| ( r_useOptimizedShadows.GetBool() << 3 ) | ( r_skipSuppress.GetBool() << 4 ) | ( r_useTurboShadow.GetBool() << 5 )
+								| ( r_useShadowVertexProgram.GetBool() << 6 ) | ( r_useShadowProjectedCull.GetBool() << 7 )
+									| ( tr.backEndRendererHasVertexPrograms << 8 ) );
+	CRC32_FinishChecksum( crc );
+	key.entityCrc = (unsigned int)crc;
+
+	return true;
+}
+
+/*
+====================
+idInteractionCache::RestoreInteraction
+====================
+*/
+bool idInteractionCache::RestoreInteraction( idInteraction *inter, const idRenderModel *model, const interactionCacheKey_t &key ) {
+	int i = FindEntry( key );
+	if ( i == -1 ) {
+		return false;
+	}
+
+	const interactionCacheEntry_t &entry = entries[i];
+
+	if ( entry.numSurfaces == 0 ) {
+		inter->numSurfaces = 0;
+		entryUsed[i] = 1;
+		return true;
+	}
+	if ( entry.numSurfaces != model->NumSurfaces() ) {
+		return false;
+	}
+
+	const idRenderEntityLocal *def = inter->entityDef;
+	const byte *data = surfaceData + entry.dataOffset;
+	const byte *end = data + entry.dataSize;
+	int c;
+
+	inter->numSurfaces = entry.numSurfaces;
+	inter->surfaces = (surfaceInteraction_t *)R_ClearedStaticAlloc( sizeof( inter->surfaces[0] ) * inter->numSurfaces );
+
+	for ( c = 0; c < inter->numSurfaces; c++ ) {
+		const modelSurface_t *surf = model->Surface( c );
+		surfaceInteraction_t *sint = &inter->surfaces[c];
+
+		if ( data + sizeof( int ) > end ) {
+			break;
+		}
+		int flags = *(const int *)data;
+		data += sizeof( int );
+
+		if ( flags & ICS_AMBIENT ) {
+			if ( surf->geometry == NULL ) {
+				break;
+			}
+			sint->shader = R_RemapShaderBySkin( surf->shader, def->parms.customSkin, def->parms.customShader );
+			sint->ambientTris = surf->geometry;
+		}
+
+		if ( flags & ICS_LIGHT_DEFERRED ) {
+			// the cull info will be calculated when the light triangles are created
+			sint->lightTris = LIGHT_TRIS_DEFERRED;
+		} else if ( flags & ICS_LIGHT_TRIS ) {
+			sint->lightTris = R_ReadCacheTris( data, end, surf->geometry );
+			if ( sint->lightTris == NULL ) {
+				break;
+			}
+		}
+
+		if ( flags & ICS_SHADOW_TRIS ) {
+			sint->shadowTris = R_ReadCacheTris( data, end, surf->geometry );
+			if ( sint->shadowTris == NULL ) {
+				break;
+			}
+		}
+	}
+
+	if ( c < inter->numSurfaces ) {
+		inter->FreeSurfaces();
+		return false;
+	}
+
+	// several threads may set the same byte, they all write the same value
+	entryUsed[i] = 1;
+
+	return true;
+}
+
+/*
+====================
+idInteractionCache::StoreInteraction
+====================
+*/
+void idInteractionCache::StoreInteraction( const idInteraction *inter, const interactionCacheKey_t &key ) {
+	interactionCacheEntry_t	entry;
+	idList<byte>			data;
+
+	data.SetGranularity( 1024 );
+
+	for ( int c = 0; c < inter->numSurfaces; c++ ) {
+		const surfaceInteraction_t *sint = &inter->surfaces[c];
+		int flags = 0;
+
+		if ( sint->ambientTris != NULL ) {
+			flags |= ICS_AMBIENT;
+		}
+		if ( sint->lightTris == LIGHT_TRIS_DEFERRED ) {
+			flags |= ICS_LIGHT_DEFERRED;
+		} else if ( sint->lightTris != NULL ) {
+			flags |= ICS_LIGHT_TRIS;
+		}
+		if ( sint->shadowTris != NULL ) {
+			flags |= ICS_SHADOW_TRIS;
+		}
+
+		R_AppendCacheData( data, &flags, sizeof( flags ) );
+
+		if ( flags & ICS_LIGHT_TRIS ) {
+			if ( !R_AppendCacheTris( data, sint->lightTris ) ) {
+				return;
+			}
+		}
+		if ( flags & ICS_SHADOW_TRIS ) {
+			if ( !R_AppendCacheTris( data, sint->shadowTris ) ) {
+				return;
+			}
+		}
+	}
+
+	entry.key = key;
+	entry.numSurfaces = inter->numSurfaces;
+	entry.dataSize = data.Num();
+
+	while ( Sys_InterlockedCompareExchange( lock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+
+	// the same interaction is created again when a light is turned back on
+	if ( FindEntry( key ) == -1 && FindNewEntry( key ) == -1 ) {
+		entry.dataOffset = newSurfaceData.Num();
+		newSurfaceData.AssureSize( entry.dataOffset + entry.dataSize );
+		memcpy( newSurfaceData.Ptr() + entry.dataOffset, data.Ptr(), entry.dataSize );
+		newEntryHash.Add( R_CacheKeyHash( key ), newEntries.Append( entry ) );
+	}
+
+	Sys_InterlockedExchange( lock, 0 );
+}
@@ -0,0 +1,123 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#ifndef __INTERACTIONCACHE_H__
+#define __INTERACTIONCACHE_H__
+
+/*
+===============================================================================
+
+	Binary cache of the interaction surfaces of static models.
+
+	The light and shadow surfaces of an interaction between a light and an
+	entity with a static model only depend on the light, the placement of the
+	entity and the model geometry, so they are saved per map and the file is
+	mapped into memory when the map is loaded.  Each interaction is keyed by
+	a CRC of the light and a CRC of the entity, which includes a CRC of the
+	model geometry and the cvars used to create the surfaces.  The whole file
+	is ignored if the CRC of the .proc file changed.
+
+	Only lights and entities that haven't moved since the map was loaded
+	are cached, so movers don't add an entry for every position.
+	Interactions that weren't in the cache are collected while the map is
+	played and the file is rewritten when the world is freed, without the
+	entries that weren't used.
+
+===============================================================================
+*/
+
+typedef struct {
+	unsigned int			lightCrc;
+	unsigned int			entityCrc;
+} interactionCacheKey_t;
+
+typedef struct {
+	interactionCacheKey_t	key;
+	int						numSurfaces;			// 0 for an empty interaction
+	int						dataOffset;				// relative to the start of the surface data
+	int						dataSize;
+} interactionCacheEntry_t;
+
+typedef struct {
+	const idRenderModel *	model;
+	ID_TIME_T				timestamp;
+	unsigned int			crc;
+} interactionCacheModel_t;
+
+class idInteractionCache {
+public:
+							idInteractionCache( void );
+							~idInteractionCache( void );
+
+	// maps the cache file of the map
+	void					Init( const char *procFileName, unsigned int procCrc );
+
+	// writes the new interactions and releases the file
+	void					Shutdown( void );
+
+	// returns false if the interaction can't be cached
+	bool					GetKey( const idInteraction *inter, const idRenderModel *model, interactionCacheKey_t &key );
+
+	// creates the surfaces of the interaction from the cache, returns false if it isn't cached,
+	// safe to call from several threads at once
+	bool					RestoreInteraction( idInteraction *inter, const idRenderModel *model, const interactionCacheKey_t &key );
+
+	// saves the surfaces of a newly created interaction, safe to call from several threads at once
+	void					StoreInteraction( const idInteraction *inter, const interactionCacheKey_t &key );
+
+private:
+	idStr					fileName;
+	unsigned int			mapCrc;
+
+	const byte *			fileData;				// mapped cache file
+	const interactionCacheEntry_t *entries;
+	const byte *			surfaceData;
+	int						surfaceDataSize;
+	int						numEntries;
+	idHashIndex				entryHash;
+	idList<byte>			entryUsed;				// set when an entry is restored, unused entries aren't written back
+
+	idList<interactionCacheEntry_t>	newEntries;
+	idList<byte>			newSurfaceData;
+	idHashIndex				newEntryHash;
+
+	idList<interactionCacheModel_t>	models;		// geometry CRCs of the models used so far
+	idHashIndex				modelHash;
+
+	volatile int			lock;
+
+private:
+	void					Write( void );
+	void					Clear( void );
+	int						FindEntry( const interactionCacheKey_t &key ) const;
+	int						FindNewEntry( const interactionCacheKey_t &key ) const;
+	unsigned int			ModelCrc( const idRenderModel *model );
+};
+
+#endif /* !__INTERACTIONCACHE_H__ */
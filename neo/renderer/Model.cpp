@@ -51,6 +51,10 @@ idRenderModelStatic::idRenderModelStatic() {
 	lastModifiedFrame = 0;
 	lastArchivedFrame = 0;
 	overlaysAdded = 0;
+	skinnedJoints = NULL;
+	skinnedJointsSerial = 0;
+	skinnedScale = 0.0f;
+	skinnedLowDetail = false;
 	shadowHull = NULL;
 	isStaticWorldModel = false;
 	defaulted = false;
@@ -345,6 +349,8 @@ void idRenderModelStatic::InitEmpty( const char *fileName ) {
 	PurgeModel();
 	purged = false;
 	bounds.Zero();
+	skinnedJoints = NULL;
+	skinnedJointsSerial = 0;
 }
 
 /*
@@ -94,6 +94,8 @@ typedef struct srfTriangles_s {
 	bool						perfectHull;			// true if there aren't any dangling edges
 	bool						deformedSurface;		// if true, indexes, silIndexes, mirrorVerts, and silEdges are
 														// pointers into the original surface, and should not be freed
+	bool						dynamicVerts;			// the verts are skinned again whenever the joints change, so the
+														// ambient and shadow caches are allocated with AllocDynamic
 
 	int							numVerts;				// number of vertices
 	idDrawVert *				verts;					// vertices, allocated with special allocator
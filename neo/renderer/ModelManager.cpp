@@ -70,6 +70,7 @@ private:
 	static void				ListModels_f( const idCmdArgs &args );
 	static void				ReloadModels_f( const idCmdArgs &args );
 	static void				TouchModel_f( const idCmdArgs &args );
+	static void				BuildMD5MeshCache_f( const idCmdArgs &args );
 };
 
 
@@ -177,6 +178,33 @@ void idRenderModelManagerLocal::TouchModel_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==============
+idRenderModelManagerLocal::BuildMD5MeshCache_f
+
+Writes the binary files of all md5 meshes, including the ones in pak files.
+The meshes are loaded into models that are not added to the manager.
+==============
+*/
+void idRenderModelManagerLocal::BuildMD5MeshCache_f( const idCmdArgs &args ) {
+	idFileList *	files;
+	int				i;
+
+	if ( !r_useBinaryMD5Meshes.GetBool() ) {
+		common->Printf( "binary md5 meshes are disabled with r_useBinaryMD5Meshes 0\n" );
+		return;
+	}
+
+	files = fileSystem->ListFilesTree( "models", "." MD5_MESH_EXT, true );
+	for ( i = 0; i < files->GetNumFiles(); i++ ) {
+		idRenderModelMD5 *model = new idRenderModelMD5;
+		model->InitFromFile( files->GetFile( i ) );
+		delete model;
+	}
+	common->Printf( "%i md5 meshes in generated/\n", files->GetNumFiles() );
+	fileSystem->FreeFileList( files );
+}
+
 /*
 =================
 idRenderModelManagerLocal::WritePrecacheCommands
@@ -210,6 +238,7 @@ void idRenderModelManagerLocal::Init() {
 	cmdSystem->AddCommand( "printModel", PrintModel_f, CMD_FL_RENDERER, "prints model info", idCmdSystem::ArgCompletion_ModelName );
 	cmdSystem->AddCommand( "reloadModels", ReloadModels_f, CMD_FL_RENDERER|CMD_FL_CHEAT, "reloads models" );
 	cmdSystem->AddCommand( "touchModel", TouchModel_f, CMD_FL_RENDERER, "touches a model", idCmdSystem::ArgCompletion_ModelName );
+	cmdSystem->AddCommand( "buildMD5MeshCache", BuildMD5MeshCache_f, CMD_FL_RENDERER, "writes the binary files of all md5 meshes to generated/" );
 
 	insideLevelLoad = false;
 
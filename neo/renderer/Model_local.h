@@ -107,6 +107,13 @@ public:
 	idBounds					bounds;
 	int							overlaysAdded;
 
+	// snapshots of skinned models remember the joints they were deformed
+	// with, so they aren't skinned again until the joints change
+	const idJointMat *			skinnedJoints;
+	int							skinnedJointsSerial;
+	float						skinnedScale;
+	bool						skinnedLowDetail;
+
 protected:
 	int							lastModifiedFrame;
 	int							lastArchivedFrame;
@@ -142,8 +149,9 @@ public:
 								idMD5Mesh();
 								~idMD5Mesh();
 
- 	void						ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints );
-	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, modelSurface_t *surf );
+ 	bool						ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints, const int *lodJoints, idList<byte> *binary );
+	bool						ReadBinaryMesh( const byte *&data, const byte *end, int numJoints, const idJointMat *joints, const int *lodJoints );
+	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, modelSurface_t *surf, bool lowDetail );
 	idBounds					CalcBounds( const idJointMat *joints );
 	int							NearestJoint( int a, int b, int c ) const;
 	int							NumVerts( void ) const;
@@ -155,11 +163,14 @@ private:
 	int							numWeights;			// number of weights
 	idVec4 *					scaledWeights;		// joint weights
 	int *						weightIndex;		// pairs of: joint offset + bool true if next weight is for next vertex
+	idVec4 *					lodScaledWeights;	// a single weight for each vertex for the low detail skinning
+	int *						lodWeightIndex;		// same layout as weightIndex
 	const idMaterial *			shader;				// material applied to mesh
 	int							numTris;			// number of triangles
 	struct deformInfo_s *		deformInfo;			// used to create srfTriangles_t from base frames and new vertexes
 	int							surfaceNum;			// number of the static surface created for this mesh
 
+	void						BuildMesh( const int *firstWeightForVertex, const int *numWeightsForVertex, const int *tris, const struct vertexWeight_s *weights, const idJointMat *joints, const int *lodJoints );
 	void						TransformVerts( idDrawVert *verts, const idJointMat *joints );
 	void						TransformScaledVerts( idDrawVert *verts, const idJointMat *joints, float scale );
 };
@@ -192,6 +203,10 @@ private:
 	void						GetFrameBounds( const renderEntity_t *ent, idBounds &bounds ) const;
 	void						DrawJoints( const renderEntity_t *ent, const struct viewDef_s *view ) const;
 	void						ParseJoint( idLexer &parser, idMD5Joint *joint, idJointQuat *defaultPose );
+	void						SetupJoints( idJointMat *poseMat3, int *lodJoints );
+	idStr						BinaryFileName( void ) const;
+	bool						LoadBinaryModel( void );
+	void						WriteBinaryModel( const idList<byte> &data ) const;
 };
 
 /*
@@ -52,6 +52,151 @@ typedef struct vertexWeight_s {
 	float						jointWeight;
 } vertexWeight_t;
 
+/*
+===========================================================================
+
+Binary md5mesh files are written to generated/ the first time a mesh is
+parsed.  They start with a header, followed by the joints with their names
+and default pose, and then for each mesh the shader name, the texture
+coordinates and weight ranges of the vertexes, the triangles and the
+weights.  Everything is stored as little endian 32 bit ints and floats, and
+strings are stored with their length and padded to a multiple of four bytes.
+The length and timestamp of the text file are stored to detect a text file
+that changed, and everything read from the file is range checked like the
+binary md5anim files.
+
+===========================================================================
+*/
+
+#define MD5_MESH_BINARY_ID			"BMM1"
+#define MD5_MESH_BINARY_VERSION		2
+#define MD5_MESH_BINARY_EXT			"bmd5mesh"
+
+/*
+====================
+R_AppendMD5Data
+====================
+*/
+static void R_AppendMD5Data( idList<byte> &data, const void *src, int size ) {
+	int offset = data.Num();
+
+	data.AssureSize( offset + ( ( size + 3 ) & ~3 ) );
+	memcpy( data.Ptr() + offset, src, size );
+	memset( data.Ptr() + offset + size, 0, data.Num() - offset - size );
+}
+
+/*
+====================
+R_AppendMD5Int
+====================
+*/
+static void R_AppendMD5Int( idList<byte> &data, int value ) {
+	value = LittleLong( value );
+	R_AppendMD5Data( data, &value, sizeof( value ) );
+}
+
+/*
+====================
+R_AppendMD5Words
+
+Appends count items made up of 32 bit ints and floats
+====================
+*/
+static void R_AppendMD5Words( idList<byte> &data, const void *src, int count, int itemSize ) {
+	int offset = data.Num();
+
+	data.AssureSize( offset + count * itemSize );
+	memcpy( data.Ptr() + offset, src, count * itemSize );
+	LittleRevBytes( data.Ptr() + offset, 4, count * itemSize / 4 );
+}
+
+/*
+====================
+R_AppendMD5String
+====================
+*/
+static void R_AppendMD5String( idList<byte> &data, const char *string ) {
+	int length = strlen( string ) + 1;
+
+	R_AppendMD5Int( data, length );
+	R_AppendMD5Data( data, string, length );
+}
+
+/*
+====================
+R_ReadMD5Data
+
+Returns NULL if the file doesn't have count items left
+====================
+*/
+static const void *R_ReadMD5Data( const byte *&data, const byte *end, int count, int itemSize ) {
+	const void *ptr = data;
+
+	if ( count < 0 || count > ( end - data ) / itemSize ) {
+		return NULL;
+	}
+	data += ( count * itemSize + 3 ) & ~3;
+	if ( data > end ) {
+		return NULL;
+	}
+	return ptr;
+}
+
+/*
+====================
+R_ReadMD5Int
+====================
+*/
+static bool R_ReadMD5Int( const byte *&data, const byte *end, int &value ) {
+	const int *ptr = (const int *)R_ReadMD5Data( data, end, 1, sizeof( int ) );
+
+	if ( ptr == NULL ) {
+		return false;
+	}
+	value = LittleLong( *ptr );
+	return true;
+}
+
+/*
+====================
+R_ReadMD5Words
+
+Returns count items made up of 32 bit ints and floats. The items are used
+directly from the file on little endian systems and swapped into swapped
+on big endian systems. Returns NULL if the file doesn't have count items left.
+====================
+*/
+static const void *R_ReadMD5Words( const byte *&data, const byte *end, int count, int itemSize, idList<int> &swapped ) {
+	const void *ptr = R_ReadMD5Data( data, end, count, itemSize );
+
+	if ( ptr == NULL || !Swap_IsBigEndian() ) {
+		return ptr;
+	}
+	swapped.SetNum( count * itemSize / 4, false );
+	memcpy( swapped.Ptr(), ptr, count * itemSize );
+	LittleRevBytes( swapped.Ptr(), 4, swapped.Num() );
+	return swapped.Ptr();
+}
+
+/*
+====================
+R_ReadMD5String
+====================
+*/
+static const char *R_ReadMD5String( const byte *&data, const byte *end ) {
+	const char *string;
+	int length;
+
+	if ( !R_ReadMD5Int( data, end, length ) || length < 1 ) {
+		return NULL;
+	}
+	string = (const char *)R_ReadMD5Data( data, end, length, 1 );
+	if ( string == NULL || string[length - 1] != '\0' ) {
+		return NULL;
+	}
+	return string;
+}
+
 /*
 ====================
 idMD5Mesh::idMD5Mesh
@@ -60,6 +205,8 @@ idMD5Mesh::idMD5Mesh
 idMD5Mesh::idMD5Mesh() {
 	scaledWeights	= NULL;
 	weightIndex		= NULL;
+	lodScaledWeights = NULL;
+	lodWeightIndex	= NULL;
 	shader			= NULL;
 	numTris			= 0;
 	deformInfo		= NULL;
@@ -74,6 +221,8 @@ idMD5Mesh::~idMD5Mesh
 idMD5Mesh::~idMD5Mesh() {
 	Mem_Free16( scaledWeights );
 	Mem_Free16( weightIndex );
+	Mem_Free16( lodScaledWeights );
+	Mem_Free16( lodWeightIndex );
 	if ( deformInfo ) {
 		R_FreeDeformInfo( deformInfo );
 		deformInfo = NULL;
@@ -83,16 +232,17 @@ idMD5Mesh::~idMD5Mesh() {
 /*
 ====================
 idMD5Mesh::ParseMesh
+
+Returns false if the mesh can't be written to the binary file
 ====================
 */
-void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints ) {
+bool idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints, const int *lodJoints, idList<byte> *binary ) {
 	idToken		token;
 	idToken		name;
-	int			num;
 	int			count;
 	int			jointnum;
 	idStr		shaderName;
-	int			i, j;
+	int			i;
 	idList<int>	tris;
 	idList<int>	firstWeightForVertex;
 	idList<int>	numWeightsForVertex;
@@ -131,7 +281,6 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 	firstWeightForVertex.SetNum( count );
 	numWeightsForVertex.SetNum( count );
 
-	numWeights = 0;
 	maxweight = 0;
 	for( i = 0; i < texCoords.Num(); i++ ) {
 		parser.ExpectTokenString( "vert" );
@@ -146,7 +295,6 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 			parser.Error( "Vertex without any joint weights." );
 		}
 
-		numWeights += numWeightsForVertex[ i ];
 		if ( numWeightsForVertex[ i ] + firstWeightForVertex[ i ] > maxweight ) {
 			maxweight = numWeightsForVertex[ i ] + firstWeightForVertex[ i ];
 		}
@@ -183,6 +331,7 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 
 	if ( maxweight > count ) {
 		parser.Warning( "Vertices reference out of range weights in model (%d of %d weights).", maxweight, count );
+		binary = NULL;
 	}
 
 	tempWeights.SetNum( count );
@@ -196,34 +345,137 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 			parser.Error( "Joint Index out of range(%d): %d", numJoints, jointnum );
 		}
 
+		tempWeights[ i ].vert			= 0;
 		tempWeights[ i ].joint			= jointnum;
 		tempWeights[ i ].jointWeight	= parser.ParseFloat();
 
 		parser.Parse1DMatrix( 3, tempWeights[ i ].offset.ToFloatPtr() );
 	}
 
+	parser.ExpectTokenString( "}" );
+
+	if ( binary != NULL ) {
+		R_AppendMD5String( *binary, shaderName );
+		R_AppendMD5Int( *binary, texCoords.Num() );
+		R_AppendMD5Words( *binary, texCoords.Ptr(), texCoords.Num(), sizeof( texCoords[0] ) );
+		R_AppendMD5Words( *binary, firstWeightForVertex.Ptr(), firstWeightForVertex.Num(), sizeof( firstWeightForVertex[0] ) );
+		R_AppendMD5Words( *binary, numWeightsForVertex.Ptr(), numWeightsForVertex.Num(), sizeof( numWeightsForVertex[0] ) );
+		R_AppendMD5Int( *binary, numTris );
+		R_AppendMD5Words( *binary, tris.Ptr(), numTris, 3 * sizeof( tris[0] ) );
+		R_AppendMD5Int( *binary, tempWeights.Num() );
+		R_AppendMD5Words( *binary, tempWeights.Ptr(), tempWeights.Num(), sizeof( tempWeights[0] ) );
+	}
+
+	BuildMesh( firstWeightForVertex.Ptr(), numWeightsForVertex.Ptr(), tris.Ptr(), tempWeights.Ptr(), joints, lodJoints );
+
+	return ( binary != NULL );
+}
+
+/*
+====================
+idMD5Mesh::ReadBinaryMesh
+
+The mesh data is used directly from the mapped file on little endian systems.
+Returns false if the file is bad.
+====================
+*/
+bool idMD5Mesh::ReadBinaryMesh( const byte *&data, const byte *end, int numJoints, const idJointMat *joints, const int *lodJoints ) {
+	const char *			shaderName;
+	const idVec2 *			fileTexCoords;
+	const int *				firstWeightForVertex;
+	const int *				numWeightsForVertex;
+	const int *				tris;
+	const vertexWeight_t *	weights;
+	int						i, numVerts, count;
+	idList<int>				swapped[5];
+
+	shaderName = R_ReadMD5String( data, end );
+	if ( shaderName == NULL || !R_ReadMD5Int( data, end, numVerts ) ) {
+		return false;
+	}
+	fileTexCoords = (const idVec2 *)R_ReadMD5Words( data, end, numVerts, sizeof( fileTexCoords[0] ), swapped[0] );
+	firstWeightForVertex = (const int *)R_ReadMD5Words( data, end, numVerts, sizeof( firstWeightForVertex[0] ), swapped[1] );
+	numWeightsForVertex = (const int *)R_ReadMD5Words( data, end, numVerts, sizeof( numWeightsForVertex[0] ), swapped[2] );
+	if ( fileTexCoords == NULL || firstWeightForVertex == NULL || numWeightsForVertex == NULL || !R_ReadMD5Int( data, end, numTris ) ) {
+		return false;
+	}
+	tris = (const int *)R_ReadMD5Words( data, end, numTris, 3 * sizeof( tris[0] ), swapped[3] );
+	if ( tris == NULL || !R_ReadMD5Int( data, end, count ) ) {
+		return false;
+	}
+	weights = (const vertexWeight_t *)R_ReadMD5Words( data, end, count, sizeof( weights[0] ), swapped[4] );
+	if ( weights == NULL ) {
+		return false;
+	}
+
+	for ( i = 0; i < numVerts; i++ ) {
+		if ( numWeightsForVertex[i] <= 0 || firstWeightForVertex[i] < 0 || firstWeightForVertex[i] + numWeightsForVertex[i] > count ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < numTris * 3; i++ ) {
+		if ( tris[i] < 0 || tris[i] >= numVerts ) {
+			return false;
+		}
+	}
+	for ( i = 0; i < count; i++ ) {
+		if ( weights[i].joint < 0 || weights[i].joint >= numJoints ) {
+			return false;
+		}
+	}
+
+	shader = declManager->FindMaterial( shaderName );
+
+	texCoords.SetNum( numVerts );
+	SIMDProcessor->Memcpy( texCoords.Ptr(), fileTexCoords, numVerts * sizeof( texCoords[0] ) );
+
+	BuildMesh( firstWeightForVertex, numWeightsForVertex, tris, weights, joints, lodJoints );
+
+	return true;
+}
+
+/*
+====================
+idMD5Mesh::BuildMesh
+
+Creates the pre-scaled weights and the deform info from the data in the text or binary file
+====================
+*/
+void idMD5Mesh::BuildMesh( const int *firstWeightForVertex, const int *numWeightsForVertex, const int *tris, const vertexWeight_t *weights, const idJointMat *joints, const int *lodJoints ) {
+	int			num;
+	int			count;
+	int			i, j;
+	idList<int>	lodJointForVertex;
+	float		bestWeight;
+
+	numWeights = 0;
+	for( i = 0; i < texCoords.Num(); i++ ) {
+		numWeights += numWeightsForVertex[ i ];
+	}
+
 	// create pre-scaled weights and an index for the vertex/joint lookup
 	scaledWeights = (idVec4 *) Mem_Alloc16( numWeights * sizeof( scaledWeights[0] ) );
 	weightIndex = (int *) Mem_Alloc16( numWeights * 2 * sizeof( weightIndex[0] ) );
 	memset( weightIndex, 0, numWeights * 2 * sizeof( weightIndex[0] ) );
 
+	lodJointForVertex.SetNum( texCoords.Num() );
+
 	count = 0;
 	for( i = 0; i < texCoords.Num(); i++ ) {
 		num = firstWeightForVertex[i];
+		bestWeight = -1.0f;
 		for( j = 0; j < numWeightsForVertex[i]; j++, num++, count++ ) {
-			scaledWeights[count].ToVec3() = tempWeights[num].offset * tempWeights[num].jointWeight;
-			scaledWeights[count].w = tempWeights[num].jointWeight;
-			weightIndex[count * 2 + 0] = tempWeights[num].joint * sizeof( idJointMat );
+			scaledWeights[count].ToVec3() = weights[num].offset * weights[num].jointWeight;
+			scaledWeights[count].w = weights[num].jointWeight;
+			weightIndex[count * 2 + 0] = weights[num].joint * sizeof( idJointMat );
+			if ( weights[num].jointWeight > bestWeight ) {
+				bestWeight = weights[num].jointWeight;
+				lodJointForVertex[i] = lodJoints[weights[num].joint];
+			}
 		}
 		weightIndex[count * 2 - 1] = 1;
 	}
 
-	tempWeights.Clear();
-	numWeightsForVertex.Clear();
-	firstWeightForVertex.Clear();
-
-	parser.ExpectTokenString( "}" );
-
 	// update counters
 	c_numVerts += texCoords.Num();
 	c_numWeights += numWeights;
@@ -242,7 +494,22 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 		verts[i].st = texCoords[i];
 	}
 	TransformVerts( verts, joints );
-	deformInfo = R_BuildDeformInfo( texCoords.Num(), verts, tris.Num(), tris.Ptr(), shader->UseUnsmoothedTangents() );
+	deformInfo = R_BuildDeformInfo( texCoords.Num(), verts, numTris * 3, tris, shader->UseUnsmoothedTangents() );
+
+	//
+	// build the low detail weights, each vertex is moved rigidly by the joint with the
+	// largest weight, or by its parent if that is a leaf joint, and stays in place in the bind pose
+	//
+	lodScaledWeights = (idVec4 *) Mem_Alloc16( texCoords.Num() * sizeof( lodScaledWeights[0] ) );
+	lodWeightIndex = (int *) Mem_Alloc16( texCoords.Num() * 2 * sizeof( lodWeightIndex[0] ) );
+
+	for ( i = 0; i < texCoords.Num(); i++ ) {
+		const idJointMat &joint = joints[lodJointForVertex[i]];
+		lodScaledWeights[i].ToVec3() = joint.ToMat3() * ( verts[i].xyz - joint.ToVec3() );
+		lodScaledWeights[i].w = 1.0f;
+		lodWeightIndex[i * 2 + 0] = lodJointForVertex[i] * sizeof( idJointMat );
+		lodWeightIndex[i * 2 + 1] = 1;
+	}
 }
 
 /*
@@ -272,13 +539,13 @@ void idMD5Mesh::TransformScaledVerts( idDrawVert *verts, const idJointMat *entJo
 idMD5Mesh::UpdateSurface
 ====================
 */
-void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, modelSurface_t *surf ) {
+void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, modelSurface_t *surf, bool lowDetail ) {
 	int i, base;
 	srfTriangles_t *tri;
 
-	tr.pc.c_deformedSurfaces++;
-	tr.pc.c_deformedVerts += deformInfo->numOutputVerts;
-	tr.pc.c_deformedIndexes += deformInfo->numIndexes;
+	Sys_InterlockedIncrement( tr.pc.c_deformedSurfaces );
+	Sys_InterlockedAdd( tr.pc.c_deformedVerts, deformInfo->numOutputVerts );
+	Sys_InterlockedAdd( tr.pc.c_deformedIndexes, deformInfo->numIndexes );
 
 	surf->shader = shader;
 
@@ -299,6 +566,7 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 
 	// note that some of the data is references, and should not be freed
 	tri->deformedSurface = true;
+	tri->dynamicVerts = true;
 	tri->tangentsCalculated = false;
 	tri->facePlanesCalculated = false;
 
@@ -324,6 +592,8 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 
 	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
 		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
+	} else if ( lowDetail ) {
+		SIMDProcessor->TransformVerts( tri->verts, texCoords.Num(), entJoints, lodScaledWeights, lodWeightIndex, texCoords.Num() );
 	} else {
 		TransformVerts( tri->verts, entJoints );
 	}
@@ -480,6 +750,208 @@ void idRenderModelMD5::InitFromFile( const char *fileName ) {
 	LoadModel();
 }
 
+/*
+====================
+idRenderModelMD5::SetupJoints
+
+Converts the default pose from model space to the space of the parent joints.
+The weights of leaf joints are moved to their parents for the low detail skinning.
+====================
+*/
+void idRenderModelMD5::SetupJoints( idJointMat *poseMat3, int *lodJoints ) {
+	int			i;
+	int			parentNum;
+	idJointQuat	*pose;
+	idMD5Joint	*joint;
+	bool		*hasChildren;
+
+	pose = defaultPose.Ptr();
+	joint = joints.Ptr();
+	for( i = 0; i < joints.Num(); i++, joint++, pose++ ) {
+		poseMat3[ i ].SetRotation( pose->q.ToMat3() );
+		poseMat3[ i ].SetTranslation( pose->t );
+		if ( joint->parent ) {
+			parentNum = joint->parent - joints.Ptr();
+			pose->q = ( poseMat3[ i ].ToMat3() * poseMat3[ parentNum ].ToMat3().Transpose() ).ToQuat();
+			pose->t = ( poseMat3[ i ].ToVec3() - poseMat3[ parentNum ].ToVec3() ) * poseMat3[ parentNum ].ToMat3().Transpose();
+		}
+	}
+
+	hasChildren = ( bool * )_alloca16( joints.Num() * sizeof( hasChildren[0] ) );
+	memset( hasChildren, 0, joints.Num() * sizeof( hasChildren[0] ) );
+	for( i = 0; i < joints.Num(); i++ ) {
+		if ( joints[ i ].parent ) {
+			hasChildren[ joints[ i ].parent - joints.Ptr() ] = true;
+		}
+	}
+	for( i = 0; i < joints.Num(); i++ ) {
+		if ( joints[ i ].parent && !hasChildren[ i ] ) {
+			lodJoints[ i ] = joints[ i ].parent - joints.Ptr();
+		} else {
+			lodJoints[ i ] = i;
+		}
+	}
+}
+
+/*
+====================
+idRenderModelMD5::BinaryFileName
+====================
+*/
+idStr idRenderModelMD5::BinaryFileName( void ) const {
+	idStr fileName;
+
+	fileName = "generated/";
+	fileName += name;
+	fileName.SetFileExtension( MD5_MESH_BINARY_EXT );
+	return fileName;
+}
+
+/*
+====================
+idRenderModelMD5::LoadBinaryModel
+
+The binary file is mapped and only the parsing is skipped, the weights and
+deform info are built in the same way as for a text file.
+Returns false if there is no up to date binary file.
+====================
+*/
+bool idRenderModelMD5::LoadBinaryModel( void ) {
+	idStr						fileName;
+	const void *				buffer;
+	const byte *				data;
+	const byte *				end;
+	const char *				jointName;
+	const idJointQuat *			pose;
+	ID_TIME_T					textTimeStamp;
+	int							i, length, textLength, parentNum;
+	int							version, fileTextLength, fileTimeStamp, numJoints, numMeshes;
+	idJointMat *				poseMat3;
+	int *						lodJoints;
+	idList<int>					swapped;
+	bool						ok;
+
+	poseMat3 = NULL;
+
+	textLength = fileSystem->ReadFile( name, NULL, &textTimeStamp );
+	if ( textLength < 0 ) {
+		return false;
+	}
+
+	fileName = BinaryFileName();
+	length = fileSystem->MapFile( fileName, &buffer );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	data = (const byte *)buffer;
+	end = data + length;
+
+	if ( !R_ReadMD5Data( data, end, 1, 4 ) || !R_ReadMD5Int( data, end, version )
+			|| !R_ReadMD5Int( data, end, fileTextLength ) || !R_ReadMD5Int( data, end, fileTimeStamp ) ) {
+		common->Warning( "%s is corrupt", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	if ( memcmp( buffer, MD5_MESH_BINARY_ID, 4 ) != 0 || version != MD5_MESH_BINARY_VERSION
+			|| fileTextLength != textLength || (unsigned int)fileTimeStamp != (unsigned int)textTimeStamp ) {
+		common->Printf( "%s is out of date\n", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	// every joint takes at least a pose, a name and a parent, and every mesh at least a shader name and four counts
+	if ( !R_ReadMD5Int( data, end, numJoints ) || !R_ReadMD5Int( data, end, numMeshes )
+			|| numJoints <= 0 || numJoints > ( end - data ) / (int)( sizeof( idJointQuat ) + 3 * sizeof( int ) )
+				|| numMeshes < 0 || numMeshes > ( end - data ) / (int)( 5 * sizeof( int ) ) ) {
+		common->Warning( "%s is corrupt", fileName.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	joints.SetGranularity( 1 );
+	joints.SetNum( numJoints );
+	defaultPose.SetGranularity( 1 );
+	defaultPose.SetNum( numJoints );
+	meshes.SetGranularity( 1 );
+	meshes.SetNum( numMeshes );
+
+	ok = true;
+	for( i = 0; ok && i < joints.Num(); i++ ) {
+		pose = (const idJointQuat *)R_ReadMD5Words( data, end, 1, sizeof( *pose ), swapped );
+		jointName = R_ReadMD5String( data, end );
+		ok = ( pose != NULL && jointName != NULL && R_ReadMD5Int( data, end, parentNum ) && parentNum < i );
+		if ( ok ) {
+			joints[ i ].name = jointName;
+			joints[ i ].parent = ( parentNum < 0 ) ? NULL : &joints[ parentNum ];
+			defaultPose[ i ] = *pose;
+		}
+	}
+
+	if ( ok ) {
+		poseMat3 = ( idJointMat * )_alloca16( joints.Num() * sizeof( *poseMat3 ) );
+		lodJoints = ( int * )_alloca16( joints.Num() * sizeof( lodJoints[0] ) );
+		SetupJoints( poseMat3, lodJoints );
+
+		for( i = 0; ok && i < meshes.Num(); i++ ) {
+			ok = meshes[ i ].ReadBinaryMesh( data, end, defaultPose.Num(), poseMat3, lodJoints );
+		}
+	}
+
+	if ( ok ) {
+		ok = ( data == end );
+	}
+
+	fileSystem->UnmapFile( buffer );
+
+	if ( !ok ) {
+		common->Warning( "%s is corrupt", fileName.c_str() );
+		PurgeModel();
+		purged = false;
+		return false;
+	}
+
+	//
+	// calculate the bounds of the model
+	//
+	CalculateBounds( poseMat3 );
+
+	return true;
+}
+
+/*
+====================
+idRenderModelMD5::WriteBinaryModel
+
+The data appended while parsing the text file is written after a header
+====================
+*/
+void idRenderModelMD5::WriteBinaryModel( const idList<byte> &data ) const {
+	idList<byte>			header;
+	ID_TIME_T				textTimeStamp;
+	idStr					fileName;
+	byte *					buffer;
+	int						length;
+
+	R_AppendMD5Data( header, MD5_MESH_BINARY_ID, 4 );
+	R_AppendMD5Int( header, MD5_MESH_BINARY_VERSION );
+	R_AppendMD5Int( header, fileSystem->ReadFile( name, NULL, &textTimeStamp ) );
+	R_AppendMD5Int( header, (int)textTimeStamp );
+	R_AppendMD5Int( header, joints.Num() );
+	R_AppendMD5Int( header, meshes.Num() );
+
+	length = header.Num() + data.Num();
+	buffer = (byte *)Mem_Alloc( length );
+	memcpy( buffer, header.Ptr(), header.Num() );
+	memcpy( buffer + header.Num(), data.Ptr(), data.Num() );
+
+	fileName = BinaryFileName();
+	fileSystem->WriteFile( fileName, buffer, length );
+
+	Mem_Free( buffer );
+}
+
 /*
 ====================
 idRenderModelMD5::LoadModel
@@ -492,23 +964,35 @@ void idRenderModelMD5::LoadModel() {
 	int			version;
 	int			i;
 	int			num;
-	int			parentNum;
 	idToken		token;
 	idLexer		parser( LEXFL_ALLOWPATHNAMES | LEXFL_NOSTRINGESCAPECHARS );
 	idJointQuat	*pose;
 	idMD5Joint	*joint;
 	idJointMat *poseMat3;
+	int			*lodJoints;
+	idList<byte> binary;
+	bool		writeBinary;
 
 	if ( !purged ) {
 		PurgeModel();
 	}
 	purged = false;
 
+	// the binary file skips the tokenizing of the text file
+	if ( r_useBinaryMD5Meshes.GetBool() && LoadBinaryModel() ) {
+		// set the timestamp for reloadmodels
+		fileSystem->ReadFile( name, NULL, &timeStamp );
+		return;
+	}
+
 	if ( !parser.LoadFile( name ) ) {
 		MakeDefaultModel();
 		return;
 	}
 
+	writeBinary = r_useBinaryMD5Meshes.GetBool();
+	binary.SetGranularity( 65536 );
+
 	parser.ExpectTokenString( MD5_VERSION_STRING );
 	version = parser.ParseInt();
 
@@ -530,6 +1014,7 @@ void idRenderModelMD5::LoadModel() {
 	defaultPose.SetGranularity( 1 );
 	defaultPose.SetNum( num );
 	poseMat3 = ( idJointMat * )_alloca16( num * sizeof( *poseMat3 ) );
+	lodJoints = ( int * )_alloca16( num * sizeof( lodJoints[0] ) );
 
 	// parse num meshes
 	parser.ExpectTokenString( "numMeshes" );
@@ -549,19 +1034,21 @@ void idRenderModelMD5::LoadModel() {
 	joint = joints.Ptr();
 	for( i = 0; i < joints.Num(); i++, joint++, pose++ ) {
 		ParseJoint( parser, joint, pose );
-		poseMat3[ i ].SetRotation( pose->q.ToMat3() );
-		poseMat3[ i ].SetTranslation( pose->t );
-		if ( joint->parent ) {
-			parentNum = joint->parent - joints.Ptr();
-			pose->q = ( poseMat3[ i ].ToMat3() * poseMat3[ parentNum ].ToMat3().Transpose() ).ToQuat();
-			pose->t = ( poseMat3[ i ].ToVec3() - poseMat3[ parentNum ].ToVec3() ) * poseMat3[ parentNum ].ToMat3().Transpose();
+		if ( writeBinary ) {
+			R_AppendMD5Words( binary, pose, 1, sizeof( *pose ) );
+			R_AppendMD5String( binary, joint->name );
+			R_AppendMD5Int( binary, joint->parent ? joint->parent - joints.Ptr() : -1 );
 		}
 	}
 	parser.ExpectTokenString( "}" );
 
+	SetupJoints( poseMat3, lodJoints );
+
 	for( i = 0; i < meshes.Num(); i++ ) {
 		parser.ExpectTokenString( "mesh" );
-		meshes[ i ].ParseMesh( parser, defaultPose.Num(), poseMat3 );
+		if ( !meshes[ i ].ParseMesh( parser, defaultPose.Num(), poseMat3, lodJoints, writeBinary ? &binary : NULL ) ) {
+			writeBinary = false;
+		}
 	}
 
 	//
@@ -569,6 +1056,10 @@ void idRenderModelMD5::LoadModel() {
 	//
 	CalculateBounds( poseMat3 );
 
+	if ( writeBinary ) {
+		WriteBinaryModel( binary );
+	}
+
 	// set the timestamp for reloadmodels
 	fileSystem->ReadFile( name, NULL, &timeStamp );
 }
@@ -714,6 +1205,35 @@ void idRenderModelMD5::DrawJoints( const renderEntity_t *ent, const struct viewD
 	}
 }
 
+/*
+====================
+R_UseLowDetailSkinning
+
+True if the entity covers so little of the view that a single
+weight per vertex is good enough.
+====================
+*/
+static bool R_UseLowDetailSkinning( const struct renderEntity_s *ent, const struct viewDef_s *view ) {
+	float	radius;
+	float	distance;
+	float	size;
+
+	if ( !r_skinningLOD.GetBool() || view == NULL ) {
+		return false;
+	}
+
+	radius = ent->bounds.GetRadius();
+	distance = ( ent->origin - view->renderView.vieworg ).Length();
+	if ( distance <= radius ) {
+		return false;
+	}
+
+	// fraction of the view width covered by the bounds
+	size = radius / ( distance * idMath::Tan( DEG2RAD( view->renderView.fov_x * 0.5f ) ) );
+
+	return ( size < r_skinningLODScreenSize.GetFloat() );
+}
+
 /*
 ====================
 idRenderModelMD5::InstantiateDynamicModel
@@ -723,6 +1243,8 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 	int					i, surfaceNum;
 	idMD5Mesh			*mesh;
 	idRenderModelStatic	*staticModel;
+	bool				reuseSkinning;
+	bool				lowDetail;
 
 	if ( cachedModel && !r_useCachedDynamicModels.GetBool() ) {
 		delete cachedModel;
@@ -744,8 +1266,6 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 		return NULL;
 	}
 
-	tr.pc.c_generateMd5++;
-
 	if ( cachedModel ) {
 		assert( dynamic_cast<idRenderModelStatic *>(cachedModel) != NULL );
 		assert( idStr::Icmp( cachedModel->Name(), MD5_SnapshotName ) == 0 );
@@ -755,6 +1275,30 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 		staticModel->InitEmpty( MD5_SnapshotName );
 	}
 
+	lowDetail = R_UseLowDetailSkinning( ent, view );
+
+	if ( r_showAnimLOD.GetBool() && view != NULL ) {
+		idBounds bounds;
+		bounds.FromTransformedBounds( ent->bounds, vec3_zero, ent->axis );
+		session->rw->DebugBounds( lowDetail ? colorRed : colorGreen, bounds, ent->origin );
+	}
+
+	// the snapshot is rebuilt on every entity update, but the surfaces that are
+	// already in it can be kept as long as the joints haven't changed since
+	// they were skinned, which is the case for paused and dormant animations
+	// and for the later views of a frame
+	reuseSkinning = r_useSkinningCache.GetBool() && ent->jointsSerial != 0
+						&& staticModel->skinnedJointsSerial == ent->jointsSerial
+						&& staticModel->skinnedJoints == ent->joints
+						&& staticModel->skinnedScale == ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ]
+						&& staticModel->skinnedLowDetail == lowDetail;
+
+	if ( reuseSkinning ) {
+		Sys_InterlockedIncrement( tr.pc.c_reusedMd5 );
+	} else {
+		Sys_InterlockedIncrement( tr.pc.c_generateMd5 );
+	}
+
 	staticModel->bounds.Clear();
 
 	if ( r_showSkel.GetInteger() ) {
@@ -789,6 +1333,12 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 		if ( staticModel->FindSurfaceWithId( i, surfaceNum ) ) {
 			mesh->surfaceNum = surfaceNum;
 			surf = &staticModel->surfaces[surfaceNum];
+
+			if ( reuseSkinning && surf->geometry && surf->shader == mesh->shader ) {
+				staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
+				staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
+				continue;
+			}
 		} else {
 
 			// Remove Overlays before adding new surfaces
@@ -801,12 +1351,17 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 			surf->id = i;
 		}
 
-		mesh->UpdateSurface( ent, ent->joints, surf );
+		mesh->UpdateSurface( ent, ent->joints, surf, lowDetail );
 
 		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
 		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
 	}
 
+	staticModel->skinnedJoints = ent->joints;
+	staticModel->skinnedJointsSerial = ent->jointsSerial;
+	staticModel->skinnedScale = ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ];
+	staticModel->skinnedLowDetail = lowDetail;
+
 	return staticModel;
 }
 
@@ -953,6 +1508,7 @@ int	idRenderModelMD5::Memory() const {
 		const idMD5Mesh *mesh = &meshes[i];
 
 		total += mesh->texCoords.MemoryUsed() + mesh->numWeights * ( sizeof( mesh->scaledWeights[0] ) + sizeof( mesh->weightIndex[0] ) * 2 );
+		total += mesh->texCoords.Num() * ( sizeof( mesh->lodScaledWeights[0] ) + sizeof( mesh->lodWeightIndex[0] ) * 2 );
 
 		// sum up deform info
 		total += sizeof( mesh->deformInfo );
@@ -39,6 +39,7 @@ idRenderEntityLocal::idRenderEntityLocal() {
 	index					= 0;
 	lastModifiedFrameNum	= 0;
 	archived				= false;
+	movedAfterLoad			= false;
 	dynamicModel			= NULL;
 	dynamicModelFrameCount	= 0;
 	cachedDynamicModel		= NULL;
@@ -86,6 +87,7 @@ idRenderLightLocal::idRenderLightLocal() {
 	memset( frustumWindings, 0, sizeof( frustumWindings ) );
 
 	lightHasMoved			= false;
+	movedAfterLoad			= false;
 	world					= NULL;
 	index					= 0;
 	areaNum					= 0;
@@ -72,9 +72,10 @@ static void R_PerformanceCounters( void ) {
 	}
 
 	if ( r_showDynamic.GetBool() ) {
-		common->Printf( "callback:%i md5:%i dfrmVerts:%i dfrmTris:%i tangTris:%i guis:%i\n",
+		common->Printf( "callback:%i md5:%i (reused:%i) dfrmVerts:%i dfrmTris:%i tangTris:%i guis:%i\n",
 			tr.pc.c_entityDefCallbacks,
 			tr.pc.c_generateMd5,
+			tr.pc.c_reusedMd5,
 			tr.pc.c_deformedVerts,
 			tr.pc.c_deformedIndexes/3,
 			tr.pc.c_tangentIndexes/3,
@@ -108,6 +109,11 @@ static void R_PerformanceCounters( void ) {
 	if ( r_showMemory.GetBool() ) {
 		int	m1 = frameData ? frameData->memoryHighwater : 0;
 		common->Printf( "frameData: %i (%i)\n", R_CountFrameData(), m1 );
+		for ( int i = 0; i < MAX_FRAME_ARENAS; i++ ) {
+			if ( frameArenas[i].highwater ) {
+				common->Printf( "  thread %i: (%i)\n", i, frameArenas[i].highwater );
+			}
+		}
 	}
 	if ( r_showLightScale.GetBool() ) {
 		common->Printf( "lightScale: %f\n", backEnd.pc.maxLightValue );
@@ -119,6 +125,187 @@ static void R_PerformanceCounters( void ) {
 
 
 
+/*
+==============================================================
+
+r_smp back end thread
+
+The front end issues a command chain and goes on building the next frame
+into the other frameData while the back end thread executes it.  Only one
+chain is ever in flight, so issuing always waits for the previous one.
+
+==============================================================
+*/
+
+typedef struct {
+	xthreadInfo				threadInfo;
+	xsignalHandle			wakeSignal;			// raised by the front end for each request
+	xsignalHandle			doneSignal;			// raised by the back end when a request is finished
+	const emptyCommand_t *	cmds;				// NULL if only the context is released
+	bool					releaseContext;		// give the GL context up after the commands
+	bool					shutdown;
+	bool					active;
+	bool					pending;			// a request hasn't been waited for yet
+	bool					backEndOwnsContext;
+} renderThread_t;
+
+static renderThread_t				renderThread;
+static ID_THREAD_LOCAL bool			onRenderThread;
+
+/*
+====================
+R_RenderThread
+====================
+*/
+static unsigned int R_RenderThread( void *parms ) {
+	onRenderThread = true;
+
+	bool hasContext = false;
+	while( 1 ) {
+		Sys_WaitForSignal( renderThread.wakeSignal );
+
+		if ( renderThread.cmds ) {
+			if ( !hasContext ) {
+				GLimp_ActivateContext();
+				hasContext = true;
+			}
+			RB_ExecuteBackEndCommands( renderThread.cmds );
+			GL_CheckErrors();
+		}
+		if ( renderThread.releaseContext && hasContext ) {
+			GLimp_DeactivateContext();
+			hasContext = false;
+		}
+
+		bool shutdown = renderThread.shutdown;
+		Sys_RaiseSignal( renderThread.doneSignal );
+		if ( shutdown ) {
+			break;
+		}
+	}
+	return 0;
+}
+
+/*
+====================
+R_RenderThreadActive
+====================
+*/
+bool R_RenderThreadActive( void ) {
+	return renderThread.active;
+}
+
+/*
+====================
+R_WaitForRenderThread
+====================
+*/
+void R_WaitForRenderThread( void ) {
+	if ( !renderThread.pending || onRenderThread ) {
+		return;
+	}
+	Sys_WaitForSignal( renderThread.doneSignal );
+	renderThread.pending = false;
+}
+
+/*
+====================
+R_WakeRenderThread
+
+Hands the GL context to the back end thread if the front end had
+taken it, the signals order the memory accesses on both sides
+====================
+*/
+static void R_WakeRenderThread( const emptyCommand_t *cmds ) {
+	R_WaitForRenderThread();
+
+	if ( !renderThread.backEndOwnsContext ) {
+		GLimp_DeactivateContext();
+		renderThread.backEndOwnsContext = true;
+	}
+
+	renderThread.cmds = cmds;
+	renderThread.releaseContext = false;
+	renderThread.pending = true;
+	Sys_RaiseSignal( renderThread.wakeSignal );
+}
+
+/*
+====================
+R_SyncRenderThread
+
+Waits for the back end and makes the GL context current on the calling
+thread, which has to be done before the front end touches GL.  The back end
+gets the context back with the next issued commands.
+====================
+*/
+void R_SyncRenderThread( void ) {
+	if ( !renderThread.active || onRenderThread ) {
+		return;
+	}
+
+	R_WaitForRenderThread();
+
+	if ( renderThread.backEndOwnsContext ) {
+		renderThread.cmds = NULL;
+		renderThread.releaseContext = true;
+		renderThread.pending = true;
+		Sys_RaiseSignal( renderThread.wakeSignal );
+		R_WaitForRenderThread();
+
+		GLimp_ActivateContext();
+		renderThread.backEndOwnsContext = false;
+	}
+}
+
+/*
+====================
+R_InitRenderThread
+
+Called after the GL context has been created
+====================
+*/
+void R_InitRenderThread( void ) {
+	if ( renderThread.active || !r_smp.GetBool() ) {
+		return;
+	}
+
+	memset( &renderThread, 0, sizeof( renderThread ) );
+	renderThread.wakeSignal = Sys_CreateSignal();
+	renderThread.doneSignal = Sys_CreateSignal();
+	Sys_CreateThread( (xthread_t)R_RenderThread, NULL, THREAD_ABOVE_NORMAL, renderThread.threadInfo, "RenderBackEnd", g_threads, &g_thread_count );
+	renderThread.active = true;
+
+	common->Printf( "using a back end thread\n" );
+}
+
+/*
+====================
+R_ShutdownRenderThread
+
+Leaves the GL context current on the calling thread
+====================
+*/
+void R_ShutdownRenderThread( void ) {
+	if ( !renderThread.active ) {
+		return;
+	}
+
+	R_SyncRenderThread();
+
+	renderThread.cmds = NULL;
+	renderThread.releaseContext = true;
+	renderThread.shutdown = true;
+	renderThread.pending = true;
+	Sys_RaiseSignal( renderThread.wakeSignal );
+	R_WaitForRenderThread();
+
+	Sys_DestroyThread( renderThread.threadInfo );
+	Sys_DestroySignal( renderThread.wakeSignal );
+	Sys_DestroySignal( renderThread.doneSignal );
+	renderThread.active = false;
+}
+
 /*
 ====================
 R_IssueRenderCommands
@@ -133,6 +320,9 @@ static void R_IssueRenderCommands( void ) {
 		return;
 	}
 
+	// the front end only wrote the frame temp vertexes to memory
+	vertexCache.UploadFrameTemp();
+
 	// r_skipBackEnd allows the entire time of the back end
 	// to be removed from performance measurements, although
 	// nothing will be drawn to the screen.  If the prints
@@ -142,7 +332,11 @@ static void R_IssueRenderCommands( void ) {
 	// r_skipRender is usually more usefull, because it will still
 	// draw 2D graphics
 	if ( !r_skipBackEnd.GetBool() ) {
-		RB_ExecuteBackEndCommands( frameData->cmdHead );
+		if ( R_RenderThreadActive() ) {
+			R_WakeRenderThread( frameData->cmdHead );
+		} else {
+			RB_ExecuteBackEndCommands( frameData->cmdHead );
+		}
 	}
 
 	R_ClearCommandChain();
@@ -538,6 +732,9 @@ void idRenderSystemLocal::SetBackEndRenderer() {
 		return;
 	}
 
+	// the back end thread may still be drawing with the old path
+	R_WaitForRenderThread();
+
 	bool oldVPstate = backEndRendererHasVertexPrograms;
 
 	backEndRenderer = BE_BAD;
@@ -721,10 +918,16 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 		return;
 	}
 
+	vertexCache.DrawStats();
+
 	// close any gui drawing
 	guiModel->EmitFullScreen();
 	guiModel->Clear();
 
+	// with r_smp the back end counters are those of the previous frame,
+	// which has to finish before they can be read
+	R_WaitForRenderThread();
+
 	// save out timing information
 	if ( frontEndMsec ) {
 		*frontEndMsec = pc.frontEndMsec;
@@ -739,8 +942,10 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 	// check for dynamic changes that require some initialization
 	R_CheckCvars();
 
-    // check for errors
-	GL_CheckErrors();
+	// check for errors, the back end thread does this after each frame
+	if ( !R_RenderThreadActive() ) {
+		GL_CheckErrors();
+	}
 
 	// add the swapbuffers command
 	cmd = (emptyCommand_t *)R_GetCommandBuffer( sizeof( *cmd ) );
@@ -968,6 +1173,7 @@ void idRenderSystemLocal::CaptureRenderToFile( const char *fileName, bool fixAlp
 	guiModel->EmitFullScreen();
 	guiModel->Clear();
 	R_IssueRenderCommands();
+	R_SyncRenderThread();
 
 	qglReadBuffer( GL_BACK );
 
@@ -69,6 +69,12 @@ idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "us
 idCVar r_useTwoSidedStencil( "r_useTwoSidedStencil", "1", CVAR_RENDERER | CVAR_BOOL, "do stencil shadows in one pass with different ops on each side" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models" );
+idCVar r_useSkinningCache( "r_useSkinningCache", "1", CVAR_RENDERER | CVAR_BOOL, "reuse skinned md5 vertexes until the joints change" );
+idCVar r_skinningLOD( "r_skinningLOD", "1", CVAR_RENDERER | CVAR_BOOL, "skin md5 models that cover little of the view with a single weight per vertex and without leaf joints" );
+idCVar r_skinningLODScreenSize( "r_skinningLODScreenSize", "0.05", CVAR_RENDERER | CVAR_FLOAT, "fraction of the view width below which md5 models use the low detail skinning" );
+idCVar r_useBinaryMD5Meshes( "r_useBinaryMD5Meshes", "1", CVAR_RENDERER | CVAR_BOOL, "load md5 meshes from the binary files in generated/, which are written when a mesh is parsed" );
+idCVar r_useParallelAddModels( "r_useParallelAddModels", "1", CVAR_RENDERER | CVAR_BOOL, "instantiate dynamic models and create their interactions on the job threads" );
+idCVar r_smp( "r_smp", "0", CVAR_RENDERER | CVAR_BOOL, "execute the back end commands on their own thread while the front end builds the next frame, takes effect at vid_restart, disables vertex buffer objects so all vertexes are drawn from the much slower virtual memory vertex cache" );
 
 idCVar r_useVertexBuffers( "r_useVertexBuffers", "1", CVAR_RENDERER | CVAR_INTEGER, "use ARB_vertex_buffer_object for vertexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
 idCVar r_useIndexBuffers( "r_useIndexBuffers", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "use ARB_vertex_buffer_object for indexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
@@ -206,6 +212,7 @@ idCVar r_lockSurfaces( "r_lockSurfaces", "0", CVAR_RENDERER | CVAR_BOOL, "allow
 idCVar r_useEntityCallbacks( "r_useEntityCallbacks", "1", CVAR_RENDERER | CVAR_BOOL, "if 0, issue the callback immediately at update time, rather than defering" );
 
 idCVar r_showSkel( "r_showSkel", "0", CVAR_RENDERER | CVAR_INTEGER, "draw the skeleton when model animates, 1 = draw model with skeleton, 2 = draw skeleton only", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+idCVar r_showAnimLOD( "r_showAnimLOD", "0", CVAR_RENDERER | CVAR_BOOL, "show the animation lod of entities and draw the bounds of md5 models, green = full skinning, red = low detail skinning" );
 idCVar r_jointNameScale( "r_jointNameScale", "0.02", CVAR_RENDERER | CVAR_FLOAT, "size of joint names when r_showskel is set to 1" );
 idCVar r_jointNameOffset( "r_jointNameOffset", "0.5", CVAR_RENDERER | CVAR_FLOAT, "offset of joint names when r_showskel is set to 1" );
 
@@ -780,6 +787,9 @@ void R_InitOpenGL( void ) {
 	// allocate the frame data, which may be more if smp is enabled
 	R_InitFrameData();
 
+	// the back end thread takes the context with the first issued frame
+	R_InitRenderThread();
+
 	// Reset our gamma
 	R_SetColorMappings();
 
@@ -1261,6 +1271,9 @@ void R_ReadTiledPixels( int width, int height, byte *buffer, renderView_t *ref =
 				h = height - yo;
 			}
 
+			// the frame may have been issued to the back end thread
+			R_SyncRenderThread();
+
 			qglReadBuffer( GL_FRONT );
 			qglReadPixels( 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, temp ); 
 
@@ -1975,6 +1988,9 @@ void R_VidRestart_f( const idCmdArgs &args ) {
 	// this could take a while, so give them the cursor back ASAP
 	Sys_GrabMouseCursor( false );
 
+	// nothing can be freed while the back end thread is drawing
+	R_SyncRenderThread();
+
 	// dump ambient caches
 	renderModelManager->FreeModelVertexCaches();
 
@@ -1995,6 +2011,8 @@ void R_VidRestart_f( const idCmdArgs &args ) {
 		soundSystem->ShutdownHW();
 		Sys_ShutdownInput();
 		globalImages->PurgeAllImages();
+		// the back end thread is restarted with the new context
+		R_ShutdownRenderThread();
 		// free the context and close the window
 		GLimp_Shutdown();
 		glConfig.isInitialized = false;
@@ -2259,6 +2277,8 @@ idRenderSystemLocal::Shutdown
 void idRenderSystemLocal::Shutdown( void ) {	
 	common->Printf( "idRenderSystem::Shutdown()\n" );
 
+	R_ShutdownRenderThread();
+
 	R_DoneFreeType( );
 
 	if ( glConfig.isInitialized ) {
@@ -2286,6 +2306,8 @@ void idRenderSystemLocal::Shutdown( void ) {
 
 	R_ShutdownTriSurfData();
 
+	R_ShutdownShadowBuffers();
+
 	RB_ShutdownDebugTools();
 
 	delete guiModel;
@@ -2302,6 +2324,7 @@ idRenderSystemLocal::BeginLevelLoad
 ========================
 */
 void idRenderSystemLocal::BeginLevelLoad( void ) {
+	R_SyncRenderThread();
 	renderModelManager->BeginLevelLoad();
 	globalImages->BeginLevelLoad();
 }
@@ -2312,6 +2335,7 @@ idRenderSystemLocal::EndLevelLoad
 ========================
 */
 void idRenderSystemLocal::EndLevelLoad( void ) {
+	R_SyncRenderThread();
 	renderModelManager->EndLevelLoad();
 	globalImages->EndLevelLoad();
 	if ( r_forceLoadImages.GetBool() ) {
@@ -2347,6 +2371,7 @@ idRenderSystemLocal::ShutdownOpenGL
 */
 void idRenderSystemLocal::ShutdownOpenGL( void ) {
 	// free the context and close the window
+	R_ShutdownRenderThread();
 	R_ShutdownFrameData();
 	GLimp_Shutdown();
 	glConfig.isInitialized = false;
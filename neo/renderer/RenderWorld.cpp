@@ -127,6 +127,7 @@ idRenderWorldLocal::idRenderWorldLocal
 idRenderWorldLocal::idRenderWorldLocal() {
 	mapName.Clear();
 	mapTimeStamp = FILE_NOT_FOUND_TIMESTAMP;
+	mapCrc = 0;
 
 	generateAllInteractionsCalled = false;
 
@@ -253,6 +254,11 @@ void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEn
 			}
 		}
 
+		// movers and doors would add a cache entry for every position
+		if ( generateAllInteractionsCalled && ( re->hModel != def->parms.hModel || re->origin != def->parms.origin || re->axis != def->parms.axis ) ) {
+			def->movedAfterLoad = true;
+		}
+
 		// save any decals if the model is the same, allowing marks to move with entities
 		if ( def->parms.hModel == re->hModel ) {
 			R_FreeEntityDefDerivedData( def, true, true );
@@ -411,6 +417,9 @@ void idRenderWorldLocal::UpdateLightDef( qhandle_t lightHandle, const renderLigh
 		} else {
 			// if we are updating shadows, the prelight model is no longer valid
 			light->lightHasMoved = true;
+			if ( generateAllInteractionsCalled ) {
+				light->movedAfterLoad = true;
+			}
 			R_FreeLightDefDerivedData( light );
 		}
 	} else {
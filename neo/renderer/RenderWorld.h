@@ -40,6 +40,18 @@ If you have questions concerning this license or the applicable additional terms
 #define PROC_FILE_EXT				"proc"
 #define	PROC_FILE_ID				"mapProcFile003"
 
+// binary version of the proc file written by dmap
+#define BPROC_FILE_EXT				"bproc"
+#define BPROC_FILE_ID				"BPRC"
+#define BPROC_FILE_VERSION			1
+
+typedef enum {
+	BPROC_MODEL,
+	BPROC_SHADOW_MODEL,
+	BPROC_INTER_AREA_PORTALS,
+	BPROC_NODES
+} bprocChunk_t;
+
 // shader parms
 const int MAX_GLOBAL_SHADER_PARMS	= 12;
 
@@ -134,6 +146,9 @@ typedef struct renderEntity_s {
 	int						numJoints;
 	idJointMat *			joints;					// array of joints that will modify vertices.
 													// NULL if non-deformable model.  NOT freed by renderer
+	int						jointsSerial;			// changed by the owner whenever the joints change, the
+													// skinned vertexes are reused while it stays the same.
+													// 0 if unknown, the model is skinned every time
 
 	float					modelDepthHack;			// squash depth range so particle effects don't clip into walls
 
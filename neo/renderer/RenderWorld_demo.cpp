@@ -664,6 +664,7 @@ void	idRenderWorldLocal::ReadRenderEntity() {
 	session->readDemo->ReadBool( ent.weaponDepthHack );
 	session->readDemo->ReadInt( ent.forceUpdate );
 	ent.callback = NULL;
+	ent.jointsSerial = 0;
 	if ( ent.customShader ) {
 		ent.customShader = declManager->FindMaterial( session->readDemo->ReadHashString() );
 	}
@@ -31,6 +31,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "tr_local.h"
 
+idCVar r_useBinaryProc( "r_useBinaryProc", "1", CVAR_RENDERER | CVAR_BOOL, "load the binary proc file written by dmap instead of parsing the text file" );
 
 /*
 ================
@@ -369,6 +370,449 @@ void idRenderWorldLocal::ParseNodes( idLexer *src ) {
 	src->ExpectTokenString( "}" );
 }
 
+/*
+================
+R_ProcFileCrc
+
+The interaction cache and the binary proc file are keyed by the
+contents of the text file, returns 0 if it can't be read
+================
+*/
+static unsigned int R_ProcFileCrc( const char *filename, int length ) {
+	const void *	buffer;
+	unsigned int	crc;
+
+	crc = 0;
+	if ( fileSystem->MapFile( filename, &buffer ) == length ) {
+		crc = CRC32_BlockChecksum( buffer, length );
+	}
+	if ( buffer ) {
+		fileSystem->UnmapFile( buffer );
+	}
+	return crc;
+}
+
+/*
+================
+R_BinaryProcHasData
+
+Checks that the binary proc file has enough data left for count items
+================
+*/
+static bool R_BinaryProcHasData( idFile *f, int count, int itemSize ) {
+	return count >= 0 && count <= ( f->Length() - f->Tell() ) / itemSize;
+}
+
+/*
+================
+R_ReadBinaryProcString
+================
+*/
+static bool R_ReadBinaryProcString( idFile *f, idStr &string ) {
+	char	buffer[MAX_STRING_CHARS];
+	int		length;
+
+	f->ReadInt( length );
+	if ( length < 0 || length >= MAX_STRING_CHARS || !R_BinaryProcHasData( f, length, 1 ) ) {
+		return false;
+	}
+	f->Read( buffer, length );
+	buffer[length] = '\0';
+	string = buffer;
+	return true;
+}
+
+/*
+================
+R_ReadBinaryProcIndexes
+================
+*/
+static bool R_ReadBinaryProcIndexes( idFile *f, srfTriangles_t *tri, int numVerts ) {
+	int		j, index;
+
+	if ( !R_BinaryProcHasData( f, tri->numIndexes, sizeof( int ) ) ) {
+		return false;
+	}
+	R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+	for ( j = 0 ; j < tri->numIndexes ; j++ ) {
+		f->ReadInt( index );
+		if ( index < 0 || index >= numVerts ) {
+			return false;
+		}
+		tri->indexes[j] = index;
+	}
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryModel
+
+The model is added to the local models before the surfaces are read,
+so FreeWorld will release it if the file is bad
+================
+*/
+bool idRenderWorldLocal::ReadBinaryModel( idFile *f ) {
+	idRenderModel	*model;
+	idStr			name;
+	int				i, j, numSurfaces;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+	float			vec[8];
+
+	if ( !R_ReadBinaryProcString( f, name ) ) {
+		return false;
+	}
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( name );
+	renderModelManager->AddModel( model );
+	localModels.Append( model );
+
+	f->ReadInt( numSurfaces );
+	if ( !R_BinaryProcHasData( f, numSurfaces, 3 * sizeof( int ) ) ) {
+		return false;
+	}
+
+	for ( i = 0 ; i < numSurfaces ; i++ ) {
+		if ( !R_ReadBinaryProcString( f, name ) ) {
+			return false;
+		}
+
+		surf.shader = declManager->FindMaterial( name );
+
+		((idMaterial*)surf.shader)->AddReference();
+
+		tri = R_AllocStaticTriSurf();
+		surf.geometry = tri;
+
+		f->ReadInt( tri->numVerts );
+		f->ReadInt( tri->numIndexes );
+
+		if ( !R_BinaryProcHasData( f, tri->numVerts, sizeof( vec ) ) ) {
+			R_FreeStaticTriSurf( tri );
+			return false;
+		}
+
+		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+		for ( j = 0 ; j < tri->numVerts ; j++ ) {
+			f->Read( vec, sizeof( vec ) );
+
+			tri->verts[j].xyz[0] = LittleFloat( vec[0] );
+			tri->verts[j].xyz[1] = LittleFloat( vec[1] );
+			tri->verts[j].xyz[2] = LittleFloat( vec[2] );
+			tri->verts[j].st[0] = LittleFloat( vec[3] );
+			tri->verts[j].st[1] = LittleFloat( vec[4] );
+			tri->verts[j].normal[0] = LittleFloat( vec[5] );
+			tri->verts[j].normal[1] = LittleFloat( vec[6] );
+			tri->verts[j].normal[2] = LittleFloat( vec[7] );
+		}
+
+		if ( !R_ReadBinaryProcIndexes( f, tri, tri->numVerts ) ) {
+			R_FreeStaticTriSurf( tri );
+			return false;
+		}
+
+		// add the completed surface to the model
+		model->AddSurface( surf );
+	}
+
+	model->FinishSurfaces();
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryShadowModel
+================
+*/
+bool idRenderWorldLocal::ReadBinaryShadowModel( idFile *f ) {
+	idRenderModel	*model;
+	idStr			name;
+	int				j;
+	srfTriangles_t	*tri;
+	modelSurface_t	surf;
+	float			vec[3];
+
+	if ( !R_ReadBinaryProcString( f, name ) ) {
+		return false;
+	}
+
+	model = renderModelManager->AllocModel();
+	model->InitEmpty( name );
+	renderModelManager->AddModel( model );
+	localModels.Append( model );
+
+	surf.shader = tr.defaultMaterial;
+
+	tri = R_AllocStaticTriSurf();
+	surf.geometry = tri;
+
+	f->ReadInt( tri->numVerts );
+	f->ReadInt( tri->numShadowIndexesNoCaps );
+	f->ReadInt( tri->numShadowIndexesNoFrontCaps );
+	f->ReadInt( tri->numIndexes );
+	f->ReadInt( tri->shadowCapPlaneBits );
+
+	if ( !R_BinaryProcHasData( f, tri->numVerts, sizeof( vec ) ) ) {
+		R_FreeStaticTriSurf( tri );
+		return false;
+	}
+
+	R_AllocStaticTriSurfShadowVerts( tri, tri->numVerts );
+	tri->bounds.Clear();
+	for ( j = 0 ; j < tri->numVerts ; j++ ) {
+		f->Read( vec, sizeof( vec ) );
+
+		tri->shadowVertexes[j].xyz[0] = LittleFloat( vec[0] );
+		tri->shadowVertexes[j].xyz[1] = LittleFloat( vec[1] );
+		tri->shadowVertexes[j].xyz[2] = LittleFloat( vec[2] );
+		tri->shadowVertexes[j].xyz[3] = 1;		// no homogenous value
+
+		tri->bounds.AddPoint( tri->shadowVertexes[j].xyz.ToVec3() );
+	}
+
+	if ( !R_ReadBinaryProcIndexes( f, tri, tri->numVerts ) ) {
+		R_FreeStaticTriSurf( tri );
+		return false;
+	}
+
+	// add the completed surface to the model
+	model->AddSurface( surf );
+
+	// we do NOT do a model->FinishSurfaceces, because we don't need sil edges, planes, tangents, etc.
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryInterAreaPortals
+================
+*/
+bool idRenderWorldLocal::ReadBinaryInterAreaPortals( idFile *f ) {
+	int i, j;
+
+	if ( portalAreas ) {
+		return false;
+	}
+
+	f->ReadInt( numPortalAreas );
+	if ( !R_BinaryProcHasData( f, numPortalAreas, 1 ) ) {
+		numPortalAreas = 0;
+		return false;
+	}
+	portalAreas = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
+	areaScreenRect = (idScreenRect *) R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
+
+	// set the doubly linked lists
+	SetupAreaRefs();
+
+	f->ReadInt( numInterAreaPortals );
+	if ( !R_BinaryProcHasData( f, numInterAreaPortals, 3 * sizeof( int ) ) ) {
+		numInterAreaPortals = 0;
+		return false;
+	}
+
+	doublePortals = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals * 
+		sizeof( doublePortals [0] ) );
+
+	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
+		int		numPoints, a1, a2;
+		idWinding	*w;
+		portal_t	*p;
+		float		vec[3];
+
+		f->ReadInt( numPoints );
+		f->ReadInt( a1 );
+		f->ReadInt( a2 );
+
+		if ( numPoints < 3 || !R_BinaryProcHasData( f, numPoints, sizeof( vec ) )
+				|| a1 < 0 || a1 >= numPortalAreas || a2 < 0 || a2 >= numPortalAreas ) {
+			return false;
+		}
+
+		w = new idWinding( numPoints );
+		w->SetNumPoints( numPoints );
+		for ( j = 0 ; j < numPoints ; j++ ) {
+			f->Read( vec, sizeof( vec ) );
+			(*w)[j][0] = LittleFloat( vec[0] );
+			(*w)[j][1] = LittleFloat( vec[1] );
+			(*w)[j][2] = LittleFloat( vec[2] );
+			// no texture coordinates
+			(*w)[j][3] = 0;
+			(*w)[j][4] = 0;
+		}
+
+		// add the portal to a1
+		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+		p->intoArea = a2;
+		p->doublePortal = &doublePortals[i];
+		p->w = w;
+		p->w->GetPlane( p->plane );
+
+		p->next = portalAreas[a1].portals;
+		portalAreas[a1].portals = p;
+
+		doublePortals[i].portals[0] = p;
+
+		// reverse it for a2
+		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+		p->intoArea = a1;
+		p->doublePortal = &doublePortals[i];
+		p->w = w->Reverse();
+		p->w->GetPlane( p->plane );
+
+		p->next = portalAreas[a2].portals;
+		portalAreas[a2].portals = p;
+
+		doublePortals[i].portals[1] = p;
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryNodes
+================
+*/
+bool idRenderWorldLocal::ReadBinaryNodes( idFile *f ) {
+	int			i;
+	float		vec[4];
+
+	if ( areaNodes ) {
+		return false;
+	}
+
+	f->ReadInt( numAreaNodes );
+	if ( !R_BinaryProcHasData( f, numAreaNodes, sizeof( vec ) + 2 * sizeof( int ) ) ) {
+		numAreaNodes = 0;
+		return false;
+	}
+	areaNodes = (areaNode_t *)R_ClearedStaticAlloc( numAreaNodes * sizeof( areaNodes[0] ) );
+
+	for ( i = 0 ; i < numAreaNodes ; i++ ) {
+		areaNode_t	*node;
+
+		node = &areaNodes[i];
+
+		f->Read( vec, sizeof( vec ) );
+		node->plane[0] = LittleFloat( vec[0] );
+		node->plane[1] = LittleFloat( vec[1] );
+		node->plane[2] = LittleFloat( vec[2] );
+		node->plane[3] = LittleFloat( vec[3] );
+		f->ReadInt( node->children[0] );
+		f->ReadInt( node->children[1] );
+
+		// children are either later nodes or areas
+		for ( int j = 0 ; j < 2 ; j++ ) {
+			if ( ( node->children[j] > 0 && ( node->children[j] <= i || node->children[j] >= numAreaNodes ) )
+					|| ( node->children[j] <= 0 && -1 - node->children[j] >= numPortalAreas ) ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::LoadBinaryProc
+
+The binary proc file is only used if dmap wrote it together with the
+current text file.  Its data is copied out of the mapped file, because the
+surfaces are modified when they are finished.  If anything is wrong with it,
+the world is freed again and the text file is parsed instead.
+================
+*/
+bool idRenderWorldLocal::LoadBinaryProc( const char *procFileName, int procLength, ID_TIME_T procTimeStamp ) {
+	idStr			filename;
+	const void *	buffer;
+	ID_TIME_T		timeStamp;
+	int				length, version, fileProcLength, chunk;
+	unsigned int	fileProcCrc;
+	char			id[4];
+	bool			ok;
+
+	if ( !r_useBinaryProc.GetBool() ) {
+		return false;
+	}
+
+	filename = procFileName;
+	filename.SetFileExtension( BPROC_FILE_EXT );
+
+	length = fileSystem->MapFile( filename, &buffer, &timeStamp );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	idFile_Memory f( filename, (const char *)buffer, length );
+
+	f.Read( id, sizeof( id ) );
+	f.ReadInt( version );
+	f.ReadInt( fileProcLength );
+	f.ReadUnsignedInt( fileProcCrc );
+
+	if ( length < (int)( sizeof( id ) + 3 * sizeof( int ) ) || memcmp( id, BPROC_FILE_ID, sizeof( id ) ) != 0
+			|| version != BPROC_FILE_VERSION ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s has a bad header\n", filename.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	// a text file edited or written by another tool takes precedence
+	if ( procLength >= 0 && ( procLength != fileProcLength || procTimeStamp > timeStamp ) ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s is out of date\n", filename.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	// the text file has to have the contents the binary file was written from
+	if ( procLength >= 0 && R_ProcFileCrc( procFileName, procLength ) != fileProcCrc ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s doesn't match the text file\n", filename.c_str() );
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	ok = true;
+	while ( ok && f.Tell() < f.Length() ) {
+		f.ReadInt( chunk );
+
+		switch( chunk ) {
+			case BPROC_MODEL:
+				ok = ReadBinaryModel( &f );
+				break;
+			case BPROC_SHADOW_MODEL:
+				ok = ReadBinaryShadowModel( &f );
+				break;
+			case BPROC_INTER_AREA_PORTALS:
+				ok = ReadBinaryInterAreaPortals( &f );
+				break;
+			case BPROC_NODES:
+				ok = ReadBinaryNodes( &f );
+				break;
+			default:
+				ok = false;
+				break;
+		}
+	}
+
+	fileSystem->UnmapFile( buffer );
+
+	if ( !ok ) {
+		common->Printf( "idRenderWorldLocal::InitFromMap: %s is corrupt\n", filename.c_str() );
+		FreeWorld();
+		return false;
+	}
+
+	mapCrc = fileProcCrc;
+
+	return true;
+}
+
 /*
 ================
 idRenderWorldLocal::CommonChildrenArea_r
@@ -440,6 +884,9 @@ void idRenderWorldLocal::FreeDefs() {
 
 	generateAllInteractionsCalled = false;
 
+	// save the interactions that were created since the map was loaded
+	interactionCache.Shutdown();
+
 	if ( interactionTable ) {
 		R_StaticFree( interactionTable );
 		interactionTable = NULL;
@@ -498,7 +945,7 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	// if we are reloading the same map, check the timestamp
 	// and try to skip all the work
 	ID_TIME_T currentTimeStamp;
-	fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
+	int procLength = fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
 
 	if ( name == mapName ) {
 		if ( currentTimeStamp != FILE_NOT_FOUND_TIMESTAMP && currentTimeStamp == mapTimeStamp ) {
@@ -507,6 +954,7 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 			TouchWorldModels();
 			AddWorldModelEntities();
 			ClearPortalStates();
+			interactionCache.Init( filename, mapCrc );
 			return true;
 		}
 		common->Printf( "idRenderWorldLocal::InitFromMap: timestamp has changed, reloading.\n" );
@@ -514,71 +962,85 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 
 	FreeWorld();
 
-	src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
-	if ( !src->IsLoaded() ) {
-		common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
-		ClearWorld();
-		return false;
-	}
+	if ( LoadBinaryProc( filename, procLength, currentTimeStamp ) ) {
+		mapName = name;
+		mapTimeStamp = currentTimeStamp;
 
+		// if we are writing a demo, archive the load command
+		if ( session->writeDemo ) {
+			WriteLoadMap();
+		}
+	} else {
+		src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
+		if ( !src->IsLoaded() ) {
+			common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
+			delete src;
+			ClearWorld();
+			return false;
+		}
 
-	mapName = name;
-	mapTimeStamp = currentTimeStamp;
 
-	// if we are writing a demo, archive the load command
-	if ( session->writeDemo ) {
-		WriteLoadMap();
-	}
+		mapName = name;
+		mapTimeStamp = currentTimeStamp;
 
-	if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
-		common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
-		delete src;
-		return false;
-	}
+		// the interaction cache is keyed by the contents of the text file
+		mapCrc = R_ProcFileCrc( filename, procLength );
 
-	// parse the file
-	while ( 1 ) {
-		if ( !src->ReadToken( &token ) ) {
-			break;
+		// if we are writing a demo, archive the load command
+		if ( session->writeDemo ) {
+			WriteLoadMap();
 		}
 
-		if ( token == "model" ) {
-			lastModel = ParseModel( src );
+		if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
+			common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
+			delete src;
+			return false;
+		}
 
-			// add it to the model manager list
-			renderModelManager->AddModel( lastModel );
+		// parse the file
+		while ( 1 ) {
+			if ( !src->ReadToken( &token ) ) {
+				break;
+			}
 
-			// save it in the list to free when clearing this map
-			localModels.Append( lastModel );
-			continue;
-		}
+			if ( token == "model" ) {
+				lastModel = ParseModel( src );
 
-		if ( token == "shadowModel" ) {
-			lastModel = ParseShadowModel( src );
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
 
-			// add it to the model manager list
-			renderModelManager->AddModel( lastModel );
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				continue;
+			}
 
-			// save it in the list to free when clearing this map
-			localModels.Append( lastModel );
-			continue;
-		}
+			if ( token == "shadowModel" ) {
+				lastModel = ParseShadowModel( src );
 
-		if ( token == "interAreaPortals" ) {
-			ParseInterAreaPortals( src );
-			continue;
-		}
+				// add it to the model manager list
+				renderModelManager->AddModel( lastModel );
 
-		if ( token == "nodes" ) {
-			ParseNodes( src );
-			continue;
+				// save it in the list to free when clearing this map
+				localModels.Append( lastModel );
+				continue;
+			}
+
+			if ( token == "interAreaPortals" ) {
+				ParseInterAreaPortals( src );
+				continue;
+			}
+
+			if ( token == "nodes" ) {
+				ParseNodes( src );
+				continue;
+			}
+
+			src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
 		}
 
-		src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
+		delete src;
 	}
 
-	delete src;
-
 	// if it was a trivial map without any areas, create a single area
 	if ( !numPortalAreas ) {
 		ClearWorld();
@@ -590,6 +1052,8 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	AddWorldModelEntities();
 	ClearPortalStates();
 
+	interactionCache.Init( filename, mapCrc );
+
 	// done!
 	return true;
 }
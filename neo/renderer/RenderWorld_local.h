@@ -136,6 +136,7 @@ public:
 
 	idStr					mapName;				// ie: maps/tim_dm2.proc, written to demoFile
 	ID_TIME_T					mapTimeStamp;			// for fast reloads of the same level
+	unsigned int			mapCrc;					// of the .proc file, keys the interaction cache
 
 	areaNode_t *			areaNodes;
 	int						numAreaNodes;
@@ -170,6 +171,8 @@ public:
 
 	bool					generateAllInteractionsCalled;
 
+	idInteractionCache		interactionCache;		// interaction surfaces of static models saved from earlier runs
+
 	//-----------------------
 	// RenderWorld_load.cpp
 
@@ -178,6 +181,11 @@ public:
 	void					SetupAreaRefs();
 	void					ParseInterAreaPortals( idLexer *src );
 	void					ParseNodes( idLexer *src );
+	bool					ReadBinaryModel( idFile *f );
+	bool					ReadBinaryShadowModel( idFile *f );
+	bool					ReadBinaryInterAreaPortals( idFile *f );
+	bool					ReadBinaryNodes( idFile *f );
+	bool					LoadBinaryProc( const char *procFileName, int procLength, ID_TIME_T procTimeStamp );
 	int						CommonChildrenArea_r( areaNode_t *node );
 	void					FreeWorld();
 	void					ClearWorld();
@@ -32,11 +32,11 @@ If you have questions concerning this license or the applicable additional terms
 #include "tr_local.h"
 
 
-static const int	FRAME_MEMORY_BYTES = 0x200000;
+static const int	TEMP_RING_BYTES = 0x1000000;	// must be a power of two, holds the skinned vertexes of a frame
 static const int	EXPAND_HEADERS = 1024;
 
-idCVar idVertexCache::r_showVertexCache( "r_showVertexCache", "0", CVAR_INTEGER|CVAR_RENDERER, "" );
-idCVar idVertexCache::r_vertexBufferMegs( "r_vertexBufferMegs", "32", CVAR_INTEGER|CVAR_RENDERER, "" );
+idCVar idVertexCache::r_showVertexCache( "r_showVertexCache", "0", CVAR_INTEGER|CVAR_RENDERER, "1 = print frame statistics, 2 = also print buffer binds, 3 = draw frame temp statistics", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3> );
+idCVar idVertexCache::r_vertexBufferMegs( "r_vertexBufferMegs", "32", CVAR_INTEGER|CVAR_RENDERER, "size of the static vertex buffer pool, the index pool is a quarter of it, takes effect at vid_restart" );
 
 idVertexCache		vertexCache;
 
@@ -70,7 +70,16 @@ void idVertexCache::ActuallyFree( vertCache_t *block ) {
 		staticAllocTotal -= block->size;
 		staticCountTotal--;
 
-		if ( block->vbo ) {
+		if ( block->pool ) {
+			// leaves a hole for the next blocks that fit in it
+			block->pool->live -= block->size;
+			block->poolNext->poolPrev = block->poolPrev;
+			block->poolPrev->poolNext = block->poolNext;
+			block->poolNext = block->poolPrev = NULL;
+			block->pool = NULL;
+			// the vbo belongs to the pool
+			block->vbo = 0;
+		} else if ( block->vbo ) {
 #if 0		// this isn't really necessary, it will be reused soon enough
 			// filling with zero length data is the equivalent of freeing
 			qglBindBufferARB(GL_ARRAY_BUFFER_ARB, block->vbo);
@@ -120,7 +129,7 @@ void *idVertexCache::Position( vertCache_t *buffer ) {
 	// the ARB vertex object just uses an offset
 	if ( buffer->vbo ) {
 		if ( r_showVertexCache.GetInteger() == 2 ) {
-			if ( buffer->tag == TAG_TEMP ) {
+			if ( buffer->tag == TAG_TEMP || buffer->pool ) {
 				common->Printf( "GL_ARRAY_BUFFER_ARB = %i + %i (%i bytes)\n", buffer->vbo, buffer->offset, buffer->size ); 
 			} else {
 				common->Printf( "GL_ARRAY_BUFFER_ARB = %i (%i bytes)\n", buffer->vbo, buffer->size ); 
@@ -157,12 +166,32 @@ void idVertexCache::Init() {
 		r_vertexBufferMegs.SetInteger( 8 );
 	}
 
+	// R_InitOpenGL calls Init again after a vid_restart, the buffers went
+	// away with the old context, but the memory is still allocated
+	if ( tempRingMemory != NULL ) {
+		// let the owners of the blocks that weren't purged know they are gone
+		while( staticHeaders.next != &staticHeaders ) {
+			ActuallyFree( staticHeaders.next );
+		}
+		for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+			vertCache_t *list = &deferredFreeList[i];
+			while( list->next != list ) {
+				ActuallyFree( list->next );
+			}
+		}
+		FreeMemory( false );
+	}
+
 	virtualMemory = false;
 
-	// use ARB_vertex_buffer_object unless explicitly disabled
-	if( r_useVertexBuffers.GetInteger() && glConfig.ARBVertexBufferObjectAvailable ) {
+	// use ARB_vertex_buffer_object unless explicitly disabled, the buffers
+	// are filled by the front end, which has no GL context with r_smp
+	if( r_useVertexBuffers.GetInteger() && glConfig.ARBVertexBufferObjectAvailable && !r_smp.GetBool() ) {
 		common->Printf( "using ARB_vertex_buffer_object memory\n" );
 	} else {
+		if ( r_useVertexBuffers.GetInteger() && glConfig.ARBVertexBufferObjectAvailable ) {
+			common->Warning( "r_smp is set, ARB_vertex_buffer_object disabled" );
+		}
 		virtualMemory = true;
 		r_useIndexBuffers.SetBool( false );
 		common->Printf( "WARNING: vertex array range in virtual memory (SLOW)\n" );
@@ -171,25 +200,44 @@ void idVertexCache::Init() {
 	// initialize the cache memory blocks
 	freeStaticHeaders.next = freeStaticHeaders.prev = &freeStaticHeaders;
 	staticHeaders.next = staticHeaders.prev = &staticHeaders;
-	freeDynamicHeaders.next = freeDynamicHeaders.prev = &freeDynamicHeaders;
-	dynamicHeaders.next = dynamicHeaders.prev = &dynamicHeaders;
-	deferredFreeList.next = deferredFreeList.prev = &deferredFreeList;
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		deferredFreeList[i].next = deferredFreeList[i].prev = &deferredFreeList[i];
+		tempHeaderCount[i] = 0;
+		memset( (void *)tempHeaderChunks[i], 0, sizeof( tempHeaderChunks[i] ) );
+		frameStart[i] = 0;
+	}
 
-	// set up the dynamic frame memory
-	frameBytes = FRAME_MEMORY_BYTES;
 	staticAllocTotal = 0;
-
-	byte	*junk = (byte *)Mem_Alloc( frameBytes );
-	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
-		allocatingTempBuffer = true;	// force the alloc to use GL_STREAM_DRAW_ARB
-		Alloc( junk, frameBytes, &tempBuffers[i] );
-		allocatingTempBuffer = false;
-		tempBuffers[i]->tag = TAG_FIXED;
-		// unlink these from the static list, so they won't ever get purged
-		tempBuffers[i]->next->prev = tempBuffers[i]->prev;
-		tempBuffers[i]->prev->next = tempBuffers[i]->next;
+	staticCountTotal = 0;
+	dynamicFrame = 0;
+
+	// the static pools are only used with ARB_vertex_buffer_object
+	int poolSize = virtualMemory ? 0 : r_vertexBufferMegs.GetInteger() * 1024 * 1024;
+	InitPool( &vertexPool, poolSize, false );
+	InitPool( &indexPool, poolSize / 4, true );
+
+	// set up the frame temp ring, the vertex data is always written to memory,
+	// with ARB_vertex_buffer_object it is uploaded to the vbo before drawing
+	tempRingSize = TEMP_RING_BYTES;
+	tempRingHead = 0;
+	tempRingTail = 0;
+	tempRingUploaded = 0;
+	tempRingMemory = (byte *)Mem_Alloc16( tempRingSize );
+
+	tempRing = headerAllocator.Alloc();
+	memset( tempRing, 0, sizeof( *tempRing ) );
+	tempRing->size = tempRingSize;
+	tempRing->tag = TAG_FIXED;
+	// not on any list, so it won't ever get purged
+	tempRing->next = tempRing->prev = tempRing;
+	if ( virtualMemory ) {
+		tempRing->virtMem = tempRingMemory;
+	} else {
+		qglGenBuffersARB( 1, &tempRing->vbo );
+		qglBindBufferARB( GL_ARRAY_BUFFER_ARB, tempRing->vbo );
+		qglBufferDataARB( GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)tempRingSize, NULL, GL_STREAM_DRAW_ARB );
+		qglBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
 	}
-	Mem_Free( junk );
 
 	EndFrame();
 }
@@ -203,6 +251,8 @@ the cached data isn't valid
 ===========
 */
 void idVertexCache::PurgeAll() {
+	R_SyncRenderThread();
+
 	while( staticHeaders.next != &staticHeaders ) {
 		ActuallyFree( staticHeaders.next );
 	}
@@ -214,11 +264,142 @@ idVertexCache::Shutdown
 ===========
 */
 void idVertexCache::Shutdown() {
-//	PurgeAll();	// !@#: also purge the temp buffers
+	FreeMemory( true );
+}
+
+/*
+===========
+idVertexCache::FreeMemory
+
+Frees the headers, the temp ring and the pools.  The buffers are only
+deleted if the GL context they were created in still exists.
+===========
+*/
+void idVertexCache::FreeMemory( bool deleteBuffers ) {
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		for ( int j = 0 ; j < MAX_TEMP_HEADER_CHUNKS ; j++ ) {
+			Mem_Free( tempHeaderChunks[i][j] );
+			tempHeaderChunks[i][j] = NULL;
+		}
+		tempHeaderCount[i] = 0;
+	}
+
+	if ( deleteBuffers && tempRing != NULL && tempRing->vbo ) {
+		qglDeleteBuffersARB( 1, &tempRing->vbo );
+	}
+	Mem_Free16( tempRingMemory );
+	tempRingMemory = NULL;
+	tempRing = NULL;
+
+	ShutdownPool( &vertexPool, deleteBuffers );
+	ShutdownPool( &indexPool, deleteBuffers );
 
 	headerAllocator.Shutdown();
 }
 
+/*
+===========
+idVertexCache::InitPool
+===========
+*/
+void idVertexCache::InitPool( vertCachePool_t *pool, int size, bool indexBuffer ) {
+	memset( pool, 0, sizeof( *pool ) );
+	pool->blocks.poolNext = pool->blocks.poolPrev = &pool->blocks;
+
+	if ( size <= 0 ) {
+		return;
+	}
+
+	GLenum target = indexBuffer ? GL_ELEMENT_ARRAY_BUFFER_ARB : GL_ARRAY_BUFFER_ARB;
+
+	pool->size = size;
+	qglGenBuffersARB( 1, &pool->vbo );
+	qglBindBufferARB( target, pool->vbo );
+	qglBufferDataARB( target, (GLsizeiptrARB)size, NULL, GL_STATIC_DRAW_ARB );
+	qglBindBufferARB( target, 0 );
+}
+
+/*
+===========
+idVertexCache::ShutdownPool
+===========
+*/
+void idVertexCache::ShutdownPool( vertCachePool_t *pool, bool deleteBuffer ) {
+	if ( deleteBuffer && pool->vbo ) {
+		qglDeleteBuffersARB( 1, &pool->vbo );
+	}
+	memset( pool, 0, sizeof( *pool ) );
+	pool->blocks.poolNext = pool->blocks.poolPrev = &pool->blocks;
+}
+
+/*
+===========
+R_PoolEnd
+
+The end of the last block in the pool
+===========
+*/
+static int R_PoolEnd( const vertCachePool_t *pool ) {
+	const vertCache_t *last = pool->blocks.poolPrev;
+
+	if ( last == &pool->blocks ) {
+		return 0;
+	}
+	return last->offset + last->size;
+}
+
+/*
+===========
+idVertexCache::AllocPool
+
+Links the block into the first hole in the pool that is large enough,
+or after the last block.  Returns false if it doesn't fit anywhere.
+The holes are only reused after the deferred free, so the GPU is
+done with the blocks that were in them.
+===========
+*/
+bool idVertexCache::AllocPool( vertCachePool_t *pool, vertCache_t *block, int bytes ) {
+	vertCache_t	*next;
+	int			offset;
+	int			end;
+
+	// large blocks get their own vbo so they don't crowd out everything else
+	if ( bytes > pool->size / 8 || pool->live + bytes > pool->size ) {
+		return false;
+	}
+
+	end = R_PoolEnd( pool );
+	if ( end - pool->live < bytes ) {
+		// all the holes together are too small, which is always
+		// the case while a level is loaded
+		next = &pool->blocks;
+		offset = end;
+	} else {
+		offset = 0;
+		for ( next = pool->blocks.poolNext; next != &pool->blocks; next = next->poolNext ) {
+			if ( next->offset - offset >= bytes ) {
+				break;
+			}
+			offset = next->offset + next->size;
+		}
+	}
+	if ( offset + bytes > pool->size ) {
+		return false;
+	}
+
+	block->pool = pool;
+	block->offset = offset;
+	block->size = bytes;
+	block->poolNext = next;
+	block->poolPrev = next->poolPrev;
+	block->poolNext->poolPrev = block;
+	block->poolPrev->poolNext = block;
+
+	pool->live += bytes;
+
+	return true;
+}
+
 /*
 ===========
 idVertexCache::Alloc
@@ -244,9 +425,11 @@ void idVertexCache::Alloc( void *data, int size, vertCache_t **buffer, bool inde
 			block->next->prev = block;
 			block->prev->next = block;
 
-			if( !virtualMemory ) {
-				qglGenBuffersARB( 1, & block->vbo );
-			}
+			// the vbo is generated when the block doesn't fit in a pool
+			block->vbo = 0;
+			block->virtMem = NULL;
+			block->pool = NULL;
+			block->poolNext = block->poolPrev = NULL;
 		}
 	}
 
@@ -281,17 +464,32 @@ void idVertexCache::Alloc( void *data, int size, vertCache_t **buffer, bool inde
 	block->indexBuffer = indexBuffer;
 
 	// copy the data
-	if ( block->vbo ) {
+	if ( !virtualMemory ) {
+		vertCachePool_t *pool = indexBuffer ? &indexPool : &vertexPool;
+		int poolBytes = ( size + 15 ) & ~15;
+		if ( AllocPool( pool, block, poolBytes ) ) {
+			// the header doesn't need a vbo of its own any more
+			if ( block->vbo ) {
+				qglDeleteBuffersARB( 1, &block->vbo );
+			}
+			block->vbo = pool->vbo;
+
+			staticAllocTotal += poolBytes - size;
+
+			GLenum target = indexBuffer ? GL_ELEMENT_ARRAY_BUFFER_ARB : GL_ARRAY_BUFFER_ARB;
+			qglBindBufferARB( target, pool->vbo );
+			qglBufferSubDataARB( target, block->offset, (GLsizeiptrARB)size, data );
+			return;
+		}
+		if ( !block->vbo ) {
+			qglGenBuffersARB( 1, &block->vbo );
+		}
 		if ( indexBuffer ) {
 			qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, block->vbo );
 			qglBufferDataARB( GL_ELEMENT_ARRAY_BUFFER_ARB, (GLsizeiptrARB)size, data, GL_STATIC_DRAW_ARB );
 		} else {
 			qglBindBufferARB( GL_ARRAY_BUFFER_ARB, block->vbo );
-			if ( allocatingTempBuffer ) {
-				qglBufferDataARB( GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)size, data, GL_STREAM_DRAW_ARB );
-			} else {
-				qglBufferDataARB( GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)size, data, GL_STATIC_DRAW_ARB );
-			}
+			qglBufferDataARB( GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)size, data, GL_STATIC_DRAW_ARB );
 		}
 	} else {
 		block->virtMem = Mem_Alloc( size );
@@ -313,7 +511,8 @@ void idVertexCache::Touch( vertCache_t *block ) {
 		common->FatalError( "idVertexCache Touch: freed pointer" );
 	}
 	if ( block->tag == TAG_TEMP ) {
-		common->FatalError( "idVertexCache Touch: temporary pointer" );
+		// AllocDynamic blocks are only used in the frame they were allocated in
+		return;
 	}
 
 	block->frameUsed = currentFrame;
@@ -342,7 +541,8 @@ void idVertexCache::Free( vertCache_t *block ) {
 		common->FatalError( "idVertexCache Free: freed pointer" );
 	}
 	if ( block->tag == TAG_TEMP ) {
-		common->FatalError( "idVertexCache Free: temporary pointer" );
+		// AllocDynamic blocks are released with their frame
+		return;
 	}
 
 	// this block still can't be purged until the frame count has expired,
@@ -352,10 +552,132 @@ void idVertexCache::Free( vertCache_t *block ) {
 	block->next->prev = block->prev;
 	block->prev->next = block->next;
 
-	block->next = deferredFreeList.next;
-	block->prev = &deferredFreeList;
-	deferredFreeList.next->prev = block;
-	deferredFreeList.next = block;
+	vertCache_t *list = &deferredFreeList[listNum];
+	block->next = list->next;
+	block->prev = list;
+	list->next->prev = block;
+	list->next = block;
+}
+
+/*
+===========
+idVertexCache::AllocTempRing
+
+Returns the offset of the block in the ring, or -1 if the
+ring is full. Can be called from any thread.
+===========
+*/
+int idVertexCache::AllocTempRing( int bytes ) {
+	int	head;
+	int	newHead;
+	int	offset;
+
+	// keep the blocks 16 byte aligned for the SIMD copies
+	bytes = ( bytes + 15 ) & ~15;
+
+	do {
+		head = tempRingHead;
+		offset = head & ( tempRingSize - 1 );
+		newHead = head + bytes;
+		if ( offset + bytes > tempRingSize ) {
+			// skip the end of the ring so the block is contiguous
+			newHead += tempRingSize - offset;
+			offset = 0;
+		}
+		if ( (unsigned int)( newHead - tempRingTail ) > (unsigned int)tempRingSize ) {
+			return -1;
+		}
+	} while ( Sys_InterlockedCompareExchange( tempRingHead, head, newHead ) != head );
+
+	return offset;
+}
+
+/*
+===========
+idVertexCache::AllocTempHeader
+
+Temp headers are never linked, they are handed out in order from
+chunks that stay allocated until shutdown. The heap isn't thread
+safe, so only the main thread adds chunks, EndFrame allocates one
+ahead so the job threads rarely run out.
+===========
+*/
+vertCache_t *idVertexCache::AllocTempHeader() {
+	int	index;
+	int	chunk;
+
+	index = Sys_InterlockedIncrement( tempHeaderCount[listNum] ) - 1;
+	chunk = index / TEMP_HEADER_CHUNK_SIZE;
+	if ( chunk >= MAX_TEMP_HEADER_CHUNKS ) {
+		return NULL;
+	}
+	if ( tempHeaderChunks[listNum][chunk] == NULL ) {
+		if ( jobManager->GetThreadIndex() != 0 ) {
+			return NULL;
+		}
+		Sys_InterlockedExchangePointer( tempHeaderChunks[listNum][chunk], Mem_Alloc( TEMP_HEADER_CHUNK_SIZE * sizeof( vertCache_t ) ) );
+	}
+	return (vertCache_t *)tempHeaderChunks[listNum][chunk] + ( index % TEMP_HEADER_CHUNK_SIZE );
+}
+
+/*
+===========
+idVertexCache::AllocTemp
+
+Copies the data into the frame temp ring.  Returns NULL if the ring is full.
+
+With r_smp the main thread waits for the back end to finish the
+previous frame before giving up on the ring.  The job threads can't
+wait, so they get NULL right away.
+===========
+*/
+vertCache_t *idVertexCache::AllocTemp( void *data, int size ) {
+	vertCache_t	*block;
+	int			offset;
+
+	offset = AllocTempRing( size );
+	if ( offset < 0 && jobManager->GetThreadIndex() == 0 && R_RenderThreadActive() ) {
+		double start = Sys_GetClockTicks();
+
+		// once the back end is done with the previous frame,
+		// only the current frame is still using the ring
+		R_WaitForRenderThread();
+		tempRingTail = frameStart[listNum];
+
+		stallCountThisFrame++;
+		stallTimeThisFrame += ( Sys_GetClockTicks() - start ) * 1000.0 / Sys_ClockTicksPerSecond();
+
+		offset = AllocTempRing( size );
+	}
+
+	block = NULL;
+	if ( offset >= 0 ) {
+		block = AllocTempHeader();
+	}
+
+	if ( !block ) {
+		Sys_InterlockedIncrement( overflowCountThisFrame );
+		return NULL;
+	}
+
+	block->next = block->prev = NULL;
+	block->size = size;
+	block->tag = TAG_TEMP;
+	block->indexBuffer = false;
+	block->offset = offset;
+	block->user = NULL;
+	block->frameUsed = 0;
+	block->virtMem = tempRing->virtMem;
+	block->vbo = tempRing->vbo;
+	block->pool = NULL;
+
+	Sys_InterlockedAdd( dynamicAllocThisFrame, size );
+	Sys_InterlockedIncrement( dynamicCountThisFrame );
+
+	// copy the data, UploadFrameTemp sends it to the vbo
+	SIMDProcessor->Memcpy( tempRingMemory + offset, data, size );
+
+	return block;
 }
 
 /*
@@ -365,6 +687,9 @@ idVertexCache::AllocFrameTemp
 A frame temp allocation must never be allowed to fail due to overflow.
 We can't simply sync with the GPU and overwrite what we have, because
 there may still be future references to dynamically created surfaces.
+
+The job threads can't make static allocations, so they get NULL when
+the ring is full and have to skip the surface.
 ===========
 */
 vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
@@ -374,59 +699,112 @@ vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
 		common->Error( "idVertexCache::AllocFrameTemp: size = %i\n", size );
 	}
 
-	if ( dynamicAllocThisFrame + size > frameBytes ) {
-		// if we don't have enough room in the temp block, allocate a static block,
-		// but immediately free it so it will get freed at the next frame
-		tempOverflow = true;
-		Alloc( data, size, &block );
-		Free( block);
+	block = AllocTemp( data, size );
+	if ( block ) {
 		return block;
 	}
 
-	// this data is just going on the shared dynamic list
+	if ( jobManager->GetThreadIndex() != 0 ) {
+		return NULL;
+	}
 
-	// if we don't have any remaining unused headers, allocate some more
-	if ( freeDynamicHeaders.next == &freeDynamicHeaders ) {
+	// if we don't have enough room in the temp ring, allocate a static block,
+	// but immediately free it so it will get freed at the next frame
+	tempOverflow = true;
+	Alloc( data, size, &block );
+	Free( block);
+	return block;
+}
 
-		for ( int i = 0; i < EXPAND_HEADERS; i++ ) {
-			block = headerAllocator.Alloc();
-			block->next = freeDynamicHeaders.next;
-			block->prev = &freeDynamicHeaders;
-			block->next->prev = block;
-			block->prev->next = block;
-		}
+/*
+===========
+idVertexCache::AllocDynamic
+
+The temp headers are handed out again in later frames, so the block
+remembers its owner and frame for CacheIsCurrent.
+===========
+*/
+void idVertexCache::AllocDynamic( void *data, int size, vertCache_t **buffer ) {
+	vertCache_t	*block;
+
+	if ( size <= 0 ) {
+		common->Error( "idVertexCache::AllocDynamic: size = %i\n", size );
 	}
 
-	// move it from the freeDynamicHeaders list to the dynamicHeaders list
-	block = freeDynamicHeaders.next;
-	block->next->prev = block->prev;
-	block->prev->next = block->next;
-	block->next = dynamicHeaders.next;
-	block->prev = &dynamicHeaders;
-	block->next->prev = block;
-	block->prev->next = block;
+	block = AllocTemp( data, size );
+	if ( !block ) {
+		// the owner frees the static block when the data changes,
+		// or it is purged like any other
+		tempOverflow = true;
+		Alloc( data, size, buffer );
+		return;
+	}
 
-	block->size = size;
-	block->tag = TAG_TEMP;
-	block->indexBuffer = false;
-	block->offset = dynamicAllocThisFrame;
-	dynamicAllocThisFrame += block->size;
-	dynamicCountThisFrame++;
-	block->user = NULL;
-	block->frameUsed = 0;
+	block->user = buffer;
+	block->frameUsed = dynamicFrame;
+	*buffer = block;
+}
 
-	// copy the data
-	block->virtMem = tempBuffers[listNum]->virtMem;
-	block->vbo = tempBuffers[listNum]->vbo;
+/*
+===========
+idVertexCache::CacheIsCurrent
+===========
+*/
+bool idVertexCache::CacheIsCurrent( vertCache_t **buffer ) const {
+	const vertCache_t *block = *buffer;
 
-	if ( block->vbo ) {
-		qglBindBufferARB( GL_ARRAY_BUFFER_ARB, block->vbo );
-		qglBufferSubDataARB( GL_ARRAY_BUFFER_ARB, block->offset, (GLsizeiptrARB)size, data );
+	if ( block == NULL ) {
+		return false;
+	}
+	if ( block->tag != TAG_TEMP ) {
+		// static blocks stay valid until they are freed or purged
+		return true;
+	}
+	// the header may have been handed out again for another allocation
+	return ( block->user == buffer && block->frameUsed == dynamicFrame );
+}
+
+/*
+===========
+idVertexCache::UploadFrameTemp
+
+Without persistent buffer mapping the front end threads can't write to the
+vbo directly, so everything added to the ring since the last upload is sent
+in at most two pieces.
+===========
+*/
+void idVertexCache::UploadFrameTemp() {
+	int	head;
+	int	start;
+	int	end;
+
+	if ( virtualMemory ) {
+		return;
+	}
+
+	head = tempRingHead;
+	if ( head == tempRingUploaded ) {
+		return;
+	}
+
+	qglBindBufferARB( GL_ARRAY_BUFFER_ARB, tempRing->vbo );
+
+	start = tempRingUploaded & ( tempRingSize - 1 );
+	end = head & ( tempRingSize - 1 );
+	if ( head - tempRingUploaded >= tempRingSize ) {
+		qglBufferSubDataARB( GL_ARRAY_BUFFER_ARB, 0, (GLsizeiptrARB)tempRingSize, tempRingMemory );
+	} else if ( start < end ) {
+		qglBufferSubDataARB( GL_ARRAY_BUFFER_ARB, start, (GLsizeiptrARB)( end - start ), tempRingMemory + start );
 	} else {
-		SIMDProcessor->Memcpy( (byte *)block->virtMem + block->offset, data, size );
+		qglBufferSubDataARB( GL_ARRAY_BUFFER_ARB, start, (GLsizeiptrARB)( tempRingSize - start ), tempRingMemory + start );
+		if ( end > 0 ) {
+			qglBufferSubDataARB( GL_ARRAY_BUFFER_ARB, 0, (GLsizeiptrARB)end, tempRingMemory );
+		}
 	}
 
-	return block;
+	qglBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
+
+	tempRingUploaded = head;
 }
 
 /*
@@ -436,7 +814,7 @@ idVertexCache::EndFrame
 */
 void idVertexCache::EndFrame() {
 	// display debug information
-	if ( r_showVertexCache.GetBool() ) {
+	if ( r_showVertexCache.GetInteger() == 1 || r_showVertexCache.GetInteger() == 2 ) {
 		int	staticUseCount = 0;
 		int staticUseSize = 0;
 
@@ -449,13 +827,20 @@ void idVertexCache::EndFrame() {
 
 		const char *frameOverflow = tempOverflow ? "(OVERFLOW)" : "";
 
-		common->Printf( "vertex dynamic:%i=%ik%s, static alloc:%i=%ik used:%i=%ik total:%i=%ik\n",
+		common->Printf( "vertex dynamic:%i=%ik%s, static alloc:%i=%ik used:%i=%ik total:%i=%ik stalls:%i=%1.2fms\n",
 			dynamicCountThisFrame, dynamicAllocThisFrame/1024, frameOverflow,
 			staticCountThisFrame, staticAllocThisFrame/1024,
 			staticUseCount, staticUseSize/1024,
-			staticCountTotal, staticAllocTotal/1024 );
+			staticCountTotal, staticAllocTotal/1024,
+			stallCountThisFrame, stallTimeThisFrame );
 	}
 
+	lastDynamicAlloc = dynamicAllocThisFrame;
+	lastDynamicCount = dynamicCountThisFrame;
+	lastStallCount = stallCountThisFrame;
+	lastStallTime = stallTimeThisFrame;
+	lastOverflowCount = overflowCountThisFrame;
+
 #if 0
 	// if our total static count is above our working memory limit, start purging things
 	while ( staticAllocTotal > r_vertexBufferMegs.GetInteger() * 1024 * 1024 ) {
@@ -473,28 +858,55 @@ void idVertexCache::EndFrame() {
 
 
 	currentFrame = tr.frameCount;
-	listNum = currentFrame % NUM_VERTEX_FRAMES;
+	dynamicFrame++;
+	listNum = ( listNum + 1 ) % NUM_VERTEX_FRAMES;
 	staticAllocThisFrame = 0;
 	staticCountThisFrame = 0;
 	dynamicAllocThisFrame = 0;
 	dynamicCountThisFrame = 0;
+	stallCountThisFrame = 0;
+	stallTimeThisFrame = 0.0;
+	overflowCountThisFrame = 0;
 	tempOverflow = false;
 
-	// free all the deferred free headers
-	while( deferredFreeList.next != &deferredFreeList ) {
-		ActuallyFree( deferredFreeList.next );
+	frameStart[listNum] = tempRingHead;
+
+	// the back end thread has finished the frame that last used this list,
+	// but may still be drawing the one that was just issued
+	if ( R_RenderThreadActive() ) {
+		ReleaseFrameBlocks( listNum );
+		tempRingTail = frameStart[( listNum + NUM_VERTEX_FRAMES - 1 ) % NUM_VERTEX_FRAMES];
+	} else {
+		for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+			ReleaseFrameBlocks( i );
+		}
+		tempRingTail = tempRingHead;
 	}
+}
 
-	// free all the frame temp headers
-	vertCache_t	*block = dynamicHeaders.next;
-	if ( block != &dynamicHeaders ) {
-		block->prev = &freeDynamicHeaders;
-		dynamicHeaders.prev->next = freeDynamicHeaders.next;
-		freeDynamicHeaders.next->prev = dynamicHeaders.prev;
-		freeDynamicHeaders.next = block;
+/*
+===========
+idVertexCache::ReleaseFrameBlocks
+===========
+*/
+void idVertexCache::ReleaseFrameBlocks( int frameList ) {
+	// free all the deferred free headers
+	vertCache_t *list = &deferredFreeList[frameList];
+	while( list->next != list ) {
+		ActuallyFree( list->next );
+	}
 
-		dynamicHeaders.next = dynamicHeaders.prev = &dynamicHeaders;
+	// make sure there is a chunk more than the last frame used, so
+	// the job threads won't have to skip surfaces for lack of headers
+	int numChunks = Min( tempHeaderCount[frameList] / TEMP_HEADER_CHUNK_SIZE + 2, MAX_TEMP_HEADER_CHUNKS );
+	for ( int i = 0 ; i < numChunks ; i++ ) {
+		if ( tempHeaderChunks[frameList][i] == NULL ) {
+			tempHeaderChunks[frameList][i] = Mem_Alloc( TEMP_HEADER_CHUNK_SIZE * sizeof( vertCache_t ) );
+		}
 	}
+
+	// free all the frame temp headers
+	tempHeaderCount[frameList] = 0;
 }
 
 /*
@@ -524,16 +936,24 @@ void idVertexCache::List( void ) {
 		numFreeStaticHeaders++;
 	}
 
-	int	numFreeDynamicHeaders = 0;
-	for ( block = freeDynamicHeaders.next ; block != &freeDynamicHeaders ; block = block->next ) {
-		numFreeDynamicHeaders++;
+	int	numTempHeaders = 0;
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		for ( int j = 0 ; j < MAX_TEMP_HEADER_CHUNKS ; j++ ) {
+			if ( tempHeaderChunks[i][j] ) {
+				numTempHeaders += TEMP_HEADER_CHUNK_SIZE;
+			}
+		}
 	}
 
 	common->Printf( "%i megs working set\n", r_vertexBufferMegs.GetInteger() );
-	common->Printf( "%i dynamic temp buffers of %ik\n", NUM_VERTEX_FRAMES, frameBytes / 1024 );
+	common->Printf( "%ik dynamic temp ring, %ik in use\n", tempRingSize / 1024, ( tempRingHead - tempRingTail ) / 1024 );
 	common->Printf( "%5i active static headers\n", numActive );
 	common->Printf( "%5i free static headers\n", numFreeStaticHeaders );
-	common->Printf( "%5i free dynamic headers\n", numFreeDynamicHeaders );
+	common->Printf( "%5i allocated temp headers\n", numTempHeaders );
+	common->Printf( "%ik / %ik static vertex pool, %ik in holes\n",
+		vertexPool.live / 1024, vertexPool.size / 1024, ( R_PoolEnd( &vertexPool ) - vertexPool.live ) / 1024 );
+	common->Printf( "%ik / %ik static index pool, %ik in holes\n",
+		indexPool.live / 1024, indexPool.size / 1024, ( R_PoolEnd( &indexPool ) - indexPool.live ) / 1024 );
 
 	if ( !virtualMemory  ) {
 		common->Printf( "Vertex cache is in ARB_vertex_buffer_object memory (FAST).\n");
@@ -548,6 +968,32 @@ void idVertexCache::List( void ) {
 	}
 }
 
+/*
+=============
+idVertexCache::DrawStats
+=============
+*/
+void idVertexCache::DrawStats() {
+	const idMaterial	*material;
+	int					x, y;
+
+	if ( r_showVertexCache.GetInteger() != 3 ) {
+		return;
+	}
+
+	material = declManager->FindMaterial( "textures/bigchars" );
+	x = 8;
+	y = 64;
+
+	tr.DrawSmallStringExt( x, y, va( "temp:  %ik in %i allocs", lastDynamicAlloc / 1024, lastDynamicCount ), colorWhite, true, material );
+	y += SMALLCHAR_HEIGHT;
+	tr.DrawSmallStringExt( x, y, va( "ring:  %ik / %ik", ( tempRingHead - tempRingTail ) / 1024, tempRingSize / 1024 ), colorWhite, true, material );
+	y += SMALLCHAR_HEIGHT;
+	tr.DrawSmallStringExt( x, y, va( "stall: %i = %1.2f msec", lastStallCount, lastStallTime ), lastStallCount ? colorYellow : colorWhite, true, material );
+	y += SMALLCHAR_HEIGHT;
+	tr.DrawSmallStringExt( x, y, va( "overflow: %i", lastOverflowCount ), lastOverflowCount ? colorRed : colorWhite, true, material );
+}
+
 /*
 =============
 idVertexCache::IsFast
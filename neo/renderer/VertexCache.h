@@ -30,6 +30,9 @@ If you have questions concerning this license or the applicable additional terms
 
 const int NUM_VERTEX_FRAMES = 2;
 
+const int TEMP_HEADER_CHUNK_SIZE = 1024;
+const int MAX_TEMP_HEADER_CHUNKS = 64;
+
 typedef enum {
 	TAG_FREE,
 	TAG_USED,
@@ -37,10 +40,14 @@ typedef enum {
 	TAG_TEMP		// in frame temp area, not static area
 } vertBlockTag_t;
 
+struct vertCachePool_s;
+
 typedef struct vertCache_s {
 	GLuint			vbo;
 	void			*virtMem;			// only one of vbo / virtMem will be set
 	bool			indexBuffer;		// holds indexes instead of vertexes
+	struct vertCachePool_s *	pool;		// suballocated from a shared static vbo
+	struct vertCache_s *poolNext, *poolPrev;	// blocks in the pool in offset order
 
 	int				offset;
 	int				size;				// may be larger than the amount asked for, due
@@ -51,6 +58,19 @@ typedef struct vertCache_s {
 	int				frameUsed;			// it can't be purged if near the current frame
 } vertCache_t;
 
+// Static allocations are suballocated from one vbo for the vertexes and one
+// for the indexes, so drawing doesn't bind a new buffer for every surface.
+// The blocks are kept in offset order and a new block goes into the first
+// hole left by freed blocks that is large enough.  Blocks never move, so
+// the pool is never uploaded again and never waits for the back end.
+// Data that changes between frames goes in the frame temp ring instead.
+typedef struct vertCachePool_s {
+	GLuint			vbo;
+	int				size;
+	int				live;				// bytes in blocks that haven't been freed
+	vertCache_t		blocks;				// head of doubly linked list in offset order
+} vertCachePool_t;
+
 
 class idVertexCache {
 public:
@@ -84,15 +104,34 @@ public:
 	// will change every frame.
 	// will return NULL if the vertex cache is completely full
 	// As with Position(), this may not actually be a pointer you can access.
+	// The data is copied into a ring buffer without locking, so this can be
+	// called from the job threads. Only the main thread can fall back to
+	// a static allocation when the ring is full.
 	vertCache_t	*	AllocFrameTemp( void *data, int bytes );
 
+	// For data that is kept between frames but changes often, like skinned
+	// vertexes and their shadow caches.  The data is copied into the frame
+	// temp ring, so *buffer is only valid for the current frame and has to
+	// be allocated again when CacheIsCurrent returns false.  Falls back to
+	// a static allocation if the ring is full.  Main thread only.
+	void			AllocDynamic( void *data, int bytes, vertCache_t **buffer );
+
+	// false if *buffer is NULL, was purged, or was allocated by
+	// AllocDynamic in an earlier frame
+	bool			CacheIsCurrent( vertCache_t **buffer ) const;
+
+	// uploads the frame temp data written since the last upload, must be
+	// called on the thread owning the GL context before drawing
+	void			UploadFrameTemp();
+
 	// notes that a buffer is used this frame, so it can't be purged
-	// out from under the GPU
+	// out from under the GPU, does nothing for frame temp blocks
 	void			Touch( vertCache_t *buffer );
 
 	// this block won't have to zero a buffer pointer when it is purged,
 	// but it must still wait for the frames to pass, in case the GPU
 	// is still referencing it
+	// frame temp blocks are released with their frame, so they are ignored
 	void			Free( vertCache_t *buffer );	
 
 	// updates the counter for determining which temp space to use
@@ -103,9 +142,20 @@ public:
 	// listVertexCache calls this
 	void			List();
 
+	// draws the frame temp statistics of the previous frame with r_showVertexCache 3
+	void			DrawStats();
+
 private:
 	void			InitMemoryBlocks( int size );
+	void			FreeMemory( bool deleteBuffers );
+	void			InitPool( vertCachePool_t *pool, int size, bool indexBuffer );
+	void			ShutdownPool( vertCachePool_t *pool, bool deleteBuffer );
+	bool			AllocPool( vertCachePool_t *pool, vertCache_t *block, int bytes );
 	void			ActuallyFree( vertCache_t *block );
+	void			ReleaseFrameBlocks( int frameList );
+	vertCache_t *	AllocTempHeader();
+	int				AllocTempRing( int bytes );
+	vertCache_t *	AllocTemp( void *data, int bytes );
 
 	static idCVar	r_showVertexCache;
 	static idCVar	r_vertexBufferMegs;
@@ -115,29 +165,51 @@ private:
 
 	int				staticAllocThisFrame;	// debug counter
 	int				staticCountThisFrame;
-	int				dynamicAllocThisFrame;
-	int				dynamicCountThisFrame;
+	volatile int	dynamicAllocThisFrame;
+	volatile int	dynamicCountThisFrame;
+	int				stallCountThisFrame;	// waits for the back end to free ring space
+	double			stallTimeThisFrame;		// milliseconds
+	volatile int	overflowCountThisFrame;	// temp allocations that didn't fit in the ring
+
+	int				lastDynamicAlloc;		// statistics of the previous frame for the overlay
+	int				lastDynamicCount;
+	int				lastStallCount;
+	double			lastStallTime;
+	int				lastOverflowCount;
 
 	int				currentFrame;			// for purgable block tracking
-	int				listNum;				// currentFrame % NUM_VERTEX_FRAMES, determines which tempBuffers to use
+	int				dynamicFrame;			// counts EndFrame calls, AllocDynamic blocks are only valid in their frame
+	int				listNum;				// alternates each EndFrame, determines which tempBuffers to use
 
 	bool			virtualMemory;			// not fast stuff
 
-	bool			allocatingTempBuffer;	// force GL_STREAM_DRAW_ARB
-
-	vertCache_t		*tempBuffers[NUM_VERTEX_FRAMES];		// allocated at startup
+	// All frame temp data goes into a single ring. The head is advanced with
+	// an interlocked compare exchange, the tail is the start of the oldest frame
+	// the back end may still be drawing. Both count bytes and only wrap around
+	// at 4GB, the position in the ring is the count modulo the ring size.
+	vertCache_t *	tempRing;				// allocated at startup
+	byte *			tempRingMemory;			// virtual memory of the ring or the copy uploaded to the vbo
+	int				tempRingSize;			// power of two
+	volatile int	tempRingHead;
+	volatile int	tempRingTail;
+	int				tempRingUploaded;		// head at the last upload to the vbo
+	int				frameStart[NUM_VERTEX_FRAMES];			// ring head at the start of the frame using the list
 	bool			tempOverflow;			// had to alloc a temp in static memory
 
+	vertCachePool_t	vertexPool;				// static vertexes with ARB_vertex_buffer_object
+	vertCachePool_t	indexPool;				// static indexes with ARB_vertex_buffer_object
+
 	idBlockAlloc<vertCache_t,1024>	headerAllocator;
 
 	vertCache_t		freeStaticHeaders;		// head of doubly linked list
-	vertCache_t		freeDynamicHeaders;		// head of doubly linked list
-	vertCache_t		dynamicHeaders;			// head of doubly linked list
-	vertCache_t		deferredFreeList;		// head of doubly linked list
+	// the r_smp back end thread can still be drawing the previous frame, so the
+	// temp headers and deferred frees are kept apart for each listNum
+	// temp headers are handed out with an interlocked increment from chunks that are never freed
+	volatile int	tempHeaderCount[NUM_VERTEX_FRAMES];
+	void * volatile	tempHeaderChunks[NUM_VERTEX_FRAMES][MAX_TEMP_HEADER_CHUNKS];
+	vertCache_t		deferredFreeList[NUM_VERTEX_FRAMES];	// head of doubly linked list
 	vertCache_t		staticHeaders;			// head of doubly linked list in MRU order,
 											// staticHeaders.next is most recently used
-
-	int				frameBytes;				// for each of NUM_VERTEX_FRAMES frames
 };
 
 extern	idVertexCache	vertexCache;
@@ -811,15 +811,18 @@ void RB_EXP_RenderOccluders( viewLight_t *vLight ) {
 
 			// render it
 			const srfTriangles_t *tri = surfInt->ambientTris;
+			if ( surfInt->shader ) {
+				surfInt->shader->GetEditorImage()->Bind();
+			}
+			// the back end can't allocate vertex cache while the front end builds the
+			// next frame with r_smp, occluders the front end didn't cache are drawn immediate
 			if ( !tri->ambientCache ) {
-				R_CreateAmbientCache( const_cast<srfTriangles_t *>(tri), false ); 
+				RB_DrawElementsImmediate( tri );
+				continue;
 			}
 			idDrawVert *ac = (idDrawVert *)vertexCache.Position( tri->ambientCache );
 			qglVertexPointer( 3, GL_FLOAT, sizeof( idDrawVert ), ac->xyz.ToFloatPtr() );
-	qglTexCoordPointer( 2, GL_FLOAT, sizeof( idDrawVert ), ac->st.ToFloatPtr() );
-	if ( surfInt->shader ) {
-		surfInt->shader->GetEditorImage()->Bind();
-	}
+			qglTexCoordPointer( 2, GL_FLOAT, sizeof( idDrawVert ), ac->st.ToFloatPtr() );
 			RB_DrawElementsWithCounters( tri );
 		}
 	}
@@ -1563,14 +1566,30 @@ const srfTriangles_t	*RB_Exp_TrianglesForFrustum( viewLight_t *vLight, int side
 			verts[4].xyz[1] -= size;
 			break;
 		}
-
-		frustumTri.ambientCache = vertexCache.AllocFrameTemp( verts, sizeof( verts ) );
 	}
 
 	return tri;
 }
 
 
+/*
+==================
+RB_Exp_DrawFrustum
+
+The back end can't allocate vertex cache while the front end builds the
+next frame with r_smp. The side frustums are built by the back end and the
+light frustum only has vertex cache when the front end created it for a
+fog light, so without vertex cache they are drawn immediate.
+==================
+*/
+static void RB_Exp_DrawFrustum( const srfTriangles_t *tri ) {
+	if ( tri->ambientCache ) {
+		RB_DrawElementsWithCounters( tri );
+	} else {
+		RB_DrawElementsImmediate( tri );
+	}
+}
+
 /*
 ==================
 RB_Exp_SelectFrustum
@@ -1581,8 +1600,10 @@ void	RB_Exp_SelectFrustum( viewLight_t *vLight, int side ) {
 
 	const srfTriangles_t *tri = RB_Exp_TrianglesForFrustum( vLight, side );
 
-	idDrawVert *ac = (idDrawVert *)vertexCache.Position( tri->ambientCache );
-	qglVertexPointer( 3, GL_FLOAT, sizeof( idDrawVert ), ac->xyz.ToFloatPtr() );
+	if ( tri->ambientCache ) {
+		idDrawVert *ac = (idDrawVert *)vertexCache.Position( tri->ambientCache );
+		qglVertexPointer( 3, GL_FLOAT, sizeof( idDrawVert ), ac->xyz.ToFloatPtr() );
+	}
 
 	qglDisable( GL_TEXTURE_2D );
 	qglDisableClientState( GL_TEXTURE_COORD_ARRAY );
@@ -1599,7 +1620,7 @@ void	RB_Exp_SelectFrustum( viewLight_t *vLight, int side ) {
 	qglStencilOp( GL_KEEP, GL_INCR, GL_KEEP );
 	GL_Cull( CT_FRONT_SIDED );
 
-	RB_DrawElementsWithCounters( tri );
+	RB_Exp_DrawFrustum( tri );
 	
 	// draw back faces of the light frustum with 
 	// depth test greater
@@ -1786,7 +1807,7 @@ PARAM	jitterTexOffset				= program.local[9];
 
 
 
-	RB_DrawElementsWithCounters( tri );
+	RB_Exp_DrawFrustum( tri );
 
 	qglDisable(GL_VERTEX_PROGRAM_ARB);
 	qglDisable(GL_FRAGMENT_PROGRAM_ARB);
@@ -1994,8 +2015,10 @@ void	RB_shadowResampleAlpha( void ) {
 	// this uses the full light, not side frustums
 	const srfTriangles_t *tri = backEnd.vLight->frustumTris;
 
-	idDrawVert *ac = (idDrawVert *)vertexCache.Position( tri->ambientCache );
-	qglVertexPointer( 3, GL_FLOAT, sizeof( idDrawVert ), ac->xyz.ToFloatPtr() );
+	if ( tri->ambientCache ) {
+		idDrawVert *ac = (idDrawVert *)vertexCache.Position( tri->ambientCache );
+		qglVertexPointer( 3, GL_FLOAT, sizeof( idDrawVert ), ac->xyz.ToFloatPtr() );
+	}
 
 	// clear stencil buffer
 	qglEnable( GL_SCISSOR_TEST );
@@ -2012,7 +2035,7 @@ void	RB_shadowResampleAlpha( void ) {
 
 	// set fragment / vertex program?
 
-	RB_DrawElementsWithCounters( tri );
+	RB_Exp_DrawFrustum( tri );
 	
 	// draw back faces of the light frustum with 
 	// depth test greater
@@ -2049,7 +2072,7 @@ void	RB_shadowResampleAlpha( void ) {
 	GL_Cull( CT_BACK_SIDED );
 	qglDepthFunc( GL_GREATER );
 
-	RB_DrawElementsWithCounters( tri );
+	RB_Exp_DrawFrustum( tri );
 
 	qglDisable(GL_VERTEX_PROGRAM_ARB);
 	qglDisable(GL_FRAGMENT_PROGRAM_ARB);
@@ -2467,10 +2490,6 @@ void    RB_Exp_DrawInteractions( void ) {
 			continue;
 		}
 
-		if ( !vLight->frustumTris->ambientCache ) {
-			R_CreateAmbientCache( const_cast<srfTriangles_t *>(vLight->frustumTris), false ); 
-		}
-
 		// all light side projections must currently match, so non-centered
 		// and non-cubic lights must take the largest length
 		viewLightAxialSize = R_EXP_CalcLightAxialSize( vLight );
@@ -30,6 +30,7 @@ If you have questions concerning this license or the applicable additional terms
 #pragma hdrstop
 
 #include "tr_local.h"
+#include "Model_local.h"
 
 static const float CHECK_BOUNDS_EPSILON = 1.0f;
 
@@ -46,11 +47,11 @@ VERTEX CACHE GENERATORS
 ==================
 R_CreateAmbientCache
 
-Create it if needed
+Create it if needed, skinned surfaces need a new one every frame
 ==================
 */
 bool R_CreateAmbientCache( srfTriangles_t *tri, bool needsLighting ) {
-	if ( tri->ambientCache ) {
+	if ( vertexCache.CacheIsCurrent( &tri->ambientCache ) ) {
 		return true;
 	}
 	// we are going to use it for drawing, so make sure we have the tangents and normals
@@ -58,7 +59,11 @@ bool R_CreateAmbientCache( srfTriangles_t *tri, bool needsLighting ) {
 		R_DeriveTangents( tri );
 	}
 
-	vertexCache.Alloc( tri->verts, tri->numVerts * sizeof( tri->verts[0] ), &tri->ambientCache );
+	if ( tri->dynamicVerts ) {
+		vertexCache.AllocDynamic( tri->verts, tri->numVerts * sizeof( tri->verts[0] ), &tri->ambientCache );
+	} else {
+		vertexCache.Alloc( tri->verts, tri->numVerts * sizeof( tri->verts[0] ), &tri->ambientCache );
+	}
 	if ( !tri->ambientCache ) {
 		return false;
 	}
@@ -182,7 +187,11 @@ void R_CreateVertexProgramShadowCache( srfTriangles_t *tri ) {
 
 #endif
 
-	vertexCache.Alloc( temp, tri->numVerts * 2 * sizeof( shadowCache_t ), &tri->shadowCache );
+	if ( tri->dynamicVerts ) {
+		vertexCache.AllocDynamic( temp, tri->numVerts * 2 * sizeof( shadowCache_t ), &tri->shadowCache );
+	} else {
+		vertexCache.Alloc( temp, tri->numVerts * 2 * sizeof( shadowCache_t ), &tri->shadowCache );
+	}
 }
 
 /*
@@ -650,6 +659,25 @@ void idRenderWorldLocal::CreateLightDefInteractions( idRenderLightLocal *ldef )
 
 //===============================================================================================================
 
+/*
+=================
+R_FrameSurfaceGeometry
+
+The r_smp back end thread draws a frame while the front end builds the next,
+which can free and recreate the vertex caches of the same surfaces, so the
+draw surfaces get a frame copy of the triangle header
+=================
+*/
+static const srfTriangles_t *R_FrameSurfaceGeometry( const srfTriangles_t *tri ) {
+	if ( !R_RenderThreadActive() ) {
+		return tri;
+	}
+
+	srfTriangles_t *copy = (srfTriangles_t *)R_FrameAlloc( sizeof( *copy ) );
+	memcpy( copy, tri, sizeof( *copy ) );
+	return copy;
+}
+
 /*
 =================
 R_LinkLightSurf
@@ -665,7 +693,7 @@ void R_LinkLightSurf( const drawSurf_t **link, const srfTriangles_t *tri, const
 
 	drawSurf = (drawSurf_t *)R_FrameAlloc( sizeof( *drawSurf ) );
 
-	drawSurf->geo = tri;
+	drawSurf->geo = R_FrameSurfaceGeometry( tri );
 	drawSurf->space = space;
 	drawSurf->material = shader;
 	drawSurf->scissorRect = scissor;
@@ -1093,15 +1121,14 @@ bool R_IssueEntityDefCallback( idRenderEntityLocal *def ) {
 
 /*
 ===================
-R_EntityDefDynamicModel
+R_UpdateEntityDefDynamicModel
 
-Issues a deferred entity callback if necessary.
-If the model isn't dynamic, it returns the original.
-Returns the cached dynamic model if present, otherwise creates
-it and any necessary overlays
+Issues a deferred entity callback if necessary and clears the snapshot
+of the dynamic model if it is out of date.
+Returns true if the snapshot has to be instantiated.
 ===================
 */
-idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
+static bool R_UpdateEntityDefDynamicModel( idRenderEntityLocal *def ) {
 	bool callbackUpdate;
 
 	// allow deferred entities to construct themselves
@@ -1120,7 +1147,7 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 	if ( model->IsDynamicModel() == DM_STATIC ) {
 		def->dynamicModel = NULL;
 		def->dynamicModelFrameCount = 0;
-		return model;
+		return false;
 	}
 
 	// continously animating models (particle systems, etc) will have their snapshot updated every single view
@@ -1128,36 +1155,63 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		R_ClearEntityDefDynamicModel( def );
 	}
 
-	// if we don't have a snapshot of the dynamic model, generate it now
-	if ( !def->dynamicModel ) {
+	// if we don't have a snapshot of the dynamic model, it needs to be generated
+	return ( def->dynamicModel == NULL );
+}
 
-		// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
-		def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
+/*
+===================
+R_InstantiateEntityDefDynamicModel
+
+Creates the snapshot of the dynamic model and any necessary overlays.
+This only touches the entity, so it can run in a job for models that
+do not share any data between their snapshots.
+===================
+*/
+static void R_InstantiateEntityDefDynamicModel( idRenderEntityLocal *def ) {
+	idRenderModel *model = def->parms.hModel;
 
-		if ( def->cachedDynamicModel ) {
+	// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
+	def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
 
-			// add any overlays to the snapshot of the dynamic model
-			if ( def->overlay && !r_skipOverlays.GetBool() ) {
-				def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
-			} else {
-				idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
-			}
+	if ( def->cachedDynamicModel ) {
 
-			if ( r_checkBounds.GetBool() ) {
-				idBounds b = def->cachedDynamicModel->Bounds();
-				if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
-						b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
-						b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
-						b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
-						b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
-						b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
-					common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
-				}
+		// add any overlays to the snapshot of the dynamic model
+		if ( def->overlay && !r_skipOverlays.GetBool() ) {
+			def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+		} else {
+			idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
+		}
+
+		if ( r_checkBounds.GetBool() ) {
+			idBounds b = def->cachedDynamicModel->Bounds();
+			if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
+					b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
+					b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
+					b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
+					b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
+					b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
+				common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
 			}
 		}
+	}
+
+	def->dynamicModel = def->cachedDynamicModel;
+	def->dynamicModelFrameCount = tr.frameCount;
+}
+
+/*
+===================
+R_FinishEntityDefDynamicModel
 
-		def->dynamicModel = def->cachedDynamicModel;
-		def->dynamicModelFrameCount = tr.frameCount;
+Sets the per view depth hack and returns the model to use for the entity
+===================
+*/
+static idRenderModel *R_FinishEntityDefDynamicModel( idRenderEntityLocal *def ) {
+	idRenderModel *model = def->parms.hModel;
+
+	if ( model->IsDynamicModel() == DM_STATIC ) {
+		return model;
 	}
 
 	// set model depth hack value
@@ -1175,6 +1229,23 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 	return def->dynamicModel;
 }
 
+/*
+===================
+R_EntityDefDynamicModel
+
+Issues a deferred entity callback if necessary.
+If the model isn't dynamic, it returns the original.
+Returns the cached dynamic model if present, otherwise creates
+it and any necessary overlays
+===================
+*/
+idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
+	if ( R_UpdateEntityDefDynamicModel( def ) ) {
+		R_InstantiateEntityDefDynamicModel( def );
+	}
+	return R_FinishEntityDefDynamicModel( def );
+}
+
 /*
 =================
 R_AddDrawSurf
@@ -1188,7 +1259,7 @@ void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const
 	float			generatedShaderParms[MAX_ENTITY_SHADER_PARMS];
 
 	drawSurf = (drawSurf_t *)R_FrameAlloc( sizeof( *drawSurf ) );
-	drawSurf->geo = tri;
+	drawSurf->geo = R_FrameSurfaceGeometry( tri );
 	drawSurf->space = space;
 	drawSurf->material = shader;
 	drawSurf->scissorRect = scissor;
@@ -1323,6 +1394,73 @@ void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const
 	// adds for this view
 }
 
+/*
+===============
+R_AmbientSurfaceShader
+
+Returns the material a model surface will be drawn with by
+R_AddAmbientDrawsurfs, or NULL if it won't be drawn at all
+===============
+*/
+static const idMaterial *R_AmbientSurfaceShader( const idRenderEntityLocal *def, const modelSurface_t *surf, int surfaceNum ) {
+	const idMaterial	*shader;
+
+	// for debugging, only show a single surface at a time
+	if ( r_singleSurface.GetInteger() >= 0 && surfaceNum != r_singleSurface.GetInteger() ) {
+		return NULL;
+	}
+
+	if ( !surf->geometry ) {
+		return NULL;
+	}
+	if ( !surf->geometry->numIndexes ) {
+		return NULL;
+	}
+	shader = surf->shader;
+	shader = R_RemapShaderBySkin( shader, def->parms.customSkin, def->parms.customShader );
+
+	R_GlobalShaderOverride( &shader );
+
+	if ( !shader ) {	
+		return NULL;
+	}
+	if ( !shader->IsDrawn() ) {
+		return NULL;
+	}
+	return shader;
+}
+
+/*
+===============
+R_CreateAmbientSurfaceCaches
+
+Creates the ambient caches and sets the ambientViewCount of the surfaces
+R_AddAmbientDrawsurfs will add, so the light surfaces can be created before
+the entity is added to the view.  Stops at the first surface the vertex cache
+can't hold, just like R_AddAmbientDrawsurfs, so no light surfaces are created
+for the surfaces the serial path would have skipped.
+===============
+*/
+static void R_CreateAmbientSurfaceCaches( viewEntity_t *vEntity, const idRenderModel *model ) {
+	const idMaterial *shader;
+
+	int total = model->NumSurfaces();
+	for ( int i = 0 ; i < total ; i++ ) {
+		const modelSurface_t *surf = model->Surface( i );
+
+		shader = R_AmbientSurfaceShader( vEntity->entityDef, surf, i );
+		if ( !shader ) {
+			continue;
+		}
+		if ( !R_CullLocalBox( surf->geometry->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum ) ) {
+			if ( !R_CreateAmbientCache( surf->geometry, shader->ReceivesLighting() ) ) {
+				return;
+			}
+			surf->geometry->ambientViewCount = tr.viewCount;
+		}
+	}
+}
+
 /*
 ===============
 R_AddAmbientDrawsurfs
@@ -1352,29 +1490,11 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 	for ( i = 0 ; i < total ; i++ ) {
 		const modelSurface_t	*surf = model->Surface( i );
 
-		// for debugging, only show a single surface at a time
-		if ( r_singleSurface.GetInteger() >= 0 && i != r_singleSurface.GetInteger() ) {
+		shader = R_AmbientSurfaceShader( def, surf, i );
+		if ( !shader ) {
 			continue;
 		}
-
 		tri = surf->geometry;
-		if ( !tri ) {
-			continue;
-		}
-		if ( !tri->numIndexes ) {
-			continue;
-		}
-		shader = surf->shader;
-		shader = R_RemapShaderBySkin( shader, def->parms.customSkin, def->parms.customShader );
-
-		R_GlobalShaderOverride( &shader );
-
-		if ( !shader ) {	
-			continue;
-		}
-		if ( !shader->IsDrawn() ) {
-			continue;
-		}
 
 		// debugging tool to make sure we are have the correct pre-calculated bounds
 		if ( r_checkBounds.GetBool() ) {
@@ -1446,6 +1566,439 @@ idScreenRect R_CalcEntityScissorRectangle( viewEntity_t *vEntity ) {
 	return R_ScreenRectFromViewFrustumBounds( bounds );
 }
 
+/*
+===============================================================================
+
+	Parallel dynamic model instantiation
+
+	The entity callbacks and interaction culling of all view entities are
+	issued on the main thread in view order, then the dynamic model snapshots
+	of entities with private dynamic models are created on the job threads.
+	The ambient caches are created in view order on the main thread, and the
+	light and shadow surfaces of all the out of date interactions of the
+	entities with private dynamic or static models are then created in a
+	second batch, one job per interaction.  All surfaces are still added to
+	the view in the original order on the main thread, so the game sees the
+	same callbacks and the draw surface and light lists are the same as with
+	the serial path.
+
+===============================================================================
+*/
+
+typedef struct {
+	idInteraction *			interaction;
+	idScreenRect			shadowScissor;
+	const idRenderModel *	model;				// model the surfaces are created from in the job
+} preparedInteraction_t;
+
+typedef struct {
+	viewEntity_t *			vEntity;
+	bool					prepared;			// callback issued and interactions culled up front
+	bool					inJob;				// interaction surfaces are created in the jobs
+	bool					instantiate;		// the dynamic model snapshot needs to be created
+	int						numInteractions;
+	preparedInteraction_t *	interactions;
+} preparedEntity_t;
+
+/*
+===================
+R_UseParallelAddModels
+===================
+*/
+static bool R_UseParallelAddModels( void ) {
+	if ( !r_useParallelAddModels.GetBool() || jobManager->GetNumThreads() <= 0 ) {
+		return false;
+	}
+	// these would print or draw debug lines from the jobs
+	if ( r_showSkel.GetInteger() || r_showAnimLOD.GetBool() || r_checkBounds.GetBool() ) {
+		return false;
+	}
+	// xray views skip interactions on a per entity basis
+	if ( tr.viewDef->isXraySubview ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+===================
+R_EntityDefHasPrivateDynamicModel
+
+Returns true if the entity model creates a snapshot that doesn't share any
+surfaces with other entities, and can be instantiated without reloading
+or printing, so it is safe to instantiate in a job.
+===================
+*/
+static bool R_EntityDefHasPrivateDynamicModel( const idRenderEntityLocal *def ) {
+	idRenderModel *model = def->parms.hModel;
+
+	if ( model == NULL || model->IsDynamicModel() == DM_STATIC || !model->IsLoaded() ) {
+		return false;
+	}
+
+	const idRenderModelMD5 *md5 = dynamic_cast<const idRenderModelMD5 *>( model );
+	if ( md5 != NULL ) {
+		return ( def->parms.joints != NULL && def->parms.numJoints == md5->NumJoints() );
+	}
+
+	return ( dynamic_cast<const idRenderModelPrt *>( model ) != NULL );
+}
+
+/*
+===================
+R_EntityDefCanBePrepared
+
+Static models are only read while the interactions are created,
+so they can be used from the jobs as well
+===================
+*/
+static bool R_EntityDefCanBePrepared( const idRenderEntityLocal *def ) {
+	idRenderModel *model = def->parms.hModel;
+
+	if ( model != NULL && model->IsDynamicModel() == DM_STATIC ) {
+		return model->IsLoaded();
+	}
+	return R_EntityDefHasPrivateDynamicModel( def );
+}
+
+/*
+===================
+R_DeriveModelFacePlanes
+
+R_CalcInteractionFacing derives the face planes on demand, which isn't safe
+when several interactions with the same surface are created at once, so
+they are derived before the interactions are handed to the jobs
+===================
+*/
+static void R_DeriveModelFacePlanes( const idRenderModel *model ) {
+	for ( int i = 0; i < model->NumSurfaces(); i++ ) {
+		srfTriangles_t *tri = model->Surface( i )->geometry;
+		if ( tri == NULL || tri->numIndexes == 0 ) {
+			continue;
+		}
+		if ( !tri->facePlanes || !tri->facePlanesCalculated ) {
+			R_DeriveFacePlanes( tri );
+		}
+	}
+}
+
+/*
+===================
+R_CreateModelSurfacesJob
+===================
+*/
+static void R_CreateModelSurfacesJob( void *data, int first, int last ) {
+	preparedEntity_t **entities = (preparedEntity_t **)data;
+
+	for ( int i = first; i < last; i++ ) {
+		preparedEntity_t *entity = entities[i];
+		idRenderEntityLocal *def = entity->vEntity->entityDef;
+
+		if ( entity->instantiate ) {
+			R_InstantiateEntityDefDynamicModel( def );
+		}
+
+		idRenderModel *model = def->dynamicModel;
+		if ( model == NULL || model->NumSurfaces() <= 0 ) {
+			continue;
+		}
+
+		if ( entity->numInteractions > 0 ) {
+			R_DeriveModelFacePlanes( model );
+		}
+	}
+}
+
+/*
+===================
+R_CreateInteractionsJob
+===================
+*/
+static void R_CreateInteractionsJob( void *data, int first, int last ) {
+	preparedInteraction_t **interactions = (preparedInteraction_t **)data;
+
+	for ( int i = first; i < last; i++ ) {
+		interactions[i]->interaction->CreateActiveInteraction( interactions[i]->model );
+	}
+}
+
+/*
+===================
+R_PrepareStaticModelSurfaces
+
+Static models can be shared by several entities, so anything that writes to
+their surfaces is done here on the main thread
+===================
+*/
+static void R_PrepareStaticModelSurfaces( preparedEntity_t *entity ) {
+	const idRenderModel *model = entity->vEntity->entityDef->parms.hModel;
+
+	if ( model->NumSurfaces() <= 0 ) {
+		return;
+	}
+
+	for ( int i = 0; i < entity->numInteractions; i++ ) {
+		if ( entity->interactions[i].interaction->IsOutOfDate() ) {
+			R_DeriveModelFacePlanes( model );
+			break;
+		}
+	}
+}
+
+/*
+===================
+R_CreatePreparedAmbientCaches
+
+The ambient caches of all prepared entities are allocated in view order on
+the main thread, so the vertex cache runs out on the same surfaces as in the
+serial path, and only the ambient surfaces in view get their light surfaces
+created right away
+===================
+*/
+static void R_CreatePreparedAmbientCaches( preparedEntity_t *entities, int numViewEntities ) {
+	for ( int i = 0; i < numViewEntities; i++ ) {
+		preparedEntity_t *entity = &entities[i];
+		if ( !entity->prepared || entity->vEntity->scissorRect.IsEmpty() ) {
+			continue;
+		}
+
+		idRenderEntityLocal *def = entity->vEntity->entityDef;
+		const idRenderModel *model = def->parms.hModel;
+		if ( model->IsDynamicModel() != DM_STATIC ) {
+			model = def->dynamicModel;
+		}
+		if ( model == NULL || model->NumSurfaces() <= 0 ) {
+			continue;
+		}
+
+		R_CreateAmbientSurfaceCaches( entity->vEntity, model );
+	}
+}
+
+/*
+===================
+R_CreatePreparedInteractions
+
+Creates the surfaces of all the out of date interactions of the prepared
+entities in parallel
+===================
+*/
+static void R_CreatePreparedInteractions( preparedEntity_t *entities, int numViewEntities, int numPreparedInteractions ) {
+	preparedInteraction_t	**jobs;
+	int						numJobs;
+
+	if ( numPreparedInteractions == 0 ) {
+		return;
+	}
+
+	jobs = (preparedInteraction_t **)R_FrameAlloc( numPreparedInteractions * sizeof( jobs[0] ) );
+	numJobs = 0;
+
+	for ( int i = 0; i < numViewEntities; i++ ) {
+		preparedEntity_t *entity = &entities[i];
+		if ( !entity->inJob ) {
+			continue;
+		}
+
+		idRenderEntityLocal *def = entity->vEntity->entityDef;
+		const idRenderModel *model = def->parms.hModel;
+		if ( model->IsDynamicModel() != DM_STATIC ) {
+			model = def->dynamicModel;
+		}
+		if ( model == NULL || model->NumSurfaces() <= 0 ) {
+			continue;
+		}
+
+		for ( int j = 0; j < entity->numInteractions; j++ ) {
+			preparedInteraction_t *prepared = &entity->interactions[j];
+			if ( !prepared->interaction->IsOutOfDate() ) {
+				continue;
+			}
+			prepared->model = model;
+			jobs[numJobs++] = prepared;
+		}
+	}
+
+	if ( numJobs > 0 ) {
+		jobManager->ParallelFor( "R_CreateInteractions", numJobs, 1, R_CreateInteractionsJob, jobs );
+	}
+}
+
+/*
+===================
+R_PrepareViewEntity
+
+Issues the callback and culls the interactions of a single view entity.
+Entities that can't be instantiated in the jobs are instantiated here,
+returns true if the entity is handed to the jobs.
+===================
+*/
+static bool R_PrepareViewEntity( preparedEntity_t *entity, bool allowJob ) {
+	viewEntity_t		*vEntity = entity->vEntity;
+	idRenderEntityLocal	*def = vEntity->entityDef;
+	idInteraction		*inter;
+	bool				updated;
+	int					count;
+
+	entity->prepared = true;
+
+	updated = false;
+	if ( !vEntity->scissorRect.IsEmpty() ) {
+		entity->instantiate = R_UpdateEntityDefDynamicModel( def );
+		updated = true;
+	}
+
+	// all empty interactions are at the end of the list
+	count = 0;
+	for ( inter = def->firstInteraction; inter != NULL && !inter->IsEmpty(); inter = inter->entityNext ) {
+		if ( inter->lightDef->viewCount == tr.viewCount ) {
+			count++;
+		}
+	}
+	if ( count > 0 ) {
+		entity->interactions = (preparedInteraction_t *)R_FrameAlloc( count * sizeof( entity->interactions[0] ) );
+	}
+	for ( inter = def->firstInteraction; inter != NULL && !inter->IsEmpty(); inter = inter->entityNext ) {
+		if ( inter->lightDef->viewCount != tr.viewCount ) {
+			continue;
+		}
+		preparedInteraction_t *prepared = &entity->interactions[entity->numInteractions];
+		if ( !inter->CullActiveInteraction( prepared->shadowScissor ) ) {
+			continue;
+		}
+		// the dynamic model is needed for the shadows even if the entity isn't visible
+		if ( !updated ) {
+			entity->instantiate = R_UpdateEntityDefDynamicModel( def );
+			updated = true;
+		}
+		prepared->interaction = inter;
+		entity->numInteractions++;
+	}
+
+	if ( !updated ) {
+		return false;
+	}
+
+	// the callback may have changed the model to one that has to be instantiated here
+	if ( !allowJob || !R_EntityDefCanBePrepared( def ) ) {
+		if ( entity->instantiate ) {
+			R_InstantiateEntityDefDynamicModel( def );
+			entity->instantiate = false;
+		}
+		return false;
+	}
+
+	entity->inJob = true;
+	return true;
+}
+
+/*
+===================
+R_PrepareModelSurfaces
+
+Issues the callbacks, culls the interactions and creates the ambient caches
+of all view entities in view order, just like the serial loop, then creates
+the models and interaction surfaces of the entities with static or private
+dynamic models in parallel.  Returns one entry for each view entity.
+===================
+*/
+static preparedEntity_t *R_PrepareModelSurfaces( int numViewEntities ) {
+	preparedEntity_t	*entities;
+	preparedEntity_t	**jobs;
+	viewEntity_t		*vEntity;
+	float				oldFloatTime;
+	int					oldTime;
+	int					i, numJobs, numPreparedInteractions;
+
+	entities = (preparedEntity_t *)R_ClearedFrameAlloc( numViewEntities * sizeof( entities[0] ) );
+	jobs = (preparedEntity_t **)R_FrameAlloc( numViewEntities * sizeof( jobs[0] ) );
+	numJobs = 0;
+	numPreparedInteractions = 0;
+
+	for ( i = 0, vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next, i++ ) {
+		idRenderEntityLocal *def = vEntity->entityDef;
+		preparedEntity_t *entity = &entities[i];
+
+		entity->vEntity = vEntity;
+
+		// the serial loop skips these outside of xray views, which are never prepared
+		if ( def->parms.xrayIndex == 2 ) {
+			continue;
+		}
+
+		game->SelectTimeGroup( def->parms.timeGroup );
+
+		// the callbacks of entities in time groups are issued with the time group time,
+		// the jobs only use the view time so they are instantiated here
+		if ( def->parms.timeGroup ) {
+			oldFloatTime = tr.viewDef->floatTime;
+			oldTime = tr.viewDef->renderView.time;
+
+			tr.viewDef->floatTime = game->GetTimeGroupTime( def->parms.timeGroup ) * 0.001;
+			tr.viewDef->renderView.time = game->GetTimeGroupTime( def->parms.timeGroup );
+		}
+
+		if ( R_PrepareViewEntity( entity, def->parms.timeGroup == 0 ) ) {
+			numPreparedInteractions += entity->numInteractions;
+
+			if ( def->parms.hModel->IsDynamicModel() == DM_STATIC ) {
+				R_PrepareStaticModelSurfaces( entity );
+			} else {
+				jobs[numJobs++] = entity;
+			}
+		}
+
+		if ( def->parms.timeGroup ) {
+			tr.viewDef->floatTime = oldFloatTime;
+			tr.viewDef->renderView.time = oldTime;
+		}
+	}
+
+	if ( numJobs > 0 ) {
+		jobManager->ParallelFor( "R_AddModelSurfaces", numJobs, 1, R_CreateModelSurfacesJob, jobs );
+	}
+
+	R_CreatePreparedAmbientCaches( entities, numViewEntities );
+	R_CreatePreparedInteractions( entities, numViewEntities, numPreparedInteractions );
+
+	return entities;
+}
+
+/*
+===================
+R_AddPreparedInteractions
+
+Adds the interactions that were culled by R_PrepareModelSurfaces
+===================
+*/
+static void R_AddPreparedInteractions( preparedEntity_t *entity ) {
+	if ( entity->numInteractions == 0 ) {
+		return;
+	}
+
+	idRenderModel *model = R_FinishEntityDefDynamicModel( entity->vEntity->entityDef );
+	if ( model == NULL || model->NumSurfaces() <= 0 ) {
+		return;
+	}
+
+	for ( int i = 0; i < entity->numInteractions; i++ ) {
+		preparedInteraction_t *prepared = &entity->interactions[i];
+		idInteraction *inter = prepared->interaction;
+
+		if ( !entity->inJob ) {
+			inter->CreateActiveInteraction( model );
+		}
+
+		// relink interactions that turned out to be empty in the job
+		if ( inter->IsEmpty() ) {
+			inter->MakeEmpty();
+			continue;
+		}
+
+		inter->LinkActiveInteraction( prepared->shadowScissor );
+	}
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1461,14 +2014,16 @@ void R_AddModelSurfaces( void ) {
 	viewEntity_t		*vEntity;
 	idInteraction		*inter, *next;
 	idRenderModel		*model;
+	preparedEntity_t	*preparedEntities, *entity;
+	int					i, numViewEntities;
 
 	// clear the ambient surface list
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 
-	// go through each entity that is either visible to the view, or to
-	// any light that intersects the view (for shadows)
+	numViewEntities = 0;
 	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+		numViewEntities++;
 
 		if ( r_useEntityScissors.GetBool() ) {
 			// calculate the screen area covered by the entity
@@ -1480,6 +2035,19 @@ void R_AddModelSurfaces( void ) {
 				R_ShowColoredScreenRect( vEntity->scissorRect, vEntity->entityDef->index );
 			}
 		}
+	}
+
+	// create the dynamic models and interaction surfaces in parallel where possible
+	preparedEntities = NULL;
+	if ( numViewEntities > 0 && R_UseParallelAddModels() ) {
+		preparedEntities = R_PrepareModelSurfaces( numViewEntities );
+	}
+
+	// go through each entity that is either visible to the view, or to
+	// any light that intersects the view (for shadows)
+	for ( i = 0, vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next, i++ ) {
+
+		entity = ( preparedEntities != NULL ) ? &preparedEntities[i] : NULL;
 
 		float oldFloatTime;
 		int oldTime;
@@ -1510,7 +2078,11 @@ void R_AddModelSurfaces( void ) {
 
 		// add the ambient surface if it has a visible rectangle
 		if ( !vEntity->scissorRect.IsEmpty() ) {
-			model = R_EntityDefDynamicModel( vEntity->entityDef );
+			if ( entity != NULL && entity->prepared ) {
+				model = R_FinishEntityDefDynamicModel( vEntity->entityDef );
+			} else {
+				model = R_EntityDefDynamicModel( vEntity->entityDef );
+			}
 			if ( model == NULL || model->NumSurfaces() <= 0 ) {
 				if ( vEntity->entityDef->parms.timeGroup ) {
 					tr.viewDef->floatTime = oldFloatTime;
@@ -1528,7 +2100,9 @@ void R_AddModelSurfaces( void ) {
 		//
 		// for all the entity / light interactions on this entity, add them to the view
 		//
-		if ( tr.viewDef->isXraySubview ) {
+		if ( entity != NULL && entity->prepared ) {
+			R_AddPreparedInteractions( entity );
+		} else if ( tr.viewDef->isXraySubview ) {
 			if ( vEntity->entityDef->parms.xrayIndex == 2 ) {
 				for ( inter = vEntity->entityDef->firstInteraction; inter != NULL && !inter->IsEmpty(); inter = next ) {
 					next = inter->entityNext;
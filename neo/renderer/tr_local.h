@@ -96,6 +96,7 @@ SURFACES
 #include "ModelDecal.h"
 #include "ModelOverlay.h"
 #include "Interaction.h"
+#include "InteractionCache.h"
 
 
 // drawSurf_t structures command the back end to render surfaces
@@ -192,6 +193,8 @@ public:
 
 	bool					lightHasMoved;			// the light has changed its position since it was
 													// first added, so the prelight model is not valid
+	bool					movedAfterLoad;			// the shape changed after GenerateAllInteractions,
+													// so its interactions aren't saved in the interaction cache
 
 	float					modelMatrix[16];		// this is just a rearrangement of parms.axis and parms.origin
 
@@ -259,6 +262,8 @@ public:
 													// and should go in the dynamic frame memory, or kept
 													// in the cached memory
 	bool					archived;				// for demo writing
+	bool					movedAfterLoad;			// the model or placement changed after GenerateAllInteractions,
+													// so its interactions aren't saved in the interaction cache
 
 	idRenderModel *			dynamicModel;			// if parms.model->IsDynamicModel(), this is the generated data
 	int						dynamicModelFrameCount;	// continuously animating dynamic models will recreate
@@ -522,7 +527,7 @@ typedef struct frameMemoryBlock_s {
 // all of the information needed by the back end must be
 // contained in a frameData_t.  This entire structure is
 // duplicated so the front and back end can run in parallel
-// on an SMP machine (OBSOLETE: this capability has been removed)
+// on an SMP machine when r_smp is enabled
 typedef struct {
 	// one or more blocks of memory for all frame
 	// temporary allocations
@@ -544,12 +549,36 @@ typedef struct {
 
 extern	frameData_t	*frameData;
 
+// every thread that allocates frame memory bump allocates from its own
+// arena, which carves chunks out of the frameData blocks, so only
+// taking a new chunk needs an interlocked operation
+typedef struct {
+	byte *				base;				// current chunk
+	int					size;
+	int					used;
+	int					frameBytes;			// carved by this arena in the current frame
+	int					highwater;			// max used on any frame
+} frameArena_t;
+
+const int MAX_FRAME_ARENAS			= MAX_JOB_THREADS + 1;	// main thread and job threads
+
+extern	frameArena_t	frameArenas[MAX_FRAME_ARENAS];
+
 //=======================================================================
 
 void R_LockSurfaceScene( viewDef_t *parms );
 void R_ClearCommandChain( void );
 void R_AddDrawViewCmd( viewDef_t *parms );
 
+// with r_smp the issued commands are executed by a back end thread, which
+// owns the GL context until a front end GL call takes it back through
+// R_SyncRenderThread
+void R_InitRenderThread( void );
+void R_ShutdownRenderThread( void );
+bool R_RenderThreadActive( void );
+void R_WaitForRenderThread( void );		// wait for the issued commands to finish
+void R_SyncRenderThread( void );		// also makes the GL context current on the calling thread
+
 void R_ReloadGuis_f( const idCmdArgs &args );
 void R_ListGuis_f( const idCmdArgs &args );
 
@@ -575,6 +604,7 @@ typedef struct {
 	int		c_createLightTris;
 	int		c_createShadowVolumes;
 	int		c_generateMd5;
+	int		c_reusedMd5;		// snapshots that kept the skinned vertexes of the previous one
 	int		c_entityDefCallbacks;
 	int		c_alloc, c_free;	// counts for R_StaticAllc/R_StaticFree
 	int		c_visibleViewEntities;
@@ -872,6 +902,13 @@ extern idCVar r_useShadowVertexProgram;	// 1 = do the shadow projection in the v
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
+extern idCVar r_useSkinningCache;		// 1 = reuse skinned md5 vertexes until the joints change
+extern idCVar r_skinningLOD;			// 1 = low detail skinning for md5 models that cover little of the view
+extern idCVar r_skinningLODScreenSize;	// fraction of the view width below which the low detail skinning is used
+extern idCVar r_useBinaryMD5Meshes;		// 1 = load md5 meshes from the binary files in generated/
+extern idCVar r_useParallelAddModels;	// 1 = instantiate dynamic models and create their interactions in jobs
+extern idCVar r_useInteractionCache;	// 1 = save and load the interactions of static models per map
+extern idCVar r_smp;					// 1 = run the back end on its own thread, takes effect at vid_restart
 extern idCVar r_useTwoSidedStencil;		// 1 = do stencil shadows in one pass with different ops on each side
 extern idCVar r_useInfiniteFarZ;		// 1 = use the no-far-clip-plane trick
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
@@ -954,6 +991,7 @@ extern idCVar r_showPrimitives;			// report vertex/index/draw counts
 extern idCVar r_showPortals;			// draw portal outlines in color based on passed / not passed
 extern idCVar r_showAlloc;				// report alloc/free counts
 extern idCVar r_showSkel;				// draw the skeleton when model animates
+extern idCVar r_showAnimLOD;			// draw the bounds of md5 models colored by the skinning lod
 extern idCVar r_showOverDraw;			// show overdraw
 extern idCVar r_jointNameScale;			// size of joint names when r_showskel is set to 1
 extern idCVar r_jointNameOffset;		// offset of joint names when r_showskel is set to 1
@@ -1449,6 +1487,9 @@ srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
 									 const srfTriangles_t *tri, const idRenderLightLocal *light,
 									 shadowGen_t optimize, srfCullInfo_t &cullInfo );
 
+// frees the per thread clip buffers
+void R_ShutdownShadowBuffers( void );
+
 /*
 ============================================================
 
@@ -176,6 +176,40 @@ void R_ShowColoredScreenRect( const idScreenRect &rect, int colorIndex ) {
 	}
 }
 
+//=====================================================
+
+#define	MEMORY_BLOCK_SIZE	0x100000
+#define	ARENA_CHUNK_SIZE	0x10000
+
+frameArena_t	frameArenas[MAX_FRAME_ARENAS];
+
+// the main thread is given the first arena by R_InitFrameData,
+// the job threads pick up their arena on the first allocation
+static frameArena_t						unassignedFrameArena;
+static ID_THREAD_LOCAL frameArena_t *	frameArena = &unassignedFrameArena;
+
+static volatile int		frameBlockLock;
+
+// the r_smp back end thread executes one frameData while the front end fills the other
+static const int		NUM_FRAME_DATA = 2;
+static frameData_t *	smpFrameData[NUM_FRAME_DATA];
+static int				smpFrame;
+
+/*
+=====================
+R_ClearFrameArenas
+=====================
+*/
+static void R_ClearFrameArenas( void ) {
+	for ( int i = 0; i < MAX_FRAME_ARENAS; i++ ) {
+		frameArena_t *arena = &frameArenas[i];
+		arena->base = NULL;
+		arena->size = 0;
+		arena->used = 0;
+		arena->frameBytes = 0;
+	}
+}
+
 /*
 ====================
 R_ToggleSmpFrame
@@ -185,6 +219,14 @@ void R_ToggleSmpFrame( void ) {
 	if ( r_lockSurfaces.GetBool() ) {
 		return;
 	}
+
+	// the back end thread may still be executing this frame, but EndFrame
+	// waited for it to finish the other one, which can be reused
+	if ( R_RenderThreadActive() ) {
+		smpFrame = ( smpFrame + 1 ) % NUM_FRAME_DATA;
+		frameData = smpFrameData[smpFrame];
+	}
+
 	R_FreeDeferredTriSurfs( frameData );
 
 	// clear frame-temporary data
@@ -204,14 +246,12 @@ void R_ToggleSmpFrame( void ) {
 		block->used = 0;
 	}
 
+	// the thread arenas have to carve new chunks
+	R_ClearFrameArenas();
+
 	R_ClearCommandChain();
 }
 
-
-//=====================================================
-
-#define	MEMORY_BLOCK_SIZE	0x100000
-
 /*
 =====================
 R_ShutdownFrameData
@@ -222,19 +262,25 @@ void R_ShutdownFrameData( void ) {
 	frameMemoryBlock_t *block;
 
 	// free any current data
-	frame = frameData;
-	if ( !frame ) {
+	if ( !frameData ) {
 		return;
 	}
 
-	R_FreeDeferredTriSurfs( frame );
+	R_ClearFrameArenas();
 
-	frameMemoryBlock_t *nextBlock;
-	for ( block = frame->memory ; block ; block = nextBlock ) {
-		nextBlock = block->next;
-		Mem_Free( block );
+	for ( int i = 0; i < NUM_FRAME_DATA; i++ ) {
+		frame = smpFrameData[i];
+
+		R_FreeDeferredTriSurfs( frame );
+
+		frameMemoryBlock_t *nextBlock;
+		for ( block = frame->memory ; block ; block = nextBlock ) {
+			nextBlock = block->next;
+			Mem_Free( block );
+		}
+		Mem_Free( frame );
+		smpFrameData[i] = NULL;
 	}
-	Mem_Free( frame );
 	frameData = NULL;
 }
 
@@ -250,18 +296,25 @@ void R_InitFrameData( void ) {
 
 	R_ShutdownFrameData();
 
-	frameData = (frameData_t *)Mem_ClearedAlloc( sizeof( *frameData ));
-	frame = frameData;
-	size = MEMORY_BLOCK_SIZE;
-	block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
-	if ( !block ) {
-		common->FatalError( "R_InitFrameData: Mem_Alloc() failed" );
+	for ( int i = 0; i < NUM_FRAME_DATA; i++ ) {
+		frame = (frameData_t *)Mem_ClearedAlloc( sizeof( *frame ));
+		size = MEMORY_BLOCK_SIZE;
+		block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
+		if ( !block ) {
+			common->FatalError( "R_InitFrameData: Mem_Alloc() failed" );
+		}
+		block->size = size;
+		block->used = 0;
+		block->next = NULL;
+		frame->memory = block;
+		frame->memoryHighwater = 0;
+		smpFrameData[i] = frame;
 	}
-	block->size = size;
-	block->used = 0;
-	block->next = NULL;
-	frame->memory = block;
-	frame->memoryHighwater = 0;
+	smpFrame = 0;
+	frameData = smpFrameData[0];
+
+	// this is the thread the front end runs on
+	frameArena = &frameArenas[0];
 
 	R_ToggleSmpFrame();
 }
@@ -279,7 +332,8 @@ int R_CountFrameData( void ) {
 	count = 0;
 	frame = frameData;
 	for ( block = frame->memory ; block ; block=block->next ) {
-		count += block->used;
+		// a failed carve may have pushed the used count past the end
+		count += Min( block->used, block->size );
 		if ( block == frame->alloc ) {
 			break;
 		}
@@ -290,6 +344,16 @@ int R_CountFrameData( void ) {
 		frame->memoryHighwater = count;
 	}
 
+	// the thread arenas keep their own marks, the unused end of the
+	// current chunk doesn't count
+	for ( int i = 0; i < MAX_FRAME_ARENAS; i++ ) {
+		frameArena_t *arena = &frameArenas[i];
+		int used = arena->frameBytes - ( arena->size - arena->used );
+		if ( used > arena->highwater ) {
+			arena->highwater = used;
+		}
+	}
+
 	return count;
 }
 
@@ -301,9 +365,10 @@ R_StaticAlloc
 void *R_StaticAlloc( int bytes ) {
 	void	*buf;
 
-	tr.pc.c_alloc++;
+	// static allocations are also made by the front end jobs
+	Sys_InterlockedIncrement( tr.pc.c_alloc );
 
-	tr.staticAllocCount += bytes;
+	Sys_InterlockedAdd( tr.staticAllocCount, bytes );
 
     buf = Mem_Alloc( bytes );
 
@@ -333,10 +398,107 @@ R_StaticFree
 =================
 */
 void R_StaticFree( void *data ) {
-	tr.pc.c_free++;
+	Sys_InterlockedIncrement( tr.pc.c_free );
     Mem_Free( data );
 }
 
+/*
+================
+R_CarveFrameMemory
+
+Takes memory directly from the frameData blocks, this is the
+only place where the threads compete for frame memory
+================
+*/
+static byte *R_CarveFrameMemory( int bytes ) {
+	frameData_t			*frame;
+	frameMemoryBlock_t	*block, *next;
+	int					end;
+
+	// we could fix this if we needed to...
+	if ( bytes > MEMORY_BLOCK_SIZE ) {
+		common->FatalError( "R_FrameAlloc of %i exceeded MEMORY_BLOCK_SIZE",
+			bytes );
+	}
+
+	frame = frameData;
+	while( 1 ) {
+		block = frame->alloc;
+
+		end = Sys_InterlockedAdd( block->used, bytes );
+		if ( end <= block->size ) {
+			return block->base + end - bytes;
+		}
+
+		// advance to the next memory block, unless another thread already did
+		while ( Sys_InterlockedCompareExchange( frameBlockLock, 0, 1 ) != 0 ) {
+			Sys_SpinPause();
+		}
+		if ( frame->alloc == block ) {
+			next = block->next;
+			// create a new block if we are at the end of
+			// the chain
+			if ( !next ) {
+				int		size;
+
+				size = MEMORY_BLOCK_SIZE;
+				next = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *next ) );
+				if ( !next ) {
+					common->FatalError( "R_FrameAlloc: Mem_Alloc() failed" );
+				}
+				next->size = size;
+				next->used = 0;
+				next->next = NULL;
+				block->next = next;
+			}
+			Sys_InterlockedExchangePointer( *(void * volatile *)&frame->alloc, next );
+		}
+		Sys_InterlockedExchange( frameBlockLock, 0 );
+	}
+}
+
+/*
+================
+R_FrameArenaAlloc
+
+Starts a new chunk in the arena of the calling thread
+================
+*/
+static void *R_FrameArenaAlloc( int bytes ) {
+	frameArena_t	*arena;
+
+	arena = frameArena;
+	if ( arena == &unassignedFrameArena ) {
+		// only the main thread and the jobs can allocate frame memory, any
+		// other thread would share the main thread arena without a lock
+		int threadIndex = jobManager->GetThreadIndex();
+		if ( threadIndex == 0 ) {
+			common->FatalError( "R_FrameAlloc called from thread '%s'", Sys_GetThreadName() );
+		}
+		arena = &frameArenas[ threadIndex ];
+		frameArena = arena;
+
+		if ( arena->size - arena->used >= bytes ) {
+			void *buf = arena->base + arena->used;
+			arena->used += bytes;
+			return buf;
+		}
+	}
+
+	// large allocations don't go through the arena so the rest of the chunk isn't wasted
+	if ( bytes > ARENA_CHUNK_SIZE / 4 ) {
+		arena->frameBytes += bytes;
+		return R_CarveFrameMemory( bytes );
+	}
+
+	arena->base = R_CarveFrameMemory( ARENA_CHUNK_SIZE );
+	arena->size = ARENA_CHUNK_SIZE;
+	arena->used = bytes;
+	arena->frameBytes += ARENA_CHUNK_SIZE;
+
+	return arena->base;
+}
+
 /*
 ================
 R_FrameAlloc
@@ -360,53 +522,26 @@ from this frame.
 
 The memory is NOT zero filled.
 Should part of this be inlined in a macro?
+
+Each thread allocates from its own arena, so this is
+safe to call from the front end jobs.
 ================
 */
 void *R_FrameAlloc( int bytes ) {
-	frameData_t		*frame;
-	frameMemoryBlock_t	*block;
+	frameArena_t	*arena;
 	void			*buf;
     
 	bytes = (bytes+16)&~15;
-	// see if it can be satisfied in the current block
-	frame = frameData;
-	block = frame->alloc;
+	// see if it can be satisfied in the current chunk of this thread
+	arena = frameArena;
 
-	if ( block->size - block->used >= bytes ) {
-		buf = block->base + block->used;
-		block->used += bytes;
+	if ( arena->size - arena->used >= bytes ) {
+		buf = arena->base + arena->used;
+		arena->used += bytes;
 		return buf;
 	}
 
-	// advance to the next memory block if available
-	block = block->next;
-	// create a new block if we are at the end of
-	// the chain
-	if ( !block ) {
-		int		size;
-
-		size = MEMORY_BLOCK_SIZE;
-		block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
-		if ( !block ) {
-			common->FatalError( "R_FrameAlloc: Mem_Alloc() failed" );
-		}
-		block->size = size;
-		block->used = 0;
-		block->next = NULL;
-		frame->alloc->next = block;
-	}
-
-	// we could fix this if we needed to...
-	if ( bytes > block->size ) {
-		common->FatalError( "R_FrameAlloc of %i exceeded MEMORY_BLOCK_SIZE",
-			bytes );
-	}
-
-	frame->alloc = block;
-
-	block->used = bytes;
-
-	return block->base;
+	return R_FrameArenaAlloc( bytes );
 }
 
 /*
@@ -654,6 +789,8 @@ bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16],
 		}
 		if ( j == 8 ) {
 			// all points were behind one of the planes
+			// the cull counters are called far too often to be interlocked,
+			// so they are only approximate when the front end runs in jobs
 			tr.pc.c_box_cull_out++;
 			return true;
 		}
@@ -1094,6 +1231,7 @@ Parms will typically be allocated with R_FrameAlloc
 */
 void R_RenderView( viewDef_t *parms ) {
 	viewDef_t		*oldView;
+	idProfileZone	zone( "R_RenderView" );
 
 	if ( parms->renderView.width <= 0 || parms->renderView.height <= 0 ) {
 		return;
@@ -76,6 +76,10 @@ debugPolygon_t	rb_debugPolygons[ MAX_DEBUG_POLYGONS ];
 int				rb_numDebugPolygons = 0;
 int				rb_debugPolygonTime = 0;
 
+// the back end can't use frame memory, the r_smp back end thread
+// executes one frame while the front end allocates from the other
+static idList<drawSurf_t *>	rb_overdrawSurfs;
+
 static void RB_DrawText( const char *text, const idVec3 &origin, float scale, const idVec4 &color, const idMat3 &viewAxis, const int align );
 
 /*
@@ -329,7 +333,8 @@ void RB_ShowOverdraw( void ) {
 		}
 	}
 
-	drawSurf_t **newDrawSurfs = (drawSurf_t **)R_FrameAlloc( numDrawSurfs + interactions * sizeof( newDrawSurfs[0] ) );
+	rb_overdrawSurfs.SetNum( numDrawSurfs + interactions, false );
+	drawSurf_t **newDrawSurfs = rb_overdrawSurfs.Ptr();
 
 	for ( i = 0; i < numDrawSurfs; i++ ) {
 		surf = drawSurfs[i];
@@ -2382,4 +2387,5 @@ void RB_ShutdownDebugTools( void ) {
 	for ( int i = 0; i < MAX_DEBUG_POLYGONS; i++ ) {
 		rb_debugPolygons[i].winding.Clear();
 	}
+	rb_overdrawSurfs.Clear();
 }
@@ -126,27 +126,40 @@ If a high order bit is clear, the point is outside the plane (definately negativ
 //#define	LIGHT_CLIP_EPSILON	0.001f
 #define	LIGHT_CLIP_EPSILON		0.1f
 
+// shadow volumes are created on the job threads, so all of the
+// generation state is thread local, and the large buffers are
+// allocated for each thread on its first static shadow volume
+
 #define	MAX_CLIP_SIL_EDGES		2048
-static int	numClipSilEdges;
-static int	clipSilEdges[MAX_CLIP_SIL_EDGES][2];
+static ID_THREAD_LOCAL int	numClipSilEdges;
+static ID_THREAD_LOCAL int	(*clipSilEdges)[2];
 
 // facing will be 0 if forward facing, 1 if backwards facing
 // grabbed with alloca
-static byte	*globalFacing;
+static ID_THREAD_LOCAL byte	*globalFacing;
 
 // faceCastsShadow will be 1 if the face is in the projection
 // and facing the apropriate direction
-static byte	*faceCastsShadow;
+static ID_THREAD_LOCAL byte	*faceCastsShadow;
 
-static int	*remap;
+static ID_THREAD_LOCAL int	*remap;
 
 #define	MAX_SHADOW_INDEXES		0x18000
 #define	MAX_SHADOW_VERTS		0x18000
-static int	numShadowIndexes;
-static glIndex_t	shadowIndexes[MAX_SHADOW_INDEXES];
-static int	numShadowVerts;
-static idVec4	shadowVerts[MAX_SHADOW_VERTS];
-static bool overflowed;
+static ID_THREAD_LOCAL int	numShadowIndexes;
+static ID_THREAD_LOCAL glIndex_t	*shadowIndexes;
+static ID_THREAD_LOCAL int	numShadowVerts;
+static ID_THREAD_LOCAL idVec4	*shadowVerts;
+static ID_THREAD_LOCAL bool overflowed;
+
+typedef struct {
+	idVec4		verts[MAX_SHADOW_VERTS];
+	glIndex_t	indexes[MAX_SHADOW_INDEXES];
+	int			clipSilEdges[MAX_CLIP_SIL_EDGES][2];
+} shadowBuffers_t;
+
+// indexed by job thread, 0 is the main thread
+static shadowBuffers_t *	threadShadowBuffers[MAX_JOB_THREADS + 1];
 
 idPlane	pointLightFrustums[6][6] = {
 	{
@@ -201,9 +214,9 @@ idPlane	pointLightFrustums[6][6] = {
 	},
 };
 
-int	c_caps, c_sils;
+int	c_caps, c_sils;		// never printed, so they are not interlocked
 
-static bool	callOptimizer;			// call the preprocessor optimizer after clipping occluders
+static ID_THREAD_LOCAL bool	callOptimizer;			// call the preprocessor optimizer after clipping occluders
 
 typedef struct {
 	int		frontCapStart;
@@ -211,8 +224,8 @@ typedef struct {
 	int		silStart;
 	int		end;
 } indexRef_t;
-static indexRef_t	indexRef[6];
-static int indexFrustumNumber;		// which shadow generating side of a light the indexRef is for
+static ID_THREAD_LOCAL indexRef_t	indexRef[6];
+static ID_THREAD_LOCAL int indexFrustumNumber;		// which shadow generating side of a light the indexRef is for
 
 /*
 ===============
@@ -1190,31 +1203,43 @@ void R_MakeShadowFrustums( idRenderLightLocal *light ) {
 
 /*
 =================
-R_CreateShadowVolume
-
-The returned surface will have a valid bounds and radius for culling.
+R_BindShadowBuffers
 
-Triangles are clipped to the light frustum before projecting.
+Points the thread local buffers at the ones of the calling thread
+=================
+*/
+static void R_BindShadowBuffers( void ) {
+	int threadIndex = jobManager->GetThreadIndex();
 
-A single triangle can clip to as many as 7 vertexes, so
-the worst case expansion is 2*(numindexes/3)*7 verts when counting both
-the front and back caps, although it will usually only be a modest
-increase in vertexes for closed modesl
+	shadowBuffers_t *buffers = threadShadowBuffers[threadIndex];
+	if ( buffers == NULL ) {
+		buffers = (shadowBuffers_t *)Mem_Alloc16( sizeof( *buffers ) );
+		threadShadowBuffers[threadIndex] = buffers;
+	}
 
-The worst case index count is much larger, when the 7 vertex clipped triangle
-needs 15 indexes for the front, 15 for the back, and 42 (a quad on seven sides)
-for the sides, for a total of 72 indexes from the original 3.  Ouch.
+	shadowVerts = buffers->verts;
+	shadowIndexes = buffers->indexes;
+	clipSilEdges = buffers->clipSilEdges;
+}
 
-NULL may be returned if the surface doesn't create a shadow volume at all,
-as with a single face that the light is behind.
+/*
+=================
+R_ShutdownShadowBuffers
+=================
+*/
+void R_ShutdownShadowBuffers( void ) {
+	for ( int i = 0; i <= MAX_JOB_THREADS; i++ ) {
+		Mem_Free16( threadShadowBuffers[i] );
+		threadShadowBuffers[i] = NULL;
+	}
+}
 
-If an edge is within an epsilon of the border of the volume, it must be treated
-as if it is clipped for triangles, generating a new sil edge, and act
-as if it was culled for edges, because the sil edge will have been
-generated by the triangle irregardless of if it actually was a sil edge.
+/*
+=================
+R_CreateStaticShadowVolume
 =================
 */
-srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
+static srfTriangles_t *R_CreateStaticShadowVolume( const idRenderEntityLocal *ent,
 									 const srfTriangles_t *tri, const idRenderLightLocal *light,
 									 shadowGen_t optimize, srfCullInfo_t &cullInfo ) {
 	int		i, j;
@@ -1222,34 +1247,7 @@ srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
 	srfTriangles_t	*newTri;
 	int		capPlaneBits;
 
-	if ( !r_shadows.GetBool() ) {
-		return NULL;
-	}
-
-	if ( tri->numSilEdges == 0 || tri->numIndexes == 0 || tri->numVerts == 0 ) {
-		return NULL;
-	}
-
-	if ( tri->numIndexes < 0 ) {
-		common->Error( "R_CreateShadowVolume: tri->numIndexes = %i", tri->numIndexes );
-	}
-
-	if ( tri->numVerts < 0 ) {
-		common->Error( "R_CreateShadowVolume: tri->numVerts = %i", tri->numVerts );
-	}
-
-	tr.pc.c_createShadowVolumes++;
-
-	// use the fast infinite projection in dynamic situations, which
-	// trades somewhat more overdraw and no cap optimizations for
-	// a very simple generation process
-	if ( optimize == SG_DYNAMIC && r_useTurboShadow.GetBool() ) {
-		if ( tr.backEndRendererHasVertexPrograms && r_useShadowVertexProgram.GetBool() ) {
-			return R_CreateVertexProgramTurboShadowVolume( ent, tri, light, cullInfo );
-		} else {
-			return R_CreateTurboShadowVolume( ent, tri, light, cullInfo );
-		}
-	}
+	R_BindShadowBuffers();
 
 	R_CalcInteractionFacing( ent, tri, light, cullInfo );
 
@@ -1393,3 +1391,64 @@ srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
 
 	return newTri;
 }
+
+/*
+=================
+R_CreateShadowVolume
+
+The returned surface will have a valid bounds and radius for culling.
+
+Triangles are clipped to the light frustum before projecting.
+
+A single triangle can clip to as many as 7 vertexes, so
+the worst case expansion is 2*(numindexes/3)*7 verts when counting both
+the front and back caps, although it will usually only be a modest
+increase in vertexes for closed modesl
+
+The worst case index count is much larger, when the 7 vertex clipped triangle
+needs 15 indexes for the front, 15 for the back, and 42 (a quad on seven sides)
+for the sides, for a total of 72 indexes from the original 3.  Ouch.
+
+NULL may be returned if the surface doesn't create a shadow volume at all,
+as with a single face that the light is behind.
+
+If an edge is within an epsilon of the border of the volume, it must be treated
+as if it is clipped for triangles, generating a new sil edge, and act
+as if it was culled for edges, because the sil edge will have been
+generated by the triangle irregardless of if it actually was a sil edge.
+=================
+*/
+srfTriangles_t *R_CreateShadowVolume( const idRenderEntityLocal *ent,
+									 const srfTriangles_t *tri, const idRenderLightLocal *light,
+									 shadowGen_t optimize, srfCullInfo_t &cullInfo ) {
+	if ( !r_shadows.GetBool() ) {
+		return NULL;
+	}
+
+	if ( tri->numSilEdges == 0 || tri->numIndexes == 0 || tri->numVerts == 0 ) {
+		return NULL;
+	}
+
+	if ( tri->numIndexes < 0 ) {
+		common->Error( "R_CreateShadowVolume: tri->numIndexes = %i", tri->numIndexes );
+	}
+
+	if ( tri->numVerts < 0 ) {
+		common->Error( "R_CreateShadowVolume: tri->numVerts = %i", tri->numVerts );
+	}
+
+	Sys_InterlockedIncrement( tr.pc.c_createShadowVolumes );
+
+	// use the fast infinite projection in dynamic situations, which
+	// trades somewhat more overdraw and no cap optimizations for
+	// a very simple generation process
+	if ( optimize == SG_DYNAMIC && r_useTurboShadow.GetBool() ) {
+		if ( tr.backEndRendererHasVertexPrograms && r_useShadowVertexProgram.GetBool() ) {
+			return R_CreateVertexProgramTurboShadowVolume( ent, tri, light, cullInfo );
+		} else {
+			return R_CreateTurboShadowVolume( ent, tri, light, cullInfo );
+		}
+	}
+
+	return R_CreateStaticShadowVolume( ent, tri, light, optimize, cullInfo );
+}
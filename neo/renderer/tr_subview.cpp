@@ -465,10 +465,11 @@ bool	R_GenerateSurfaceSubview( drawSurf_t *drawSurf ) {
 	shader = drawSurf->material;
 
 	// never recurse through a subview surface that we are
-	// already seeing through
+	// already seeing through, the geo may be a frame copy
+	// with r_smp, so compare the vertexes
 	for ( parms = tr.viewDef ; parms ; parms = parms->superView ) {
 		if ( parms->subviewSurface
-			&& parms->subviewSurface->geo == drawSurf->geo
+			&& parms->subviewSurface->geo->verts == drawSurf->geo->verts
 			&& parms->subviewSurface->space->entityDef == drawSurf->space->entityDef ) {
 			break;
 		}
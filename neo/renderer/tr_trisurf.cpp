@@ -148,6 +148,31 @@ static idDynamicAlloc<int, 1<<16, 1<<10>				triMirroredVertAllocator;
 static idDynamicAlloc<int, 1<<16, 1<<10>				triDupVertAllocator;
 #endif
 
+// dynamic models are instantiated and interactions are created on the job threads,
+// so the allocations and frees of the static triangle surfaces are serialized;
+// the sil edge and tangent generation at load time still has to run on a single thread
+static volatile int		triSurfLock;
+
+/*
+===============
+R_LockTriSurfData
+===============
+*/
+static ID_INLINE void R_LockTriSurfData( void ) {
+	while ( Sys_InterlockedCompareExchange( triSurfLock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+}
+
+/*
+===============
+R_UnlockTriSurfData
+===============
+*/
+static ID_INLINE void R_UnlockTriSurfData( void ) {
+	Sys_InterlockedExchange( triSurfLock, 0 );
+}
+
 
 /*
 ===============
@@ -341,6 +366,7 @@ R_FreeStaticTriSurfVertexCaches
 ==============
 */
 void R_FreeStaticTriSurfVertexCaches( srfTriangles_t *tri ) {
+	R_LockTriSurfData();
 	if ( tri->ambientSurface == NULL ) {
 		// this is a real model surface
 		vertexCache.Free( tri->ambientCache );
@@ -362,6 +388,7 @@ void R_FreeStaticTriSurfVertexCaches( srfTriangles_t *tri ) {
 		vertexCache.Free( tri->shadowCache );
 		tri->shadowCache = NULL;
 	}
+	R_UnlockTriSurfData();
 }
 
 /*
@@ -378,6 +405,8 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 
 	R_FreeStaticTriSurfVertexCaches( tri );
 
+	R_LockTriSurfData();
+
 	if ( tri->verts != NULL ) {
 		// R_CreateLightTris points tri->verts at the verts of the ambient surface
 		if ( tri->ambientSurface == NULL || tri->verts != tri->ambientSurface->verts ) {
@@ -422,6 +451,8 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 #endif
 
 	srfTrianglesAllocator.Free( tri );
+
+	R_UnlockTriSurfData();
 }
 
 /*
@@ -506,12 +537,14 @@ void R_FreeStaticTriSurf( srfTriangles_t *tri ) {
 		R_CheckStaticTriSurfMemory( tri );
 #endif
 		tri->nextDeferredFree = NULL;
+		R_LockTriSurfData();
 		if ( frame->lastDeferredFreeTriSurf ) {
 			frame->lastDeferredFreeTriSurf->nextDeferredFree = tri;
 		} else {
 			frame->firstDeferredFreeTriSurf = tri;
 		}
 		frame->lastDeferredFreeTriSurf = tri;
+		R_UnlockTriSurfData();
 	}
 }
 
@@ -521,7 +554,9 @@ R_AllocStaticTriSurf
 ==============
 */
 srfTriangles_t *R_AllocStaticTriSurf( void ) {
+	R_LockTriSurfData();
 	srfTriangles_t *tris = srfTrianglesAllocator.Alloc();
+	R_UnlockTriSurfData();
 	memset( tris, 0, sizeof( srfTriangles_t ) );
 	return tris;
 }
@@ -554,7 +589,9 @@ R_AllocStaticTriSurfVerts
 */
 void R_AllocStaticTriSurfVerts( srfTriangles_t *tri, int numVerts ) {
 	assert( tri->verts == NULL );
+	R_LockTriSurfData();
 	tri->verts = triVertexAllocator.Alloc( numVerts );
+	R_UnlockTriSurfData();
 }
 
 /*
@@ -564,7 +601,9 @@ R_AllocStaticTriSurfIndexes
 */
 void R_AllocStaticTriSurfIndexes( srfTriangles_t *tri, int numIndexes ) {
 	assert( tri->indexes == NULL );
+	R_LockTriSurfData();
 	tri->indexes = triIndexAllocator.Alloc( numIndexes );
+	R_UnlockTriSurfData();
 }
 
 /*
@@ -574,7 +613,9 @@ R_AllocStaticTriSurfShadowVerts
 */
 void R_AllocStaticTriSurfShadowVerts( srfTriangles_t *tri, int numVerts ) {
 	assert( tri->shadowVertexes == NULL );
+	R_LockTriSurfData();
 	tri->shadowVertexes = triShadowVertexAllocator.Alloc( numVerts );
+	R_UnlockTriSurfData();
 }
 
 /*
@@ -583,10 +624,12 @@ R_AllocStaticTriSurfPlanes
 =================
 */
 void R_AllocStaticTriSurfPlanes( srfTriangles_t *tri, int numIndexes ) {
+	R_LockTriSurfData();
 	if ( tri->facePlanes ) {
 		triPlaneAllocator.Free( tri->facePlanes );
 	}
 	tri->facePlanes = triPlaneAllocator.Alloc( numIndexes / 3 );
+	R_UnlockTriSurfData();
 }
 
 /*
@@ -596,7 +639,9 @@ R_ResizeStaticTriSurfVerts
 */
 void R_ResizeStaticTriSurfVerts( srfTriangles_t *tri, int numVerts ) {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	R_LockTriSurfData();
 	tri->verts = triVertexAllocator.Resize( tri->verts, numVerts );
+	R_UnlockTriSurfData();
 #else
 	assert( false );
 #endif
@@ -609,7 +654,9 @@ R_ResizeStaticTriSurfIndexes
 */
 void R_ResizeStaticTriSurfIndexes( srfTriangles_t *tri, int numIndexes ) {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	R_LockTriSurfData();
 	tri->indexes = triIndexAllocator.Resize( tri->indexes, numIndexes );
+	R_UnlockTriSurfData();
 #else
 	assert( false );
 #endif
@@ -622,7 +669,9 @@ R_ResizeStaticTriSurfShadowVerts
 */
 void R_ResizeStaticTriSurfShadowVerts( srfTriangles_t *tri, int numVerts ) {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	R_LockTriSurfData();
 	tri->shadowVertexes = triShadowVertexAllocator.Resize( tri->shadowVertexes, numVerts );
+	R_UnlockTriSurfData();
 #else
 	assert( false );
 #endif
@@ -652,7 +701,9 @@ R_FreeStaticTriSurfSilIndexes
 =================
 */
 void R_FreeStaticTriSurfSilIndexes( srfTriangles_t *tri ) {
+	R_LockTriSurfData();
 	triSilIndexAllocator.Free( tri->silIndexes );
+	R_UnlockTriSurfData();
 	tri->silIndexes = NULL;
 }
 
@@ -1657,7 +1708,7 @@ void R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes ) {
 		return;
 	}
 
-	tr.pc.c_tangentIndexes += tri->numIndexes;
+	Sys_InterlockedAdd( tr.pc.c_tangentIndexes, tri->numIndexes );
 
 	if ( !tri->facePlanes && allocFacePlanes ) {
 		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
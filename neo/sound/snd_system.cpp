@@ -608,6 +608,8 @@ int idSoundSystemLocal::AsyncMix( int soundTime, float *mixBuffer ) {
 		return 0;
 	}
 
+	idProfileZone zone( "idSoundSystem::AsyncMix" );
+
 	inTime = Sys_Milliseconds();
 	numSpeakers = snd_audio_hw->GetNumberOfSpeakers();
 	
@@ -659,6 +661,8 @@ int idSoundSystemLocal::AsyncUpdate( int inTime ) {
 		return 0;
 	}
 
+	idProfileZone zone( "idSoundSystem::AsyncUpdate" );
+
 	// lock the buffer so we can actually write to it
 	short *fBlock = NULL;
 	ulong fBlockLen = 0;
@@ -755,6 +759,8 @@ int idSoundSystemLocal::AsyncUpdateWrite( int inTime ) {
 		return 0;
 	}
 
+	idProfileZone zone( "idSoundSystem::AsyncUpdateWrite" );
+
 	if ( !useOpenAL ) {
 		snd_audio_hw->Flush();
 	}
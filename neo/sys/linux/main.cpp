@@ -37,6 +37,10 @@ If you have questions concerning this license or the applicable additional terms
 #include <sys/types.h>
 #include <fcntl.h>
 
+#if defined( __i386__ ) || defined( __x86_64__ )
+#include <cpuid.h>
+#endif
+
 #ifdef ID_MCHECK
 #include <mcheck.h>
 #endif
@@ -201,13 +205,91 @@ void Sys_Shutdown( void ) {
 	Posix_Shutdown();
 }
 
+#if defined( __i386__ ) || defined( __x86_64__ )
+
+/*
+===============
+Sys_XGetBV
+
+  reads XCR0 to see which register states the operating system saves
+===============
+*/
+static unsigned int Sys_XGetBV( void ) {
+	unsigned int eax, edx;
+	// xgetbv, not all assemblers know the mnemonic
+	__asm__ __volatile__( ".byte 0x0f, 0x01, 0xd0" : "=a" ( eax ), "=d" ( edx ) : "c" ( 0 ) );
+	return eax;
+}
+
+#endif
+
 /*
 ===============
 Sys_GetProcessorId
 ===============
 */
 cpuid_t Sys_GetProcessorId( void ) {
+#if defined( __i386__ ) || defined( __x86_64__ )
+	static int flags = CPUID_NONE;
+	unsigned int eax, ebx, ecx, edx, maxLeaf;
+
+	if ( flags != CPUID_NONE ) {
+		return (cpuid_t)flags;
+	}
+
+	if ( !__get_cpuid( 0, &maxLeaf, &ebx, &ecx, &edx ) ) {
+		flags = CPUID_UNSUPPORTED;
+		return (cpuid_t)flags;
+	}
+
+	// "AuthenticAMD"
+	if ( ebx == 0x68747541 ) {
+		flags = CPUID_AMD;
+	} else {
+		flags = CPUID_INTEL;
+	}
+
+	__get_cpuid( 1, &eax, &ebx, &ecx, &edx );
+
+	if ( edx & ( 1 << 23 ) ) {
+		flags |= CPUID_MMX;
+	}
+	if ( edx & ( 1 << 25 ) ) {
+		flags |= CPUID_SSE;
+	}
+	if ( edx & ( 1 << 26 ) ) {
+		flags |= CPUID_SSE2;
+	}
+	if ( ecx & ( 1 << 0 ) ) {
+		flags |= CPUID_SSE3;
+	}
+	if ( edx & ( 1 << 15 ) ) {
+		flags |= CPUID_CMOV;
+	}
+
+	// AVX2 and FMA3 also need the operating system to save the YMM registers
+	const bool avxState = ( ecx & ( 1 << 27 ) ) && ( ecx & ( 1 << 28 ) ) && ( Sys_XGetBV() & 6 ) == 6;
+
+	if ( avxState && ( ecx & ( 1 << 12 ) ) ) {
+		flags |= CPUID_FMA3;
+	}
+	if ( avxState && maxLeaf >= 7 ) {
+		__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+		if ( ebx & ( 1 << 5 ) ) {
+			flags |= CPUID_AVX2;
+		}
+	}
+
+	if ( __get_cpuid( 0x80000001, &eax, &ebx, &ecx, &edx ) && ( edx & ( 1 << 31 ) ) ) {
+		flags |= CPUID_3DNOW;
+	}
+
+	// FTZ and DAZ are not reported, Sys_FPU_SetFTZ and Sys_FPU_SetDAZ are not implemented here
+
+	return (cpuid_t)flags;
+#else
 	return CPUID_GENERIC;
+#endif
 }
 
 /*
@@ -216,7 +298,52 @@ Sys_GetProcessorString
 ===============
 */
 const char *Sys_GetProcessorString( void ) {
-	return "generic";
+	static char processorString[256];
+	idStr string;
+
+	if ( processorString[0] ) {
+		return processorString;
+	}
+
+	cpuid_t cpuid = Sys_GetProcessorId();
+
+	if ( cpuid & CPUID_AMD ) {
+		string += "AMD CPU";
+	} else if ( cpuid & CPUID_INTEL ) {
+		string += "Intel CPU";
+	} else if ( cpuid & CPUID_UNSUPPORTED ) {
+		string += "unsupported CPU";
+	} else {
+		string += "generic CPU";
+	}
+
+	string += " with ";
+	if ( cpuid & CPUID_MMX ) {
+		string += "MMX & ";
+	}
+	if ( cpuid & CPUID_3DNOW ) {
+		string += "3DNow! & ";
+	}
+	if ( cpuid & CPUID_SSE ) {
+		string += "SSE & ";
+	}
+	if ( cpuid & CPUID_SSE2 ) {
+		string += "SSE2 & ";
+	}
+	if ( cpuid & CPUID_SSE3 ) {
+		string += "SSE3 & ";
+	}
+	if ( cpuid & CPUID_AVX2 ) {
+		string += "AVX2 & ";
+	}
+	if ( cpuid & CPUID_FMA3 ) {
+		string += "FMA3 & ";
+	}
+	string.StripTrailing( " & " );
+	string.StripTrailing( " with " );
+
+	idStr::Copynz( processorString, string.c_str(), sizeof( processorString ) );
+	return processorString;
 }
 
 /*
@@ -436,6 +436,28 @@ long Sys_FileTimeStamp(FILE * fp) {
 	return st.st_mtime;
 }
 
+/*
+================
+Sys_MapFile
+================
+*/
+const void *Sys_MapFile( FILE *fp, int length ) {
+	void *data = mmap( NULL, length, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+	if ( data == MAP_FAILED ) {
+		return NULL;
+	}
+	return data;
+}
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+	munmap( const_cast<void *>( data ), length );
+}
+
 void Sys_Sleep(int msec) {
 	if ( msec < 20 ) {
 		static int last = 0;
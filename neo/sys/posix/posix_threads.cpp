@@ -142,6 +142,102 @@ void Sys_TriggerEvent( int index ) {
 	Sys_LeaveCriticalSection( MAX_LOCAL_CRITICAL_SECTIONS - 1 );
 }
 
+/*
+======================================================
+signals
+every signal has its own lock and condition, they are used by the job workers
+which would contend on the single lock of the trigger events
+======================================================
+*/
+
+struct xsignal_s {
+	pthread_mutex_t		mutex;
+	pthread_cond_t		cond;
+	bool				signaled;
+};
+
+/*
+==================
+Sys_CreateSignal
+==================
+*/
+xsignalHandle Sys_CreateSignal( void ) {
+	xsignalHandle signal = new xsignal_s;
+	pthread_mutex_init( &signal->mutex, NULL );
+	pthread_cond_init( &signal->cond, NULL );
+	signal->signaled = false;
+	return signal;
+}
+
+/*
+==================
+Sys_DestroySignal
+==================
+*/
+void Sys_DestroySignal( xsignalHandle signal ) {
+	pthread_cond_destroy( &signal->cond );
+	pthread_mutex_destroy( &signal->mutex );
+	delete signal;
+}
+
+/*
+==================
+Sys_RaiseSignal
+==================
+*/
+void Sys_RaiseSignal( xsignalHandle signal ) {
+	pthread_mutex_lock( &signal->mutex );
+	signal->signaled = true;
+	pthread_cond_signal( &signal->cond );
+	pthread_mutex_unlock( &signal->mutex );
+}
+
+/*
+==================
+Sys_WaitForSignal
+==================
+*/
+bool Sys_WaitForSignal( xsignalHandle signal, int timeout ) {
+	pthread_mutex_lock( &signal->mutex );
+	if ( timeout < 0 ) {
+		while ( !signal->signaled ) {
+			pthread_cond_wait( &signal->cond, &signal->mutex );
+		}
+	} else if ( !signal->signaled ) {
+		struct timeval now;
+		struct timespec abstime;
+		gettimeofday( &now, NULL );
+		abstime.tv_sec = now.tv_sec + timeout / 1000;
+		abstime.tv_nsec = ( now.tv_usec + ( timeout % 1000 ) * 1000 ) * 1000;
+		if ( abstime.tv_nsec >= 1000000000 ) {
+			abstime.tv_sec++;
+			abstime.tv_nsec -= 1000000000;
+		}
+		while ( !signal->signaled ) {
+			if ( pthread_cond_timedwait( &signal->cond, &signal->mutex, &abstime ) == ETIMEDOUT ) {
+				break;
+			}
+		}
+	}
+	bool signaled = signal->signaled;
+	signal->signaled = false;
+	pthread_mutex_unlock( &signal->mutex );
+	return signaled;
+}
+
+/*
+==================
+Sys_GetProcessorCount
+==================
+*/
+int Sys_GetProcessorCount( void ) {
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	if ( count < 1 ) {
+		return 1;
+	}
+	return (int)count;
+}
+
 /*
 ======================================================
 thread create and destroy
@@ -149,7 +245,6 @@ thread create and destroy
 */
 
 // not a hard limit, just what we keep track of for debugging
-#define MAX_THREADS 10
 xthreadInfo *g_threads[MAX_THREADS];
 
 int g_thread_count = 0;
@@ -0,0 +1,913 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+idCVar sys_jobThreads( "sys_jobThreads", "0", CVAR_SYSTEM | CVAR_INTEGER | CVAR_INIT, "number of job worker threads, 0 = one less than the number of cores, -1 = run all jobs on the waiting threads", -1, MAX_JOB_THREADS );
+
+class idJobListLocal;
+class idJobManagerLocal;
+
+typedef struct job_s {
+	jobRun_t				function;
+	void *					data;
+	idJobListLocal *		list;
+} job_t;
+
+typedef enum {
+	JOBLIST_IDLE,							// being filled
+	JOBLIST_WAITING,						// submitted, waiting for dependencies
+	JOBLIST_RUNNING,
+	JOBLIST_DONE
+} jobListState_t;
+
+// accumulated in microseconds so the counters can be updated with interlocked adds
+typedef struct jobThreadStats_s {
+	volatile int			jobs;
+	volatile int			steals;
+	volatile int			busyTime;		// running jobs
+	volatile int			waitTime;		// sleeping or blocked in idJobList::Wait
+} jobThreadStats_t;
+
+static ID_THREAD_LOCAL int	job_threadIndex = 0;
+
+/*
+===============================================================================
+
+	idJobQueue
+
+	Job queue owned by a worker thread. The owner pops the most recently
+	added job, other threads steal the oldest one.
+
+===============================================================================
+*/
+
+class idJobQueue {
+public:
+							idJobQueue( void );
+
+	void					Push( job_t *job );
+	job_t *					Pop( void );
+	job_t *					Steal( void );
+	bool					IsEmpty( void ) const { return numJobs == 0; }
+
+private:
+	volatile int			lock;
+	volatile int			numJobs;		// mirrors the list size so IsEmpty can peek without locking
+	int						first;
+	idList<job_t *>			jobs;
+
+	void					Lock( void );
+	void					Unlock( void );
+};
+
+/*
+================
+idJobQueue::idJobQueue
+================
+*/
+idJobQueue::idJobQueue( void ) {
+	lock = 0;
+	numJobs = 0;
+	first = 0;
+	jobs.SetGranularity( 256 );
+}
+
+/*
+================
+idJobQueue::Lock
+================
+*/
+ID_INLINE void idJobQueue::Lock( void ) {
+	while ( Sys_InterlockedCompareExchange( lock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+}
+
+/*
+================
+idJobQueue::Unlock
+================
+*/
+ID_INLINE void idJobQueue::Unlock( void ) {
+	Sys_InterlockedExchange( lock, 0 );
+}
+
+/*
+================
+idJobQueue::Push
+================
+*/
+void idJobQueue::Push( job_t *job ) {
+	Lock();
+	jobs.Append( job );
+	Sys_InterlockedIncrement( numJobs );
+	Unlock();
+}
+
+/*
+================
+idJobQueue::Pop
+================
+*/
+job_t *idJobQueue::Pop( void ) {
+	job_t *job = NULL;
+	Lock();
+	if ( first < jobs.Num() ) {
+		job = jobs[jobs.Num() - 1];
+		jobs.SetNum( jobs.Num() - 1, false );
+		Sys_InterlockedDecrement( numJobs );
+		if ( first >= jobs.Num() ) {
+			jobs.SetNum( 0, false );
+			first = 0;
+		}
+	}
+	Unlock();
+	return job;
+}
+
+/*
+================
+idJobQueue::Steal
+================
+*/
+job_t *idJobQueue::Steal( void ) {
+	job_t *job = NULL;
+	Lock();
+	if ( first < jobs.Num() ) {
+		job = jobs[first++];
+		Sys_InterlockedDecrement( numJobs );
+		if ( first >= jobs.Num() ) {
+			jobs.SetNum( 0, false );
+			first = 0;
+		}
+	}
+	Unlock();
+	return job;
+}
+
+/*
+===============================================================================
+
+	idJobListLocal
+
+===============================================================================
+*/
+
+class idJobListLocal : public idJobList {
+	friend class idJobManagerLocal;
+public:
+							idJobListLocal( idJobManagerLocal *manager, const char *name );
+	virtual					~idJobListLocal( void );
+
+	virtual const char *	GetName( void ) const { return name.c_str(); }
+
+	virtual void			Clear( void );
+	virtual void			AddJob( jobRun_t function, void *data );
+	virtual int				NumJobs( void ) const { return jobs.Num(); }
+	virtual void			AddDependency( idJobList *list );
+
+	virtual void			Submit( void );
+	virtual void			Wait( void );
+	virtual bool			IsSubmitted( void ) const { return state != JOBLIST_IDLE; }
+	virtual bool			IsDone( void ) const { return IsFinished(); }
+
+private:
+	idJobManagerLocal *		manager;
+	idStr					name;
+	idList<job_t>			jobs;
+	idList<idJobListLocal *> dependencies;
+	idList<idJobListLocal *> dependents;	// lists waiting for this one, guarded by the manager lock
+
+	volatile int			state;
+	volatile int			numPendingDependencies;
+	volatile int			numRemainingJobs;
+	xsignalHandle			doneSignal;
+
+	// interlocked read so the results of the jobs are visible once the list is seen as done
+	bool					IsFinished( void ) const { return Sys_InterlockedCompareExchange( const_cast<volatile int &>( state ), JOBLIST_DONE, JOBLIST_DONE ) == JOBLIST_DONE; }
+
+	// statistics
+	int						numSubmits;
+	double					submitTime;
+	double					startTime;
+	int						lastRunTime;	// microseconds from start to completion
+	int						lastWaitTime;	// microseconds spent blocked in Wait
+};
+
+/*
+===============================================================================
+
+	idJobManagerLocal
+
+===============================================================================
+*/
+
+typedef struct jobThread_s {
+	idJobManagerLocal *		manager;
+	int						index;
+	xthreadInfo				threadInfo;
+	xsignalHandle			wakeSignal;
+	volatile int			sleeping;
+	volatile int			exited;
+	char					name[16];
+} jobThread_t;
+
+typedef struct parallelForJob_s {
+	parallelForRun_t		function;
+	void *					data;
+	int						first;
+	int						last;
+} parallelForJob_t;
+
+typedef struct parallelForList_s {
+	idJobListLocal *		list;
+	idList<parallelForJob_t> ranges;
+} parallelForList_t;
+
+class idJobManagerLocal : public idJobManager {
+	friend class idJobListLocal;
+public:
+							idJobManagerLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+
+	virtual idJobList *		AllocJobList( const char *name );
+	virtual void			FreeJobList( idJobList *list );
+
+	virtual void			ParallelFor( const char *name, int count, int granularity, parallelForRun_t function, void *data );
+
+	virtual int				GetNumThreads( void ) const { return numThreads; }
+	virtual int				GetThreadIndex( void ) const { return job_threadIndex; }
+
+	void					ListJobs( void );
+	void					PrintStats( void );
+
+private:
+	bool					initialized;
+	volatile bool			shutdown;
+	volatile int			lock;
+
+	int						numThreads;
+	jobThread_t				threads[MAX_JOB_THREADS];
+	idJobQueue				queues[MAX_JOB_THREADS];	// queue 0 is used when there are no worker threads
+	int						numQueues;
+	volatile int			nextQueue;
+	volatile int			numQueuedJobs;
+
+	// index 0 accumulates all threads that are not workers
+	jobThreadStats_t		stats[MAX_JOB_THREADS + 1];
+	double					statsStartTime;
+
+	idList<idJobListLocal *> jobLists;
+	idList<parallelForList_t *> freeParallelLists;
+
+	void					Lock( void );
+	void					Unlock( void );
+
+	void					StartList( idJobListLocal *list );
+	void					FinishList( idJobListLocal *list );
+	job_t *					FindJob( int threadIndex, bool &stolen );
+	void					WakeThreads( int count );
+	void					RunJob( job_t *job, int threadIndex );
+	void					AddStatsTime( volatile int &time, double startTicks );
+
+	static unsigned int		WorkerThread( void *parm );
+	static void				ParallelForJob( void *data );
+
+	static void				ListJobs_f( const idCmdArgs &args );
+	static void				JobStats_f( const idCmdArgs &args );
+};
+
+idJobManagerLocal			jobManagerLocal;
+idJobManager *				jobManager = &jobManagerLocal;
+
+/*
+================
+idJobListLocal::idJobListLocal
+================
+*/
+idJobListLocal::idJobListLocal( idJobManagerLocal *manager, const char *name ) {
+	this->manager = manager;
+	this->name = name;
+	state = JOBLIST_IDLE;
+	numPendingDependencies = 0;
+	numRemainingJobs = 0;
+	doneSignal = Sys_CreateSignal();
+	numSubmits = 0;
+	submitTime = 0.0;
+	startTime = 0.0;
+	lastRunTime = 0;
+	lastWaitTime = 0;
+}
+
+/*
+================
+idJobListLocal::~idJobListLocal
+================
+*/
+idJobListLocal::~idJobListLocal( void ) {
+	assert( state != JOBLIST_WAITING && state != JOBLIST_RUNNING );
+	Sys_DestroySignal( doneSignal );
+}
+
+/*
+================
+idJobListLocal::Clear
+================
+*/
+void idJobListLocal::Clear( void ) {
+	assert( state != JOBLIST_WAITING && state != JOBLIST_RUNNING );
+	jobs.SetNum( 0, false );
+	dependencies.SetNum( 0, false );
+	state = JOBLIST_IDLE;
+}
+
+/*
+================
+idJobListLocal::AddJob
+================
+*/
+void idJobListLocal::AddJob( jobRun_t function, void *data ) {
+	assert( state != JOBLIST_WAITING && state != JOBLIST_RUNNING );
+	job_t &job = jobs.Alloc();
+	job.function = function;
+	job.data = data;
+	job.list = this;
+}
+
+/*
+================
+idJobListLocal::AddDependency
+================
+*/
+void idJobListLocal::AddDependency( idJobList *list ) {
+	assert( state != JOBLIST_WAITING && state != JOBLIST_RUNNING );
+	assert( list != this );
+	dependencies.AddUnique( static_cast<idJobListLocal *>( list ) );
+}
+
+/*
+================
+idJobListLocal::Submit
+================
+*/
+void idJobListLocal::Submit( void ) {
+	assert( state != JOBLIST_WAITING && state != JOBLIST_RUNNING );
+
+	numSubmits++;
+	submitTime = Sys_GetClockTicks();
+	lastWaitTime = 0;
+	numRemainingJobs = jobs.Num();
+
+	// the manager lock keeps the dependencies from completing while they are checked
+	manager->Lock();
+	int numPending = 0;
+	for ( int i = 0; i < dependencies.Num(); i++ ) {
+		if ( dependencies[i]->state != JOBLIST_DONE ) {
+			dependencies[i]->dependents.Append( this );
+			numPending++;
+		}
+	}
+	numPendingDependencies = numPending;
+	state = ( numPending != 0 ) ? JOBLIST_WAITING : JOBLIST_RUNNING;
+	manager->Unlock();
+
+	if ( numPending == 0 ) {
+		manager->StartList( this );
+	}
+}
+
+/*
+================
+idJobListLocal::Wait
+================
+*/
+void idJobListLocal::Wait( void ) {
+	assert( state != JOBLIST_IDLE );
+
+	int threadIndex = job_threadIndex;
+	jobThreadStats_t &stats = manager->stats[threadIndex];
+
+	while ( !IsFinished() ) {
+		bool stolen;
+		job_t *job = manager->FindJob( threadIndex, stolen );
+		if ( job != NULL ) {
+			if ( stolen ) {
+				Sys_InterlockedIncrement( stats.steals );
+			}
+			manager->RunJob( job, threadIndex );
+			continue;
+		}
+		// the timeout covers other threads waiting for the same list
+		double waitStart = Sys_GetClockTicks();
+		Sys_WaitForSignal( doneSignal, 1 );
+		int waitTime = idMath::FtoiFast( ( Sys_GetClockTicks() - waitStart ) * 1000000.0 / Sys_ClockTicksPerSecond() );
+		Sys_InterlockedAdd( stats.waitTime, waitTime );
+		lastWaitTime += waitTime;
+	}
+}
+
+/*
+================
+idJobManagerLocal::idJobManagerLocal
+================
+*/
+idJobManagerLocal::idJobManagerLocal( void ) {
+	initialized = false;
+	shutdown = false;
+	lock = 0;
+	numThreads = 0;
+	numQueues = 1;
+	nextQueue = 0;
+	numQueuedJobs = 0;
+	memset( stats, 0, sizeof( stats ) );
+	statsStartTime = 0.0;
+}
+
+/*
+================
+idJobManagerLocal::Lock
+================
+*/
+ID_INLINE void idJobManagerLocal::Lock( void ) {
+	while ( Sys_InterlockedCompareExchange( lock, 0, 1 ) != 0 ) {
+		Sys_SpinPause();
+	}
+}
+
+/*
+================
+idJobManagerLocal::Unlock
+================
+*/
+ID_INLINE void idJobManagerLocal::Unlock( void ) {
+	Sys_InterlockedExchange( lock, 0 );
+}
+
+/*
+================
+idJobManagerLocal::Init
+================
+*/
+void idJobManagerLocal::Init( void ) {
+	if ( initialized ) {
+		return;
+	}
+
+	int numCores = Sys_GetProcessorCount();
+
+	numThreads = sys_jobThreads.GetInteger();
+	if ( numThreads == 0 ) {
+		numThreads = numCores - 1;
+	}
+	numThreads = idMath::ClampInt( 0, MAX_JOB_THREADS, numThreads );
+	// the workers are registered in g_threads with the engine threads
+	assert( MAX_THREADS >= MAX_JOB_THREADS + 10 );
+	numQueues = Max( numThreads, 1 );
+
+	shutdown = false;
+	memset( stats, 0, sizeof( stats ) );
+	statsStartTime = Sys_GetClockTicks();
+
+	for ( int i = 0; i < numThreads; i++ ) {
+		jobThread_t &thread = threads[i];
+		thread.manager = this;
+		thread.index = i + 1;
+		thread.wakeSignal = Sys_CreateSignal();
+		thread.sleeping = 0;
+		thread.exited = 0;
+		sprintf( thread.name, "JobWorker%d", i + 1 );
+		Sys_CreateThread( (xthread_t)WorkerThread, &thread, THREAD_NORMAL, thread.threadInfo, thread.name, g_threads, &g_thread_count );
+	}
+
+	cmdSystem->AddCommand( "listJobs", ListJobs_f, CMD_FL_SYSTEM, "lists the job lists" );
+	cmdSystem->AddCommand( "jobStats", JobStats_f, CMD_FL_SYSTEM, "shows job worker utilization since the last jobStats" );
+
+	initialized = true;
+
+	common->Printf( "job system: %d worker threads on %d cores\n", numThreads, numCores );
+}
+
+/*
+================
+idJobManagerLocal::Shutdown
+================
+*/
+void idJobManagerLocal::Shutdown( void ) {
+	int i;
+
+	if ( !initialized ) {
+		return;
+	}
+
+	cmdSystem->RemoveCommand( "listJobs" );
+	cmdSystem->RemoveCommand( "jobStats" );
+
+	// let the workers leave their loop before the threads are destroyed
+	shutdown = true;
+	for ( i = 0; i < numThreads; i++ ) {
+		while ( !threads[i].exited ) {
+			Sys_RaiseSignal( threads[i].wakeSignal );
+			Sys_Sleep( 1 );
+		}
+		Sys_DestroyThread( threads[i].threadInfo );
+		Sys_DestroySignal( threads[i].wakeSignal );
+	}
+	numThreads = 0;
+	numQueues = 1;
+
+	for ( i = 0; i < freeParallelLists.Num(); i++ ) {
+		delete freeParallelLists[i];
+	}
+	freeParallelLists.Clear();
+	jobLists.DeleteContents( true );
+
+	initialized = false;
+}
+
+/*
+================
+idJobManagerLocal::AllocJobList
+================
+*/
+idJobList *idJobManagerLocal::AllocJobList( const char *name ) {
+	idJobListLocal *list = new idJobListLocal( this, name );
+	Lock();
+	jobLists.Append( list );
+	Unlock();
+	return list;
+}
+
+/*
+================
+idJobManagerLocal::FreeJobList
+================
+*/
+void idJobManagerLocal::FreeJobList( idJobList *list ) {
+	if ( list == NULL ) {
+		return;
+	}
+	if ( list->IsSubmitted() ) {
+		list->Wait();
+	}
+	Lock();
+	jobLists.Remove( static_cast<idJobListLocal *>( list ) );
+	Unlock();
+	delete list;
+}
+
+/*
+================
+idJobManagerLocal::StartList
+
+  spreads the jobs over the worker queues
+================
+*/
+void idJobManagerLocal::StartList( idJobListLocal *list ) {
+	int numJobs = list->jobs.Num();
+
+	list->startTime = Sys_GetClockTicks();
+
+	if ( numJobs == 0 ) {
+		FinishList( list );
+		return;
+	}
+
+	Sys_InterlockedAdd( numQueuedJobs, numJobs );
+
+	int queue = ( Sys_InterlockedIncrement( nextQueue ) & 0x7fffffff ) % numQueues;
+	for ( int i = 0; i < numJobs; i++ ) {
+		queues[queue].Push( &list->jobs[i] );
+		queue = ( queue + 1 ) % numQueues;
+	}
+
+	WakeThreads( numJobs );
+}
+
+/*
+================
+idJobManagerLocal::WakeThreads
+
+  wakes up to count sleeping workers, busy workers find the new jobs by themselves
+================
+*/
+void idJobManagerLocal::WakeThreads( int count ) {
+	for ( int i = 0; i < numThreads && count > 0; i++ ) {
+		if ( threads[i].sleeping && Sys_InterlockedExchange( threads[i].sleeping, 0 ) != 0 ) {
+			Sys_RaiseSignal( threads[i].wakeSignal );
+			count--;
+		}
+	}
+}
+
+/*
+================
+idJobManagerLocal::FinishList
+
+  starts the lists that were only waiting for this list
+================
+*/
+void idJobManagerLocal::FinishList( idJobListLocal *list ) {
+	idJobListLocal *dependents[16];
+	idList<idJobListLocal *> moreDependents;
+	int numDependents;
+
+	list->lastRunTime = idMath::FtoiFast( ( Sys_GetClockTicks() - list->startTime ) * 1000000.0 / Sys_ClockTicksPerSecond() );
+
+	Lock();
+	numDependents = list->dependents.Num();
+	if ( numDependents <= 16 ) {
+		memcpy( dependents, list->dependents.Ptr(), numDependents * sizeof( dependents[0] ) );
+	} else {
+		moreDependents = list->dependents;
+	}
+	list->dependents.SetNum( 0, false );
+	Sys_InterlockedExchange( list->state, JOBLIST_DONE );
+	// the list may be cleared or freed by a waiting thread once the lock is released
+	Sys_RaiseSignal( list->doneSignal );
+	Unlock();
+
+	idJobListLocal **start = ( numDependents <= 16 ) ? dependents : moreDependents.Ptr();
+	for ( int i = 0; i < numDependents; i++ ) {
+		if ( Sys_InterlockedDecrement( start[i]->numPendingDependencies ) == 0 ) {
+			Sys_InterlockedExchange( start[i]->state, JOBLIST_RUNNING );
+			StartList( start[i] );
+		}
+	}
+}
+
+/*
+================
+idJobManagerLocal::FindJob
+================
+*/
+job_t *idJobManagerLocal::FindJob( int threadIndex, bool &stolen ) {
+	job_t *job;
+	int own = threadIndex - 1;
+
+	if ( own >= 0 ) {
+		job = queues[own].Pop();
+		if ( job != NULL ) {
+			Sys_InterlockedDecrement( numQueuedJobs );
+			stolen = false;
+			return job;
+		}
+	}
+
+	stolen = true;
+	for ( int i = 1; i <= numQueues; i++ ) {
+		int victim = ( own + i + numQueues ) % numQueues;
+		if ( victim == own || queues[victim].IsEmpty() ) {
+			continue;
+		}
+		job = queues[victim].Steal();
+		if ( job != NULL ) {
+			Sys_InterlockedDecrement( numQueuedJobs );
+			return job;
+		}
+	}
+	return NULL;
+}
+
+/*
+================
+idJobManagerLocal::AddStatsTime
+================
+*/
+ID_INLINE void idJobManagerLocal::AddStatsTime( volatile int &time, double startTicks ) {
+	Sys_InterlockedAdd( time, idMath::FtoiFast( ( Sys_GetClockTicks() - startTicks ) * 1000000.0 / Sys_ClockTicksPerSecond() ) );
+}
+
+/*
+================
+idJobManagerLocal::RunJob
+================
+*/
+void idJobManagerLocal::RunJob( job_t *job, int threadIndex ) {
+	idJobListLocal *list = job->list;
+	double start = Sys_GetClockTicks();
+
+	job->function( job->data );
+
+	AddStatsTime( stats[threadIndex].busyTime, start );
+	Sys_InterlockedIncrement( stats[threadIndex].jobs );
+
+	if ( Sys_InterlockedDecrement( list->numRemainingJobs ) == 0 ) {
+		FinishList( list );
+	}
+}
+
+/*
+================
+idJobManagerLocal::WorkerThread
+================
+*/
+unsigned int idJobManagerLocal::WorkerThread( void *parm ) {
+	jobThread_t *thread = (jobThread_t *)parm;
+	idJobManagerLocal *manager = thread->manager;
+	jobThreadStats_t &stats = manager->stats[thread->index];
+
+	job_threadIndex = thread->index;
+	profiler->SetThreadName( thread->name );
+
+	while ( !manager->shutdown ) {
+		bool stolen;
+		job_t *job = manager->FindJob( thread->index, stolen );
+		if ( job == NULL ) {
+			// spin a little before going to sleep, jobs often come in bursts
+			for ( int i = 0; i < 64 && job == NULL; i++ ) {
+				Sys_SpinPause();
+				job = manager->FindJob( thread->index, stolen );
+			}
+		}
+		if ( job == NULL ) {
+			// check once more after announcing the sleep so a job queued in between is not missed
+			Sys_InterlockedExchange( thread->sleeping, 1 );
+			job = manager->FindJob( thread->index, stolen );
+			if ( job == NULL ) {
+				double waitStart = Sys_GetClockTicks();
+				Sys_WaitForSignal( thread->wakeSignal );
+				manager->AddStatsTime( stats.waitTime, waitStart );
+				Sys_InterlockedExchange( thread->sleeping, 0 );
+				continue;
+			}
+			Sys_InterlockedExchange( thread->sleeping, 0 );
+		}
+		// get more workers going while there are jobs left in the queues
+		if ( manager->numQueuedJobs > 0 ) {
+			manager->WakeThreads( 1 );
+		}
+		if ( stolen ) {
+			Sys_InterlockedIncrement( stats.steals );
+		}
+		manager->RunJob( job, thread->index );
+	}
+
+	thread->exited = 1;
+	return 0;
+}
+
+/*
+================
+idJobManagerLocal::ParallelForJob
+================
+*/
+void idJobManagerLocal::ParallelForJob( void *data ) {
+	parallelForJob_t *range = (parallelForJob_t *)data;
+	range->function( range->data, range->first, range->last );
+}
+
+/*
+================
+idJobManagerLocal::ParallelFor
+================
+*/
+void idJobManagerLocal::ParallelFor( const char *name, int count, int granularity, parallelForRun_t function, void *data ) {
+	if ( count <= 0 ) {
+		return;
+	}
+	if ( granularity <= 0 ) {
+		granularity = Max( 1, ( count + numThreads ) / ( numThreads + 1 ) );
+	}
+	int numRanges = ( count + granularity - 1 ) / granularity;
+	if ( numRanges <= 1 || !initialized ) {
+		function( data, 0, count );
+		return;
+	}
+
+	// lists are recycled so a parallel for does not allocate
+	parallelForList_t *pf = NULL;
+	Lock();
+	if ( freeParallelLists.Num() ) {
+		pf = freeParallelLists[freeParallelLists.Num() - 1];
+		freeParallelLists.SetNum( freeParallelLists.Num() - 1, false );
+	}
+	Unlock();
+	if ( pf == NULL ) {
+		pf = new parallelForList_t;
+		pf->list = static_cast<idJobListLocal *>( AllocJobList( name ) );
+	}
+
+	pf->list->name = name;
+	pf->list->Clear();
+	pf->ranges.SetNum( numRanges, false );
+	for ( int i = 0; i < numRanges; i++ ) {
+		parallelForJob_t &range = pf->ranges[i];
+		range.function = function;
+		range.data = data;
+		range.first = i * granularity;
+		range.last = Min( range.first + granularity, count );
+		pf->list->AddJob( ParallelForJob, &range );
+	}
+	pf->list->Submit();
+	pf->list->Wait();
+
+	Lock();
+	freeParallelLists.Append( pf );
+	Unlock();
+}
+
+/*
+================
+idJobManagerLocal::ListJobs
+================
+*/
+void idJobManagerLocal::ListJobs( void ) {
+	static const char *stateNames[] = { "idle", "waiting", "running", "done" };
+
+	common->Printf( "state    jobs deps submits   run ms  wait ms name\n" );
+	common->Printf( "------- ----- ---- ------- -------- -------- ----\n" );
+
+	Lock();
+	for ( int i = 0; i < jobLists.Num(); i++ ) {
+		const idJobListLocal *list = jobLists[i];
+		common->Printf( "%-7s %5d %4d %7d %8.3f %8.3f %s\n", stateNames[list->state], list->jobs.Num(), list->dependencies.Num(),
+						list->numSubmits, list->lastRunTime * 0.001f, list->lastWaitTime * 0.001f, list->name.c_str() );
+	}
+	common->Printf( "%d job lists, %d worker threads\n", jobLists.Num(), numThreads );
+	Unlock();
+}
+
+/*
+================
+idJobManagerLocal::PrintStats
+================
+*/
+void idJobManagerLocal::PrintStats( void ) {
+	double now = Sys_GetClockTicks();
+	float elapsed = (float)( ( now - statsStartTime ) * 1000000.0 / Sys_ClockTicksPerSecond() );
+
+	if ( elapsed <= 0.0f ) {
+		return;
+	}
+
+	common->Printf( "thread          jobs  steals  busy ms  wait ms  util\n" );
+	common->Printf( "------------ ------- ------- -------- -------- -----\n" );
+
+	int totalJobs = 0;
+	int workerBusy = 0;
+	for ( int i = 0; i <= numThreads; i++ ) {
+		jobThreadStats_t s;
+		s.jobs = Sys_InterlockedExchange( stats[i].jobs, 0 );
+		s.steals = Sys_InterlockedExchange( stats[i].steals, 0 );
+		s.busyTime = Sys_InterlockedExchange( stats[i].busyTime, 0 );
+		s.waitTime = Sys_InterlockedExchange( stats[i].waitTime, 0 );
+
+		common->Printf( "%-12s %7d %7d %8.1f %8.1f %4.0f%%\n", ( i == 0 ) ? "other" : threads[i - 1].name,
+						s.jobs, s.steals, s.busyTime * 0.001f, s.waitTime * 0.001f, 100.0f * s.busyTime / elapsed );
+		totalJobs += s.jobs;
+		if ( i > 0 ) {
+			workerBusy += s.busyTime;
+		}
+	}
+	common->Printf( "%d jobs in %.1f ms, worker utilization %.0f%%\n", totalJobs, elapsed * 0.001f,
+					numThreads ? 100.0f * workerBusy / ( elapsed * numThreads ) : 0.0f );
+
+	statsStartTime = now;
+}
+
+/*
+================
+idJobManagerLocal::ListJobs_f
+================
+*/
+void idJobManagerLocal::ListJobs_f( const idCmdArgs &args ) {
+	jobManagerLocal.ListJobs();
+}
+
+/*
+================
+idJobManagerLocal::JobStats_f
+================
+*/
+void idJobManagerLocal::JobStats_f( const idCmdArgs &args ) {
+	jobManagerLocal.PrintStats();
+}
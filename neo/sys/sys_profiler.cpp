@@ -0,0 +1,338 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+const int MAX_PROFILE_THREADS			= MAX_JOB_THREADS + 16;
+const int MAX_PROFILE_DEPTH				= 64;
+const int PROFILE_RING_SIZE				= 1 << 16;		// zones kept per thread, must be a power of two
+
+typedef struct profileZone_s {
+	const char *			name;
+	double					start;
+	double					end;
+	int						depth;
+} profileZone_t;
+
+// only ever written by the thread it belongs to
+typedef struct profileThread_s {
+	char					name[32];
+	int						generation;		// capture the zones were recorded for
+	int						depth;
+	const char *			stackNames[MAX_PROFILE_DEPTH];
+	double					stackStart[MAX_PROFILE_DEPTH];
+	volatile int			numZones;		// total number of zones written, the ring keeps the most recent ones
+	profileZone_t *			zones;
+} profileThread_t;
+
+static ID_THREAD_LOCAL profileThread_t *profile_thread = NULL;
+
+class idProfilerLocal : public idProfiler {
+public:
+							idProfilerLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+
+	virtual void			StartCapture( int numFrames, const char *fileName );
+	virtual void			EndFrame( void );
+	virtual void			SetThreadName( const char *name );
+
+	virtual void			BeginZone( const char *name );
+	virtual void			EndZone( void );
+
+private:
+	profileThread_t			threads[MAX_PROFILE_THREADS];
+	volatile int			numThreads;
+	volatile int			generation;
+	int						framesLeft;
+	bool					writePending;
+	double					captureStart;
+	double					captureEnd;
+	idStr					fileName;
+
+	profileThread_t *		GetThread( void );
+	void					WriteCapture( void );
+
+	static void				ProfileCapture_f( const idCmdArgs &args );
+};
+
+idProfilerLocal				profilerLocal;
+idProfiler *				profiler = &profilerLocal;
+
+/*
+================
+idProfilerLocal::idProfilerLocal
+================
+*/
+idProfilerLocal::idProfilerLocal( void ) {
+	capturing = false;
+	memset( threads, 0, sizeof( threads ) );
+	numThreads = 0;
+	generation = 0;
+	framesLeft = 0;
+	writePending = false;
+	captureStart = 0.0;
+	captureEnd = 0.0;
+}
+
+/*
+================
+idProfilerLocal::Init
+================
+*/
+void idProfilerLocal::Init( void ) {
+	SetThreadName( "main" );
+
+	cmdSystem->AddCommand( "profileCapture", ProfileCapture_f, CMD_FL_SYSTEM, "profiles the given number of frames and writes a Chrome trace event file" );
+}
+
+/*
+================
+idProfilerLocal::Shutdown
+================
+*/
+void idProfilerLocal::Shutdown( void ) {
+	capturing = false;
+	writePending = false;
+
+	cmdSystem->RemoveCommand( "profileCapture" );
+
+	// threads keep pointing at their slot so the slots and ring buffers stay allocated
+	for ( int i = 0; i < numThreads; i++ ) {
+		threads[i].numZones = 0;
+	}
+}
+
+/*
+================
+idProfilerLocal::GetThread
+
+Gives the calling thread a slot the first time it is named or records a zone.
+================
+*/
+profileThread_t *idProfilerLocal::GetThread( void ) {
+	if ( profile_thread != NULL ) {
+		return profile_thread;
+	}
+
+	int index = Sys_InterlockedIncrement( numThreads ) - 1;
+	if ( index >= MAX_PROFILE_THREADS ) {
+		Sys_InterlockedDecrement( numThreads );
+		return NULL;
+	}
+
+	profileThread_t *thread = &threads[index];
+	thread->generation = -1;
+	thread->depth = 0;
+	thread->numZones = 0;
+
+	profile_thread = thread;
+	return thread;
+}
+
+/*
+================
+idProfilerLocal::SetThreadName
+================
+*/
+void idProfilerLocal::SetThreadName( const char *name ) {
+	profileThread_t *thread = GetThread();
+	if ( thread != NULL && thread->name[0] == '\0' ) {
+		idStr::Copynz( thread->name, name, sizeof( thread->name ) );
+	}
+}
+
+/*
+================
+idProfilerLocal::BeginZone
+================
+*/
+void idProfilerLocal::BeginZone( const char *name ) {
+	profileThread_t *thread = GetThread();
+	if ( thread == NULL ) {
+		return;
+	}
+
+	// the ring buffer is only allocated once the thread is profiled
+	if ( thread->zones == NULL ) {
+		thread->zones = (profileZone_t *)Mem_Alloc( PROFILE_RING_SIZE * sizeof( profileZone_t ) );
+	}
+
+	// drop the zones of the previous capture
+	if ( thread->generation != generation ) {
+		thread->generation = generation;
+		thread->depth = 0;
+		thread->numZones = 0;
+	}
+
+	if ( thread->depth < MAX_PROFILE_DEPTH ) {
+		thread->stackNames[thread->depth] = name;
+		thread->stackStart[thread->depth] = Sys_GetClockTicks();
+	}
+	thread->depth++;
+}
+
+/*
+================
+idProfilerLocal::EndZone
+================
+*/
+void idProfilerLocal::EndZone( void ) {
+	profileThread_t *thread = profile_thread;
+	if ( thread == NULL || thread->generation != generation || thread->depth <= 0 ) {
+		return;
+	}
+
+	thread->depth--;
+	if ( thread->depth < MAX_PROFILE_DEPTH ) {
+		profileZone_t &zone = thread->zones[thread->numZones & ( PROFILE_RING_SIZE - 1 )];
+		zone.name = thread->stackNames[thread->depth];
+		zone.start = thread->stackStart[thread->depth];
+		zone.end = Sys_GetClockTicks();
+		zone.depth = thread->depth;
+		thread->numZones++;
+	}
+}
+
+/*
+================
+idProfilerLocal::StartCapture
+================
+*/
+void idProfilerLocal::StartCapture( int numFrames, const char *fileName ) {
+	if ( capturing || writePending ) {
+		common->Printf( "a profile capture is already running\n" );
+		return;
+	}
+
+	this->fileName = fileName;
+	this->fileName.DefaultFileExtension( ".json" );
+	// the frame the capture is started in is not complete so capture one more
+	framesLeft = Max( numFrames, 1 ) + 1;
+
+	Sys_InterlockedIncrement( generation );
+	captureStart = Sys_GetClockTicks();
+	capturing = true;
+}
+
+/*
+================
+idProfilerLocal::EndFrame
+
+The capture is written one frame after it stopped so zones that were
+still open on other threads get a chance to close.
+================
+*/
+void idProfilerLocal::EndFrame( void ) {
+	if ( writePending ) {
+		WriteCapture();
+		writePending = false;
+	}
+	if ( capturing && --framesLeft <= 0 ) {
+		capturing = false;
+		captureEnd = Sys_GetClockTicks();
+		writePending = true;
+	}
+}
+
+/*
+================
+idProfilerLocal::WriteCapture
+================
+*/
+void idProfilerLocal::WriteCapture( void ) {
+	int i, j, first, last, numWritten, numDropped;
+	double usecPerTick;
+	idFile *f;
+
+	f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "couldn't open %s", fileName.c_str() );
+		return;
+	}
+
+	usecPerTick = 1000000.0 / Sys_ClockTicksPerSecond();
+	numWritten = 0;
+	numDropped = 0;
+
+	f->Printf( "{\"traceEvents\":[\n" );
+	f->Printf( "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"%s\"}}", GAME_NAME );
+
+	for ( i = 0; i < numThreads; i++ ) {
+		const profileThread_t &thread = threads[i];
+
+		if ( thread.name[0] != '\0' ) {
+			f->Printf( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", i, thread.name );
+		} else {
+			f->Printf( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", i, i );
+		}
+		f->Printf( ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"sort_index\":%d}}", i, i );
+
+		if ( thread.generation != generation ) {
+			continue;
+		}
+
+		last = thread.numZones;
+		first = Max( 0, last - PROFILE_RING_SIZE );
+		numDropped += first;
+
+		for ( j = first; j < last; j++ ) {
+			const profileZone_t &zone = thread.zones[j & ( PROFILE_RING_SIZE - 1 )];
+			if ( zone.start < captureStart ) {
+				continue;
+			}
+			f->Printf( ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", zone.name, i,
+						( zone.start - captureStart ) * usecPerTick, ( zone.end - zone.start ) * usecPerTick );
+			numWritten++;
+		}
+	}
+
+	f->Printf( "\n],\"displayTimeUnit\":\"ms\"}\n" );
+	fileSystem->CloseFile( f );
+
+	common->Printf( "wrote %d zones of %d threads over %.1f ms to %s\n", numWritten, (int)numThreads,
+					( captureEnd - captureStart ) * usecPerTick * 0.001, fileSystem->RelativePathToOSPath( fileName, "fs_savepath" ) );
+	if ( numDropped > 0 ) {
+		common->Printf( "%d zones were dropped because the per thread ring buffers wrapped around\n", numDropped );
+	}
+}
+
+/*
+================
+idProfilerLocal::ProfileCapture_f
+================
+*/
+void idProfilerLocal::ProfileCapture_f( const idCmdArgs &args ) {
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: profileCapture <frames> [fileName]\n" );
+		return;
+	}
+	profilerLocal.StartCapture( atoi( args.Argv( 1 ) ), args.Argc() > 2 ? args.Argv( 2 ) : "profile.json" );
+}
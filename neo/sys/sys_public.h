@@ -84,7 +84,7 @@ If you have questions concerning this license or the applicable additional terms
 #endif
 
 #define _alloca							alloca
-#define _alloca16( x )					((void *)((((int)alloca( (x)+15 )) + 15) & ~15))
+#define _alloca16( x )					((void *)((((size_t)alloca( (x)+15 )) + 15) & ~(size_t)15))
 
 #define PATHSEPERATOR_STR				"/"
 #define PATHSEPERATOR_CHAR				'/'
@@ -108,6 +108,11 @@ If you have questions concerning this license or the applicable additional terms
 	#define BUILD_OS_ID					2
 	#define CPUSTRING					"x86"
 	#define CPU_EASYARGS				1
+#elif defined(__x86_64__)
+	#define	BUILD_STRING				"linux-x86_64"
+	#define BUILD_OS_ID					2
+	#define CPUSTRING					"x86_64"
+	#define CPU_EASYARGS				1
 #elif defined(__ppc__)
 	#define	BUILD_STRING				"linux-ppc"
 	#define CPUSTRING					"ppc"
@@ -115,7 +120,7 @@ If you have questions concerning this license or the applicable additional terms
 #endif
 
 #define _alloca							alloca
-#define _alloca16( x )					((void *)((((int)alloca( (x)+15 )) + 15) & ~15))
+#define _alloca16( x )					((void *)((((size_t)alloca( (x)+15 )) + 15) & ~(size_t)15))
 
 #define ALIGN16( x )					x
 #define PACKED							__attribute__((packed))
@@ -154,7 +159,9 @@ typedef enum {
 	CPUID_HTT							= 0x01000,	// Hyper-Threading Technology
 	CPUID_CMOV							= 0x02000,	// Conditional Move (CMOV) and fast floating point comparison (FCOMI) instructions
 	CPUID_FTZ							= 0x04000,	// Flush-To-Zero mode (denormal results are flushed to zero)
-	CPUID_DAZ							= 0x08000	// Denormals-Are-Zero mode (denormal source operands are set to zero)
+	CPUID_DAZ							= 0x08000,	// Denormals-Are-Zero mode (denormal source operands are set to zero)
+	CPUID_AVX2							= 0x10000,	// Advanced Vector Extensions 2 (with operating system support for the YMM state)
+	CPUID_FMA3							= 0x20000	// Fused Multiply-Add with three operands
 } cpuid_t;
 
 typedef enum {
@@ -369,6 +376,10 @@ void			Sys_ShowConsole( int visLevel, bool quitOnClose );
 
 void			Sys_Mkdir( const char *path );
 ID_TIME_T			Sys_FileTimeStamp( FILE *fp );
+// maps a whole file read only, the file can be closed afterwards
+// returns NULL if the file can't be mapped
+const void *	Sys_MapFile( FILE *fp, int length );
+void			Sys_UnmapFile( const void *data, int length );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 const char *	Sys_DefaultCDPath( void );
@@ -491,7 +502,7 @@ typedef struct {
 	unsigned long	threadId;
 } xthreadInfo;
 
-const int MAX_THREADS				= 10;
+const int MAX_THREADS				= 10 + 32;		// the engine threads and up to MAX_JOB_THREADS job workers
 extern xthreadInfo *g_threads[MAX_THREADS];
 extern int			g_thread_count;
 
@@ -526,6 +537,125 @@ enum {
 void				Sys_WaitForEvent( int index = TRIGGER_EVENT_ZERO );
 void				Sys_TriggerEvent( int index = TRIGGER_EVENT_ZERO );
 
+// auto-reset signals, unlike the trigger events any number of them can be created
+// a signal raised while no thread is waiting stays raised until the next wait
+typedef struct xsignal_s *	xsignalHandle;
+
+xsignalHandle		Sys_CreateSignal( void );
+void				Sys_DestroySignal( xsignalHandle signal );
+void				Sys_RaiseSignal( xsignalHandle signal );
+// returns false if the signal was not raised within timeout milliseconds, a negative timeout waits forever
+bool				Sys_WaitForSignal( xsignalHandle signal, int timeout = -1 );
+
+// number of logical processors available to the process
+int					Sys_GetProcessorCount( void );
+
+/*
+==============================================================
+
+	Atomic operations
+
+	These are inlined compiler intrinsics so they can be used from
+	idLib in both the executable and the game module.
+
+==============================================================
+*/
+
+#ifdef _WIN32
+
+#include <intrin.h>
+
+#define ID_THREAD_LOCAL					__declspec( thread )
+
+// returns the incremented value
+ID_INLINE int Sys_InterlockedIncrement( volatile int &value ) {
+	return _InterlockedIncrement( (volatile long *)&value );
+}
+
+// returns the decremented value
+ID_INLINE int Sys_InterlockedDecrement( volatile int &value ) {
+	return _InterlockedDecrement( (volatile long *)&value );
+}
+
+// returns the new value
+ID_INLINE int Sys_InterlockedAdd( volatile int &value, int i ) {
+	return _InterlockedExchangeAdd( (volatile long *)&value, i ) + i;
+}
+
+// returns the previous value
+ID_INLINE int Sys_InterlockedExchange( volatile int &value, int exchange ) {
+	return _InterlockedExchange( (volatile long *)&value, exchange );
+}
+
+// returns the previous value, the exchange only happens if it was equal to comparand
+ID_INLINE int Sys_InterlockedCompareExchange( volatile int &value, int comparand, int exchange ) {
+	return _InterlockedCompareExchange( (volatile long *)&value, exchange, comparand );
+}
+
+ID_INLINE void *Sys_InterlockedExchangePointer( void * volatile &ptr, void *exchange ) {
+	return (void *)_InterlockedExchange( (volatile long *)&ptr, (long)exchange );
+}
+
+ID_INLINE void *Sys_InterlockedCompareExchangePointer( void * volatile &ptr, void *comparand, void *exchange ) {
+	return (void *)_InterlockedCompareExchange( (volatile long *)&ptr, (long)exchange, (long)comparand );
+}
+
+// spin-wait hint to the processor
+ID_INLINE void Sys_SpinPause( void ) {
+	_mm_pause();
+}
+
+#else
+
+#define ID_THREAD_LOCAL					__thread
+
+ID_INLINE int Sys_InterlockedIncrement( volatile int &value ) {
+	return __sync_add_and_fetch( &value, 1 );
+}
+
+ID_INLINE int Sys_InterlockedDecrement( volatile int &value ) {
+	return __sync_sub_and_fetch( &value, 1 );
+}
+
+ID_INLINE int Sys_InterlockedAdd( volatile int &value, int i ) {
+	return __sync_add_and_fetch( &value, i );
+}
+
+ID_INLINE int Sys_InterlockedExchange( volatile int &value, int exchange ) {
+#if __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 7 )
+	return __atomic_exchange_n( &value, exchange, __ATOMIC_SEQ_CST );
+#else
+	// __sync_lock_test_and_set is only an acquire barrier
+	__sync_synchronize();
+	return __sync_lock_test_and_set( &value, exchange );
+#endif
+}
+
+ID_INLINE int Sys_InterlockedCompareExchange( volatile int &value, int comparand, int exchange ) {
+	return __sync_val_compare_and_swap( &value, comparand, exchange );
+}
+
+ID_INLINE void *Sys_InterlockedExchangePointer( void * volatile &ptr, void *exchange ) {
+#if __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 7 )
+	return __atomic_exchange_n( &ptr, exchange, __ATOMIC_SEQ_CST );
+#else
+	__sync_synchronize();
+	return __sync_lock_test_and_set( &ptr, exchange );
+#endif
+}
+
+ID_INLINE void *Sys_InterlockedCompareExchangePointer( void * volatile &ptr, void *comparand, void *exchange ) {
+	return __sync_val_compare_and_swap( &ptr, comparand, exchange );
+}
+
+ID_INLINE void Sys_SpinPause( void ) {
+#if defined(__i386__) || defined(__x86_64__)
+	__asm__ __volatile__( "pause" );
+#endif
+}
+
+#endif
+
 /*
 ==============================================================
 
@@ -190,6 +190,33 @@ static void CPUID( int func, unsigned regs[4] ) {
 	regs[_REG_EDX] = regEDX;
 }
 
+/*
+================
+CPUIDEx
+
+  same as CPUID but with a sub-leaf in ECX
+================
+*/
+static void CPUIDEx( int func, int subfunc, unsigned regs[4] ) {
+	unsigned regEAX, regEBX, regECX, regEDX;
+
+	__asm pusha
+	__asm mov eax, func
+	__asm mov ecx, subfunc
+	__asm __emit 00fh
+	__asm __emit 0a2h
+	__asm mov regEAX, eax
+	__asm mov regEBX, ebx
+	__asm mov regECX, ecx
+	__asm mov regEDX, edx
+	__asm popa
+
+	regs[_REG_EAX] = regEAX;
+	regs[_REG_EBX] = regEBX;
+	regs[_REG_ECX] = regECX;
+	regs[_REG_EDX] = regEDX;
+}
+
 
 /*
 ================
@@ -335,6 +362,91 @@ static bool HasSSE3( void ) {
 	return false;
 }
 
+/*
+================
+HasAVXState
+
+  returns true if the operating system saves and restores the YMM registers
+================
+*/
+static bool HasAVXState( void ) {
+	unsigned regs[4];
+	unsigned xcr0;
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 27 of ECX denotes OSXSAVE and bit 28 of ECX denotes AVX existence
+	if ( ( regs[_REG_ECX] & ( ( 1 << 27 ) | ( 1 << 28 ) ) ) != ( ( 1 << 27 ) | ( 1 << 28 ) ) ) {
+		return false;
+	}
+
+	// xgetbv with ECX = 0 returns XCR0, the XMM and YMM state bits have to be enabled
+	__asm {
+		push	eax
+		push	ecx
+		push	edx
+		xor		ecx, ecx
+		__emit	0x0f
+		__emit	0x01
+		__emit	0xd0
+		mov		xcr0, eax
+		pop		edx
+		pop		ecx
+		pop		eax
+	}
+	return ( xcr0 & 6 ) == 6;
+}
+
+/*
+================
+HasFMA3
+================
+*/
+static bool HasFMA3( void ) {
+	unsigned regs[4];
+
+	if ( !HasAVXState() ) {
+		return false;
+	}
+
+	// get CPU feature bits
+	CPUID( 1, regs );
+
+	// bit 12 of ECX denotes FMA3 existence
+	if ( regs[_REG_ECX] & ( 1 << 12 ) ) {
+		return true;
+	}
+	return false;
+}
+
+/*
+================
+HasAVX2
+================
+*/
+static bool HasAVX2( void ) {
+	unsigned regs[4];
+
+	if ( !HasAVXState() ) {
+		return false;
+	}
+
+	// the structured extended feature flags require leaf 7
+	CPUID( 0, regs );
+	if ( regs[_REG_EAX] < 7 ) {
+		return false;
+	}
+
+	CPUIDEx( 7, 0, regs );
+
+	// bit 5 of EBX denotes AVX2 existence
+	if ( regs[_REG_EBX] & ( 1 << 5 ) ) {
+		return true;
+	}
+	return false;
+}
+
 /*
 ================
 LogicalProcPerPhysicalProc
@@ -571,6 +683,16 @@ cpuid_t Sys_GetCPUId( void ) {
 		flags |= CPUID_SSE3;
 	}
 
+	// check for Advanced Vector Extensions 2
+	if ( HasAVX2() ) {
+		flags |= CPUID_AVX2;
+	}
+
+	// check for Fused Multiply-Add
+	if ( HasFMA3() ) {
+		flags |= CPUID_FMA3;
+	}
+
 	// check for Hyper-Threading Technology
 	if ( HasHTT() ) {
 		flags |= CPUID_HTT;
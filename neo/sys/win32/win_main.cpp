@@ -200,6 +200,54 @@ void Sys_TriggerEvent( int index ) {
 	SetEvent( win32.backgroundDownloadSemaphore );
 }
 
+/*
+==================
+Sys_CreateSignal
+==================
+*/
+xsignalHandle Sys_CreateSignal( void ) {
+	// auto-reset event
+	return (xsignalHandle)CreateEvent( NULL, FALSE, FALSE, NULL );
+}
+
+/*
+==================
+Sys_DestroySignal
+==================
+*/
+void Sys_DestroySignal( xsignalHandle signal ) {
+	CloseHandle( (HANDLE)signal );
+}
+
+/*
+==================
+Sys_RaiseSignal
+==================
+*/
+void Sys_RaiseSignal( xsignalHandle signal ) {
+	SetEvent( (HANDLE)signal );
+}
+
+/*
+==================
+Sys_WaitForSignal
+==================
+*/
+bool Sys_WaitForSignal( xsignalHandle signal, int timeout ) {
+	return WaitForSingleObject( (HANDLE)signal, timeout < 0 ? INFINITE : timeout ) == WAIT_OBJECT_0;
+}
+
+/*
+==================
+Sys_GetProcessorCount
+==================
+*/
+int Sys_GetProcessorCount( void ) {
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
 
 
 #pragma optimize( "", on )
@@ -482,6 +530,35 @@ ID_TIME_T Sys_FileTimeStamp( FILE *fp ) {
 	return (long) st.st_mtime;
 }
 
+/*
+=================
+Sys_MapFile
+=================
+*/
+const void *Sys_MapFile( FILE *fp, int length ) {
+	HANDLE file = (HANDLE)_get_osfhandle( _fileno( fp ) );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return NULL;
+	}
+	HANDLE mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+	// the view keeps the mapping alive
+	const void *data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, length );
+	CloseHandle( mapping );
+	return data;
+}
+
+/*
+=================
+Sys_UnmapFile
+=================
+*/
+void Sys_UnmapFile( const void *data, int length ) {
+	UnmapViewOfFile( data );
+}
+
 /*
 ==============
 Sys_Cwd
@@ -1079,6 +1156,12 @@ void Sys_Init( void ) {
 		if ( win32.cpuid & CPUID_SSE3 ) {
 			string += "SSE3 & ";
 		}
+		if ( win32.cpuid & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( win32.cpuid & CPUID_FMA3 ) {
+			string += "FMA3 & ";
+		}
 		if ( win32.cpuid & CPUID_HTT ) {
 			string += "HTT & ";
 		}
@@ -1108,6 +1191,10 @@ void Sys_Init( void ) {
 				id |= CPUID_SSE2;
 			} else if ( token.Icmp( "sse3" ) == 0 ) {
 				id |= CPUID_SSE3;
+			} else if ( token.Icmp( "avx2" ) == 0 ) {
+				id |= CPUID_AVX2;
+			} else if ( token.Icmp( "fma3" ) == 0 ) {
+				id |= CPUID_FMA3;
 			} else if ( token.Icmp( "htt" ) == 0 ) {
 				id |= CPUID_HTT;
 			}
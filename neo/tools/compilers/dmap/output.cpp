@@ -48,6 +48,7 @@ resolved: normals.  otherwise adjacent facet shaded surfaces get their
 #endif
 
 static	idFile	*procFile;
+static	idFile	*bprocFile;		// little endian binary version of the same data
 
 #define	AREANUM_DIFFERENT	-2
 /*
@@ -98,6 +99,27 @@ static void WriteFloat( idFile *f, float v )
 	}
 }
 
+/*
+=============
+WriteBinaryFloat
+
+Snaps to integers the same way WriteFloat does
+=============
+*/
+static void WriteBinaryFloat( idFile *f, float v ) {
+	if ( idMath::Fabs(v - idMath::Rint(v)) < 0.001 ) {
+		f->WriteFloat( (float)(int)idMath::Rint(v) );
+	} else {
+		f->WriteFloat( v );
+	}
+}
+
+static void WriteBinary1DMatrix( idFile *f, int x, const float *m ) {
+	for ( int i = 0; i < x; i++ ) {
+		WriteBinaryFloat( f, m[i] );
+	}
+}
+
 void Write1DMatrix( idFile *f, int x, float *m ) {
 	int		i;
 
@@ -308,6 +330,19 @@ static void WriteUTriangles( const srfTriangles_t *uTris ) {
 	if ( col != 0 ) {
 		procFile->WriteFloatString( "\n" );
 	}
+
+	bprocFile->WriteInt( uTris->numVerts );
+	bprocFile->WriteInt( uTris->numIndexes );
+	for ( i = 0 ; i < uTris->numVerts ; i++ ) {
+		const idDrawVert *dv = &uTris->verts[i];
+
+		WriteBinary1DMatrix( bprocFile, 3, dv->xyz.ToFloatPtr() );
+		WriteBinary1DMatrix( bprocFile, 2, dv->st.ToFloatPtr() );
+		WriteBinary1DMatrix( bprocFile, 3, dv->normal.ToFloatPtr() );
+	}
+	for ( i = 0 ; i < uTris->numIndexes ; i++ ) {
+		bprocFile->WriteInt( uTris->indexes[i] );
+	}
 }
 
 
@@ -353,6 +388,18 @@ static void WriteShadowTriangles( const srfTriangles_t *tri ) {
 	if ( col != 0 ) {
 		procFile->WriteFloatString( "\n" );
 	}
+
+	bprocFile->WriteInt( tri->numVerts );
+	bprocFile->WriteInt( tri->numShadowIndexesNoCaps );
+	bprocFile->WriteInt( tri->numShadowIndexesNoFrontCaps );
+	bprocFile->WriteInt( tri->numIndexes );
+	bprocFile->WriteInt( tri->shadowCapPlaneBits );
+	for ( i = 0 ; i < tri->numVerts ; i++ ) {
+		WriteBinary1DMatrix( bprocFile, 3, tri->shadowVertexes[i].xyz.ToFloatPtr() );
+	}
+	for ( i = 0 ; i < tri->numIndexes ; i++ ) {
+		bprocFile->WriteInt( tri->indexes[i] );
+	}
 }
 
 
@@ -405,9 +452,12 @@ typedef struct interactionTris_s {
 	numSurfaces = CountUniqueShaders( area->groups );
 
 
+	bprocFile->WriteInt( BPROC_MODEL );
+
 	if ( entityNum == 0 ) {
 		procFile->WriteFloatString( "model { /* name = */ \"_area%i\" /* numSurfaces = */ %i\n\n", 
 			areaNum, numSurfaces );
+		bprocFile->WriteString( va( "_area%i", areaNum ) );
 	} else {
 		const char *name;
 
@@ -417,7 +467,9 @@ typedef struct interactionTris_s {
 		}
 		procFile->WriteFloatString( "model { /* name = */ \"%s\" /* numSurfaces = */ %i\n\n", 
 			name, numSurfaces );
+		bprocFile->WriteString( name );
 	}
+	bprocFile->WriteInt( numSurfaces );
 
 	surfaceNum = 0;
 	for ( group = area->groups ; group ; group = group->nextGroup ) {
@@ -479,6 +531,7 @@ typedef struct interactionTris_s {
 		procFile->WriteFloatString( "/* surface %i */ { ", surfaceNum );
 		surfaceNum++;
 		procFile->WriteFloatString( "\"%s\" ", ambient->material->GetName() );
+		bprocFile->WriteString( ambient->material->GetName() );
 
 		uTri = ShareMapTriVerts( ambient );
 		FreeTriList( ambient );
@@ -525,6 +578,10 @@ static void WriteNode_r( node_t *node ) {
 	Write1DMatrix( procFile, 4, plane->ToFloatPtr() );
 	procFile->WriteFloatString( "%i %i\n", child[0], child[1] );
 
+	WriteBinary1DMatrix( bprocFile, 4, plane->ToFloatPtr() );
+	bprocFile->WriteInt( child[0] );
+	bprocFile->WriteInt( child[1] );
+
 	if ( child[0] > 0 ) {
 		WriteNode_r( node->children[0] );
 	}
@@ -563,6 +620,9 @@ static void WriteOutputNodes( node_t *node ) {
 	procFile->WriteFloatString( "/* a child number of 0 is an opaque, solid area */\n" );
 	procFile->WriteFloatString( "/* negative child numbers are areas: (-1-child) */\n" );
 
+	bprocFile->WriteInt( BPROC_NODES );
+	bprocFile->WriteInt( numNodes );
+
 	WriteNode_r( node );
 
 	procFile->WriteFloatString( "}\n\n" );
@@ -581,12 +641,21 @@ static void WriteOutputPortals( uEntity_t *e ) {
 	procFile->WriteFloatString( "interAreaPortals { /* numAreas = */ %i /* numIAP = */ %i\n\n", 
 		e->numAreas, numInterAreaPortals );
 	procFile->WriteFloatString( "/* interAreaPortal format is: numPoints positiveSideArea negativeSideArea ( point) ... */\n" );
+
+	bprocFile->WriteInt( BPROC_INTER_AREA_PORTALS );
+	bprocFile->WriteInt( e->numAreas );
+	bprocFile->WriteInt( numInterAreaPortals );
+
 	for ( i = 0 ; i < numInterAreaPortals ; i++ ) {
 		iap = &interAreaPortals[i];
 		w = iap->side->winding;
 		procFile->WriteFloatString("/* iap %i */ %i %i %i ", i, w->GetNumPoints(), iap->area0, iap->area1 );
+		bprocFile->WriteInt( w->GetNumPoints() );
+		bprocFile->WriteInt( iap->area0 );
+		bprocFile->WriteInt( iap->area1 );
 		for ( j = 0 ; j < w->GetNumPoints() ; j++ ) {
 			Write1DMatrix( procFile, 3, (*w)[j].ToFloatPtr() );
+			WriteBinary1DMatrix( bprocFile, 3, (*w)[j].ToFloatPtr() );
 		}
 		procFile->WriteFloatString("\n" );
 	}
@@ -628,6 +697,18 @@ static void WriteOutputEntity( int entityNum ) {
 }
 
 
+/*
+====================
+WriteBinaryProcHeader
+====================
+*/
+static void WriteBinaryProcHeader( int procLength, unsigned long procCrc ) {
+	bprocFile->Write( BPROC_FILE_ID, 4 );
+	bprocFile->WriteInt( BPROC_FILE_VERSION );
+	bprocFile->WriteInt( procLength );
+	bprocFile->WriteUnsignedInt( procCrc );
+}
+
 /*
 ====================
 WriteOutputFile
@@ -636,12 +717,13 @@ WriteOutputFile
 void WriteOutputFile( void ) {
 	int				i;
 	uEntity_t		*entity;
-	idStr			qpath;
+	idStr			qpath, bqpath;
 
 	// write the file
 	common->Printf( "----- WriteOutputFile -----\n" );
 
 	sprintf( qpath, "%s." PROC_FILE_EXT, dmapGlobals.mapFileBase );
+	sprintf( bqpath, "%s." BPROC_FILE_EXT, dmapGlobals.mapFileBase );
 
 	common->Printf( "writing %s\n", qpath.c_str() );
 	// _D3XP used fs_cdpath
@@ -650,8 +732,17 @@ void WriteOutputFile( void ) {
 		common->Error( "Error opening %s", qpath.c_str() );
 	}
 
+	common->Printf( "writing %s\n", bqpath.c_str() );
+	bprocFile = fileSystem->OpenFileWrite( bqpath, "fs_devpath" );
+	if ( !bprocFile ) {
+		common->Error( "Error opening %s", bqpath.c_str() );
+	}
+
 	procFile->WriteFloatString( "%s\n\n", PROC_FILE_ID );
 
+	// the header is rewritten with the length and CRC of the text file when it is complete
+	WriteBinaryProcHeader( 0, 0 );
+
 	// write the entity models and information, writing entities first
 	for ( i=dmapGlobals.num_entities - 1 ; i >= 0 ; i-- ) {
 		entity = &dmapGlobals.uEntities[i];
@@ -671,6 +762,8 @@ void WriteOutputFile( void ) {
 		}
 
 		procFile->WriteFloatString( "shadowModel { /* name = */ \"_prelight_%s\"\n\n", light->name );
+		bprocFile->WriteInt( BPROC_SHADOW_MODEL );
+		bprocFile->WriteString( va( "_prelight_%s", light->name ) );
 		WriteShadowTriangles( light->shadowTris );
 		procFile->WriteFloatString( "}\n\n" );
 
@@ -679,4 +772,21 @@ void WriteOutputFile( void ) {
 	}
 
 	fileSystem->CloseFile( procFile );
+
+	// the engine only uses the binary file if it was written for this text file
+	idFile *f = fileSystem->OpenExplicitFileRead( fileSystem->RelativePathToOSPath( qpath, "fs_devpath" ) );
+	if ( !f ) {
+		common->Error( "Error reading back %s", qpath.c_str() );
+	}
+	int length = f->Length();
+	byte *buffer = (byte *)Mem_Alloc( length );
+	f->Read( buffer, length );
+	fileSystem->CloseFile( f );
+	unsigned long crc = CRC32_BlockChecksum( buffer, length );
+	Mem_Free( buffer );
+
+	bprocFile->Seek( 0, FS_SEEK_SET );
+	WriteBinaryProcHeader( length, crc );
+
+	fileSystem->CloseFile( bprocFile );
 }